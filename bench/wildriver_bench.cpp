@@ -0,0 +1,929 @@
+/**
+ * @file wildriver_bench.cpp
+ * @brief Benchmark of reading and writing synthetic matrices, graphs and
+ * vectors in each of the supported formats.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-25
+ */
+
+
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "wildriver.h"
+
+
+
+
+namespace
+{
+
+
+/******************************************************************************
+* TYPES ***********************************************************************
+******************************************************************************/
+
+
+struct options_struct
+{
+  options_struct() :
+    rows(100000),
+    degree(16),
+    seed(1),
+    repeat(3),
+    dir("."),
+    formats(),
+    backends({"buffered", "mmap", "async"}),
+    caches({"warm", "cold"}),
+    keep(false)
+  {
+    // do nothing
+  }
+
+  wildriver_dim_t rows;
+  wildriver_ind_t degree;
+  uint64_t seed;
+  int repeat;
+  std::string dir;
+  std::vector<std::string> formats;
+  std::vector<std::string> backends;
+  std::vector<std::string> caches;
+  bool keep;
+};
+
+
+struct matrix_struct
+{
+  matrix_struct() :
+    nrows(0),
+    rowptr(1, 0),
+    rowind(),
+    rowval()
+  {
+    // do nothing
+  }
+
+  wildriver_dim_t nrows;
+  std::vector<wildriver_ind_t> rowptr;
+  std::vector<wildriver_dim_t> rowind;
+  std::vector<wildriver_val_t> rowval;
+};
+
+
+struct result_struct
+{
+  result_struct() :
+    format(),
+    operation(),
+    backend(),
+    cache(),
+    bytes(0),
+    entries(0),
+    seconds(0),
+    peakRss(0)
+  {
+    // do nothing
+  }
+
+  std::string format;
+  std::string operation;
+  // how the file was read, and whether it was in the page cache
+  std::string backend;
+  std::string cache;
+  size_t bytes;
+  size_t entries;
+  double seconds;
+  size_t peakRss;
+};
+
+
+/**
+* @brief How the input of a format is structured and written.
+*/
+struct format_struct
+{
+  char const * name;
+  char const * extension;
+  // whether the generated matrix is symmetric with no self loops
+  bool symmetric;
+  // the writer of the format, which for formats the library does not write
+  // is part of the generation and not timed
+  bool (*write)(
+      std::string const & fname,
+      matrix_struct const & matrix);
+  // whether the library writes the format
+  bool timed;
+};
+
+
+
+
+/******************************************************************************
+* HELPER FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+/**
+* @brief The read backends, by name.
+*/
+std::pair<char const *, int> const READ_BACKENDS[] = {
+  {"buffered", WILDRIVER_READ_BUFFERED},
+  {"mmap", WILDRIVER_READ_MMAP},
+  {"async", WILDRIVER_READ_ASYNC}
+};
+
+
+/**
+* @brief Find a read backend by name.
+*
+* @param name The name.
+*
+* @return The backend, or -1 if there is none by the name.
+*/
+int findBackend(
+    std::string const & name)
+{
+  for (std::pair<char const *, int> const & backend : READ_BACKENDS) {
+    if (name == backend.first) {
+      return backend.second;
+    }
+  }
+
+  return -1;
+}
+
+
+/**
+* @brief Split a comma separated list.
+*
+* @param value The list.
+*
+* @return The items.
+*/
+std::vector<std::string> splitList(
+    std::string const & value)
+{
+  std::vector<std::string> items;
+  std::istringstream stream(value);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    items.emplace_back(item);
+  }
+
+  return items;
+}
+
+
+void usage(
+    char const * const name)
+{
+  std::cerr << "USAGE: " << name << " [options]" << std::endl;
+  std::cerr << std::endl;
+  std::cerr << "OPTIONS:" << std::endl;
+  std::cerr << "  --rows=<n>" << std::endl;
+  std::cerr << "    The number of rows/vertices (default 100000)." << \
+      std::endl;
+  std::cerr << "  --degree=<n>" << std::endl;
+  std::cerr << "    The average number of entries per row (default 16)." << \
+      std::endl;
+  std::cerr << "  --seed=<n>" << std::endl;
+  std::cerr << "    The seed for generating the inputs (default 1)." << \
+      std::endl;
+  std::cerr << "  --repeat=<n>" << std::endl;
+  std::cerr << "    The number of times to time each operation, reporting " \
+      "the fastest (default 3)." << std::endl;
+  std::cerr << "  --dir=<path>" << std::endl;
+  std::cerr << "    The directory to write the inputs to (default .)." << \
+      std::endl;
+  std::cerr << "  --formats=<name>[,<name>...]" << std::endl;
+  std::cerr << "    The formats to benchmark (default all): csr, metis, " \
+      "mm, mm-symmetric, snap, snap-undirected, vector." << std::endl;
+  std::cerr << "  --backends=<name>[,<name>...]" << std::endl;
+  std::cerr << "    The read backends to time reads with (default all): " \
+      "buffered, mmap, async." << std::endl;
+  std::cerr << "  --cache=<state>[,<state>...]" << std::endl;
+  std::cerr << "    The page cache states to time reads in (default both): " \
+      "warm, cold (the" << std::endl;
+  std::cerr << "    input is dropped from the page cache before each read)." \
+      << std::endl;
+  std::cerr << "  --keep" << std::endl;
+  std::cerr << "    Keep the generated inputs." << std::endl;
+}
+
+
+bool parseOptions(
+    int const argc,
+    char ** const argv,
+    options_struct * const options)
+{
+  for (int i = 1; i < argc; ++i) {
+    std::string const arg(argv[i]);
+    size_t const eq = arg.find('=');
+    std::string const key = arg.substr(0, eq);
+    std::string const value = eq == std::string::npos ? std::string() : \
+        arg.substr(eq+1);
+
+    if (key == "--rows") {
+      options->rows = static_cast<wildriver_dim_t>(std::stoull(value));
+    } else if (key == "--degree") {
+      options->degree = static_cast<wildriver_ind_t>(std::stoull(value));
+    } else if (key == "--seed") {
+      options->seed = std::stoull(value);
+    } else if (key == "--repeat") {
+      options->repeat = std::max(std::stoi(value), 1);
+    } else if (key == "--dir") {
+      options->dir = value;
+    } else if (key == "--formats") {
+      options->formats = splitList(value);
+    } else if (key == "--backends") {
+      options->backends = splitList(value);
+      for (std::string const & backend : options->backends) {
+        if (findBackend(backend) < 0) {
+          return false;
+        }
+      }
+    } else if (key == "--cache") {
+      options->caches = splitList(value);
+      for (std::string const & cache : options->caches) {
+        if (cache != "warm" && cache != "cold") {
+          return false;
+        }
+      }
+    } else if (key == "--keep") {
+      options->keep = true;
+    } else {
+      return false;
+    }
+  }
+
+  return options->rows > 0 && !options->backends.empty() && \
+      !options->caches.empty();
+}
+
+
+/**
+* @brief Generate a square matrix with uniformly random columns and values.
+*
+* @param nrows The number of rows.
+* @param degree The number of entries to draw for each row (duplicates are
+* dropped).
+* @param seed The seed.
+*
+* @return The matrix.
+*/
+matrix_struct generateGeneral(
+    wildriver_dim_t const nrows,
+    wildriver_ind_t const degree,
+    uint64_t const seed)
+{
+  std::mt19937_64 rng(seed);
+  std::uniform_int_distribution<wildriver_dim_t> column(0, nrows-1);
+  std::uniform_real_distribution<wildriver_val_t> value(0, 1);
+
+  matrix_struct matrix;
+  matrix.nrows = nrows;
+
+  std::vector<wildriver_dim_t> row;
+  for (wildriver_dim_t i = 0; i < nrows; ++i) {
+    row.clear();
+    for (wildriver_ind_t j = 0; j < degree; ++j) {
+      row.emplace_back(column(rng));
+    }
+    std::sort(row.begin(), row.end());
+    row.erase(std::unique(row.begin(), row.end()), row.end());
+
+    for (wildriver_dim_t const col : row) {
+      matrix.rowind.emplace_back(col);
+      matrix.rowval.emplace_back(value(rng));
+    }
+    matrix.rowptr.emplace_back(matrix.rowind.size());
+  }
+
+  return matrix;
+}
+
+
+/**
+* @brief Generate a symmetric matrix with no diagonal, uniformly random
+* neighbors, and small integer weights (so that it is also a valid weighted
+* graph).
+*
+* @param nrows The number of rows.
+* @param degree The average number of entries per row.
+* @param seed The seed.
+*
+* @return The matrix.
+*/
+matrix_struct generateSymmetric(
+    wildriver_dim_t const nrows,
+    wildriver_ind_t const degree,
+    uint64_t const seed)
+{
+  std::mt19937_64 rng(seed);
+  std::uniform_int_distribution<wildriver_dim_t> column(0, nrows-1);
+  std::uniform_int_distribution<int> weight(1, 9);
+
+  // draw half of the entries, each being mirrored
+  std::vector<std::vector<std::pair<wildriver_dim_t, int>>> rows(nrows);
+  for (wildriver_dim_t i = 0; i < nrows; ++i) {
+    for (wildriver_ind_t j = 0; j < degree / 2; ++j) {
+      wildriver_dim_t const col = column(rng);
+      if (col != i) {
+        int const w = weight(rng);
+        rows[i].emplace_back(col, w);
+        rows[col].emplace_back(i, w);
+      }
+    }
+  }
+
+  matrix_struct matrix;
+  matrix.nrows = nrows;
+  for (std::vector<std::pair<wildriver_dim_t, int>> & row : rows) {
+    // keeping the lightest of duplicate entries keeps the matrix symmetric
+    std::sort(row.begin(), row.end());
+    for (size_t j = 0; j < row.size(); ++j) {
+      if (j == 0 || row[j].first != row[j-1].first) {
+        matrix.rowind.emplace_back(row[j].first);
+        matrix.rowval.emplace_back(row[j].second);
+      }
+    }
+    matrix.rowptr.emplace_back(matrix.rowind.size());
+    std::vector<std::pair<wildriver_dim_t, int>>().swap(row);
+  }
+
+  return matrix;
+}
+
+
+bool writeMatrix(
+    std::string const & fname,
+    matrix_struct const & matrix)
+{
+  return wildriver_write_matrix(fname.c_str(), matrix.nrows, matrix.nrows, \
+      matrix.rowind.size(), matrix.rowptr.data(), matrix.rowind.data(), \
+      matrix.rowval.data()) == 1;
+}
+
+
+bool writeGraph(
+    std::string const & fname,
+    matrix_struct const & matrix)
+{
+  return wildriver_write_graph(fname.c_str(), matrix.nrows, \
+      matrix.rowind.size(), 0, matrix.rowptr.data(), matrix.rowind.data(), \
+      nullptr, matrix.rowval.data()) == 1;
+}
+
+
+bool writeUnweightedGraph(
+    std::string const & fname,
+    matrix_struct const & matrix)
+{
+  return wildriver_write_graph(fname.c_str(), matrix.nrows, \
+      matrix.rowind.size(), 0, matrix.rowptr.data(), matrix.rowind.data(), \
+      nullptr, nullptr) == 1;
+}
+
+
+/**
+* @brief Write the lower triangle of a symmetric matrix as a MatrixMarket
+* file.
+*
+* @param fname The filename/path.
+* @param matrix The matrix.
+*
+* @return True if the file was written.
+*/
+bool writeSymmetricMatrixMarket(
+    std::string const & fname,
+    matrix_struct const & matrix)
+{
+  std::ofstream stream(fname);
+
+  stream << "%%MatrixMarket matrix coordinate real symmetric\n";
+  stream << matrix.nrows << " " << matrix.nrows << " " << \
+      matrix.rowind.size() / 2 << "\n";
+  for (wildriver_dim_t i = 0; i < matrix.nrows; ++i) {
+    for (wildriver_ind_t j = matrix.rowptr[i]; j < matrix.rowptr[i+1]; ++j) {
+      if (matrix.rowind[j] < i) {
+        stream << (i+1) << " " << (matrix.rowind[j]+1) << " " << \
+            matrix.rowval[j] << "\n";
+      }
+    }
+  }
+
+  return static_cast<bool>(stream);
+}
+
+
+/**
+* @brief Write a symmetric matrix as an undirected SNAP graph, with each edge
+* saved once.
+*
+* @param fname The filename/path.
+* @param matrix The matrix.
+*
+* @return True if the file was written.
+*/
+bool writeUndirectedSNAP(
+    std::string const & fname,
+    matrix_struct const & matrix)
+{
+  std::ofstream stream(fname);
+
+  stream << "# Undirected graph (each unordered pair of nodes is saved " \
+      "once): " << fname << "\n";
+  stream << "# A graph.\n";
+  stream << "# Nodes: " << matrix.nrows << " Edges: " << \
+      matrix.rowind.size() / 2 << "\n";
+  stream << "# FromNodeId\tToNodeId\n";
+  for (wildriver_dim_t i = 0; i < matrix.nrows; ++i) {
+    for (wildriver_ind_t j = matrix.rowptr[i]; j < matrix.rowptr[i+1]; ++j) {
+      if (matrix.rowind[j] < i) {
+        stream << i << "\t" << matrix.rowind[j] << "\n";
+      }
+    }
+  }
+
+  return static_cast<bool>(stream);
+}
+
+
+bool readMatrix(
+    std::string const & fname,
+    size_t * const entries)
+{
+  wildriver_dim_t nrows, ncols;
+  wildriver_ind_t nnz;
+  wildriver_ind_t * rowptr;
+  wildriver_dim_t * rowind;
+  wildriver_val_t * rowval;
+  if (wildriver_read_matrix(fname.c_str(), &nrows, &ncols, &nnz, &rowptr, \
+      &rowind, &rowval) != 1) {
+    return false;
+  }
+
+  free(rowptr);
+  free(rowind);
+  free(rowval);
+
+  *entries = nnz;
+
+  return true;
+}
+
+
+bool writeVector(
+    std::string const & fname,
+    std::vector<wildriver_val_t> const & vals)
+{
+  wildriver_vector_handle * const handle = \
+      wildriver_open_vector(fname.c_str(), WILDRIVER_OUT);
+  if (handle == nullptr) {
+    return false;
+  }
+
+  handle->size = vals.size();
+  int const rv = wildriver_save_vector(handle, vals.data(), nullptr);
+  wildriver_close_vector(handle);
+
+  return rv == 1;
+}
+
+
+bool readVector(
+    std::string const & fname,
+    size_t * const entries)
+{
+  wildriver_vector_handle * const handle = \
+      wildriver_open_vector(fname.c_str(), WILDRIVER_IN);
+  if (handle == nullptr) {
+    return false;
+  }
+
+  wildriver_val_t * const vals = static_cast<wildriver_val_t*>( \
+      malloc(sizeof(wildriver_val_t)*handle->size));
+  int const rv = wildriver_load_vector(handle, vals, nullptr);
+  *entries = handle->size;
+
+  free(vals);
+  wildriver_close_vector(handle);
+
+  return rv == 1;
+}
+
+
+size_t getFileSize(
+    std::string const & fname)
+{
+  struct stat info;
+  if (stat(fname.c_str(), &info) != 0) {
+    return 0;
+  }
+
+  return static_cast<size_t>(info.st_size);
+}
+
+
+/**
+* @brief Drop a file from the page cache, so that reading it reads the
+* device.
+*
+* @param fname The filename/path.
+*
+* @return True if it was dropped.
+*/
+bool dropCache(
+    std::string const & fname)
+{
+  int const fd = open(fname.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  // dirty pages are not dropped
+  fdatasync(fd);
+  int const rv = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+  close(fd);
+
+  return rv == 0;
+}
+
+
+/**
+* @brief Read a file into the page cache.
+*
+* @param fname The filename/path.
+*
+* @return True if it was read.
+*/
+bool warmCache(
+    std::string const & fname)
+{
+  std::ifstream stream(fname, std::ifstream::binary);
+  std::vector<char> buffer(1024*1024);
+  while (stream.read(buffer.data(), buffer.size()) || stream.gcount() > 0) {
+    // only the reading matters
+  }
+
+  return stream.eof();
+}
+
+
+/**
+* @brief Reset the peak resident set size of the process to its current
+* size, so that the next operation can be measured on its own.
+*
+* @return True if it was reset.
+*/
+bool resetPeakRss()
+{
+  std::ofstream stream("/proc/self/clear_refs");
+  stream << "5" << std::endl;
+
+  return static_cast<bool>(stream);
+}
+
+
+/**
+* @brief Get the peak resident set size of the process.
+*
+* @return The size in bytes.
+*/
+size_t getPeakRss()
+{
+  std::ifstream stream("/proc/self/status");
+  std::string line;
+  while (std::getline(stream, line)) {
+    if (line.compare(0, 6, "VmHWM:") == 0) {
+      return static_cast<size_t>(std::stoull(line.substr(6)))*1024;
+    }
+  }
+
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+
+  return static_cast<size_t>(usage.ru_maxrss)*1024;
+}
+
+
+/**
+* @brief Time an operation several times, keeping the fastest.
+*
+* @param repeat The number of times to run the operation.
+* @param func The operation.
+* @param result The result to record the time and peak memory in.
+* @param prepare What to do before each run, untimed (may be empty).
+*
+* @return True if the operation (and its preparation) succeeded every time.
+*/
+bool measure(
+    int const repeat,
+    std::function<bool()> const & func,
+    result_struct * const result,
+    std::function<bool()> const & prepare = nullptr)
+{
+  result->seconds = 0;
+  result->peakRss = 0;
+  for (int r = 0; r < repeat; ++r) {
+    if (prepare && !prepare()) {
+      return false;
+    }
+    resetPeakRss();
+
+    std::chrono::steady_clock::time_point const start = \
+        std::chrono::steady_clock::now();
+    if (!func()) {
+      return false;
+    }
+    double const seconds = std::chrono::duration<double>( \
+        std::chrono::steady_clock::now() - start).count();
+
+    if (r == 0 || seconds < result->seconds) {
+      result->seconds = seconds;
+    }
+    result->peakRss = std::max(result->peakRss, getPeakRss());
+  }
+
+  return true;
+}
+
+
+void printResult(
+    result_struct const & result,
+    bool const last)
+{
+  double const seconds = std::max(result.seconds, 1.0e-9);
+
+  std::string source;
+  if (!result.backend.empty()) {
+    source = "\"backend\": \"" + result.backend + "\", \"cache\": \"" + \
+        result.cache + "\", ";
+  }
+
+  std::printf("    {\"format\": \"%s\", \"operation\": \"%s\", %s" \
+      "\"bytes\": %zu, \"entries\": %zu, \"seconds\": %.6f, " \
+      "\"mb_per_second\": %.3f, \"entries_per_second\": %.1f, " \
+      "\"peak_rss_bytes\": %zu}%s\n", result.format.c_str(), \
+      result.operation.c_str(), source.c_str(), result.bytes, \
+      result.entries, result.seconds, (result.bytes / 1.0e6) / seconds, \
+      result.entries / seconds, result.peakRss, last ? "" : ",");
+}
+
+
+/**
+* @brief Benchmark reading a file with each of the selected read backends,
+* with the file in and out of the page cache.
+*
+* @param format The name of the format.
+* @param fname The filename/path.
+* @param options The benchmark options.
+* @param read The read, which outputs the number of entries read.
+* @param results The results (output).
+*
+* @return True if the benchmark succeeded.
+*/
+bool benchRead(
+    std::string const & format,
+    std::string const & fname,
+    options_struct const & options,
+    std::function<bool(size_t*)> const & read,
+    std::vector<result_struct> * const results)
+{
+  int const previous = wildriver_get_read_backend();
+
+  for (std::string const & backend : options.backends) {
+    wildriver_set_read_backend(findBackend(backend));
+    for (std::string const & cache : options.caches) {
+      result_struct result;
+      result.format = format;
+      result.operation = "read";
+      result.backend = backend;
+      result.cache = cache;
+      result.bytes = getFileSize(fname);
+
+      std::function<bool()> const prepare = [&fname, &cache]() {
+        return cache == "cold" ? dropCache(fname) : warmCache(fname);
+      };
+      if (!measure(options.repeat, [&read, &result]() {
+            return read(&result.entries);
+          }, &result, prepare)) {
+        std::cerr << "ERROR: failed to read '" << fname << "' with the " << \
+            backend << " backend" << std::endl;
+        wildriver_set_read_backend(previous);
+        return false;
+      }
+      results->emplace_back(result);
+    }
+  }
+
+  wildriver_set_read_backend(previous);
+
+  return true;
+}
+
+
+/**
+* @brief Benchmark writing (if the library writes it) and then reading a
+* format.
+*
+* @param format The format.
+* @param options The benchmark options.
+* @param results The results (output).
+*
+* @return True if the benchmark succeeded.
+*/
+bool benchFormat(
+    format_struct const & format,
+    options_struct const & options,
+    std::vector<result_struct> * const results)
+{
+  std::string const fname = options.dir + "/wildriver_bench." + \
+      format.name + format.extension;
+
+  result_struct write;
+  write.format = format.name;
+  write.operation = "write";
+
+  {
+    matrix_struct const matrix = format.symmetric ? \
+        generateSymmetric(options.rows, options.degree, options.seed) : \
+        generateGeneral(options.rows, options.degree, options.seed);
+    write.entries = matrix.rowind.size();
+
+    if (format.timed) {
+      if (!measure(options.repeat, [&format, &fname, &matrix]() {
+            return format.write(fname, matrix);
+          }, &write)) {
+        std::cerr << "ERROR: failed to write '" << fname << "'" << std::endl;
+        return false;
+      }
+    } else if (!format.write(fname, matrix)) {
+      std::cerr << "ERROR: failed to generate '" << fname << "'" << \
+          std::endl;
+      return false;
+    }
+  }
+  write.bytes = getFileSize(fname);
+  if (format.timed) {
+    results->emplace_back(write);
+  }
+
+  if (!benchRead(format.name, fname, options, [&fname](size_t * entries) {
+        return readMatrix(fname, entries);
+      }, results)) {
+    return false;
+  }
+
+  if (!options.keep) {
+    std::remove(fname.c_str());
+  }
+
+  return true;
+}
+
+
+bool benchVector(
+    options_struct const & options,
+    std::vector<result_struct> * const results)
+{
+  std::string const fname = options.dir + "/wildriver_bench.vector.txt";
+
+  result_struct write;
+  write.format = "vector";
+  write.operation = "write";
+
+  {
+    std::mt19937_64 rng(options.seed);
+    std::uniform_real_distribution<wildriver_val_t> value(0, 1);
+    std::vector<wildriver_val_t> vals(options.rows);
+    for (wildriver_val_t & val : vals) {
+      val = value(rng);
+    }
+    write.entries = vals.size();
+
+    if (!measure(options.repeat, [&fname, &vals]() {
+          return writeVector(fname, vals);
+        }, &write)) {
+      std::cerr << "ERROR: failed to write '" << fname << "'" << std::endl;
+      return false;
+    }
+  }
+  write.bytes = getFileSize(fname);
+  results->emplace_back(write);
+
+  if (!benchRead("vector", fname, options, [&fname](size_t * entries) {
+        return readVector(fname, entries);
+      }, results)) {
+    return false;
+  }
+
+  if (!options.keep) {
+    std::remove(fname.c_str());
+  }
+
+  return true;
+}
+
+
+bool selected(
+    options_struct const & options,
+    std::string const & name)
+{
+  return options.formats.empty() || std::find(options.formats.begin(), \
+      options.formats.end(), name) != options.formats.end();
+}
+
+
+}
+
+
+
+
+/******************************************************************************
+* MAIN ************************************************************************
+******************************************************************************/
+
+
+int main(
+    int argc,
+    char ** argv)
+{
+  options_struct options;
+  try {
+    if (!parseOptions(argc, argv, &options)) {
+      usage(argv[0]);
+      return 1;
+    }
+  } catch (std::exception const &) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  format_struct const formats[] = {
+    {"csr", ".csr", false, writeMatrix, true},
+    {"metis", ".graph", true, writeGraph, true},
+    {"mm", ".mtx", false, writeMatrix, true},
+    {"mm-symmetric", ".mtx", true, writeSymmetricMatrixMarket, false},
+    {"snap", ".snap", false, writeUnweightedGraph, true},
+    {"snap-undirected", ".snap", true, writeUndirectedSNAP, false}
+  };
+
+  std::vector<result_struct> results;
+  for (format_struct const & format : formats) {
+    if (selected(options, format.name)) {
+      std::cerr << "Benchmarking " << format.name << "..." << std::endl;
+      if (!benchFormat(format, options, &results)) {
+        return 1;
+      }
+    }
+  }
+  if (selected(options, "vector")) {
+    std::cerr << "Benchmarking vector..." << std::endl;
+    if (!benchVector(options, &results)) {
+      return 1;
+    }
+  }
+
+  bool const rssReset = resetPeakRss();
+
+  std::printf("{\n");
+  std::printf("  \"version\": \"%d.%d.%d\",\n", WILDRIVER_VER_MAJOR, \
+      WILDRIVER_VER_MINOR, WILDRIVER_VER_SUBMINOR);
+  std::printf("  \"rows\": %zu,\n", static_cast<size_t>(options.rows));
+  std::printf("  \"degree\": %zu,\n", static_cast<size_t>(options.degree));
+  std::printf("  \"seed\": %llu,\n", \
+      static_cast<unsigned long long>(options.seed));
+  std::printf("  \"repeat\": %d,\n", options.repeat);
+  std::printf("  \"threads\": %d,\n", wildriver_get_num_threads());
+  std::printf("  \"peak_rss_per_operation\": %s,\n", \
+      rssReset ? "true" : "false");
+  std::printf("  \"results\": [\n");
+  for (size_t i = 0; i < results.size(); ++i) {
+    printResult(results[i], i+1 == results.size());
+  }
+  std::printf("  ]\n");
+  std::printf("}\n");
+
+  return 0;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file convert.c
+ * @brief Example of using WildRiver to convert a matrix between formats.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-02
+ */
+
+
+
+
+#include <stdio.h>
+#include "wildriver.h"
+
+
+
+
+int main(
+  int argc,
+  char ** argv)
+{
+  int s;
+  wildriver_stage_stats stats[WILDRIVER_NUM_STAGES];
+  char const * const names[WILDRIVER_NUM_STAGES] = {
+    "read", "parse", "transform", "format", "write"
+  };
+
+  if (argc != 3) {
+    printf("Must supply an input and an output matrix/graph file.\n");
+    return 1;
+  }
+
+  if (!wildriver_convert_matrix(argv[1], argv[2], NULL, stats)) {
+    printf("Failed to convert '%s'.\n", argv[1]);
+    return 1;
+  }
+
+  printf("%-10s %8s %12s %10s %10s %10s\n", "stage", "threads", "bytes", \
+      "busy(s)", "wait(s)", "MB/s");
+  for (s = 0; s < WILDRIVER_NUM_STAGES; ++s) {
+    printf("%-10s %8d %12zu %10.3f %10.3f %10.2f\n", names[s], \
+        stats[s].nthreads, stats[s].bytes, stats[s].busy, stats[s].wait, \
+        stats[s].mbps);
+  }
+
+  return 0;
+}
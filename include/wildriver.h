@@ -29,6 +29,8 @@
 #define WILDRIVER_VER_MINOR 0
 #define WILDRIVER_VER_SUBMINOR 0
 
+#define WILDRIVER_ERROR_SIZE 256
+
 
 
 
@@ -60,6 +62,8 @@ typedef struct {
   wildriver_dim_t nrows;
   wildriver_dim_t ncols;
   wildriver_ind_t nnz;
+  /* the peak temporary memory loading is expected to need (in bytes) */
+  size_t temporary_bytes;
   void * fd;
 } wildriver_matrix_handle;
 
@@ -70,6 +74,8 @@ typedef struct {
   wildriver_ind_t nedges;
   int nvwgt;
   int ewgt;
+  /* the peak temporary memory loading is expected to need (in bytes) */
+  size_t temporary_bytes;
   void * fd;
 } wildriver_graph_handle;
 
@@ -81,6 +87,79 @@ typedef struct {
 } wildriver_vector_handle;
 
 
+typedef struct {
+  wildriver_dim_t nrows;
+  wildriver_dim_t ncols;
+  wildriver_ind_t nnz;
+  /* the index of the first row of the next batch */
+  wildriver_dim_t row;
+  void * fd;
+} wildriver_row_stream;
+
+
+typedef struct {
+  /* the kind of load (WILDRIVER_ASYNC_MATRIX or WILDRIVER_ASYNC_GRAPH) */
+  int kind;
+  void * fd;
+} wildriver_async;
+
+
+typedef struct {
+  void * fd;
+} wildriver_cancel_token;
+
+
+typedef struct {
+  /* the filename/path of the matrix file (input) */
+  char const * fname;
+  /* the loaded matrix, allocated as by wildriver_read_matrix() (output) */
+  wildriver_dim_t nrows;
+  wildriver_dim_t ncols;
+  wildriver_ind_t nnz;
+  wildriver_ind_t * rowptr;
+  wildriver_dim_t * rowind;
+  wildriver_val_t * rowval;
+  /* WILDRIVER_SUCCESS or WILDRIVER_ERROR (output) */
+  int status;
+  /* the reason the load failed (output) */
+  char error[WILDRIVER_ERROR_SIZE];
+} wildriver_matrix_slot;
+
+
+typedef struct {
+  /* the filename/path of the vector file (input) */
+  char const * fname;
+  /* the loaded vector, allocated as by wildriver_read_matrix() (output) */
+  wildriver_ind_t size;
+  wildriver_val_t * vals;
+  /* WILDRIVER_SUCCESS or WILDRIVER_ERROR (output) */
+  int status;
+  /* the reason the load failed (output) */
+  char error[WILDRIVER_ERROR_SIZE];
+} wildriver_vector_slot;
+
+
+typedef struct {
+  /* the phase of the load (a wildriver_phase_t) */
+  int phase;
+  /* the number of bytes read from files, and the total size of the files */
+  size_t bytes;
+  size_t total_bytes;
+  /* the number of rows (or vertices) and entries (or edges) processed */
+  size_t rows;
+  size_t entries;
+  /* the seconds since the load started */
+  double seconds;
+  /* the rate of reading since the previous report (in MB/s) */
+  double mbps;
+} wildriver_progress;
+
+
+typedef struct {
+  void * fd;
+} wildriver_progress_monitor;
+
+
 enum wildriver_format_t {
   WILDRIVER_FORMAT_AUTO,
   WILDRIVER_FORMAT_METIS,
@@ -95,12 +174,251 @@ enum wildriver_format_t {
 };
 
 
+enum wildriver_type_t {
+  WILDRIVER_TYPE_U32,
+  WILDRIVER_TYPE_U64,
+  WILDRIVER_TYPE_I32,
+  WILDRIVER_TYPE_I64,
+  WILDRIVER_TYPE_F32,
+  WILDRIVER_TYPE_F64
+};
+
+
+enum wildriver_alloc_flag_t {
+  /* plain malloc() */
+  WILDRIVER_ALLOC_DEFAULT = 0,
+  /* zero the arrays in parallel from the library's thread pool, so that
+   * pages are spread across the NUMA nodes it runs on */
+  WILDRIVER_ALLOC_FIRST_TOUCH = 1,
+  /* align arrays of at least 2MB to huge pages and advise the use of
+   * transparent huge pages */
+  WILDRIVER_ALLOC_HUGE_PAGES = 2,
+  /* interleave pages across all online NUMA nodes */
+  WILDRIVER_ALLOC_INTERLEAVE = 4
+};
+
+
+enum wildriver_status_t {
+  /* waiting for a thread of the pool */
+  WILDRIVER_STATUS_PENDING,
+  /* being loaded */
+  WILDRIVER_STATUS_RUNNING,
+  /* loaded, the results can be taken */
+  WILDRIVER_STATUS_DONE,
+  /* the load failed */
+  WILDRIVER_STATUS_FAILED,
+  /* the load was cancelled */
+  WILDRIVER_STATUS_CANCELLED
+};
+
+
+enum wildriver_phase_t {
+  /* opening the file and reading its header */
+  WILDRIVER_PHASE_OPEN,
+  /* parsing the rows or entries of the file */
+  WILDRIVER_PHASE_READ,
+  /* assembling the parsed entries (e.g., sorting coordinates into rows) */
+  WILDRIVER_PHASE_BUILD,
+  /* writing the rows or entries to the file */
+  WILDRIVER_PHASE_WRITE,
+  WILDRIVER_PHASE_DONE
+};
+
+
+enum wildriver_error_t {
+  /* the deadline of the cancellation token passed */
+  WILDRIVER_ERROR_DEADLINE = -2,
+  /* the cancellation token was cancelled */
+  WILDRIVER_ERROR_CANCELLED = -1,
+  /* any other error */
+  WILDRIVER_ERROR = 0,
+  WILDRIVER_SUCCESS = 1
+};
+
+
+enum wildriver_async_kind_t {
+  WILDRIVER_ASYNC_MATRIX,
+  WILDRIVER_ASYNC_GRAPH
+};
+
+
 enum wildriver_mode_t {
   WILDRIVER_IN = 1,
   WILDRIVER_OUT = 2
 };
 
 
+enum wildriver_generator_t {
+  /* an R-MAT power-law graph */
+  WILDRIVER_GENERATOR_RMAT,
+  /* a uniformly random sparse matrix */
+  WILDRIVER_GENERATOR_UNIFORM,
+  /* a banded matrix with the stencil of a Laplacian */
+  WILDRIVER_GENERATOR_BANDED
+};
+
+
+enum wildriver_compression_t {
+  /* plain text */
+  WILDRIVER_COMPRESSION_NONE,
+  /* gzip, written as a BGZF file */
+  WILDRIVER_COMPRESSION_GZIP,
+  /* zstd, written as a zstd seekable file */
+  WILDRIVER_COMPRESSION_ZSTD
+};
+
+
+enum wildriver_read_backend_t {
+  /* buffered reads through the standard library */
+  WILDRIVER_READ_BUFFERED,
+  /* a memory mapping of the file */
+  WILDRIVER_READ_MMAP,
+  /* many large reads in flight with io_uring, or pread without it */
+  WILDRIVER_READ_ASYNC
+};
+
+
+enum wildriver_stage_t {
+  WILDRIVER_STAGE_READ,
+  WILDRIVER_STAGE_PARSE,
+  WILDRIVER_STAGE_TRANSFORM,
+  WILDRIVER_STAGE_FORMAT,
+  WILDRIVER_STAGE_WRITE,
+  WILDRIVER_NUM_STAGES
+};
+
+
+typedef struct {
+  /* the number of threads working in the stage */
+  int nthreads;
+  /* the number of chunks processed */
+  size_t chunks;
+  /* the number of bytes read, parsed, formatted, or written */
+  size_t bytes;
+  /* the number of rows and non-zeros handled */
+  size_t rows;
+  size_t nnz;
+  /* seconds spent working and blocked, summed over the stage's threads */
+  double busy;
+  double wait;
+  /* the throughput of the whole stage while working: bytes processed per
+   * second of busy time averaged over its threads (in MB/s) */
+  double mbps;
+} wildriver_stage_stats;
+
+
+typedef struct {
+  /* the seconds spent in each phase (indexed by wildriver_phase_t) */
+  double phase_seconds[WILDRIVER_PHASE_DONE];
+  /* the seconds the whole operation took */
+  double seconds;
+  /* the number of bytes read or written */
+  size_t bytes;
+  /* the number of lines read or written, and of the lines read which were
+   * skipped as comments */
+  size_t lines;
+  size_t comment_lines;
+  /* the number of rows (or vertices) and entries (or edges) processed */
+  size_t rows;
+  size_t entries;
+  /* the number of arrays allocated, and the most memory held at once in
+   * temporary arrays (in bytes) */
+  size_t allocations;
+  size_t peak_temporary_bytes;
+} wildriver_stats;
+
+
+typedef struct {
+  /* the number of threads for each of the parse and format stages (0 for
+   * the number of threads set by wildriver_set_num_threads()) */
+  int nthreads;
+  /* the size of the byte chunks read from the input (0 for the default) */
+  size_t chunk_size;
+  /* the number of chunks each queue between stages holds (0 for the
+   * default) */
+  size_t queue_depth;
+  /* whether or not to symmetrize the matrix -- this holds the whole matrix
+   * in memory */
+  int symmetrize;
+  /* new labels for columns, such that column i becomes labels[i] (may be
+   * NULL) */
+  wildriver_dim_t const * labels;
+  wildriver_dim_t nlabels;
+  /* a function returning 0 for entries which should be removed (may be
+   * NULL) */
+  int (*filter)(
+      wildriver_dim_t row,
+      wildriver_dim_t col,
+      wildriver_val_t val,
+      void * ctx);
+  void * filter_ctx;
+} wildriver_convert_options;
+
+
+typedef struct {
+  /* the directory to store sorted runs in (NULL for $TMPDIR or /tmp) */
+  char const * tmpdir;
+  /* the number of bytes of entries to hold in memory (0 for the default) */
+  size_t memory_budget;
+  /* the function to pass each row to, in order, when no output file is
+   * given (may be NULL) */
+  void (*row_callback)(
+      wildriver_dim_t row,
+      wildriver_dim_t nnz,
+      wildriver_dim_t const * columns,
+      wildriver_val_t const * values,
+      void * ctx);
+  void * row_ctx;
+  /* the number of runs spilled to disk (output) */
+  size_t nruns;
+} wildriver_external_options;
+
+
+typedef struct {
+  /* the kind of matrix to generate (a wildriver_generator_t) */
+  int kind;
+  /* the dimensions of the matrix */
+  wildriver_dim_t nrows;
+  wildriver_dim_t ncols;
+  /* the number of entries to draw for random matrices -- duplicates are
+   * merged, and mirrored entries of symmetric matrices are extra */
+  wildriver_ind_t nnz;
+  /* the R-MAT probabilities of the top left, top right, and bottom left
+   * quadrants (the bottom right gets the remainder) */
+  double a;
+  double b;
+  double c;
+  /* the number of entries on each side of the diagonal of banded matrices */
+  wildriver_dim_t bandwidth;
+  /* whether or not to mirror entries across the diagonal (required for
+   * METIS files) */
+  int symmetric;
+  /* whether or not to write random values (graph files are unweighted) */
+  int values;
+  /* the seed of the random streams, which alone determines the output */
+  uint64_t seed;
+  /* the number of entries written (output) */
+  wildriver_ind_t nnz_written;
+} wildriver_generator_options;
+
+
+typedef struct {
+  /* allocate the given number of bytes aligned to alignment (a power of
+   * two), returning NULL on failure */
+  void * (*alloc)(
+      size_t bytes,
+      size_t alignment,
+      void * ctx);
+  /* release memory returned by alloc */
+  void (*free)(
+      void * ptr,
+      size_t bytes,
+      void * ctx);
+  /* the context passed to alloc and free */
+  void * ctx;
+} wildriver_allocator;
+
+
 
 /******************************************************************************
 * FUNCTION PROTOTYPES *********************************************************
@@ -133,7 +451,8 @@ wildriver_matrix_handle * wildriver_open_matrix(
  * nrows+1).
  * @param rowind The column indices for entries in each row (must be of length
  * nnz)).
- * @param rowval The value of the entries in each row (must be of length nnz).
+ * @param rowval The value of the entries in each row (must be of length nnz,
+ * or NULL to load only the pattern without parsing values).
  * @param progress A variable to update as the matrix is loaded (will start at
  * 0 and go to 1.0 when the matrix is fully loaded). This may be null if
  * progress tracking is not required.
@@ -148,6 +467,66 @@ int wildriver_load_matrix(
     double * progress);
 
 
+/**
+ * @brief Load the matrix in CSC form (the CSR form of its transpose) into the
+ * given memory locations. MatrixMarket files are bucketed by column directly
+ * from their triplets, other formats are transposed in parallel after
+ * loading.
+ *
+ * @param handle The pointer to the open matrix.
+ * @param colptr The the starting index for each column (must be of length
+ * ncols+1).
+ * @param colind The row indices for entries in each column (must be of length
+ * nnz).
+ * @param colval The value of the entries in each column (must be of length
+ * nnz, or NULL).
+ * @param progress A variable to update as the matrix is loaded (may be
+ * NULL).
+ *
+ * @return 1 on success, 0 if an error occurs while loading.
+ */
+int wildriver_load_matrix_csc(
+    wildriver_matrix_handle * handle,
+    wildriver_ind_t * colptr,
+    wildriver_dim_t * colind,
+    wildriver_val_t * colval,
+    double * progress);
+
+
+/**
+ * @brief Load the matrix in both CSR and CSC form into the given memory
+ * locations. The CSC form is built from the CSR form with a parallel
+ * transpose.
+ *
+ * @param handle The pointer to the open matrix.
+ * @param rowptr The the starting index for each row (must be of length
+ * nrows+1).
+ * @param rowind The column indices for entries in each row (must be of length
+ * nnz).
+ * @param rowval The value of the entries in each row (must be of length nnz,
+ * or NULL).
+ * @param colptr The the starting index for each column (must be of length
+ * ncols+1).
+ * @param colind The row indices for entries in each column (must be of length
+ * nnz).
+ * @param colval The value of the entries in each column (must be of length
+ * nnz, or NULL).
+ * @param progress A variable to update as the matrix is loaded (may be
+ * NULL).
+ *
+ * @return 1 on success, 0 if an error occurs while loading.
+ */
+int wildriver_load_matrix_both(
+    wildriver_matrix_handle * handle,
+    wildriver_ind_t * rowptr,
+    wildriver_dim_t * rowind,
+    wildriver_val_t * rowval,
+    wildriver_ind_t * colptr,
+    wildriver_dim_t * colind,
+    wildriver_val_t * colval,
+    double * progress);
+
+
 /**
  * @brief Save the matrix after setting nrows, ncols, and nnz in the handle.
  *
@@ -171,6 +550,83 @@ int wildriver_save_matrix(
     double * progress);
 
 
+/**
+ * @brief Get the size in bytes of an element of the given type.
+ *
+ * @param type The type (a wildriver_type_t).
+ *
+ * @return The size, or 0 if the type is unknown.
+ */
+size_t wildriver_type_size(
+    int type);
+
+
+/**
+ * @brief Load the matrix into the given memory locations, using index,
+ * dimension, and value types chosen at runtime rather than the compile time
+ * wildriver_ind_t, wildriver_dim_t, and wildriver_val_t. CSR and BCSR files
+ * are parsed directly into the given types, and MatrixMarket and SNAP files
+ * are counted and then scattered, so that no copy of the matrix in the
+ * native types is made.
+ *
+ * @param handle The pointer to the open matrix.
+ * @param ind_type The type of rowptr (WILDRIVER_TYPE_U32 or
+ * WILDRIVER_TYPE_U64).
+ * @param dim_type The type of rowind (WILDRIVER_TYPE_U32 or
+ * WILDRIVER_TYPE_U64).
+ * @param val_type The type of rowval (WILDRIVER_TYPE_F32,
+ * WILDRIVER_TYPE_F64, WILDRIVER_TYPE_I32, or WILDRIVER_TYPE_I64).
+ * @param rowptr The the starting index for each row (must be of length
+ * nrows+1).
+ * @param rowind The column indices for entries in each row (must be of length
+ * nnz).
+ * @param rowval The value of the entries in each row (must be of length nnz,
+ * or NULL).
+ * @param progress A variable to update as the matrix is loaded (may be
+ * NULL).
+ *
+ * @return 1 on success, 0 if an error occurs while loading (including if the
+ * matrix is too large for the given types).
+ */
+int wildriver_load_matrix_typed(
+    wildriver_matrix_handle * handle,
+    int ind_type,
+    int dim_type,
+    int val_type,
+    void * rowptr,
+    void * rowind,
+    void * rowval,
+    double * progress);
+
+
+/**
+ * @brief Save the matrix after setting nrows, ncols, and nnz in the handle,
+ * using index, dimension, and value types chosen at runtime.
+ *
+ * @param handle The pointer to the open matrix.
+ * @param ind_type The type of rowptr.
+ * @param dim_type The type of rowind.
+ * @param val_type The type of rowval.
+ * @param rowptr The the starting index for each row (must be of length
+ * nrows+1).
+ * @param rowind The column indices for entries in each row (must be of length
+ * nnz).
+ * @param rowval The value of the entries in each row (must be of length nnz).
+ * @param progress A variable to update as the matrix is saved (may be NULL).
+ *
+ * @return 1 on success, 0 if an error occurs while saving.
+ */
+int wildriver_save_matrix_typed(
+    wildriver_matrix_handle * handle,
+    int ind_type,
+    int dim_type,
+    int val_type,
+    void const * rowptr,
+    void const * rowind,
+    void const * rowval,
+    double * progress);
+
+
 /**
  * @brief Close an open matrix.
  *
@@ -281,27 +737,168 @@ void wildriver_close_vector(
     wildriver_vector_handle * handle);
 
 
+/**
+ * @brief Open a matrix (or graph) for streaming its rows in order a batch at
+ * a time, so that memory use does not depend on the size of the file. Only
+ * CSR and METIS files can be streamed. The returned stream must be closed
+ * with wildriver_end_rows().
+ *
+ * @param fname The filename/path of the matrix file.
+ *
+ * @return The open stream, or NULL if there was an error.
+ */
+wildriver_row_stream * wildriver_begin_rows(
+    char const * fname);
+
 
-/******************************************************************************
-* DEPRECATED FUNCTIONS ********************************************************
-******************************************************************************/
+/**
+ * @brief Read the next batch of rows into the given buffers. A row which does
+ * not fit in the remaining space of the batch is returned in the next batch.
+ * The column indices are global, and the row pointer starts at 0 for each
+ * batch, with the first row of the batch given by stream->row before the
+ * call.
+ *
+ * @param stream The open stream.
+ * @param maxrows The maximum number of rows in the batch.
+ * @param maxnnz The maximum number of non-zeros in the batch.
+ * @param r_nrows The number of rows read (output, 0 once all rows have been
+ * read).
+ * @param rowptr The starting index for each row in the batch (must be of
+ * length at least maxrows+1).
+ * @param rowind The column indices for entries in each row (must be of
+ * length at least maxnnz).
+ * @param rowval The value of the entries in each row (must be of length at
+ * least maxnnz, or NULL to ignore values).
+ *
+ * @return 1 on success, 0 if an error occurs (including when a single row has
+ * more than maxnnz non-zeros, in which case the call can be repeated with
+ * larger buffers).
+ */
+int wildriver_next_rows(
+    wildriver_row_stream * stream,
+    wildriver_dim_t maxrows,
+    wildriver_ind_t maxnnz,
+    wildriver_dim_t * r_nrows,
+    wildriver_ind_t * rowptr,
+    wildriver_dim_t * rowind,
+    wildriver_val_t * rowval);
 
 
 /**
- * @brief Read a matrix from the given path into a CSR data-structure.
+ * @brief Close a row stream.
+ *
+ * @param stream The open stream.
+ */
+void wildriver_end_rows(
+    wildriver_row_stream * stream);
+
+
+/**
+ * @brief Start loading a matrix in the background, on a pool of threads
+ * managed by the library. The load must be released with
+ * wildriver_async_free().
  *
  * @param fname The filename/path of the matrix file.
+ * @param callback The function to call from the loading thread once the load
+ * has completed, with its final status (may be NULL). The results may be
+ * taken from within the callback, but the load must not be freed there.
+ * @param ctx The context passed to the callback.
+ *
+ * @return The pending load, or NULL if it could not be started.
+ */
+wildriver_async * wildriver_read_matrix_async(
+    char const * fname,
+    void (*callback)(
+        wildriver_async * async,
+        int status,
+        void * ctx),
+    void * ctx);
+
+
+/**
+ * @brief Start loading a graph in the background (see
+ * wildriver_read_matrix_async()).
+ *
+ * @param fname The filename/path of the graph file.
+ * @param callback The function to call once the load has completed (may be
+ * NULL).
+ * @param ctx The context passed to the callback.
+ *
+ * @return The pending load, or NULL if it could not be started.
+ */
+wildriver_async * wildriver_read_graph_async(
+    char const * fname,
+    void (*callback)(
+        wildriver_async * async,
+        int status,
+        void * ctx),
+    void * ctx);
+
+
+/**
+ * @brief Request that a load stop. The load checks for this between chunks
+ * of the file, and then completes with the status WILDRIVER_STATUS_CANCELLED
+ * and releases its memory.
+ *
+ * @param async The load.
+ */
+void wildriver_async_cancel(
+    wildriver_async * async);
+
+
+/**
+ * @brief Get the progress of a load without blocking.
+ *
+ * @param async The load.
+ * @param r_progress The progress (output).
+ */
+void wildriver_async_get_progress(
+    wildriver_async const * async,
+    wildriver_progress * r_progress);
+
+
+/**
+ * @brief Get the status of a load without blocking.
+ *
+ * @param async The load.
+ *
+ * @return The status (a wildriver_status_t).
+ */
+int wildriver_async_status(
+    wildriver_async const * async);
+
+
+/**
+ * @brief Block until a load has completed and its callback has returned.
+ *
+ * @param async The load.
+ *
+ * @return The final status (WILDRIVER_STATUS_DONE, WILDRIVER_STATUS_FAILED,
+ * or WILDRIVER_STATUS_CANCELLED).
+ */
+int wildriver_async_wait(
+    wildriver_async * async);
+
+
+/**
+ * @brief Take the matrix of a load started with
+ * wildriver_read_matrix_async(), blocking until it has been loaded. The
+ * arrays are allocated as by wildriver_read_matrix(), and become owned by
+ * the caller. They can only be taken once.
+ *
+ * @param async The load.
  * @param r_nrows The number of rows in the matrix (output).
  * @param r_ncols The number of columns in the matrix (output).
  * @param r_nnz The number of non-zeros in the matrix (output).
  * @param r_rowptr The the starting index for each row (output).
  * @param r_rowind The column indices for entries in each row (output).
- * @param r_rowval The value of the entries in each row (output).
+ * @param r_rowval The value of the entries in each row (output, optional).
  *
- * @return 1 on success, 0 otherwise.
+ * @return 1 on success, 0 if the load failed or the matrix has already been
+ * taken.
  */
-int wildriver_read_matrix(
-    char const * fname,
+int wildriver_async_get_matrix(
+    wildriver_async * async,
     wildriver_dim_t * r_nrows,
     wildriver_dim_t * r_ncols,
     wildriver_ind_t * r_nnz,
@@ -311,32 +908,10 @@ int wildriver_read_matrix(
 
 
 /**
- * @brief Write a matrix file to the given path from a CSR data-structure.
- *
- * @param fname The filename/path of the matrix file.
- * @param nrows The number of rows in the matrix.
- * @param ncols The number of columns in the matrix.
- * @param nnz The number of non-zeros in the matrix.
- * @param rowptr The starting index for each row.
- * @param rowind The column indices for entries in each row.
- * @param rowval The value of the entries in each row.
- *
- * @return 1 on success, 0 otherwise.
- */
-int wildriver_write_matrix(
-    char const * fname,
-    wildriver_dim_t nrows,
-    wildriver_dim_t ncols,
-    wildriver_ind_t nnz,
-    wildriver_ind_t const * rowptr,
-    wildriver_dim_t const * rowind,
-    wildriver_val_t const * rowval);
-
-
-/**
- * @brief Read a graph from the given path into a CSR data-structure.
+ * @brief Take the graph of a load started with wildriver_read_graph_async()
+ * (see wildriver_async_get_matrix()).
  *
- * @param fname The filename/path of the graph file.
+ * @param async The load.
  * @param r_nvtxs The number of vertices in the graph (output).
  * @param r_nedges The number of edges in the graph (output, optional).
  * @param r_nvwgts The number of vertex weights in the graph (output,
@@ -345,8 +920,762 @@ int wildriver_write_matrix(
  * (output, optional).
  * @param r_xadj The adjacency list pointer (output).
  * @param r_adjncy The adjacency list (output).
- * @param r_vwgt The vertex weights (output, optional).
- * @param r_adjwgt The edge weights (output, optional).
+ * @param r_vwgt The vertex weights (output, optional). This is set to NULL
+ * if the graph does not have vertex weights.
+ * @param r_adjwgt The edge weights (output, optional). This is set to NULL
+ * if the graph does not have edge weights.
+ *
+ * @return 1 on success, 0 if the load failed or the graph has already been
+ * taken.
+ */
+int wildriver_async_get_graph(
+    wildriver_async * async,
+    wildriver_dim_t * r_nvtxs,
+    wildriver_ind_t * r_nedges,
+    int * r_nvwgts,
+    int * r_ewgts,
+    wildriver_ind_t ** r_xadj,
+    wildriver_dim_t ** r_adjncy,
+    wildriver_val_t ** r_vwgt,
+    wildriver_val_t ** r_adjwgt);
+
+
+/**
+ * @brief Release a load, waiting for it to complete and freeing any results
+ * which were not taken.
+ *
+ * @param async The load.
+ */
+void wildriver_async_free(
+    wildriver_async * async);
+
+
+
+/**
+ * @brief Set the conversion options to their defaults.
+ *
+ * @param options The options to initialize.
+ */
+void wildriver_init_convert_options(
+    wildriver_convert_options * options);
+
+
+/**
+ * @brief Convert a matrix file from one format to another without loading
+ * it into memory. Reading, parsing, transforming, formatting, and writing
+ * are performed by a pipeline of concurrent stages. The input must be a CSR
+ * or METIS file.
+ *
+ * @param input The filename/path of the file to read.
+ * @param output The filename/path of the file to write.
+ * @param options The options for the conversion (may be NULL for the
+ * defaults).
+ * @param stats The statistics of each stage, indexed by WILDRIVER_STAGE_*
+ * (output, must be null or of length WILDRIVER_NUM_STAGES).
+ *
+ * @return 1 on success, 0 if an error occurs.
+ */
+int wildriver_convert_matrix(
+    char const * input,
+    char const * output,
+    wildriver_convert_options const * options,
+    wildriver_stage_stats * stats);
+
+
+/**
+ * @brief Set the external build options to their defaults.
+ *
+ * @param options The options to initialize.
+ */
+void wildriver_init_external_options(
+    wildriver_external_options * options);
+
+
+/**
+ * @brief Build a CSR matrix from a coordinate file (MatrixMarket or SNAP)
+ * whose entries may be in any order, without holding more than a fixed
+ * amount of it in memory. Sorted runs of entries are spilled to temporary
+ * files and then merged.
+ *
+ * @param input The filename/path of the coordinate file to read.
+ * @param output The filename/path of the CSR file to write (.csr or .bcsr),
+ * or NULL to pass the rows to options->row_callback instead.
+ * @param options The options for the build (may be NULL for the defaults if
+ * output is not NULL).
+ *
+ * @return 1 on success, 0 if an error occurs.
+ */
+int wildriver_build_csr_external(
+    char const * input,
+    char const * output,
+    wildriver_external_options * options);
+
+
+/**
+ * @brief Set the generator options to their defaults: an R-MAT graph with
+ * the probabilities used by Graph500 (0.57, 0.19, 0.19).
+ *
+ * @param options The options to initialize.
+ */
+void wildriver_init_generator_options(
+    wildriver_generator_options * options);
+
+
+/**
+ * @brief Generate a synthetic matrix or graph and write it to a file,
+ * without holding it in memory. The matrix is generated in parallel, and
+ * depends only on the options, not on the number of threads. Graph files
+ * (METIS and SNAP) get no self loops.
+ *
+ * @param output The filename/path of the file to write.
+ * @param options The options for the matrix (nnz_written is set).
+ *
+ * @return 1 on success, 0 if an error occurs.
+ */
+int wildriver_generate_matrix(
+    char const * output,
+    wildriver_generator_options * options);
+
+
+/**
+ * @brief Set how the arrays returned by wildriver_read_matrix() and
+ * wildriver_read_graph() are allocated. The arrays may always be released
+ * with free(). Placement hints not supported by the system are ignored.
+ *
+ * @param flags A combination of wildriver_alloc_flag_t values.
+ */
+void wildriver_set_alloc_flags(
+    int flags);
+
+
+/**
+ * @brief Get how the arrays returned by wildriver_read_matrix() and
+ * wildriver_read_graph() are allocated.
+ *
+ * @return The combination of wildriver_alloc_flag_t values.
+ */
+int wildriver_get_alloc_flags(void);
+
+
+/**
+ * @brief Set the number of threads the library runs parallel work with
+ * (transposing, first touching, conversion and batch loading). The default is
+ * taken from the WILDRIVER_NUM_THREADS environment variable if it is set, and
+ * is otherwise the number of hardware threads. Parallel work started from
+ * within an OpenMP parallel region runs on the calling thread alone. This may
+ * be called at any time, from any thread.
+ *
+ * @param nthreads The number of threads (0 for the default).
+ */
+void wildriver_set_num_threads(
+    int nthreads);
+
+
+/**
+ * @brief Get the number of threads the library runs parallel work with.
+ *
+ * @return The number of threads.
+ */
+int wildriver_get_num_threads(void);
+
+
+/**
+ * @brief Set the limit on the temporary memory a load may hold beyond the
+ * arrays it fills. Readers whose fastest strategy would exceed it switch to
+ * one which uses less memory (e.g., reading the file twice instead of
+ * sorting its entries in memory), and loads with no such strategy fail
+ * before allocating. The default is taken from the WILDRIVER_MEMORY_BUDGET
+ * environment variable (in bytes) if it is set, and is otherwise unlimited.
+ * The memory each load is expected to need under the budget is reported in
+ * the temporary_bytes of its handle. This may be called at any time, from
+ * any thread.
+ *
+ * @param bytes The number of bytes (0 for unlimited).
+ */
+void wildriver_set_memory_budget(
+    size_t bytes);
+
+
+/**
+ * @brief Get the limit on the temporary memory a load may hold.
+ *
+ * @return The number of bytes (0 if unlimited).
+ */
+size_t wildriver_get_memory_budget(void);
+
+
+/**
+ * @brief Set the compression text files are written with when their name
+ * does not end in a compression extension (files named with .gz or .zst are
+ * always compressed accordingly). Compressed files are written in
+ * independent blocks, compressed by the threads of the library while the
+ * rows are being formatted, and remain standard gzip and zstd files. The
+ * default is taken from the WILDRIVER_OUTPUT_COMPRESSION environment
+ * variable ("gzip" or "zstd") if it is set, and is otherwise
+ * WILDRIVER_COMPRESSION_NONE. This may be called at any time, from any
+ * thread, and applies to files opened for writing afterwards.
+ *
+ * @param compression The compression (a wildriver_compression_t).
+ */
+void wildriver_set_output_compression(
+    int compression);
+
+
+/**
+ * @brief Get the compression text files are written with when their name
+ * does not end in a compression extension.
+ *
+ * @return The compression (a wildriver_compression_t).
+ */
+int wildriver_get_output_compression(void);
+
+
+/**
+ * @brief Set how uncompressed files are read. With WILDRIVER_READ_ASYNC,
+ * reads of a pool of large buffers ahead of the parser are kept in flight at
+ * once with io_uring on Linux, falling back to pread where io_uring is not
+ * available. Backends which are not supported on the platform fall back to
+ * WILDRIVER_READ_BUFFERED. The default is taken from the
+ * WILDRIVER_READ_BACKEND environment variable ("buffered", "mmap", or
+ * "async") if it is set, and is otherwise WILDRIVER_READ_BUFFERED. This may
+ * be called at any time, from any thread, and applies to files opened for
+ * reading afterwards.
+ *
+ * @param backend The backend (a wildriver_read_backend_t).
+ */
+void wildriver_set_read_backend(
+    int backend);
+
+
+/**
+ * @brief Get how uncompressed files are read.
+ *
+ * @return The backend (a wildriver_read_backend_t).
+ */
+int wildriver_get_read_backend(void);
+
+
+/**
+ * @brief Read a matrix from the given path into a CSR data-structure whose
+ * arrays are allocated with the given allocator (e.g., from an arena, a huge
+ * page pool, pinned memory, or a mapped file). If an error occurs, any
+ * arrays already allocated are released with allocator->free.
+ *
+ * @param fname The filename/path of the matrix file.
+ * @param allocator The allocator to use.
+ * @param r_nrows The number of rows in the matrix (output).
+ * @param r_ncols The number of columns in the matrix (output).
+ * @param r_nnz The number of non-zeros in the matrix (output).
+ * @param r_rowptr The the starting index for each row (output).
+ * @param r_rowind The column indices for entries in each row (output).
+ * @param r_rowval The value of the entries in each row (output, optional).
+ *
+ * @return 1 on success, 0 otherwise.
+ */
+int wildriver_read_matrix_alloc(
+    char const * fname,
+    wildriver_allocator const * allocator,
+    wildriver_dim_t * r_nrows,
+    wildriver_dim_t * r_ncols,
+    wildriver_ind_t * r_nnz,
+    wildriver_ind_t ** r_rowptr,
+    wildriver_dim_t ** r_rowind,
+    wildriver_val_t ** r_rowval);
+
+
+/**
+ * @brief Read a graph from the given path into a CSR data-structure whose
+ * arrays are allocated with the given allocator. If an error occurs, any
+ * arrays already allocated are released with allocator->free.
+ *
+ * @param fname The filename/path of the graph file.
+ * @param allocator The allocator to use.
+ * @param r_nvtxs The number of vertices in the graph (output).
+ * @param r_nedges The number of edges in the graph (output, optional).
+ * @param r_nvwgts The number of vertex weights in the graph (output,
+ * optional).
+ * @param r_ewgts Whether or not edge weights are present in the graph file
+ * (output, optional).
+ * @param r_xadj The adjacency list pointer (output).
+ * @param r_adjncy The adjacency list (output).
+ * @param r_vwgt The vertex weights (output, optional).
+ * @param r_adjwgt The edge weights (output, optional). This is set to NULL
+ * if the graph does not have edge weights.
+ *
+ * @return 1 on success, 0 otherwise.
+ */
+int wildriver_read_graph_alloc(
+    char const * fname,
+    wildriver_allocator const * allocator,
+    wildriver_dim_t * r_nvtxs,
+    wildriver_ind_t * r_nedges,
+    int * r_nvwgts,
+    int * r_ewgts,
+    wildriver_ind_t ** r_xadj,
+    wildriver_dim_t ** r_adjncy,
+    wildriver_val_t ** r_vwgt,
+    wildriver_val_t ** r_adjwgt);
+
+
+/**
+ * @brief Read only the rows [begin, end) of a matrix into a CSR
+ * data-structure. The row pointer is local to the range (starting at zero),
+ * while the column indices remain global. CSR and METIS files seek directly
+ * to the first row, and coordinate files (MatrixMarket and SNAP) are filtered
+ * by row.
+ *
+ * @param fname The filename/path of the matrix file.
+ * @param begin The first row to read.
+ * @param end One past the last row to read.
+ * @param r_nrows The number of rows in the whole matrix (output).
+ * @param r_ncols The number of columns in the whole matrix (output).
+ * @param r_nnz The number of non-zeros in the range of rows (output).
+ * @param r_rowptr The the starting index for each row (output, length
+ * end-begin+1).
+ * @param r_rowind The column indices for entries in each row (output).
+ * @param r_rowval The value of the entries in each row (output, optional).
+ *
+ * @return 1 on success, 0 otherwise.
+ */
+int wildriver_read_matrix_rows(
+    char const * fname,
+    wildriver_dim_t begin,
+    wildriver_dim_t end,
+    wildriver_dim_t * r_nrows,
+    wildriver_dim_t * r_ncols,
+    wildriver_ind_t * r_nnz,
+    wildriver_ind_t ** r_rowptr,
+    wildriver_dim_t ** r_rowind,
+    wildriver_val_t ** r_rowval);
+
+
+/**
+ * @brief Read only the vertices [begin, end) of a graph into a CSR
+ * data-structure. The adjacency list pointer is local to the range (starting
+ * at zero), while the edge destinations remain global.
+ *
+ * @param fname The filename/path of the graph file.
+ * @param begin The first vertex to read.
+ * @param end One past the last vertex to read.
+ * @param r_nvtxs The number of vertices in the whole graph (output).
+ * @param r_nedges The number of edges in the range of vertices (output,
+ * optional).
+ * @param r_nvwgts The number of vertex weights in the graph (output,
+ * optional).
+ * @param r_ewgts Whether or not edge weights are present in the graph file
+ * (output, optional).
+ * @param r_xadj The adjacency list pointer (output, length end-begin+1).
+ * @param r_adjncy The adjacency list (output).
+ * @param r_vwgt The vertex weights (output, optional). This is set to NULL
+ * if the graph does not have vertex weights.
+ * @param r_adjwgt The edge weights (output, optional). This is set to NULL
+ * if the graph does not have edge weights.
+ *
+ * @return 1 on success, 0 otherwise.
+ */
+int wildriver_read_graph_vertices(
+    char const * fname,
+    wildriver_dim_t begin,
+    wildriver_dim_t end,
+    wildriver_dim_t * r_nvtxs,
+    wildriver_ind_t * r_nedges,
+    int * r_nvwgts,
+    int * r_ewgts,
+    wildriver_ind_t ** r_xadj,
+    wildriver_dim_t ** r_adjncy,
+    wildriver_val_t ** r_vwgt,
+    wildriver_val_t ** r_adjwgt);
+
+
+/**
+ * @brief Read one part of a matrix split into nparts contiguous ranges of
+ * rows, balancing the number of non-zeros plus rows in each part. The split
+ * is computed from a pre-scan counting the entries of each row (without
+ * parsing them for CSR and METIS files), so that each part may be loaded
+ * independently by a separate process or thread. The row pointer is local
+ * to the part, while the column indices remain global.
+ *
+ * @param fname The filename/path of the matrix file.
+ * @param nparts The number of parts.
+ * @param part The part to read (from 0 to nparts-1).
+ * @param r_nrows The number of rows in the whole matrix (output).
+ * @param r_ncols The number of columns in the whole matrix (output).
+ * @param r_begin The first row of the part (output).
+ * @param r_end One past the last row of the part (output).
+ * @param r_nnz The number of non-zeros in the part (output).
+ * @param r_rowptr The the starting index for each row (output, length
+ * end-begin+1).
+ * @param r_rowind The column indices for entries in each row (output).
+ * @param r_rowval The value of the entries in each row (output, optional).
+ *
+ * @return 1 on success, 0 otherwise.
+ */
+int wildriver_read_matrix_part(
+    char const * fname,
+    int nparts,
+    int part,
+    wildriver_dim_t * r_nrows,
+    wildriver_dim_t * r_ncols,
+    wildriver_dim_t * r_begin,
+    wildriver_dim_t * r_end,
+    wildriver_ind_t * r_nnz,
+    wildriver_ind_t ** r_rowptr,
+    wildriver_dim_t ** r_rowind,
+    wildriver_val_t ** r_rowval);
+
+
+/**
+ * @brief Read one part of a graph split into nparts contiguous ranges of
+ * vertices, balancing the number of edges plus vertices in each part (see
+ * wildriver_read_matrix_part()).
+ *
+ * @param fname The filename/path of the graph file.
+ * @param nparts The number of parts.
+ * @param part The part to read (from 0 to nparts-1).
+ * @param r_nvtxs The number of vertices in the whole graph (output).
+ * @param r_begin The first vertex of the part (output).
+ * @param r_end One past the last vertex of the part (output).
+ * @param r_nedges The number of edges in the part (output, optional).
+ * @param r_nvwgts The number of vertex weights in the graph (output,
+ * optional).
+ * @param r_ewgts Whether or not edge weights are present in the graph file
+ * (output, optional).
+ * @param r_xadj The adjacency list pointer (output, length end-begin+1).
+ * @param r_adjncy The adjacency list (output).
+ * @param r_vwgt The vertex weights (output, optional). This is set to NULL
+ * if the graph does not have vertex weights.
+ * @param r_adjwgt The edge weights (output, optional). This is set to NULL
+ * if the graph does not have edge weights.
+ *
+ * @return 1 on success, 0 otherwise.
+ */
+int wildriver_read_graph_part(
+    char const * fname,
+    int nparts,
+    int part,
+    wildriver_dim_t * r_nvtxs,
+    wildriver_dim_t * r_begin,
+    wildriver_dim_t * r_end,
+    wildriver_ind_t * r_nedges,
+    int * r_nvwgts,
+    int * r_ewgts,
+    wildriver_ind_t ** r_xadj,
+    wildriver_dim_t ** r_adjncy,
+    wildriver_val_t ** r_vwgt,
+    wildriver_val_t ** r_adjwgt);
+
+
+/**
+ * @brief Create a token for cancelling loads. Loads check the token between
+ * chunks of the file, so a load may continue briefly after the token is
+ * cancelled. The token must be released with wildriver_free_cancel_token().
+ *
+ * @return The token, or NULL if there was an error.
+ */
+wildriver_cancel_token * wildriver_create_cancel_token(void);
+
+
+/**
+ * @brief Cancel the loads using a token. This may be called from any thread.
+ *
+ * @param token The token.
+ */
+void wildriver_cancel(
+    wildriver_cancel_token * token);
+
+
+/**
+ * @brief Set a deadline after which the loads using a token are cancelled.
+ *
+ * @param token The token.
+ * @param seconds The number of seconds from now (0 to remove the deadline).
+ */
+void wildriver_set_deadline(
+    wildriver_cancel_token * token,
+    double seconds);
+
+
+/**
+ * @brief Release a token. It must not be in use by any load.
+ *
+ * @param token The token.
+ */
+void wildriver_free_cancel_token(
+    wildriver_cancel_token * token);
+
+
+/**
+ * @brief Stop the loads performed by the calling thread early if a token is
+ * cancelled or its deadline passes, including those through open handles
+ * (e.g., wildriver_load_matrix()), which then fail and return 0.
+ *
+ * @param token The token (NULL to stop checking one).
+ */
+void wildriver_set_thread_cancel_token(
+    wildriver_cancel_token const * token);
+
+
+/**
+ * @brief Read a matrix (see wildriver_read_matrix()), stopping early if the
+ * token is cancelled or its deadline passes. The partially loaded arrays are
+ * freed before returning.
+ *
+ * @param fname The filename/path of the matrix file.
+ * @param token The cancellation token.
+ * @param r_nrows The number of rows in the matrix (output).
+ * @param r_ncols The number of columns in the matrix (output).
+ * @param r_nnz The number of non-zeros in the matrix (output).
+ * @param r_rowptr The the starting index for each row (output).
+ * @param r_rowind The column indices for entries in each row (output).
+ * @param r_rowval The value of the entries in each row (output, optional).
+ *
+ * @return WILDRIVER_SUCCESS, WILDRIVER_ERROR_CANCELLED,
+ * WILDRIVER_ERROR_DEADLINE, or WILDRIVER_ERROR for any other error.
+ */
+int wildriver_read_matrix_cancellable(
+    char const * fname,
+    wildriver_cancel_token const * token,
+    wildriver_dim_t * r_nrows,
+    wildriver_dim_t * r_ncols,
+    wildriver_ind_t * r_nnz,
+    wildriver_ind_t ** r_rowptr,
+    wildriver_dim_t ** r_rowind,
+    wildriver_val_t ** r_rowval);
+
+
+/**
+ * @brief Read a graph (see wildriver_read_graph()), stopping early if the
+ * token is cancelled or its deadline passes. The partially loaded arrays are
+ * freed before returning.
+ *
+ * @param fname The filename/path of the graph file.
+ * @param token The cancellation token.
+ * @param r_nvtxs The number of vertices in the graph (output).
+ * @param r_nedges The number of edges in the graph (output, optional).
+ * @param r_nvwgts The number of vertex weights in the graph (output,
+ * optional).
+ * @param r_ewgts Whether or not edge weights are present in the graph file
+ * (output, optional).
+ * @param r_xadj The adjacency list pointer (output).
+ * @param r_adjncy The adjacency list (output).
+ * @param r_vwgt The vertex weights (output, optional).
+ * @param r_adjwgt The edge weights (output, optional).
+ *
+ * @return WILDRIVER_SUCCESS, WILDRIVER_ERROR_CANCELLED,
+ * WILDRIVER_ERROR_DEADLINE, or WILDRIVER_ERROR for any other error.
+ */
+int wildriver_read_graph_cancellable(
+    char const * fname,
+    wildriver_cancel_token const * token,
+    wildriver_dim_t * r_nvtxs,
+    wildriver_ind_t * r_nedges,
+    int * r_nvwgts,
+    int * r_ewgts,
+    wildriver_ind_t ** r_xadj,
+    wildriver_dim_t ** r_adjncy,
+    wildriver_val_t ** r_vwgt,
+    wildriver_val_t ** r_adjwgt);
+
+
+/**
+ * @brief Create a monitor for the progress of loads. The counts are updated
+ * atomically, so a monitor may be shared by loads on several threads and
+ * read from any thread. The monitor must be released with
+ * wildriver_free_progress_monitor().
+ *
+ * @param callback The function to call with the progress (may be NULL). It
+ * is called from a loading thread, at most once per interval and never
+ * concurrently with itself, and whenever the phase changes.
+ * @param ctx The context passed to the callback.
+ * @param interval The minimum number of seconds between calls.
+ *
+ * @return The monitor, or NULL if there was an error.
+ */
+wildriver_progress_monitor * wildriver_create_progress_monitor(
+    void (*callback)(
+        wildriver_progress const * progress,
+        void * ctx),
+    void * ctx,
+    double interval);
+
+
+/**
+ * @brief Report the progress of the loads performed by the calling thread
+ * to a monitor.
+ *
+ * @param monitor The monitor (NULL to stop reporting).
+ */
+void wildriver_set_thread_progress(
+    wildriver_progress_monitor * monitor);
+
+
+/**
+ * @brief Get the progress of the loads reporting to a monitor.
+ *
+ * @param monitor The monitor.
+ * @param r_progress The progress (output).
+ */
+void wildriver_get_progress(
+    wildriver_progress_monitor const * monitor,
+    wildriver_progress * r_progress);
+
+
+/**
+ * @brief Release a monitor. It must not be in use by any thread.
+ *
+ * @param monitor The monitor.
+ */
+void wildriver_free_progress_monitor(
+    wildriver_progress_monitor * monitor);
+
+
+/**
+ * @brief Get the timings and counts of the last operation of the calling
+ * thread (e.g., wildriver_read_matrix() or wildriver_save_matrix()), whether
+ * or not it succeeded. Setting the WILDRIVER_STATS environment variable
+ * (to anything other than "0") also prints a summary of each operation to
+ * stderr.
+ *
+ * @param r_stats The stats (output).
+ *
+ * @return 1 if the thread has performed an operation, 0 otherwise.
+ */
+int wildriver_get_last_stats(
+    wildriver_stats * r_stats);
+
+
+/**
+ * @brief Enable or disable tracing, which records a timeline of the work of
+ * readers, writers, conversion pipelines, and the library's thread pool on
+ * each thread. Events already recorded are kept when tracing is disabled.
+ * While disabled, tracing costs next to nothing.
+ *
+ * @param enable 1 to record events, 0 to stop.
+ */
+void wildriver_set_tracing(
+    int enable);
+
+
+/**
+ * @brief Write the recorded events as Chrome trace JSON, which can be opened
+ * in chrome://tracing or Perfetto.
+ *
+ * @param filename The file to write.
+ *
+ * @return 1 on success, 0 if there was an error.
+ */
+int wildriver_write_trace(
+    char const * filename);
+
+
+/**
+ * @brief Discard the recorded events. This must not be called while other
+ * threads are reading or writing.
+ */
+void wildriver_clear_trace(void);
+
+
+/**
+ * @brief Load many matrices concurrently on the library's thread pool,
+ * blocking until all have been loaded. Small files share a task, which loads
+ * them one after another, to save scheduling a task per file. A file which
+ * fails to load does not affect the others.
+ *
+ * @param slots The files to load and the arrays to load them into.
+ * @param nslots The number of slots.
+ * @param values Whether or not to load the values of the entries (rowval is
+ * set to NULL if not).
+ *
+ * @return The number of matrices successfully loaded.
+ */
+size_t wildriver_read_matrix_batch(
+    wildriver_matrix_slot * slots,
+    size_t nslots,
+    int values);
+
+
+/**
+ * @brief Load many vectors concurrently (see wildriver_read_matrix_batch()).
+ *
+ * @param slots The files to load and the arrays to load them into.
+ * @param nslots The number of slots.
+ *
+ * @return The number of vectors successfully loaded.
+ */
+size_t wildriver_read_vector_batch(
+    wildriver_vector_slot * slots,
+    size_t nslots);
+
+
+
+/******************************************************************************
+* DEPRECATED FUNCTIONS ********************************************************
+******************************************************************************/
+
+
+/**
+ * @brief Read a matrix from the given path into a CSR data-structure.
+ *
+ * @param fname The filename/path of the matrix file.
+ * @param r_nrows The number of rows in the matrix (output).
+ * @param r_ncols The number of columns in the matrix (output).
+ * @param r_nnz The number of non-zeros in the matrix (output).
+ * @param r_rowptr The the starting index for each row (output).
+ * @param r_rowind The column indices for entries in each row (output).
+ * @param r_rowval The value of the entries in each row (output, optional).
+ * If NULL, the matrix is loaded as a pattern only, and values are neither
+ * parsed nor allocated.
+ *
+ * @return 1 on success, 0 otherwise.
+ */
+int wildriver_read_matrix(
+    char const * fname,
+    wildriver_dim_t * r_nrows,
+    wildriver_dim_t * r_ncols,
+    wildriver_ind_t * r_nnz,
+    wildriver_ind_t ** r_rowptr,
+    wildriver_dim_t ** r_rowind,
+    wildriver_val_t ** r_rowval);
+
+
+/**
+ * @brief Write a matrix file to the given path from a CSR data-structure.
+ *
+ * @param fname The filename/path of the matrix file.
+ * @param nrows The number of rows in the matrix.
+ * @param ncols The number of columns in the matrix.
+ * @param nnz The number of non-zeros in the matrix.
+ * @param rowptr The starting index for each row.
+ * @param rowind The column indices for entries in each row.
+ * @param rowval The value of the entries in each row.
+ *
+ * @return 1 on success, 0 otherwise.
+ */
+int wildriver_write_matrix(
+    char const * fname,
+    wildriver_dim_t nrows,
+    wildriver_dim_t ncols,
+    wildriver_ind_t nnz,
+    wildriver_ind_t const * rowptr,
+    wildriver_dim_t const * rowind,
+    wildriver_val_t const * rowval);
+
+
+/**
+ * @brief Read a graph from the given path into a CSR data-structure.
+ *
+ * @param fname The filename/path of the graph file.
+ * @param r_nvtxs The number of vertices in the graph (output).
+ * @param r_nedges The number of edges in the graph (output, optional).
+ * @param r_nvwgts The number of vertex weights in the graph (output,
+ * optional).
+ * @param r_ewgts Whether or not edge weights are present in the graph file
+ * (output, optional).
+ * @param r_xadj The adjacency list pointer (output).
+ * @param r_adjncy The adjacency list (output).
+ * @param r_vwgt The vertex weights (output, optional).
+ * @param r_adjwgt The edge weights (output, optional). This is set to NULL
+ * if the graph does not have edge weights.
  *
  * @return 1 on success, 0 otherwise.
  */
@@ -0,0 +1,177 @@
+/**
+ * @file AsyncLoader.cpp
+ * @brief Implementation of the AsyncLoader class.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-21
+ */
+
+
+
+
+#include <functional>
+#include <memory>
+
+#include "AsyncLoader.hpp"
+#include "GraphInHandle.hpp"
+#include "MatrixInHandle.hpp"
+#include "ThreadPool.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/******************************************************************************
+* HELPER FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+/**
+ * @brief Run a function on the library's thread pool.
+ *
+ * @tparam T The type of result.
+ * @param func The function.
+ *
+ * @return The future result of the function.
+ */
+template<typename T>
+std::future<T> runAsync(
+    std::function<T()> func)
+{
+  // the task is shared since std::function requires a copyable target
+  std::shared_ptr<std::packaged_task<T()>> task = \
+      std::make_shared<std::packaged_task<T()>>(std::move(func));
+  std::future<T> result = task->get_future();
+
+  ThreadPool::getInstance().submit([task]() {
+    (*task)();
+  });
+
+  return result;
+}
+
+
+/**
+ * @brief Load a matrix.
+ *
+ * @param name The filename/path of the matrix file.
+ * @param values Whether or not to load the values of the entries.
+ * @param token The token for cancelling the load (may be null).
+ * @param monitor The monitor to report progress to (may be null).
+ *
+ * @return The matrix.
+ */
+loaded_matrix_struct readMatrix(
+    std::string const & name,
+    bool const values,
+    CancelToken const * const token,
+    ProgressMonitor * const monitor)
+{
+  CancelToken::Scope scope(token);
+  ProgressMonitor::Scope progress(monitor);
+  ProgressMonitor::setCurrentPhase(WILDRIVER_PHASE_OPEN);
+
+  MatrixInHandle handle(name);
+
+  loaded_matrix_struct matrix;
+  ind_t nnz;
+  handle.getInfo(matrix.nrows, matrix.ncols, nnz);
+
+  matrix.rowptr.resize(matrix.nrows+1);
+  matrix.rowind.resize(nnz);
+  if (values) {
+    matrix.rowval.resize(nnz);
+  }
+
+  handle.readSparse(matrix.rowptr.data(), matrix.rowind.data(), \
+      values ? matrix.rowval.data() : nullptr);
+
+  ProgressMonitor::setCurrentPhase(WILDRIVER_PHASE_DONE);
+
+  return matrix;
+}
+
+
+/**
+ * @brief Load a graph.
+ *
+ * @param name The filename/path of the graph file.
+ * @param token The token for cancelling the load (may be null).
+ * @param monitor The monitor to report progress to (may be null).
+ *
+ * @return The graph.
+ */
+loaded_graph_struct readGraph(
+    std::string const & name,
+    CancelToken const * const token,
+    ProgressMonitor * const monitor)
+{
+  CancelToken::Scope scope(token);
+  ProgressMonitor::Scope progress(monitor);
+  ProgressMonitor::setCurrentPhase(WILDRIVER_PHASE_OPEN);
+
+  GraphInHandle handle(name);
+
+  loaded_graph_struct graph;
+  ind_t nedges;
+  handle.getInfo(graph.nvtxs, nedges, graph.nvwgts, graph.ewgts);
+
+  graph.xadj.resize(graph.nvtxs+1);
+  graph.adjncy.resize(nedges);
+  graph.vwgt.resize(static_cast<size_t>(graph.nvtxs)*graph.nvwgts);
+  if (graph.ewgts) {
+    graph.adjwgt.resize(nedges);
+  }
+
+  handle.readGraph(graph.xadj.data(), graph.adjncy.data(), \
+      graph.nvwgts > 0 ? graph.vwgt.data() : nullptr, \
+      graph.ewgts ? graph.adjwgt.data() : nullptr);
+
+  ProgressMonitor::setCurrentPhase(WILDRIVER_PHASE_DONE);
+
+  return graph;
+}
+
+
+}
+
+
+
+
+/******************************************************************************
+* PUBLIC STATIC FUNCTIONS *****************************************************
+******************************************************************************/
+
+
+std::future<loaded_matrix_struct> AsyncLoader::loadMatrix(
+    std::string const & name,
+    bool const values,
+    CancelToken const * const token,
+    ProgressMonitor * const monitor)
+{
+  return runAsync<loaded_matrix_struct>(std::bind(readMatrix, name, values, \
+      token, monitor));
+}
+
+
+std::future<loaded_graph_struct> AsyncLoader::loadGraph(
+    std::string const & name,
+    CancelToken const * const token,
+    ProgressMonitor * const monitor)
+{
+  return runAsync<loaded_graph_struct>(std::bind(readGraph, name, token, \
+      monitor));
+}
+
+
+
+
+}
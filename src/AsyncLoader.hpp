@@ -0,0 +1,146 @@
+/**
+ * @file AsyncLoader.hpp
+ * @brief Functions for loading matrices and graphs in the background.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-21
+ */
+
+
+
+
+#ifndef WILDRIVER_ASYNCLOADER_HPP
+#define WILDRIVER_ASYNCLOADER_HPP
+
+
+
+
+#include <future>
+#include <string>
+#include <vector>
+
+#include "base.h"
+#include "CancelToken.hpp"
+#include "ProgressMonitor.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/**
+ * @brief A matrix loaded in CSR form.
+ */
+struct loaded_matrix_struct
+{
+  loaded_matrix_struct() :
+    nrows(0),
+    ncols(0),
+    rowptr(),
+    rowind(),
+    rowval()
+  {
+    // do nothing
+  }
+
+  dim_t nrows;
+  dim_t ncols;
+  std::vector<ind_t> rowptr;
+  std::vector<dim_t> rowind;
+  std::vector<val_t> rowval;
+};
+
+
+/**
+ * @brief A graph loaded in CSR form.
+ */
+struct loaded_graph_struct
+{
+  loaded_graph_struct() :
+    nvtxs(0),
+    nvwgts(0),
+    ewgts(false),
+    xadj(),
+    adjncy(),
+    vwgt(),
+    adjwgt()
+  {
+    // do nothing
+  }
+
+  dim_t nvtxs;
+  int nvwgts;
+  bool ewgts;
+  std::vector<ind_t> xadj;
+  std::vector<dim_t> adjncy;
+  std::vector<val_t> vwgt;
+  std::vector<val_t> adjwgt;
+};
+
+
+/**
+ * @brief Loads matrices and graphs in the background for code within the
+ * library. Like the library's other C++ headers this one is not installed,
+ * and applications load in the background through the C interface of
+ * wildriver.h instead: wildriver_read_matrix_async() and
+ * wildriver_read_graph_async() start a load, and the wildriver_async_*()
+ * functions poll, wait on, cancel and take the results of it.
+ */
+class AsyncLoader
+{
+  public:
+    /**
+     * @brief Start loading a matrix on the library's thread pool. Waiting on
+     * or polling the returned future (with wait_for()) gives the status of
+     * the load, and any exception thrown while loading is rethrown by get().
+     *
+     * @param name The filename/path of the matrix file.
+     * @param values Whether or not to load the values of the entries.
+     * @param token The token for cancelling the load, which must outlive it
+     * (may be null). A cancelled load rethrows CancelledException from get().
+     * @param monitor The monitor to report progress to, which must outlive
+     * the load (may be null).
+     *
+     * @return The future matrix.
+     */
+    static std::future<loaded_matrix_struct> loadMatrix(
+        std::string const & name,
+        bool values = true,
+        CancelToken const * token = nullptr,
+        ProgressMonitor * monitor = nullptr);
+
+
+    /**
+     * @brief Start loading a graph on the library's thread pool (see
+     * loadMatrix()).
+     *
+     * @param name The filename/path of the graph file.
+     * @param token The token for cancelling the load, which must outlive it
+     * (may be null).
+     * @param monitor The monitor to report progress to, which must outlive
+     * the load (may be null).
+     *
+     * @return The future graph.
+     */
+    static std::future<loaded_graph_struct> loadGraph(
+        std::string const & name,
+        CancelToken const * token = nullptr,
+        ProgressMonitor * monitor = nullptr);
+
+
+
+
+};
+
+
+
+
+}
+
+
+
+
+#endif
@@ -0,0 +1,678 @@
+/**
+ * @file AsyncReadBuffer.cpp
+ * @brief Implementation of the AsyncReadBuffer class.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-27
+ */
+
+
+
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef WILDRIVER_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+
+#include "AsyncReadBuffer.hpp"
+#include "Tracer.hpp"
+#include "Exception.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/******************************************************************************
+* TYPES ***********************************************************************
+******************************************************************************/
+
+
+#ifdef WILDRIVER_IO_URING
+/**
+ * @brief An io_uring instance, used through the system calls directly (as
+ * liburing is not required). Reads are submitted one at a time, and their
+ * completions are tagged with the index of the buffer they fill.
+ */
+class AsyncReadBuffer::Ring
+{
+  public:
+    /**
+     * @brief Set up an io_uring instance.
+     *
+     * @param entries The most reads which will be in flight at once.
+     *
+     * @return The instance, or nullptr if io_uring is not available.
+     */
+    static std::unique_ptr<Ring> open(
+        unsigned const entries)
+    {
+      io_uring_params params;
+      std::memset(&params, 0, sizeof(params));
+      int const fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, \
+          &params));
+      if (fd < 0) {
+        return nullptr;
+      }
+
+      std::unique_ptr<Ring> ring(new Ring(fd, entries));
+      if (!ring->map(params)) {
+        return nullptr;
+      }
+
+      return ring;
+    }
+
+
+    ~Ring()
+    {
+      if (m_sqes != nullptr) {
+        munmap(m_sqes, m_sqesSize);
+      }
+      if (m_cqRing != nullptr && m_cqRing != m_sqRing) {
+        munmap(m_cqRing, m_cqRingSize);
+      }
+      if (m_sqRing != nullptr) {
+        munmap(m_sqRing, m_sqRingSize);
+      }
+      ::close(m_fd);
+    }
+
+
+    /**
+     * @brief Submit a read.
+     *
+     * @param fd The file to read from.
+     * @param data The memory to read into.
+     * @param size The number of bytes to read.
+     * @param offset The offset in the file to read from.
+     * @param tag The tag of the completion.
+     *
+     * @throw BadFileException If the read cannot be submitted.
+     */
+    void read(
+        int const fd,
+        char * const data,
+        size_t const size,
+        size_t const offset,
+        size_t const tag)
+    {
+      // only this thread adds to the submission queue
+      unsigned const tail = *m_sqTail;
+      unsigned const index = tail & *m_sqMask;
+
+      // the vector must remain valid until the read completes
+      iovec & vec = m_vecs[tag];
+      vec.iov_base = data;
+      vec.iov_len = size;
+
+      io_uring_sqe & sqe = m_sqes[index];
+      std::memset(&sqe, 0, sizeof(sqe));
+      sqe.opcode = IORING_OP_READV;
+      sqe.fd = fd;
+      sqe.off = offset;
+      sqe.addr = reinterpret_cast<uint64_t>(&vec);
+      sqe.len = 1;
+      sqe.user_data = tag;
+      m_sqArray[index] = index;
+      __atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+
+      while (syscall(__NR_io_uring_enter, m_fd, 1, 0, 0, nullptr, 0) < 0) {
+        if (errno != EINTR) {
+          int const error = errno;
+          // the kernel did not take the read
+          __atomic_store_n(m_sqTail, tail, __ATOMIC_RELEASE);
+          throw BadFileException(std::string("Failed to submit read: ") + \
+              std::strerror(error));
+        }
+      }
+    }
+
+
+    /**
+     * @brief Wait for a read to complete.
+     *
+     * @param tag The tag of the read (output).
+     * @param result The number of bytes read, or the negated error
+     * (output).
+     *
+     * @throw BadFileException If waiting fails.
+     */
+    void wait(
+        size_t * const tag,
+        int * const result)
+    {
+      while (true) {
+        // only this thread removes from the completion queue
+        unsigned const head = *m_cqHead;
+        if (head != __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE)) {
+          io_uring_cqe const & cqe = m_cqes[head & *m_cqMask];
+          *tag = static_cast<size_t>(cqe.user_data);
+          *result = cqe.res;
+          __atomic_store_n(m_cqHead, head + 1, __ATOMIC_RELEASE);
+          return;
+        }
+
+        if (syscall(__NR_io_uring_enter, m_fd, 0, 1, IORING_ENTER_GETEVENTS, \
+            nullptr, 0) < 0 && errno != EINTR) {
+          int const error = errno;
+          throw BadFileException(std::string("Failed to wait for read: ") + \
+              std::strerror(error));
+        }
+      }
+    }
+
+
+  private:
+    int const m_fd;
+    std::vector<iovec> m_vecs;
+    void * m_sqRing;
+    size_t m_sqRingSize;
+    void * m_cqRing;
+    size_t m_cqRingSize;
+    io_uring_sqe * m_sqes;
+    size_t m_sqesSize;
+    unsigned * m_sqTail;
+    unsigned * m_sqMask;
+    unsigned * m_sqArray;
+    unsigned * m_cqHead;
+    unsigned * m_cqTail;
+    unsigned * m_cqMask;
+    io_uring_cqe * m_cqes;
+
+
+    Ring(
+        int const fd,
+        unsigned const entries) :
+      m_fd(fd),
+      m_vecs(entries),
+      m_sqRing(nullptr),
+      m_sqRingSize(0),
+      m_cqRing(nullptr),
+      m_cqRingSize(0),
+      m_sqes(nullptr),
+      m_sqesSize(0),
+      m_sqTail(nullptr),
+      m_sqMask(nullptr),
+      m_sqArray(nullptr),
+      m_cqHead(nullptr),
+      m_cqTail(nullptr),
+      m_cqMask(nullptr),
+      m_cqes(nullptr)
+    {
+      // do nothing
+    }
+
+
+    /**
+     * @brief Map a region of the instance.
+     *
+     * @param size The size of the region.
+     * @param offset The offset of the region.
+     *
+     * @return The region, or nullptr if it could not be mapped.
+     */
+    void * mapRegion(
+        size_t const size,
+        off_t const offset) const noexcept
+    {
+      void * const region = mmap(nullptr, size, PROT_READ | PROT_WRITE, \
+          MAP_SHARED | MAP_POPULATE, m_fd, offset);
+
+      return region == MAP_FAILED ? nullptr : region;
+    }
+
+
+    /**
+     * @brief Map the submission and completion queues.
+     *
+     * @param params The parameters the instance was set up with.
+     *
+     * @return False if they could not be mapped.
+     */
+    bool map(
+        io_uring_params const & params) noexcept
+    {
+      m_sqRingSize = params.sq_off.array + \
+          params.sq_entries*sizeof(unsigned);
+      m_cqRingSize = params.cq_off.cqes + \
+          params.cq_entries*sizeof(io_uring_cqe);
+      bool const single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+      if (single) {
+        m_sqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+        m_cqRingSize = m_sqRingSize;
+      }
+
+      m_sqRing = mapRegion(m_sqRingSize, IORING_OFF_SQ_RING);
+      if (m_sqRing == nullptr) {
+        return false;
+      }
+      m_cqRing = single ? m_sqRing : \
+          mapRegion(m_cqRingSize, IORING_OFF_CQ_RING);
+      if (m_cqRing == nullptr) {
+        return false;
+      }
+      m_sqesSize = params.sq_entries*sizeof(io_uring_sqe);
+      m_sqes = static_cast<io_uring_sqe*>( \
+          mapRegion(m_sqesSize, IORING_OFF_SQES));
+      if (m_sqes == nullptr) {
+        return false;
+      }
+
+      char * const sq = static_cast<char*>(m_sqRing);
+      m_sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+      m_sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+      m_sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+      char * const cq = static_cast<char*>(m_cqRing);
+      m_cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+      m_cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+      m_cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+      m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+      return true;
+    }
+
+
+    // disable copying
+    Ring(
+        Ring const & rhs);
+    Ring & operator=(
+        Ring const & rhs);
+};
+#else
+/**
+ * @brief A stand in for an io_uring instance, where support for io_uring was
+ * not built.
+ */
+class AsyncReadBuffer::Ring
+{
+  public:
+    static std::unique_ptr<Ring> open(
+        unsigned)
+    {
+      return nullptr;
+    }
+
+
+    void read(
+        int,
+        char *,
+        size_t,
+        size_t,
+        size_t)
+    {
+      throw BadFileException("Reading with io_uring is not supported.");
+    }
+
+
+    void wait(
+        size_t *,
+        int *)
+    {
+      throw BadFileException("Reading with io_uring is not supported.");
+    }
+};
+#endif
+
+
+
+
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+
+size_t const AsyncReadBuffer::BUFFER_SIZE = 1024*1024;
+
+
+size_t const AsyncReadBuffer::NUM_BUFFERS = 16;
+
+
+
+
+/******************************************************************************
+* PUBLIC STATIC FUNCTIONS *****************************************************
+******************************************************************************/
+
+
+bool AsyncReadBuffer::isSupported() noexcept
+{
+#ifdef __linux__
+  return true;
+#else
+  return false;
+#endif
+}
+
+
+
+
+/******************************************************************************
+* CONSTRUCTORS / DESTRUCTOR ***************************************************
+******************************************************************************/
+
+
+AsyncReadBuffer::AsyncReadBuffer(
+    std::string const & name,
+    bool const ring) :
+  m_name(name),
+  m_fd(-1),
+  m_fileSize(0),
+  m_buffers(NUM_BUFFERS),
+  m_ring(),
+  m_first(0),
+  m_numUsed(0),
+  m_hasCurrent(false),
+  m_position(0),
+  m_nextOffset(0)
+{
+#ifdef __linux__
+  m_fd = ::open(name.c_str(), O_RDONLY | O_CLOEXEC);
+  if (m_fd < 0) {
+    throw BadFileException(std::string("Failed to open file '") + \
+        name + std::string("'"));
+  }
+
+  struct stat info;
+  if (fstat(m_fd, &info) != 0) {
+    ::close(m_fd);
+    throw BadFileException(std::string("Failed to stat file '") + \
+        name + std::string("'"));
+  }
+  m_fileSize = static_cast<size_t>(info.st_size);
+  posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+  if (ring) {
+    m_ring = Ring::open(static_cast<unsigned>(NUM_BUFFERS));
+  }
+
+  try {
+    start(0);
+  } catch (...) {
+    drain();
+    ::close(m_fd);
+    throw;
+  }
+#else
+  static_cast<void>(ring);
+  throw BadFileException(std::string("Unable to read '") + name + \
+      std::string("': asynchronous reads are not supported on this " \
+      "platform."));
+#endif
+}
+
+
+AsyncReadBuffer::~AsyncReadBuffer()
+{
+  drain();
+
+#ifdef __linux__
+  ::close(m_fd);
+#endif
+}
+
+
+
+
+/******************************************************************************
+* PROTECTED FUNCTIONS *********************************************************
+******************************************************************************/
+
+
+AsyncReadBuffer::int_type AsyncReadBuffer::underflow()
+{
+  if (gptr() < egptr()) {
+    return traits_type::to_int_type(*gptr());
+  }
+
+  if (!advance()) {
+    return traits_type::eof();
+  }
+
+  return traits_type::to_int_type(*gptr());
+}
+
+
+AsyncReadBuffer::pos_type AsyncReadBuffer::seekoff(
+    off_type const off,
+    std::ios_base::seekdir const dir,
+    std::ios_base::openmode const which)
+{
+  off_type const current = static_cast<off_type>(m_position) + \
+      (gptr() - eback());
+
+  if (dir == std::ios_base::cur) {
+    if (off == 0) {
+      // a query of the position
+      return pos_type(current);
+    }
+    return seekpos(pos_type(current + off), which);
+  } else if (dir == std::ios_base::end) {
+    return seekpos(pos_type(static_cast<off_type>(m_fileSize) + off), which);
+  }
+
+  return seekpos(pos_type(off), which);
+}
+
+
+AsyncReadBuffer::pos_type AsyncReadBuffer::seekpos(
+    pos_type const pos,
+    std::ios_base::openmode const which)
+{
+  off_type const target = static_cast<off_type>(pos);
+  if (target < 0 || static_cast<size_t>(target) > m_fileSize || \
+      !(which & std::ios_base::in)) {
+    return pos_type(off_type(-1));
+  }
+
+  // move through the buffers being read if the target is among them
+  size_t const offset = static_cast<size_t>(target);
+  if (offset < m_position || offset > m_nextOffset) {
+    start(offset);
+  }
+
+  while (!m_hasCurrent || offset > m_position + m_buffers[m_first].filled) {
+    if (!advance()) {
+      return offset == m_position ? pos : pos_type(off_type(-1));
+    }
+  }
+
+  buffer_struct const & current = m_buffers[m_first];
+  char * const data = current.data.get();
+  setg(data, data + (offset - m_position), data + current.filled);
+
+  return pos;
+}
+
+
+
+
+/******************************************************************************
+* PRIVATE FUNCTIONS ***********************************************************
+******************************************************************************/
+
+
+void AsyncReadBuffer::start(
+    size_t const offset)
+{
+  drain();
+
+  setg(nullptr, nullptr, nullptr);
+  m_first = 0;
+  m_numUsed = 0;
+  m_hasCurrent = false;
+  m_position = offset;
+  m_nextOffset = offset;
+
+  fill();
+}
+
+
+void AsyncReadBuffer::fill()
+{
+  while (m_numUsed < NUM_BUFFERS && m_nextOffset < m_fileSize) {
+    size_t const index = (m_first + m_numUsed) % NUM_BUFFERS;
+    buffer_struct & buffer = m_buffers[index];
+    buffer.offset = m_nextOffset;
+    buffer.size = std::min(BUFFER_SIZE, m_fileSize - m_nextOffset);
+    buffer.filled = 0;
+    buffer.error = 0;
+    submit(index);
+
+    m_nextOffset += buffer.size;
+    ++m_numUsed;
+  }
+}
+
+
+bool AsyncReadBuffer::advance()
+{
+  if (m_hasCurrent) {
+    // its buffer is free to read into again
+    buffer_struct const & current = m_buffers[m_first];
+    m_position = current.offset + current.size;
+    m_first = (m_first + 1) % NUM_BUFFERS;
+    --m_numUsed;
+    m_hasCurrent = false;
+    setg(nullptr, nullptr, nullptr);
+  }
+
+  fill();
+  if (m_numUsed == 0) {
+    return false;
+  }
+
+  wait(m_first);
+
+  buffer_struct const & buffer = m_buffers[m_first];
+  m_hasCurrent = true;
+  m_position = buffer.offset;
+  char * const data = buffer.data.get();
+  setg(data, data, data + buffer.filled);
+
+  // the file may have been truncated while being read
+  return buffer.filled > 0;
+}
+
+
+void AsyncReadBuffer::submit(
+    size_t const index)
+{
+  buffer_struct & buffer = m_buffers[index];
+  if (m_ring != nullptr) {
+    m_ring->read(m_fd, buffer.data.get() + buffer.filled, \
+        buffer.size - buffer.filled, buffer.offset + buffer.filled, index);
+  }
+
+  // without a ring, the buffer is read when it is waited for
+  buffer.pending = true;
+}
+
+
+void AsyncReadBuffer::wait(
+    size_t const index)
+{
+  buffer_struct & buffer = m_buffers[index];
+  if (buffer.pending) {
+    Tracer::Span span("reader", "wait read");
+
+    while (buffer.pending) {
+      if (m_ring != nullptr) {
+        complete();
+        continue;
+      }
+
+#ifdef __linux__
+      ssize_t const size = pread(m_fd, buffer.data.get() + buffer.filled, \
+          buffer.size - buffer.filled, \
+          static_cast<off_t>(buffer.offset + buffer.filled));
+      if (size < 0) {
+        if (errno != EINTR) {
+          buffer.error = errno;
+          buffer.pending = false;
+        }
+      } else {
+        buffer.filled += static_cast<size_t>(size);
+        buffer.pending = size > 0 && buffer.filled < buffer.size;
+      }
+#endif
+    }
+  }
+
+  if (buffer.error != 0) {
+    int const error = buffer.error;
+    buffer.error = 0;
+    throw BadFileException(std::string("Failed to read file '") + m_name + \
+        std::string("': ") + std::strerror(error));
+  }
+}
+
+
+void AsyncReadBuffer::complete()
+{
+  size_t index;
+  int result;
+  m_ring->wait(&index, &result);
+
+  buffer_struct & buffer = m_buffers[index];
+  buffer.pending = false;
+  if (result == -EINTR || result == -EAGAIN) {
+    submit(index);
+  } else if (result < 0) {
+    buffer.error = -result;
+  } else if (result > 0) {
+    // a short read, which is continued unless the file ended early
+    buffer.filled += static_cast<size_t>(result);
+    if (buffer.filled < buffer.size) {
+      submit(index);
+    }
+  }
+}
+
+
+void AsyncReadBuffer::drain() noexcept
+{
+  for (buffer_struct & buffer : m_buffers) {
+    while (buffer.pending) {
+      if (m_ring == nullptr) {
+        buffer.pending = false;
+        continue;
+      }
+
+      try {
+        complete();
+      } catch (std::exception const &) {
+        // the kernel may still write into the buffers of reads which cannot
+        // be waited for, so they are never freed
+        for (buffer_struct & other : m_buffers) {
+          if (other.pending) {
+            other.data.release();
+            other.pending = false;
+          }
+        }
+      }
+    }
+  }
+}
+
+
+
+
+}
@@ -0,0 +1,231 @@
+/**
+ * @file AsyncReadBuffer.hpp
+ * @brief A stream buffer which keeps many large reads of a file in flight.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-27
+ */
+
+
+
+
+#ifndef WILDRIVER_ASYNCREADBUFFER_HPP
+#define WILDRIVER_ASYNCREADBUFFER_HPP
+
+
+
+
+#include <cstdint>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+
+
+
+namespace WildRiver
+{
+
+
+/**
+ * @brief A read only stream buffer over a file, read into a pool of large
+ * buffers. With io_uring, reads of all of the buffers ahead of the reader are
+ * kept in flight at once, so that the device is kept busy while the reader
+ * parses the current buffer. Where io_uring is not built or not permitted
+ * (e.g., in some containers), each buffer is instead filled with pread when
+ * the reader reaches it, with the kernel reading ahead of it.
+ *
+ * Seeking within the current buffer only moves the position, and seeking
+ * elsewhere waits for the reads in flight and starts reading at the target.
+ */
+class AsyncReadBuffer : public std::streambuf
+{
+  public:
+    /**
+     * @brief The number of bytes of each buffer.
+     */
+    static size_t const BUFFER_SIZE;
+
+
+    /**
+     * @brief The number of buffers in the pool.
+     */
+    static size_t const NUM_BUFFERS;
+
+
+    /**
+     * @brief Check whether files can be read with this buffer on this
+     * platform.
+     *
+     * @return True if they can.
+     */
+    static bool isSupported() noexcept;
+
+
+    /**
+     * @brief Open a file and start reading it.
+     *
+     * @param name The filename/path.
+     * @param ring Whether to use io_uring if it is available (otherwise
+     * pread is used).
+     *
+     * @throw BadFileException If the file cannot be opened.
+     */
+    AsyncReadBuffer(
+        std::string const & name,
+        bool ring = true);
+
+
+    /**
+     * @brief Wait for the reads in flight, and close the file.
+     */
+    ~AsyncReadBuffer();
+
+
+    /**
+     * @brief Check whether the file is read with io_uring.
+     *
+     * @return True if it is, false if it is read with pread.
+     */
+    bool usesRing() const noexcept
+    {
+      return m_ring != nullptr;
+    }
+
+
+  protected:
+    int_type underflow() override;
+
+
+    pos_type seekoff(
+        off_type off,
+        std::ios_base::seekdir dir,
+        std::ios_base::openmode which) override;
+
+
+    pos_type seekpos(
+        pos_type pos,
+        std::ios_base::openmode which) override;
+
+
+  private:
+    class Ring;
+
+
+    /**
+     * @brief A buffer of the pool, and the read filling it.
+     */
+    struct buffer_struct
+    {
+      buffer_struct() :
+        data(new char[BUFFER_SIZE]),
+        offset(0),
+        size(0),
+        filled(0),
+        pending(false),
+        error(0)
+      {
+        // do nothing
+      }
+
+      std::unique_ptr<char[]> data;
+      size_t offset;
+      size_t size;
+      size_t filled;
+      bool pending;
+      int error;
+    };
+
+
+    std::string const m_name;
+    int m_fd;
+    size_t m_fileSize;
+    std::vector<buffer_struct> m_buffers;
+    std::unique_ptr<Ring> m_ring;
+    size_t m_first;
+    size_t m_numUsed;
+    bool m_hasCurrent;
+    size_t m_position;
+    size_t m_nextOffset;
+
+
+    /**
+     * @brief Start reading at an offset, after waiting for the reads in
+     * flight.
+     *
+     * @param offset The offset.
+     */
+    void start(
+        size_t offset);
+
+
+    /**
+     * @brief Start reads into the free buffers of the pool, up to the end of
+     * the file.
+     */
+    void fill();
+
+
+    /**
+     * @brief Release the current buffer, and move to the next one once it is
+     * filled.
+     *
+     * @return False if the end of the file was reached.
+     */
+    bool advance();
+
+
+    /**
+     * @brief Start reading the rest of a buffer.
+     *
+     * @param index The index of the buffer.
+     */
+    void submit(
+        size_t index);
+
+
+    /**
+     * @brief Wait for a buffer to be filled.
+     *
+     * @param index The index of the buffer.
+     *
+     * @throw BadFileException If reading fails.
+     */
+    void wait(
+        size_t index);
+
+
+    /**
+     * @brief Wait for the next read in flight to complete.
+     */
+    void complete();
+
+
+    /**
+     * @brief Wait for every read in flight to complete.
+     */
+    void drain() noexcept;
+
+
+    // disable copying
+    AsyncReadBuffer(
+        AsyncReadBuffer const & rhs);
+    AsyncReadBuffer & operator=(
+        AsyncReadBuffer const & rhs);
+
+
+
+
+};
+
+
+
+
+}
+
+
+
+
+#endif
@@ -0,0 +1,493 @@
+/**
+* @file BCSRFile.cpp
+* @brief Implementation of the BCSRFile class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-05-09
+*/
+
+
+
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+
+#include "BCSRFile.hpp"
+#include "CancelToken.hpp"
+#include "Compression.hpp"
+#include "IOStats.hpp"
+#include "ProgressMonitor.hpp"
+#include "TextFile.hpp"
+#include "Exception.hpp"
+#include "TypeList.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+char const MAGIC[8] = {'W', 'R', 'B', 'C', 'S', 'R', '0', '1'};
+
+/**
+* @brief The size of the header in bytes.
+*/
+std::streamoff const HEADER_SIZE = 40;
+
+/**
+* @brief The number of non-zeros to buffer before writing.
+*/
+size_t const BUFFER_SIZE = 65536;
+
+
+}
+
+
+
+
+/******************************************************************************
+* HELPER FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+/**
+* @brief Read an array from the stream in blocks, updating the progress as
+* each block is read. Elements are stored in the file as type S, and
+* converted to type T if they differ.
+*
+* @tparam S The type of element in the file.
+* @tparam T The type of element in memory.
+* @param stream The stream to read from.
+* @param data The array to fill.
+* @param num The number of elements.
+* @param progress The progress variable (may be null).
+* @param start The progress at the start of the array.
+* @param share The share of the total progress this array represents.
+*/
+template<typename S, typename T>
+void readArray(
+    std::fstream & stream,
+    T * const data,
+    size_t const num,
+    double * const progress,
+    double const start,
+    double const share)
+{
+  size_t const block = BUFFER_SIZE;
+  std::vector<S> buffer(std::is_same<S, T>::value ? 0 : \
+      std::min(block, num));
+  for (size_t i = 0; i < num; i += block) {
+    CancelToken::checkCurrent();
+
+    size_t const size = std::min(block, num - i);
+    if (std::is_same<S, T>::value) {
+      stream.read(reinterpret_cast<char*>(data + i), size*sizeof(T));
+    } else {
+      stream.read(reinterpret_cast<char*>(buffer.data()), size*sizeof(S));
+      for (size_t j = 0; j < size; ++j) {
+        data[i+j] = static_cast<T>(buffer[j]);
+      }
+    }
+    if (!stream) {
+      throw BadFileException("Unexpected end of binary CSR file.");
+    }
+    ProgressMonitor::addCurrentBytes(size*sizeof(S));
+    if (progress) {
+      *progress = start + (share*(i+size))/num;
+    }
+  }
+}
+
+
+/**
+* @brief Write an array to the stream.
+*
+* @tparam T The type of element.
+* @param stream The stream to write to.
+* @param data The array.
+* @param num The number of elements.
+*/
+template<typename T>
+void writeArray(
+    std::fstream & stream,
+    T const * const data,
+    size_t const num)
+{
+  stream.write(reinterpret_cast<char const*>(data), num*sizeof(T));
+  if (!stream) {
+    throw BadFileException("Failed to write to binary CSR file.");
+  }
+  IOStats::addCurrentBytes(num*sizeof(T));
+}
+
+
+}
+
+
+
+
+/******************************************************************************
+* PUBLIC STATIC FUNCTIONS *****************************************************
+******************************************************************************/
+
+
+bool BCSRFile::hasExtension(
+    std::string const & f)
+{
+  std::vector<std::string> extensions;
+
+  extensions.push_back(".bcsr");
+
+  // binary files are read and written directly, never compressed
+  return Compression::fromExtension(f) == COMPRESSION_NONE && \
+      TextFile::matchExtension(f,extensions);
+}
+
+
+
+
+/******************************************************************************
+* CONSTRUCTORS / DESTRUCTOR ***************************************************
+******************************************************************************/
+
+
+BCSRFile::BCSRFile(
+    std::string const & fname) :
+  m_infoSet(false),
+  m_numRows(NULL_DIM),
+  m_numCols(NULL_DIM),
+  m_nnz(NULL_IND),
+  m_rowsWritten(0),
+  m_nnzWritten(0),
+  m_rowptrBuffer(),
+  m_rowindBuffer(),
+  m_rowvalBuffer(),
+  m_name(fname),
+  m_stream(),
+  m_rowindOffset(0),
+  m_rowvalOffset(0)
+{
+  // do nothing
+}
+
+
+BCSRFile::~BCSRFile()
+{
+  // do nothing
+}
+
+
+
+
+/******************************************************************************
+* PUBLIC FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+void BCSRFile::getInfo(
+    dim_t & nrows,
+    dim_t & ncols,
+    ind_t & nnz)
+{
+  if (!m_infoSet) {
+    readHeader();
+  }
+
+  nrows = m_numRows;
+  ncols = m_numCols;
+  nnz = m_nnz;
+}
+
+
+void BCSRFile::setInfo(
+    dim_t const nrows,
+    dim_t const ncols,
+    ind_t const nnz)
+{
+  writeHeader(nrows, ncols, nnz);
+}
+
+
+void BCSRFile::read(
+    ind_t * const rowptr,
+    dim_t * const rowind,
+    val_t * const rowval,
+    double * const progress)
+{
+  readTyped(rowptr, rowind, rowval, progress);
+}
+
+
+template<typename I, typename D, typename V>
+void BCSRFile::readTyped(
+    I * const rowptr,
+    D * const rowind,
+    V * const rowval,
+    double * const progress)
+{
+  if (!m_infoSet) {
+    throw UnsetInfoException("Cannot call read() before calling getInfo()");
+  }
+
+  m_stream.seekg(HEADER_SIZE);
+
+  ProgressMonitor::setCurrentPhase(WILDRIVER_PHASE_READ);
+  ProgressMonitor::Counter counter;
+
+  readArray<ind_t>(m_stream, rowptr, m_numRows+1, progress, 0.0, 0.2);
+  if (rowptr[0] != 0 || static_cast<ind_t>(rowptr[m_numRows]) != m_nnz) {
+    throw BadFileException("Invalid row pointer in binary CSR file.");
+  }
+  readArray<dim_t>(m_stream, rowind, m_nnz, progress, 0.2, 0.4);
+  if (rowval) {
+    readArray<val_t>(m_stream, rowval, m_nnz, progress, 0.6, 0.4);
+  }
+  counter.update(m_numRows, m_nnz);
+
+  if (progress) {
+    *progress = 1.0;
+  }
+}
+
+
+void BCSRFile::write(
+    ind_t const * const rowptr,
+    dim_t const * const rowind,
+    val_t const * const rowval)
+{
+  if (!m_infoSet) {
+    throw UnsetInfoException("Cannot call write() before calling setInfo()");
+  }
+
+  if (rowptr[m_numRows] != m_nnz) {
+    throw BadParameterException("Row pointer does not match the number of " \
+        "non-zeros.");
+  }
+
+  // as we have the whole matrix, skip the buffers
+  m_stream.seekp(HEADER_SIZE);
+  writeArray(m_stream, rowptr, m_numRows+1);
+  writeArray(m_stream, rowind, m_nnz);
+  if (rowval) {
+    writeArray(m_stream, rowval, m_nnz);
+  } else {
+    std::vector<val_t> ones(std::min(m_nnz, static_cast<ind_t>(BUFFER_SIZE)), \
+        1);
+    for (ind_t i = 0; i < m_nnz; i += ones.size()) {
+      writeArray(m_stream, ones.data(), std::min(ones.size(), m_nnz - i));
+    }
+  }
+
+  m_rowsWritten = m_numRows;
+  m_nnzWritten = m_nnz;
+  m_rowptrBuffer.clear();
+
+  m_stream.close();
+}
+
+
+void BCSRFile::writeHeader(
+    dim_t const numRows,
+    dim_t const numCols,
+    ind_t const nnz)
+{
+  m_stream.open(m_name, std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!m_stream.is_open()) {
+    throw BadFileException(std::string("Unable to open '") + m_name + \
+        std::string("' for writing."));
+  }
+
+  m_numRows = numRows;
+  m_numCols = numCols;
+  m_nnz = nnz;
+  m_infoSet = true;
+
+  m_rowindOffset = HEADER_SIZE + (numRows+1)*sizeof(ind_t);
+  m_rowvalOffset = m_rowindOffset + nnz*sizeof(dim_t);
+
+  uint64_t const dims[3] = {numRows, numCols, nnz};
+  uint8_t const types[8] = {
+    sizeof(ind_t),
+    sizeof(dim_t),
+    sizeof(val_t),
+    std::numeric_limits<val_t>::is_integer ? 0 : 1,
+    0, 0, 0, 0
+  };
+
+  m_stream.write(MAGIC, sizeof(MAGIC));
+  IOStats::addCurrentBytes(sizeof(MAGIC));
+  writeArray(m_stream, dims, 3);
+  writeArray(m_stream, types, 8);
+
+  m_rowsWritten = 0;
+  m_nnzWritten = 0;
+  m_rowptrBuffer.assign(1, 0);
+  m_rowindBuffer.clear();
+  m_rowvalBuffer.clear();
+
+  if (numRows == 0) {
+    flush();
+  }
+}
+
+
+void BCSRFile::setNextRow(
+    dim_t const numNonZeros,
+    dim_t const * const columns,
+    val_t const * const values)
+{
+  if (!m_infoSet) {
+    throw UnsetInfoException("Cannot call setNextRow() before calling " \
+        "writeHeader()");
+  }
+
+  if (m_rowsWritten >= m_numRows) {
+    throw BadParameterException("Attempt to write more rows than declared " \
+        "in the header.");
+  }
+  if (m_nnzWritten + numNonZeros > m_nnz) {
+    throw BadParameterException("Attempt to write more non-zeros than " \
+        "declared in the header.");
+  }
+
+  m_rowindBuffer.insert(m_rowindBuffer.end(), columns, columns+numNonZeros);
+  if (values) {
+    m_rowvalBuffer.insert(m_rowvalBuffer.end(), values, values+numNonZeros);
+  } else {
+    m_rowvalBuffer.insert(m_rowvalBuffer.end(), numNonZeros, 1);
+  }
+
+  ++m_rowsWritten;
+  m_nnzWritten += numNonZeros;
+  m_rowptrBuffer.emplace_back(m_nnzWritten);
+
+  if (m_rowsWritten == m_numRows || m_rowindBuffer.size() >= BUFFER_SIZE || \
+      m_rowptrBuffer.size() >= BUFFER_SIZE) {
+    flush();
+  }
+}
+
+
+
+
+/******************************************************************************
+* PRIVATE FUNCTIONS ***********************************************************
+******************************************************************************/
+
+
+void BCSRFile::readHeader()
+{
+  m_stream.open(m_name, std::ios::in | std::ios::binary);
+  if (!m_stream.is_open()) {
+    throw BadFileException(std::string("Unable to open '") + m_name + \
+        std::string("' for reading."));
+  }
+
+  if (ProgressMonitor::getCurrent() != nullptr) {
+    m_stream.seekg(0, std::ios::end);
+    ProgressMonitor::addCurrentTotalBytes( \
+        static_cast<size_t>(m_stream.tellg()));
+    m_stream.seekg(0, std::ios::beg);
+  }
+  ProgressMonitor::addCurrentBytes(static_cast<size_t>(HEADER_SIZE));
+
+  char magic[sizeof(MAGIC)];
+  uint64_t dims[3];
+  uint8_t types[8];
+
+  m_stream.read(magic, sizeof(magic));
+  m_stream.read(reinterpret_cast<char*>(dims), sizeof(dims));
+  m_stream.read(reinterpret_cast<char*>(types), sizeof(types));
+  if (!m_stream || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+    throw BadFileException(std::string("Invalid binary CSR header in '") + \
+        m_name + std::string("'."));
+  }
+
+  if (types[0] != sizeof(ind_t) || types[1] != sizeof(dim_t) || \
+      types[2] != sizeof(val_t) || \
+      types[3] != (std::numeric_limits<val_t>::is_integer ? 0 : 1)) {
+    throw BadFileException(std::string("Binary CSR file '") + m_name + \
+        std::string("' was written with different index/value types."));
+  }
+
+  if (dims[0] >= static_cast<uint64_t>(NULL_DIM) || \
+      dims[1] >= static_cast<uint64_t>(NULL_DIM) || \
+      dims[2] >= static_cast<uint64_t>(NULL_IND)) {
+    throw BadFileException(std::string("Binary CSR file '") + m_name + \
+        std::string("' is too large for the index types."));
+  }
+
+  m_numRows = static_cast<dim_t>(dims[0]);
+  m_numCols = static_cast<dim_t>(dims[1]);
+  m_nnz = static_cast<ind_t>(dims[2]);
+  m_infoSet = true;
+}
+
+
+void BCSRFile::flush()
+{
+  // the first rowptr entry in the buffer, and the first non-zero
+  ind_t const ptrStart = (m_rowsWritten+1) - m_rowptrBuffer.size();
+  ind_t const nnzStart = m_nnzWritten - m_rowindBuffer.size();
+
+  m_stream.seekp(HEADER_SIZE + ptrStart*sizeof(ind_t));
+  writeArray(m_stream, m_rowptrBuffer.data(), m_rowptrBuffer.size());
+
+  if (!m_rowindBuffer.empty()) {
+    m_stream.seekp(m_rowindOffset + nnzStart*sizeof(dim_t));
+    writeArray(m_stream, m_rowindBuffer.data(), m_rowindBuffer.size());
+    m_stream.seekp(m_rowvalOffset + nnzStart*sizeof(val_t));
+    writeArray(m_stream, m_rowvalBuffer.data(), m_rowvalBuffer.size());
+  }
+
+  m_rowptrBuffer.clear();
+  m_rowindBuffer.clear();
+  m_rowvalBuffer.clear();
+
+  if (m_rowsWritten == m_numRows) {
+    if (m_nnzWritten != m_nnz) {
+      throw BadParameterException(std::string("Only ") + \
+          std::to_string(m_nnzWritten) + std::string(" of ") + \
+          std::to_string(m_nnz) + std::string(" declared non-zeros were " \
+          "written."));
+    }
+    m_stream.close();
+  }
+}
+
+
+
+
+/******************************************************************************
+* EXPLICIT INSTANTIATIONS *****************************************************
+******************************************************************************/
+
+
+#define WILDRIVER_INSTANTIATE_BCSR(I, D, V) \
+  template void BCSRFile::readTyped<I, D, V>(I*, D*, V*, double*);
+WILDRIVER_FOR_EACH_TYPE(WILDRIVER_INSTANTIATE_BCSR)
+#undef WILDRIVER_INSTANTIATE_BCSR
+
+
+
+
+}
@@ -0,0 +1,302 @@
+/**
+* @file BCSRFile.hpp
+* @brief Class for reading/writing binary CSR files.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-05-09
+*/
+
+
+
+
+#ifndef WILDRIVER_BCSRFILE_HPP
+#define WILDRIVER_BCSRFILE_HPP
+
+
+
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+#include "IMatrixReader.hpp"
+#include "IMatrixWriter.hpp"
+#include "IRowMatrixWriter.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/**
+* @brief A class for reading and writing matrices in a binary CSR format. The
+* file consists of a fixed size header followed by the raw rowptr, rowind,
+* and rowval arrays:
+*
+* ```
+* char[8]  magic ("WRBCSR01")
+* uint64   nrows
+* uint64   ncols
+* uint64   nnz
+* uint8    sizeof(ind_t)
+* uint8    sizeof(dim_t)
+* uint8    sizeof(val_t)
+* uint8    whether val_t is floating point
+* uint8[4] padding
+* ind_t    rowptr[nrows+1]
+* dim_t    rowind[nnz]
+* val_t    rowval[nnz]
+* ```
+*
+* As the position of each array is known from the header, the file can be
+* written row by row.
+*/
+class BCSRFile :
+    public IMatrixReader,
+    public IMatrixWriter,
+    public IRowMatrixWriter
+{
+  public:
+    /**
+     * @brief Check if the given filename matches an extension for this
+     * filetype.
+     *
+     * @param f The filename.
+     *
+     * @return True if the extension matches this filetype.
+     */
+    static bool hasExtension(
+        std::string const & f);
+
+
+    /**
+     * @brief Create a new BCSRFile for reading and writing.
+     *
+     * @param fname The filename/path.
+     */
+    BCSRFile(
+        std::string const & fname);
+
+
+    /**
+     * @brief Flush any buffered rows and close the file.
+     */
+    virtual ~BCSRFile();
+
+
+    /**
+     * @brief Get the number of rows, columns, and non-zeros in the matrix.
+     *
+     * @param nrows The number of rows.
+     * @param ncols The number of columns.
+     * @param nnz THe number of non-zeros.
+     */
+    virtual void getInfo(
+        dim_t & nrows,
+        dim_t & ncols,
+        ind_t & nnz) override;
+
+
+    /**
+     * @brief Set the matrix information for this file.
+     *
+     * @param nrows The number of rows in the matrix.
+     * @param ncols The number of columns in the matrix.
+     * @param nnz The number of non-zeroes in the matrix.
+     */
+    virtual void setInfo(
+        dim_t nrows,
+        dim_t ncols,
+        ind_t nnz) override;
+
+
+    /**
+     * @brief Get the sparse matrix in CSR form. The pointers must be
+     * pre-allocated to the sizes required by the info of the matrix
+     *
+     * |rowptr| = nrows + 1
+     * |rowind| = nnz
+     * |rowval| = nnz
+     *
+     * @param rowptr The row pointer indicating the start of each row.
+     * @param rowind The row column indexs (i.e., for each element in a row,
+     * the column index corresponding to that element).
+     * @param rowval The row values (may be null).
+     * @param progress The variable to update as the matrix is loaded (may be
+     * null).
+     */
+    virtual void read(
+        ind_t * rowptr,
+        dim_t * rowind,
+        val_t * rowval,
+        double * progress) override;
+
+
+    /**
+    * @brief Get the sparse matrix in CSR form using the given types,
+    * converting each block as it is read (i.e., without an intermediate copy
+    * in the native types). The header must already have been read via
+    * getInfo().
+    *
+    * @tparam I The index type.
+    * @tparam D The dimension type.
+    * @tparam V The value type.
+    * @param rowptr The row pointer indicating the start of each row.
+    * @param rowind The column index of each entry.
+    * @param rowval The value of each entry (may be null).
+    * @param progress The variable to update as the matrix is loaded (may be
+    * null).
+    */
+    template<typename I, typename D, typename V>
+    void readTyped(
+        I * rowptr,
+        D * rowind,
+        V * rowval,
+        double * progress);
+
+
+    /**
+     * @brief Write the given CSR structure to the file. The information for
+     * the matrix must already be set.
+     *
+     * @param rowptr The row pointer indicating the start of each row.
+     * @param rowind The row column indexs (i.e., for each element in a row,
+     * the column index corresponding to that element).
+     * @param rowval The row values.
+     */
+    virtual void write(
+        ind_t const * rowptr,
+        dim_t const * rowind,
+        val_t const * rowval) override;
+
+
+    /**
+     * @brief Write the header to the file, and reserve space for the arrays.
+     *
+     * @param numRows The number of rows.
+     * @param numCols The number of columns.
+     * @param nnz The number of non-zeros.
+     */
+    void writeHeader(
+        dim_t numRows,
+        dim_t numCols,
+        ind_t nnz) override;
+
+
+    /**
+     * @brief Set the next row in the matrix file. Rows are buffered, and
+     * written once the buffers fill or the last row is set.
+     *
+     * @param numNonZeros The number of non-zeros in the row.
+     * @param columns The column IDs.
+     * @param values The values (may be null for a unit valued row).
+     */
+    void setNextRow(
+        dim_t numNonZeros,
+        dim_t const * columns,
+        val_t const * values) override;
+
+
+  private:
+    /**
+    * @brief Whether or not the header has been read or written.
+    */
+    bool m_infoSet;
+
+    /**
+    * @brief The number of rows in the matrix.
+    */
+    dim_t m_numRows;
+
+    /**
+    * @brief The number of columns in the matrix.
+    */
+    dim_t m_numCols;
+
+    /**
+    * @brief The number of non-zeros in the matrix.
+    */
+    ind_t m_nnz;
+
+    /**
+    * @brief The number of rows set so far.
+    */
+    dim_t m_rowsWritten;
+
+    /**
+    * @brief The number of non-zeros set so far.
+    */
+    ind_t m_nnzWritten;
+
+    /**
+    * @brief The rowptr entries waiting to be written.
+    */
+    std::vector<ind_t> m_rowptrBuffer;
+
+    /**
+    * @brief The column indexes waiting to be written.
+    */
+    std::vector<dim_t> m_rowindBuffer;
+
+    /**
+    * @brief The values waiting to be written.
+    */
+    std::vector<val_t> m_rowvalBuffer;
+
+    /**
+    * @brief The filename/path.
+    */
+    std::string m_name;
+
+    /**
+    * @brief The underlying binary stream.
+    */
+    std::fstream m_stream;
+
+    /**
+    * @brief The position of the rowind array in the file.
+    */
+    std::streamoff m_rowindOffset;
+
+    /**
+    * @brief The position of the rowval array in the file.
+    */
+    std::streamoff m_rowvalOffset;
+
+
+    /**
+    * @brief Read the header from the file.
+    */
+    void readHeader();
+
+
+    /**
+    * @brief Write out the buffered rows.
+    */
+    void flush();
+
+
+    // disable copying
+    BCSRFile(
+        BCSRFile const & rhs);
+    BCSRFile & operator=(
+        BCSRFile const & rhs);
+
+
+
+
+};
+
+
+
+
+}
+
+
+
+
+#endif
@@ -0,0 +1,126 @@
+/**
+ * @file BatchLoader.cpp
+ * @brief Implementation of the BatchLoader class.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-24
+ */
+
+
+
+
+#include <algorithm>
+
+#include "BatchLoader.hpp"
+#include "CancelToken.hpp"
+#include "IOStats.hpp"
+#include "ProgressMonitor.hpp"
+#include "TextFile.hpp"
+#include "ThreadPool.hpp"
+#include "Tracer.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+
+size_t const BatchLoader::GROUP_BYTES = 4*1024*1024;
+
+
+
+
+/******************************************************************************
+* PUBLIC STATIC FUNCTIONS *****************************************************
+******************************************************************************/
+
+
+std::vector<std::vector<size_t>> BatchLoader::group(
+    std::vector<size_t> const & sizes,
+    size_t const groupBytes)
+{
+  std::vector<size_t> order(sizes.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), \
+      [&sizes](size_t const a, size_t const b) {
+    return sizes[a] > sizes[b];
+  });
+
+  std::vector<std::vector<size_t>> groups;
+  bool open = false;
+  size_t bytes = 0;
+  for (size_t const file : order) {
+    if (sizes[file] >= groupBytes) {
+      groups.emplace_back(1, file);
+    } else {
+      // start a new group when the current one is full
+      if (!open || bytes + sizes[file] > groupBytes) {
+        groups.emplace_back();
+        open = true;
+        bytes = 0;
+      }
+      groups.back().emplace_back(file);
+      bytes += sizes[file];
+    }
+  }
+
+  return groups;
+}
+
+
+std::vector<std::exception_ptr> BatchLoader::load(
+    std::vector<std::string> const & names,
+    std::function<void(size_t)> const & func)
+{
+  std::vector<size_t> sizes(names.size());
+  for (size_t i = 0; i < names.size(); ++i) {
+    // a file whose size cannot be determined reports the error on load
+    sizes[i] = TextFile::getFileSize(names[i]);
+  }
+
+  std::vector<std::vector<size_t>> const groups = group(sizes, GROUP_BYTES);
+
+  std::vector<std::exception_ptr> errors(names.size());
+
+  // the files are loaded under the caller's token, monitor and stats,
+  // whichever thread runs them
+  CancelToken const * const token = CancelToken::getCurrent();
+  ProgressMonitor * const monitor = ProgressMonitor::getCurrent();
+  IOStats * const stats = IOStats::getCurrent();
+
+  ThreadPool::TaskGroup tasks(ThreadPool::getInstance());
+  for (std::vector<size_t> const & files : groups) {
+    tasks.run([&func, &errors, files, token, monitor, stats]() {
+      CancelToken::Scope tokenScope(token);
+      ProgressMonitor::Scope monitorScope(monitor);
+      IOStats::Scope statsScope(stats);
+      for (size_t const file : files) {
+        Tracer::Span span("batch", "load", static_cast<int64_t>(file));
+        try {
+          // files not yet started when the batch is cancelled fail at once
+          CancelToken::checkCurrent();
+          func(file);
+        } catch (...) {
+          errors[file] = std::current_exception();
+        }
+      }
+    });
+  }
+  tasks.wait();
+
+  return errors;
+}
+
+
+
+
+}
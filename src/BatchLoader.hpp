@@ -0,0 +1,92 @@
+/**
+ * @file BatchLoader.hpp
+ * @brief Functions for loading many files concurrently.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-24
+ */
+
+
+
+
+#ifndef WILDRIVER_BATCHLOADER_HPP
+#define WILDRIVER_BATCHLOADER_HPP
+
+
+
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <string>
+#include <vector>
+
+
+
+
+namespace WildRiver
+{
+
+
+class BatchLoader
+{
+  public:
+    /**
+     * @brief The number of bytes of small files to load in a single task.
+     */
+    static size_t const GROUP_BYTES;
+
+
+    /**
+     * @brief Split files into groups to be loaded as single tasks. Files of
+     * at least groupBytes are each given their own group, and smaller files
+     * share groups of up to groupBytes. Groups are ordered from the largest
+     * to the smallest, so that the largest start first.
+     *
+     * @param sizes The size of each file in bytes.
+     * @param groupBytes The number of bytes of small files per group.
+     *
+     * @return The indices of the files in each group.
+     */
+    static std::vector<std::vector<size_t>> group(
+        std::vector<size_t> const & sizes,
+        size_t groupBytes);
+
+
+    /**
+     * @brief Load each file on the library's thread pool, blocking until all
+     * have been loaded. Small files are grouped so that a single task loads
+     * several of them one after another, which amortizes the cost of
+     * scheduling a task per file; each file is still opened and read on its
+     * own, so the I/O itself is not batched. The load function is called
+     * concurrently for different files, and an exception it throws only
+     * fails its own file.
+     * Each file is loaded with the calling thread's cancel token, progress
+     * monitor and I/O stats installed, and once the token is cancelled (or
+     * its deadline passes) the files not yet started fail at once.
+     *
+     * @param names The filenames/paths of the files.
+     * @param func The function loading the file of the given index.
+     *
+     * @return The exception thrown for each file (null for files which
+     * loaded successfully).
+     */
+    static std::vector<std::exception_ptr> load(
+        std::vector<std::string> const & names,
+        std::function<void(size_t)> const & func);
+
+
+
+
+};
+
+
+
+
+}
+
+
+
+
+#endif
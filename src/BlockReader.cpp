@@ -0,0 +1,337 @@
+/**
+ * @file BlockReader.cpp
+ * @brief Implementation of the BlockReader class.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-27
+ */
+
+
+
+
+#include <algorithm>
+#include <cstdint>
+
+#include "BlockReader.hpp"
+#include "Compression.hpp"
+#include "Util.hpp"
+#include "Exception.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+/**
+ * @brief The number of bytes to read ahead at a time.
+ */
+size_t const READ_AHEAD = 1024*1024;
+
+
+/**
+ * @brief The size of the fixed part of a gzip header, before the extra
+ * field.
+ */
+size_t const GZIP_HEADER_SIZE = 12;
+
+
+/**
+ * @brief The size of the footer of a zstd seekable file.
+ */
+size_t const SEEK_TABLE_FOOTER_SIZE = 9;
+
+
+/**
+ * @brief The magic numbers of the table of a zstd seekable file, and of the
+ * skippable frame holding it.
+ */
+uint32_t const SEEKABLE_MAGIC = 0x8F92EAB1;
+uint32_t const SEEK_TABLE_FRAME_MAGIC = 0x184D2A5E;
+
+
+}
+
+
+
+
+/******************************************************************************
+* PUBLIC STATIC FUNCTIONS *****************************************************
+******************************************************************************/
+
+
+bool BlockReader::isBlocked(
+    std::string const & name)
+{
+  int const compression = Compression::fromMagic(name);
+  if (compression != COMPRESSION_GZIP && compression != COMPRESSION_ZSTD) {
+    return false;
+  }
+
+  try {
+    BlockReader reader(name);
+  } catch (BadFileException const &) {
+    return false;
+  }
+
+  return true;
+}
+
+
+std::vector<BlockReader::block_struct> BlockReader::readIndex(
+    std::string const & name)
+{
+  BlockReader reader(name);
+
+  std::vector<block_struct> index;
+  block_struct block;
+  while (reader.next(block, nullptr)) {
+    if (block.size > 0) {
+      index.emplace_back(block);
+    }
+  }
+
+  return index;
+}
+
+
+size_t BlockReader::findBlock(
+    std::vector<block_struct> const & index,
+    size_t const offset)
+{
+  std::vector<block_struct>::const_iterator const it = \
+      std::upper_bound(index.begin(), index.end(), offset, \
+          [](size_t const value, block_struct const & block) {
+            return value < block.offset;
+          });
+
+  return it == index.begin() ? 0 : \
+      static_cast<size_t>(it - index.begin()) - 1;
+}
+
+
+
+
+/******************************************************************************
+* CONSTRUCTORS / DESTRUCTOR ***************************************************
+******************************************************************************/
+
+
+BlockReader::BlockReader(
+    std::string const & name) :
+  m_name(name),
+  m_compression(Compression::fromMagic(name)),
+  m_file(name, std::ifstream::in | std::ifstream::binary),
+  m_fileSize(0),
+  m_buffer(READ_AHEAD),
+  m_bufferStart(0),
+  m_bufferSize(0),
+  m_compressedOffset(0),
+  m_offset(0),
+  m_frames(),
+  m_nextFrame(0)
+{
+  if (!m_file.is_open()) {
+    throw BadFileException(std::string("Failed to open file '") + \
+        name + std::string("'"));
+  }
+
+  m_file.seekg(0, std::ifstream::end);
+  m_fileSize = static_cast<size_t>(m_file.tellg());
+
+  if (m_compression == COMPRESSION_GZIP) {
+    // the first block must be a BGZF block
+    readGzipBlockSize(0);
+  } else if (m_compression == COMPRESSION_ZSTD) {
+    readSeekTable();
+  } else {
+    throw BadFileException(std::string("File '") + name + \
+        std::string("' is not block compressed."));
+  }
+}
+
+
+
+
+/******************************************************************************
+* PUBLIC FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+bool BlockReader::next(
+    block_struct & block,
+    std::string * const data)
+{
+  if (m_compression == COMPRESSION_ZSTD) {
+    if (m_nextFrame == m_frames.size()) {
+      return false;
+    }
+    block = m_frames[m_nextFrame++];
+  } else {
+    if (m_compressedOffset >= m_fileSize) {
+      return false;
+    }
+    size_t const size = readGzipBlockSize(m_compressedOffset);
+    block.compressedOffset = m_compressedOffset;
+    block.compressedSize = size;
+    block.offset = m_offset;
+    block.size = static_cast<size_t>(Util::readLittleEndian( \
+        fetch(m_compressedOffset + size - 4, 4), 4));
+
+    m_compressedOffset += size;
+    m_offset += block.size;
+  }
+
+  if (data != nullptr) {
+    data->append(fetch(block.compressedOffset, block.compressedSize), \
+        block.compressedSize);
+  }
+
+  return true;
+}
+
+
+
+
+/******************************************************************************
+* PRIVATE FUNCTIONS ***********************************************************
+******************************************************************************/
+
+
+char const * BlockReader::fetch(
+    size_t const offset,
+    size_t const size)
+{
+  if (offset < m_bufferStart || \
+      offset + size > m_bufferStart + m_bufferSize) {
+    if (offset + size > m_fileSize) {
+      throw BadFileException(std::string("Unexpected end of compressed " \
+          "file '") + m_name + std::string("'"));
+    }
+
+    size_t const length = std::min(std::max(size, READ_AHEAD), \
+        m_fileSize - offset);
+    if (m_buffer.size() < length) {
+      m_buffer.resize(length);
+    }
+
+    m_file.clear();
+    m_file.seekg(static_cast<std::streamoff>(offset));
+    m_file.read(m_buffer.data(), length);
+    if (static_cast<size_t>(m_file.gcount()) != length) {
+      throw BadFileException(std::string("Failed to read file '") + \
+          m_name + std::string("'"));
+    }
+
+    m_bufferStart = offset;
+    m_bufferSize = length;
+  }
+
+  return m_buffer.data() + (offset - m_bufferStart);
+}
+
+
+size_t BlockReader::readGzipBlockSize(
+    size_t const offset)
+{
+  char const * header = fetch(offset, GZIP_HEADER_SIZE);
+  if (static_cast<unsigned char>(header[0]) == 0x1f && \
+      static_cast<unsigned char>(header[1]) == 0x8b && header[2] == 8 && \
+      (header[3] & 4) != 0) {
+    size_t const extraSize = static_cast<size_t>( \
+        Util::readLittleEndian(header + 10, 2));
+    char const * const extra = \
+        fetch(offset, GZIP_HEADER_SIZE + extraSize) + GZIP_HEADER_SIZE;
+
+    // find the 'BC' subfield holding the block size
+    size_t pos = 0;
+    while (pos + 4 <= extraSize) {
+      size_t const length = static_cast<size_t>( \
+          Util::readLittleEndian(extra + pos + 2, 2));
+      if (extra[pos] == 'B' && extra[pos+1] == 'C' && length == 2 && \
+          pos + 6 <= extraSize) {
+        return static_cast<size_t>( \
+            Util::readLittleEndian(extra + pos + 4, 2)) + 1;
+      }
+      pos += 4 + length;
+    }
+  }
+
+  throw BadFileException(std::string("File '") + m_name + \
+      std::string("' has a gzip member which is not a BGZF block at byte ") + \
+      std::to_string(offset) + std::string("."));
+}
+
+
+void BlockReader::readSeekTable()
+{
+  if (m_fileSize < SEEK_TABLE_FOOTER_SIZE) {
+    throw BadFileException(std::string("File '") + m_name + \
+        std::string("' is not a zstd seekable file."));
+  }
+
+  char const * const footer = \
+      fetch(m_fileSize - SEEK_TABLE_FOOTER_SIZE, SEEK_TABLE_FOOTER_SIZE);
+  size_t const numFrames = \
+      static_cast<size_t>(Util::readLittleEndian(footer, 4));
+  bool const checksums = (static_cast<unsigned char>(footer[4]) & 0x80) != 0;
+  if (Util::readLittleEndian(footer + 5, 4) != SEEKABLE_MAGIC) {
+    throw BadFileException(std::string("File '") + m_name + \
+        std::string("' is not a zstd seekable file."));
+  }
+
+  size_t const entrySize = checksums ? 12 : 8;
+  size_t const tableSize = numFrames * entrySize + SEEK_TABLE_FOOTER_SIZE;
+  if (tableSize + 8 > m_fileSize) {
+    throw BadFileException(std::string("Truncated seek table in '") + \
+        m_name + std::string("'."));
+  }
+
+  // the table is the content of a skippable frame
+  size_t const frameStart = m_fileSize - tableSize - 8;
+  char const * const frame = fetch(frameStart, 8);
+  if (Util::readLittleEndian(frame, 4) != SEEK_TABLE_FRAME_MAGIC || \
+      Util::readLittleEndian(frame + 4, 4) != tableSize) {
+    throw BadFileException(std::string("Corrupt seek table in '") + \
+        m_name + std::string("'."));
+  }
+
+  char const * const entries = fetch(frameStart + 8, numFrames * entrySize);
+  m_frames.resize(numFrames);
+  size_t compressedOffset = 0;
+  size_t offset = 0;
+  for (size_t i = 0; i < numFrames; ++i) {
+    char const * const entry = entries + i*entrySize;
+    block_struct & block = m_frames[i];
+    block.compressedOffset = compressedOffset;
+    block.compressedSize = \
+        static_cast<size_t>(Util::readLittleEndian(entry, 4));
+    block.offset = offset;
+    block.size = \
+        static_cast<size_t>(Util::readLittleEndian(entry + 4, 4));
+
+    compressedOffset += block.compressedSize;
+    offset += block.size;
+  }
+
+  if (compressedOffset != frameStart) {
+    throw BadFileException(std::string("Seek table of '") + m_name + \
+        std::string("' does not match its frames."));
+  }
+}
+
+
+
+
+}
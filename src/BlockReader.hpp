@@ -0,0 +1,196 @@
+/**
+ * @file BlockReader.hpp
+ * @brief Reader of the independent blocks of block compressed files.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-27
+ */
+
+
+
+
+#ifndef WILDRIVER_BLOCKREADER_HPP
+#define WILDRIVER_BLOCKREADER_HPP
+
+
+
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+
+
+namespace WildRiver
+{
+
+
+/**
+ * @brief Reads the compressed blocks of a block compressed file, each of
+ * which can be decompressed on its own: BGZF files (gzip files made of
+ * members of at most 64 KiB, with each member's size in its header), and
+ * zstd seekable files (zstd frames followed by a table of their sizes). Both
+ * remain standard gzip and zstd files.
+ *
+ * The blocks are found without decompressing anything, so that they can be
+ * decompressed on separate threads, and their index allows seeking to any
+ * offset of the decompressed contents.
+ */
+class BlockReader
+{
+  public:
+    /**
+     * @brief The location of a block, in the compressed file and in the
+     * decompressed contents.
+     */
+    struct block_struct
+    {
+      size_t compressedOffset;
+      size_t compressedSize;
+      size_t offset;
+      size_t size;
+    };
+
+
+    /**
+     * @brief Check whether a file is block compressed.
+     *
+     * @param name The filename/path.
+     *
+     * @return True if it is a BGZF or zstd seekable file.
+     */
+    static bool isBlocked(
+        std::string const & name);
+
+
+    /**
+     * @brief Build the index of the non-empty blocks of a file. For BGZF
+     * files this reads the header and footer of each block.
+     *
+     * @param name The filename/path.
+     *
+     * @return The blocks, in order.
+     *
+     * @throw BadFileException If the file is not block compressed.
+     */
+    static std::vector<block_struct> readIndex(
+        std::string const & name);
+
+
+    /**
+     * @brief Find the block holding an offset of the decompressed contents.
+     *
+     * @param index The index of the blocks.
+     * @param offset The offset.
+     *
+     * @return The position of the block in the index.
+     */
+    static size_t findBlock(
+        std::vector<block_struct> const & index,
+        size_t offset);
+
+
+    /**
+     * @brief Open a block compressed file.
+     *
+     * @param name The filename/path.
+     *
+     * @throw BadFileException If the file cannot be opened or is not block
+     * compressed.
+     */
+    BlockReader(
+        std::string const & name);
+
+
+    /**
+     * @brief Get the compression of the blocks.
+     *
+     * @return The compression (a compression_type).
+     */
+    int getCompression() const noexcept
+    {
+      return m_compression;
+    }
+
+
+    /**
+     * @brief Read the next block.
+     *
+     * @param block The location of the block (output).
+     * @param data The string to append the compressed block to (may be
+     * null to only locate it).
+     *
+     * @return False if there are no more blocks.
+     *
+     * @throw BadFileException If the file is truncated or corrupt.
+     */
+    bool next(
+        block_struct & block,
+        std::string * data);
+
+
+  private:
+    std::string const m_name;
+    int m_compression;
+    std::ifstream m_file;
+    size_t m_fileSize;
+    std::vector<char> m_buffer;
+    size_t m_bufferStart;
+    size_t m_bufferSize;
+    size_t m_compressedOffset;
+    size_t m_offset;
+    std::vector<block_struct> m_frames;
+    size_t m_nextFrame;
+
+
+    /**
+     * @brief Get bytes of the file, reading ahead of them.
+     *
+     * @param offset The offset of the first byte.
+     * @param size The number of bytes.
+     *
+     * @return The bytes, valid until the next call.
+     *
+     * @throw BadFileException If the file ends first.
+     */
+    char const * fetch(
+        size_t offset,
+        size_t size);
+
+
+    /**
+     * @brief Get the size of the BGZF block starting at an offset.
+     *
+     * @param offset The offset of the block.
+     *
+     * @return The number of bytes of the block.
+     *
+     * @throw BadFileException If it is not a BGZF block.
+     */
+    size_t readGzipBlockSize(
+        size_t offset);
+
+
+    /**
+     * @brief Read the table of frames of a zstd seekable file.
+     *
+     * @throw BadFileException If the file has no valid table.
+     */
+    void readSeekTable();
+
+
+
+
+};
+
+
+
+
+}
+
+
+
+
+#endif
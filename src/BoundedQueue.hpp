@@ -0,0 +1,176 @@
+/**
+* @file BoundedQueue.hpp
+* @brief A blocking queue with a fixed capacity for passing work between
+* threads.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-05-02
+*/
+
+
+
+
+#ifndef WILDRIVER_BOUNDEDQUEUE_HPP
+#define WILDRIVER_BOUNDEDQUEUE_HPP
+
+
+
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+
+
+
+namespace WildRiver
+{
+
+
+/**
+* @brief A multi-producer multi-consumer queue which blocks producers when
+* full and consumers when empty. Once closed, pushes fail and pops drain the
+* remaining items before failing.
+*
+* @tparam T The type of item stored.
+*/
+template<typename T>
+class BoundedQueue
+{
+  public:
+    /**
+    * @brief Create a new queue.
+    *
+    * @param capacity The maximum number of items held at once (must be at
+    * least one).
+    */
+    BoundedQueue(
+        size_t const capacity) :
+      m_capacity(capacity > 0 ? capacity : 1),
+      m_closed(false),
+      m_items(),
+      m_mutex(),
+      m_notEmpty(),
+      m_notFull()
+    {
+      // do nothing
+    }
+
+
+    /**
+    * @brief Deleted copy constructor.
+    *
+    * @param rhs The queue to copy.
+    */
+    BoundedQueue(
+        BoundedQueue const & rhs) = delete;
+
+
+    /**
+    * @brief Deleted assignment operator.
+    *
+    * @param rhs The queue to copy.
+    *
+    * @return This queue.
+    */
+    BoundedQueue & operator=(
+        BoundedQueue const & rhs) = delete;
+
+
+    /**
+    * @brief Add an item to the back of the queue, waiting for space if the
+    * queue is full.
+    *
+    * @param item The item to add.
+    *
+    * @return False if the queue was closed and the item was not added.
+    */
+    bool push(
+        T && item)
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_notFull.wait(lock, [this]() {
+        return m_closed || m_items.size() < m_capacity;
+      });
+
+      if (m_closed) {
+        return false;
+      }
+
+      m_items.emplace_back(std::move(item));
+      lock.unlock();
+
+      m_notEmpty.notify_one();
+
+      return true;
+    }
+
+
+    /**
+    * @brief Remove an item from the front of the queue, waiting for one to
+    * become available.
+    *
+    * @param item The removed item (output).
+    *
+    * @return False if the queue has been closed and is empty.
+    */
+    bool pop(
+        T & item)
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_notEmpty.wait(lock, [this]() {
+        return m_closed || !m_items.empty();
+      });
+
+      if (m_items.empty()) {
+        return false;
+      }
+
+      item = std::move(m_items.front());
+      m_items.pop_front();
+      lock.unlock();
+
+      m_notFull.notify_one();
+
+      return true;
+    }
+
+
+    /**
+    * @brief Close the queue, waking all blocked producers and consumers.
+    */
+    void close()
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+      }
+
+      m_notEmpty.notify_all();
+      m_notFull.notify_all();
+    }
+
+
+  private:
+    size_t const m_capacity;
+    bool m_closed;
+    std::deque<T> m_items;
+    std::mutex m_mutex;
+    std::condition_variable m_notEmpty;
+    std::condition_variable m_notFull;
+
+
+
+
+};
+
+
+
+
+}
+
+
+
+
+#endif
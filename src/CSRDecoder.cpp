@@ -10,7 +10,11 @@
 
 
 
+#include <algorithm>
+
 #include "CSRDecoder.hpp"
+#include "CancelToken.hpp"
+#include "ProgressMonitor.hpp"
 #include "Exception.hpp"
 
 
@@ -70,29 +74,32 @@ void CSRDecoder::read(
     double * progress)
 {
   dim_t const interval = m_numRows > 100 ? m_numRows / 100 : 1;
+  dim_t const batch = std::min(interval, \
+      static_cast<dim_t>(CancelToken::CHECK_INTERVAL));
   double const increment = 1.0/100.0;
 
-  // read in the rows the matrix into our csr
-  dim_t j = 0;
-  rowptr[0] = j;
-  for (dim_t i = 0; i < m_numRows; ++i) {
-    dim_t degree;
-
-    dim_t * const rowindStart = rowind+rowptr[i];
-    val_t * const rowvalStart = rowval ? rowval+rowptr[i] : nullptr;
+  // read in the rows the matrix into our csr, a batch of rows per check of
+  // the token, and a share of the progress for each
+  ProgressMonitor::setCurrentPhase(WILDRIVER_PHASE_READ);
+  ProgressMonitor::Counter counter;
+  rowptr[0] = 0;
+  for (dim_t i = 0; i < m_numRows; i += batch) {
+    dim_t const count = std::min(batch, m_numRows - i);
 
-    m_reader->getNextRow(&degree, rowindStart, rowvalStart);
+    CancelToken::checkCurrent();
 
-    rowptr[i+1] = rowptr[i]+degree;
+    m_reader->getNextRows(count, rowptr+i, rowind, rowval);
+    counter.update(i+count, rowptr[i+count]);
 
-    if (progress != nullptr && i % interval == 0) {
-      *progress += increment;
+    if (progress != nullptr) {
+      *progress += increment*count/interval;
     }
   }
 
   if (rowptr[m_numRows] != m_nnz) {
     // we read in the wrong number of non-zeroes
-    throw EOFException(std::string("Only found ") + std::to_string(j) + \
+    throw EOFException(std::string("Only found ") + \
+        std::to_string(rowptr[m_numRows]) + \
         std::string("/") + std::to_string(m_nnz) + \
         std::string(" non-zeroes in file"));
   }
@@ -10,6 +10,7 @@
 
 
 
+#include <algorithm>
 #include <cassert>
 
 
@@ -22,6 +23,24 @@ namespace WildRiver
 {
 
 
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+/**
+* @brief The number of rows to pass to the writer at a time.
+*/
+dim_t const ROWS_PER_BATCH = 1024;
+
+
+}
+
+
 
 /******************************************************************************
 * CONSTRUCTORS / DESTRUCTOR ***************************************************
@@ -73,9 +92,9 @@ void CSREncoder::write(
     dim_t const * const rowind,
     val_t const * const rowval)
 {
-  for (dim_t i = 0; i < m_numRows; ++i) {
-    ind_t const size = rowptr[i+1] - rowptr[i];
-    m_writer->setNextRow(size, rowind+rowptr[i], rowval+rowptr[i]);
+  for (dim_t i = 0; i < m_numRows; i += ROWS_PER_BATCH) {
+    dim_t const count = std::min(ROWS_PER_BATCH, m_numRows - i);
+    m_writer->setNextRows(count, rowptr+i, rowind, rowval);
   }
 }
 
@@ -18,6 +18,12 @@
 
 
 #include "CSRFile.hpp"
+#include "CancelToken.hpp"
+#include "ProgressMonitor.hpp"
+#include "TypeList.hpp"
+#include "Util.hpp"
+#include "LineIndex.hpp"
+#include "RowPartition.hpp"
 
 
 
@@ -102,13 +108,75 @@ bool CSRFile::hasExtension(
 bool CSRFile::nextNoncommentLine(
     std::string & line)
 {
-  do {
-    if (!m_file.nextLine(line)) {
-      return false;
+  while (m_file.nextLine(line)) {
+    if (!isComment(line)) {
+      return true;
     }
-  } while (isComment(line));
+    m_file.countComment();
+  }
 
-  return true;
+  return false;
+}
+
+
+
+
+template<typename D, typename V>
+dim_t CSRFile::parseRow(
+    D * const columns,
+    V * const values)
+{
+  if (!nextNoncommentLine(m_line)) {
+    throw BadFileException(std::string("Unexcepted end of file at line") + \
+        std::to_string(m_file.getCurrentLine()));
+  }
+
+  return parseLine(columns, values);
+}
+
+
+template<typename D, typename V>
+dim_t CSRFile::parseLine(
+    D * const columns,
+    V * const values)
+{
+  // TOOD: don't cast constness away
+  char * sptr;
+  char * eptr = (char*)m_line.data();
+
+  const dim_t offset = m_oneBased ? 1 : 0;
+
+  dim_t degree = 0;
+  dim_t col;
+
+  // Loop through row until we streamed to the end
+  while (true) {
+    sptr = eptr;
+    col = static_cast<dim_t>(std::strtoull(sptr,&eptr,10));
+    if (eptr == sptr) {
+      // nothing left to read
+      break;
+    }
+
+    sptr = eptr;
+
+    if (values) {
+      double const val = std::strtod(sptr,&eptr);
+      values[degree] = static_cast<V>(val);
+    } else {
+      // pattern only -- skip the value without converting it
+      eptr = Util::skipField(sptr);
+    }
+    if (eptr == sptr) {
+      throw BadFileException(std::string("Failed to read column on "
+            "line ") + std::to_string(m_file.getCurrentLine()));
+    }
+
+    columns[degree] = static_cast<D>(col - offset);
+    ++degree;
+  }
+
+  return degree;
 }
 
 
@@ -125,7 +193,8 @@ CSRFile::CSRFile(
   m_line(BUFFER_SIZE,'\0'),
   m_file(fname),
   m_decoder(nullptr),
-  m_encoder(nullptr)
+  m_encoder(nullptr),
+  m_index(nullptr)
 {
   // do nothing
 }
@@ -216,8 +285,33 @@ void CSRFile::readHeader(
   numRows = 0;
   nnz = 0;
 
-  while (nextNoncommentLine(m_line)) {
-    char const * const lineEnd = m_line.data() + m_line.length();
+  // the index for reading ranges of rows is built during the same scan
+  std::vector<size_t> offsets;
+  std::vector<size_t> fileLines;
+  std::vector<size_t> blockFields;
+
+  while (true) {
+    bool const indexed = numRows % LineIndex::STRIDE == 0;
+    size_t offset = 0;
+    size_t fileLine = 0;
+    if (indexed) {
+      offset = m_file.tell();
+      fileLine = m_file.getCurrentLine();
+    }
+
+    if (!nextNoncommentLine(m_line)) {
+      break;
+    }
+
+    if (indexed) {
+      offsets.emplace_back(offset);
+      fileLines.emplace_back(fileLine);
+      blockFields.emplace_back(0);
+    }
+
+    if (numRows % CancelToken::CHECK_INTERVAL == 0) {
+      CancelToken::checkCurrent();
+    }
 
     char * sptr;
     char * eptr = (char*)m_line.data();
@@ -240,16 +334,20 @@ void CSRFile::readHeader(
       }
 
       // skip value without converting
-      do {
-        ++eptr;
-      } while (eptr < lineEnd && *eptr != ' ');
+      eptr = Util::skipField(eptr);
       ++degree;
     }
 
+    // a column and a value per entry
+    blockFields.back() += 2*static_cast<size_t>(degree);
+
     nnz += degree;
     ++numRows;
   }
 
+  m_index.reset(new LineIndex(m_file.getFilename(), "#", numRows, offsets, \
+      fileLines, blockFields));
+
   // decide where we started counting
   if (minColumn > 0) {
     // 1-based
@@ -270,47 +368,97 @@ void CSRFile::getNextRow(
     dim_t * const numNonZeros,
     dim_t * const columns,
     val_t * const values)
+{
+  *numNonZeros = parseRow(columns, values);
+}
+
+
+void CSRFile::getNextRows(
+    dim_t const numRows,
+    ind_t * const rowptr,
+    dim_t * const columns,
+    val_t * const values)
+{
+  for (dim_t i = 0; i < numRows; ++i) {
+    rowptr[i+1] = rowptr[i] + parseRow(columns+rowptr[i], \
+        values ? values+rowptr[i] : nullptr);
+  }
+}
+
+
+bool CSRFile::getNextRow(
+    std::vector<dim_t> & columns,
+    std::vector<val_t> * const values)
 {
   if (!nextNoncommentLine(m_line)) {
-    throw BadFileException(std::string("Unexcepted end of file at line") + \
-        std::to_string(m_file.getCurrentLine()));
+    return false;
   }
 
-  // TOOD: don't cast constness away
-  char * sptr;
-  char * eptr = (char*)m_line.data();
+  // every entry takes at least two characters
+  size_t const maxDegree = m_line.size() / 2 + 1;
+  columns.resize(maxDegree);
+  if (values) {
+    values->resize(maxDegree);
+  }
 
-  const dim_t offset = m_oneBased ? 1 : 0;
+  dim_t const degree = parseLine(columns.data(), \
+      values ? values->data() : nullptr);
 
-  dim_t degree = 0;
-  dim_t col;
-  val_t val;
+  columns.resize(degree);
+  if (values) {
+    values->resize(degree);
+  }
 
-  // Loop through row until we streamed to the end
-  while (true) {
-    sptr = eptr;
-    col = static_cast<dim_t>(std::strtoull(sptr,&eptr,10));
-    if (eptr == sptr) {
-      // nothing left to read
-      break;
-    }
+  return true;
+}
 
-    sptr = eptr;
 
-    val = std::strtod(sptr,&eptr);
-    if (eptr == sptr) {
-      throw BadFileException(std::string("Failed to read column on "
-            "line ") + std::to_string(m_file.getCurrentLine()));
-    }
+template<typename I, typename D, typename V>
+void CSRFile::readTyped(
+    I * const rowptr,
+    D * const rowind,
+    V * const rowval,
+    double * const progress)
+{
+  if (m_decoder.get() == nullptr) {
+    throw UnsetInfoException("Cannot call readTyped() before calling " \
+        "getInfo()");
+  }
 
-    columns[degree] = col - offset;
-    if (values) {
-      values[degree] = val;
+  dim_t nrows, ncols;
+  ind_t nnz;
+  m_decoder->getInfo(nrows, ncols, nnz);
+
+  dim_t const interval = nrows > 100 ? nrows / 100 : 1;
+  double const increment = 1.0/100.0;
+
+  ProgressMonitor::setCurrentPhase(WILDRIVER_PHASE_READ);
+  ProgressMonitor::Counter counter;
+
+  rowptr[0] = 0;
+  for (dim_t i = 0; i < nrows; ++i) {
+    dim_t const degree = parseRow(rowind+rowptr[i], \
+        rowval ? rowval+rowptr[i] : nullptr);
+
+    rowptr[i+1] = rowptr[i]+degree;
+
+    if (i % CancelToken::CHECK_INTERVAL == 0) {
+      CancelToken::checkCurrent();
+    }
+    if (i % interval == 0) {
+      counter.update(i+1, rowptr[i+1]);
+      if (progress != nullptr) {
+        *progress += increment;
+      }
     }
-    ++degree;
   }
+  counter.update(nrows, rowptr[nrows]);
 
-  *numNonZeros = degree;
+  if (static_cast<ind_t>(rowptr[nrows]) != nnz) {
+    throw EOFException(std::string("Only found ") + \
+        std::to_string(rowptr[nrows]) + std::string("/") + \
+        std::to_string(nnz) + std::string(" non-zeroes in file"));
+  }
 }
 
 
@@ -324,6 +472,138 @@ void CSRFile::writeHeader(
 }
 
 
+void CSRFile::readRange(
+    dim_t const begin,
+    dim_t const end,
+    std::vector<ind_t> & rowptr,
+    std::vector<dim_t> & rowind,
+    std::vector<val_t> * const rowval)
+{
+  if (m_decoder.get() == nullptr) {
+    throw UnsetInfoException("Cannot call readRange() before calling " \
+        "getInfo()");
+  }
+
+  dim_t nrows, ncols;
+  ind_t nnz;
+  m_decoder->getInfo(nrows, ncols, nnz);
+
+  if (begin > end || end > nrows) {
+    throw BadParameterException(std::string("Invalid row range [") + \
+        std::to_string(begin) + std::string(", ") + std::to_string(end) + \
+        std::string(") for ") + std::to_string(nrows) + \
+        std::string(" rows."));
+  }
+
+  rowptr.assign(1, 0);
+  rowind.clear();
+  if (rowval) {
+    rowval->clear();
+  }
+
+  if (begin == end) {
+    return;
+  }
+
+  if (m_index.get() == nullptr) {
+    m_index.reset(new LineIndex(m_file.getFilename(), "#"));
+  }
+
+  // jump to the closest indexed row, and skip the remaining rows
+  size_t row, offset, fileLine;
+  m_index->find(begin, &row, &offset, &fileLine);
+  m_file.seek(offset, fileLine);
+  for (; row < begin; ++row) {
+    nextNoncommentLine(m_line);
+  }
+
+  for (dim_t i = begin; i < end; ++i) {
+    if (!nextNoncommentLine(m_line)) {
+      throw BadFileException(std::string("Unexcepted end of file at line") + \
+          std::to_string(m_file.getCurrentLine()));
+    }
+
+    // every entry takes at least two characters
+    ind_t const start = rowptr.back();
+    size_t const maxDegree = m_line.size() / 2 + 1;
+    rowind.resize(start + maxDegree);
+    if (rowval) {
+      rowval->resize(start + maxDegree);
+    }
+
+    dim_t const degree = parseLine(rowind.data() + start, \
+        rowval ? rowval->data() + start : nullptr);
+
+    rowptr.emplace_back(start + degree);
+  }
+
+  rowind.resize(rowptr.back());
+  if (rowval) {
+    rowval->resize(rowptr.back());
+  }
+}
+
+
+void CSRFile::readRowCounts(
+    std::vector<ind_t> & counts)
+{
+  std::vector<size_t> fields;
+  LineIndex::countFields(m_file.getFilename(), "#", &fields);
+
+  counts.resize(fields.size());
+  for (size_t i = 0; i < fields.size(); ++i) {
+    counts[i] = static_cast<ind_t>(fields[i] / 2);
+  }
+}
+
+
+std::vector<dim_t> CSRFile::getPartition(
+    int const numParts)
+{
+  if (m_decoder.get() == nullptr) {
+    throw UnsetInfoException("Cannot call getPartition() before calling " \
+        "getInfo()");
+  }
+
+  dim_t nrows, ncols;
+  ind_t nnz;
+  m_decoder->getInfo(nrows, ncols, nnz);
+
+  // the index is normally built with the header
+  if (m_index.get() == nullptr || !m_index->hasBlockFields()) {
+    m_index.reset(new LineIndex(m_file.getFilename(), "#", true));
+  }
+
+  if (m_index->getNumLines() != static_cast<size_t>(nrows)) {
+    throw BadFileException(std::string("Found ") + \
+        std::to_string(m_index->getNumLines()) + \
+        std::string(" rows but expected ") + std::to_string(nrows));
+  }
+
+  // every entry is a pair of fields
+  std::vector<size_t> const & fields = m_index->getBlockFields();
+  std::vector<dim_t> blockStarts(fields.size()+1);
+  std::vector<ind_t> blockCounts(fields.size());
+  for (size_t b = 0; b < fields.size(); ++b) {
+    blockStarts[b] = static_cast<dim_t>(b*LineIndex::STRIDE);
+    blockCounts[b] = static_cast<ind_t>(fields[b] / 2);
+  }
+  blockStarts[fields.size()] = nrows;
+
+  LineIndex const * const index = m_index.get();
+  return RowPartition::balanceBlocks(blockStarts, blockCounts, numParts, \
+      [index](size_t const block, std::vector<ind_t> & counts) {
+    std::vector<size_t> rowFields;
+    index->countBlockFields(block, &rowFields);
+
+    counts.resize(rowFields.size());
+    for (size_t i = 0; i < rowFields.size(); ++i) {
+      counts[i] = static_cast<ind_t>(rowFields[i] / 2);
+    }
+  });
+}
+
+
 void CSRFile::setNextRow(
     dim_t numNonZeros,
     dim_t const * const columns,
@@ -336,9 +616,42 @@ void CSRFile::setNextRow(
   if (numNonZeros > 0) {
     const size_t last = numNonZeros - 1;
     for (size_t i = 0; i < last; ++i) {
-      streamBuffer << (columns[i]+offset) << " " << values[i] << " ";
+      streamBuffer << (columns[i]+offset) << " " << \
+          (values ? values[i] : 1) << " ";
+    }
+    streamBuffer << (columns[last]+offset) << " " << \
+        (values ? values[last] : 1);
+  }
+
+  m_file.setNextLine(streamBuffer.str());
+}
+
+
+void CSRFile::setNextRows(
+    dim_t const numRows,
+    ind_t const * const rowptr,
+    dim_t const * const columns,
+    val_t const * const values)
+{
+  if (numRows == 0) {
+    return;
+  }
+
+  std::stringstream streamBuffer;
+
+  const dim_t offset = m_oneBased ? 1 : 0;
+
+  for (dim_t r = 0; r < numRows; ++r) {
+    if (r > 0) {
+      streamBuffer << "\n";
+    }
+    for (ind_t j = rowptr[r]; j < rowptr[r+1]; ++j) {
+      if (j > rowptr[r]) {
+        streamBuffer << " ";
+      }
+      streamBuffer << (columns[j]+offset) << " " << \
+          (values ? values[j] : 1);
     }
-    streamBuffer << (columns[last]+offset) << " " << values[last];
   }
 
   m_file.setNextLine(streamBuffer.str());
@@ -347,4 +660,17 @@ void CSRFile::setNextRow(
 
 
 
+/******************************************************************************
+* EXPLICIT INSTANTIATIONS *****************************************************
+******************************************************************************/
+
+
+#define WILDRIVER_INSTANTIATE_CSR(I, D, V) \
+  template void CSRFile::readTyped<I, D, V>(I*, D*, V*, double*);
+WILDRIVER_FOR_EACH_TYPE(WILDRIVER_INSTANTIATE_CSR)
+#undef WILDRIVER_INSTANTIATE_CSR
+
+
+
+
 }
@@ -23,7 +23,9 @@
 #include "CSRDecoder.hpp"
 #include "CSREncoder.hpp"
 #include "TextFile.hpp"
+#include "LineIndex.hpp"
 #include <memory>
+#include <vector>
 
 
 
@@ -164,6 +166,40 @@ class CSRFile :
         val_t * values) override;
 
 
+    /**
+     * @brief Get the next several rows in the matrix, parsing them without a
+     * virtual call per row.
+     *
+     * @param numRows The number of rows to get.
+     * @param rowptr The row pointer of the rows (length numRows+1). The first
+     * element must be set to the offset of the first row within columns and
+     * values, and the rest are filled in.
+     * @param columns The column of each non-zero entry (indexed by rowptr).
+     * @param values The value of each non-zero entry (may be null, indexed by
+     * rowptr).
+     */
+    void getNextRows(
+        dim_t numRows,
+        ind_t * rowptr,
+        dim_t * columns,
+        val_t * values) override;
+
+
+    /**
+     * @brief Get the next row in the matrix, sizing the buffers to fit it.
+     * Unlike getNextRow() with fixed buffers, this does not require knowing
+     * the size of the row ahead of time.
+     *
+     * @param columns The column of each non-zero entry (output).
+     * @param values The value of each non-zero entry (output, may be null).
+     *
+     * @return True if another row was found in the file.
+     */
+    bool getNextRow(
+        std::vector<dim_t> & columns,
+        std::vector<val_t> * values);
+
+
     /**
      * @brief Writer the header to the file (this is a no-op for CSF files).
      *
@@ -182,7 +218,8 @@ class CSRFile :
      *
      * @param numNonZeros The number of non-zeros in the row.
      * @param columns The column IDs.
-     * @param values The values.
+     * @param values The values (may be null, in which case ones are
+     * written).
      */
     void setNextRow(
         dim_t numNonZeros,
@@ -190,6 +227,108 @@ class CSRFile :
         val_t const * values) override;
 
 
+    /**
+     * @brief Set the next several rows in the matrix file, formatting them
+     * into a single buffer which is written at once.
+     *
+     * @param numRows The number of rows to set.
+     * @param rowptr The row pointer of the rows (length numRows+1), indexing
+     * columns and values.
+     * @param columns The column IDs.
+     * @param values The values (may be null, in which case ones are
+     * written).
+     */
+    void setNextRows(
+        dim_t numRows,
+        ind_t const * rowptr,
+        dim_t const * columns,
+        val_t const * values) override;
+
+
+    /**
+    * @brief Check whether the column indexes of the file start at one. This
+    * is only known after the header has been read.
+    *
+    * @return True if the file has 1-based column indexes.
+    */
+    bool isOneBased() const noexcept
+    {
+      return m_oneBased;
+    }
+
+
+    /**
+    * @brief Get the sparse matrix in CSR form using the given types, parsing
+    * directly into the arrays (i.e., without an intermediate copy in the
+    * native types). The header must already have been read via getInfo().
+    *
+    * @tparam I The index type.
+    * @tparam D The dimension type.
+    * @tparam V The value type.
+    * @param rowptr The row pointer indicating the start of each row.
+    * @param rowind The column index of each entry.
+    * @param rowval The value of each entry (may be null).
+    * @param progress The variable to update as the matrix is loaded (may be
+    * null).
+    */
+    template<typename I, typename D, typename V>
+    void readTyped(
+        I * rowptr,
+        D * rowind,
+        V * rowval,
+        double * progress);
+
+
+    /**
+    * @brief Read only the rows [begin, end) of the matrix, seeking to the
+    * first row via an index of the line offsets. Column indices remain
+    * global. The header must already have been read via getInfo().
+    *
+    * @param begin The first row to read.
+    * @param end One past the last row to read.
+    * @param rowptr The local row pointer (output, length end-begin+1).
+    * @param rowind The column index of each entry (output).
+    * @param rowval The value of each entry (output, may be null).
+    *
+    * @throw BadParameterException If the range is invalid.
+    */
+    void readRange(
+        dim_t begin,
+        dim_t end,
+        std::vector<ind_t> & rowptr,
+        std::vector<dim_t> & rowind,
+        std::vector<val_t> * rowval);
+
+
+    /**
+    * @brief Count the entries of each row by scanning the file for fields,
+    * without parsing them.
+    *
+    * @param counts The number of entries in each row (output).
+    */
+    void readRowCounts(
+        std::vector<ind_t> & counts);
+
+
+    /**
+    * @brief Split the rows into contiguous parts balancing the number of
+    * entries plus rows in each (see RowPartition::balance()). Only the
+    * entries of each block of LineIndex::STRIDE rows are used, as counted
+    * when the header was read, and the rows of a block are counted only
+    * where a part ends inside it.
+    *
+    * @param numParts The number of parts.
+    *
+    * @return The first row of each part, followed by the number of rows
+    * (length numParts+1).
+    *
+    * @throw BadFileException If the file does not have the expected number
+    * of rows.
+    */
+    std::vector<dim_t> getPartition(
+        int numParts);
+
+
 
   private:
     /**
@@ -221,6 +360,13 @@ class CSRFile :
     std::unique_ptr<CSREncoder> m_encoder;
 
 
+    /**
+     * @brief The index of line offsets for reading ranges of rows, built
+     * while reading the header.
+     */
+    std::unique_ptr<LineIndex> m_index;
+
+
     /**
     * @brief Get the next non-comment line from the file.
     *
@@ -232,6 +378,38 @@ class CSRFile :
         std::string & line);
 
 
+    /**
+    * @brief Parse the next row of the file.
+    *
+    * @tparam D The type of column index.
+    * @tparam V The type of value.
+    * @param columns The column of each non-zero entry.
+    * @param values The value of each non-zero entry (may be null).
+    *
+    * @return The number of non-zeros in the row.
+    */
+    template<typename D, typename V>
+    dim_t parseRow(
+        D * columns,
+        V * values);
+
+
+    /**
+    * @brief Parse the row in the line buffer.
+    *
+    * @tparam D The type of column index.
+    * @tparam V The type of value.
+    * @param columns The column of each non-zero entry.
+    * @param values The value of each non-zero entry (may be null).
+    *
+    * @return The number of non-zeros in the row.
+    */
+    template<typename D, typename V>
+    dim_t parseLine(
+        D * columns,
+        V * values);
+
+
 
 
 };
@@ -0,0 +1,167 @@
+/**
+ * @file CancelToken.cpp
+ * @brief Implementation of the CancelToken class.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-22
+ */
+
+
+
+
+#include "CancelToken.hpp"
+#include "Util.hpp"
+#include "Exception.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/******************************************************************************
+* HELPER FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+/**
+ * @brief The token installed for the loads of each thread.
+ */
+thread_local CancelToken const * currentToken = nullptr;
+
+
+}
+
+
+
+
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+
+size_t const CancelToken::CHECK_INTERVAL = 65536;
+
+
+
+
+/******************************************************************************
+* PUBLIC STATIC FUNCTIONS *****************************************************
+******************************************************************************/
+
+
+CancelToken const * CancelToken::getCurrent() noexcept
+{
+  return currentToken;
+}
+
+
+void CancelToken::checkCurrent()
+{
+  if (currentToken != nullptr) {
+    currentToken->check();
+  }
+}
+
+
+CancelToken const * CancelToken::setCurrent(
+    CancelToken const * const token) noexcept
+{
+  CancelToken const * const previous = currentToken;
+  currentToken = token;
+  return previous;
+}
+
+
+
+
+/******************************************************************************
+* CONSTRUCTORS / DESTRUCTOR ***************************************************
+******************************************************************************/
+
+
+CancelToken::Scope::Scope(
+    CancelToken const * const token) noexcept :
+  m_previous(setCurrent(token))
+{
+  // do nothing
+}
+
+
+CancelToken::Scope::~Scope()
+{
+  setCurrent(m_previous);
+}
+
+
+CancelToken::CancelToken() :
+  m_cancelled(false),
+  m_deadline(0)
+{
+  // do nothing
+}
+
+
+
+
+/******************************************************************************
+* PUBLIC FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+void CancelToken::cancel() noexcept
+{
+  m_cancelled.store(true);
+}
+
+
+void CancelToken::setDeadline(
+    double const seconds) noexcept
+{
+  if (seconds > 0) {
+    m_deadline.store(Util::now() + static_cast<int64_t>(seconds * 1e9));
+  } else {
+    m_deadline.store(0);
+  }
+}
+
+
+bool CancelToken::isCancelled() const noexcept
+{
+  return m_cancelled.load() || isPastDeadline();
+}
+
+
+void CancelToken::check() const
+{
+  if (m_cancelled.load()) {
+    throw CancelledException("The load was cancelled.");
+  } else if (isPastDeadline()) {
+    throw DeadlineExceededException("The deadline of the load passed.");
+  }
+}
+
+
+
+
+/******************************************************************************
+* PRIVATE FUNCTIONS ***********************************************************
+******************************************************************************/
+
+
+bool CancelToken::isPastDeadline() const noexcept
+{
+  int64_t const deadline = m_deadline.load();
+  return deadline != 0 && Util::now() >= deadline;
+}
+
+
+
+
+}
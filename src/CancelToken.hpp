@@ -0,0 +1,182 @@
+/**
+ * @file CancelToken.hpp
+ * @brief Class for cooperatively cancelling long running loads.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-22
+ */
+
+
+
+
+#ifndef WILDRIVER_CANCELTOKEN_HPP
+#define WILDRIVER_CANCELTOKEN_HPP
+
+
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+
+
+
+namespace WildRiver
+{
+
+
+/**
+ * @brief A flag and optional deadline which loads poll between chunks of
+ * work. A token is installed for the loads of a thread with a Scope, so that
+ * readers need not pass it through their interfaces, and may be cancelled
+ * from any thread.
+ */
+class CancelToken
+{
+  public:
+    /**
+     * @brief Installs a token as the current token of the calling thread for
+     * the lifetime of the scope.
+     */
+    class Scope
+    {
+      public:
+        /**
+         * @brief Install a token.
+         *
+         * @param token The token (may be null for no token).
+         */
+        Scope(
+            CancelToken const * token) noexcept;
+
+
+        /**
+         * @brief Restore the previously installed token.
+         */
+        ~Scope();
+
+
+      private:
+        CancelToken const * m_previous;
+
+        // disable copying
+        Scope(
+            Scope const & rhs);
+        Scope & operator=(
+            Scope const & rhs);
+    };
+
+
+    /**
+     * @brief The number of lines, rows, or entries loads process between
+     * checks of the token, so that a cancel is seen quickly however large
+     * the file.
+     */
+    static size_t const CHECK_INTERVAL;
+
+
+    /**
+     * @brief Get the current token of the calling thread.
+     *
+     * @return The token (null if there is none).
+     */
+    static CancelToken const * getCurrent() noexcept;
+
+
+    /**
+     * @brief Check the current token of the calling thread, if it has one.
+     *
+     * @throw CancelledException If the token has been cancelled.
+     * @throw DeadlineExceededException If the token's deadline has passed.
+     */
+    static void checkCurrent();
+
+
+    /**
+     * @brief Set the current token of the calling thread.
+     *
+     * @param token The token (may be null for no token).
+     *
+     * @return The previous token.
+     */
+    static CancelToken const * setCurrent(
+        CancelToken const * token) noexcept;
+
+
+    /**
+     * @brief Create a new token, which is not cancelled and has no deadline.
+     */
+    CancelToken();
+
+
+    /**
+     * @brief Request that loads using this token stop.
+     */
+    void cancel() noexcept;
+
+
+    /**
+     * @brief Set the deadline of loads using this token.
+     *
+     * @param seconds The number of seconds from now (0 or less to remove the
+     * deadline).
+     */
+    void setDeadline(
+        double seconds) noexcept;
+
+
+    /**
+     * @brief Check whether the token has been cancelled or its deadline has
+     * passed.
+     *
+     * @return True if loads using the token should stop.
+     */
+    bool isCancelled() const noexcept;
+
+
+    /**
+     * @brief Check the token.
+     *
+     * @throw CancelledException If the token has been cancelled.
+     * @throw DeadlineExceededException If the token's deadline has passed.
+     */
+    void check() const;
+
+
+  private:
+    std::atomic<bool> m_cancelled;
+
+    /**
+     * @brief The deadline in nanoseconds of the steady clock (0 for none).
+     */
+    std::atomic<int64_t> m_deadline;
+
+    /**
+     * @brief Check if the deadline has passed.
+     *
+     * @return True if it has.
+     */
+    bool isPastDeadline() const noexcept;
+
+    // disable copying
+    CancelToken(
+        CancelToken const & rhs);
+    CancelToken & operator=(
+        CancelToken const & rhs);
+
+
+
+
+};
+
+
+
+
+}
+
+
+
+
+#endif
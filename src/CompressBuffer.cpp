@@ -0,0 +1,380 @@
+/**
+ * @file CompressBuffer.cpp
+ * @brief Implementation of the CompressBuffer class.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-27
+ */
+
+
+
+
+#include "CompressBuffer.hpp"
+#include "Compression.hpp"
+#include "ThreadPool.hpp"
+#include "Tracer.hpp"
+#include "Util.hpp"
+#include "Exception.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/******************************************************************************
+* HELPER FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+/**
+ * @brief The empty block ending a BGZF file.
+ */
+char const BGZF_EOF[] = "\x1f\x8b\x08\x04\0\0\0\0\0\xff\x06\0BC\x02\0\x1b\0" \
+    "\x03\0\0\0\0\0\0\0\0\0";
+
+
+/**
+ * @brief Get the number of blocks which may wait to be compressed and
+ * written, for the number of threads of the pool.
+ *
+ * @return The number of blocks, 0 if blocks are compressed by the writer.
+ */
+size_t getMaxPending()
+{
+  int const numThreads = ThreadPool::getInstance().getNumThreads();
+  if (numThreads <= 1) {
+    return 0;
+  }
+
+  return 2*static_cast<size_t>(numThreads);
+}
+
+
+}
+
+
+
+
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+
+size_t const CompressBuffer::ZSTD_BLOCK_SIZE = 1024*1024;
+
+
+
+
+/******************************************************************************
+* CONSTRUCTORS / DESTRUCTOR ***************************************************
+******************************************************************************/
+
+
+CompressBuffer::CompressBuffer(
+    std::string const & name,
+    int const compression) :
+  m_name(name),
+  m_compression(compression),
+  m_blockSize(compression == COMPRESSION_GZIP ? \
+      Compression::GZIP_BLOCK_SIZE : ZSTD_BLOCK_SIZE),
+  m_maxPending(getMaxPending()),
+  m_file(),
+  m_fileSize(0),
+  m_current(new block_struct(m_blockSize)),
+  m_pending(),
+  m_free(),
+  m_numBlocks(0),
+  m_frames(),
+  m_reservedSize(0),
+  m_reservedOffset(0),
+  m_closed(false)
+{
+  if ((compression != COMPRESSION_GZIP && compression != COMPRESSION_ZSTD) \
+      || !Compression::isSupported(compression)) {
+    throw BadFileException(std::string("Unable to write '") + name + \
+        std::string("': writing ") + Compression::getName(compression) + \
+        std::string(" compressed files is not supported."));
+  }
+
+  if (m_file.open(name, std::ios::out | std::ios::trunc | \
+      std::ios::binary) == nullptr) {
+    throw BadFileException(std::string("Failed to open file '") + \
+        name + std::string("'"));
+  }
+
+  setp(m_current->data.get(), m_current->data.get() + m_blockSize);
+}
+
+
+CompressBuffer::~CompressBuffer()
+{
+  try {
+    close();
+  } catch (std::exception const &) {
+    // destructors cannot report errors
+  }
+}
+
+
+
+
+/******************************************************************************
+* PUBLIC FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+void CompressBuffer::close()
+{
+  if (m_closed) {
+    return;
+  }
+  m_closed = true;
+
+  submitBlock();
+  while (!m_pending.empty()) {
+    writeNext();
+  }
+
+  if (m_compression == COMPRESSION_GZIP) {
+    write(BGZF_EOF, sizeof(BGZF_EOF) - 1);
+  } else {
+    // the seek table, in a skippable frame
+    std::string table;
+    Util::appendLittleEndian(0x184D2A5E, 4, table);
+    Util::appendLittleEndian(m_frames.size()*8 + 9, 4, table);
+    for (std::pair<uint32_t, uint32_t> const & frame : m_frames) {
+      Util::appendLittleEndian(frame.first, 4, table);
+      Util::appendLittleEndian(frame.second, 4, table);
+    }
+    Util::appendLittleEndian(m_frames.size(), 4, table);
+    Util::appendLittleEndian(0, 1, table);
+    Util::appendLittleEndian(0x8F92EAB1, 4, table);
+    write(table.data(), table.size());
+  }
+
+  if (m_file.close() == nullptr) {
+    throw BadFileException(std::string("Failed to close file '") + \
+        m_name + std::string("'"));
+  }
+}
+
+
+void CompressBuffer::reserve(
+    size_t const size)
+{
+  if (m_reservedSize > 0) {
+    throw BadParameterException(std::string("A block of '") + m_name + \
+        std::string("' is already reserved."));
+  }
+
+  submitBlock();
+
+  block_ptr block(new block_struct(0));
+  block->size = size;
+  block->compressed.assign(Compression::getReservedSize(m_compression, \
+      size), '\0');
+  block->reserved = true;
+  block->claimed = true;
+  block->done = true;
+  m_pending.emplace_back(std::move(block));
+
+  m_reservedSize = size;
+}
+
+
+void CompressBuffer::fillReserved(
+    char const * const data,
+    size_t const size)
+{
+  if (size != m_reservedSize || m_reservedSize == 0) {
+    throw BadParameterException(std::string("Reserved ") + \
+        std::to_string(m_reservedSize) + std::string(" bytes of '") + \
+        m_name + std::string("' but filled ") + std::to_string(size) + \
+        std::string("."));
+  }
+
+  // everything before the reserved block must be written to know where it is
+  while (!m_pending.empty()) {
+    writeNext();
+  }
+
+  std::string block;
+  Compression::compressReserved(m_compression, data, size, \
+      Compression::getReservedSize(m_compression, size), block);
+
+  if (m_file.pubseekpos(static_cast<std::streamoff>(m_reservedOffset), \
+      std::ios::out) == std::streampos(std::streamoff(-1))) {
+    throw BadFileException(std::string("Failed to seek in '") + \
+        m_name + std::string("'"));
+  }
+  size_t const fileSize = m_fileSize;
+  write(block.data(), block.size());
+  m_fileSize = fileSize;
+  m_file.pubseekoff(0, std::ios::end, std::ios::out);
+}
+
+
+
+
+/******************************************************************************
+* PROTECTED FUNCTIONS *********************************************************
+******************************************************************************/
+
+
+CompressBuffer::int_type CompressBuffer::overflow(
+    int_type const c)
+{
+  if (m_closed) {
+    return traits_type::eof();
+  }
+
+  submitBlock();
+
+  if (!traits_type::eq_int_type(c, traits_type::eof())) {
+    *pptr() = traits_type::to_char_type(c);
+    pbump(1);
+  }
+
+  return traits_type::not_eof(c);
+}
+
+
+
+
+/******************************************************************************
+* PRIVATE STATIC FUNCTIONS ****************************************************
+******************************************************************************/
+
+
+void CompressBuffer::compress(
+    int const compression,
+    block_ptr const & block)
+{
+  if (block->claimed.exchange(true)) {
+    // another thread is compressing it
+    return;
+  }
+
+  Tracer::Span span("writer", "compress", block->index);
+
+  try {
+    Compression::compressBlock(compression, block->data.get(), \
+        block->size, block->compressed);
+  } catch (...) {
+    // passed to the writer when it writes the block
+    block->error = std::current_exception();
+  }
+
+  std::lock_guard<std::mutex> lock(block->mutex);
+  block->done = true;
+  block->finished.notify_all();
+}
+
+
+
+
+/******************************************************************************
+* PRIVATE FUNCTIONS ***********************************************************
+******************************************************************************/
+
+
+void CompressBuffer::submitBlock()
+{
+  size_t const size = static_cast<size_t>(pptr() - pbase());
+  if (size == 0) {
+    return;
+  }
+
+  block_ptr block = std::move(m_current);
+  block->size = size;
+  block->index = static_cast<int64_t>(m_numBlocks);
+  if (m_maxPending > 0) {
+    int const compression = m_compression;
+    ThreadPool::getInstance().submit([compression, block]() {
+      compress(compression, block);
+    });
+  }
+  m_pending.emplace_back(std::move(block));
+  ++m_numBlocks;
+
+  if (m_free.empty()) {
+    m_current.reset(new block_struct(m_blockSize));
+  } else {
+    m_current = std::move(m_free.back());
+    m_free.pop_back();
+  }
+  setp(m_current->data.get(), m_current->data.get() + m_blockSize);
+
+  // write the blocks which are done, and wait once too many are pending
+  while (!m_pending.empty()) {
+    block_ptr const & front = m_pending.front();
+    bool done;
+    {
+      std::lock_guard<std::mutex> lock(front->mutex);
+      done = front->done;
+    }
+    if (!done && m_pending.size() <= m_maxPending) {
+      break;
+    }
+    writeNext();
+  }
+}
+
+
+void CompressBuffer::writeNext()
+{
+  block_ptr block = std::move(m_pending.front());
+  m_pending.pop_front();
+
+  // compress it here if no worker has started it
+  compress(m_compression, block);
+  {
+    std::unique_lock<std::mutex> lock(block->mutex);
+    while (!block->done) {
+      block->finished.wait(lock);
+    }
+  }
+  if (block->error) {
+    std::rethrow_exception(block->error);
+  }
+
+  if (block->reserved) {
+    m_reservedOffset = m_fileSize;
+  }
+  write(block->compressed.data(), block->compressed.size());
+  m_frames.emplace_back(static_cast<uint32_t>(block->compressed.size()), \
+      static_cast<uint32_t>(block->size));
+
+  // reuse the block, unless a queued task still holds it
+  if (!block->reserved && block.use_count() == 1) {
+    block->compressed.clear();
+    block->claimed = false;
+    block->done = false;
+    m_free.emplace_back(std::move(block));
+  }
+}
+
+
+void CompressBuffer::write(
+    char const * const data,
+    size_t const size)
+{
+  if (m_file.sputn(data, static_cast<std::streamsize>(size)) != \
+      static_cast<std::streamsize>(size)) {
+    throw BadFileException(std::string("Failed writing to '") + \
+        m_name + std::string("'"));
+  }
+  m_fileSize += size;
+}
+
+
+
+
+}
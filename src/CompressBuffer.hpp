@@ -0,0 +1,226 @@
+/**
+ * @file CompressBuffer.hpp
+ * @brief A stream buffer which writes a block compressed file.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-27
+ */
+
+
+
+
+#ifndef WILDRIVER_COMPRESSBUFFER_HPP
+#define WILDRIVER_COMPRESSBUFFER_HPP
+
+
+
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+
+
+namespace WildRiver
+{
+
+
+/**
+ * @brief A write only stream buffer which compresses what is written to it
+ * in independent blocks: a BGZF file for gzip, or a zstd seekable file for
+ * zstd. The result can be read by the standard gzip and zstd tools, and in
+ * parallel (see BlockReader).
+ *
+ * Full blocks are compressed by the workers of the thread pool while the
+ * writer keeps filling the next one, and are written to the file in order by
+ * the writing thread. If no worker is free when the writer runs out of
+ * blocks, the writer compresses the oldest block itself.
+ */
+class CompressBuffer : public std::streambuf
+{
+  public:
+    /**
+     * @brief The number of bytes of each zstd frame.
+     */
+    static size_t const ZSTD_BLOCK_SIZE;
+
+
+    /**
+     * @brief Create a new file.
+     *
+     * @param name The filename/path.
+     * @param compression The compression (COMPRESSION_GZIP or
+     * COMPRESSION_ZSTD).
+     *
+     * @throw BadFileException If the file cannot be created or support for
+     * the compression was not built.
+     */
+    CompressBuffer(
+        std::string const & name,
+        int compression);
+
+
+    /**
+     * @brief Finish the file if close() was not called, ignoring errors.
+     */
+    ~CompressBuffer();
+
+
+    /**
+     * @brief Compress the remaining data, and write the end of the file.
+     *
+     * @throw BadFileException If writing fails.
+     */
+    void close();
+
+
+    /**
+     * @brief Leave room for a block of data which will be written later with
+     * fillReserved() (e.g., a header whose counts are not yet known). Only
+     * one block may be reserved.
+     *
+     * @param size The number of bytes of data the block will hold.
+     */
+    void reserve(
+        size_t size);
+
+
+    /**
+     * @brief Write the reserved block.
+     *
+     * @param data The data.
+     * @param size The number of bytes (as passed to reserve()).
+     *
+     * @throw BadFileException If writing fails.
+     */
+    void fillReserved(
+        char const * data,
+        size_t size);
+
+
+  protected:
+    int_type overflow(
+        int_type c) override;
+
+
+  private:
+    /**
+     * @brief A block of data, and its compressed form once a worker (or the
+     * writer) has compressed it.
+     */
+    struct block_struct
+    {
+      block_struct(
+          size_t const capacity) :
+        data(new char[capacity]),
+        size(0),
+        index(0),
+        compressed(),
+        reserved(false),
+        claimed(false),
+        done(false),
+        error(),
+        mutex(),
+        finished()
+      {
+        // do nothing
+      }
+
+      std::unique_ptr<char[]> data;
+      size_t size;
+      int64_t index;
+      std::string compressed;
+      bool reserved;
+      std::atomic<bool> claimed;
+      bool done;
+      std::exception_ptr error;
+      std::mutex mutex;
+      std::condition_variable finished;
+    };
+
+    typedef std::shared_ptr<block_struct> block_ptr;
+
+
+    std::string const m_name;
+    int const m_compression;
+    size_t const m_blockSize;
+    size_t const m_maxPending;
+    std::filebuf m_file;
+    size_t m_fileSize;
+    block_ptr m_current;
+    std::deque<block_ptr> m_pending;
+    std::vector<block_ptr> m_free;
+    size_t m_numBlocks;
+    std::vector<std::pair<uint32_t, uint32_t>> m_frames;
+    size_t m_reservedSize;
+    size_t m_reservedOffset;
+    bool m_closed;
+
+
+    /**
+     * @brief Compress a block, if no other thread has claimed it.
+     *
+     * @param compression The compression.
+     * @param block The block.
+     */
+    static void compress(
+        int compression,
+        block_ptr const & block);
+
+
+    /**
+     * @brief Pass the buffered data on to be compressed as a block, and start
+     * a new block.
+     */
+    void submitBlock();
+
+
+    /**
+     * @brief Wait for the oldest pending block to be compressed (compressing
+     * it if no worker has started it), and write it.
+     */
+    void writeNext();
+
+
+    /**
+     * @brief Write bytes to the file.
+     *
+     * @param data The bytes.
+     * @param size The number of bytes.
+     */
+    void write(
+        char const * data,
+        size_t size);
+
+
+    // disable copying
+    CompressBuffer(
+        CompressBuffer const & rhs);
+    CompressBuffer & operator=(
+        CompressBuffer const & rhs);
+
+
+
+
+};
+
+
+
+
+}
+
+
+
+
+#endif
@@ -0,0 +1,900 @@
+/**
+ * @file Compression.cpp
+ * @brief Implementation of the Compression class.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-27
+ */
+
+
+
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#ifdef WILDRIVER_ZLIB
+#include <zlib.h>
+#endif
+#ifdef WILDRIVER_ZSTD
+#include <zstd.h>
+#endif
+#ifdef WILDRIVER_LZMA
+#include <lzma.h>
+#endif
+
+#include "Compression.hpp"
+#include "DecompressBuffer.hpp"
+#include "ReadBackend.hpp"
+#include "Util.hpp"
+#include "Exception.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/******************************************************************************
+* HELPER FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+/**
+ * @brief The number of compressed bytes to read from the file at a time.
+ */
+size_t const INPUT_SIZE = 64*1024;
+
+
+/**
+ * @brief The extensions of each compression.
+ */
+struct extension_struct
+{
+  char const * extension;
+  int compression;
+};
+
+extension_struct const EXTENSIONS[] = {
+  {".gz", COMPRESSION_GZIP},
+  {".zst", COMPRESSION_ZSTD},
+  {".xz", COMPRESSION_XZ}
+};
+
+
+/**
+ * @brief Get the index of the compression extension of a filename.
+ *
+ * @param name The filename.
+ *
+ * @return The index in EXTENSIONS, or -1 if it has none.
+ */
+int findExtension(
+    std::string const & name) noexcept
+{
+  for (size_t i = 0; i < sizeof(EXTENSIONS)/sizeof(*EXTENSIONS); ++i) {
+    std::string const ext(EXTENSIONS[i].extension);
+    if (name.size() > ext.size() && \
+        name.compare(name.size()-ext.size(), ext.size(), ext) == 0) {
+      return static_cast<int>(i);
+    }
+  }
+
+  return -1;
+}
+
+
+/**
+ * @brief The compressed file being decoded, read in pieces.
+ */
+class CompressedInput
+{
+  public:
+    CompressedInput(
+        std::string const & name,
+        size_t const offset) :
+      m_name(name),
+      m_file(name, std::ifstream::in | std::ifstream::binary),
+      m_buffer(new char[INPUT_SIZE]),
+      m_bytes(0)
+    {
+      if (!m_file.is_open()) {
+        throw BadFileException(std::string("Failed to open file '") + \
+            name + std::string("'"));
+      }
+      if (offset > 0) {
+        m_file.seekg(static_cast<std::streamoff>(offset));
+      }
+    }
+
+
+    /**
+     * @brief Read the next piece of the file.
+     *
+     * @return The number of bytes read (0 at the end of the file).
+     */
+    size_t fill()
+    {
+      if (!m_file) {
+        return 0;
+      }
+
+      m_file.read(m_buffer.get(), INPUT_SIZE);
+      if (m_file.bad()) {
+        throw BadFileException(std::string("Failed to read file '") + \
+            m_name + std::string("'"));
+      }
+
+      size_t const size = static_cast<size_t>(m_file.gcount());
+      m_bytes += size;
+
+      return size;
+    }
+
+
+    /**
+     * @brief Throw an exception for corrupt contents.
+     *
+     * @param reason The reason given by the decoding library.
+     */
+    void corrupt(
+        std::string const & reason) const
+    {
+      throw BadFileException(std::string("Corrupt compressed file '") + \
+          m_name + std::string("': ") + reason);
+    }
+
+
+    char * data() noexcept
+    {
+      return m_buffer.get();
+    }
+
+
+    size_t getBytes() const noexcept
+    {
+      return m_bytes;
+    }
+
+
+  private:
+    std::string const m_name;
+    std::ifstream m_file;
+    std::unique_ptr<char[]> m_buffer;
+    size_t m_bytes;
+};
+
+
+#ifdef WILDRIVER_ZLIB
+/**
+ * @brief Decoder of gzip (and zlib) files, of one or more members.
+ */
+class GzipDecoder : public Compression::Decoder
+{
+  public:
+    GzipDecoder(
+        std::string const & name,
+        size_t const offset) :
+      m_input(name, offset),
+      m_stream(),
+      m_inMember(false)
+    {
+      // detect the gzip or zlib header
+      if (inflateInit2(&m_stream, 15+32) != Z_OK) {
+        throw BadFileException(std::string("Failed to initialize gzip " \
+            "decoding of '") + name + std::string("'"));
+      }
+    }
+
+
+    GzipDecoder(
+        GzipDecoder const & rhs) = delete;
+    GzipDecoder & operator=(
+        GzipDecoder const & rhs) = delete;
+
+
+    ~GzipDecoder()
+    {
+      inflateEnd(&m_stream);
+    }
+
+
+    size_t read(
+        char * const data,
+        size_t const size) override
+    {
+      m_stream.next_out = reinterpret_cast<Bytef*>(data);
+      m_stream.avail_out = static_cast<uInt>(size);
+
+      while (m_stream.avail_out > 0) {
+        if (m_stream.avail_in == 0) {
+          m_stream.next_in = reinterpret_cast<Bytef*>(m_input.data());
+          m_stream.avail_in = static_cast<uInt>(m_input.fill());
+          if (m_stream.avail_in == 0) {
+            if (m_inMember) {
+              m_input.corrupt("truncated gzip member");
+            }
+            break;
+          }
+        }
+
+        int const ret = inflate(&m_stream, Z_NO_FLUSH);
+        if (ret == Z_STREAM_END) {
+          // another member may follow
+          inflateReset(&m_stream);
+          m_inMember = false;
+        } else if (ret == Z_OK) {
+          m_inMember = true;
+        } else {
+          m_input.corrupt(m_stream.msg != nullptr ? m_stream.msg : \
+              "invalid gzip data");
+        }
+      }
+
+      return size - m_stream.avail_out;
+    }
+
+
+    size_t getCompressedBytes() const noexcept override
+    {
+      return m_input.getBytes();
+    }
+
+
+  private:
+    CompressedInput m_input;
+    z_stream m_stream;
+    bool m_inMember;
+};
+#endif
+
+
+#ifdef WILDRIVER_ZSTD
+/**
+ * @brief Decoder of zstd files, of one or more frames.
+ */
+class ZstdDecoder : public Compression::Decoder
+{
+  public:
+    ZstdDecoder(
+        std::string const & name,
+        size_t const offset) :
+      m_input(name, offset),
+      m_stream(ZSTD_createDStream()),
+      m_in{nullptr, 0, 0},
+      m_inFrame(false)
+    {
+      if (m_stream == nullptr || ZSTD_isError(ZSTD_initDStream(m_stream))) {
+        ZSTD_freeDStream(m_stream);
+        throw BadFileException(std::string("Failed to initialize zstd " \
+            "decoding of '") + name + std::string("'"));
+      }
+    }
+
+
+    ZstdDecoder(
+        ZstdDecoder const & rhs) = delete;
+    ZstdDecoder & operator=(
+        ZstdDecoder const & rhs) = delete;
+
+
+    ~ZstdDecoder()
+    {
+      ZSTD_freeDStream(m_stream);
+    }
+
+
+    size_t read(
+        char * const data,
+        size_t const size) override
+    {
+      ZSTD_outBuffer out{data, size, 0};
+
+      while (out.pos < out.size) {
+        if (m_in.pos == m_in.size) {
+          m_in.src = m_input.data();
+          m_in.size = m_input.fill();
+          m_in.pos = 0;
+          if (m_in.size == 0) {
+            if (m_inFrame) {
+              m_input.corrupt("truncated zstd frame");
+            }
+            break;
+          }
+        }
+
+        size_t const ret = ZSTD_decompressStream(m_stream, &out, &m_in);
+        if (ZSTD_isError(ret)) {
+          m_input.corrupt(ZSTD_getErrorName(ret));
+        }
+        // another frame may follow a finished one
+        m_inFrame = ret != 0;
+      }
+
+      return out.pos;
+    }
+
+
+    size_t getCompressedBytes() const noexcept override
+    {
+      return m_input.getBytes();
+    }
+
+
+  private:
+    CompressedInput m_input;
+    ZSTD_DStream * m_stream;
+    ZSTD_inBuffer m_in;
+    bool m_inFrame;
+};
+#endif
+
+
+#ifdef WILDRIVER_LZMA
+/**
+ * @brief Decoder of xz files, of one or more streams.
+ */
+class XzDecoder : public Compression::Decoder
+{
+  public:
+    XzDecoder(
+        std::string const & name,
+        size_t const offset) :
+      m_input(name, offset),
+      m_stream(),
+      m_eof(false),
+      m_finished(false)
+    {
+      if (lzma_stream_decoder(&m_stream, UINT64_MAX, LZMA_CONCATENATED) != \
+          LZMA_OK) {
+        throw BadFileException(std::string("Failed to initialize xz " \
+            "decoding of '") + name + std::string("'"));
+      }
+    }
+
+
+    XzDecoder(
+        XzDecoder const & rhs) = delete;
+    XzDecoder & operator=(
+        XzDecoder const & rhs) = delete;
+
+
+    ~XzDecoder()
+    {
+      lzma_end(&m_stream);
+    }
+
+
+    size_t read(
+        char * const data,
+        size_t const size) override
+    {
+      m_stream.next_out = reinterpret_cast<uint8_t*>(data);
+      m_stream.avail_out = size;
+
+      while (!m_finished && m_stream.avail_out > 0) {
+        if (m_stream.avail_in == 0 && !m_eof) {
+          m_stream.next_in = reinterpret_cast<uint8_t*>(m_input.data());
+          m_stream.avail_in = m_input.fill();
+          m_eof = m_stream.avail_in == 0;
+        }
+
+        // concatenated streams only end once told there is no more input
+        lzma_ret const ret = lzma_code(&m_stream, \
+            m_eof ? LZMA_FINISH : LZMA_RUN);
+        if (ret == LZMA_STREAM_END) {
+          m_finished = true;
+        } else if (ret == LZMA_BUF_ERROR) {
+          m_input.corrupt("truncated xz stream");
+        } else if (ret != LZMA_OK) {
+          m_input.corrupt(std::string("invalid xz data (error ") + \
+              std::to_string(static_cast<int>(ret)) + std::string(")"));
+        }
+      }
+
+      return size - m_stream.avail_out;
+    }
+
+
+    size_t getCompressedBytes() const noexcept override
+    {
+      return m_input.getBytes();
+    }
+
+
+  private:
+    CompressedInput m_input;
+    lzma_stream m_stream;
+    bool m_eof;
+    bool m_finished;
+};
+#endif
+
+
+#ifdef WILDRIVER_ZSTD
+/**
+ * @brief The level zstd frames are compressed at (the default of the zstd
+ * tool).
+ */
+int const ZSTD_LEVEL = 3;
+#endif
+
+
+/**
+ * @brief Get the output compression from the WILDRIVER_OUTPUT_COMPRESSION
+ * environment variable.
+ *
+ * @return The compression, or COMPRESSION_NONE if it is not set.
+ */
+int getDefaultOutputCompression() noexcept
+{
+  char const * const env = std::getenv("WILDRIVER_OUTPUT_COMPRESSION");
+  if (env != nullptr) {
+    for (int compression : {COMPRESSION_GZIP, COMPRESSION_ZSTD}) {
+      if (std::strcmp(env, Compression::getName(compression)) == 0) {
+        return compression;
+      }
+    }
+  }
+
+  return COMPRESSION_NONE;
+}
+
+
+#ifdef WILDRIVER_ZLIB
+/**
+ * @brief The size of the header of a BGZF block, the gzip header with an
+ * extra field holding the size of the block.
+ */
+size_t const BGZF_HEADER_SIZE = 18;
+
+
+/**
+ * @brief The size of the footer of a BGZF block (the CRC32 and size).
+ */
+size_t const BGZF_FOOTER_SIZE = 8;
+
+
+/**
+ * @brief The largest size of a BGZF block.
+ */
+size_t const BGZF_MAX_BLOCK = 65536;
+
+
+/**
+ * @brief The size of the smallest padding of BGZF files, an empty BGZF block
+ * with an empty padding subfield.
+ */
+size_t const BGZF_PADDING_SIZE = 32;
+#endif
+
+
+#ifdef WILDRIVER_ZSTD
+/**
+ * @brief The size of the smallest padding of zstd files, an empty skippable
+ * frame.
+ */
+size_t const ZSTD_PADDING_SIZE = 8;
+#endif
+
+
+#ifdef WILDRIVER_ZLIB
+
+
+/**
+ * @brief Deflate data into a string.
+ *
+ * @param level The compression level.
+ * @param data The data.
+ * @param size The number of bytes.
+ * @param out The string to write the raw deflate stream to, starting at the
+ * given offset.
+ * @param offset The offset.
+ *
+ * @return The number of bytes written.
+ */
+size_t deflateRaw(
+    int const level,
+    char const * const data,
+    size_t const size,
+    std::string & out,
+    size_t const offset)
+{
+  z_stream stream = z_stream();
+  if (deflateInit2(&stream, level, Z_DEFLATED, -15, 8, \
+      Z_DEFAULT_STRATEGY) != Z_OK) {
+    throw BadFileException("Failed to initialize gzip compression.");
+  }
+
+  size_t const bound = deflateBound(&stream, static_cast<uLong>(size));
+  out.resize(offset + bound);
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+  stream.avail_in = static_cast<uInt>(size);
+  stream.next_out = reinterpret_cast<Bytef*>(&out[offset]);
+  stream.avail_out = static_cast<uInt>(bound);
+
+  int const ret = deflate(&stream, Z_FINISH);
+  size_t const written = static_cast<size_t>(stream.total_out);
+  deflateEnd(&stream);
+  if (ret != Z_STREAM_END) {
+    throw BadFileException("Failed to compress gzip block.");
+  }
+
+  return written;
+}
+#endif
+
+
+}
+
+
+
+
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+
+size_t const Compression::GZIP_BLOCK_SIZE = 0xff00;
+
+
+std::atomic<int> Compression::s_outputCompression( \
+    getDefaultOutputCompression());
+
+
+
+
+/******************************************************************************
+* PUBLIC STATIC FUNCTIONS *****************************************************
+******************************************************************************/
+
+
+int Compression::getOutputCompression() noexcept
+{
+  return s_outputCompression.load();
+}
+
+
+void Compression::setOutputCompression(
+    int const compression) noexcept
+{
+  s_outputCompression.store(compression);
+}
+
+
+int Compression::forOutput(
+    std::string const & name)
+{
+  int const compression = fromExtension(name);
+  if (compression != COMPRESSION_NONE) {
+    return compression;
+  }
+
+  return getOutputCompression();
+}
+
+
+int Compression::fromExtension(
+    std::string const & name)
+{
+  int const index = findExtension(name);
+  if (index < 0) {
+    return COMPRESSION_NONE;
+  }
+
+  return EXTENSIONS[index].compression;
+}
+
+
+int Compression::fromMagic(
+    std::string const & name)
+{
+  std::ifstream file(name, std::ifstream::in | std::ifstream::binary);
+  unsigned char magic[6] = {0};
+  file.read(reinterpret_cast<char*>(magic), sizeof(magic));
+  size_t const size = static_cast<size_t>(file.gcount());
+
+  if (size >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+    return COMPRESSION_GZIP;
+  } else if (size >= 4 && magic[1] == 0xb5 && magic[2] == 0x2f && \
+      magic[3] == 0xfd && magic[0] == 0x28) {
+    return COMPRESSION_ZSTD;
+  } else if (size >= 4 && (magic[0] & 0xf0) == 0x50 && magic[1] == 0x2a && \
+      magic[2] == 0x4d && magic[3] == 0x18) {
+    // a zstd skippable frame (e.g., the index of a seekable file)
+    return COMPRESSION_ZSTD;
+  } else if (size >= 6 && magic[0] == 0xfd && magic[1] == '7' && \
+      magic[2] == 'z' && magic[3] == 'X' && magic[4] == 'Z' && \
+      magic[5] == 0x00) {
+    return COMPRESSION_XZ;
+  }
+
+  return COMPRESSION_NONE;
+}
+
+
+std::string Compression::stripExtension(
+    std::string const & name)
+{
+  int const index = findExtension(name);
+  if (index < 0) {
+    return name;
+  }
+
+  return name.substr(0, name.size() - \
+      std::string(EXTENSIONS[index].extension).size());
+}
+
+
+bool Compression::isSupported(
+    int const compression) noexcept
+{
+  switch (compression) {
+    case COMPRESSION_NONE:
+      return true;
+#ifdef WILDRIVER_ZLIB
+    case COMPRESSION_GZIP:
+      return true;
+#endif
+#ifdef WILDRIVER_ZSTD
+    case COMPRESSION_ZSTD:
+      return true;
+#endif
+#ifdef WILDRIVER_LZMA
+    case COMPRESSION_XZ:
+      return true;
+#endif
+    default:
+      return false;
+  }
+}
+
+
+char const * Compression::getName(
+    int const compression) noexcept
+{
+  switch (compression) {
+    case COMPRESSION_NONE:
+      return "none";
+    case COMPRESSION_GZIP:
+      return "gzip";
+    case COMPRESSION_ZSTD:
+      return "zstd";
+    case COMPRESSION_XZ:
+      return "xz";
+    default:
+      return "unknown";
+  }
+}
+
+
+std::unique_ptr<Compression::Decoder> Compression::makeDecoder(
+    std::string const & name,
+    int const compression,
+    size_t const offset)
+{
+  switch (compression) {
+#ifdef WILDRIVER_ZLIB
+    case COMPRESSION_GZIP:
+      return std::unique_ptr<Decoder>(new GzipDecoder(name, offset));
+#endif
+#ifdef WILDRIVER_ZSTD
+    case COMPRESSION_ZSTD:
+      return std::unique_ptr<Decoder>(new ZstdDecoder(name, offset));
+#endif
+#ifdef WILDRIVER_LZMA
+    case COMPRESSION_XZ:
+      return std::unique_ptr<Decoder>(new XzDecoder(name, offset));
+#endif
+    default:
+      throw BadFileException(std::string("Unable to read '") + name + \
+          std::string("': support for ") + getName(compression) + \
+          std::string(" compressed files was not built."));
+  }
+}
+
+
+void Compression::decompress(
+    int const compression,
+    char const * const data,
+    size_t const size,
+    char * const out,
+    size_t const outSize)
+{
+  size_t written = 0;
+  switch (compression) {
+#ifdef WILDRIVER_ZLIB
+    case COMPRESSION_GZIP: {
+      z_stream stream = z_stream();
+      if (inflateInit2(&stream, 15+16) != Z_OK) {
+        throw BadFileException("Failed to initialize gzip decoding.");
+      }
+      stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+      stream.avail_in = static_cast<uInt>(size);
+      stream.next_out = reinterpret_cast<Bytef*>(out);
+      stream.avail_out = static_cast<uInt>(outSize);
+
+      int ret;
+      while ((ret = inflate(&stream, Z_NO_FLUSH)) == Z_STREAM_END && \
+          stream.avail_in > 0) {
+        // the next member
+        inflateReset(&stream);
+      }
+      written = outSize - stream.avail_out;
+      inflateEnd(&stream);
+      if (ret != Z_STREAM_END) {
+        throw BadFileException("Corrupt gzip block.");
+      }
+      break;
+    }
+#endif
+#ifdef WILDRIVER_ZSTD
+    case COMPRESSION_ZSTD: {
+      written = ZSTD_decompress(out, outSize, data, size);
+      if (ZSTD_isError(written)) {
+        throw BadFileException(std::string("Corrupt zstd frame: ") + \
+            ZSTD_getErrorName(written));
+      }
+      break;
+    }
+#endif
+    default:
+      throw BadFileException(std::string("Unable to decompress block: " \
+          "support for ") + getName(compression) + \
+          std::string(" compressed files was not built."));
+  }
+
+  if (written != outSize) {
+    throw BadFileException(std::string("Compressed block holds ") + \
+        std::to_string(written) + std::string(" bytes instead of ") + \
+        std::to_string(outSize) + std::string("."));
+  }
+}
+
+
+void Compression::compressBlock(
+    int const compression,
+    char const * const data,
+    size_t const size,
+    std::string & out)
+{
+  switch (compression) {
+#ifdef WILDRIVER_ZLIB
+    case COMPRESSION_GZIP: {
+      if (size > GZIP_BLOCK_SIZE) {
+        throw BadParameterException(std::string("BGZF blocks cannot hold ") + \
+            std::to_string(size) + std::string(" bytes."));
+      }
+
+      size_t const start = out.size();
+      size_t length = deflateRaw(Z_DEFAULT_COMPRESSION, data, size, out, \
+          start + BGZF_HEADER_SIZE);
+      if (BGZF_HEADER_SIZE + length + BGZF_FOOTER_SIZE > BGZF_MAX_BLOCK) {
+        // incompressible data
+        length = deflateRaw(Z_NO_COMPRESSION, data, size, out, \
+            start + BGZF_HEADER_SIZE);
+      }
+      out.resize(start + BGZF_HEADER_SIZE + length);
+
+      std::string header("\x1f\x8b\x08\x04\0\0\0\0\0\xff\x06\0BC\x02\0", \
+          BGZF_HEADER_SIZE - 2);
+      Util::appendLittleEndian( \
+          BGZF_HEADER_SIZE + length + BGZF_FOOTER_SIZE - 1, 2, header);
+      out.replace(start, BGZF_HEADER_SIZE, header);
+
+      uLong const crc = crc32(crc32(0, nullptr, 0), \
+          reinterpret_cast<Bytef const*>(data), static_cast<uInt>(size));
+      Util::appendLittleEndian(crc, 4, out);
+      Util::appendLittleEndian(size, 4, out);
+      break;
+    }
+#endif
+#ifdef WILDRIVER_ZSTD
+    case COMPRESSION_ZSTD: {
+      size_t const start = out.size();
+      out.resize(start + ZSTD_compressBound(size));
+      size_t const length = ZSTD_compress(&out[start], out.size() - start, \
+          data, size, ZSTD_LEVEL);
+      if (ZSTD_isError(length)) {
+        throw BadFileException(std::string("Failed to compress zstd " \
+            "frame: ") + ZSTD_getErrorName(length));
+      }
+      out.resize(start + length);
+      break;
+    }
+#endif
+    default:
+      throw BadFileException(std::string("Unable to compress block: " \
+          "support for writing ") + getName(compression) + \
+          std::string(" compressed files was not built."));
+  }
+}
+
+
+size_t Compression::getReservedSize(
+    int const compression,
+    size_t const size)
+{
+  switch (compression) {
+#ifdef WILDRIVER_ZLIB
+    case COMPRESSION_GZIP:
+      return BGZF_HEADER_SIZE + compressBound(static_cast<uLong>(size)) + \
+          BGZF_FOOTER_SIZE + BGZF_PADDING_SIZE;
+#endif
+#ifdef WILDRIVER_ZSTD
+    case COMPRESSION_ZSTD:
+      return ZSTD_compressBound(size) + ZSTD_PADDING_SIZE;
+#endif
+    default:
+      throw BadFileException(std::string("Unable to compress block: " \
+          "support for writing ") + getName(compression) + \
+          std::string(" compressed files was not built."));
+  }
+}
+
+
+void Compression::compressReserved(
+    int const compression,
+    char const * const data,
+    size_t const size,
+    size_t const reserved,
+    std::string & out)
+{
+  size_t const start = out.size();
+  compressBlock(compression, data, size, out);
+  size_t const padding = reserved - (out.size() - start);
+
+  switch (compression) {
+#ifdef WILDRIVER_ZLIB
+    case COMPRESSION_GZIP: {
+      // an empty BGZF block, with a subfield of zeros filling the rest
+      size_t const length = padding - BGZF_PADDING_SIZE;
+      out.append("\x1f\x8b\x08\x04\0\0\0\0\0\xff", 10);
+      Util::appendLittleEndian(10 + length, 2, out);
+      out.append("BC\x02\0", 4);
+      Util::appendLittleEndian(padding - 1, 2, out);
+      out.append("PD", 2);
+      Util::appendLittleEndian(length, 2, out);
+      out.append(length, '\0');
+      out.append("\x03\0", 2);
+      out.append(BGZF_FOOTER_SIZE, '\0');
+      break;
+    }
+#endif
+#ifdef WILDRIVER_ZSTD
+    case COMPRESSION_ZSTD: {
+      Util::appendLittleEndian(0x184D2A50, 4, out);
+      Util::appendLittleEndian(padding - ZSTD_PADDING_SIZE, 4, out);
+      out.append(padding - ZSTD_PADDING_SIZE, '\0');
+      break;
+    }
+#endif
+    default:
+      break;
+  }
+}
+
+
+std::unique_ptr<std::streambuf> Compression::openRead(
+    std::string const & name)
+{
+  int const compression = fromMagic(name);
+  if (compression != COMPRESSION_NONE) {
+    return std::unique_ptr<std::streambuf>( \
+        new DecompressBuffer(name, compression));
+  }
+
+  return ReadBackend::openRead(name);
+}
+
+
+
+
+}
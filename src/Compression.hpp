@@ -0,0 +1,317 @@
+/**
+ * @file Compression.hpp
+ * @brief Detection and decoding of compressed files.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-27
+ */
+
+
+
+
+#ifndef WILDRIVER_COMPRESSION_HPP
+#define WILDRIVER_COMPRESSION_HPP
+
+
+
+
+#include <atomic>
+#include <memory>
+#include <streambuf>
+#include <string>
+
+
+
+
+namespace WildRiver
+{
+
+
+/**
+ * @brief The compression formats of files.
+ */
+enum compression_type {
+  COMPRESSION_NONE,
+  COMPRESSION_GZIP,
+  COMPRESSION_ZSTD,
+  COMPRESSION_XZ
+};
+
+
+/**
+ * @brief Detection of compressed files by their extension (.gz, .zst, .xz)
+ * and magic bytes, and decoding of them with the optional system libraries
+ * (zlib, zstd, and liblzma). Files of several concatenated gzip members,
+ * zstd frames, or xz streams are decoded as a whole.
+ *
+ * Text files are written compressed if their extension is .gz or .zst, or
+ * otherwise if an output compression is set (process wide). The default is
+ * taken from the WILDRIVER_OUTPUT_COMPRESSION environment variable ("gzip"
+ * or "zstd") if it is set.
+ */
+class Compression
+{
+  public:
+    /**
+     * @brief Decodes a compressed file sequentially.
+     */
+    class Decoder
+    {
+      public:
+        /**
+         * @brief Virtual destructor.
+         */
+        virtual ~Decoder()
+        {
+          // do nothing
+        }
+
+
+        /**
+         * @brief Decompress the next bytes of the file.
+         *
+         * @param data The buffer to fill.
+         * @param size The size of the buffer.
+         *
+         * @return The number of bytes decompressed, which is only less than
+         * the size at the end of the file.
+         *
+         * @throw BadFileException If the file is corrupt or truncated.
+         */
+        virtual size_t read(
+            char * data,
+            size_t size) = 0;
+
+
+        /**
+         * @brief Get the number of bytes of the compressed file read so far.
+         *
+         * @return The number of bytes.
+         */
+        virtual size_t getCompressedBytes() const noexcept = 0;
+    };
+
+
+    /**
+     * @brief The largest number of bytes in a BGZF block.
+     */
+    static size_t const GZIP_BLOCK_SIZE;
+
+
+    /**
+     * @brief Get the compression files without a compression extension are
+     * written with.
+     *
+     * @return The compression (a compression_type).
+     */
+    static int getOutputCompression() noexcept;
+
+
+    /**
+     * @brief Set the compression files without a compression extension are
+     * written with. This may be called at any time, from any thread, and
+     * applies to files opened afterwards.
+     *
+     * @param compression The compression (a compression_type).
+     */
+    static void setOutputCompression(
+        int compression) noexcept;
+
+
+    /**
+     * @brief Get the compression a file will be written with: that of its
+     * extension, or otherwise the output compression.
+     *
+     * @param name The filename/path.
+     *
+     * @return The compression (a compression_type).
+     */
+    static int forOutput(
+        std::string const & name);
+
+
+    /**
+     * @brief Get the compression of a file from its extension.
+     *
+     * @param name The filename/path.
+     *
+     * @return The compression (a compression_type).
+     */
+    static int fromExtension(
+        std::string const & name);
+
+
+    /**
+     * @brief Get the compression of a file from its first bytes.
+     *
+     * @param name The filename/path.
+     *
+     * @return The compression (a compression_type), which is
+     * COMPRESSION_NONE if the file cannot be opened.
+     */
+    static int fromMagic(
+        std::string const & name);
+
+
+    /**
+     * @brief Remove the compression extension from a filename, so that the
+     * format of the contents can be determined from the extension before it
+     * (e.g., "A.mtx.gz" becomes "A.mtx").
+     *
+     * @param name The filename/path.
+     *
+     * @return The filename without the compression extension.
+     */
+    static std::string stripExtension(
+        std::string const & name);
+
+
+    /**
+     * @brief Check whether support for a compression was built.
+     *
+     * @param compression The compression (a compression_type).
+     *
+     * @return True if files of it can be read.
+     */
+    static bool isSupported(
+        int compression) noexcept;
+
+
+    /**
+     * @brief Get the name of a compression.
+     *
+     * @param compression The compression (a compression_type).
+     *
+     * @return The name (e.g., "gzip").
+     */
+    static char const * getName(
+        int compression) noexcept;
+
+
+    /**
+     * @brief Create a decoder for a compressed file.
+     *
+     * @param name The filename/path.
+     * @param compression The compression of the file (a compression_type).
+     * @param offset The offset in the file to start decoding at, which must
+     * be the start of a gzip member, zstd frame, or xz stream.
+     *
+     * @return The decoder.
+     *
+     * @throw BadFileException If the file cannot be opened or support for
+     * the compression was not built.
+     */
+    static std::unique_ptr<Decoder> makeDecoder(
+        std::string const & name,
+        int compression,
+        size_t offset = 0);
+
+
+    /**
+     * @brief Decompress one or more whole gzip members or zstd frames held in
+     * memory (e.g., a run of blocks of a blocked file).
+     *
+     * @param compression The compression (a compression_type).
+     * @param data The compressed data.
+     * @param size The number of compressed bytes.
+     * @param out The buffer to decompress into.
+     * @param outSize The number of decompressed bytes expected.
+     *
+     * @throw BadFileException If the data is corrupt or does not decompress
+     * to exactly the expected number of bytes.
+     */
+    static void decompress(
+        int compression,
+        char const * data,
+        size_t size,
+        char * out,
+        size_t outSize);
+
+
+    /**
+     * @brief Compress data as a single independent block: a BGZF block (a
+     * gzip member) for gzip, or a frame for zstd.
+     *
+     * @param compression The compression (a compression_type).
+     * @param data The data to compress.
+     * @param size The number of bytes (for gzip, at most GZIP_BLOCK_SIZE).
+     * @param out The string to append the block to.
+     *
+     * @throw BadFileException If support for the compression was not built.
+     */
+    static void compressBlock(
+        int compression,
+        char const * data,
+        size_t size,
+        std::string & out);
+
+
+    /**
+     * @brief Get the number of bytes to reserve for a block to be written
+     * later with compressReserved() (e.g., a header whose counts are not yet
+     * known).
+     *
+     * @param compression The compression (a compression_type).
+     * @param size The number of bytes of data the block will hold.
+     *
+     * @return The number of compressed bytes.
+     */
+    static size_t getReservedSize(
+        int compression,
+        size_t size);
+
+
+    /**
+     * @brief Compress data as an independent block followed by padding which
+     * decoders skip (an empty gzip member, or a zstd skippable frame), so
+     * that it fills exactly the reserved number of bytes.
+     *
+     * @param compression The compression (a compression_type).
+     * @param data The data to compress.
+     * @param size The number of bytes.
+     * @param reserved The number of bytes reserved, from getReservedSize().
+     * @param out The string to append the block to.
+     *
+     * @throw BadFileException If support for the compression was not built.
+     */
+    static void compressReserved(
+        int compression,
+        char const * data,
+        size_t size,
+        size_t reserved,
+        std::string & out);
+
+
+    /**
+     * @brief Open a file for reading its contents, decompressing it in the
+     * background if its magic bytes show it is compressed, and otherwise
+     * reading it with the read backend (see ReadBackend).
+     *
+     * @param name The filename/path.
+     *
+     * @return The buffer to read the contents from.
+     *
+     * @throw BadFileException If the file cannot be opened.
+     */
+    static std::unique_ptr<std::streambuf> openRead(
+        std::string const & name);
+
+
+  private:
+    static std::atomic<int> s_outputCompression;
+
+
+
+
+};
+
+
+
+
+}
+
+
+
+
+#endif
@@ -0,0 +1,1616 @@
+/**
+* @file ConversionPipeline.cpp
+* @brief Implementation of the ConversionPipeline class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-05-02
+*/
+
+
+
+
+#include "ConversionPipeline.hpp"
+#include "BlockReader.hpp"
+#include "BoundedQueue.hpp"
+#include "CancelToken.hpp"
+#include "CompressBuffer.hpp"
+#include "Compression.hpp"
+#include "CSRFile.hpp"
+#include "MatrixMarketFile.hpp"
+#include "MetisFile.hpp"
+#include "SNAPFile.hpp"
+#include "ThreadPool.hpp"
+#include "Tracer.hpp"
+#include "Exception.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <istream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <utility>
+
+
+
+
+namespace WildRiver
+{
+
+
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+size_t const DEFAULT_CHUNK_SIZE = 1 << 20;
+
+size_t const DEFAULT_QUEUE_DEPTH = 8;
+
+/**
+* @brief The number of rows per chunk emitted after symmetrization.
+*/
+dim_t const SYMMETRIC_CHUNK_ROWS = 8192;
+
+/**
+* @brief The width the line holding the counts in a header is padded to, so
+* that it can be overwritten in place once the counts are known.
+*/
+size_t const COUNT_LINE_WIDTH = 64;
+
+
+enum pipeline_format {
+  PIPELINE_FORMAT_CSR,
+  PIPELINE_FORMAT_METIS,
+  PIPELINE_FORMAT_MATRIXMARKET,
+  PIPELINE_FORMAT_SNAP
+};
+
+
+}
+
+
+
+
+/******************************************************************************
+* TYPES ***********************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+/**
+* @brief A chunk of the matrix as it moves through the pipeline. It starts as
+* raw input text (or compressed blocks of it), becomes a set of rows, and then
+* becomes output text.
+*/
+struct pipeline_chunk
+{
+  pipeline_chunk() :
+    seq(0),
+    inBytes(0),
+    compressed(),
+    blocks(),
+    text(),
+    head(),
+    tail(),
+    hasHead(false),
+    firstRow(0),
+    rowptr(),
+    rowind(),
+    rowval()
+  {
+    // do nothing
+  }
+
+  size_t seq;
+  size_t inBytes;
+
+  // the compressed blocks, as (compressed size, size) pairs
+  std::string compressed;
+  std::vector<std::pair<size_t, size_t>> blocks;
+
+  std::string text;
+
+  // the partial lines at the ends of decompressed blocks, joined with those
+  // of the neighboring chunks by the transform stage
+  std::string head;
+  std::string tail;
+  bool hasHead;
+
+  dim_t firstRow;
+  std::vector<ind_t> rowptr;
+  std::vector<dim_t> rowind;
+  std::vector<val_t> rowval;
+};
+
+
+typedef std::unique_ptr<pipeline_chunk> chunk_ptr;
+
+
+/**
+* @brief Limits how far ahead of an ordered consumer a producer may run, so
+* that the reorder buffers between stages stay bounded.
+*/
+class SequenceWindow
+{
+  public:
+    SequenceWindow(
+        size_t const size) :
+      m_size(size),
+      m_done(0),
+      m_aborted(false),
+      m_mutex(),
+      m_cond()
+    {
+      // do nothing
+    }
+
+    bool waitFor(
+        size_t const seq)
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cond.wait(lock, [this, seq]() {
+        return m_aborted || seq < m_done + m_size;
+      });
+
+      return !m_aborted;
+    }
+
+    void advance()
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_done;
+      }
+      m_cond.notify_all();
+    }
+
+    void abort()
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_aborted = true;
+      }
+      m_cond.notify_all();
+    }
+
+  private:
+    size_t const m_size;
+    size_t m_done;
+    bool m_aborted;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+};
+
+
+/**
+* @brief Accumulates the time a thread spends working and waiting, tracing
+* each interval as an event named after the stage or as a wait.
+*/
+class StageClock
+{
+  public:
+    StageClock(
+        char const * const name) :
+      m_name(name),
+      m_busy(0),
+      m_wait(0),
+      m_last(std::chrono::steady_clock::now())
+    {
+      // do nothing
+    }
+
+    void startWork()
+    {
+      m_wait += lap("wait");
+    }
+
+    void startWait()
+    {
+      m_busy += lap(m_name);
+    }
+
+    double busy() const
+    {
+      return m_busy;
+    }
+
+    double wait() const
+    {
+      return m_wait;
+    }
+
+  private:
+    char const * m_name;
+    double m_busy;
+    double m_wait;
+    std::chrono::steady_clock::time_point m_last;
+
+    double lap(
+        char const * const event)
+    {
+      std::chrono::steady_clock::time_point const now = \
+          std::chrono::steady_clock::now();
+      if (Tracer::isEnabled()) {
+        Tracer::record("pipeline", event, -1, \
+            std::chrono::duration_cast<std::chrono::nanoseconds>( \
+                m_last.time_since_epoch()).count(), \
+            std::chrono::duration_cast<std::chrono::nanoseconds>( \
+                now.time_since_epoch()).count());
+      }
+      double const seconds = \
+          std::chrono::duration<double>(now - m_last).count();
+      m_last = now;
+      return seconds;
+    }
+
+    // disable copying
+    StageClock(
+        StageClock const & rhs);
+    StageClock & operator=(
+        StageClock const & rhs);
+};
+
+
+}
+
+
+
+
+/******************************************************************************
+* HELPER FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+int inputFormat(
+    std::string const & f)
+{
+  if (CSRFile::hasExtension(f)) {
+    return PIPELINE_FORMAT_CSR;
+  } else if (MetisFile::hasExtension(f)) {
+    return PIPELINE_FORMAT_METIS;
+  } else {
+    throw UnknownExtensionException(std::string("Unsupported input for " \
+        "conversion: ") + f);
+  }
+}
+
+
+int outputFormat(
+    std::string const & f)
+{
+  if (CSRFile::hasExtension(f)) {
+    return PIPELINE_FORMAT_CSR;
+  } else if (MetisFile::hasExtension(f)) {
+    return PIPELINE_FORMAT_METIS;
+  } else if (MatrixMarketFile::hasExtension(f)) {
+    return PIPELINE_FORMAT_MATRIXMARKET;
+  } else if (SNAPFile::hasExtension(f)) {
+    return PIPELINE_FORMAT_SNAP;
+  } else {
+    throw UnknownExtensionException(std::string("Unsupported output for " \
+        "conversion: ") + f);
+  }
+}
+
+
+bool isCommentLine(
+    int const format,
+    char const * const line)
+{
+  if (format == PIPELINE_FORMAT_METIS) {
+    return line[0] == '#' || line[0] == '%' || line[0] == '"' || \
+        line[0] == '/';
+  } else {
+    return line[0] == '#';
+  }
+}
+
+
+/**
+* @brief Check whether a CSR file refers to column zero, and so counts its
+* columns from zero, stopping at the first line which does.
+*
+* @param fname The name of the file.
+*
+* @return True if column zero is found.
+*/
+bool hasZeroColumn(
+    std::string const & fname)
+{
+  std::unique_ptr<std::streambuf> const buffer(Compression::openRead(fname));
+  std::istream stream(buffer.get());
+  stream.exceptions(std::istream::badbit);
+
+  std::string line;
+  size_t numLines = 0;
+  while (std::getline(stream, line)) {
+    if (numLines++ % CancelToken::CHECK_INTERVAL == 0) {
+      CancelToken::checkCurrent();
+    }
+    if (line.empty() || isCommentLine(PIPELINE_FORMAT_CSR, line.c_str())) {
+      continue;
+    }
+
+    // the columns alternate with values
+    char * sptr;
+    char * eptr = &line[0];
+    while (true) {
+      sptr = eptr;
+      dim_t const col = static_cast<dim_t>(std::strtoull(sptr, &eptr, 10));
+      if (eptr == sptr) {
+        break;
+      }
+      if (col == 0) {
+        return true;
+      }
+
+      sptr = eptr;
+      std::strtod(sptr, &eptr);
+      if (eptr == sptr) {
+        break;
+      }
+    }
+  }
+
+  return false;
+}
+
+
+std::string padLine(
+    std::string line)
+{
+  if (line.size() < COUNT_LINE_WIDTH) {
+    line.append(COUNT_LINE_WIDTH - line.size(), ' ');
+  }
+  return line + "\n";
+}
+
+
+/**
+* @brief Build the header for the output file. The line containing the
+* counts is padded to a fixed width, so the header has the same length for
+* any counts.
+*
+* @param format The output format.
+* @param fname The output filename.
+* @param nrows The number of rows.
+* @param ncols The number of columns.
+* @param nnz The number of non-zeros.
+* @param hasValues Whether or not values are written.
+*
+* @return The header text.
+*/
+std::string makeHeader(
+    int const format,
+    std::string const & fname,
+    dim_t const nrows,
+    dim_t const ncols,
+    ind_t const nnz,
+    bool const hasValues)
+{
+  std::string header;
+  switch (format) {
+    case PIPELINE_FORMAT_METIS: {
+      if (nnz % 2 != 0) {
+        throw BadParameterException("Metis files are required to be " \
+            "symmetric: odd number of non-zeroes found.");
+      }
+      std::string line = std::to_string(nrows) + " " + \
+          std::to_string(nnz/2);
+      if (hasValues) {
+        line += " 1";
+      }
+      header = padLine(line);
+      break;
+    }
+    case PIPELINE_FORMAT_MATRIXMARKET:
+      header = std::string("%%MatrixMarket matrix coordinate ") + \
+          (hasValues ? "real" : "pattern") + " general\n" + \
+          "%====================================================\n" + \
+          "%= Generated by wildriver. =\n" + \
+          "%====================================================\n" + \
+          padLine(std::to_string(nrows) + " " + std::to_string(ncols) + " " + \
+              std::to_string(nnz));
+      break;
+    case PIPELINE_FORMAT_SNAP:
+      header = std::string("# Directed graph (each unordered pair of nodes " \
+          "is saved once): ") + fname + "\n# A graph.\n" + \
+          padLine(std::string("# Nodes: ") + std::to_string(nrows) + \
+              " Edges: " + std::to_string(nnz)) + \
+          (hasValues ? "# FromNodeId\tToNodeId\tWeight\n" : \
+              "# FromNodeId\tToNodeId\n");
+      break;
+    default:
+      // no header
+      break;
+  }
+
+  return header;
+}
+
+
+}
+
+
+
+
+/******************************************************************************
+* PIPELINE EXECUTION **********************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+/**
+* @brief The state of a single execution of the pipeline.
+*/
+class PipelineRun
+{
+  public:
+    PipelineRun(
+        std::string const & input,
+        std::string const & output,
+        int const numThreads,
+        size_t const chunkSize,
+        size_t const queueDepth,
+        std::vector<dim_t> const & labels,
+        ConversionPipeline::filter_type const & filter,
+        bool const symmetrize,
+        wildriver_stage_stats * const stats) :
+      m_input(input),
+      m_output(output),
+      m_inFormat(inputFormat(input)),
+      m_outFormat(outputFormat(output)),
+      m_outCompression(Compression::forOutput(output)),
+      m_numThreads(numThreads),
+      m_chunkSize(chunkSize),
+      m_labels(labels),
+      m_filter(filter),
+      m_symmetrize(symmetrize),
+      m_oneBased(false),
+      m_hasValues(true),
+      m_numVertexWeights(0),
+      m_inRows(0),
+      m_inCols(0),
+      m_blockCompression(COMPRESSION_NONE),
+      m_numRows(0),
+      m_numCols(0),
+      m_nnz(0),
+      m_carry(),
+      m_symRowptr(1, 0),
+      m_symRowind(),
+      m_symRowval(),
+      m_header(),
+      m_compressBuffer(),
+      m_raw(queueDepth),
+      m_parsed(queueDepth),
+      m_transformed(queueDepth),
+      m_formatted(queueDepth),
+      m_readWindow(2*queueDepth + numThreads),
+      m_writeWindow(2*queueDepth + numThreads),
+      m_activeParsers(numThreads),
+      m_activeFormatters(numThreads),
+      m_aborted(false),
+      m_error(),
+      m_mutex(),
+      m_stats(stats)
+    {
+      for (int s = 0; s < WILDRIVER_NUM_STAGES; ++s) {
+        m_stats[s] = wildriver_stage_stats();
+      }
+      m_stats[WILDRIVER_STAGE_READ].nthreads = 1;
+      m_stats[WILDRIVER_STAGE_PARSE].nthreads = numThreads;
+      m_stats[WILDRIVER_STAGE_TRANSFORM].nthreads = 1;
+      m_stats[WILDRIVER_STAGE_FORMAT].nthreads = numThreads;
+      m_stats[WILDRIVER_STAGE_WRITE].nthreads = 1;
+    }
+
+
+    PipelineRun(
+        PipelineRun const & rhs) = delete;
+
+
+    PipelineRun & operator=(
+        PipelineRun const & rhs) = delete;
+
+
+    void execute()
+    {
+      readInfo();
+
+      m_header = makeHeader(m_outFormat, m_output, 0, 0, 0, m_hasValues);
+
+      std::vector<std::function<void()>> stages;
+      stages.emplace_back(std::bind(&PipelineRun::guard, this, \
+          m_blockCompression != COMPRESSION_NONE ? \
+          &PipelineRun::readBlockStage : &PipelineRun::readStage));
+      for (int t = 0; t < m_numThreads; ++t) {
+        stages.emplace_back(std::bind(&PipelineRun::guard, this, \
+            &PipelineRun::parseStage));
+      }
+      stages.emplace_back(std::bind(&PipelineRun::guard, this, \
+          &PipelineRun::transformStage));
+      for (int t = 0; t < m_numThreads; ++t) {
+        stages.emplace_back(std::bind(&PipelineRun::guard, this, \
+            &PipelineRun::formatStage));
+      }
+      stages.emplace_back(std::bind(&PipelineRun::guard, this, \
+          &PipelineRun::writeStage));
+
+      ThreadPool::getInstance().runPipeline(stages);
+
+      if (m_error) {
+        std::rethrow_exception(m_error);
+      }
+
+      patchHeader();
+
+      for (int s = 0; s < WILDRIVER_NUM_STAGES; ++s) {
+        wildriver_stage_stats & stats = m_stats[s];
+        if (stats.busy > 0) {
+          // the threads of a stage work at once, so their rates add up
+          stats.mbps = (stats.bytes / 1.0e6) / (stats.busy / stats.nthreads);
+        }
+      }
+    }
+
+
+  private:
+    std::string const m_input;
+    std::string const m_output;
+    int const m_inFormat;
+    int const m_outFormat;
+    int const m_outCompression;
+    int const m_numThreads;
+    size_t const m_chunkSize;
+    std::vector<dim_t> const & m_labels;
+    ConversionPipeline::filter_type const & m_filter;
+    bool const m_symmetrize;
+
+    bool m_oneBased;
+    bool m_hasValues;
+    int m_numVertexWeights;
+    dim_t m_inRows;
+    // taken from the header of METIS input, and grown by the transform stage
+    dim_t m_inCols;
+
+    // the compression of block compressed input, which is decompressed by
+    // the parse stage
+    int m_blockCompression;
+
+    // only touched by the transform stage until all threads are joined
+    dim_t m_numRows;
+    dim_t m_numCols;
+    ind_t m_nnz;
+    std::string m_carry;
+    std::vector<ind_t> m_symRowptr;
+    std::vector<dim_t> m_symRowind;
+    std::vector<val_t> m_symRowval;
+
+    std::string m_header;
+
+    // compressed output is kept open until its header is written
+    std::unique_ptr<CompressBuffer> m_compressBuffer;
+
+    BoundedQueue<chunk_ptr> m_raw;
+    BoundedQueue<chunk_ptr> m_parsed;
+    BoundedQueue<chunk_ptr> m_transformed;
+    BoundedQueue<chunk_ptr> m_formatted;
+    SequenceWindow m_readWindow;
+    SequenceWindow m_writeWindow;
+    std::atomic<int> m_activeParsers;
+    std::atomic<int> m_activeFormatters;
+    std::atomic<bool> m_aborted;
+    std::exception_ptr m_error;
+    std::mutex m_mutex;
+    wildriver_stage_stats * const m_stats;
+
+
+    /**
+    * @brief Run a stage, stopping the whole pipeline if it fails.
+    *
+    * @param stage The stage to run.
+    */
+    void guard(
+        void (PipelineRun::*stage)())
+    {
+      try {
+        (this->*stage)();
+      } catch (...) {
+        {
+          std::lock_guard<std::mutex> lock(m_mutex);
+          if (!m_error) {
+            m_error = std::current_exception();
+          }
+        }
+        m_aborted = true;
+        m_raw.close();
+        m_parsed.close();
+        m_transformed.close();
+        m_formatted.close();
+        m_readWindow.abort();
+        m_writeWindow.abort();
+      }
+    }
+
+
+    void record(
+        int const stage,
+        StageClock const & clock,
+        size_t const chunks,
+        size_t const bytes,
+        size_t const rows,
+        size_t const nnz)
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      wildriver_stage_stats & stats = m_stats[stage];
+      stats.chunks += chunks;
+      stats.bytes += bytes;
+      stats.rows += rows;
+      stats.nnz += nnz;
+      stats.busy += clock.busy();
+      stats.wait += clock.wait();
+    }
+
+
+    void readInfo()
+    {
+      if (m_inFormat == PIPELINE_FORMAT_CSR) {
+        // the rows, columns, and non-zeros are counted by the stages and
+        // patched into the header, but the indexing must be known before
+        // any row is parsed, so the input is scanned up to its first zero
+        // column beforehand, which reads one-based input twice
+        m_oneBased = !hasZeroColumn(m_input);
+        m_hasValues = true;
+      } else {
+        MetisFile file(m_input);
+        ind_t nedges;
+        bool ewgts;
+        file.getInfo(m_inRows, nedges, m_numVertexWeights, ewgts);
+        m_inCols = m_inRows;
+        m_hasValues = ewgts;
+      }
+
+      if (BlockReader::isBlocked(m_input)) {
+        m_blockCompression = Compression::fromMagic(m_input);
+      }
+    }
+
+
+    void readStage()
+    {
+      StageClock clock("read");
+
+      // compressed input is decompressed by a thread of its own
+      std::unique_ptr<std::streambuf> buffer(Compression::openRead(m_input));
+      std::istream stream(buffer.get());
+      stream.exceptions(std::istream::badbit);
+
+      if (m_inFormat == PIPELINE_FORMAT_METIS) {
+        // discard comments and the header line
+        std::string line;
+        while (std::getline(stream, line)) {
+          if (line.empty() || !isCommentLine(m_inFormat, line.c_str())) {
+            break;
+          }
+        }
+      }
+
+      size_t seq = 0;
+      size_t bytes = 0;
+      std::string carry;
+      bool eof = false;
+      while (!eof && !m_aborted) {
+        clock.startWait();
+        if (!m_readWindow.waitFor(seq)) {
+          break;
+        }
+        clock.startWork();
+
+        chunk_ptr chunk(new pipeline_chunk());
+        chunk->text.swap(carry);
+
+        size_t const start = chunk->text.size();
+        chunk->text.resize(start + m_chunkSize);
+        stream.read(&chunk->text[start], m_chunkSize);
+        size_t const numRead = static_cast<size_t>(stream.gcount());
+        chunk->text.resize(start + numRead);
+        bytes += numRead;
+        eof = numRead < m_chunkSize;
+
+        if (!eof) {
+          // keep partial lines for the next chunk
+          size_t const last = chunk->text.rfind('\n');
+          if (last == std::string::npos) {
+            // a line longer than the chunk -- keep reading
+            carry.swap(chunk->text);
+            continue;
+          }
+          carry.assign(chunk->text, last+1, std::string::npos);
+          chunk->text.resize(last+1);
+        } else if (chunk->text.empty()) {
+          break;
+        }
+
+        chunk->seq = seq++;
+        chunk->inBytes = chunk->text.size();
+
+        clock.startWait();
+        if (!m_raw.push(std::move(chunk))) {
+          break;
+        }
+        clock.startWork();
+      }
+      clock.startWait();
+
+      m_raw.close();
+
+      record(WILDRIVER_STAGE_READ, clock, seq, bytes, 0, 0);
+    }
+
+
+    /**
+    * @brief Read groups of compressed blocks of a block compressed file,
+    * leaving their decompression to the parse stage.
+    */
+    void readBlockStage()
+    {
+      StageClock clock("read");
+
+      BlockReader reader(m_input);
+      BlockReader::block_struct block;
+
+      size_t seq = 0;
+      size_t bytes = 0;
+      bool eof = false;
+      while (!eof && !m_aborted) {
+        clock.startWait();
+        if (!m_readWindow.waitFor(seq)) {
+          break;
+        }
+        clock.startWork();
+
+        chunk_ptr chunk(new pipeline_chunk());
+        while (chunk->inBytes < m_chunkSize) {
+          size_t const mark = chunk->compressed.size();
+          if (!reader.next(block, &chunk->compressed)) {
+            eof = true;
+            break;
+          }
+          if (block.size == 0) {
+            chunk->compressed.resize(mark);
+            continue;
+          }
+          chunk->blocks.emplace_back(block.compressedSize, block.size);
+          chunk->inBytes += block.size;
+        }
+        if (chunk->blocks.empty()) {
+          break;
+        }
+        bytes += chunk->inBytes;
+
+        chunk->seq = seq++;
+
+        clock.startWait();
+        if (!m_raw.push(std::move(chunk))) {
+          break;
+        }
+        clock.startWork();
+      }
+      clock.startWait();
+
+      m_raw.close();
+
+      record(WILDRIVER_STAGE_READ, clock, seq, bytes, 0, 0);
+    }
+
+
+    /**
+    * @brief Decompress the blocks of a chunk, and split off the partial
+    * lines at its ends.
+    *
+    * @param chunk The chunk.
+    */
+    void decompressChunk(
+        pipeline_chunk & chunk) const
+    {
+      std::string & text = chunk.text;
+      text.resize(chunk.inBytes);
+
+      size_t in = 0;
+      size_t out = 0;
+      for (std::pair<size_t, size_t> const & block : chunk.blocks) {
+        Compression::decompress(m_blockCompression, \
+            chunk.compressed.data() + in, block.first, &text[out], \
+            block.second);
+        in += block.first;
+        out += block.second;
+      }
+      std::string().swap(chunk.compressed);
+
+      size_t start = 0;
+      if (chunk.seq > 0) {
+        size_t const first = text.find('\n');
+        if (first == std::string::npos) {
+          // the whole chunk is part of a line
+          chunk.head.swap(text);
+          return;
+        }
+        chunk.head.assign(text, 0, first);
+        chunk.hasHead = true;
+        start = first+1;
+      } else if (m_inFormat == PIPELINE_FORMAT_METIS) {
+        // discard comments and the header line
+        while (true) {
+          size_t const end = text.find('\n', start);
+          if (end == std::string::npos) {
+            throw BadFileException(std::string("Incomplete header in " \
+                "the first block of '") + m_input + std::string("'"));
+          }
+          bool const header = end == start || \
+              !isCommentLine(m_inFormat, text.c_str() + start);
+          start = end+1;
+          if (header) {
+            break;
+          }
+        }
+      }
+
+      size_t const last = text.rfind('\n');
+      if (last == std::string::npos || last < start) {
+        chunk.tail.assign(text, start, std::string::npos);
+        text.clear();
+      } else {
+        chunk.tail.assign(text, last+1, std::string::npos);
+        text.resize(last+1);
+        text.erase(0, start);
+      }
+    }
+
+
+    void parseChunk(
+        pipeline_chunk & chunk) const
+    {
+      dim_t const offset = m_oneBased ? 1 : 0;
+
+      std::string & text = chunk.text;
+      char * ptr = &text[0];
+      char * const end = ptr + text.size();
+
+      chunk.rowptr.clear();
+      chunk.rowptr.push_back(0);
+      while (ptr < end) {
+        char * lineEnd = \
+            static_cast<char*>(std::memchr(ptr, '\n', end - ptr));
+        if (lineEnd == nullptr) {
+          // the string is null terminated
+          lineEnd = end;
+        } else {
+          *lineEnd = '\0';
+        }
+
+        if (!isCommentLine(m_inFormat, ptr)) {
+          char * sptr;
+          char * eptr = ptr;
+
+          // skip vertex weights
+          for (int k = 0; k < m_numVertexWeights; ++k) {
+            sptr = eptr;
+            std::strtod(sptr, &eptr);
+            if (sptr == eptr) {
+              throw BadFileException(std::string("Failed to read vertex " \
+                  "weight in chunk ") + std::to_string(chunk.seq));
+            }
+          }
+
+          while (true) {
+            sptr = eptr;
+            dim_t col = static_cast<dim_t>(std::strtoull(sptr, &eptr, 10));
+            if (eptr == sptr) {
+              // nothing left to read
+              break;
+            }
+
+            if (m_inFormat == PIPELINE_FORMAT_METIS) {
+              col = col - 1;
+              if (col >= m_inRows) {
+                throw BadFileException(std::string("Edge with destination " \
+                    "of ") + std::to_string(col) + std::string("/") + \
+                    std::to_string(m_inRows));
+              }
+            } else {
+              col = col - offset;
+            }
+            chunk.rowind.push_back(col);
+
+            if (m_hasValues) {
+              sptr = eptr;
+              val_t const val = static_cast<val_t>(std::strtod(sptr, &eptr));
+              if (eptr == sptr) {
+                throw BadFileException(std::string("Failed to read value " \
+                    "in chunk ") + std::to_string(chunk.seq));
+              }
+              chunk.rowval.push_back(val);
+            }
+          }
+          chunk.rowptr.push_back(chunk.rowind.size());
+        }
+
+        ptr = lineEnd + 1;
+      }
+
+      std::string().swap(text);
+    }
+
+
+    void parseStage()
+    {
+      StageClock clock("parse");
+      size_t chunks = 0, bytes = 0, rows = 0, nnz = 0;
+
+      chunk_ptr chunk;
+      while (true) {
+        clock.startWait();
+        if (!m_raw.pop(chunk) || m_aborted) {
+          break;
+        }
+        clock.startWork();
+
+        ++chunks;
+        bytes += chunk->inBytes;
+        if (!chunk->blocks.empty()) {
+          decompressChunk(*chunk);
+        }
+        parseChunk(*chunk);
+        rows += chunk->rowptr.size()-1;
+        nnz += chunk->rowind.size();
+
+        clock.startWait();
+        if (!m_parsed.push(std::move(chunk))) {
+          break;
+        }
+      }
+
+      if (--m_activeParsers == 0) {
+        m_parsed.close();
+      }
+
+      record(WILDRIVER_STAGE_PARSE, clock, chunks, bytes, rows, nnz);
+    }
+
+
+    /**
+    * @brief Complete the line split between the previous chunks and this
+    * one, and add it as the first row of this chunk.
+    *
+    * @param chunk The chunk.
+    */
+    void stitchChunk(
+        pipeline_chunk & chunk)
+    {
+      if (chunk.hasHead) {
+        pipeline_chunk line;
+        line.seq = chunk.seq;
+        line.text.swap(m_carry);
+        line.text.append(chunk.head);
+        line.text.push_back('\n');
+        parseChunk(line);
+
+        ind_t const nnz = line.rowind.size();
+        for (ind_t & ptr : chunk.rowptr) {
+          ptr += nnz;
+        }
+        chunk.rowptr.insert(chunk.rowptr.begin(), line.rowptr.begin(), \
+            line.rowptr.end()-1);
+        chunk.rowind.insert(chunk.rowind.begin(), line.rowind.begin(), \
+            line.rowind.end());
+        chunk.rowval.insert(chunk.rowval.begin(), line.rowval.begin(), \
+            line.rowval.end());
+      } else {
+        m_carry.append(chunk.head);
+      }
+      m_carry.append(chunk.tail);
+
+      std::string().swap(chunk.head);
+      std::string().swap(chunk.tail);
+    }
+
+
+    void transformChunk(
+        pipeline_chunk & chunk)
+    {
+      chunk.firstRow = m_numRows;
+
+      dim_t const nrows = static_cast<dim_t>(chunk.rowptr.size()-1);
+      dim_t const numLabels = static_cast<dim_t>(m_labels.size());
+
+      ind_t out = 0;
+      ind_t start = chunk.rowptr[0];
+      for (dim_t i = 0; i < nrows; ++i) {
+        ind_t const end = chunk.rowptr[i+1];
+        chunk.rowptr[i] = out;
+        for (ind_t j = start; j < end; ++j) {
+          dim_t col = chunk.rowind[j];
+          if (col >= m_inCols) {
+            // the columns of the input, whether or not they are kept
+            m_inCols = col+1;
+          }
+          if (numLabels > 0) {
+            if (col >= numLabels) {
+              throw BadParameterException(std::string("No label for " \
+                  "column ") + std::to_string(col));
+            }
+            col = m_labels[col];
+          }
+          val_t const val = m_hasValues ? chunk.rowval[j] : 1;
+          if (m_filter && !m_filter(chunk.firstRow+i, col, val)) {
+            continue;
+          }
+
+          if (col >= m_numCols) {
+            m_numCols = col+1;
+          }
+          chunk.rowind[out] = col;
+          if (m_hasValues) {
+            chunk.rowval[out] = val;
+          }
+          ++out;
+        }
+        start = end;
+      }
+      chunk.rowptr[nrows] = out;
+      chunk.rowind.resize(out);
+      if (m_hasValues) {
+        chunk.rowval.resize(out);
+      }
+
+      m_numRows += nrows;
+      m_nnz += out;
+    }
+
+
+    void absorbChunk(
+        pipeline_chunk const & chunk)
+    {
+      ind_t const base = m_symRowind.size();
+      dim_t const nrows = static_cast<dim_t>(chunk.rowptr.size()-1);
+      for (dim_t i = 0; i < nrows; ++i) {
+        m_symRowptr.push_back(base + chunk.rowptr[i+1]);
+      }
+      m_symRowind.insert(m_symRowind.end(), chunk.rowind.begin(), \
+          chunk.rowind.end());
+      m_symRowval.insert(m_symRowval.end(), chunk.rowval.begin(), \
+          chunk.rowval.end());
+    }
+
+
+    bool emit(
+        chunk_ptr chunk,
+        size_t const seq,
+        StageClock & clock)
+    {
+      chunk->seq = seq;
+
+      clock.startWait();
+      bool const pushed = m_writeWindow.waitFor(seq) && \
+          m_transformed.push(std::move(chunk));
+      clock.startWork();
+
+      return pushed;
+    }
+
+
+    /**
+    * @brief Emit A + A^T from the absorbed rows. Entries present in both
+    * keep the value from A.
+    *
+    * @param clock The clock of the transform stage.
+    *
+    * @return The number of chunks emitted.
+    */
+    size_t emitSymmetric(
+        StageClock & clock)
+    {
+      dim_t const n = std::max(m_numRows, m_numCols);
+      while (m_symRowptr.size() < static_cast<size_t>(n)+1) {
+        m_symRowptr.push_back(m_symRowptr.back());
+      }
+
+      // build the transpose
+      std::vector<ind_t> tptr(n+1, 0);
+      for (dim_t const col : m_symRowind) {
+        ++tptr[col+1];
+      }
+      for (dim_t i = 0; i < n; ++i) {
+        tptr[i+1] += tptr[i];
+      }
+      std::vector<dim_t> tind(m_symRowind.size());
+      std::vector<val_t> tval(m_hasValues ? m_symRowind.size() : 0);
+      {
+        std::vector<ind_t> next(tptr.begin(), tptr.end()-1);
+        for (dim_t i = 0; i < n; ++i) {
+          for (ind_t j = m_symRowptr[i]; j < m_symRowptr[i+1]; ++j) {
+            ind_t const dst = next[m_symRowind[j]]++;
+            tind[dst] = i;
+            if (m_hasValues) {
+              tval[dst] = m_symRowval[j];
+            }
+          }
+        }
+      }
+
+      m_numRows = n;
+      m_numCols = n;
+      m_nnz = 0;
+
+      size_t seq = 0;
+      std::vector<std::pair<dim_t, ind_t>> row;
+      for (dim_t first = 0; first < n; first += SYMMETRIC_CHUNK_ROWS) {
+        dim_t const last = std::min(n, first + SYMMETRIC_CHUNK_ROWS);
+
+        chunk_ptr chunk(new pipeline_chunk());
+        chunk->firstRow = first;
+        chunk->inBytes = 0;
+        chunk->rowptr.push_back(0);
+        for (dim_t i = first; i < last; ++i) {
+          // entries of A are tagged by even keys, and those of A^T by odd
+          row.clear();
+          for (ind_t j = m_symRowptr[i]; j < m_symRowptr[i+1]; ++j) {
+            row.emplace_back(m_symRowind[j], 2*j);
+          }
+          for (ind_t j = tptr[i]; j < tptr[i+1]; ++j) {
+            row.emplace_back(tind[j], 2*j+1);
+          }
+          std::stable_sort(row.begin(), row.end(), \
+              [](std::pair<dim_t, ind_t> const & a, \
+                std::pair<dim_t, ind_t> const & b) {
+                return a.first < b.first;
+              });
+
+          for (size_t k = 0; k < row.size(); ++k) {
+            if (k > 0 && row[k].first == row[k-1].first) {
+              continue;
+            }
+            chunk->rowind.push_back(row[k].first);
+            if (m_hasValues) {
+              ind_t const key = row[k].second;
+              chunk->rowval.push_back(key % 2 == 0 ? \
+                  m_symRowval[key/2] : tval[key/2]);
+            }
+          }
+          chunk->rowptr.push_back(chunk->rowind.size());
+        }
+        m_nnz += chunk->rowind.size();
+
+        if (!emit(std::move(chunk), seq++, clock)) {
+          break;
+        }
+      }
+
+      return seq;
+    }
+
+
+    void transformStage()
+    {
+      StageClock clock("transform");
+      size_t chunks = 0, bytes = 0;
+
+      std::map<size_t, chunk_ptr> pending;
+      size_t next = 0;
+      size_t seq = 0;
+
+      chunk_ptr chunk;
+      while (true) {
+        clock.startWait();
+        if (!m_parsed.pop(chunk) || m_aborted) {
+          break;
+        }
+        clock.startWork();
+
+        size_t const id = chunk->seq;
+        pending.emplace(id, std::move(chunk));
+
+        // process all chunks which are now in order
+        while (!pending.empty() && pending.begin()->first == next) {
+          chunk = std::move(pending.begin()->second);
+          pending.erase(pending.begin());
+          ++next;
+
+          ++chunks;
+          bytes += chunk->inBytes;
+          if (m_blockCompression != COMPRESSION_NONE) {
+            stitchChunk(*chunk);
+          }
+          transformChunk(*chunk);
+          m_readWindow.advance();
+
+          if (m_symmetrize) {
+            absorbChunk(*chunk);
+          } else if (!emit(std::move(chunk), seq++, clock)) {
+            break;
+          }
+        }
+      }
+
+      if (!m_aborted && !m_carry.empty()) {
+        // the last line of block compressed input, without a newline
+        chunk.reset(new pipeline_chunk());
+        chunk->seq = next;
+        chunk->text.swap(m_carry);
+        parseChunk(*chunk);
+        transformChunk(*chunk);
+
+        ++chunks;
+        if (m_symmetrize) {
+          absorbChunk(*chunk);
+        } else {
+          emit(std::move(chunk), seq++, clock);
+        }
+      }
+
+      if (!m_aborted) {
+        if (m_inFormat == PIPELINE_FORMAT_METIS && m_numRows != m_inRows) {
+          throw BadFileException(std::string("Premature end of file: ") + \
+              std::to_string(m_numRows) + std::string("/") + \
+              std::to_string(m_inRows) + std::string(" vertices found."));
+        }
+        if (m_inCols > m_numCols && m_labels.empty()) {
+          m_numCols = m_inCols;
+        }
+
+        if (m_symmetrize) {
+          chunks = emitSymmetric(clock);
+        }
+      }
+      clock.startWait();
+
+      m_transformed.close();
+
+      record(WILDRIVER_STAGE_TRANSFORM, clock, chunks, bytes, m_numRows, \
+          m_nnz);
+    }
+
+
+    void formatChunk(
+        pipeline_chunk & chunk) const
+    {
+      std::ostringstream stream;
+
+      dim_t const nrows = static_cast<dim_t>(chunk.rowptr.size()-1);
+      for (dim_t i = 0; i < nrows; ++i) {
+        dim_t const row = chunk.firstRow + i;
+        for (ind_t j = chunk.rowptr[i]; j < chunk.rowptr[i+1]; ++j) {
+          dim_t const col = chunk.rowind[j];
+          val_t const val = m_hasValues ? chunk.rowval[j] : 1;
+          switch (m_outFormat) {
+            case PIPELINE_FORMAT_CSR:
+              if (j > chunk.rowptr[i]) {
+                stream << " ";
+              }
+              stream << col << " " << val;
+              break;
+            case PIPELINE_FORMAT_METIS:
+              if (j > chunk.rowptr[i]) {
+                stream << " ";
+              }
+              stream << (col+1);
+              if (m_hasValues) {
+                stream << " " << val;
+              }
+              break;
+            case PIPELINE_FORMAT_MATRIXMARKET:
+              stream << (row+1) << " " << (col+1);
+              if (m_hasValues) {
+                stream << " " << std::to_string(val);
+              }
+              stream << "\n";
+              break;
+            case PIPELINE_FORMAT_SNAP:
+              stream << row << "\t" << col;
+              if (m_hasValues) {
+                stream << "\t" << std::to_string(val);
+              }
+              stream << "\n";
+              break;
+          }
+        }
+
+        if (m_outFormat == PIPELINE_FORMAT_CSR || \
+            m_outFormat == PIPELINE_FORMAT_METIS) {
+          // one line per row
+          stream << "\n";
+        }
+      }
+
+      chunk.text = stream.str();
+
+      std::vector<ind_t>().swap(chunk.rowptr);
+      std::vector<dim_t>().swap(chunk.rowind);
+      std::vector<val_t>().swap(chunk.rowval);
+    }
+
+
+    void formatStage()
+    {
+      StageClock clock("format");
+      size_t chunks = 0, bytes = 0, rows = 0, nnz = 0;
+
+      chunk_ptr chunk;
+      while (true) {
+        clock.startWait();
+        if (!m_transformed.pop(chunk) || m_aborted) {
+          break;
+        }
+        clock.startWork();
+
+        ++chunks;
+        rows += chunk->rowptr.size()-1;
+        nnz += chunk->rowind.size();
+        formatChunk(*chunk);
+        bytes += chunk->text.size();
+
+        clock.startWait();
+        if (!m_formatted.push(std::move(chunk))) {
+          break;
+        }
+      }
+
+      if (--m_activeFormatters == 0) {
+        m_formatted.close();
+      }
+
+      record(WILDRIVER_STAGE_FORMAT, clock, chunks, bytes, rows, nnz);
+    }
+
+
+    void writeStage()
+    {
+      StageClock clock("write");
+      size_t chunks = 0, bytes = 0;
+
+      std::filebuf file;
+      std::streambuf * buffer = &file;
+      if (m_outCompression != COMPRESSION_NONE) {
+        // compressed in blocks by the thread pool
+        m_compressBuffer.reset(new CompressBuffer(m_output, \
+            m_outCompression));
+        buffer = m_compressBuffer.get();
+      } else if (file.open(m_output, std::ios::out | std::ios::trunc | \
+          std::ios::binary) == nullptr) {
+        throw BadFileException(std::string("Failed to open file '") + \
+            m_output + std::string("'"));
+      }
+      std::ostream stream(buffer);
+      stream.exceptions(std::ostream::badbit);
+
+      // reserve space for the header
+      if (m_compressBuffer != nullptr) {
+        if (!m_header.empty()) {
+          m_compressBuffer->reserve(m_header.size());
+        }
+      } else {
+        stream.write(m_header.data(), m_header.size());
+      }
+
+      std::map<size_t, chunk_ptr> pending;
+      size_t next = 0;
+
+      chunk_ptr chunk;
+      while (true) {
+        clock.startWait();
+        if (!m_formatted.pop(chunk) || m_aborted) {
+          break;
+        }
+        clock.startWork();
+
+        size_t const id = chunk->seq;
+        pending.emplace(id, std::move(chunk));
+
+        while (!pending.empty() && pending.begin()->first == next) {
+          std::string const & text = pending.begin()->second->text;
+          stream.write(text.data(), text.size());
+          bytes += text.size();
+          ++chunks;
+
+          pending.erase(pending.begin());
+          ++next;
+          m_writeWindow.advance();
+        }
+      }
+
+      if (!stream.good()) {
+        throw BadFileException(std::string("Failed writing to '") + \
+            m_output + std::string("'"));
+      }
+      clock.startWait();
+
+      record(WILDRIVER_STAGE_WRITE, clock, chunks, bytes, 0, 0);
+    }
+
+
+    void patchHeader()
+    {
+      std::string const header = makeHeader(m_outFormat, m_output, \
+          m_numRows, m_numCols, m_nnz, m_hasValues);
+      assert(header.size() == m_header.size());
+
+      if (m_compressBuffer != nullptr) {
+        if (!header.empty()) {
+          m_compressBuffer->fillReserved(header.data(), header.size());
+        }
+        m_compressBuffer->close();
+        return;
+      }
+
+      if (header.empty()) {
+        return;
+      }
+
+      std::fstream stream(m_output, std::fstream::in | std::fstream::out | \
+          std::fstream::binary);
+      stream.seekp(0);
+      stream.write(header.data(), header.size());
+      if (!stream.good()) {
+        throw BadFileException(std::string("Failed to write header to '") + \
+            m_output + std::string("'"));
+      }
+    }
+};
+
+
+}
+
+
+
+
+/******************************************************************************
+* PUBLIC STATIC FUNCTIONS *****************************************************
+******************************************************************************/
+
+
+bool ConversionPipeline::isSupportedInput(
+    std::string const & f)
+{
+  return CSRFile::hasExtension(f) || MetisFile::hasExtension(f);
+}
+
+
+bool ConversionPipeline::isSupportedOutput(
+    std::string const & f)
+{
+  return CSRFile::hasExtension(f) || MetisFile::hasExtension(f) || \
+      MatrixMarketFile::hasExtension(f) || SNAPFile::hasExtension(f);
+}
+
+
+
+
+/******************************************************************************
+* CONSTRUCTORS / DESTRUCTOR ***************************************************
+******************************************************************************/
+
+
+ConversionPipeline::ConversionPipeline(
+    std::string const & input,
+    std::string const & output) :
+  m_input(input),
+  m_output(output),
+  m_numThreads(0),
+  m_chunkSize(DEFAULT_CHUNK_SIZE),
+  m_queueDepth(DEFAULT_QUEUE_DEPTH),
+  m_labels(),
+  m_filter(),
+  m_symmetrize(false),
+  m_stats()
+{
+  // do nothing
+}
+
+
+
+
+/******************************************************************************
+* PUBLIC FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+void ConversionPipeline::setNumThreads(
+    int const numThreads)
+{
+  if (numThreads < 0) {
+    throw BadParameterException(std::string("Invalid number of threads: ") + \
+        std::to_string(numThreads));
+  }
+  m_numThreads = numThreads;
+}
+
+
+void ConversionPipeline::setChunkSize(
+    size_t const chunkSize)
+{
+  m_chunkSize = chunkSize > 0 ? chunkSize : DEFAULT_CHUNK_SIZE;
+}
+
+
+void ConversionPipeline::setQueueDepth(
+    size_t const depth)
+{
+  m_queueDepth = depth > 0 ? depth : DEFAULT_QUEUE_DEPTH;
+}
+
+
+void ConversionPipeline::setColumnLabels(
+    std::vector<dim_t> labels)
+{
+  m_labels.swap(labels);
+}
+
+
+void ConversionPipeline::setFilter(
+    filter_type filter)
+{
+  m_filter.swap(filter);
+}
+
+
+void ConversionPipeline::setSymmetrize(
+    bool const symmetrize)
+{
+  m_symmetrize = symmetrize;
+}
+
+
+void ConversionPipeline::run()
+{
+  int numThreads = m_numThreads;
+  if (numThreads == 0) {
+    // a parse and a format stage per thread, plus the read, transform, and
+    // write stages, within the most the pool runs at once
+    numThreads = std::max( \
+        (ThreadPool::getInstance().getMaxStages() - 3) / 2, 1);
+  }
+
+  PipelineRun pipeline(m_input, m_output, numThreads, m_chunkSize, \
+      m_queueDepth, m_labels, m_filter, m_symmetrize, m_stats);
+  pipeline.execute();
+}
+
+
+wildriver_stage_stats const & ConversionPipeline::getStageStats(
+    int const stage) const
+{
+  if (stage < 0 || stage >= WILDRIVER_NUM_STAGES) {
+    throw BadParameterException(std::string("Invalid stage: ") + \
+        std::to_string(stage));
+  }
+
+  return m_stats[stage];
+}
+
+
+
+
+}
@@ -0,0 +1,231 @@
+/**
+* @file ConversionPipeline.hpp
+* @brief A multi-threaded pipeline for converting between matrix file formats.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-05-02
+*/
+
+
+
+
+#ifndef WILDRIVER_CONVERSIONPIPELINE_HPP
+#define WILDRIVER_CONVERSIONPIPELINE_HPP
+
+
+
+
+#include <functional>
+#include <string>
+#include <vector>
+
+
+#include "base.h"
+
+
+
+
+namespace WildRiver
+{
+
+
+/**
+* @brief Convert a matrix file from one format to another without building
+* the matrix in memory. The conversion is organized as a series of stages
+* connected by bounded queues:
+*
+* 1. A reader thread splitting the input into line aligned byte chunks.
+* 2. A pool of threads parsing chunks into rows.
+* 3. A single thread applying transforms (relabeling, filtering,
+*    symmetrization) in row order.
+* 4. A pool of threads formatting rows into output text.
+* 5. A single writer thread emitting the formatted chunks in order.
+*
+* The input must be stored row-wise (CSR or METIS). Any supported matrix or
+* graph format may be used as the output. Formats which require counts in
+* their header have the header patched once the conversion finishes.
+*/
+class ConversionPipeline
+{
+  public:
+    /**
+    * @brief The filter used to drop entries during the transform stage.
+    * Entries for which it returns false are removed.
+    */
+    typedef std::function<bool(dim_t row, dim_t col, val_t val)> filter_type;
+
+
+    /**
+     * @brief Check if the given file can be used as input to the pipeline.
+     *
+     * @param f The filename.
+     *
+     * @return True if the file is stored row-wise in a supported format.
+     */
+    static bool isSupportedInput(
+        std::string const & f);
+
+
+    /**
+     * @brief Check if the given file can be used as output of the pipeline.
+     *
+     * @param f The filename.
+     *
+     * @return True if the file is of a supported format.
+     */
+    static bool isSupportedOutput(
+        std::string const & f);
+
+
+    /**
+    * @brief Create a new conversion pipeline.
+    *
+    * @param input The file to read.
+    * @param output The file to write.
+    */
+    ConversionPipeline(
+        std::string const & input,
+        std::string const & output);
+
+
+    /**
+    * @brief Set the number of threads in each of the parse and format pools.
+    * Conversions run at once share the stage threads of the library's
+    * thread pool, and one with more stages than it runs at once waits to
+    * run on its own.
+    *
+    * @param numThreads The number of threads (0 to use the number of
+    * threads of the library's thread pool, or one within an OpenMP parallel
+    * region).
+    */
+    void setNumThreads(
+        int numThreads);
+
+
+    /**
+    * @brief Set the target size of the byte chunks read from the input.
+    *
+    * @param chunkSize The size in bytes (0 for the default).
+    */
+    void setChunkSize(
+        size_t chunkSize);
+
+
+    /**
+    * @brief Set the capacity of each queue between stages.
+    *
+    * @param depth The number of chunks (0 for the default).
+    */
+    void setQueueDepth(
+        size_t depth);
+
+
+    /**
+    * @brief Set new labels for the columns of the matrix, such that column
+    * `i` becomes column `labels[i]`.
+    *
+    * @param labels The new labels (empty to disable relabeling).
+    */
+    void setColumnLabels(
+        std::vector<dim_t> labels);
+
+
+    /**
+    * @brief Set the filter for removing entries.
+    *
+    * @param filter The filter (empty to disable filtering).
+    */
+    void setFilter(
+        filter_type filter);
+
+
+    /**
+    * @brief Set whether or not the output should be symmetrized (A + A^T).
+    * As entries of a row may come from any later row, this requires the
+    * transform stage to hold the whole matrix.
+    *
+    * @param symmetrize True to symmetrize the output.
+    */
+    void setSymmetrize(
+        bool symmetrize);
+
+
+    /**
+    * @brief Perform the conversion. If any stage fails, all stages are
+    * stopped and the first error is re-thrown.
+    */
+    void run();
+
+
+    /**
+    * @brief Get the statistics of a stage from the last run.
+    *
+    * @param stage The stage (WILDRIVER_STAGE_*).
+    *
+    * @return The statistics.
+    */
+    wildriver_stage_stats const & getStageStats(
+        int stage) const;
+
+
+  private:
+    /**
+    * @brief The input filename/path.
+    */
+    std::string m_input;
+
+    /**
+    * @brief The output filename/path.
+    */
+    std::string m_output;
+
+    /**
+    * @brief The number of threads in each pool (0 for the library's).
+    */
+    int m_numThreads;
+
+    /**
+    * @brief The target size of input chunks in bytes.
+    */
+    size_t m_chunkSize;
+
+    /**
+    * @brief The capacity of the queues between stages.
+    */
+    size_t m_queueDepth;
+
+    /**
+    * @brief The new label of each column (empty for no relabeling).
+    */
+    std::vector<dim_t> m_labels;
+
+    /**
+    * @brief The entry filter (empty for no filtering).
+    */
+    filter_type m_filter;
+
+    /**
+    * @brief Whether or not to symmetrize the matrix.
+    */
+    bool m_symmetrize;
+
+    /**
+    * @brief The statistics of each stage from the last run.
+    */
+    wildriver_stage_stats m_stats[WILDRIVER_NUM_STAGES];
+
+
+
+
+};
+
+
+
+
+}
+
+
+
+
+#endif
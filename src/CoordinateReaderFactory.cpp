@@ -0,0 +1,58 @@
+/**
+ * @file CoordinateReaderFactory.cpp
+ * @brief Implementation of the CoordinateReaderFactory class.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-09
+ */
+
+
+
+
+#include "CoordinateReaderFactory.hpp"
+#include "MatrixMarketFile.hpp"
+#include "SNAPFile.hpp"
+#include "Exception.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/******************************************************************************
+* STATIC FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+bool CoordinateReaderFactory::isSupported(
+    std::string const & name)
+{
+  return MatrixMarketFile::hasExtension(name) || SNAPFile::hasExtension(name);
+}
+
+
+std::unique_ptr<ICoordinateReader> CoordinateReaderFactory::make(
+    std::string const & name)
+{
+  std::unique_ptr<ICoordinateReader> file;
+
+  // determine what type of reader to instantiate based on extension
+  if (MatrixMarketFile::hasExtension(name)) {
+    file.reset(new MatrixMarketFile(name));
+  } else if (SNAPFile::hasExtension(name)) {
+    file.reset(new SNAPFile(name));
+  } else {
+    throw UnknownExtensionException(std::string("Unknown coordinate " \
+        "filetype: ") + name);
+  }
+
+  return file;
+}
+
+
+
+
+}
@@ -0,0 +1,65 @@
+/**
+ * @file CoordinateReaderFactory.hpp
+ * @brief Class for instantiating coordinate matrix readers.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-09
+ */
+
+
+
+
+#ifndef WILDRIVER_COORDINATEREADERFACTORY_HPP
+#define WILDRIVER_COORDINATEREADERFACTORY_HPP
+
+
+
+
+#include <memory>
+#include <string>
+#include "ICoordinateReader.hpp"
+
+
+
+namespace WildRiver
+{
+
+
+class CoordinateReaderFactory
+{
+  public:
+    /**
+     * @brief Check if the given file can be streamed as coordinates.
+     *
+     * @param name The filename.
+     *
+     * @return True if a coordinate reader exists for the file type.
+     */
+    static bool isSupported(
+        std::string const & name);
+
+
+    /**
+     * @brief Instantiate a coordinate file.
+     *
+     * @param name The name of the file to open.
+     *
+     * @return The instantiated object.
+     *
+     * @throw UnknownExtensionException If no class reading the specified file
+     * type can be found.
+     */
+    static std::unique_ptr<ICoordinateReader> make(
+        std::string const & name);
+};
+
+
+
+
+}
+
+
+
+
+#endif
@@ -27,7 +27,8 @@ namespace WildRiver
 CoordinateWriter::CoordinateWriter(
     TextFile * const file) :
   m_numWrittenRows(0),
-  m_file(file)
+  m_file(file),
+  m_buffer()
 {
   // do nothing
 }
@@ -68,6 +69,37 @@ void CoordinateWriter::setNextRow(
 }
 
 
+void CoordinateWriter::setNextRows(
+    dim_t const numRows,
+    ind_t const * const rowptr,
+    dim_t const * const columns,
+    val_t const * const values)
+{
+  m_buffer.clear();
+  for (dim_t i = 0; i < numRows; ++i) {
+    std::string const rowStr(std::to_string(m_numWrittenRows) + \
+        std::string("  "));
+    for (ind_t j = rowptr[i]; j < rowptr[i+1]; ++j) {
+      m_buffer += rowStr;
+      m_buffer += std::to_string(columns[j]);
+      if (values != nullptr) {
+        m_buffer += ' ';
+        m_buffer += std::to_string(values[j]);
+      }
+      m_buffer += '\n';
+    }
+
+    ++m_numWrittenRows;
+  }
+
+  if (!m_buffer.empty()) {
+    // the file adds the final newline
+    m_buffer.pop_back();
+    m_file->setNextLine(m_buffer);
+  }
+}
+
+
 
 
 }
@@ -18,6 +18,7 @@
 
 #include "IRowMatrixWriter.hpp"
 #include <memory>
+#include <string>
 
 
 
@@ -91,6 +92,23 @@ class CoordinateWriter : public IRowMatrixWriter
         val_t const * values) override;
 
 
+    /**
+     * @brief Set the next several rows in the matrix file, formatting them
+     * into a single buffer which is written at once.
+     *
+     * @param numRows The number of rows to set.
+     * @param rowptr The row pointer of the rows (length numRows+1), indexing
+     * columns and values.
+     * @param columns The column IDs.
+     * @param values The values (may be null).
+     */
+    virtual void setNextRows(
+        dim_t numRows,
+        ind_t const * rowptr,
+        dim_t const * columns,
+        val_t const * values) override;
+
+
 
 
   private:
@@ -104,6 +122,11 @@ class CoordinateWriter : public IRowMatrixWriter
     */
     TextFile * m_file;
 
+    /**
+    * @brief The buffer for formatting batches of rows.
+    */
+    std::string m_buffer;
+
 
 
 };
@@ -0,0 +1,271 @@
+/**
+ * @file DecompressBuffer.cpp
+ * @brief Implementation of the DecompressBuffer class.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-27
+ */
+
+
+
+
+#include "DecompressBuffer.hpp"
+#include "BlockReader.hpp"
+#include "Tracer.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+
+size_t const DecompressBuffer::BLOCK_SIZE = 1024*1024;
+
+
+size_t const DecompressBuffer::NUM_BLOCKS = 4;
+
+
+
+
+/******************************************************************************
+* CONSTRUCTORS / DESTRUCTOR ***************************************************
+******************************************************************************/
+
+
+DecompressBuffer::DecompressBuffer(
+    std::string const & name,
+    int const compression) :
+  m_name(name),
+  m_compression(compression),
+  m_blocked(BlockReader::isBlocked(name)),
+  m_index(),
+  m_free(),
+  m_filled(),
+  m_current(),
+  m_position(0),
+  m_compressedBytes(0),
+  m_passCompressedBytes(0),
+  m_error(),
+  m_thread()
+{
+  start(0, 0);
+}
+
+
+DecompressBuffer::~DecompressBuffer()
+{
+  stop();
+}
+
+
+
+
+/******************************************************************************
+* PROTECTED FUNCTIONS *********************************************************
+******************************************************************************/
+
+
+DecompressBuffer::int_type DecompressBuffer::underflow()
+{
+  if (gptr() < egptr()) {
+    return traits_type::to_int_type(*gptr());
+  }
+
+  if (!nextBlock()) {
+    return traits_type::eof();
+  }
+
+  return traits_type::to_int_type(*gptr());
+}
+
+
+DecompressBuffer::pos_type DecompressBuffer::seekoff(
+    off_type const off,
+    std::ios_base::seekdir const dir,
+    std::ios_base::openmode const which)
+{
+  off_type const current = static_cast<off_type>(m_position) + \
+      (gptr() - eback());
+
+  if (dir == std::ios_base::cur) {
+    if (off == 0) {
+      // a query of the position
+      return pos_type(current);
+    }
+    return seekpos(pos_type(current + off), which);
+  } else if (dir == std::ios_base::beg) {
+    return seekpos(pos_type(off), which);
+  }
+
+  // the size is unknown until the file is decompressed
+  return pos_type(off_type(-1));
+}
+
+
+DecompressBuffer::pos_type DecompressBuffer::seekpos(
+    pos_type const pos,
+    std::ios_base::openmode const which)
+{
+  off_type const target = static_cast<off_type>(pos);
+  if (target < 0 || !(which & std::ios_base::in)) {
+    return pos_type(off_type(-1));
+  }
+
+  size_t const offset = static_cast<size_t>(target);
+  size_t const end = m_position + (m_current != nullptr ? m_current->size : 0);
+  if (offset < m_position || \
+      (m_blocked && offset > end + NUM_BLOCKS*BLOCK_SIZE)) {
+    jump(offset);
+  }
+
+  while (offset > m_position + (m_current != nullptr ? m_current->size : 0)) {
+    if (!nextBlock()) {
+      return pos_type(off_type(-1));
+    }
+  }
+
+  if (m_current == nullptr) {
+    // at the start, before the first block
+    return pos;
+  }
+
+  char * const data = m_current->data.get();
+  setg(data, data + (offset - m_position), data + m_current->size);
+
+  return pos;
+}
+
+
+
+
+/******************************************************************************
+* PRIVATE FUNCTIONS ***********************************************************
+******************************************************************************/
+
+
+void DecompressBuffer::start(
+    size_t const compressedOffset,
+    size_t const position)
+{
+  // open the file before returning, so errors are not deferred
+  std::unique_ptr<Compression::Decoder> decoder( \
+      Compression::makeDecoder(m_name, m_compression, compressedOffset));
+
+  m_free.reset(new BoundedQueue<block_ptr>(NUM_BLOCKS));
+  m_filled.reset(new BoundedQueue<block_ptr>(NUM_BLOCKS));
+  for (size_t i = 0; i < NUM_BLOCKS; ++i) {
+    m_free->push(block_ptr(new block_struct));
+  }
+
+  m_current.reset();
+  m_position = position;
+  m_passCompressedBytes = 0;
+  m_error = nullptr;
+  setg(nullptr, nullptr, nullptr);
+
+  m_thread = std::thread(&DecompressBuffer::decompress, this, \
+      std::move(decoder));
+}
+
+
+void DecompressBuffer::stop()
+{
+  if (m_thread.joinable()) {
+    m_free->close();
+    m_filled->close();
+    m_thread.join();
+  }
+}
+
+
+void DecompressBuffer::jump(
+    size_t const offset)
+{
+  stop();
+
+  if (!m_blocked || offset == 0) {
+    // restart from the beginning
+    start(0, 0);
+    return;
+  }
+
+  if (m_index.empty()) {
+    m_index = BlockReader::readIndex(m_name);
+  }
+  if (m_index.empty()) {
+    start(0, 0);
+    return;
+  }
+
+  BlockReader::block_struct const & block = \
+      m_index[BlockReader::findBlock(m_index, offset)];
+  start(block.compressedOffset, block.offset);
+}
+
+
+bool DecompressBuffer::nextBlock()
+{
+  if (m_current != nullptr) {
+    m_position += m_current->size;
+    m_free->push(std::move(m_current));
+    m_current.reset();
+  }
+  setg(nullptr, nullptr, nullptr);
+
+  block_ptr block;
+  if (!m_filled->pop(block)) {
+    if (m_error != nullptr) {
+      std::rethrow_exception(m_error);
+    }
+    return false;
+  }
+
+  m_compressedBytes += block->compressedBytes - m_passCompressedBytes;
+  m_passCompressedBytes = block->compressedBytes;
+
+  m_current = std::move(block);
+  char * const data = m_current->data.get();
+  setg(data, data, data + m_current->size);
+
+  return true;
+}
+
+
+void DecompressBuffer::decompress(
+    std::unique_ptr<Compression::Decoder> decoder)
+{
+  Tracer::setThreadName("decompress");
+
+  try {
+    int64_t index = 0;
+    block_ptr block;
+    while (m_free->pop(block)) {
+      Tracer::Span span("reader", "decompress", index++);
+
+      block->size = decoder->read(block->data.get(), BLOCK_SIZE);
+      block->compressedBytes = decoder->getCompressedBytes();
+
+      bool const end = block->size < BLOCK_SIZE;
+      if ((block->size > 0 && !m_filled->push(std::move(block))) || end) {
+        break;
+      }
+    }
+  } catch (...) {
+    // passed to the reader once it has consumed the blocks before the error
+    m_error = std::current_exception();
+  }
+
+  m_filled->close();
+}
+
+
+
+
+}
@@ -0,0 +1,210 @@
+/**
+ * @file DecompressBuffer.hpp
+ * @brief A stream buffer which decompresses a file in the background.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-27
+ */
+
+
+
+
+#ifndef WILDRIVER_DECOMPRESSBUFFER_HPP
+#define WILDRIVER_DECOMPRESSBUFFER_HPP
+
+
+
+
+#include <exception>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BlockReader.hpp"
+#include "BoundedQueue.hpp"
+#include "Compression.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/**
+ * @brief A read only stream buffer over the decompressed contents of a file.
+ * A background thread decompresses the file into a ring of blocks, which the
+ * reader parses as they are filled, so that decompression overlaps parsing.
+ *
+ * Seeking forward skips decompressed blocks, and seeking backward restarts
+ * decompression from the start of the file. In block compressed files (see
+ * BlockReader), decompression instead restarts from the block holding the
+ * target, for seeks backward or far forward.
+ */
+class DecompressBuffer : public std::streambuf
+{
+  public:
+    /**
+     * @brief The number of bytes of each block.
+     */
+    static size_t const BLOCK_SIZE;
+
+
+    /**
+     * @brief The number of blocks in the ring.
+     */
+    static size_t const NUM_BLOCKS;
+
+
+    /**
+     * @brief Start decompressing a file.
+     *
+     * @param name The filename/path.
+     * @param compression The compression of the file (a compression_type).
+     *
+     * @throw BadFileException If the file cannot be opened or support for
+     * the compression was not built.
+     */
+    DecompressBuffer(
+        std::string const & name,
+        int compression);
+
+
+    /**
+     * @brief Stop decompressing.
+     */
+    ~DecompressBuffer();
+
+
+    /**
+     * @brief Get the number of bytes of the compressed file consumed so far,
+     * counting each pass over the file.
+     *
+     * @return The number of bytes.
+     */
+    size_t getCompressedBytes() const noexcept
+    {
+      return m_compressedBytes;
+    }
+
+
+  protected:
+    int_type underflow() override;
+
+
+    pos_type seekoff(
+        off_type off,
+        std::ios_base::seekdir dir,
+        std::ios_base::openmode which) override;
+
+
+    pos_type seekpos(
+        pos_type pos,
+        std::ios_base::openmode which) override;
+
+
+  private:
+    /**
+     * @brief A block of decompressed data.
+     */
+    struct block_struct
+    {
+      block_struct() :
+        data(new char[BLOCK_SIZE]),
+        size(0),
+        compressedBytes(0)
+      {
+        // do nothing
+      }
+
+      std::unique_ptr<char[]> data;
+      size_t size;
+      size_t compressedBytes;
+    };
+
+    typedef std::unique_ptr<block_struct> block_ptr;
+
+
+    std::string const m_name;
+    int const m_compression;
+    bool const m_blocked;
+    std::vector<BlockReader::block_struct> m_index;
+    std::unique_ptr<BoundedQueue<block_ptr>> m_free;
+    std::unique_ptr<BoundedQueue<block_ptr>> m_filled;
+    block_ptr m_current;
+    size_t m_position;
+    size_t m_compressedBytes;
+    size_t m_passCompressedBytes;
+    std::exception_ptr m_error;
+    std::thread m_thread;
+
+
+    /**
+     * @brief Start decompressing.
+     *
+     * @param compressedOffset The offset in the file to start at (the start
+     * of a block for block compressed files).
+     * @param position The offset of the decompressed contents it holds.
+     */
+    void start(
+        size_t compressedOffset,
+        size_t position);
+
+
+    /**
+     * @brief Restart decompressing at or before an offset of the
+     * decompressed contents.
+     *
+     * @param offset The offset.
+     */
+    void jump(
+        size_t offset);
+
+
+    /**
+     * @brief Stop decompressing, waiting for the background thread to exit.
+     */
+    void stop();
+
+
+    /**
+     * @brief Move to the next decompressed block.
+     *
+     * @return False if the end of the file was reached.
+     */
+    bool nextBlock();
+
+
+    /**
+     * @brief Decompress the file into the ring of blocks. This is run by the
+     * background thread.
+     *
+     * @param decoder The decoder of the file.
+     */
+    void decompress(
+        std::unique_ptr<Compression::Decoder> decoder);
+
+
+    // disable copying
+    DecompressBuffer(
+        DecompressBuffer const & rhs);
+    DecompressBuffer & operator=(
+        DecompressBuffer const & rhs);
+
+
+
+
+};
+
+
+
+
+}
+
+
+
+
+#endif
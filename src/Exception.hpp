@@ -101,6 +101,45 @@ class OutOfMemoryException : public std::runtime_error
           std::to_string(nbytes) + " bytes")
     {
     }
+
+    OutOfMemoryException(
+        std::string const & str) : 
+      std::runtime_error(str)
+    {
+    }
+};
+
+
+class MemoryBudgetException : public OutOfMemoryException 
+{
+  public:
+    MemoryBudgetException(
+        std::string const & str) : 
+      OutOfMemoryException(str)
+    {
+    }
+};
+
+
+class CancelledException : public std::runtime_error 
+{
+  public:
+    CancelledException(
+        std::string const & str) : 
+      std::runtime_error(str)
+    {
+    }
+};
+
+
+class DeadlineExceededException : public CancelledException 
+{
+  public:
+    DeadlineExceededException(
+        std::string const & str) : 
+      CancelledException(str)
+    {
+    }
 };
 
 
@@ -0,0 +1,609 @@
+/**
+* @file ExternalCSRBuilder.cpp
+* @brief Implementation of the ExternalCSRBuilder class.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-05-09
+*/
+
+
+
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <queue>
+#include <random>
+#include <sstream>
+
+
+#include "ExternalCSRBuilder.hpp"
+#include "Exception.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/******************************************************************************
+* TYPES ***********************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+typedef ExternalCSRBuilder::entry_struct entry_struct;
+
+
+/**
+* @brief Order entries by row and then column.
+*/
+bool entryLess(
+    entry_struct const & a,
+    entry_struct const & b) noexcept
+{
+  return a.row < b.row || (a.row == b.row && a.col < b.col);
+}
+
+
+/**
+* @brief Buffered sequential reader of a run file.
+*/
+class RunReader
+{
+  public:
+    RunReader(
+        std::string const & name,
+        size_t const bufferSize) :
+      m_name(name),
+      m_stream(name, std::ios::in | std::ios::binary),
+      m_buffer(),
+      m_pos(0),
+      m_bufferSize(bufferSize)
+    {
+      if (!m_stream.is_open()) {
+        throw BadFileException(std::string("Unable to open run file '") + \
+            name + std::string("'."));
+      }
+      fill();
+    }
+
+
+    bool valid() const noexcept
+    {
+      return m_pos < m_buffer.size();
+    }
+
+
+    entry_struct const & front() const noexcept
+    {
+      return m_buffer[m_pos];
+    }
+
+
+    void pop()
+    {
+      ++m_pos;
+      if (m_pos == m_buffer.size()) {
+        fill();
+      }
+    }
+
+
+  private:
+    std::string m_name;
+    std::ifstream m_stream;
+    std::vector<entry_struct> m_buffer;
+    size_t m_pos;
+    size_t m_bufferSize;
+
+
+    void fill()
+    {
+      m_buffer.resize(m_bufferSize);
+      m_stream.read(reinterpret_cast<char*>(m_buffer.data()), \
+          m_bufferSize*sizeof(entry_struct));
+      size_t const bytes = static_cast<size_t>(m_stream.gcount());
+      if (bytes % sizeof(entry_struct) != 0) {
+        throw BadFileException(std::string("Truncated run file '") + \
+            m_name + std::string("'."));
+      }
+      m_buffer.resize(bytes / sizeof(entry_struct));
+      m_pos = 0;
+    }
+};
+
+
+/**
+* @brief Buffered sequential writer of a run file.
+*/
+class RunWriter
+{
+  public:
+    RunWriter(
+        std::string const & name,
+        size_t const bufferSize) :
+      m_name(name),
+      m_stream(name, std::ios::out | std::ios::binary | std::ios::trunc),
+      m_buffer(),
+      m_bufferSize(bufferSize)
+    {
+      if (!m_stream.is_open()) {
+        throw BadFileException(std::string("Unable to create run file '") + \
+            name + std::string("'."));
+      }
+      m_buffer.reserve(m_bufferSize);
+    }
+
+
+    void push(
+        entry_struct const & entry)
+    {
+      m_buffer.emplace_back(entry);
+      if (m_buffer.size() == m_bufferSize) {
+        flush();
+      }
+    }
+
+
+    void write(
+        entry_struct const * const entries,
+        size_t const num)
+    {
+      m_stream.write(reinterpret_cast<char const*>(entries), \
+          num*sizeof(entry_struct));
+      if (!m_stream) {
+        throw BadFileException(std::string("Failed to write run file '") + \
+            m_name + std::string("'."));
+      }
+    }
+
+
+    void flush()
+    {
+      write(m_buffer.data(), m_buffer.size());
+      m_buffer.clear();
+    }
+
+
+  private:
+    std::string m_name;
+    std::ofstream m_stream;
+    std::vector<entry_struct> m_buffer;
+    size_t m_bufferSize;
+};
+
+
+/**
+* @brief Assemble sorted entries into rows for a row writer.
+*/
+class RowAssembler
+{
+  public:
+    RowAssembler(
+        dim_t const nrows,
+        dim_t const ncols,
+        IRowMatrixWriter * const writer) :
+      m_numRows(nrows),
+      m_numCols(ncols),
+      m_row(0),
+      m_columns(),
+      m_values(),
+      m_writer(writer)
+    {
+      // do nothing
+    }
+
+
+    void push(
+        entry_struct const & entry)
+    {
+      if (entry.row >= m_numRows || entry.col >= m_numCols) {
+        throw BadParameterException(std::string("Entry (") + \
+            std::to_string(entry.row) + std::string(", ") + \
+            std::to_string(entry.col) + std::string(") is outside of the " \
+            "matrix."));
+      }
+
+      while (m_row < entry.row) {
+        emitRow();
+      }
+      m_columns.emplace_back(entry.col);
+      m_values.emplace_back(entry.val);
+    }
+
+
+    void finish()
+    {
+      while (m_row < m_numRows) {
+        emitRow();
+      }
+    }
+
+
+  private:
+    dim_t m_numRows;
+    dim_t m_numCols;
+    dim_t m_row;
+    std::vector<dim_t> m_columns;
+    std::vector<val_t> m_values;
+    IRowMatrixWriter * m_writer;
+
+
+    void emitRow()
+    {
+      m_writer->setNextRow(static_cast<dim_t>(m_columns.size()), \
+          m_columns.data(), m_values.data());
+      m_columns.clear();
+      m_values.clear();
+      ++m_row;
+    }
+
+
+    // disable copying
+    RowAssembler(
+        RowAssembler const & rhs);
+    RowAssembler & operator=(
+        RowAssembler const & rhs);
+};
+
+
+/**
+* @brief Merge a set of sorted runs, passing the entries in order to the
+* given function. Ties are broken by the position of the run, so that the
+* relative order of equal entries is preserved.
+*
+* @tparam F The type of function.
+* @param names The run files.
+* @param bufferSize The number of entries to buffer per run.
+* @param out The function to pass entries to.
+*/
+template<typename F>
+void mergeRuns(
+    std::vector<std::string> const & names,
+    size_t const bufferSize,
+    F & out)
+{
+  std::vector<std::unique_ptr<RunReader>> readers;
+  readers.reserve(names.size());
+  for (std::string const & name : names) {
+    readers.emplace_back(new RunReader(name, bufferSize));
+  }
+
+  auto const greater = [&readers](size_t const a, size_t const b) {
+    entry_struct const & x = readers[a]->front();
+    entry_struct const & y = readers[b]->front();
+    return entryLess(y, x) || (!entryLess(x, y) && a > b);
+  };
+  std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> \
+      heap(greater);
+
+  for (size_t i = 0; i < readers.size(); ++i) {
+    if (readers[i]->valid()) {
+      heap.push(i);
+    }
+  }
+
+  while (!heap.empty()) {
+    size_t const run = heap.top();
+    heap.pop();
+
+    out(readers[run]->front());
+    readers[run]->pop();
+
+    if (readers[run]->valid()) {
+      heap.push(run);
+    }
+  }
+}
+
+
+}
+
+
+
+
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+/**
+* @brief The fewest entries each run should have buffered while merging.
+*/
+size_t const MIN_RUN_BUFFER = 64;
+
+/**
+* @brief The maximum number of runs to merge at once.
+*/
+size_t const MAX_FAN_IN = 128;
+
+/**
+* @brief The fewest entries to make room for when the buffer grows.
+*/
+size_t const MIN_BUFFER_GROWTH = 4096;
+
+/**
+* @brief The number of entries to write to a run at a time when spilling.
+*/
+size_t const SPILL_BATCH = 1024;
+
+
+}
+
+
+size_t const ExternalCSRBuilder::DEFAULT_MEMORY_BUDGET = 256*1024*1024;
+
+
+
+
+/******************************************************************************
+* HELPER FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+/**
+* @brief Create a prefix for run files that will not collide with other
+* builders or processes.
+*
+* @param tempDir The directory for run files.
+*
+* @return The prefix.
+*/
+std::string makePrefix(
+    std::string tempDir)
+{
+  if (tempDir.empty()) {
+    char const * const env = std::getenv("TMPDIR");
+    tempDir = (env != nullptr && env[0] != '\0') ? env : "/tmp";
+  }
+
+  std::random_device rd;
+  std::ostringstream prefix;
+  prefix << tempDir << "/wildriver-" << std::hex << rd() << rd() << "-";
+
+  return prefix.str();
+}
+
+
+}
+
+
+
+
+/******************************************************************************
+* CONSTRUCTORS / DESTRUCTOR ***************************************************
+******************************************************************************/
+
+
+ExternalCSRBuilder::ExternalCSRBuilder(
+    std::string const & tempDir,
+    size_t memoryBudget,
+    size_t const maxEntries) :
+  m_prefix(makePrefix(tempDir)),
+  m_capacity(0),
+  m_numEntries(0),
+  m_numRuns(0),
+  m_built(false),
+  m_buffer(),
+  m_runs()
+{
+  if (memoryBudget == 0) {
+    memoryBudget = DEFAULT_MEMORY_BUDGET;
+  }
+  m_capacity = std::max(memoryBudget / sizeof(buffered_struct), \
+      static_cast<size_t>(1));
+  if (maxEntries > 0) {
+    m_capacity = std::min(m_capacity, maxEntries);
+  }
+}
+
+
+ExternalCSRBuilder::~ExternalCSRBuilder()
+{
+  for (std::string const & run : m_runs) {
+    std::remove(run.c_str());
+  }
+}
+
+
+
+
+/******************************************************************************
+* PUBLIC FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+void ExternalCSRBuilder::add(
+    dim_t const row,
+    dim_t const col,
+    val_t const val)
+{
+  if (m_built) {
+    throw BadFileStateException("Cannot add entries after build().");
+  }
+
+  if (m_buffer.size() == m_buffer.capacity()) {
+    grow();
+  }
+
+  m_buffer.emplace_back(buffered_struct{entry_struct{row, col, val}, \
+      m_buffer.size()});
+  ++m_numEntries;
+}
+
+
+void ExternalCSRBuilder::build(
+    dim_t const nrows,
+    dim_t const ncols,
+    IRowMatrixWriter * const writer)
+{
+  if (m_built) {
+    throw BadFileStateException("Cannot call build() more than once.");
+  }
+  m_built = true;
+
+  writer->writeHeader(nrows, ncols, m_numEntries);
+
+  emit(nrows, ncols, writer);
+}
+
+
+
+
+/******************************************************************************
+* PRIVATE FUNCTIONS ***********************************************************
+******************************************************************************/
+
+
+std::string ExternalCSRBuilder::newRunName()
+{
+  return m_prefix + std::to_string(m_numRuns++) + std::string(".run");
+}
+
+
+void ExternalCSRBuilder::sortBuffer()
+{
+  // unlike std::stable_sort, this needs no temporary buffer
+  std::sort(m_buffer.begin(), m_buffer.end(), \
+      [](buffered_struct const & a, buffered_struct const & b) {
+    return entryLess(a.entry, b.entry) || \
+        (!entryLess(b.entry, a.entry) && a.seq < b.seq);
+  });
+}
+
+
+void ExternalCSRBuilder::grow()
+{
+  size_t const size = m_buffer.size();
+  if (size >= m_capacity) {
+    spill();
+    return;
+  }
+
+  // the old and new buffers are both held while growing, so grow only as
+  // far as they fit in the budget together
+  size_t const next = std::min(std::max(2*size, MIN_BUFFER_GROWTH), \
+      m_capacity - size);
+  if (next > size) {
+    m_buffer.reserve(next);
+  } else {
+    // no room to grow in place, so spill and start again at full size
+    spill();
+    std::vector<buffered_struct>().swap(m_buffer);
+    m_buffer.reserve(m_capacity);
+  }
+}
+
+
+void ExternalCSRBuilder::spill()
+{
+  sortBuffer();
+
+  std::string const name = newRunName();
+  m_runs.emplace_back(name);
+
+  // the entries are written without the order they were added in, a batch
+  // at a time
+  RunWriter run(name, SPILL_BATCH);
+  for (buffered_struct const & buffered : m_buffer) {
+    run.push(buffered.entry);
+  }
+  run.flush();
+
+  m_buffer.clear();
+}
+
+
+void ExternalCSRBuilder::reduceRuns(
+    size_t const fanIn)
+{
+  // each input run and the output run get an equal share of the budget
+  size_t const bufferSize = std::max(m_capacity / (fanIn+1), \
+      static_cast<size_t>(1));
+
+  while (m_runs.size() > fanIn) {
+    std::vector<std::string> merged;
+    for (size_t start = 0; start < m_runs.size(); start += fanIn) {
+      size_t const end = std::min(start + fanIn, m_runs.size());
+      if (end - start == 1) {
+        merged.emplace_back(m_runs[start]);
+        continue;
+      }
+
+      std::vector<std::string> const group(m_runs.begin()+start, \
+          m_runs.begin()+end);
+      std::string const name = newRunName();
+      merged.emplace_back(name);
+
+      RunWriter out(name, bufferSize);
+      auto push = [&out](entry_struct const & entry) {
+        out.push(entry);
+      };
+      mergeRuns(group, bufferSize, push);
+      out.flush();
+
+      for (std::string const & run : group) {
+        std::remove(run.c_str());
+      }
+    }
+
+    m_runs.swap(merged);
+  }
+}
+
+
+void ExternalCSRBuilder::emit(
+    dim_t const nrows,
+    dim_t const ncols,
+    IRowMatrixWriter * const writer)
+{
+  RowAssembler rows(nrows, ncols, writer);
+
+  if (m_runs.empty()) {
+    // everything fit in memory
+    sortBuffer();
+    for (buffered_struct const & buffered : m_buffer) {
+      rows.push(buffered.entry);
+    }
+    std::vector<buffered_struct>().swap(m_buffer);
+  } else {
+    if (!m_buffer.empty()) {
+      spill();
+    }
+    std::vector<buffered_struct>().swap(m_buffer);
+
+    size_t const fanIn = std::min(std::max(m_capacity / MIN_RUN_BUFFER, \
+        static_cast<size_t>(2)), MAX_FAN_IN);
+    reduceRuns(fanIn);
+
+    size_t const bufferSize = std::max(m_capacity / m_runs.size(), \
+        static_cast<size_t>(1));
+    auto push = [&rows](entry_struct const & entry) {
+      rows.push(entry);
+    };
+    mergeRuns(m_runs, bufferSize, push);
+  }
+
+  rows.finish();
+}
+
+
+
+
+}
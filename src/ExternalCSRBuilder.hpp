@@ -0,0 +1,256 @@
+/**
+* @file ExternalCSRBuilder.hpp
+* @brief Class for building CSR matrices from unordered entries out of core.
+* @author Dominique LaSalle <dominique@solidlake.com>
+* Copyright 2018
+* @version 1
+* @date 2018-05-09
+*/
+
+
+
+
+#ifndef WILDRIVER_EXTERNALCSRBUILDER_HPP
+#define WILDRIVER_EXTERNALCSRBUILDER_HPP
+
+
+
+
+#include <string>
+#include <vector>
+
+
+#include "base.h"
+#include "IRowMatrixWriter.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/**
+* @brief Build a CSR matrix from entries given in any order, using at most a
+* fixed amount of memory. Entries are buffered until the memory budget is
+* reached, at which point the buffer is sorted by (row, column) and spilled to
+* a temporary run file. Building the matrix then performs a k-way merge of the
+* runs, emitting each row in order to a row writer (e.g., a BCSRFile).
+*
+* Entries with the same row and column are kept in the order they were added.
+* All run files are removed when the builder is destroyed.
+*/
+class ExternalCSRBuilder
+{
+  public:
+    /**
+    * @brief The default memory budget in bytes.
+    */
+    static size_t const DEFAULT_MEMORY_BUDGET;
+
+
+    /**
+    * @brief Create a new builder.
+    *
+    * @param tempDir The directory to place run files in (empty to use
+    * $TMPDIR or /tmp).
+    * @param memoryBudget The maximum number of bytes to use for buffering
+    * entries (0 for the default).
+    * @param maxEntries The most entries that will be added, if known, so
+    * that no more of the budget is used than they need (0 if unknown).
+    */
+    ExternalCSRBuilder(
+        std::string const & tempDir,
+        size_t memoryBudget,
+        size_t maxEntries = 0);
+
+
+    /**
+    * @brief Destructor, removing any run files.
+    */
+    ~ExternalCSRBuilder();
+
+
+    /**
+    * @brief Add an entry to the matrix.
+    *
+    * @param row The row of the entry.
+    * @param col The column of the entry.
+    * @param val The value of the entry.
+    */
+    void add(
+        dim_t row,
+        dim_t col,
+        val_t val);
+
+
+    /**
+    * @brief Merge all added entries and write them row by row. This may only
+    * be called once.
+    *
+    * @param nrows The number of rows in the matrix.
+    * @param ncols The number of columns in the matrix.
+    * @param writer The writer to emit rows to.
+    *
+    * @throw BadParameterException If an entry lies outside of the matrix.
+    */
+    void build(
+        dim_t nrows,
+        dim_t ncols,
+        IRowMatrixWriter * writer);
+
+
+    /**
+    * @brief Get the number of entries added.
+    *
+    * @return The number of entries.
+    */
+    ind_t getNumEntries() const noexcept
+    {
+      return m_numEntries;
+    }
+
+
+    /**
+    * @brief Get the number of runs spilled to disk so far (including those
+    * created by intermediate merges).
+    *
+    * @return The number of runs.
+    */
+    size_t getNumRuns() const noexcept
+    {
+      return m_numRuns;
+    }
+
+
+    /**
+    * @brief A single entry of the matrix.
+    */
+    struct entry_struct
+    {
+      dim_t row;
+      dim_t col;
+      val_t val;
+    };
+
+
+  private:
+    /**
+    * @brief A buffered entry, with the order it was added in among the
+    * buffered entries, so that equal entries keep that order when sorted.
+    */
+    struct buffered_struct
+    {
+      entry_struct entry;
+      size_t seq;
+    };
+
+
+    /**
+    * @brief The path prefix unique to this builder for naming runs.
+    */
+    std::string m_prefix;
+
+    /**
+    * @brief The maximum number of entries to hold in memory.
+    */
+    size_t m_capacity;
+
+    /**
+    * @brief The number of entries added.
+    */
+    ind_t m_numEntries;
+
+    /**
+    * @brief The total number of runs created.
+    */
+    size_t m_numRuns;
+
+    /**
+    * @brief Whether or not build() has been called.
+    */
+    bool m_built;
+
+    /**
+    * @brief The buffered entries, which grow as entries are added but never
+    * past m_capacity, and never so that the old and new buffers together
+    * exceed it.
+    */
+    std::vector<buffered_struct> m_buffer;
+
+    /**
+    * @brief The run files waiting to be merged.
+    */
+    std::vector<std::string> m_runs;
+
+
+    /**
+    * @brief Create a name for a new run file, unique to this builder.
+    *
+    * @return The path.
+    */
+    std::string newRunName();
+
+
+    /**
+    * @brief Sort the buffered entries in place, by row, column, and then the
+    * order they were added in.
+    */
+    void sortBuffer();
+
+
+    /**
+    * @brief Make room for more entries in the buffer, growing it if the
+    * budget allows, and otherwise spilling it.
+    */
+    void grow();
+
+
+    /**
+    * @brief Sort the buffered entries and write them to a new run.
+    */
+    void spill();
+
+
+    /**
+    * @brief Merge runs until no more than the given number remain.
+    *
+    * @param fanIn The maximum number of runs to merge at once.
+    */
+    void reduceRuns(
+        size_t fanIn);
+
+
+    /**
+    * @brief Merge the current runs and emit the rows.
+    *
+    * @param nrows The number of rows.
+    * @param ncols The number of columns.
+    * @param writer The writer to emit rows to.
+    */
+    void emit(
+        dim_t nrows,
+        dim_t ncols,
+        IRowMatrixWriter * writer);
+
+
+    // disable copying
+    ExternalCSRBuilder(
+        ExternalCSRBuilder const & rhs);
+    ExternalCSRBuilder & operator=(
+        ExternalCSRBuilder const & rhs);
+
+
+
+
+};
+
+
+
+
+}
+
+
+
+
+#endif
@@ -0,0 +1,570 @@
+/**
+ * @file Generator.cpp
+ * @brief Implementation of the Generator class.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-26
+ */
+
+
+
+
+#include <algorithm>
+#include <cmath>
+
+#include "Generator.hpp"
+#include "Exception.hpp"
+#include "ThreadPool.hpp"
+#include "Tracer.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+/**
+* @brief The increment of the random streams (the golden ratio).
+*/
+uint64_t const GOLDEN_GAMMA = 0x9e3779b97f4a7c15ULL;
+
+
+/**
+* @brief The scale of a random 53-bit integer to a double in [0, 1).
+*/
+double const UNIT_SCALE = 1.0 / 9007199254740992.0;
+
+
+/**
+* @brief The lower half of a random number.
+*/
+uint64_t const HALF_MASK = 0xffffffffULL;
+
+
+/**
+* @brief How close the probabilities must be to one quarter for the matrix to
+* be drawn uniformly.
+*/
+double const UNIFORM_TOLERANCE = 1e-12;
+
+
+}
+
+
+dim_t const Generator::MAX_TILES = 1024;
+
+
+
+
+/******************************************************************************
+* HELPER FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+/**
+* @brief Scramble the bits of an integer (the splitmix64 finalizer). Unlike
+* the distributions of the standard library, this gives the same results
+* everywhere.
+*
+* @param x The integer.
+*
+* @return The scrambled integer.
+*/
+uint64_t mix(
+    uint64_t x)
+{
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+
+/**
+* @brief Get the next number of a random stream.
+*
+* @param state The state of the stream (updated).
+*
+* @return The random number.
+*/
+uint64_t nextRandom(
+    uint64_t * const state)
+{
+  *state += GOLDEN_GAMMA;
+  return mix(*state);
+}
+
+
+/**
+* @brief Get the next number of a random stream in [0, 1).
+*
+* @param state The state of the stream (updated).
+*
+* @return The random number.
+*/
+double nextUniform(
+    uint64_t * const state)
+{
+  return static_cast<double>(nextRandom(state) >> 11) * UNIT_SCALE;
+}
+
+
+/**
+* @brief Get the next number of a random stream in [0, max).
+*
+* @param state The state of the stream (updated).
+* @param max The bound of the number.
+*
+* @return The random number.
+*/
+uint64_t nextBounded(
+    uint64_t * const state,
+    uint64_t const max)
+{
+  uint64_t const x = static_cast<uint64_t>(nextUniform(state) * max);
+  return std::min(x, max-1);
+}
+
+
+/**
+* @brief Get the random value of an entry, in (0, 1].
+*
+* @param seed The seed of the matrix.
+* @param row The row of the entry.
+* @param col The column of the entry.
+*
+* @return The value.
+*/
+val_t entryValue(
+    uint64_t const seed,
+    dim_t const row,
+    dim_t const col)
+{
+  uint64_t const key = (static_cast<uint64_t>(row) << 32) | col;
+  return static_cast<val_t>(1.0 - \
+      static_cast<double>(mix(mix(key) ^ seed) >> 11) * UNIT_SCALE);
+}
+
+
+}
+
+
+
+
+/******************************************************************************
+* CONSTRUCTORS / DESTRUCTOR ***************************************************
+******************************************************************************/
+
+
+Generator::Generator(
+    dim_t const nrows,
+    dim_t const ncols,
+    uint64_t const seed) :
+  m_nrows(nrows),
+  m_ncols(ncols),
+  m_seed(seed),
+  m_nnz(0),
+  m_a(0.25),
+  m_b(0.25),
+  m_c(0.25),
+  m_bandwidth(0),
+  m_banded(false),
+  m_symmetric(false),
+  m_diagonal(true),
+  m_values(true),
+  m_scale(0),
+  m_tileScale(0),
+  m_numRowTiles(0),
+  m_numColTiles(0),
+  m_totalWeight(0)
+{
+  // do nothing
+}
+
+
+
+
+/******************************************************************************
+* PUBLIC FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+void Generator::setRMat(
+    ind_t const nnz,
+    double const a,
+    double const b,
+    double const c)
+{
+  if (a < 0 || b < 0 || c < 0 || a + b + c > 1.0) {
+    throw BadParameterException("R-MAT probabilities must be non-negative " \
+        "and sum to at most one.");
+  }
+
+  m_nnz = nnz;
+  m_a = a;
+  m_b = b;
+  m_c = c;
+  m_banded = false;
+}
+
+
+void Generator::setUniform(
+    ind_t const nnz)
+{
+  setRMat(nnz, 0.25, 0.25, 0.25);
+}
+
+
+void Generator::setBanded(
+    dim_t const bandwidth)
+{
+  m_bandwidth = bandwidth;
+  m_banded = true;
+}
+
+
+void Generator::setSymmetric(
+    bool const symmetric)
+{
+  m_symmetric = symmetric;
+}
+
+
+void Generator::setDiagonal(
+    bool const diagonal)
+{
+  m_diagonal = diagonal;
+}
+
+
+void Generator::setValues(
+    bool const values)
+{
+  m_values = values;
+}
+
+
+ind_t Generator::count()
+{
+  prepare();
+
+  // generate each block on its own, keeping only the counts
+  std::vector<ind_t> counts(m_numRowTiles, 0);
+  ThreadPool::getInstance().parallelFor(0, m_numRowTiles, 1, \
+      [this, &counts](size_t const begin, size_t const end) {
+    block_struct block;
+    for (size_t b = begin; b < end; ++b) {
+      generateBlock(static_cast<dim_t>(b), block);
+      counts[b] = block.rowind.size();
+    }
+  });
+
+  ind_t nnz = 0;
+  for (ind_t const blockCount : counts) {
+    nnz += blockCount;
+  }
+
+  return nnz;
+}
+
+
+ind_t Generator::write(
+    IRowMatrixWriter * const writer)
+{
+  ind_t const nnz = count();
+
+  writer->writeHeader(m_nrows, m_ncols, nnz);
+
+  ThreadPool & pool = ThreadPool::getInstance();
+
+  dim_t const numBlocks = m_numRowTiles;
+  dim_t const window = static_cast<dim_t>(pool.getNumThreads());
+
+  // generate the next window of blocks while writing the current one
+  std::vector<block_struct> current(window);
+  std::vector<block_struct> next(window);
+  auto const launch = [this, &next, numBlocks, window](dim_t const first, \
+      ThreadPool::TaskGroup & group) {
+    dim_t const last = std::min(first + window, numBlocks);
+    for (dim_t b = first; b < last; ++b) {
+      block_struct * const block = &next[b-first];
+      group.run([this, block, b]() {
+        generateBlock(b, *block);
+      });
+    }
+  };
+
+  {
+    ThreadPool::TaskGroup group(pool);
+    launch(0, group);
+    group.wait();
+  }
+
+  for (dim_t first = 0; first < numBlocks; first += window) {
+    std::swap(current, next);
+
+    ThreadPool::TaskGroup group(pool);
+    if (numBlocks - first > window) {
+      launch(first + window, group);
+    }
+
+    dim_t const last = std::min(first + window, numBlocks);
+    for (dim_t b = first; b < last; ++b) {
+      block_struct & block = current[b-first];
+      Tracer::Span span("writer", "write rows", b);
+      writer->setNextRows(static_cast<dim_t>(block.rowptr.size()-1), \
+          block.rowptr.data(), block.rowind.data(), \
+          m_values ? block.rowval.data() : nullptr);
+    }
+
+    group.wait();
+  }
+
+  return nnz;
+}
+
+
+
+
+/******************************************************************************
+* PRIVATE FUNCTIONS ***********************************************************
+******************************************************************************/
+
+
+void Generator::prepare()
+{
+  if (m_symmetric && m_nrows != m_ncols) {
+    throw BadParameterException("Symmetric matrices must be square: " + \
+        std::to_string(m_nrows) + "x" + std::to_string(m_ncols));
+  }
+
+  // the matrix is drawn as if it were a square of a power of two
+  dim_t const size = std::max(m_nrows, m_ncols);
+  m_scale = 0;
+  while (m_scale < 32 && (static_cast<uint64_t>(1) << m_scale) < size) {
+    ++m_scale;
+  }
+
+  m_tileScale = 0;
+  while (m_tileScale < m_scale && \
+      (static_cast<dim_t>(1) << (m_tileScale+1)) <= MAX_TILES) {
+    ++m_tileScale;
+  }
+
+  uint64_t const tileSize = static_cast<uint64_t>(1) << \
+      (m_scale - m_tileScale);
+  m_numRowTiles = static_cast<dim_t>((m_nrows + tileSize - 1) / tileSize);
+  m_numColTiles = static_cast<dim_t>((m_ncols + tileSize - 1) / tileSize);
+
+  m_totalWeight = 0;
+  if (!m_banded) {
+    for (dim_t i = 0; i < m_numRowTiles; ++i) {
+      for (dim_t j = 0; j < m_numColTiles; ++j) {
+        m_totalWeight += tileWeight(i, j);
+      }
+    }
+  }
+}
+
+
+dim_t Generator::tileStart(
+    dim_t const tile) const
+{
+  return static_cast<dim_t>(static_cast<uint64_t>(tile) << \
+      (m_scale - m_tileScale));
+}
+
+
+double Generator::tileWeight(
+    dim_t const row,
+    dim_t const col) const
+{
+  double const d = std::max(1.0 - m_a - m_b - m_c, 0.0);
+
+  double weight = 1.0;
+  for (int level = m_tileScale-1; level >= 0; --level) {
+    bool const bottom = ((row >> level) & 1) != 0;
+    bool const right = ((col >> level) & 1) != 0;
+    if (bottom) {
+      weight *= right ? d : m_c;
+    } else {
+      weight *= right ? m_b : m_a;
+    }
+  }
+
+  // tiles on the edges of the matrix are only partially within it
+  double const tileSize = std::ldexp(1.0, m_scale - m_tileScale);
+  double const rows = std::min(tileSize, \
+      static_cast<double>(m_nrows - tileStart(row)));
+  double const cols = std::min(tileSize, \
+      static_cast<double>(m_ncols - tileStart(col)));
+
+  return weight * (rows / tileSize) * (cols / tileSize);
+}
+
+
+void Generator::drawTile(
+    dim_t const row,
+    dim_t const col,
+    bool const transpose,
+    std::vector<uint64_t> & entries) const
+{
+  if (m_totalWeight <= 0) {
+    return;
+  }
+
+  uint64_t state = mix(m_seed ^ mix((static_cast<uint64_t>(row) << 32) | \
+      col));
+
+  // round the expected number of entries randomly, so that the total is
+  // close to the number drawn
+  double const expected = static_cast<double>(m_nnz) * \
+      tileWeight(row, col) / m_totalWeight;
+  ind_t num = static_cast<ind_t>(expected);
+  if (nextUniform(&state) < expected - static_cast<double>(num)) {
+    ++num;
+  }
+
+  int const levels = m_scale - m_tileScale;
+  uint64_t const tileSize = static_cast<uint64_t>(1) << levels;
+  uint64_t const rows = std::min(tileSize, \
+      static_cast<uint64_t>(m_nrows - tileStart(row)));
+  uint64_t const cols = std::min(tileSize, \
+      static_cast<uint64_t>(m_ncols - tileStart(col)));
+
+  bool const uniform = std::fabs(m_a - 0.25) < UNIFORM_TOLERANCE && \
+      std::fabs(m_b - 0.25) < UNIFORM_TOLERANCE && \
+      std::fabs(m_c - 0.25) < UNIFORM_TOLERANCE;
+  // each level of the descent uses half of a random number, compared
+  // against the probabilities scaled to 32 bits
+  uint64_t const a = static_cast<uint64_t>(std::ldexp(m_a, 32));
+  uint64_t const ab = static_cast<uint64_t>(std::ldexp(m_a + m_b, 32));
+  uint64_t const abc = static_cast<uint64_t>(std::ldexp(m_a + m_b + m_c, \
+      32));
+
+  for (ind_t e = 0; e < num; ++e) {
+    uint64_t r, c;
+    if (uniform) {
+      r = nextBounded(&state, rows);
+      c = nextBounded(&state, cols);
+    } else {
+      // descend the quadrants within the tile, drawing again if the entry
+      // falls outside of the matrix
+      do {
+        r = 0;
+        c = 0;
+        uint64_t bits = 0;
+        for (int level = 0; level < levels; ++level) {
+          if (level % 2 == 0) {
+            bits = nextRandom(&state);
+          }
+          uint64_t const p = bits & HALF_MASK;
+          bits >>= 32;
+          // the quadrant, in row major order
+          uint64_t const q = static_cast<uint64_t>(p >= a) + \
+              static_cast<uint64_t>(p >= ab) + static_cast<uint64_t>(p >= abc);
+          r = (r << 1) | (q >> 1);
+          c = (c << 1) | (q & 1);
+        }
+      } while (r >= rows || c >= cols);
+    }
+
+    if (transpose) {
+      entries.emplace_back((c << 32) | (tileStart(row) + r));
+    } else {
+      entries.emplace_back((r << 32) | (tileStart(col) + c));
+    }
+  }
+}
+
+
+void Generator::generateBlock(
+    dim_t const index,
+    block_struct & block) const
+{
+  Tracer::Span span("generator", "generate", index);
+
+  dim_t const start = tileStart(index);
+  dim_t const numRows = static_cast<dim_t>(std::min( \
+      static_cast<uint64_t>(1) << (m_scale - m_tileScale), \
+      static_cast<uint64_t>(m_nrows - start)));
+
+  block.rowptr.assign(1, 0);
+  block.rowind.clear();
+  block.rowval.clear();
+
+  if (m_banded) {
+    for (dim_t i = start; i < start + numRows; ++i) {
+      uint64_t const first = i > m_bandwidth ? i - m_bandwidth : 0;
+      uint64_t const last = std::min(static_cast<uint64_t>(i) + m_bandwidth \
+          + 1, static_cast<uint64_t>(m_ncols));
+      size_t const rowStart = block.rowind.size();
+      for (uint64_t j = first; j < last; ++j) {
+        if (m_diagonal || j != i) {
+          block.rowind.emplace_back(static_cast<dim_t>(j));
+        }
+      }
+      if (m_values) {
+        // diagonally dominant, like a Laplacian
+        size_t const size = block.rowind.size() - rowStart;
+        for (size_t j = rowStart; j < block.rowind.size(); ++j) {
+          block.rowval.emplace_back(block.rowind[j] == i ? \
+              static_cast<val_t>(size - 1) : static_cast<val_t>(-1));
+        }
+      }
+      block.rowptr.emplace_back(block.rowind.size());
+    }
+    return;
+  }
+
+  // gather the entries of the tiles of the block, and those mirrored into it
+  std::vector<uint64_t> entries;
+  for (dim_t j = 0; j < m_numColTiles; ++j) {
+    drawTile(index, j, false, entries);
+    if (m_symmetric) {
+      drawTile(j, index, true, entries);
+    }
+  }
+
+  std::sort(entries.begin(), entries.end());
+  entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+
+  block.rowptr.resize(numRows+1, 0);
+  block.rowind.reserve(entries.size());
+  for (uint64_t const entry : entries) {
+    dim_t const row = static_cast<dim_t>(entry >> 32);
+    dim_t const col = static_cast<dim_t>(entry);
+    if (m_diagonal || col != start + row) {
+      ++block.rowptr[row+1];
+      block.rowind.emplace_back(col);
+      if (m_values) {
+        block.rowval.emplace_back(m_symmetric ? \
+            entryValue(m_seed, std::min(start + row, col), \
+                std::max(start + row, col)) : \
+            entryValue(m_seed, start + row, col));
+      }
+    }
+  }
+  for (dim_t i = 0; i < numRows; ++i) {
+    block.rowptr[i+1] += block.rowptr[i];
+  }
+}
+
+
+
+
+}
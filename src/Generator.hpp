@@ -0,0 +1,275 @@
+/**
+ * @file Generator.hpp
+ * @brief Generators of synthetic sparse matrices and graphs.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-26
+ */
+
+
+
+
+#ifndef WILDRIVER_GENERATOR_HPP
+#define WILDRIVER_GENERATOR_HPP
+
+
+
+
+#include <cstdint>
+#include <vector>
+
+#include "base.h"
+#include "IRowMatrixWriter.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/**
+* @brief A generator of large synthetic matrices, which are streamed to a
+* writer row by row rather than held in memory. Three kinds are supported:
+*
+* - R-MAT (recursive matrix) power-law graphs, where each entry is placed by
+*   recursively choosing one of the four quadrants of the matrix with the
+*   probabilities a, b, c, and d.
+* - Uniformly random sparse matrices (R-MAT with equal probabilities).
+* - Banded matrices, where each row i has the entries [i-w, i+w], with the
+*   diagonal equal to the number of other entries in the row and the others
+*   equal to -1, like the stencil of a Laplacian.
+*
+* The matrix is split into tiles of rows and columns, each of which gets a
+* share of the entries and a random stream seeded from its position, so that
+* the output depends only on the seed and not on the number of threads.
+* Blocks of rows are generated in parallel on the library's thread pool while
+* the blocks before them are written.
+*/
+class Generator
+{
+  public:
+    /**
+    * @brief The most tiles to split each dimension of the matrix into.
+    */
+    static dim_t const MAX_TILES;
+
+
+    /**
+    * @brief Create a generator of a uniformly random matrix with no entries.
+    *
+    * @param nrows The number of rows.
+    * @param ncols The number of columns.
+    * @param seed The seed of the random streams.
+    */
+    Generator(
+        dim_t nrows,
+        dim_t ncols,
+        uint64_t seed);
+
+
+    /**
+    * @brief Generate an R-MAT matrix, with the probability of the bottom
+    * right quadrant being 1 - a - b - c. Duplicate entries are merged, so the
+    * generated matrix has fewer entries than drawn.
+    *
+    * @param nnz The number of entries to draw.
+    * @param a The probability of the top left quadrant.
+    * @param b The probability of the top right quadrant.
+    * @param c The probability of the bottom left quadrant.
+    *
+    * @throw BadParameterException If the probabilities are invalid.
+    */
+    void setRMat(
+        ind_t nnz,
+        double a,
+        double b,
+        double c);
+
+
+    /**
+    * @brief Generate a uniformly random matrix. Duplicate entries are
+    * merged, so the generated matrix has fewer entries than drawn.
+    *
+    * @param nnz The number of entries to draw.
+    */
+    void setUniform(
+        ind_t nnz);
+
+
+    /**
+    * @brief Generate a banded matrix.
+    *
+    * @param bandwidth The number of entries on each side of the diagonal.
+    */
+    void setBanded(
+        dim_t bandwidth);
+
+
+    /**
+    * @brief Set whether or not to mirror each entry across the diagonal, so
+    * that the matrix is symmetric. This requires the matrix to be square.
+    *
+    * @param symmetric True to make the matrix symmetric.
+    */
+    void setSymmetric(
+        bool symmetric);
+
+
+    /**
+    * @brief Set whether or not to keep entries on the diagonal. Graph formats
+    * should not have them.
+    *
+    * @param diagonal True to keep diagonal entries.
+    */
+    void setDiagonal(
+        bool diagonal);
+
+
+    /**
+    * @brief Set whether or not to generate values for the entries. Random
+    * matrices get values in (0, 1], which are the same for mirrored entries.
+    *
+    * @param values True to generate values.
+    */
+    void setValues(
+        bool values);
+
+
+    /**
+    * @brief Count the entries of the matrix, generating it without writing
+    * it.
+    *
+    * @return The number of entries.
+    */
+    ind_t count();
+
+
+    /**
+    * @brief Generate the matrix and write it. As the header of the writer
+    * needs the number of entries, the matrix is generated twice: once to
+    * count the entries and once to write them.
+    *
+    * @param writer The writer.
+    *
+    * @return The number of entries written.
+    */
+    ind_t write(
+        IRowMatrixWriter * writer);
+
+
+  private:
+    /**
+    * @brief The rows of a block of the matrix.
+    */
+    struct block_struct
+    {
+      block_struct() :
+        rowptr(),
+        rowind(),
+        rowval()
+      {
+        // do nothing
+      }
+
+      std::vector<ind_t> rowptr;
+      std::vector<dim_t> rowind;
+      std::vector<val_t> rowval;
+    };
+
+
+    dim_t m_nrows;
+    dim_t m_ncols;
+    uint64_t m_seed;
+    ind_t m_nnz;
+    double m_a;
+    double m_b;
+    double m_c;
+    dim_t m_bandwidth;
+    bool m_banded;
+    bool m_symmetric;
+    bool m_diagonal;
+    bool m_values;
+
+    // the layout of the tiles
+    int m_scale;
+    int m_tileScale;
+    dim_t m_numRowTiles;
+    dim_t m_numColTiles;
+    double m_totalWeight;
+
+
+    /**
+    * @brief Lay out the tiles of the matrix, and check the parameters.
+    *
+    * @throw BadParameterException If the parameters are invalid.
+    */
+    void prepare();
+
+
+    /**
+    * @brief Get the first row of a block (or column of a tile).
+    *
+    * @param tile The block or tile.
+    *
+    * @return The first row or column.
+    */
+    dim_t tileStart(
+        dim_t tile) const;
+
+
+    /**
+    * @brief Get the share of the entries a tile is expected to get, relative
+    * to m_totalWeight.
+    *
+    * @param row The row of the tile.
+    * @param col The column of the tile.
+    *
+    * @return The weight of the tile.
+    */
+    double tileWeight(
+        dim_t row,
+        dim_t col) const;
+
+
+    /**
+    * @brief Draw the entries of a tile, appending them to a list of packed
+    * (local row, column) pairs.
+    *
+    * @param row The row of the tile.
+    * @param col The column of the tile.
+    * @param transpose Whether to swap the rows and columns of the entries.
+    * @param entries The list of entries (output).
+    */
+    void drawTile(
+        dim_t row,
+        dim_t col,
+        bool transpose,
+        std::vector<uint64_t> & entries) const;
+
+
+    /**
+    * @brief Generate the rows of a block of the matrix.
+    *
+    * @param index The index of the block.
+    * @param block The generated rows (output).
+    */
+    void generateBlock(
+        dim_t index,
+        block_struct & block) const;
+
+
+
+
+};
+
+
+
+
+}
+
+
+
+
+#endif
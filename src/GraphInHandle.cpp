@@ -12,6 +12,7 @@
 
 #include "GraphInHandle.hpp"
 #include "GraphReaderFactory.hpp"
+#include "Tracer.hpp"
 
 
 
@@ -27,7 +28,10 @@ namespace WildRiver
 
 GraphInHandle::GraphInHandle(
     std::string const & name) :
-  m_reader(GraphReaderFactory::make(name))
+  m_name(name),
+  m_reader(GraphReaderFactory::make(name)),
+  m_metis(nullptr),
+  m_matrix(nullptr)
 {
   // do nothing
 }
@@ -56,6 +60,12 @@ void GraphInHandle::getInfo(
 }
 
 
+size_t GraphInHandle::getTemporaryBytes()
+{
+  return m_reader->getTemporaryBytes();
+}
+
+
 void GraphInHandle::readGraph(
     ind_t * const xadj,
     dim_t * const adjncy,
@@ -63,10 +73,99 @@ void GraphInHandle::readGraph(
     val_t * const adjwgt,
     double * progress)
 {
+  Tracer::Span span("reader", "read graph");
   m_reader->read(xadj,adjncy,vwgt,adjwgt,progress);
 }
 
 
+void GraphInHandle::readGraphRange(
+    dim_t const begin,
+    dim_t const end,
+    std::vector<ind_t> & xadj,
+    std::vector<dim_t> & adjncy,
+    std::vector<val_t> * const vwgt,
+    std::vector<val_t> * const adjwgt)
+{
+  if (MetisFile::hasExtension(m_name)) {
+    getMetis()->readRange(begin, end, xadj, adjncy, vwgt, adjwgt);
+  } else {
+    getMatrix()->readSparseRange(begin, end, xadj, adjncy, adjwgt);
+
+    if (vwgt != nullptr) {
+      // only metis files contain vertex weights
+      vwgt->assign(end-begin, 1);
+    }
+  }
+}
+
+
+std::vector<dim_t> GraphInHandle::getPartition(
+    int const numParts)
+{
+  if (MetisFile::hasExtension(m_name)) {
+    return getMetis()->getPartition(numParts);
+  } else {
+    return getMatrix()->getPartition(numParts);
+  }
+}
+
+
+void GraphInHandle::readGraphPart(
+    int const numParts,
+    int const part,
+    dim_t & begin,
+    dim_t & end,
+    std::vector<ind_t> & xadj,
+    std::vector<dim_t> & adjncy,
+    std::vector<val_t> * const vwgt,
+    std::vector<val_t> * const adjwgt)
+{
+  if (part < 0 || part >= numParts) {
+    throw BadParameterException(std::string("Invalid part ") + \
+        std::to_string(part) + std::string(" of ") + \
+        std::to_string(numParts));
+  }
+
+  std::vector<dim_t> const starts = getPartition(numParts);
+  begin = starts[part];
+  end = starts[part+1];
+
+  readGraphRange(begin, end, xadj, adjncy, vwgt, adjwgt);
+}
+
+
+
+
+/******************************************************************************
+* PRIVATE FUNCTIONS ***********************************************************
+******************************************************************************/
+
+
+MetisFile * GraphInHandle::getMetis()
+{
+  if (m_metis.get() == nullptr) {
+    m_metis.reset(new MetisFile(m_name));
+    dim_t nvtxs;
+    ind_t nedges;
+    int nvwgt;
+    bool ewgts;
+    m_metis->getInfo(nvtxs, nedges, nvwgt, ewgts);
+  }
+
+  return m_metis.get();
+}
+
+
+MatrixInHandle * GraphInHandle::getMatrix()
+{
+  if (m_matrix.get() == nullptr) {
+    m_matrix.reset(new MatrixInHandle(m_name));
+  }
+
+  return m_matrix.get();
+}
+
+
 
 
 }
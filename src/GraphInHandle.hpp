@@ -18,8 +18,11 @@
 
 #include <vector>
 #include <memory>
+#include <vector>
 
 #include "IGraphReader.hpp"
+#include "MatrixInHandle.hpp"
+#include "MetisFile.hpp"
 
 
 
@@ -67,6 +70,77 @@ class GraphInHandle
         val_t * adjwgt,
         double * progress = nullptr);
 
+
+    /**
+     * @brief Read only the vertices [begin, end) of the graph. The adjacency
+     * list pointer is local to the range (starting at zero), while the edge
+     * destinations remain global. METIS files seek directly to the first
+     * vertex via an index of line offsets, and other formats use the row
+     * range reading of MatrixInHandle.
+     *
+     * @param begin The first vertex to read.
+     * @param end One past the last vertex to read.
+     * @param xadj The local adjacency list pointer (output, length
+     * end-begin+1).
+     * @param adjncy The adjacency list (output).
+     * @param vwgt The vertex weights (output, may be null). If the file does
+     * not contain vertex weights, it will be filled with ones.
+     * @param adjwgt The edge weights (output, may be null). If the file does
+     * not contain edge weights, it will be filled with ones.
+     *
+     * @throw BadParameterException If the range is invalid.
+     */
+    void readGraphRange(
+        dim_t begin,
+        dim_t end,
+        std::vector<ind_t> & xadj,
+        std::vector<dim_t> & adjncy,
+        std::vector<val_t> * vwgt,
+        std::vector<val_t> * adjwgt);
+
+
+    /**
+     * @brief Split the vertices into contiguous parts balancing the number of
+     * edges plus vertices in each. METIS files are counted a block of lines
+     * at a time (see MetisFile::getPartition()), and other formats use
+     * MatrixInHandle::getPartition().
+     *
+     * @param numParts The number of parts.
+     *
+     * @return The first vertex of each part, followed by the number of
+     * vertices (length numParts+1).
+     */
+    std::vector<dim_t> getPartition(
+        int numParts);
+
+
+    /**
+     * @brief Read only the vertices of one part of a balanced split of the
+     * graph (see getPartition()). Each part may be loaded by a separate
+     * handle, process, or thread.
+     *
+     * @param numParts The number of parts.
+     * @param part The part to read.
+     * @param begin The first vertex of the part (output).
+     * @param end One past the last vertex of the part (output).
+     * @param xadj The local adjacency list pointer (output, length
+     * end-begin+1).
+     * @param adjncy The adjacency list (output).
+     * @param vwgt The vertex weights (output, may be null).
+     * @param adjwgt The edge weights (output, may be null).
+     *
+     * @throw BadParameterException If the part is invalid.
+     */
+    void readGraphPart(
+        int numParts,
+        int part,
+        dim_t & begin,
+        dim_t & end,
+        std::vector<ind_t> & xadj,
+        std::vector<dim_t> & adjncy,
+        std::vector<val_t> * vwgt,
+        std::vector<val_t> * adjwgt);
+
   
     /**
      * @brief Get information about the graph.
@@ -83,13 +157,60 @@ class GraphInHandle
         bool & ewgts);
 
 
+    /**
+     * @brief Get the peak amount of temporary memory readGraph() is expected
+     * to allocate beyond the arrays it fills, under the current memory
+     * budget. This may only be called after getInfo().
+     *
+     * @return The number of bytes.
+     */
+    size_t getTemporaryBytes();
+
+
   private:
+    /**
+     * @brief The filename/path of the graph.
+     */
+    std::string m_name;
+
+
     /**
      * @brief A pointer to the underlying graph reader.
      */
     std::unique_ptr<IGraphReader> m_reader;
 
 
+    /**
+     * @brief The metis file used for reading ranges of vertices (created when
+     * needed).
+     */
+    std::unique_ptr<MetisFile> m_metis;
+
+
+    /**
+     * @brief The matrix handle used for reading ranges of vertices of other
+     * formats (created when needed).
+     */
+    std::unique_ptr<MatrixInHandle> m_matrix;
+
+
+    /**
+     * @brief Get the metis file for reading ranges of vertices, reading its
+     * header the first time.
+     *
+     * @return The metis file.
+     */
+    MetisFile * getMetis();
+
+
+    /**
+     * @brief Get the matrix handle for reading ranges of vertices.
+     *
+     * @return The matrix handle.
+     */
+    MatrixInHandle * getMatrix();
+
+
     /**
      * @brief Private copy constructor declared to disable copying.
      *
@@ -68,6 +68,18 @@ void GraphMatrixReader::read(
 }
 
 
+size_t GraphMatrixReader::getTemporaryBytes()
+{
+  return m_reader->getTemporaryBytes();
+}
+
+
+IGraphReader * GraphMatrixReader::getGraphReader() noexcept
+{
+  return m_reader.get();
+}
+
+
 
 
 }
@@ -85,6 +85,23 @@ class GraphMatrixReader :
         ind_t & nnz) override;
 
 
+    /**
+     * @brief Get the peak amount of temporary memory read() is expected to
+     * allocate beyond the arrays it fills.
+     *
+     * @return The number of bytes.
+     */
+    virtual size_t getTemporaryBytes() override;
+
+
+    /**
+     * @brief Get the adapted graph reader.
+     *
+     * @return The graph reader.
+     */
+    IGraphReader * getGraphReader() noexcept;
+
+
   private:
     std::unique_ptr<IGraphReader> m_reader;
 
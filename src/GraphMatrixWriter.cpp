@@ -27,7 +27,8 @@ namespace WildRiver
 
 GraphMatrixWriter::GraphMatrixWriter(
     std::unique_ptr<IGraphWriter>& writer) :
-  m_writer(std::move(writer))
+  m_writer(std::move(writer)),
+  m_rows(dynamic_cast<IRowMatrixWriter*>(m_writer.get()))
 {
   // do nothing
 }
@@ -69,6 +70,51 @@ void GraphMatrixWriter::write(
 }
 
 
+void GraphMatrixWriter::writeHeader(
+    dim_t const nrows,
+    dim_t const ncols,
+    ind_t const nnz)
+{
+  getRows()->writeHeader(nrows, ncols, nnz);
+}
+
+
+void GraphMatrixWriter::setNextRow(
+    dim_t const numNonZeros,
+    dim_t const * const columns,
+    val_t const * const values)
+{
+  getRows()->setNextRow(numNonZeros, columns, values);
+}
+
+
+void GraphMatrixWriter::setNextRows(
+    dim_t const numRows,
+    ind_t const * const rowptr,
+    dim_t const * const columns,
+    val_t const * const values)
+{
+  getRows()->setNextRows(numRows, rowptr, columns, values);
+}
+
+
+
+
+/******************************************************************************
+* PRIVATE FUNCTIONS ***********************************************************
+******************************************************************************/
+
+
+IRowMatrixWriter * GraphMatrixWriter::getRows()
+{
+  if (m_rows == nullptr) {
+    throw BadFileStateException("The graph writer cannot write rows.");
+  }
+
+  return m_rows;
+}
+
+
 
 
 }
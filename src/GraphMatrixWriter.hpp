@@ -22,6 +22,7 @@
 
 #include "IGraphWriter.hpp"
 #include "IMatrixWriter.hpp"
+#include "IRowMatrixWriter.hpp"
 
 
 
@@ -31,7 +32,8 @@ namespace WildRiver
 
 
 class GraphMatrixWriter :
-    public IMatrixWriter
+    public IMatrixWriter,
+    public IRowMatrixWriter
 {
   public:
     /**
@@ -77,10 +79,71 @@ class GraphMatrixWriter :
         val_t const * rowval) override;
 
 
+    /**
+     * @brief Write the header of the graph, if its information has not been
+     * set.
+     *
+     * @param nrows The number of rows in the matrix.
+     * @param ncols The number of columns in the matrix.
+     * @param nnz The number of non-zeroes in the matrix.
+     */
+    virtual void writeHeader(
+        dim_t nrows,
+        dim_t ncols,
+        ind_t nnz) override;
+
+
+    /**
+     * @brief Set the next row of the matrix as the next vertex of the graph.
+     *
+     * @param numNonZeros The number of non-zeros in the row.
+     * @param columns The column IDs.
+     * @param values The values.
+     */
+    virtual void setNextRow(
+        dim_t numNonZeros,
+        dim_t const * columns,
+        val_t const * values) override;
+
+
+    /**
+     * @brief Set the next several rows of the matrix as the next vertices of
+     * the graph.
+     *
+     * @param numRows The number of rows to set.
+     * @param rowptr The row pointer of the rows (length numRows+1).
+     * @param columns The column IDs.
+     * @param values The values (may be null).
+     */
+    virtual void setNextRows(
+        dim_t numRows,
+        ind_t const * rowptr,
+        dim_t const * columns,
+        val_t const * values) override;
+
+
 
 
   private:
     std::unique_ptr<IGraphWriter> m_writer;
+    IRowMatrixWriter * m_rows;
+
+
+    /**
+     * @brief Get the adapted writer for writing rows.
+     *
+     * @return The row writer.
+     *
+     * @throw BadFileStateException If the adapted writer cannot write rows.
+     */
+    IRowMatrixWriter * getRows();
+
+
+    // disable copying
+    GraphMatrixWriter(
+        GraphMatrixWriter const & rhs);
+    GraphMatrixWriter & operator=(
+        GraphMatrixWriter const & rhs);
 
 
 
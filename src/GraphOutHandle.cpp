@@ -12,6 +12,8 @@
 
 #include "GraphOutHandle.hpp"
 #include "GraphWriterFactory.hpp"
+#include "IOStats.hpp"
+#include "Tracer.hpp"
 
 
 
@@ -28,7 +30,9 @@ namespace WildRiver
 
 GraphOutHandle::GraphOutHandle(
     std::string const & name) :
-  m_writer(GraphWriterFactory::make(name))
+  m_writer(GraphWriterFactory::make(name)),
+  m_numVertices(NULL_DIM),
+  m_numEdges(NULL_IND)
 {
   // do nothing
 }
@@ -53,7 +57,12 @@ void GraphOutHandle::writeGraph(
     val_t const * const vwgt,
     val_t const * const adjwgt)
 {
+  Tracer::Span span("writer", "write graph");
+  IOStats::setCurrentPhase(WILDRIVER_PHASE_WRITE);
   m_writer->write(xadj,adjncy,vwgt,adjwgt);
+  if (m_numVertices != NULL_DIM) {
+    IOStats::addCurrentEntries(m_numVertices, m_numEdges);
+  }
 }
 
 
@@ -63,6 +72,9 @@ void GraphOutHandle::setInfo(
     int const nvwgt,
     bool const ewgts)
 {
+  m_numVertices = nvtxs;
+  m_numEdges = nedges;
+
   m_writer->setInfo(nvtxs,nedges,nvwgt,ewgts);
 }
 
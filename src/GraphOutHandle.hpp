@@ -86,6 +86,13 @@ class GraphOutHandle
     std::unique_ptr<IGraphWriter> m_writer;
 
 
+    /**
+     * @brief The number of vertices and edges set via setInfo().
+     */
+    dim_t m_numVertices;
+    ind_t m_numEdges;
+
+
     // disable copying
     GraphOutHandle(
         GraphOutHandle const & handle);
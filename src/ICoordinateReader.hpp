@@ -0,0 +1,88 @@
+/**
+ * @file ICoordinateReader.hpp
+ * @brief Interface for streaming the entries of coordinate matrix files.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-09
+ */
+
+
+
+
+#ifndef WILDRIVER_ICOORDINATEREADER_HPP
+#define WILDRIVER_ICOORDINATEREADER_HPP
+
+
+
+
+#include <functional>
+
+#include "base.h"
+
+
+
+
+namespace WildRiver
+{
+
+
+class ICoordinateReader
+{
+  public:
+    /**
+    * @brief The function called for each entry read.
+    */
+    typedef std::function<void(dim_t row, dim_t col, val_t val)> \
+        entry_visitor;
+
+
+    /**
+     * @brief Virtual destructor.
+     */
+    virtual ~ICoordinateReader()
+    {
+      // do nothing
+    }
+
+
+    /**
+     * @brief Get the dimensions of the matrix and an upper bound on the
+     * number of entries.
+     *
+     * @param nrows The number of rows.
+     * @param ncols The number of columns.
+     * @param nnz The maximum number of entries that will be visited.
+     */
+    virtual void getInfo(
+        dim_t & nrows,
+        dim_t & ncols,
+        ind_t & nnz) = 0;
+
+
+    /**
+     * @brief Visit each entry of the matrix in file order, without storing
+     * them. Implied entries (e.g., the mirror of a symmetric entry) are
+     * visited immediately after the stored entry. Each call starts from the
+     * first entry, so that the entries may be visited more than once.
+     *
+     * @param visit The function to call for each entry.
+     * @param progress The variable to update as the matrix is read (may be
+     * null).
+     */
+    virtual void readEntries(
+        entry_visitor const & visit,
+        double * progress) = 0;
+
+
+};
+
+
+
+
+}
+
+
+
+
+#endif
@@ -79,6 +79,20 @@ class IGraphReader
         bool & ewgts) = 0;
 
 
+    /**
+     * @brief Get the peak amount of temporary memory read() is expected to
+     * allocate beyond the arrays it fills, with the strategy it will choose
+     * under the current memory budget. This may only be called after
+     * getInfo().
+     *
+     * @return The number of bytes.
+     */
+    virtual size_t getTemporaryBytes()
+    {
+      return 0;
+    }
+
+
 
 
 };
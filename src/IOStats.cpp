@@ -0,0 +1,411 @@
+/**
+ * @file IOStats.cpp
+ * @brief Implementation of the IOStats class.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-27
+ */
+
+
+
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include "IOStats.hpp"
+#include "Util.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/******************************************************************************
+* HELPER FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+/**
+ * @brief The stats installed for the operations of each thread.
+ */
+thread_local IOStats * currentStats = nullptr;
+
+
+/**
+ * @brief The stats of the last operation of each thread.
+ */
+thread_local wildriver_stats lastStats;
+
+
+/**
+ * @brief Whether or not each thread has performed an operation.
+ */
+thread_local bool hasLastStats = false;
+
+
+/**
+ * @brief The names of the timed phases.
+ */
+char const * const PHASE_NAMES[WILDRIVER_PHASE_DONE] = {
+  "open",
+  "read",
+  "build",
+  "write"
+};
+
+
+/**
+ * @brief Check whether the summaries of operations should be printed, which
+ * is when the WILDRIVER_STATS environment variable is set to anything other
+ * than "0".
+ *
+ * @return True if they should be printed.
+ */
+bool printSummaries() noexcept
+{
+  char const * const value = std::getenv("WILDRIVER_STATS");
+  return value != nullptr && value[0] != '\0' && std::strcmp(value, "0") != 0;
+}
+
+
+/**
+ * @brief Print a one line summary of an operation to stderr.
+ *
+ * @param operation The name of the operation.
+ * @param name The file read or written.
+ * @param stats The stats of the operation.
+ */
+void printSummary(
+    char const * const operation,
+    std::string const & name,
+    wildriver_stats const & stats)
+{
+  // build the line first so that concurrent operations don't interleave
+  std::ostringstream line;
+  line << "wildriver: " << operation;
+  if (!name.empty()) {
+    line << " '" << name << "'";
+  }
+  line << ": " << stats.seconds << " s (";
+  for (int phase = 0; phase < WILDRIVER_PHASE_DONE; ++phase) {
+    line << (phase > 0 ? ", " : "") << PHASE_NAMES[phase] << " " << \
+        stats.phase_seconds[phase] << " s";
+  }
+  line << "), " << stats.bytes << " bytes";
+  if (stats.seconds > 0) {
+    line << " (" << stats.bytes / stats.seconds / 1e6 << " MB/s)";
+  }
+  line << ", " << stats.lines << " lines (" << stats.comment_lines << \
+      " comments), " << stats.rows << " rows, " << stats.entries << \
+      " entries, " << stats.allocations << " allocations, " << \
+      stats.peak_temporary_bytes << " peak temporary bytes\n";
+
+  std::cerr << line.str();
+}
+
+
+}
+
+
+
+
+/******************************************************************************
+* PUBLIC STATIC FUNCTIONS *****************************************************
+******************************************************************************/
+
+
+IOStats * IOStats::getCurrent() noexcept
+{
+  return currentStats;
+}
+
+
+IOStats * IOStats::setCurrent(
+    IOStats * const stats) noexcept
+{
+  IOStats * const previous = currentStats;
+  currentStats = stats;
+  return previous;
+}
+
+
+bool IOStats::getLast(
+    wildriver_stats * const stats) noexcept
+{
+  if (!hasLastStats) {
+    return false;
+  }
+
+  *stats = lastStats;
+  return true;
+}
+
+
+void IOStats::addCurrentBytes(
+    size_t const bytes) noexcept
+{
+  if (currentStats != nullptr) {
+    currentStats->add(bytes, 0, 0, 0, 0);
+  }
+}
+
+
+void IOStats::addCurrentLines(
+    size_t const lines,
+    size_t const comments) noexcept
+{
+  if (currentStats != nullptr) {
+    currentStats->add(0, lines, comments, 0, 0);
+  }
+}
+
+
+void IOStats::addCurrentEntries(
+    size_t const rows,
+    size_t const entries) noexcept
+{
+  if (currentStats != nullptr) {
+    currentStats->add(0, 0, 0, rows, entries);
+  }
+}
+
+
+void IOStats::addCurrentAllocation(
+    size_t const bytes) noexcept
+{
+  if (currentStats != nullptr) {
+    currentStats->allocate(bytes, false);
+  }
+}
+
+
+void IOStats::setCurrentPhase(
+    int const phase) noexcept
+{
+  if (currentStats != nullptr) {
+    currentStats->setPhase(phase);
+  }
+}
+
+
+
+
+/******************************************************************************
+* CONSTRUCTORS / DESTRUCTOR ***************************************************
+******************************************************************************/
+
+
+IOStats::Scope::Scope(
+    IOStats * const stats) noexcept :
+  m_previous(setCurrent(stats))
+{
+  // do nothing
+}
+
+
+IOStats::Scope::~Scope()
+{
+  setCurrent(m_previous);
+}
+
+
+IOStats::Record::Record(
+    char const * const operation,
+    char const * const name) :
+  m_operation(operation),
+  m_name(name != nullptr ? name : ""),
+  m_stats(nullptr),
+  m_previous(nullptr)
+{
+  // an operation made up of others is recorded as a whole
+  if (currentStats == nullptr) {
+    m_stats = new IOStats;
+    m_previous = setCurrent(m_stats);
+  }
+}
+
+
+IOStats::Record::~Record()
+{
+  if (m_stats == nullptr) {
+    return;
+  }
+
+  setCurrent(m_previous);
+
+  m_stats->setPhase(WILDRIVER_PHASE_DONE);
+  lastStats = m_stats->getStats();
+  hasLastStats = true;
+  delete m_stats;
+
+  if (printSummaries()) {
+    try {
+      printSummary(m_operation, m_name, lastStats);
+    } catch (std::exception const &) {
+      // the summary is only informational
+    }
+  }
+}
+
+
+IOStats::Temporary::Temporary(
+    size_t const bytes) noexcept :
+  m_stats(currentStats),
+  m_bytes(bytes)
+{
+  if (m_stats != nullptr) {
+    m_stats->allocate(bytes, true);
+  }
+}
+
+
+IOStats::Temporary::~Temporary()
+{
+  if (m_stats != nullptr) {
+    m_stats->release(m_bytes);
+  }
+}
+
+
+IOStats::IOStats() noexcept :
+  m_start(Util::now()),
+  m_phaseStart(m_start),
+  m_phase(WILDRIVER_PHASE_OPEN),
+  m_phaseSeconds(),
+  m_bytes(0),
+  m_lines(0),
+  m_comments(0),
+  m_rows(0),
+  m_entries(0),
+  m_allocations(0),
+  m_temporaryBytes(0),
+  m_peakTemporaryBytes(0)
+{
+  // do nothing
+}
+
+
+
+
+/******************************************************************************
+* PUBLIC FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+void IOStats::Temporary::resize(
+    size_t const bytes) noexcept
+{
+  if (m_stats != nullptr) {
+    // the new array is allocated before the old one is freed
+    if (bytes > 0) {
+      m_stats->allocate(bytes, true);
+    }
+    m_stats->release(m_bytes);
+  }
+  m_bytes = bytes;
+}
+
+
+void IOStats::add(
+    size_t const bytes,
+    size_t const lines,
+    size_t const comments,
+    size_t const rows,
+    size_t const entries) noexcept
+{
+  if (bytes > 0) {
+    m_bytes.fetch_add(bytes, std::memory_order_relaxed);
+  }
+  if (lines > 0) {
+    m_lines.fetch_add(lines, std::memory_order_relaxed);
+  }
+  if (comments > 0) {
+    m_comments.fetch_add(comments, std::memory_order_relaxed);
+  }
+  if (rows > 0) {
+    m_rows.fetch_add(rows, std::memory_order_relaxed);
+  }
+  if (entries > 0) {
+    m_entries.fetch_add(entries, std::memory_order_relaxed);
+  }
+}
+
+
+void IOStats::allocate(
+    size_t const bytes,
+    bool const temporary) noexcept
+{
+  m_allocations.fetch_add(1, std::memory_order_relaxed);
+
+  if (temporary) {
+    size_t const held = m_temporaryBytes.fetch_add(bytes, \
+        std::memory_order_relaxed) + bytes;
+    size_t peak = m_peakTemporaryBytes.load(std::memory_order_relaxed);
+    while (held > peak && !m_peakTemporaryBytes.compare_exchange_weak(peak, \
+        held, std::memory_order_relaxed)) {
+      // retry with the updated peak
+    }
+  }
+}
+
+
+void IOStats::release(
+    size_t const bytes) noexcept
+{
+  m_temporaryBytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+
+void IOStats::setPhase(
+    int const phase) noexcept
+{
+  if (phase == m_phase) {
+    return;
+  }
+
+  int64_t const time = Util::now();
+  if (m_phase >= 0 && m_phase < WILDRIVER_PHASE_DONE) {
+    m_phaseSeconds[m_phase] += (time - m_phaseStart) / 1e9;
+  }
+  m_phase = phase;
+  m_phaseStart = time;
+}
+
+
+wildriver_stats IOStats::getStats() const noexcept
+{
+  wildriver_stats stats;
+
+  int64_t const time = Util::now();
+  for (int phase = 0; phase < WILDRIVER_PHASE_DONE; ++phase) {
+    stats.phase_seconds[phase] = m_phaseSeconds[phase];
+  }
+  if (m_phase >= 0 && m_phase < WILDRIVER_PHASE_DONE) {
+    stats.phase_seconds[m_phase] += (time - m_phaseStart) / 1e9;
+  }
+  stats.seconds = (time - m_start) / 1e9;
+  stats.bytes = m_bytes.load(std::memory_order_relaxed);
+  stats.lines = m_lines.load(std::memory_order_relaxed);
+  stats.comment_lines = m_comments.load(std::memory_order_relaxed);
+  stats.rows = m_rows.load(std::memory_order_relaxed);
+  stats.entries = m_entries.load(std::memory_order_relaxed);
+  stats.allocations = m_allocations.load(std::memory_order_relaxed);
+  stats.peak_temporary_bytes = \
+      m_peakTemporaryBytes.load(std::memory_order_relaxed);
+
+  return stats;
+}
+
+
+
+
+}
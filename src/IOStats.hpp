@@ -0,0 +1,345 @@
+/**
+ * @file IOStats.hpp
+ * @brief Class for collecting the timings and counts of reads and writes.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-27
+ */
+
+
+
+
+#ifndef WILDRIVER_IOSTATS_HPP
+#define WILDRIVER_IOSTATS_HPP
+
+
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "base.h"
+
+
+
+
+namespace WildRiver
+{
+
+
+/**
+ * @brief The time spent in each phase of a read or write, along with counts
+ * of the bytes, lines, comment lines, rows, and entries processed, and of
+ * the arrays allocated. Like a ProgressMonitor, the stats are installed for
+ * the calling thread with a Scope, and are reported to at the same points:
+ * the static functions of ProgressMonitor pass their reports on to the
+ * current stats as well.
+ *
+ * The functions of the C API each collect the stats of their operation with
+ * a Record, after which they can be retrieved with getLast(). If the
+ * WILDRIVER_STATS environment variable is set, a summary of each operation
+ * is also printed to stderr.
+ */
+class IOStats
+{
+  public:
+    /**
+     * @brief Installs stats as the current stats of the calling thread for
+     * the lifetime of the scope.
+     */
+    class Scope
+    {
+      public:
+        /**
+         * @brief Install stats.
+         *
+         * @param stats The stats (may be null for no stats).
+         */
+        Scope(
+            IOStats * stats) noexcept;
+
+
+        /**
+         * @brief Restore the previously installed stats.
+         */
+        ~Scope();
+
+
+      private:
+        IOStats * m_previous;
+
+        // disable copying
+        Scope(
+            Scope const & rhs);
+        Scope & operator=(
+            Scope const & rhs);
+    };
+
+
+    /**
+     * @brief Collects the stats of an operation of the calling thread. When
+     * the record is destroyed, whether or not the operation succeeded, its
+     * stats become the last stats of the thread.
+     */
+    class Record
+    {
+      public:
+        /**
+         * @brief Start collecting stats.
+         *
+         * @param operation The name of the operation (e.g., "read").
+         * @param name The file being read or written (may be null).
+         */
+        Record(
+            char const * operation,
+            char const * name);
+
+
+        /**
+         * @brief Stop collecting stats, and save them as the last stats of
+         * the thread.
+         */
+        ~Record();
+
+
+      private:
+        char const * m_operation;
+        std::string m_name;
+        IOStats * m_stats;
+        IOStats * m_previous;
+
+        // disable copying
+        Record(
+            Record const & rhs);
+        Record & operator=(
+            Record const & rhs);
+    };
+
+
+    /**
+     * @brief Accounts for a temporary array of a reader or writer while it
+     * is alive, to find the peak of temporary memory. It reports to the
+     * stats that were current when it was created.
+     */
+    class Temporary
+    {
+      public:
+        /**
+         * @brief Account for a newly allocated temporary array.
+         *
+         * @param bytes The size of the array.
+         */
+        Temporary(
+            size_t bytes) noexcept;
+
+
+        /**
+         * @brief Account for the array being released.
+         */
+        ~Temporary();
+
+
+        /**
+         * @brief Account for the array being resized.
+         *
+         * @param bytes The new size of the array (0 if it was released).
+         */
+        void resize(
+            size_t bytes) noexcept;
+
+
+      private:
+        IOStats * m_stats;
+        size_t m_bytes;
+
+        // disable copying
+        Temporary(
+            Temporary const & rhs);
+        Temporary & operator=(
+            Temporary const & rhs);
+    };
+
+
+    /**
+     * @brief Get the current stats of the calling thread.
+     *
+     * @return The stats (null if there are none).
+     */
+    static IOStats * getCurrent() noexcept;
+
+
+    /**
+     * @brief Set the current stats of the calling thread.
+     *
+     * @param stats The stats (may be null for no stats).
+     *
+     * @return The previous stats.
+     */
+    static IOStats * setCurrent(
+        IOStats * stats) noexcept;
+
+
+    /**
+     * @brief Get the stats of the last operation of the calling thread.
+     *
+     * @param stats The stats (output).
+     *
+     * @return True if the thread has performed an operation.
+     */
+    static bool getLast(
+        wildriver_stats * stats) noexcept;
+
+
+    /**
+     * @brief Add to the bytes read or written of the current stats, if there
+     * are any.
+     *
+     * @param bytes The number of bytes.
+     */
+    static void addCurrentBytes(
+        size_t bytes) noexcept;
+
+
+    /**
+     * @brief Add to the lines read or written of the current stats, if there
+     * are any.
+     *
+     * @param lines The number of lines (including comments).
+     * @param comments The number of the lines which were skipped comments.
+     */
+    static void addCurrentLines(
+        size_t lines,
+        size_t comments) noexcept;
+
+
+    /**
+     * @brief Add to the rows and entries of the current stats, if there are
+     * any.
+     *
+     * @param rows The number of rows.
+     * @param entries The number of entries.
+     */
+    static void addCurrentEntries(
+        size_t rows,
+        size_t entries) noexcept;
+
+
+    /**
+     * @brief Count an array allocated for the output of the current stats,
+     * if there are any.
+     *
+     * @param bytes The size of the array.
+     */
+    static void addCurrentAllocation(
+        size_t bytes) noexcept;
+
+
+    /**
+     * @brief Set the phase of the current stats, if there are any.
+     *
+     * @param phase The phase (a wildriver_phase_t).
+     */
+    static void setCurrentPhase(
+        int phase) noexcept;
+
+
+    /**
+     * @brief Create new stats, starting in the open phase.
+     */
+    IOStats() noexcept;
+
+
+    /**
+     * @brief Add to the counts of the stats.
+     *
+     * @param bytes The number of bytes read or written.
+     * @param lines The number of lines read or written.
+     * @param comments The number of comment lines skipped.
+     * @param rows The number of rows processed.
+     * @param entries The number of entries processed.
+     */
+    void add(
+        size_t bytes,
+        size_t lines,
+        size_t comments,
+        size_t rows,
+        size_t entries) noexcept;
+
+
+    /**
+     * @brief Count an allocated array.
+     *
+     * @param bytes The size of the array.
+     * @param temporary Whether the array is temporary, in which case
+     * release() must be called when it is freed.
+     */
+    void allocate(
+        size_t bytes,
+        bool temporary) noexcept;
+
+
+    /**
+     * @brief Account for a temporary array being freed.
+     *
+     * @param bytes The size of the array.
+     */
+    void release(
+        size_t bytes) noexcept;
+
+
+    /**
+     * @brief Set the phase, adding the time since the last change to the
+     * previous phase. This must only be called by the thread performing the
+     * operation.
+     *
+     * @param phase The phase (a wildriver_phase_t).
+     */
+    void setPhase(
+        int phase) noexcept;
+
+
+    /**
+     * @brief Get the stats, with the current phase timed up until now.
+     *
+     * @return The stats.
+     */
+    wildriver_stats getStats() const noexcept;
+
+
+  private:
+    int64_t m_start;
+    int64_t m_phaseStart;
+    int m_phase;
+    double m_phaseSeconds[WILDRIVER_PHASE_DONE];
+    std::atomic<size_t> m_bytes;
+    std::atomic<size_t> m_lines;
+    std::atomic<size_t> m_comments;
+    std::atomic<size_t> m_rows;
+    std::atomic<size_t> m_entries;
+    std::atomic<size_t> m_allocations;
+    std::atomic<size_t> m_temporaryBytes;
+    std::atomic<size_t> m_peakTemporaryBytes;
+
+    // disable copying
+    IOStats(
+        IOStats const & rhs);
+    IOStats & operator=(
+        IOStats const & rhs);
+
+
+
+
+};
+
+
+
+
+}
+
+
+
+
+#endif
@@ -64,6 +64,34 @@ class IRowMatrixReader
         val_t * values) = 0;
 
 
+    /**
+     * @brief Get the next several rows in the matrix. Readers which can parse
+     * rows without a virtual call per row should override this, as by default
+     * it calls getNextRow() for each row.
+     *
+     * @param numRows The number of rows to get.
+     * @param rowptr The row pointer of the rows (length numRows+1). The first
+     * element must be set to the offset of the first row within columns and
+     * values, and the rest are filled in.
+     * @param columns The column of each non-zero entry (indexed by rowptr).
+     * @param values The value of each non-zero entry (may be null, indexed by
+     * rowptr).
+     */
+    virtual void getNextRows(
+        dim_t const numRows,
+        ind_t * const rowptr,
+        dim_t * const columns,
+        val_t * const values)
+    {
+      for (dim_t i = 0; i < numRows; ++i) {
+        dim_t degree;
+        getNextRow(&degree, columns+rowptr[i], \
+            values ? values+rowptr[i] : nullptr);
+        rowptr[i+1] = rowptr[i]+degree;
+      }
+    }
+
+
 
 
 };
@@ -61,6 +61,30 @@ class IRowMatrixWriter
         val_t const * values) = 0;
 
 
+    /**
+     * @brief Set the next several rows in the matrix file. Writers which can
+     * format rows without a virtual call per row should override this, as by
+     * default it calls setNextRow() for each row.
+     *
+     * @param numRows The number of rows to set.
+     * @param rowptr The row pointer of the rows (length numRows+1), indexing
+     * columns and values.
+     * @param columns The column IDs.
+     * @param values The values (may be null).
+     */
+    virtual void setNextRows(
+        dim_t const numRows,
+        ind_t const * const rowptr,
+        dim_t const * const columns,
+        val_t const * const values)
+    {
+      for (dim_t i = 0; i < numRows; ++i) {
+        setNextRow(rowptr[i+1]-rowptr[i], columns+rowptr[i], \
+            values ? values+rowptr[i] : nullptr);
+      }
+    }
+
+
 
 
 };
@@ -0,0 +1,72 @@
+/**
+ * @file ITransposeMatrixReader.hpp
+ * @brief Interface for reading sparse matrices directly in CSC form.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-11
+ */
+
+
+
+
+#ifndef WILDRIVER_ITRANSPOSEMATRIXREADER_HPP
+#define WILDRIVER_ITRANSPOSEMATRIXREADER_HPP
+
+
+
+
+#include "base.h"
+
+
+
+
+namespace WildRiver
+{
+
+
+class ITransposeMatrixReader
+{
+  public:
+    /**
+     * @brief Virtual destructor.
+     */
+    virtual ~ITransposeMatrixReader()
+    {
+      // do nothing
+    }
+
+
+    /**
+     * @brief Get the matrix in CSC form (i.e., the CSR form of its
+     * transpose), without first building it in CSR form. The pointers must be
+     * pre-allocated to the sizes required by the info of the matrix.
+     *
+     * |colptr| = ncols + 1
+     * |colind| = nnz
+     * |colval| = nnz
+     *
+     * @param colptr The column pointer indicating the start of each column.
+     * @param colind The row index of each entry in each column.
+     * @param colval The column values (may be null).
+     * @param progress The variable to update as the matrix is loaded (may be
+     * null).
+     */
+    virtual void readTransposed(
+        ind_t * colptr,
+        dim_t * colind,
+        val_t * colval,
+        double * progress) = 0;
+
+
+};
+
+
+
+
+}
+
+
+
+
+#endif
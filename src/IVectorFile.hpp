@@ -10,8 +10,8 @@
 
 
 
-#ifndef WILDIRVER_IVECTORFILE_HPP
-#define WILDIRVER_IVECTORFILE_HPP
+#ifndef WILDRIVER_IVECTORFILE_HPP
+#define WILDRIVER_IVECTORFILE_HPP
 
 
 
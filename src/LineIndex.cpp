@@ -0,0 +1,336 @@
+/**
+ * @file LineIndex.cpp
+ * @brief Implementation of the LineIndex class.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-18
+ */
+
+
+
+
+#include <cstring>
+#include <istream>
+#include <memory>
+
+
+#include "LineIndex.hpp"
+#include "CancelToken.hpp"
+#include "Compression.hpp"
+#include "Exception.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+/**
+* @brief The number of bytes to scan at a time.
+*/
+size_t const SCAN_BUFFER_SIZE = 1024*1024;
+
+
+}
+
+
+size_t const LineIndex::STRIDE = 1024;
+
+
+
+
+/******************************************************************************
+* TYPES ***********************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+/**
+* @brief Scans the data lines of a file one at a time, from a given offset,
+* in large reads. Lines are found by searching for newlines, unless their
+* fields are being counted.
+*/
+class LineScanner
+{
+  public:
+    LineScanner(
+        std::streambuf * const file,
+        std::string const & commentChars,
+        bool const countFields,
+        size_t const offset,
+        size_t const fileLine) :
+      m_stream(file),
+      m_countFields(countFields),
+      m_buffer(SCAN_BUFFER_SIZE),
+      m_base(offset),
+      m_pos(0),
+      m_size(0),
+      m_fileLine(fileLine)
+    {
+      m_stream.exceptions(std::istream::badbit);
+
+      for (bool & comment : m_comment) {
+        comment = false;
+      }
+      for (char const c : commentChars) {
+        m_comment[static_cast<unsigned char>(c)] = true;
+      }
+    }
+
+    /**
+    * @brief Move past the next data line.
+    *
+    * @param offset The byte offset of the line (output).
+    * @param fileLine The number of lines (including comments) preceding it
+    * (output).
+    * @param fields The number of fields on it, if they are counted (output).
+    *
+    * @return False if the end of the file was reached.
+    */
+    bool next(
+        size_t * const offset,
+        size_t * const fileLine,
+        size_t * const fields)
+    {
+      while (m_pos < m_size || refill()) {
+        char const * const data = m_buffer.data();
+
+        // classify the line by its first character
+        bool const dataLine = !m_comment[static_cast<unsigned char>( \
+            data[m_pos])];
+        *offset = m_base + m_pos;
+        *fileLine = m_fileLine;
+        *fields = 0;
+
+        bool inField = false;
+        bool ended = false;
+        while (!ended && (m_pos < m_size || refill())) {
+          if (m_countFields && dataLine) {
+            // count the starts of fields up to the end of the line
+            while (m_pos < m_size && data[m_pos] != '\n') {
+              bool const space = data[m_pos] == ' ' || \
+                  data[m_pos] == '\t' || data[m_pos] == '\r';
+              if (!space && !inField) {
+                ++(*fields);
+              }
+              inField = !space;
+              ++m_pos;
+            }
+            if (m_pos < m_size) {
+              ++m_pos;
+              ended = true;
+            }
+          } else {
+            // jump to the end of the line
+            void const * const end = std::memchr(data + m_pos, '\n', \
+                m_size - m_pos);
+            if (end == nullptr) {
+              m_pos = m_size;
+            } else {
+              m_pos = static_cast<size_t>(static_cast<char const*>(end) - \
+                  data) + 1;
+              ended = true;
+            }
+          }
+        }
+        if (ended) {
+          ++m_fileLine;
+        }
+
+        if (dataLine) {
+          return true;
+        }
+      }
+
+      return false;
+    }
+
+  private:
+    std::istream m_stream;
+    bool const m_countFields;
+    bool m_comment[256];
+    std::vector<char> m_buffer;
+    size_t m_base;
+    size_t m_pos;
+    size_t m_size;
+    size_t m_fileLine;
+
+    bool refill()
+    {
+      if (!m_stream) {
+        return false;
+      }
+
+      m_base += m_size;
+      m_pos = 0;
+      m_stream.read(m_buffer.data(), m_buffer.size());
+      m_size = static_cast<size_t>(m_stream.gcount());
+
+      return m_size > 0;
+    }
+};
+
+
+}
+
+
+
+
+/******************************************************************************
+* PUBLIC STATIC FUNCTIONS *****************************************************
+******************************************************************************/
+
+
+void LineIndex::countFields(
+    std::string const & fname,
+    std::string const & commentChars,
+    std::vector<size_t> * const fieldCounts)
+{
+  std::unique_ptr<std::streambuf> const file(Compression::openRead(fname));
+  LineScanner scanner(file.get(), commentChars, true, 0, 0);
+
+  fieldCounts->clear();
+
+  size_t offset, fileLine, fields;
+  while (scanner.next(&offset, &fileLine, &fields)) {
+    if (fieldCounts->size() % CancelToken::CHECK_INTERVAL == 0) {
+      CancelToken::checkCurrent();
+    }
+    fieldCounts->emplace_back(fields);
+  }
+}
+
+
+
+
+/******************************************************************************
+* CONSTRUCTORS / DESTRUCTOR ***************************************************
+******************************************************************************/
+
+
+LineIndex::LineIndex(
+    std::string const & fname,
+    std::string const & commentChars,
+    bool const countFields) :
+  m_name(fname),
+  m_commentChars(commentChars),
+  m_numLines(0),
+  m_offsets(),
+  m_fileLines(),
+  m_blockFields()
+{
+  std::unique_ptr<std::streambuf> const file(Compression::openRead(fname));
+  LineScanner scanner(file.get(), commentChars, countFields, 0, 0);
+
+  size_t offset, fileLine, fields;
+  while (scanner.next(&offset, &fileLine, &fields)) {
+    if (m_numLines % CancelToken::CHECK_INTERVAL == 0) {
+      CancelToken::checkCurrent();
+    }
+    if (m_numLines % STRIDE == 0) {
+      m_offsets.emplace_back(offset);
+      m_fileLines.emplace_back(fileLine);
+      if (countFields) {
+        m_blockFields.emplace_back(0);
+      }
+    }
+    if (countFields) {
+      m_blockFields.back() += fields;
+    }
+    ++m_numLines;
+  }
+}
+
+
+LineIndex::LineIndex(
+    std::string const & fname,
+    std::string const & commentChars,
+    size_t const numLines,
+    std::vector<size_t> const & offsets,
+    std::vector<size_t> const & fileLines,
+    std::vector<size_t> const & blockFields) :
+  m_name(fname),
+  m_commentChars(commentChars),
+  m_numLines(numLines),
+  m_offsets(offsets),
+  m_fileLines(fileLines),
+  m_blockFields(blockFields)
+{
+  // do nothing
+}
+
+
+
+
+/******************************************************************************
+* PUBLIC FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+void LineIndex::countBlockFields(
+    size_t const block,
+    std::vector<size_t> * const fieldCounts) const
+{
+  if (block >= m_offsets.size()) {
+    throw BadParameterException(std::string("Block ") + \
+        std::to_string(block) + \
+        std::string(" is past the end of the file (") + \
+        std::to_string(m_offsets.size()) + std::string(" blocks)."));
+  }
+
+  std::unique_ptr<std::streambuf> const file(Compression::openRead(m_name));
+  std::streamoff const offset = static_cast<std::streamoff>(m_offsets[block]);
+  if (file->pubseekpos(offset, std::ios_base::in) != offset) {
+    throw BadFileException(std::string("Failed to seek in '") + m_name + \
+        std::string("'"));
+  }
+  LineScanner scanner(file.get(), m_commentChars, true, m_offsets[block], \
+      m_fileLines[block]);
+
+  fieldCounts->clear();
+
+  size_t lineOffset, fileLine, fields;
+  while (fieldCounts->size() < STRIDE && \
+      scanner.next(&lineOffset, &fileLine, &fields)) {
+    fieldCounts->emplace_back(fields);
+  }
+}
+
+
+void LineIndex::find(
+    size_t const line,
+    size_t * const indexedLine,
+    size_t * const offset,
+    size_t * const fileLine) const
+{
+  if (line >= m_numLines) {
+    throw BadParameterException(std::string("Line ") + \
+        std::to_string(line) + std::string(" is past the end of the file (") + \
+        std::to_string(m_numLines) + std::string(" lines)."));
+  }
+
+  size_t const idx = line / STRIDE;
+
+  *indexedLine = idx * STRIDE;
+  *offset = m_offsets[idx];
+  *fileLine = m_fileLines[idx];
+}
+
+
+
+
+}
@@ -0,0 +1,235 @@
+/**
+ * @file LineIndex.hpp
+ * @brief Class for finding the byte offsets of lines in text files.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-18
+ */
+
+
+
+
+#ifndef WILDRIVER_LINEINDEX_HPP
+#define WILDRIVER_LINEINDEX_HPP
+
+
+
+
+#include <string>
+#include <vector>
+
+
+
+
+namespace WildRiver
+{
+
+
+/**
+* @brief A sparse index of the data (i.e., non-comment) lines of a text
+* file, storing the byte offset of every STRIDE'th data line. It is built
+* with a single raw scan for newlines, without parsing any fields, and allows
+* a reader to seek to any data line by skipping at most STRIDE-1 lines.
+*
+* The index can also keep the number of fields in each block of STRIDE data
+* lines, so that the file can be split by weight while holding only one
+* count per block. The counts of the lines of a single block are found by
+* scanning that block again.
+*/
+class LineIndex
+{
+  public:
+    /**
+    * @brief The number of data lines between indexed lines.
+    */
+    static size_t const STRIDE;
+
+
+    /**
+    * @brief Count the whitespace separated fields on each data line of a
+    * file, in a single scan.
+    *
+    * @param fname The filename/path.
+    * @param commentChars The characters which mark a line as a comment when
+    * they are the first character of the line.
+    * @param fieldCounts The number of fields on each data line (output).
+    *
+    * @throw BadFileException If the file cannot be read.
+    */
+    static void countFields(
+        std::string const & fname,
+        std::string const & commentChars,
+        std::vector<size_t> * fieldCounts);
+
+
+    /**
+    * @brief Build the index of a file.
+    *
+    * @param fname The filename/path.
+    * @param commentChars The characters which mark a line as a comment when
+    * they are the first character of the line.
+    * @param countFields Whether to count the whitespace separated fields of
+    * each block of data lines (see getBlockFields()). Counting the fields
+    * makes the scan examine every byte rather than just searching for
+    * newlines.
+    *
+    * @throw BadFileException If the file cannot be read.
+    */
+    LineIndex(
+        std::string const & fname,
+        std::string const & commentChars,
+        bool countFields = false);
+
+
+    /**
+    * @brief Create the index of a file from the data lines found by a
+    * reader's own scan of it (e.g., while counting its rows), so that the
+    * file need not be scanned again.
+    *
+    * @param fname The filename/path.
+    * @param commentChars The characters which mark a line as a comment when
+    * they are the first character of the line.
+    * @param numLines The number of data lines.
+    * @param offsets The byte offset of every STRIDE'th data line, or of the
+    * comment lines directly preceding it.
+    * @param fileLines The number of lines (including comments) preceding
+    * each offset.
+    * @param blockFields The number of fields in each block of STRIDE data
+    * lines (may be empty if they were not counted).
+    */
+    LineIndex(
+        std::string const & fname,
+        std::string const & commentChars,
+        size_t numLines,
+        std::vector<size_t> const & offsets,
+        std::vector<size_t> const & fileLines,
+        std::vector<size_t> const & blockFields);
+
+
+    /**
+    * @brief Get the number of data lines in the file.
+    *
+    * @return The number of data lines.
+    */
+    size_t getNumLines() const noexcept
+    {
+      return m_numLines;
+    }
+
+
+    /**
+    * @brief Get the number of blocks of STRIDE data lines (the last of which
+    * may be shorter).
+    *
+    * @return The number of blocks.
+    */
+    size_t getNumBlocks() const noexcept
+    {
+      return m_offsets.size();
+    }
+
+
+    /**
+    * @brief Check whether the fields of each block were counted.
+    *
+    * @return True if they were.
+    */
+    bool hasBlockFields() const noexcept
+    {
+      return m_blockFields.size() == m_offsets.size();
+    }
+
+
+    /**
+    * @brief Get the number of fields in each block of STRIDE data lines. This
+    * is only available if the index was built counting fields.
+    *
+    * @return The number of fields of each block.
+    */
+    std::vector<size_t> const & getBlockFields() const noexcept
+    {
+      return m_blockFields;
+    }
+
+
+    /**
+    * @brief Count the fields on each data line of a single block, by scanning
+    * just that block of the file.
+    *
+    * @param block The block.
+    * @param fieldCounts The number of fields on each data line of the block
+    * (output).
+    *
+    * @throw BadFileException If the file cannot be read.
+    */
+    void countBlockFields(
+        size_t block,
+        std::vector<size_t> * fieldCounts) const;
+
+
+    /**
+    * @brief Find the closest indexed data line at or before the given data
+    * line.
+    *
+    * @param line The data line (0-based, counting only data lines).
+    * @param indexedLine The data line that was found (output).
+    * @param offset The byte offset of the found line, or of the comment lines
+    * directly preceding it (output).
+    * @param fileLine The number of lines (including comments) preceding the
+    * offset (output).
+    */
+    void find(
+        size_t line,
+        size_t * indexedLine,
+        size_t * offset,
+        size_t * fileLine) const;
+
+
+  private:
+    /**
+    * @brief The filename/path of the file.
+    */
+    std::string m_name;
+
+    /**
+    * @brief The characters marking comment lines.
+    */
+    std::string m_commentChars;
+
+    /**
+    * @brief The number of data lines.
+    */
+    size_t m_numLines;
+
+    /**
+    * @brief The byte offset of every STRIDE'th data line.
+    */
+    std::vector<size_t> m_offsets;
+
+    /**
+    * @brief The number of lines (including comments) preceding every
+    * STRIDE'th data line.
+    */
+    std::vector<size_t> m_fileLines;
+
+    /**
+    * @brief The number of fields in each block of STRIDE data lines (empty if
+    * they were not counted).
+    */
+    std::vector<size_t> m_blockFields;
+
+
+
+
+};
+
+
+
+
+}
+
+
+
+
+#endif
@@ -0,0 +1,157 @@
+/**
+ * @file MappedBuffer.cpp
+ * @brief Implementation of the MappedBuffer class.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-27
+ */
+
+
+
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+#include "MappedBuffer.hpp"
+#include "Exception.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/******************************************************************************
+* PUBLIC STATIC FUNCTIONS *****************************************************
+******************************************************************************/
+
+
+bool MappedBuffer::isSupported() noexcept
+{
+#ifdef __linux__
+  return true;
+#else
+  return false;
+#endif
+}
+
+
+
+
+/******************************************************************************
+* CONSTRUCTORS / DESTRUCTOR ***************************************************
+******************************************************************************/
+
+
+MappedBuffer::MappedBuffer(
+    std::string const & name) :
+  m_name(name),
+  m_data(nullptr),
+  m_size(0)
+{
+#ifdef __linux__
+  int const fd = ::open(name.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw BadFileException(std::string("Failed to open file '") + \
+        name + std::string("'"));
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    ::close(fd);
+    throw BadFileException(std::string("Failed to stat file '") + \
+        name + std::string("'"));
+  }
+  m_size = static_cast<size_t>(info.st_size);
+
+  // an empty file cannot be mapped, and has nothing to read
+  if (m_size > 0) {
+    void * const data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+      throw BadFileException(std::string("Failed to map file '") + \
+          name + std::string("'"));
+    }
+    m_data = static_cast<char*>(data);
+    madvise(m_data, m_size, MADV_SEQUENTIAL);
+  } else {
+    ::close(fd);
+  }
+#else
+  throw BadFileException(std::string("Unable to map '") + name + \
+      std::string("': mapping files is not supported on this platform."));
+#endif
+
+  setg(m_data, m_data, m_data + m_size);
+}
+
+
+MappedBuffer::~MappedBuffer()
+{
+#ifdef __linux__
+  if (m_data != nullptr) {
+    munmap(m_data, m_size);
+  }
+#endif
+}
+
+
+
+
+/******************************************************************************
+* PROTECTED FUNCTIONS *********************************************************
+******************************************************************************/
+
+
+MappedBuffer::int_type MappedBuffer::underflow()
+{
+  if (gptr() < egptr()) {
+    return traits_type::to_int_type(*gptr());
+  }
+
+  return traits_type::eof();
+}
+
+
+MappedBuffer::pos_type MappedBuffer::seekoff(
+    off_type const off,
+    std::ios_base::seekdir const dir,
+    std::ios_base::openmode const which)
+{
+  off_type base = 0;
+  if (dir == std::ios_base::cur) {
+    base = static_cast<off_type>(gptr() - eback());
+  } else if (dir == std::ios_base::end) {
+    base = static_cast<off_type>(m_size);
+  }
+
+  return seekpos(pos_type(base + off), which);
+}
+
+
+MappedBuffer::pos_type MappedBuffer::seekpos(
+    pos_type const pos,
+    std::ios_base::openmode const which)
+{
+  off_type const target = static_cast<off_type>(pos);
+  if (target < 0 || static_cast<size_t>(target) > m_size || \
+      !(which & std::ios_base::in)) {
+    return pos_type(off_type(-1));
+  }
+
+  setg(m_data, m_data + target, m_data + m_size);
+
+  return pos;
+}
+
+
+
+
+}
@@ -0,0 +1,102 @@
+/**
+ * @file MappedBuffer.hpp
+ * @brief A stream buffer over a memory mapped file.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-27
+ */
+
+
+
+
+#ifndef WILDRIVER_MAPPEDBUFFER_HPP
+#define WILDRIVER_MAPPEDBUFFER_HPP
+
+
+
+
+#include <streambuf>
+#include <string>
+
+
+
+
+namespace WildRiver
+{
+
+
+/**
+ * @brief A read only stream buffer over a file mapped into memory, which the
+ * reader parses in place, with the kernel reading ahead as the pages are
+ * touched. Seeking only moves the position in the mapping.
+ */
+class MappedBuffer : public std::streambuf
+{
+  public:
+    /**
+     * @brief Check whether files can be mapped on this platform.
+     *
+     * @return True if they can.
+     */
+    static bool isSupported() noexcept;
+
+
+    /**
+     * @brief Map a file.
+     *
+     * @param name The filename/path.
+     *
+     * @throw BadFileException If the file cannot be opened or mapped.
+     */
+    MappedBuffer(
+        std::string const & name);
+
+
+    /**
+     * @brief Unmap the file.
+     */
+    ~MappedBuffer();
+
+
+  protected:
+    int_type underflow() override;
+
+
+    pos_type seekoff(
+        off_type off,
+        std::ios_base::seekdir dir,
+        std::ios_base::openmode which) override;
+
+
+    pos_type seekpos(
+        pos_type pos,
+        std::ios_base::openmode which) override;
+
+
+  private:
+    std::string const m_name;
+    char * m_data;
+    size_t m_size;
+
+
+    // disable copying
+    MappedBuffer(
+        MappedBuffer const & rhs);
+    MappedBuffer & operator=(
+        MappedBuffer const & rhs);
+
+
+
+
+};
+
+
+
+
+}
+
+
+
+
+#endif
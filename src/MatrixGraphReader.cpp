@@ -87,6 +87,12 @@ void MatrixGraphReader::read(
 }
 
 
+size_t MatrixGraphReader::getTemporaryBytes()
+{
+  return m_reader->getTemporaryBytes();
+}
+
+
 
 
 }
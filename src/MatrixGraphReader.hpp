@@ -87,6 +87,15 @@ class MatrixGraphReader :
         double * progress) override;
 
 
+    /**
+     * @brief Get the peak amount of temporary memory read() is expected to
+     * allocate beyond the arrays it fills.
+     *
+     * @return The number of bytes.
+     */
+    size_t getTemporaryBytes() override;
+
+
 
 
   private:
@@ -10,8 +10,24 @@
 
 
 
+#include <algorithm>
+#include <vector>
+
 #include "MatrixInHandle.hpp"
 #include "MatrixReaderFactory.hpp"
+#include "CoordinateReaderFactory.hpp"
+#include "CSRFile.hpp"
+#include "BCSRFile.hpp"
+#include "GraphMatrixReader.hpp"
+#include "MetisFile.hpp"
+#include "IOStats.hpp"
+#include "MemoryBudget.hpp"
+#include "ProgressMonitor.hpp"
+#include "RowPartition.hpp"
+#include "Tracer.hpp"
+#include "TypeList.hpp"
+#include "ITransposeMatrixReader.hpp"
+#include "Transpose.hpp"
 
 
 
@@ -20,6 +36,27 @@ namespace WildRiver
 {
 
 
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+/**
+ * @brief The number of rows to hold at once when transposing a file a range
+ * of rows at a time.
+ */
+dim_t const TRANSPOSE_CHUNK_ROWS = 65536;
+
+
+}
+
+
+
+
 /******************************************************************************
 * CONSTRUCTORS / DESTRUCTOR ***************************************************
 ******************************************************************************/
@@ -27,8 +64,14 @@ namespace WildRiver
 
 MatrixInHandle::MatrixInHandle(
     std::string const & name) :
-  m_reader(MatrixReaderFactory::make(name))
-  
+  m_name(name),
+  m_reader(MatrixReaderFactory::make(name)),
+  m_metis(nullptr),
+  m_numThreads(0),
+  m_infoSet(false),
+  m_numRows(NULL_DIM),
+  m_numCols(NULL_DIM),
+  m_nnz(NULL_IND)
 {
   // do nothing
 }
@@ -52,7 +95,19 @@ void MatrixInHandle::getInfo(
     dim_t & ncols,
     ind_t & nnz)
 {
-  m_reader->getInfo(nrows,ncols,nnz);
+  ensureInfo();
+
+  nrows = m_numRows;
+  ncols = m_numCols;
+  nnz = m_nnz;
+}
+
+
+size_t MatrixInHandle::getTemporaryBytes()
+{
+  ensureInfo();
+
+  return m_reader->getTemporaryBytes();
 }
 
 
@@ -62,10 +117,526 @@ void MatrixInHandle::readSparse(
     val_t * rowval,
     double * progress)
 {
+  Tracer::Span span("reader", "read matrix");
   m_reader->read(rowptr,rowind,rowval,progress);
 }
 
 
+void MatrixInHandle::readSparseTransposed(
+    ind_t * const colptr,
+    dim_t * const colind,
+    val_t * const colval,
+    double * const progress)
+{
+  ensureInfo();
+
+  ITransposeMatrixReader * const direct = \
+      dynamic_cast<ITransposeMatrixReader*>(m_reader.get());
+  if (direct != nullptr) {
+    direct->readTransposed(colptr, colind, colval, progress);
+  } else if (dynamic_cast<CSRFile*>(m_reader.get()) != nullptr || \
+      MetisFile::hasExtension(m_name)) {
+    readRowsTransposed(colptr, colind, colval, progress);
+  } else if (CoordinateReaderFactory::isSupported(m_name)) {
+    readCoordinatesTransposed(colptr, colind, colval, progress);
+  } else {
+    MemoryBudget::check(getCopyBytes(colval != nullptr), "Transposing");
+
+    std::vector<ind_t> rowptr(m_numRows+1);
+    std::vector<dim_t> rowind(m_nnz);
+    std::vector<val_t> rowval(colval != nullptr ? m_nnz : 0);
+    IOStats::Temporary memory(sizeof(ind_t)*rowptr.size() + \
+        sizeof(dim_t)*rowind.size() + sizeof(val_t)*rowval.size());
+
+    m_reader->read(rowptr.data(), rowind.data(), \
+        colval != nullptr ? rowval.data() : nullptr, progress);
+
+    ProgressMonitor::setCurrentPhase(WILDRIVER_PHASE_BUILD);
+    Transpose::csrToCsc(m_numRows, m_numCols, rowptr.data(), rowind.data(), \
+        colval != nullptr ? rowval.data() : nullptr, colptr, colind, colval, \
+        m_numThreads);
+  }
+}
+
+
+void MatrixInHandle::readSparseBoth(
+    ind_t * const rowptr,
+    dim_t * const rowind,
+    val_t * const rowval,
+    ind_t * const colptr,
+    dim_t * const colind,
+    val_t * const colval,
+    double * const progress)
+{
+  ensureInfo();
+
+  m_reader->read(rowptr, rowind, rowval, progress);
+
+  ProgressMonitor::setCurrentPhase(WILDRIVER_PHASE_BUILD);
+  Transpose::csrToCsc(m_numRows, m_numCols, rowptr, rowind, rowval, colptr, \
+      colind, colval, m_numThreads);
+}
+
+
+template<typename I, typename D, typename V>
+void MatrixInHandle::readSparseTyped(
+    I * const rowptr,
+    D * const rowind,
+    V * const rowval,
+    double * const progress)
+{
+  ensureInfo();
+
+  TypeList::checkFits<I, D>(m_numRows, m_numCols, m_nnz);
+
+  CSRFile * const csr = dynamic_cast<CSRFile*>(m_reader.get());
+  BCSRFile * const bcsr = dynamic_cast<BCSRFile*>(m_reader.get());
+  if (csr != nullptr) {
+    csr->readTyped(rowptr, rowind, rowval, progress);
+  } else if (bcsr != nullptr) {
+    bcsr->readTyped(rowptr, rowind, rowval, progress);
+  } else if (CoordinateReaderFactory::isSupported(m_name)) {
+    readCoordinatesTyped(rowptr, rowind, rowval, progress);
+  } else {
+    MemoryBudget::check(getCopyBytes(rowval != nullptr), \
+        "Converting types");
+
+    std::vector<ind_t> nativeRowptr(m_numRows+1);
+    std::vector<dim_t> nativeRowind(m_nnz);
+    std::vector<val_t> nativeRowval(rowval != nullptr ? m_nnz : 0);
+    IOStats::Temporary memory(sizeof(ind_t)*nativeRowptr.size() + \
+        sizeof(dim_t)*nativeRowind.size() + \
+        sizeof(val_t)*nativeRowval.size());
+
+    m_reader->read(nativeRowptr.data(), nativeRowind.data(), \
+        rowval != nullptr ? nativeRowval.data() : nullptr, progress);
+
+    ind_t const nnz = nativeRowptr[m_numRows];
+    for (dim_t i = 0; i <= m_numRows; ++i) {
+      rowptr[i] = static_cast<I>(nativeRowptr[i]);
+    }
+    for (ind_t j = 0; j < nnz; ++j) {
+      rowind[j] = static_cast<D>(nativeRowind[j]);
+    }
+    if (rowval != nullptr) {
+      for (ind_t j = 0; j < nnz; ++j) {
+        rowval[j] = static_cast<V>(nativeRowval[j]);
+      }
+    }
+  }
+}
+
+
+void MatrixInHandle::readSparseRange(
+    dim_t const begin,
+    dim_t const end,
+    std::vector<ind_t> & rowptr,
+    std::vector<dim_t> & rowind,
+    std::vector<val_t> * const rowval)
+{
+  ensureInfo();
+
+  if (begin > end || end > m_numRows) {
+    throw BadParameterException(std::string("Invalid row range [") + \
+        std::to_string(begin) + std::string(", ") + std::to_string(end) + \
+        std::string(") for ") + std::to_string(m_numRows) + \
+        std::string(" rows."));
+  }
+
+  CSRFile * const csr = dynamic_cast<CSRFile*>(m_reader.get());
+  if (csr != nullptr) {
+    csr->readRange(begin, end, rowptr, rowind, rowval);
+  } else if (MetisFile::hasExtension(m_name)) {
+    getMetis()->readRange(begin, end, rowptr, rowind, nullptr, rowval);
+  } else if (CoordinateReaderFactory::isSupported(m_name)) {
+    readCoordinatesRange(begin, end, rowptr, rowind, rowval);
+  } else {
+    MemoryBudget::check(getCopyBytes(rowval != nullptr), \
+        "Reading a range of rows");
+
+    std::vector<ind_t> fullRowptr(m_numRows+1);
+    std::vector<dim_t> fullRowind(m_nnz);
+    std::vector<val_t> fullRowval(rowval != nullptr ? m_nnz : 0);
+    IOStats::Temporary memory(sizeof(ind_t)*fullRowptr.size() + \
+        sizeof(dim_t)*fullRowind.size() + sizeof(val_t)*fullRowval.size());
+
+    m_reader->read(fullRowptr.data(), fullRowind.data(), \
+        rowval != nullptr ? fullRowval.data() : nullptr, nullptr);
+
+    ind_t const start = fullRowptr[begin];
+    ind_t const stop = fullRowptr[end];
+
+    rowptr.resize(end-begin+1);
+    for (dim_t i = begin; i <= end; ++i) {
+      rowptr[i-begin] = fullRowptr[i] - start;
+    }
+    rowind.assign(fullRowind.begin()+start, fullRowind.begin()+stop);
+    if (rowval != nullptr) {
+      rowval->assign(fullRowval.begin()+start, fullRowval.begin()+stop);
+    }
+  }
+}
+
+
+void MatrixInHandle::readRowCounts(
+    std::vector<ind_t> & counts)
+{
+  ensureInfo();
+
+  CSRFile * const csr = dynamic_cast<CSRFile*>(m_reader.get());
+  if (csr != nullptr) {
+    csr->readRowCounts(counts);
+  } else if (MetisFile::hasExtension(m_name)) {
+    getMetis()->readDegrees(counts);
+  } else if (CoordinateReaderFactory::isSupported(m_name)) {
+    counts.assign(m_numRows, 0);
+    std::unique_ptr<ICoordinateReader> counter( \
+        CoordinateReaderFactory::make(m_name));
+    dim_t nrows, ncols;
+    ind_t nnz;
+    counter->getInfo(nrows, ncols, nnz);
+    counter->readEntries([&counts](dim_t const row, dim_t, val_t) {
+      ++counts[row];
+    }, nullptr);
+  } else {
+    MemoryBudget::check(getCopyBytes(false), "Counting rows");
+
+    std::vector<ind_t> rowptr(m_numRows+1);
+    std::vector<dim_t> rowind(m_nnz);
+    IOStats::Temporary memory(sizeof(ind_t)*rowptr.size() + \
+        sizeof(dim_t)*rowind.size());
+    m_reader->read(rowptr.data(), rowind.data(), nullptr, nullptr);
+
+    counts.resize(m_numRows);
+    for (dim_t i = 0; i < m_numRows; ++i) {
+      counts[i] = rowptr[i+1] - rowptr[i];
+    }
+  }
+
+  if (counts.size() != static_cast<size_t>(m_numRows)) {
+    throw BadFileException(std::string("Found ") + \
+        std::to_string(counts.size()) + std::string(" rows but expected ") + \
+        std::to_string(m_numRows));
+  }
+}
+
+
+std::vector<dim_t> MatrixInHandle::getPartition(
+    int const numParts)
+{
+  ensureInfo();
+
+  // text formats with an index only count the rows near the boundaries
+  CSRFile * const csr = dynamic_cast<CSRFile*>(m_reader.get());
+  if (csr != nullptr) {
+    return csr->getPartition(numParts);
+  } else if (MetisFile::hasExtension(m_name)) {
+    return getMetis()->getPartition(numParts);
+  }
+
+  std::vector<ind_t> counts;
+  readRowCounts(counts);
+
+  return RowPartition::balance(counts, numParts);
+}
+
+
+void MatrixInHandle::readSparsePart(
+    int const numParts,
+    int const part,
+    dim_t & begin,
+    dim_t & end,
+    std::vector<ind_t> & rowptr,
+    std::vector<dim_t> & rowind,
+    std::vector<val_t> * const rowval)
+{
+  if (part < 0 || part >= numParts) {
+    throw BadParameterException(std::string("Invalid part ") + \
+        std::to_string(part) + std::string(" of ") + \
+        std::to_string(numParts));
+  }
+
+  std::vector<dim_t> const starts = getPartition(numParts);
+  begin = starts[part];
+  end = starts[part+1];
+
+  readSparseRange(begin, end, rowptr, rowind, rowval);
+}
+
+
+void MatrixInHandle::setNumThreads(
+    int const numThreads)
+{
+  m_numThreads = numThreads;
+}
+
+
+
+
+/******************************************************************************
+* PRIVATE FUNCTIONS ***********************************************************
+******************************************************************************/
+
+
+void MatrixInHandle::ensureInfo()
+{
+  if (!m_infoSet) {
+    m_reader->getInfo(m_numRows, m_numCols, m_nnz);
+    m_infoSet = true;
+  }
+}
+
+
+size_t MatrixInHandle::getCopyBytes(
+    bool const values)
+{
+  size_t const copyBytes = sizeof(ind_t)*(m_numRows+1) + \
+      sizeof(dim_t)*m_nnz + (values ? sizeof(val_t)*m_nnz : 0);
+
+  // the reader's own temporary memory is held at the same time
+  return copyBytes + m_reader->getTemporaryBytes();
+}
+
+
+ICoordinateReader * MatrixInHandle::getCoordinateReader()
+{
+  ICoordinateReader * coordinates = \
+      dynamic_cast<ICoordinateReader*>(m_reader.get());
+
+  // graphs are read through an adapter
+  GraphMatrixReader * const graph = \
+      dynamic_cast<GraphMatrixReader*>(m_reader.get());
+  if (coordinates == nullptr && graph != nullptr) {
+    coordinates = dynamic_cast<ICoordinateReader*>(graph->getGraphReader());
+  }
+
+  if (coordinates == nullptr) {
+    throw BadFileException(std::string("Not a coordinate file: ") + m_name);
+  }
+
+  return coordinates;
+}
+
+
+MetisFile * MatrixInHandle::getMetis()
+{
+  if (m_metis.get() == nullptr) {
+    m_metis.reset(new MetisFile(m_name));
+    dim_t nvtxs;
+    ind_t nedges;
+    int nvwgt;
+    bool ewgts;
+    m_metis->getInfo(nvtxs, nedges, nvwgt, ewgts);
+  }
+
+  return m_metis.get();
+}
+
+
+template<typename I, typename D, typename V>
+void MatrixInHandle::readCoordinatesTyped(
+    I * const rowptr,
+    D * const rowind,
+    V * const rowval,
+    double * const progress)
+{
+  // both passes use the handle's reader, whose header has been read
+  ICoordinateReader * const reader = getCoordinateReader();
+
+  std::fill(rowptr, rowptr+m_numRows+1, 0);
+  reader->readEntries([rowptr](dim_t const row, dim_t, val_t) {
+    ++rowptr[row+1];
+  }, nullptr);
+
+  for (dim_t i = 0; i < m_numRows; ++i) {
+    rowptr[i+1] += rowptr[i];
+  }
+
+  if (progress != nullptr) {
+    *progress = 0.5;
+  }
+
+  // use the row pointer as the insertion point, and shift it back after
+  reader->readEntries([rowptr, rowind, rowval](dim_t const row, \
+      dim_t const col, val_t const val) {
+    I const idx = rowptr[row]++;
+    rowind[idx] = static_cast<D>(col);
+    if (rowval != nullptr) {
+      rowval[idx] = static_cast<V>(val);
+    }
+  }, nullptr);
+
+  for (dim_t i = m_numRows; i > 0; --i) {
+    rowptr[i] = rowptr[i-1];
+  }
+  rowptr[0] = 0;
+
+  if (progress != nullptr) {
+    *progress = 1.0;
+  }
+}
+
+
+void MatrixInHandle::readRowsTransposed(
+    ind_t * const colptr,
+    dim_t * const colind,
+    val_t * const colval,
+    double * const progress)
+{
+  std::vector<ind_t> rowptr;
+  std::vector<dim_t> rowind;
+  std::vector<val_t> rowval;
+
+  // count the entries of each column
+  std::fill(colptr, colptr+m_numCols+1, 0);
+  for (dim_t begin = 0; begin < m_numRows; begin += TRANSPOSE_CHUNK_ROWS) {
+    dim_t const end = std::min(m_numRows, begin + TRANSPOSE_CHUNK_ROWS);
+    readSparseRange(begin, end, rowptr, rowind, nullptr);
+    for (dim_t const col : rowind) {
+      ++colptr[col+1];
+    }
+  }
+
+  for (dim_t i = 0; i < m_numCols; ++i) {
+    colptr[i+1] += colptr[i];
+  }
+
+  if (progress != nullptr) {
+    *progress = 0.5;
+  }
+
+  // use the column pointer as the insertion point, and shift it back after
+  for (dim_t begin = 0; begin < m_numRows; begin += TRANSPOSE_CHUNK_ROWS) {
+    dim_t const end = std::min(m_numRows, begin + TRANSPOSE_CHUNK_ROWS);
+    readSparseRange(begin, end, rowptr, rowind, \
+        colval != nullptr ? &rowval : nullptr);
+    for (dim_t i = begin; i < end; ++i) {
+      for (ind_t j = rowptr[i-begin]; j < rowptr[i-begin+1]; ++j) {
+        ind_t const idx = colptr[rowind[j]]++;
+        colind[idx] = i;
+        if (colval != nullptr) {
+          colval[idx] = rowval[j];
+        }
+      }
+    }
+  }
+
+  for (dim_t i = m_numCols; i > 0; --i) {
+    colptr[i] = colptr[i-1];
+  }
+  colptr[0] = 0;
+
+  if (progress != nullptr) {
+    *progress = 1.0;
+  }
+}
+
+
+void MatrixInHandle::readCoordinatesTransposed(
+    ind_t * const colptr,
+    dim_t * const colind,
+    val_t * const colval,
+    double * const progress)
+{
+  // both passes use the handle's reader, whose header has been read
+  ICoordinateReader * const reader = getCoordinateReader();
+
+  std::fill(colptr, colptr+m_numCols+1, 0);
+  reader->readEntries([colptr](dim_t, dim_t const col, val_t) {
+    ++colptr[col+1];
+  }, nullptr);
+
+  for (dim_t i = 0; i < m_numCols; ++i) {
+    colptr[i+1] += colptr[i];
+  }
+
+  if (progress != nullptr) {
+    *progress = 0.5;
+  }
+
+  // use the column pointer as the insertion point, and shift it back after
+  reader->readEntries([colptr, colind, colval](dim_t const row, \
+      dim_t const col, val_t const val) {
+    ind_t const idx = colptr[col]++;
+    colind[idx] = row;
+    if (colval != nullptr) {
+      colval[idx] = val;
+    }
+  }, nullptr);
+
+  for (dim_t i = m_numCols; i > 0; --i) {
+    colptr[i] = colptr[i-1];
+  }
+  colptr[0] = 0;
+
+  if (progress != nullptr) {
+    *progress = 1.0;
+  }
+}
+
+
+void MatrixInHandle::readCoordinatesRange(
+    dim_t const begin,
+    dim_t const end,
+    std::vector<ind_t> & rowptr,
+    std::vector<dim_t> & rowind,
+    std::vector<val_t> * const rowval)
+{
+  // both passes use the handle's reader, whose header has been read
+  ICoordinateReader * const reader = getCoordinateReader();
+
+  // count the entries of each row within the range
+  rowptr.assign(end-begin+1, 0);
+  reader->readEntries([&rowptr, begin, end](dim_t const row, dim_t, \
+      val_t) {
+    if (row >= begin && row < end) {
+      ++rowptr[row-begin+1];
+    }
+  }, nullptr);
+
+  dim_t const nlocal = end - begin;
+  for (dim_t i = 0; i < nlocal; ++i) {
+    rowptr[i+1] += rowptr[i];
+  }
+
+  rowind.resize(rowptr[nlocal]);
+  if (rowval != nullptr) {
+    rowval->resize(rowptr[nlocal]);
+  }
+
+  // use the row pointer as the insertion point, and shift it back after
+  reader->readEntries([&rowptr, &rowind, rowval, begin, end]( \
+      dim_t const row, dim_t const col, val_t const val) {
+    if (row >= begin && row < end) {
+      ind_t const idx = rowptr[row-begin]++;
+      rowind[idx] = col;
+      if (rowval != nullptr) {
+        (*rowval)[idx] = val;
+      }
+    }
+  }, nullptr);
+
+  for (dim_t i = nlocal; i > 0; --i) {
+    rowptr[i] = rowptr[i-1];
+  }
+  rowptr[0] = 0;
+}
+
+
+
+
+/******************************************************************************
+* EXPLICIT INSTANTIATIONS *****************************************************
+******************************************************************************/
+
+
+#define WILDRIVER_INSTANTIATE_IN(I, D, V) \
+  template void MatrixInHandle::readSparseTyped<I, D, V>(I*, D*, V*, \
+      double*);
+WILDRIVER_FOR_EACH_TYPE(WILDRIVER_INSTANTIATE_IN)
+#undef WILDRIVER_INSTANTIATE_IN
+
+
 
 
 }
@@ -17,8 +17,11 @@
 
 
 #include <memory>
+#include <vector>
 
+#include "ICoordinateReader.hpp"
 #include "IMatrixReader.hpp"
+#include "MetisFile.hpp"
 
 
 
@@ -58,6 +61,16 @@ class MatrixInHandle
         ind_t & nnz);
 
 
+    /**
+     * @brief Get the peak amount of temporary memory readSparse() is expected
+     * to allocate beyond the arrays it fills, under the current memory
+     * budget.
+     *
+     * @return The number of bytes.
+     */
+    size_t getTemporaryBytes();
+
+
     /**
      * @brief Get the sparse matrix in CSR form. The pointers must be
      * pre-allocated to the sizes required by the info of the matrix 
@@ -80,9 +93,318 @@ class MatrixInHandle
         double * progress = nullptr);
 
 
+    /**
+     * @brief Get the sparse matrix in CSC form. Readers which can produce it
+     * directly (e.g., MatrixMarket) do so. CSR, METIS and SNAP files are read
+     * twice, first counting the entries of each column and then placing
+     * them. Otherwise the CSR form is read into temporary storage and
+     * transposed in parallel.
+     *
+     * |colptr| = ncols + 1
+     * |colind| = nnz
+     * |colval| = nnz
+     *
+     * @param colptr The column pointer indicating the start of each column.
+     * @param colind The row index of each entry in each column.
+     * @param colval The column values (may be null).
+     * @param progress The variable to update as the matrix is loaded from 0.0
+     * to 1.0 (can be null).
+     */
+    void readSparseTransposed(
+        ind_t * colptr,
+        dim_t * colind,
+        val_t * colval,
+        double * progress = nullptr);
+
+
+    /**
+     * @brief Get the sparse matrix in both CSR and CSC form. The CSC form is
+     * built from the CSR form in parallel, without any temporary copy of the
+     * matrix.
+     *
+     * @param rowptr The row pointer indicating the start of each row.
+     * @param rowind The column index of each entry in each row.
+     * @param rowval The row values (may be null).
+     * @param colptr The column pointer indicating the start of each column.
+     * @param colind The row index of each entry in each column.
+     * @param colval The column values (may be null).
+     * @param progress The variable to update as the matrix is loaded from 0.0
+     * to 1.0 (can be null).
+     */
+    void readSparseBoth(
+        ind_t * rowptr,
+        dim_t * rowind,
+        val_t * rowval,
+        ind_t * colptr,
+        dim_t * colind,
+        val_t * colval,
+        double * progress = nullptr);
+
+
+    /**
+     * @brief Get the sparse matrix in CSR form using the given index,
+     * dimension, and value types. Readers which can parse directly into the
+     * given types do so, otherwise the matrix is read in the native types and
+     * converted.
+     *
+     * @tparam I The index type.
+     * @tparam D The dimension type.
+     * @tparam V The value type.
+     * @param rowptr The row pointer indicating the start of each row.
+     * @param rowind The column index of each entry in each row.
+     * @param rowval The row values (may be null).
+     * @param progress The variable to update as the matrix is loaded from 0.0
+     * to 1.0 (can be null).
+     *
+     * @throw BadParameterException If the matrix is too large for the types.
+     */
+    template<typename I, typename D, typename V>
+    void readSparseTyped(
+        I * rowptr,
+        D * rowind,
+        V * rowval,
+        double * progress = nullptr);
+
+
+    /**
+     * @brief Get only the rows [begin, end) of the sparse matrix in CSR form.
+     * The row pointer is local to the range (starting at zero), while the
+     * column indices remain global. CSR and METIS files seek directly to the
+     * first row via an index of line offsets, coordinate files (e.g.,
+     * MatrixMarket and SNAP) are streamed and filtered by row, and all other
+     * formats are read in full and sliced.
+     *
+     * @param begin The first row to read.
+     * @param end One past the last row to read.
+     * @param rowptr The local row pointer (output, length end-begin+1).
+     * @param rowind The column index of each entry (output).
+     * @param rowval The value of each entry (output, may be null).
+     *
+     * @throw BadParameterException If the range is invalid.
+     */
+    void readSparseRange(
+        dim_t begin,
+        dim_t end,
+        std::vector<ind_t> & rowptr,
+        std::vector<dim_t> & rowind,
+        std::vector<val_t> * rowval);
+
+
+    /**
+     * @brief Count the entries of each row. CSR and METIS files are scanned
+     * for fields without parsing them, coordinate files are streamed, and
+     * all other formats are read in full.
+     *
+     * @param counts The number of entries in each row (output).
+     */
+    void readRowCounts(
+        std::vector<ind_t> & counts);
+
+
+    /**
+     * @brief Split the rows into contiguous parts balancing the number of
+     * entries plus rows in each. CSR and METIS files are counted a block of
+     * rows at a time (see CSRFile::getPartition()), and other formats use
+     * readRowCounts().
+     *
+     * @param numParts The number of parts.
+     *
+     * @return The first row of each part, followed by the number of rows
+     * (length numParts+1).
+     */
+    std::vector<dim_t> getPartition(
+        int numParts);
+
+
+    /**
+     * @brief Get only the rows of one part of a balanced split of the matrix
+     * (see getPartition()). Each part may be loaded by a separate handle,
+     * process, or thread.
+     *
+     * @param numParts The number of parts.
+     * @param part The part to read.
+     * @param begin The first row of the part (output).
+     * @param end One past the last row of the part (output).
+     * @param rowptr The local row pointer (output, length end-begin+1).
+     * @param rowind The column index of each entry (output).
+     * @param rowval The value of each entry (output, may be null).
+     *
+     * @throw BadParameterException If the part is invalid.
+     */
+    void readSparsePart(
+        int numParts,
+        int part,
+        dim_t & begin,
+        dim_t & end,
+        std::vector<ind_t> & rowptr,
+        std::vector<dim_t> & rowind,
+        std::vector<val_t> * rowval);
+
+
+    /**
+     * @brief Set the number of threads to use for transposing.
+     *
+     * @param numThreads The number of threads (0 for the number of threads of
+     * the library's thread pool).
+     */
+    void setNumThreads(
+        int numThreads);
+
+
   private:
+    /**
+     * @brief The filename/path of the matrix.
+     */
+    std::string m_name;
+
     std::unique_ptr<IMatrixReader> m_reader;
 
+    /**
+     * @brief The metis file used for reading ranges of rows, as the reader of
+     * a metis file is wrapped as a matrix (created when needed).
+     */
+    std::unique_ptr<MetisFile> m_metis;
+
+    /**
+     * @brief The number of threads to transpose with.
+     */
+    int m_numThreads;
+
+    /**
+     * @brief Whether or not the information of the matrix has been read.
+     */
+    bool m_infoSet;
+
+    /**
+     * @brief The number of rows in the matrix.
+     */
+    dim_t m_numRows;
+
+    /**
+     * @brief The number of columns in the matrix.
+     */
+    dim_t m_numCols;
+
+    /**
+     * @brief The (maximum) number of non-zeros in the matrix.
+     */
+    ind_t m_nnz;
+
+
+    /**
+     * @brief Make sure the matrix information has been read.
+     */
+    void ensureInfo();
+
+
+    /**
+     * @brief Get the peak amount of temporary memory needed to read the
+     * whole matrix into a copy, for the operations the reader cannot perform
+     * directly.
+     *
+     * @param values Whether or not the values are read.
+     *
+     * @return The number of bytes.
+     */
+    size_t getCopyBytes(
+        bool values);
+
+
+    /**
+     * @brief Read a coordinate file in the given types by making two passes
+     * over its entries: one to count the entries of each row, and one to
+     * place them. Entries keep their file order within each row.
+     *
+     * @tparam I The index type.
+     * @tparam D The dimension type.
+     * @tparam V The value type.
+     * @param rowptr The row pointer indicating the start of each row.
+     * @param rowind The column index of each entry in each row.
+     * @param rowval The row values (may be null).
+     * @param progress The variable to update as the matrix is loaded (can be
+     * null).
+     */
+    template<typename I, typename D, typename V>
+    void readCoordinatesTyped(
+        I * rowptr,
+        D * rowind,
+        V * rowval,
+        double * progress);
+
+
+    /**
+     * @brief Read the rows [begin, end) of a coordinate file by streaming its
+     * entries twice, first counting and then placing those within the range.
+     * Entries keep their file order within each row.
+     *
+     * @param begin The first row to read.
+     * @param end One past the last row to read.
+     * @param rowptr The local row pointer (output).
+     * @param rowind The column index of each entry (output).
+     * @param rowval The value of each entry (output, may be null).
+     */
+    void readCoordinatesRange(
+        dim_t begin,
+        dim_t end,
+        std::vector<ind_t> & rowptr,
+        std::vector<dim_t> & rowind,
+        std::vector<val_t> * rowval);
+
+
+    /**
+     * @brief Read the CSC form of a file with an index of its rows, in two
+     * passes over chunks of rows: the first counts the entries of each
+     * column, and the second places them. Rows are in increasing order
+     * within each column.
+     *
+     * @param colptr The column pointer indicating the start of each column.
+     * @param colind The row index of each entry in each column.
+     * @param colval The column values (may be null).
+     * @param progress The variable to update as the matrix is loaded (can be
+     * null).
+     */
+    void readRowsTransposed(
+        ind_t * colptr,
+        dim_t * colind,
+        val_t * colval,
+        double * progress);
+
+
+    /**
+     * @brief Read the CSC form of a coordinate file by streaming its entries
+     * twice, first counting the entries of each column and then placing
+     * them. Entries keep their file order within each column.
+     *
+     * @param colptr The column pointer indicating the start of each column.
+     * @param colind The row index of each entry in each column.
+     * @param colval The column values (may be null).
+     * @param progress The variable to update as the matrix is loaded (can be
+     * null).
+     */
+    void readCoordinatesTransposed(
+        ind_t * colptr,
+        dim_t * colind,
+        val_t * colval,
+        double * progress);
+
+
+    /**
+     * @brief Get the handle's reader as a coordinate reader, whose header has
+     * already been read.
+     *
+     * @return The coordinate reader.
+     */
+    ICoordinateReader * getCoordinateReader();
+
+
+    /**
+     * @brief Get the metis file for reading ranges of rows, reading its header
+     * the first time.
+     *
+     * @return The metis file.
+     */
+    MetisFile * getMetis();
+
 
     // disable copying
     MatrixInHandle(
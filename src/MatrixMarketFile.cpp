@@ -11,10 +11,17 @@
 
 
 #include "MatrixMarketFile.hpp"
+#include "CancelToken.hpp"
+#include "IOStats.hpp"
+#include "MemoryBudget.hpp"
+#include "ProgressMonitor.hpp"
+#include "ThreadPool.hpp"
+#include "Tracer.hpp"
 
 #include "Exception.hpp"
 #include "Util.hpp"
 
+#include <algorithm>
 #include <map>
 #include <cassert>
 
@@ -131,10 +138,10 @@ void parseTriplet(
     D * const col,
     V * const val)
 {
+  // the const_cast is safe, as strtoull() and strtod() only set the end
+  // pointer and never write through it
   char * sptr;
-  std::vector<char> stringBuffer(line->c_str(), line->c_str() + \
-      line->length()+1);
-  char * eptr = stringBuffer.data();
+  char * eptr = const_cast<char*>(line->c_str());
   sptr = eptr;
   *row = static_cast<D>(std::strtoull(sptr, &eptr, 10));
   if (eptr == sptr) {
@@ -149,21 +156,19 @@ void parseTriplet(
         "column: ") + *line);
   }
 
-  V tmpVal;
-  sptr = eptr;
-  if (std::is_floating_point<V>::value) {
-    tmpVal = static_cast<V>(std::strtod(sptr, &eptr));
-  } else {
-    tmpVal = static_cast<V>(std::strtoll(sptr, &eptr, 10));
-  }
-
+  // only convert the value if it is wanted
   if (val != nullptr) {
+    sptr = eptr;
+    if (std::is_floating_point<V>::value) {
+      *val = static_cast<V>(std::strtod(sptr, &eptr));
+    } else {
+      *val = static_cast<V>(std::strtoll(sptr, &eptr, 10));
+    }
+
     if (eptr == sptr) {
       throw BadFileException(std::string("Unable to parse triplet " \
           "value: ") + *line);
     }
-
-    *val = tmpVal;
   }
 }
 
@@ -197,13 +202,167 @@ bool MatrixMarketFile::hasExtension(
 bool MatrixMarketFile::nextNoncommentLine(
     std::string & line)
 {
-  do {
-    if (!m_file.nextLine(line)) {
-      return false;
+  while (m_file.nextLine(line)) {
+    if (!isComment(line)) {
+      return true;
+    }
+    m_file.countComment();
+  }
+
+  return false;
+}
+
+
+
+
+void MatrixMarketFile::parseEntry(
+    dim_t * const rowOut,
+    dim_t * const colOut,
+    val_t * const valOut)
+{
+  // make these large enough to hold whatever value is in the file
+  int64_t row, col;
+
+  if (m_type == MATRIX_MARKET_PATTERN) {
+    parseTriplet(&m_line, &row, &col, static_cast<val_t*>(nullptr));
+    if (valOut != nullptr) {
+      *valOut = 1;
+    }
+  } else if (m_type == MATRIX_MARKET_REAL || \
+      m_type == MATRIX_MARKET_INTEGER) {
+    parseTriplet(&m_line, &row, &col, valOut);
+  } else {
+    throw BadFileException("Complex types are not supported.");
+  }
+
+  // handle 1-based rows
+  if (row <= 0) {
+    throw BadFileException(std::string("Invalid row ") + \
+        std::to_string(row) + std::string(" must be 1-based indexing."));
+  } else if (row > m_nrows) {
+    throw BadFileException(std::string("Invalid row ") + \
+        std::to_string(row) + std::string(" exceeds total rows ") + \
+        std::to_string(m_nrows) + std::string("."));
+  }
+
+  // handle 1-based columns
+  if (col <= 0) {
+    throw BadFileException(std::string("Invalid column ") + \
+        std::to_string(col) + std::string(" must be 1-based indexing."));
+  } else if (col > m_ncols) {
+    throw BadFileException(std::string("Invalid column ") + \
+        std::to_string(col) + std::string(" exceeds total columns ") + \
+        std::to_string(m_ncols) + std::string("."));
+  }
+
+  *rowOut = static_cast<dim_t>(row-1);
+  *colOut = static_cast<dim_t>(col-1);
+}
+
+
+void MatrixMarketFile::checkOrientation(
+    int * const orientation,
+    dim_t const row,
+    dim_t const col)
+{
+  if (*orientation == ORIENTATION_UNKNOWN) {
+    // if we're off diagonal, set orienation
+    if (col > row) {
+      *orientation = ORIENTATION_UPPER;
+    } else if (col < row) {
+      *orientation = ORIENTATION_LOWER;
     }
-  } while (isComment(line));
+  } else if (*orientation == ORIENTATION_LOWER && col > row) {
+    // invalid for symmetric
+    throw BadFileException(std::string("Non-zero in upper triangle: (") + \
+        std::to_string(row) + std::string(", ") + std::to_string(col) + \
+        std::string(") when lower triangle non-zeros have been found."));
+  } else if (*orientation == ORIENTATION_UPPER && col < row) {
+    // invalid for symmetric
+    throw BadFileException(std::string("Non-zero in lower triangle: (") + \
+        std::to_string(row) + std::string(", ") + std::to_string(col) + \
+        std::string(") when upper triangle non-zeros have been found."));
+  }
+}
+
 
-  return true;
+size_t MatrixMarketFile::getSortBytes(
+    bool const values) const noexcept
+{
+  // the row of each entry is held alongside the source of each entry, and
+  // then the source alongside a copy of the values
+  size_t const perEntry = std::max(sizeof(dim_t)+sizeof(ind_t), \
+      values ? sizeof(ind_t)+sizeof(val_t) : 0);
+
+  return perEntry*m_nnz;
+}
+
+
+void MatrixMarketFile::rewindEntries()
+{
+  m_file.resetStream();
+
+  // skip the banner, any comments, and the size line
+  if (!m_file.nextLine(m_line) || !nextNoncommentLine(m_line)) {
+    throw BadFileException(std::string("Failed to find header line in '") + \
+        m_file.getFilename() + std::string("'."));
+  }
+}
+
+
+void MatrixMarketFile::visitEntries(
+    entry_visitor const & visit,
+    double * const progress,
+    bool const count)
+{
+  dim_t row, col;
+  val_t value;
+  int orientation = ORIENTATION_UNKNOWN;
+
+  ind_t const nlines = m_symmetric ? m_nnz / 2 : m_nnz;
+
+  ind_t const interval = nlines > 100 ? nlines / 100 : 1;
+  double const increment = 1.0/100.0;
+
+  ProgressMonitor::setCurrentPhase(WILDRIVER_PHASE_READ);
+  ProgressMonitor::Counter counter;
+  Tracer::Span parse("reader", "parse");
+  ind_t visited = 0;
+
+  for (ind_t line = 0; line < nlines; ++line) {
+    if (!nextNoncommentLine(m_line)) {
+      throw BadFileException(std::string("Only found ") + \
+          std::to_string(line) + std::string("/") + std::to_string(nlines) + \
+          std::string(" non-zeros."));
+    }
+
+    parseEntry(&row, &col, &value);
+    visit(row, col, value);
+    ++visited;
+
+    if (m_symmetric) {
+      checkOrientation(&orientation, row, col);
+      if (row != col) {
+        visit(col, row, value);
+        ++visited;
+      }
+    }
+
+    if (line % CancelToken::CHECK_INTERVAL == 0) {
+      CancelToken::checkCurrent();
+    }
+    if (line % interval == 0) {
+      if (count) {
+        counter.update(0, visited);
+      }
+      if (progress != nullptr) {
+        *progress += increment;
+      }
+    }
+  }
+  if (count) {
+    counter.update(0, visited);
+  }
 }
 
 
@@ -225,7 +384,9 @@ MatrixMarketFile::MatrixMarketFile(
   m_entity(MATRIX_MARKET_NULL),
   m_format(MATRIX_MARKET_NULL),
   m_type(MATRIX_MARKET_NULL),
-  m_symmetric(false)
+  m_symmetric(false),
+  m_numWrittenRows(0),
+  m_buffer()
 {
   // do nothing
 }
@@ -276,7 +437,7 @@ void MatrixMarketFile::read(
     if (m_symmetric) {
       readSymmetricCoordinates(rowptr, rowind, rowval, progress);
     } else {
-      readCoordinates(rowptr, rowind, rowval, progress);
+      readCoordinates(rowptr, rowind, rowval, progress, false);
     }
   } else if (m_format == MATRIX_MARKET_ARRAY) {
     // dense
@@ -285,6 +446,48 @@ void MatrixMarketFile::read(
 }
 
 
+void MatrixMarketFile::readTransposed(
+    ind_t * const colptr,
+    dim_t * const colind,
+    val_t * const colval,
+    double * const progress)
+{
+  if (!m_infoSet) {
+    throw UnsetInfoException("Cannot call readTransposed() before calling " \
+        "getInfo()");
+  }
+
+  if (m_format != MATRIX_MARKET_COORDINATE) {
+    throw BadFileException("Only coordinate matrices can be transposed.");
+  }
+
+  if (m_symmetric) {
+    // the transpose is the matrix itself
+    readSymmetricCoordinates(colptr, colind, colval, progress);
+  } else {
+    // bucket the triplets by column instead of row
+    readCoordinates(colptr, colind, colval, progress, true);
+  }
+}
+
+
+size_t MatrixMarketFile::getTemporaryBytes()
+{
+  if (!m_infoSet) {
+    throw UnsetInfoException("Cannot call getTemporaryBytes() before " \
+        "calling getInfo()");
+  }
+
+  if (m_format != MATRIX_MARKET_COORDINATE) {
+    return 0;
+  }
+
+  // reading twice needs no temporary memory
+  size_t const sortBytes = getSortBytes(true);
+  return MemoryBudget::fits(sortBytes) ? sortBytes : 0;
+}
+
+
 void MatrixMarketFile::setInfo(
     dim_t const nrows,
     dim_t const ncols,
@@ -354,12 +557,15 @@ void MatrixMarketFile::readHeader()
 
     if (m_format == MATRIX_MARKET_COORDINATE) {
       // read past all comments until we get to the size line
-      do {
+      while (true) {
         if (!m_file.nextLine(m_line)) {
           throw BadFileException(std::string("Failed to find header line " \
               "in '") + m_file.getFilename() + std::string("'."));
+        } else if (!isComment(m_line)) {
+          break;
         }
-      } while (isComment(m_line));
+        m_file.countComment();
+      }
 
       parseTriplet(&m_line, &m_nrows, &m_ncols, &m_nnz);
     } else {
@@ -419,11 +625,19 @@ void MatrixMarketFile::readCoordinates(
     ind_t * const rowptr,
     dim_t * const rowind,
     val_t * const rowval,
-    double * const progress)
+    double * const progress,
+    bool const transpose)
 {
-  // make these large enough to hold whatever value is in the file
-  int64_t row, col;
-  val_t value;
+  if (!MemoryBudget::fits(getSortBytes(rowval != nullptr))) {
+    readCoordinatesTwice(rowptr, rowind, rowval, progress, transpose);
+    return;
+  }
+
+  dim_t row, col;
+  val_t value = 0;
+
+  // when transposing, columns take the place of rows
+  dim_t const nptrs = transpose ? m_ncols : m_nrows;
 
   // TODO: I'd like to take advantage of cases where the triplets are in order:
   // if the triplets are in row major order, we can do it in a single pass
@@ -435,15 +649,20 @@ void MatrixMarketFile::readCoordinates(
   // the strategy is to allocate a new 'row' array, read in our coordinate
   // data, and sort it
   std::vector<dim_t> rows(m_nnz);
+  IOStats::Temporary rowsMemory(sizeof(dim_t)*m_nnz);
 
   // zero out rowptr
-  for (size_t i = 0; i < m_nrows+1; ++i) {
+  for (size_t i = 0; i < nptrs+1; ++i) {
     rowptr[i] = 0;
   }
 
   dim_t const interval = m_nnz > 100 ? m_nnz / 100 : 1;
   double const increment = 1.0/100.0;
 
+  ProgressMonitor::setCurrentPhase(WILDRIVER_PHASE_READ);
+  ProgressMonitor::Counter counter;
+  Tracer::Span parse("reader", "parse");
+
   // count non-zeros per row
   for (ind_t nnz = 0; nnz < m_nnz; ++nnz) {
     if (!nextNoncommentLine(m_line)) {
@@ -452,61 +671,47 @@ void MatrixMarketFile::readCoordinates(
           std::string(" non-zeros."));
     }
 
-    if (m_type == MATRIX_MARKET_PATTERN) {
-      parseTriplet(&m_line, &row, &col, static_cast<val_t*>(nullptr));
-      value = 1;
-    } else if (m_type == MATRIX_MARKET_REAL || \
-        m_type == MATRIX_MARKET_INTEGER) {
-      parseTriplet(&m_line, &row, &col, &value);
-    } else {
-      throw BadFileException("Complex types are not supported.");
-    }
-
-    // handle 1-based rows
-    if (row <= 0) {
-      throw BadFileException(std::string("Invalid row ") + \
-          std::to_string(row) + std::string(" must be 1-based indexing."));
-    } else if (row > m_nrows) {
-      throw BadFileException(std::string("Invalid row ") + \
-          std::to_string(row) + std::string(" exceeds total rows ") + \
-          std::to_string(m_nrows) + std::string("."));
-    } 
-    --row;
-
-    // handle 1-based columns
-    if (col <= 0) {
-      throw BadFileException(std::string("Invalid column ") + \
-          std::to_string(col) + std::string(" must be 1-based indexing."));
-    } else if (row > m_nrows) {
-      throw BadFileException(std::string("Invalid column ") + \
-          std::to_string(col) + std::string(" exceeds total columns ") + \
-          std::to_string(m_ncols) + std::string("."));
-    }
-    --col;
-
-    rows[nnz] = static_cast<dim_t>(row);
-    rowind[nnz] = static_cast<dim_t>(col);
-    rowval[nnz] = value;
+    parseEntry(&row, &col, rowval ? &value : nullptr);
+    if (transpose) {
+      std::swap(row, col);
+    }
+
+    rows[nnz] = row;
+    rowind[nnz] = col;
+    if (rowval) {
+      rowval[nnz] = value;
+    }
 
     ++rowptr[row+1];
 
-    if (progress != nullptr && nnz % interval == 0) {
-      *progress += increment;
+    if (nnz % CancelToken::CHECK_INTERVAL == 0) {
+      CancelToken::checkCurrent();
+    }
+    if (nnz % interval == 0) {
+      counter.update(0, nnz+1);
+      if (progress != nullptr) {
+        *progress += increment;
+      }
     }
   }
+  counter.update(0, m_nnz);
+
+  ProgressMonitor::setCurrentPhase(WILDRIVER_PHASE_BUILD);
+  parse.end();
+  Tracer::Span build("reader", "build");
 
   // prefix sum rows in the second row
-  for (ind_t i = 1; i < m_nrows+1; ++i) {
-    rowptr[i] += rowptr[i-1]; 
-  }
+  ThreadPool::getInstance().prefixSum(rowptr, \
+      static_cast<size_t>(nptrs)+1);
   assert(rowptr[0] == 0);
-  assert(rowptr[m_nrows] == m_nnz);
+  assert(rowptr[nptrs] == m_nnz);
 
   // at this point we have a rowptr ready for insertion, and all triplets
   // stored in memory --  
 
   // determine the source of each nz in the 'rows' variable
   std::vector<ind_t> source(m_nnz);
+  IOStats::Temporary sourceMemory(sizeof(ind_t)*m_nnz);
   for (ind_t nnz = 0; nnz < m_nnz; ++nnz) {
     ind_t const dest = rowptr[rows[nnz]]++;
     source[dest] = nnz;
@@ -523,24 +728,27 @@ void MatrixMarketFile::readCoordinates(
   }
   // throw away rows
   std::vector<dim_t>().swap(rows);
+  rowsMemory.resize(0);
 
   // copy over rowval
-  std::vector<val_t> vals(rowval, rowval+m_nnz);
-  for (ind_t nnz = 0; nnz < m_nnz; ++nnz) {
-    ind_t const src = source[nnz];
-    rowval[nnz] = vals[src];
+  if (rowval) {
+    std::vector<val_t> vals(rowval, rowval+m_nnz);
+    IOStats::Temporary valsMemory(sizeof(val_t)*m_nnz);
+    for (ind_t nnz = 0; nnz < m_nnz; ++nnz) {
+      ind_t const src = source[nnz];
+      rowval[nnz] = vals[src];
+    }
   }
 
-  // throw away vals
-  std::vector<val_t>().swap(vals);
-
   // shift
-  for (ind_t i = m_nrows; i > 0; --i) {
+  for (ind_t i = nptrs; i > 0; --i) {
     rowptr[i] = rowptr[i-1]; 
   }
   rowptr[0] = 0;
 
-  assert(rowptr[m_nrows] == m_nnz);
+  assert(rowptr[nptrs] == m_nnz);
+
+  counter.update(nptrs, m_nnz);
 }
 
 
@@ -550,9 +758,13 @@ void MatrixMarketFile::readSymmetricCoordinates(
     val_t * const rowval,
     double * const progress)
 {
-  // make these large enough to hold whatever value is in the file
-  int64_t row, col;
-  val_t value;
+  if (!MemoryBudget::fits(getSortBytes(rowval != nullptr))) {
+    readCoordinatesTwice(rowptr, rowind, rowval, progress, false);
+    return;
+  }
+
+  dim_t row, col;
+  val_t value = 0;
   int orientation = ORIENTATION_UNKNOWN;
 
   // TODO: Avoiding the excess memory is more tricky here than for the
@@ -562,6 +774,7 @@ void MatrixMarketFile::readSymmetricCoordinates(
   // the strategy is to allocate a new 'row' array, read in our coordinate
   // data, and sort it
   std::vector<dim_t> rows(m_nnz);
+  IOStats::Temporary rowsMemory(sizeof(dim_t)*m_nnz);
 
   // zero out rowptr
   for (size_t i = 0; i < m_nrows+1; ++i) {
@@ -577,6 +790,10 @@ void MatrixMarketFile::readSymmetricCoordinates(
   dim_t const interval = nlines > 100 ? nlines / 100 : 1;
   double const increment = 1.0/100.0;
 
+  ProgressMonitor::setCurrentPhase(WILDRIVER_PHASE_READ);
+  ProgressMonitor::Counter counter;
+  Tracer::Span parse("reader", "parse");
+
   for (ind_t line = 0; line < nlines; ++line) {
     if (!nextNoncommentLine(m_line)) {
       throw BadFileException(std::string("Only found ") + \
@@ -584,86 +801,51 @@ void MatrixMarketFile::readSymmetricCoordinates(
           std::string(" non-zeros."));
     }
 
-    if (m_type == MATRIX_MARKET_PATTERN) {
-      parseTriplet(&m_line, &row, &col, static_cast<val_t*>(nullptr));
-      value = 1;
-    } else if (m_type == MATRIX_MARKET_REAL || \
-        m_type == MATRIX_MARKET_INTEGER) {
-      parseTriplet(&m_line, &row, &col, &value);
-    } else {
-      throw BadFileException("Complex types are not supported.");
-    }
-
-    // handle 1-based rows
-    if (row <= 0) {
-      throw BadFileException(std::string("Invalid row ") + \
-          std::to_string(row) + std::string(" must be 1-based indexing."));
-    } else if (row > m_nrows) {
-      throw BadFileException(std::string("Invalid row ") + \
-          std::to_string(row) + std::string(" exceeds total rows ") + \
-          std::to_string(m_nrows) + std::string("."));
-    } 
-    --row;
-
-    // handle 1-based columns
-    if (col <= 0) {
-      throw BadFileException(std::string("Invalid column ") + \
-          std::to_string(col) + std::string(" must be 1-based indexing."));
-    } else if (col > m_ncols) {
-      throw BadFileException(std::string("Invalid column ") + \
-          std::to_string(col) + std::string(" exceeds total columns ") + \
-          std::to_string(m_ncols) + std::string("."));
-    }
-    --col;
-
-    // handle symmetry
-    if (orientation == ORIENTATION_UNKNOWN) {
-      // if we're off diagonal, set orienation
-      if (col > row) {
-        orientation = ORIENTATION_UPPER;
-      } else if (col < row) {
-        orientation = ORIENTATION_LOWER;
-      }
-    } else if (orientation == ORIENTATION_LOWER && col > row) {
-      // invalid for symmetric
-      throw BadFileException(std::string("Non-zero in upper triangle: (") + \
-          std::to_string(row) + std::string(", ") + std::to_string(col) + \
-          std::string(") when lower triangle non-zeros have been found."));
-    } else if (orientation == ORIENTATION_UPPER && col < row) {
-      // invalid for symmetric
-      throw BadFileException(std::string("Non-zero in lower triangle: (") + \
-          std::to_string(row) + std::string(", ") + std::to_string(col) + \
-          std::string(") when upper triangle non-zeros have been found."));
-    }
-
-    rows[nnz] = static_cast<dim_t>(row);
-    rowind[nnz] = static_cast<dim_t>(col);
-    rowval[nnz] = value;
+    parseEntry(&row, &col, rowval ? &value : nullptr);
+    checkOrientation(&orientation, row, col);
+
+    rows[nnz] = row;
+    rowind[nnz] = col;
+    if (rowval) {
+      rowval[nnz] = value;
+    }
 
     ++rowptr[row+1];
     ++nnz;
 
     // add corresponding entry (if not diagonal)
     if (row != col) {
-      rows[nnz] = static_cast<dim_t>(col);
-      rowind[nnz] = static_cast<dim_t>(row);
-      rowval[nnz] = value;
+      rows[nnz] = col;
+      rowind[nnz] = row;
+      if (rowval) {
+        rowval[nnz] = value;
+      }
 
       ++rowptr[col+1];
       ++nnz;
     }
 
-    if (progress != nullptr && line % interval == 0) {
-      *progress += increment;
+    if (line % CancelToken::CHECK_INTERVAL == 0) {
+      CancelToken::checkCurrent();
+    }
+    if (line % interval == 0) {
+      counter.update(0, nnz);
+      if (progress != nullptr) {
+        *progress += increment;
+      }
     }
   }
   // set proper nnz count
   m_nnz = nnz;
+  counter.update(0, m_nnz);
+
+  ProgressMonitor::setCurrentPhase(WILDRIVER_PHASE_BUILD);
+  parse.end();
+  Tracer::Span build("reader", "build");
 
   // prefix sum rows in the second row
-  for (ind_t i = 1; i < m_nrows+1; ++i) {
-    rowptr[i] += rowptr[i-1]; 
-  }
+  ThreadPool::getInstance().prefixSum(rowptr, \
+      static_cast<size_t>(m_nrows)+1);
   assert(rowptr[0] == 0);
   assert(rowptr[m_nrows] == m_nnz);
 
@@ -672,6 +854,7 @@ void MatrixMarketFile::readSymmetricCoordinates(
 
   // determine the source of each nz in the 'rows' variable
   std::vector<ind_t> source(m_nnz);
+  IOStats::Temporary sourceMemory(sizeof(ind_t)*m_nnz);
   for (ind_t nnz = 0; nnz < m_nnz; ++nnz) {
     ind_t const dest = rowptr[rows[nnz]]++;
     source[dest] = nnz;
@@ -688,17 +871,18 @@ void MatrixMarketFile::readSymmetricCoordinates(
   }
   // throw away rows
   std::vector<dim_t>().swap(rows);
+  rowsMemory.resize(0);
 
   // copy over rowval
-  std::vector<val_t> vals(rowval, rowval+m_nnz);
-  for (nnz = 0; nnz < m_nnz; ++nnz) {
-    ind_t const src = source[nnz];
-    rowval[nnz] = vals[src];
+  if (rowval) {
+    std::vector<val_t> vals(rowval, rowval+m_nnz);
+    IOStats::Temporary valsMemory(sizeof(val_t)*m_nnz);
+    for (nnz = 0; nnz < m_nnz; ++nnz) {
+      ind_t const src = source[nnz];
+      rowval[nnz] = vals[src];
+    }
   }
 
-  // throw away vals
-  std::vector<val_t>().swap(vals);
-
   // shift
   for (ind_t i = m_nrows; i > 0; --i) {
     rowptr[i] = rowptr[i-1]; 
@@ -706,6 +890,85 @@ void MatrixMarketFile::readSymmetricCoordinates(
   rowptr[0] = 0;
 
   assert(rowptr[m_nrows] == m_nnz);
+
+  counter.update(m_nrows, m_nnz);
+}
+
+
+void MatrixMarketFile::readCoordinatesTwice(
+    ind_t * const rowptr,
+    dim_t * const rowind,
+    val_t * const rowval,
+    double * const progress,
+    bool const transpose)
+{
+  // the transpose of a symmetric matrix is the matrix itself
+  bool const swap = transpose && !m_symmetric;
+  dim_t const nptrs = swap ? m_ncols : m_nrows;
+
+  std::fill(rowptr, rowptr+nptrs+1, 0);
+
+  // count non-zeros per row
+  visitEntries([rowptr, swap](dim_t const row, dim_t const col, val_t) {
+    ++rowptr[(swap ? col : row)+1];
+  }, nullptr, false);
+
+  if (progress != nullptr) {
+    *progress += 0.5;
+  }
+
+  ProgressMonitor::setCurrentPhase(WILDRIVER_PHASE_BUILD);
+  ThreadPool::getInstance().prefixSum(rowptr, \
+      static_cast<size_t>(nptrs)+1);
+
+  // use the row pointer as the insertion point of each entry as it is read
+  // again, and shift it back after
+  rewindEntries();
+  visitEntries([rowptr, rowind, rowval, swap](dim_t row, dim_t col, \
+      val_t const value) {
+    if (swap) {
+      std::swap(row, col);
+    }
+    ind_t const dest = rowptr[row]++;
+    rowind[dest] = col;
+    if (rowval) {
+      rowval[dest] = value;
+    }
+  }, nullptr, true);
+
+  ProgressMonitor::setCurrentPhase(WILDRIVER_PHASE_BUILD);
+  for (ind_t i = nptrs; i > 0; --i) {
+    rowptr[i] = rowptr[i-1];
+  }
+  rowptr[0] = 0;
+
+  // set proper nnz count
+  m_nnz = rowptr[nptrs];
+
+  ProgressMonitor::Counter counter;
+  counter.update(nptrs, 0);
+
+  if (progress != nullptr) {
+    *progress += 0.5;
+  }
+}
+
+
+void MatrixMarketFile::readEntries(
+    entry_visitor const & visit,
+    double * const progress)
+{
+  if (!m_infoSet) {
+    throw UnsetInfoException("Cannot call readEntries() before calling " \
+        "getInfo()");
+  }
+
+  if (m_format != MATRIX_MARKET_COORDINATE) {
+    throw BadFileException("Only coordinate matrices can be streamed.");
+  }
+
+  rewindEntries();
+  visitEntries(visit, progress, true);
 }
 
 
@@ -730,6 +993,58 @@ void MatrixMarketFile::writeCoordinates(
 }
 
 
+void MatrixMarketFile::writeHeader(
+    dim_t const nrows,
+    dim_t const ncols,
+    ind_t const nnz)
+{
+  if (!m_infoSet) {
+    setInfo(nrows, ncols, nnz);
+  }
+}
+
+
+void MatrixMarketFile::setNextRow(
+    dim_t const numNonZeros,
+    dim_t const * const columns,
+    val_t const * const values)
+{
+  ind_t const rowptr[2] = {0, numNonZeros};
+  setNextRows(1, rowptr, columns, values);
+}
+
+
+void MatrixMarketFile::setNextRows(
+    dim_t const numRows,
+    ind_t const * const rowptr,
+    dim_t const * const columns,
+    val_t const * const values)
+{
+  std::string const one(std::to_string(static_cast<val_t>(1)));
+
+  m_buffer.clear();
+  for (dim_t i = 0; i < numRows; ++i) {
+    std::string const rowStr(std::to_string(m_numWrittenRows+1) + \
+        std::string(" "));
+    for (ind_t j = rowptr[i]; j < rowptr[i+1]; ++j) {
+      m_buffer += rowStr;
+      m_buffer += std::to_string(columns[j]+1);
+      m_buffer += ' ';
+      m_buffer += values != nullptr ? std::to_string(values[j]) : one;
+      m_buffer += '\n';
+    }
+
+    ++m_numWrittenRows;
+  }
+
+  if (!m_buffer.empty()) {
+    // the file adds the final newline
+    m_buffer.pop_back();
+    m_file.setNextLine(m_buffer);
+  }
+}
+
+
 
 
 }
@@ -19,8 +19,11 @@
 #include <memory>
 
 
+#include "ICoordinateReader.hpp"
 #include "IMatrixReader.hpp"
 #include "IMatrixWriter.hpp"
+#include "IRowMatrixWriter.hpp"
+#include "ITransposeMatrixReader.hpp"
 #include "TextFile.hpp"
 
 
@@ -36,7 +39,10 @@ namespace WildRiver
 */
 class MatrixMarketFile :
     public IMatrixReader,
-    public IMatrixWriter
+    public IMatrixWriter,
+    public ICoordinateReader,
+    public ITransposeMatrixReader,
+    public IRowMatrixWriter
 {
   public:
     /**
@@ -147,15 +153,18 @@ class MatrixMarketFile :
      * @param rowptr The row pointer indicating the start of each row.
      * @param rowind The row column indexs (i.e., for each element in a row,
      * the column index corresponding to that element).
-     * @param rowval The row values.
+     * @param rowval The row values (may be null).
      * @param progress The variable to update as the matrix is loaded (may be
      * null).
+     * @param transpose Whether to build the transpose (CSC) instead, in which
+     * case rowptr must be of length ncols+1.
     */
     virtual void readCoordinates(
         ind_t * rowptr,
         dim_t * rowind,
         val_t * rowval,
-        double * progress);
+        double * progress,
+        bool transpose);
 
 
     /**
@@ -175,6 +184,50 @@ class MatrixMarketFile :
         double * progress);
 
 
+    /**
+     * @brief Get the matrix in CSC form directly from the triplets, without
+     * building the CSR form first. As with read(), the entries of each column
+     * are kept in the order they appear in the file.
+     *
+     * @param colptr The column pointer indicating the start of each column.
+     * @param colind The row index of each entry in each column.
+     * @param colval The column values (may be null).
+     * @param progress The variable to update as the matrix is loaded (may be
+     * null).
+     */
+    virtual void readTransposed(
+        ind_t * colptr,
+        dim_t * colind,
+        val_t * colval,
+        double * progress) override;
+
+
+    /**
+     * @brief Get the peak amount of temporary memory read() and
+     * readTransposed() are expected to allocate. Sorting the entries in
+     * memory needs temporary arrays as long as the entries, and if those do
+     * not fit in the memory budget the file is instead read twice, needing
+     * none.
+     *
+     * @return The number of bytes.
+     */
+    virtual size_t getTemporaryBytes() override;
+
+
+    /**
+     * @brief Visit each entry of the matrix in file order, without storing
+     * them. For symmetric matrices, the mirrored entry is visited immediately
+     * after each off-diagonal entry.
+     *
+     * @param visit The function to call for each entry.
+     * @param progress The variable to update as the matrix is read (may be
+     * null).
+     */
+    virtual void readEntries(
+        entry_visitor const & visit,
+        double * progress) override;
+
+
     /**
     * @brief Read in the matrix in array format.
     */
@@ -195,6 +248,52 @@ class MatrixMarketFile :
         val_t const * rowval);
 
 
+    /**
+     * @brief Write the header of the file, if the information for the matrix
+     * has not already been set.
+     *
+     * @param nrows The number of rows in the matrix.
+     * @param ncols The number of columns in the matrix.
+     * @param nnz The number of non-zeroes in the matrix.
+     */
+    virtual void writeHeader(
+        dim_t nrows,
+        dim_t ncols,
+        ind_t nnz) override;
+
+
+    /**
+     * @brief Set the next row in the matrix file.
+     *
+     * @param numNonZeros The number of non-zeros in the row.
+     * @param columns The column IDs.
+     * @param values The values (may be null, in which case ones are
+     * written).
+     */
+    virtual void setNextRow(
+        dim_t numNonZeros,
+        dim_t const * columns,
+        val_t const * values) override;
+
+
+    /**
+     * @brief Set the next several rows in the matrix file, formatting their
+     * coordinates into a single buffer which is written at once.
+     *
+     * @param numRows The number of rows to set.
+     * @param rowptr The row pointer of the rows (length numRows+1), indexing
+     * columns and values.
+     * @param columns The column IDs.
+     * @param values The values (may be null, in which case ones are
+     * written).
+     */
+    virtual void setNextRows(
+        dim_t numRows,
+        ind_t const * rowptr,
+        dim_t const * columns,
+        val_t const * values) override;
+
+
   private:
     /**
      * @brief Whether the info has been written/read.
@@ -247,6 +346,16 @@ class MatrixMarketFile :
      */
     bool m_symmetric;
 
+    /**
+     * @brief The number of rows set.
+     */
+    dim_t m_numWrittenRows;
+
+    /**
+     * @brief The buffer for formatting batches of rows.
+     */
+    std::string m_buffer;
+
 
     /**
     * @brief Get the next non-comment line from the file.
@@ -259,6 +368,88 @@ class MatrixMarketFile :
         std::string & line);
 
 
+    /**
+    * @brief Parse and validate the entry in the current line.
+    *
+    * @param row The 0-based row (output).
+    * @param col The 0-based column (output).
+    * @param val The value, 1 for pattern matrices (output, may be null to
+    * skip parsing the value).
+    */
+    void parseEntry(
+        dim_t * row,
+        dim_t * col,
+        val_t * val);
+
+
+    /**
+    * @brief Ensure the entries of a symmetric matrix are all in the same
+    * triangle.
+    *
+    * @param orientation The orientation found so far (updated).
+    * @param row The row of the entry.
+    * @param col The column of the entry.
+    */
+    void checkOrientation(
+        int * orientation,
+        dim_t row,
+        dim_t col);
+
+
+    /**
+    * @brief Get the peak amount of temporary memory needed to sort the
+    * entries into rows in memory.
+    *
+    * @param values Whether or not the values are read.
+    *
+    * @return The number of bytes.
+    */
+    size_t getSortBytes(
+        bool values) const noexcept;
+
+
+    /**
+    * @brief Move back to the first entry of the file.
+    */
+    void rewindEntries();
+
+
+    /**
+    * @brief Visit each entry of the matrix from the current position in the
+    * file.
+    *
+    * @param visit The function to call for each entry.
+    * @param progress The variable to update as the matrix is read (may be
+    * null).
+    * @param count Whether to count the entries read in the progress and
+    * stats of the read.
+    */
+    void visitEntries(
+        entry_visitor const & visit,
+        double * progress,
+        bool count);
+
+
+    /**
+    * @brief Read in the matrix in coordinate format without any temporary
+    * memory, by counting the entries of each row in one pass over the file
+    * and placing them in a second.
+    *
+    * @param rowptr The row pointer indicating the start of each row.
+    * @param rowind The row column indexs.
+    * @param rowval The row values (may be null).
+    * @param progress The variable to update as the matrix is loaded (may be
+    * null).
+    * @param transpose Whether to build the transpose (CSC) instead.
+    */
+    void readCoordinatesTwice(
+        ind_t * rowptr,
+        dim_t * rowind,
+        val_t * rowval,
+        double * progress,
+        bool transpose);
+
+
 
 
 };
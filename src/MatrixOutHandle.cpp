@@ -10,8 +10,15 @@
 
 
 
+#include <vector>
+
 #include "MatrixOutHandle.hpp"
 #include "MatrixWriterFactory.hpp"
+#include "IRowMatrixWriter.hpp"
+#include "Exception.hpp"
+#include "IOStats.hpp"
+#include "TypeList.hpp"
+#include "Tracer.hpp"
 
 
 
@@ -20,6 +27,27 @@ namespace WildRiver
 {
 
 
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+/**
+* @brief The number of entries to convert to the native types at a time when
+* writing a matrix of other types.
+*/
+size_t const TYPED_BATCH_ENTRIES = 65536;
+
+
+}
+
+
+
+
 /******************************************************************************
 * CONSTRUCTORS / DESTRUCTOR ***************************************************
 ******************************************************************************/
@@ -27,7 +55,9 @@ namespace WildRiver
 
 MatrixOutHandle::MatrixOutHandle(
     std::string const & name) :
-  m_writer(MatrixWriterFactory::make(name))
+  m_writer(MatrixWriterFactory::make(name)),
+  m_numRows(NULL_DIM),
+  m_nnz(NULL_IND)
 {
   // do nothing
 }
@@ -51,6 +81,9 @@ void MatrixOutHandle::setInfo(
     dim_t const ncols,
     ind_t const nnz)
 {
+  m_numRows = nrows;
+  m_nnz = nnz;
+
   m_writer->setInfo(nrows,ncols,nnz);
 }
 
@@ -60,10 +93,86 @@ void MatrixOutHandle::writeSparse(
     dim_t const * const rowind,
     val_t const * const rowval)
 {
+  Tracer::Span span("writer", "write matrix");
+  IOStats::setCurrentPhase(WILDRIVER_PHASE_WRITE);
   m_writer->write(rowptr,rowind,rowval);
+  if (m_numRows != NULL_DIM) {
+    IOStats::addCurrentEntries(m_numRows, m_nnz);
+  }
 }
 
 
+template<typename I, typename D, typename V>
+void MatrixOutHandle::writeSparseTyped(
+    I const * const rowptr,
+    D const * const rowind,
+    V const * const rowval)
+{
+  if (m_numRows == NULL_DIM) {
+    throw UnsetInfoException("Cannot call writeSparseTyped() before " \
+        "calling setInfo()");
+  }
+
+  Tracer::Span span("writer", "write matrix");
+  IOStats::setCurrentPhase(WILDRIVER_PHASE_WRITE);
+
+  IRowMatrixWriter * const rows = \
+      dynamic_cast<IRowMatrixWriter*>(m_writer.get());
+  if (rows == nullptr) {
+    throw BadFileStateException("Cannot write rows of other types to this " \
+        "file type");
+  }
+
+  // convert and pass on a batch of whole rows at a time
+  std::vector<ind_t> batchPtr;
+  std::vector<dim_t> columns;
+  std::vector<val_t> values;
+  batchPtr.reserve(TYPED_BATCH_ENTRIES+1);
+  columns.reserve(TYPED_BATCH_ENTRIES);
+  values.reserve(rowval != nullptr ? TYPED_BATCH_ENTRIES : 0);
+  IOStats::Temporary memory(sizeof(ind_t)*batchPtr.capacity() + \
+      sizeof(dim_t)*columns.capacity() + sizeof(val_t)*values.capacity());
+
+  batchPtr.emplace_back(0);
+  for (dim_t i = 0; i < m_numRows; ++i) {
+    ind_t const start = static_cast<ind_t>(rowptr[i]);
+    ind_t const end = static_cast<ind_t>(rowptr[i+1]);
+    for (ind_t j = start; j < end; ++j) {
+      columns.emplace_back(static_cast<dim_t>(rowind[j]));
+      if (rowval != nullptr) {
+        values.emplace_back(static_cast<val_t>(rowval[j]));
+      }
+    }
+    batchPtr.emplace_back(columns.size());
+
+    if (columns.size() >= TYPED_BATCH_ENTRIES || \
+        batchPtr.size() > TYPED_BATCH_ENTRIES || i+1 == m_numRows) {
+      rows->setNextRows(static_cast<dim_t>(batchPtr.size()-1), \
+          batchPtr.data(), columns.data(), \
+          rowval != nullptr ? values.data() : nullptr);
+      batchPtr.resize(1);
+      columns.clear();
+      values.clear();
+    }
+  }
+  IOStats::addCurrentEntries(m_numRows, m_nnz);
+}
+
+
+
+
+/******************************************************************************
+* EXPLICIT INSTANTIATIONS *****************************************************
+******************************************************************************/
+
+
+#define WILDRIVER_INSTANTIATE_OUT(I, D, V) \
+  template void MatrixOutHandle::writeSparseTyped<I, D, V>(I const *, \
+      D const *, V const *);
+WILDRIVER_FOR_EACH_TYPE(WILDRIVER_INSTANTIATE_OUT)
+#undef WILDRIVER_INSTANTIATE_OUT
+
+
 
 
 }
@@ -74,9 +74,40 @@ class MatrixOutHandle
         val_t const * rowval);
 
 
+    /**
+     * @brief Write the data of the matrix stored using the given index,
+     * dimension, and value types. The rows are converted to the native types
+     * and passed to the writer a bounded batch at a time, so that no copy of
+     * the whole matrix is made. This function must be called after
+     * setInfo().
+     *
+     * @tparam I The index type.
+     * @tparam D The dimension type.
+     * @tparam V The value type.
+     * @param rowptr The beginning index of each row.
+     * @param rowind The column each entry is located in.
+     * @param rowval The value of each entry.
+     */
+    template<typename I, typename D, typename V>
+    void writeSparseTyped(
+        I const * rowptr,
+        D const * rowind,
+        V const * rowval);
+
+
   private:
     std::unique_ptr<IMatrixWriter> m_writer;
 
+    /**
+     * @brief The number of rows set via setInfo().
+     */
+    dim_t m_numRows;
+
+    /**
+     * @brief The number of non-zeros set via setInfo().
+     */
+    ind_t m_nnz;
+
     // disable copying
     MatrixOutHandle(
         MatrixOutHandle const & handle);
@@ -11,6 +11,7 @@
 
 
 #include "MatrixWriterFactory.hpp"
+#include "BCSRFile.hpp"
 #include "CSRFile.hpp"
 #include "MatrixMarketFile.hpp"
 #include "MetisFile.hpp"
@@ -38,6 +39,8 @@ std::unique_ptr<IMatrixWriter> MatrixWriterFactory::make(
   // determine what type of reader to instantiate based on extension
   if (CSRFile::hasExtension(name)) {
     file.reset(new CSRFile(name));
+  } else if (BCSRFile::hasExtension(name)) {
+    file.reset(new BCSRFile(name));
   } else if (MatrixMarketFile::hasExtension(name)) {
     file.reset(new MatrixMarketFile(name));
   } else if (useAdapter) {
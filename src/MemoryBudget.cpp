@@ -0,0 +1,108 @@
+/**
+ * @file MemoryBudget.cpp
+ * @brief Implementation of the MemoryBudget class.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-27
+ */
+
+
+
+
+#include <cstdlib>
+#include <string>
+
+#include "MemoryBudget.hpp"
+#include "Exception.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/******************************************************************************
+* HELPER FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+/**
+ * @brief Get the budget from the WILDRIVER_MEMORY_BUDGET environment
+ * variable.
+ *
+ * @return The number of bytes, or 0 if it is not set.
+ */
+size_t getDefaultBudget() noexcept
+{
+  char const * const env = std::getenv("WILDRIVER_MEMORY_BUDGET");
+  if (env != nullptr) {
+    return static_cast<size_t>(std::strtoull(env, nullptr, 10));
+  }
+
+  return 0;
+}
+
+
+}
+
+
+
+
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+
+std::atomic<size_t> MemoryBudget::s_budget(getDefaultBudget());
+
+
+
+
+/******************************************************************************
+* PUBLIC STATIC FUNCTIONS *****************************************************
+******************************************************************************/
+
+
+size_t MemoryBudget::get() noexcept
+{
+  return s_budget.load();
+}
+
+
+void MemoryBudget::set(
+    size_t const bytes) noexcept
+{
+  s_budget.store(bytes);
+}
+
+
+bool MemoryBudget::fits(
+    size_t const bytes) noexcept
+{
+  size_t const budget = s_budget.load();
+  return budget == 0 || bytes <= budget;
+}
+
+
+void MemoryBudget::check(
+    size_t const bytes,
+    char const * const purpose)
+{
+  if (!fits(bytes)) {
+    throw MemoryBudgetException(std::string(purpose) + \
+        std::string(" requires ") + std::to_string(bytes) + \
+        std::string(" bytes of temporary memory, exceeding the memory " \
+        "budget of ") + std::to_string(get()) + std::string(" bytes."));
+  }
+}
+
+
+
+
+}
@@ -0,0 +1,101 @@
+/**
+ * @file MemoryBudget.hpp
+ * @brief The limit on the temporary memory readers may use.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-27
+ */
+
+
+
+
+#ifndef WILDRIVER_MEMORYBUDGET_HPP
+#define WILDRIVER_MEMORYBUDGET_HPP
+
+
+
+
+#include <atomic>
+#include <cstddef>
+
+
+
+
+namespace WildRiver
+{
+
+
+/**
+ * @brief The process wide limit on the temporary memory a read may hold
+ * beyond the arrays it fills. Readers whose fastest strategy would exceed the
+ * budget switch to one which uses less memory (e.g., parsing the file twice
+ * instead of sorting its entries in memory), and reads with no such strategy
+ * fail before allocating anything.
+ *
+ * The default is taken from the WILDRIVER_MEMORY_BUDGET environment variable
+ * (in bytes) if it is set, and is otherwise unlimited.
+ */
+class MemoryBudget
+{
+  public:
+    /**
+     * @brief Get the budget.
+     *
+     * @return The number of bytes, or 0 if it is unlimited.
+     */
+    static size_t get() noexcept;
+
+
+    /**
+     * @brief Set the budget. This may be called at any time, from any thread,
+     * and applies to reads which start afterwards.
+     *
+     * @param bytes The number of bytes (0 for unlimited).
+     */
+    static void set(
+        size_t bytes) noexcept;
+
+
+    /**
+     * @brief Check whether an amount of temporary memory fits in the budget.
+     *
+     * @param bytes The number of bytes.
+     *
+     * @return True if it fits.
+     */
+    static bool fits(
+        size_t bytes) noexcept;
+
+
+    /**
+     * @brief Ensure an amount of temporary memory fits in the budget, before
+     * it is allocated.
+     *
+     * @param bytes The number of bytes.
+     * @param purpose What the memory is for (e.g., "transposing").
+     *
+     * @throw MemoryBudgetException If it does not fit.
+     */
+    static void check(
+        size_t bytes,
+        char const * purpose);
+
+
+  private:
+    static std::atomic<size_t> s_budget;
+
+
+
+
+};
+
+
+
+
+}
+
+
+
+
+#endif
@@ -10,8 +10,14 @@
 
 
 
+#include <algorithm>
 #include <sstream>
 #include "MetisFile.hpp"
+#include "CancelToken.hpp"
+#include "ProgressMonitor.hpp"
+#include "Util.hpp"
+#include "LineIndex.hpp"
+#include "RowPartition.hpp"
 
 
 
@@ -194,27 +200,66 @@ bool MetisFile::getNextVertex(
         dim_t * const edgeDests,
         val_t * const edgeWeights)
 {
-  dim_t const ncon = m_numVertexWeights;
-
   // get my m_line
   if (!nextNoncommentLine(m_line)) {
     return false;
   }
 
+  *numEdges = parseVertex(vertexWeights, edgeDests, edgeWeights);
+
+  // indicate that we successfully found a vertex
+  return true;
+}
+
+
+bool MetisFile::getNextVertex(
+    std::vector<dim_t> & edgeDests,
+    std::vector<val_t> * const edgeWeights)
+{
+  if (!nextNoncommentLine(m_line)) {
+    return false;
+  }
+
+  // every edge takes at least two characters
+  size_t const maxDegree = m_line.size() / 2 + 1;
+  edgeDests.resize(maxDegree);
+  if (edgeWeights) {
+    edgeWeights->resize(maxDegree);
+  }
+
+  dim_t const degree = parseVertex(nullptr, edgeDests.data(), \
+      edgeWeights ? edgeWeights->data() : nullptr);
+
+  edgeDests.resize(degree);
+  if (edgeWeights) {
+    edgeWeights->resize(degree);
+  }
+
+  return true;
+}
+
+
+dim_t MetisFile::parseVertex(
+        val_t * const vertexWeights,
+        dim_t * const edgeDests,
+        val_t * const edgeWeights)
+{
+  dim_t const ncon = m_numVertexWeights;
+
   char * eptr = (char*)m_line.data();
 
   // read in vertex weights
   for (dim_t k=0; k<ncon; ++k) {
     char * const sptr = eptr;
-    val_t const val = std::strtod(sptr,&eptr);
+    if (vertexWeights != nullptr) {
+      vertexWeights[k] = std::strtod(sptr,&eptr);
+    } else {
+      eptr = Util::skipField(sptr);
+    }
     if (sptr == eptr) {
       throw BadFileException(std::string("Failed to read vertex weight on " \
             "line ") + std::to_string(m_file.getCurrentLine()));
     }
-
-    if (vertexWeights != nullptr) {
-      vertexWeights[k] = val;
-    }
   }
 
   dim_t degree = 0;
@@ -237,27 +282,26 @@ bool MetisFile::getNextVertex(
       edgeDests[degree] = dst;
     }
 
-    val_t wgt = static_cast<val_t>(1);
     if (m_hasEdgeWeights) {
       sptr = eptr;
-      wgt = static_cast<val_t>(std::strtod(sptr,&eptr));
+      if (edgeWeights != nullptr) {
+        edgeWeights[degree] = static_cast<val_t>(std::strtod(sptr,&eptr));
+      } else {
+        // pattern only -- skip the weight without converting it
+        eptr = Util::skipField(sptr);
+      }
       if (sptr == eptr) {
         throw BadFileException(std::string("Could not read edge weight at "
               "line ") + std::to_string(m_file.getCurrentLine()));
       }
-    } 
-    
-    if (edgeWeights != nullptr) {
-      edgeWeights[degree] = wgt;
+    } else if (edgeWeights != nullptr) {
+      edgeWeights[degree] = static_cast<val_t>(1);
     }
 
     ++degree;
   }
 
-  *numEdges = degree;
-
-  // indicate that we successfully found a vertex
-  return true;
+  return degree;
 }
 
 
@@ -302,13 +346,14 @@ void MetisFile::setNextVertex(
 bool MetisFile::nextNoncommentLine(
     std::string & line)
 {
-  do {
-    if (!m_file.nextLine(line)) {
-      return false;
+  while (m_file.nextLine(line)) {
+    if (!isComment(line)) {
+      return true;
     }
-  } while (isComment(line));
+    m_file.countComment();
+  }
 
-  return true;
+  return false;
 }
 
 
@@ -328,7 +373,8 @@ MetisFile::MetisFile(
   m_numVertexWeights(0),
   m_hasEdgeWeights(false),
   m_line(BUFFER_SIZE,'\0'),
-  m_file(fname)
+  m_file(fname),
+  m_index(nullptr)
 {
   // do nothing
 }
@@ -382,6 +428,68 @@ void MetisFile::setInfo(
 }
 
 
+void MetisFile::writeHeader(
+    dim_t const nrows,
+    dim_t,
+    ind_t const nnz)
+{
+  if (!m_infoSet) {
+    setInfo(nrows, nnz, 0, false);
+  }
+}
+
+
+void MetisFile::setNextRow(
+    dim_t const numNonZeros,
+    dim_t const * const columns,
+    val_t const * const values)
+{
+  ind_t const rowptr[2] = {0, numNonZeros};
+  setNextRows(1, rowptr, columns, values);
+}
+
+
+void MetisFile::setNextRows(
+    dim_t const numRows,
+    ind_t const * const rowptr,
+    dim_t const * const columns,
+    val_t const * const values)
+{
+  if (numRows == 0) {
+    return;
+  }
+
+  dim_t const ncon = m_numVertexWeights;
+  bool const ewgts = m_hasEdgeWeights;
+
+  std::stringstream stream;
+
+  for (dim_t i = 0; i < numRows; ++i) {
+    if (i > 0) {
+      stream << "\n";
+    }
+
+    bool first = true;
+    for (dim_t k = 0; k < ncon; ++k) {
+      stream << (first ? "" : " ") << 1;
+      first = false;
+    }
+
+    for (ind_t j = rowptr[i]; j < rowptr[i+1]; ++j) {
+      stream << (first ? "" : " ") << (columns[j]+1);
+      if (ewgts) {
+        stream << " " << (values ? values[j] : 1);
+      }
+      first = false;
+    }
+  }
+
+  m_file.setNextLine(stream.str());
+
+  m_currentVertex += numRows;
+}
+
+
 void MetisFile::read(
     ind_t * const xadj,
     dim_t * const adjncy,
@@ -392,6 +500,9 @@ void MetisFile::read(
   dim_t const interval = m_numVertices > 100 ? m_numVertices / 100 : 1;
   double const increment = 1/100.0;
 
+  ProgressMonitor::setCurrentPhase(WILDRIVER_PHASE_READ);
+  ProgressMonitor::Counter counter;
+
   xadj[0] = 0;
   for (dim_t i = 0; i < m_numVertices; ++i) {
     dim_t degree;
@@ -416,10 +527,207 @@ void MetisFile::read(
 
     xadj[i+1] = xadj[i]+degree;
 
-    if (progress != nullptr && i % interval == 0) {
-      *progress += increment;
+    if (i % CancelToken::CHECK_INTERVAL == 0) {
+      CancelToken::checkCurrent();
     }
+    if (i % interval == 0) {
+      counter.update(i+1, xadj[i+1]);
+      if (progress != nullptr) {
+        *progress += increment;
+      }
+    }
+  }
+
+  counter.update(m_numVertices, xadj[m_numVertices]);
+}
+
+
+void MetisFile::readRange(
+    dim_t const begin,
+    dim_t const end,
+    std::vector<ind_t> & xadj,
+    std::vector<dim_t> & adjncy,
+    std::vector<val_t> * const vwgt,
+    std::vector<val_t> * const adjwgt)
+{
+  if (!m_infoSet) {
+    throw UnsetInfoException("Cannot call readRange() before calling " \
+        "getInfo()");
+  }
+
+  if (begin > end || end > m_numVertices) {
+    throw BadParameterException(std::string("Invalid vertex range [") + \
+        std::to_string(begin) + std::string(", ") + std::to_string(end) + \
+        std::string(") for ") + std::to_string(m_numVertices) + \
+        std::string(" vertices."));
+  }
+
+  dim_t const nvtxs = end - begin;
+  dim_t const ncon = m_numVertexWeights > 0 ? m_numVertexWeights : 1;
+
+  xadj.assign(1, 0);
+  adjncy.clear();
+  if (vwgt) {
+    // unit vertex weights if the file has none
+    vwgt->assign(static_cast<size_t>(nvtxs)*ncon, 1);
+  }
+  if (adjwgt) {
+    adjwgt->clear();
   }
+
+  if (nvtxs == 0) {
+    return;
+  }
+
+  if (m_index.get() == nullptr) {
+    m_index.reset(new LineIndex(m_file.getFilename(), "#%\"/"));
+  }
+
+  // the header is the first data line, so vertex v is on data line v+1
+  size_t line, offset, fileLine;
+  m_index->find(begin+1, &line, &offset, &fileLine);
+  m_file.seek(offset, fileLine);
+  for (; line < begin+1; ++line) {
+    nextNoncommentLine(m_line);
+  }
+
+  for (dim_t i = 0; i < nvtxs; ++i) {
+    if (!nextNoncommentLine(m_line)) {
+      throw BadFileException(std::string("Premature end of file: ") + \
+          std::to_string(begin+i) + std::string("/") + \
+          std::to_string(m_numVertices) + std::string(" vertices found."));
+    }
+
+    // every edge takes at least two characters
+    ind_t const start = xadj.back();
+    size_t const maxDegree = m_line.size() / 2 + 1;
+    adjncy.resize(start + maxDegree);
+    if (adjwgt) {
+      adjwgt->resize(start + maxDegree);
+    }
+
+    val_t * const vwgtStart = (m_numVertexWeights > 0 && vwgt) ? \
+        vwgt->data()+(static_cast<size_t>(i)*m_numVertexWeights) : nullptr;
+
+    dim_t const degree = parseVertex(vwgtStart, adjncy.data() + start, \
+        adjwgt ? adjwgt->data() + start : nullptr);
+
+    xadj.emplace_back(start + degree);
+  }
+
+  adjncy.resize(xadj.back());
+  if (adjwgt) {
+    adjwgt->resize(xadj.back());
+  }
+}
+
+
+void MetisFile::readDegrees(
+    std::vector<ind_t> & degrees)
+{
+  if (!m_infoSet) {
+    throw UnsetInfoException("Cannot call readDegrees() before calling " \
+        "getInfo()");
+  }
+
+  std::vector<size_t> fields;
+  LineIndex::countFields(m_file.getFilename(), "#%\"/", &fields);
+
+  if (fields.size() < static_cast<size_t>(m_numVertices)+1) {
+    throw BadFileException(std::string("Premature end of file: ") + \
+        std::to_string(fields.empty() ? 0 : fields.size()-1) + \
+        std::string("/") + std::to_string(m_numVertices) + \
+        std::string(" vertices found."));
+  }
+
+  size_t const fieldsPerEdge = m_hasEdgeWeights ? 2 : 1;
+
+  // skip the header line
+  degrees.resize(m_numVertices);
+  for (dim_t v = 0; v < m_numVertices; ++v) {
+    size_t const count = fields[v+1];
+    degrees[v] = static_cast<ind_t>(count > m_numVertexWeights ? \
+        (count - m_numVertexWeights) / fieldsPerEdge : 0);
+  }
+}
+
+
+std::vector<dim_t> MetisFile::getPartition(
+    int const numParts)
+{
+  if (!m_infoSet) {
+    throw UnsetInfoException("Cannot call getPartition() before calling " \
+        "getInfo()");
+  }
+
+  // the index is kept, for reading the range after
+  if (m_index.get() == nullptr || !m_index->hasBlockFields()) {
+    m_index.reset(new LineIndex(m_file.getFilename(), "#%\"/", true));
+  }
+
+  if (m_index->getNumLines() < static_cast<size_t>(m_numVertices)+1) {
+    throw BadFileException(std::string("Premature end of file: ") + \
+        std::to_string(m_index->getNumLines() == 0 ? 0 : \
+            m_index->getNumLines()-1) + std::string("/") + \
+        std::to_string(m_numVertices) + std::string(" vertices found."));
+  }
+
+  size_t const fieldsPerEdge = m_hasEdgeWeights ? 2 : 1;
+  size_t const numVertexWeights = m_numVertexWeights;
+  dim_t const nvtxs = m_numVertices;
+  LineIndex const * const index = m_index.get();
+
+  // the degrees of the vertices of a block of lines, where the header is the
+  // first data line, so vertex v is on data line v+1
+  auto const readBlock = [index, fieldsPerEdge, numVertexWeights, nvtxs]( \
+      size_t const block, std::vector<ind_t> & degrees) {
+    std::vector<size_t> fields;
+    index->countBlockFields(block, &fields);
+
+    size_t const first = block*LineIndex::STRIDE;
+    degrees.clear();
+    for (size_t i = 0; i < fields.size(); ++i) {
+      if (first+i == 0) {
+        continue;
+      } else if (first+i > static_cast<size_t>(nvtxs)) {
+        break;
+      }
+      degrees.emplace_back(static_cast<ind_t>(fields[i] > numVertexWeights ? \
+          (fields[i] - numVertexWeights) / fieldsPerEdge : 0));
+    }
+  };
+
+  // only the blocks holding vertices
+  size_t const numBlocks = nvtxs > 0 ? \
+      static_cast<size_t>(nvtxs) / LineIndex::STRIDE + 1 : 0;
+  std::vector<size_t> const & fields = m_index->getBlockFields();
+  std::vector<dim_t> blockStarts(numBlocks+1);
+  std::vector<ind_t> blockCounts(numBlocks);
+  for (size_t b = 0; b < numBlocks; ++b) {
+    size_t const first = std::max(b*LineIndex::STRIDE, \
+        static_cast<size_t>(1));
+    size_t const last = std::min((b+1)*LineIndex::STRIDE, \
+        static_cast<size_t>(nvtxs)+1);
+    blockStarts[b] = static_cast<dim_t>(first-1);
+
+    if (b == 0 || b+1 == numBlocks) {
+      // these may include the header or lines after the last vertex
+      std::vector<ind_t> degrees;
+      readBlock(b, degrees);
+      blockCounts[b] = 0;
+      for (ind_t const degree : degrees) {
+        blockCounts[b] += degree;
+      }
+    } else {
+      size_t const weights = (last-first)*numVertexWeights;
+      blockCounts[b] = static_cast<ind_t>(fields[b] > weights ? \
+          (fields[b] - weights) / fieldsPerEdge : 0);
+    }
+  }
+  blockStarts[numBlocks] = nvtxs;
+
+  return RowPartition::balanceBlocks(blockStarts, blockCounts, numParts, \
+      readBlock);
 }
 
 
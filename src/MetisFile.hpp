@@ -18,8 +18,11 @@
 
 #include "IGraphReader.hpp"
 #include "IGraphWriter.hpp"
+#include "IRowMatrixWriter.hpp"
 #include "TextFile.hpp"
 #include "MatrixEntry.hpp"
+#include "LineIndex.hpp"
+#include <memory>
 
 
 
@@ -29,7 +32,8 @@ namespace WildRiver {
 
 class MetisFile : 
   public IGraphReader,
-  public IGraphWriter
+  public IGraphWriter,
+  public IRowMatrixWriter
 {
   public:
     /**
@@ -96,6 +100,80 @@ class MetisFile :
         bool & ewgts) override;
 
 
+    /**
+     * @brief Read only the vertices [begin, end) of the graph, seeking to the
+     * first vertex via an index of the line offsets. Edge destinations remain
+     * global. The header must already have been read via getInfo().
+     *
+     * @param begin The first vertex to read.
+     * @param end One past the last vertex to read.
+     * @param xadj The local adjacency list pointer (output, length
+     * end-begin+1).
+     * @param adjncy The adjacency list (output).
+     * @param vwgt The vertex weights (output, may be null). If the file does
+     * not contain vertex weights, it will be filled with ones.
+     * @param adjwgt The edge weights (output, may be null). If the file does
+     * not contain edge weights, it will be filled with ones.
+     *
+     * @throw BadParameterException If the range is invalid.
+     */
+    void readRange(
+        dim_t begin,
+        dim_t end,
+        std::vector<ind_t> & xadj,
+        std::vector<dim_t> & adjncy,
+        std::vector<val_t> * vwgt,
+        std::vector<val_t> * adjwgt);
+
+
+    /**
+     * @brief Get the edges of the next vertex, sizing the buffers to fit
+     * them. Vertex weights are skipped. The header must already have been
+     * read via getInfo().
+     *
+     * @param edgeDests The destination of each edge leaving this vertex
+     * (output).
+     * @param edgeWeights The weight of each edge leaving this vertex (output,
+     * may be null). If the file does not contain edge weights, it will be
+     * filled with ones.
+     *
+     * @return True if another vertex was found in the file.
+     */
+    bool getNextVertex(
+        std::vector<dim_t> & edgeDests,
+        std::vector<val_t> * edgeWeights);
+
+
+    /**
+     * @brief Count the edges of each vertex by scanning the file for fields,
+     * without parsing them. The header must already have been read via
+     * getInfo().
+     *
+     * @param degrees The number of edges of each vertex (output).
+     */
+    void readDegrees(
+        std::vector<ind_t> & degrees);
+
+
+    /**
+     * @brief Split the vertices into contiguous parts balancing the number of
+     * edges plus vertices in each (see RowPartition::balance()). Only the
+     * edges of each block of LineIndex::STRIDE lines are counted, while
+     * building the index used by readRange(), and the vertices of a block
+     * are counted only where a part ends inside it. The header must already
+     * have been read via getInfo().
+     *
+     * @param numParts The number of parts.
+     *
+     * @return The first vertex of each part, followed by the number of
+     * vertices (length numParts+1).
+     *
+     * @throw BadFileException If the file has too few vertices.
+     */
+    std::vector<dim_t> getPartition(
+        int numParts);
+
+
     /**
      * @brief Write a graph file from the given CSR structure.
      *
@@ -127,6 +205,52 @@ class MetisFile :
         bool ewgts) override;
 
 
+    /**
+     * @brief Write the header of the graph from the dimensions of a square
+     * matrix, if the information of the graph has not already been set.
+     *
+     * @param nrows The number of rows (vertices).
+     * @param ncols The number of columns (vertices).
+     * @param nnz The number of entries (an undirected edge counts as two).
+     */
+    virtual void writeHeader(
+        dim_t nrows,
+        dim_t ncols,
+        ind_t nnz) override;
+
+
+    /**
+     * @brief Set the edges of the next vertex. Vertex weights, if the graph
+     * has them, are written as ones.
+     *
+     * @param numNonZeros The number of edges of the vertex.
+     * @param columns The neighbors.
+     * @param values The edge weights (may be null, in which case ones are
+     * written if the graph has edge weights).
+     */
+    virtual void setNextRow(
+        dim_t numNonZeros,
+        dim_t const * columns,
+        val_t const * values) override;
+
+
+    /**
+     * @brief Set the edges of the next several vertices, formatting them into
+     * a single buffer which is written at once.
+     *
+     * @param numRows The number of vertices to set.
+     * @param rowptr The adjacency list pointer of the vertices (length
+     * numRows+1), indexing columns and values.
+     * @param columns The neighbors.
+     * @param values The edge weights (may be null).
+     */
+    virtual void setNextRows(
+        dim_t numRows,
+        ind_t const * rowptr,
+        dim_t const * columns,
+        val_t const * values) override;
+
+
 
 
   private:
@@ -178,6 +302,12 @@ class MetisFile :
     TextFile m_file;
 
 
+    /**
+     * @brief The index of line offsets for reading ranges of vertices.
+     */
+    std::unique_ptr<LineIndex> m_index;
+
+
     /**
      * @brief Get the flags representing the weights associated with this
      * graph.
@@ -249,6 +379,24 @@ class MetisFile :
         val_t * edgeWeights);
 
 
+    /**
+     * @brief Parse the vertex in the line buffer.
+     *
+     * @param vertexWeights The vertex weight(s) (must be null or at least of
+     * length equal to the number of constraints).
+     * @param edgeDests The destination of each edge leaving this vertex (must
+     * be of length equal to the number of edges of the vertex).
+     * @param edgeWeights The weight of each edge leaving this vertex (must
+     * null or be of length equal to the number of edges of the vertex).
+     *
+     * @return The number of edges incident to this vertex.
+     */
+    dim_t parseVertex(
+        val_t * vertexWeights,
+        dim_t * edgeDests,
+        val_t * edgeWeights);
+
+
     /**
      * @brief Set the adjacency list and vertex weight of the next vertex.
      *
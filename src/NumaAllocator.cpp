@@ -0,0 +1,318 @@
+/**
+ * @file NumaAllocator.cpp
+ * @brief Implementation of the NumaAllocator class.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-16
+ */
+
+
+
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+#include "NumaAllocator.hpp"
+#include "ThreadPool.hpp"
+#include "Util.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+/**
+* @brief The size of a transparent huge page.
+*/
+size_t const HUGE_PAGE_SIZE = 2*1024*1024;
+
+/**
+* @brief The fewest bytes worth aligning to and advising huge pages for, as
+* a smaller array cannot contain a whole huge page.
+*/
+size_t const MIN_HUGE_PAGE_BYTES = HUGE_PAGE_SIZE;
+
+/**
+* @brief The fewest bytes worth giving to a thread to touch.
+*/
+size_t const MIN_BYTES_PER_THREAD = 1024*1024;
+
+/**
+* @brief The policy for interleaving pages (from linux/mempolicy.h).
+*/
+int const MPOL_INTERLEAVE_POLICY = 3;
+
+/**
+* @brief The largest node id we will build a mask for.
+*/
+int const MAX_NODES = 1024;
+
+
+}
+
+
+
+
+/******************************************************************************
+* HELPER FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+/**
+* @brief Get the size of a page.
+*
+* @return The page size in bytes.
+*/
+size_t getPageSize()
+{
+#ifdef __linux__
+  long const size = sysconf(_SC_PAGESIZE);
+  if (size > 0) {
+    return static_cast<size_t>(size);
+  }
+#endif
+  return 4096;
+}
+
+
+/**
+* @brief Get the ids of the online NUMA nodes, parsed from a list such as
+* "0-1,4".
+*
+* @return The node ids (empty if they cannot be determined).
+*/
+std::vector<int> getOnlineNodes()
+{
+  std::vector<int> nodes;
+
+  std::ifstream stream("/sys/devices/system/node/online");
+  std::string line;
+  if (!stream.is_open() || !std::getline(stream, line)) {
+    return nodes;
+  }
+
+  for (std::string const & range : Util::split(line, ",")) {
+    size_t const dash = range.find('-');
+    int const first = std::atoi(range.substr(0, dash).c_str());
+    int const last = dash == std::string::npos ? first : \
+        std::atoi(range.substr(dash+1).c_str());
+    for (int node = first; node <= last && node < MAX_NODES; ++node) {
+      nodes.emplace_back(node);
+    }
+  }
+
+  return nodes;
+}
+
+
+/**
+* @brief Get the whole pages contained within a region of memory.
+*
+* @param ptr The start of the region.
+* @param bytes The size of the region.
+* @param start The first page (output).
+* @param length The length of the pages in bytes (output).
+*
+* @return True if the region contains at least one whole page.
+*/
+bool getPages(
+    void * const ptr,
+    size_t const bytes,
+    char ** const start,
+    size_t * const length)
+{
+  size_t const page = getPageSize();
+  uintptr_t const begin = reinterpret_cast<uintptr_t>(ptr);
+  uintptr_t const first = ((begin + page - 1) / page) * page;
+  uintptr_t const last = ((begin + bytes) / page) * page;
+
+  if (last <= first) {
+    return false;
+  }
+
+  *start = reinterpret_cast<char*>(first);
+  *length = last - first;
+
+  return true;
+}
+
+
+/**
+* @brief Advise the kernel to back the region with huge pages.
+*
+* @param ptr The start of the region.
+* @param bytes The size of the region.
+*/
+void adviseHugePages(
+    void * const ptr,
+    size_t const bytes)
+{
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  char * start;
+  size_t length;
+  if (getPages(ptr, bytes, &start, &length)) {
+    // this is only a hint, so failure is fine
+    madvise(start, length, MADV_HUGEPAGE);
+  }
+#endif
+}
+
+
+/**
+* @brief Set the policy of the region to interleave its pages across all
+* online NUMA nodes.
+*
+* @param ptr The start of the region.
+* @param bytes The size of the region.
+*/
+void interleavePages(
+    void * const ptr,
+    size_t const bytes)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+  std::vector<int> const nodes = getOnlineNodes();
+  if (nodes.size() < 2) {
+    // nothing to interleave across
+    return;
+  }
+
+  size_t const bitsPerWord = sizeof(unsigned long)*8;
+  std::vector<unsigned long> mask(MAX_NODES / bitsPerWord, 0);
+  for (int const node : nodes) {
+    mask[node / bitsPerWord] |= 1UL << (node % bitsPerWord);
+  }
+
+  char * start;
+  size_t length;
+  if (getPages(ptr, bytes, &start, &length)) {
+    // this is only a hint, so failure is fine
+    syscall(SYS_mbind, start, length, MPOL_INTERLEAVE_POLICY, mask.data(), \
+        mask.size()*bitsPerWord, 0);
+  }
+#endif
+}
+
+
+/**
+* @brief Zero the region in equal contiguous pieces from separate tasks of
+* the library's thread pool. The tasks are not pinned to threads, so this
+* only spreads the pages across the nodes the pool happens to run on.
+*
+* @param ptr The start of the region.
+* @param bytes The size of the region.
+* @param numThreads The maximum number of threads to use.
+*/
+void touchPages(
+    void * const ptr,
+    size_t const bytes,
+    int numThreads)
+{
+  numThreads = static_cast<int>(std::min(static_cast<size_t>(numThreads), \
+      std::max(bytes / MIN_BYTES_PER_THREAD, static_cast<size_t>(1))));
+
+  // keep each thread's piece page aligned
+  size_t const page = getPageSize();
+  size_t const pages = (bytes + page - 1) / page;
+  char * const data = static_cast<char*>(ptr);
+
+  auto const touch = [=](int const t) {
+    size_t const start = std::min(((pages * t) / numThreads) * page, bytes);
+    size_t const end = std::min(((pages * (t+1)) / numThreads) * page, \
+        bytes);
+    std::memset(data + start, 0, end - start);
+  };
+
+  ThreadPool::getInstance().parallelFor(0, numThreads, 1, \
+      [&touch](size_t const begin, size_t const end) {
+    for (size_t t = begin; t < end; ++t) {
+      touch(static_cast<int>(t));
+    }
+  });
+}
+
+
+}
+
+
+
+
+/******************************************************************************
+* PUBLIC STATIC FUNCTIONS *****************************************************
+******************************************************************************/
+
+
+void * NumaAllocator::allocate(
+    size_t const bytes,
+    int const flags,
+    int numThreads)
+{
+  if (flags == WILDRIVER_ALLOC_DEFAULT) {
+    return std::malloc(bytes);
+  }
+
+  bool const hugePages = (flags & WILDRIVER_ALLOC_HUGE_PAGES) && \
+      bytes >= MIN_HUGE_PAGE_BYTES;
+  size_t const alignment = hugePages ? HUGE_PAGE_SIZE : getPageSize();
+
+  void * ptr = nullptr;
+  if (posix_memalign(&ptr, alignment, std::max(bytes, \
+      static_cast<size_t>(1))) != 0) {
+    return nullptr;
+  }
+
+  // set the policies before any page is touched
+  if (hugePages) {
+    adviseHugePages(ptr, bytes);
+  }
+  if (flags & WILDRIVER_ALLOC_INTERLEAVE) {
+    interleavePages(ptr, bytes);
+  }
+
+  if (flags & WILDRIVER_ALLOC_FIRST_TOUCH) {
+    if (numThreads <= 0) {
+      numThreads = ThreadPool::getInstance().getNumThreads();
+    }
+    touchPages(ptr, bytes, numThreads);
+  }
+
+  return ptr;
+}
+
+
+int NumaAllocator::getNumNodes()
+{
+  return std::max(static_cast<int>(getOnlineNodes().size()), 1);
+}
+
+
+
+
+}
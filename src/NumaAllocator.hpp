@@ -0,0 +1,84 @@
+/**
+ * @file NumaAllocator.hpp
+ * @brief Functions for allocating arrays with control over page placement.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-16
+ */
+
+
+
+
+#ifndef WILDRIVER_NUMAALLOCATOR_HPP
+#define WILDRIVER_NUMAALLOCATOR_HPP
+
+
+
+
+#include <cstddef>
+
+#include "base.h"
+
+
+
+
+namespace WildRiver
+{
+
+
+class NumaAllocator
+{
+  public:
+    /**
+     * @brief Allocate an array whose pages are placed according to the given
+     * flags (a combination of wildriver_alloc_flag_t). The memory is always
+     * obtained from the C heap, so that it may be released with free().
+     *
+     * - WILDRIVER_ALLOC_FIRST_TOUCH: the array is split into equal contiguous
+     *   pieces which are zeroed by tasks of the library's thread pool, so
+     *   that its pages are spread across the NUMA nodes the pool runs on.
+     *   The threads are not pinned, so which node a given piece lands on is
+     *   not tied to the thread that later processes it.
+     * - WILDRIVER_ALLOC_HUGE_PAGES: arrays of at least a huge page are
+     *   aligned to a huge page and the kernel is advised to back them with
+     *   transparent huge pages. Smaller arrays are only page aligned.
+     * - WILDRIVER_ALLOC_INTERLEAVE: pages are interleaved across all online
+     *   NUMA nodes.
+     *
+     * Hints the system does not support are silently ignored.
+     *
+     * @param bytes The number of bytes to allocate.
+     * @param flags The placement flags.
+     * @param numThreads The number of threads to first touch with (0 for the
+     * number of threads of the library's thread pool).
+     *
+     * @return The allocated memory, or nullptr if it could not be allocated.
+     */
+    static void * allocate(
+        size_t bytes,
+        int flags,
+        int numThreads);
+
+
+    /**
+     * @brief Get the number of online NUMA nodes.
+     *
+     * @return The number of nodes (1 if it cannot be determined).
+     */
+    static int getNumNodes();
+
+
+
+
+};
+
+
+
+
+}
+
+
+
+
+#endif
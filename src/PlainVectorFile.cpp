@@ -86,13 +86,14 @@ bool PlainVectorFile::hasExtension(
 bool PlainVectorFile::nextNoncommentLine(
     std::string & line)
 {
-  do {
-    if (!m_file.nextLine(line)) {
-      return false;
+  while (m_file.nextLine(line)) {
+    if (!isComment(line)) {
+      return true;
     }
-  } while (isComment(line));
+    m_file.countComment();
+  }
 
-  return true;
+  return false;
 }
 
 
@@ -11,8 +11,8 @@
 
 
 
-#ifndef WILDIRVER_PLAINVECTORFILE_HPP
-#define WILDIRVER_PLAINVECTORFILE_HPP
+#ifndef WILDRIVER_PLAINVECTORFILE_HPP
+#define WILDRIVER_PLAINVECTORFILE_HPP
 
 
 
@@ -0,0 +1,259 @@
+/**
+ * @file ProgressMonitor.cpp
+ * @brief Implementation of the ProgressMonitor class.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-23
+ */
+
+
+
+
+#include "ProgressMonitor.hpp"
+#include "Util.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/******************************************************************************
+* HELPER FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+/**
+ * @brief The monitor installed for the loads of each thread.
+ */
+thread_local ProgressMonitor * currentMonitor = nullptr;
+
+
+/**
+ * @brief The shortest time over which to measure the rate (in nanoseconds).
+ */
+int64_t const MIN_RATE_PERIOD = 1000000;
+
+
+}
+
+
+
+
+/******************************************************************************
+* PUBLIC STATIC FUNCTIONS *****************************************************
+******************************************************************************/
+
+
+ProgressMonitor * ProgressMonitor::getCurrent() noexcept
+{
+  return currentMonitor;
+}
+
+
+ProgressMonitor * ProgressMonitor::setCurrent(
+    ProgressMonitor * const monitor) noexcept
+{
+  ProgressMonitor * const previous = currentMonitor;
+  currentMonitor = monitor;
+  return previous;
+}
+
+
+void ProgressMonitor::addCurrentBytes(
+    size_t const bytes)
+{
+  if (currentMonitor != nullptr) {
+    currentMonitor->add(bytes, 0, 0);
+  }
+  IOStats::addCurrentBytes(bytes);
+}
+
+
+void ProgressMonitor::addCurrentTotalBytes(
+    size_t const bytes)
+{
+  if (currentMonitor != nullptr) {
+    currentMonitor->addTotalBytes(bytes);
+  }
+}
+
+
+void ProgressMonitor::setCurrentPhase(
+    int const phase)
+{
+  if (currentMonitor != nullptr) {
+    currentMonitor->setPhase(phase);
+  }
+  IOStats::setCurrentPhase(phase);
+}
+
+
+
+
+/******************************************************************************
+* CONSTRUCTORS / DESTRUCTOR ***************************************************
+******************************************************************************/
+
+
+ProgressMonitor::Scope::Scope(
+    ProgressMonitor * const monitor) noexcept :
+  m_previous(setCurrent(monitor))
+{
+  // do nothing
+}
+
+
+ProgressMonitor::Scope::~Scope()
+{
+  setCurrent(m_previous);
+}
+
+
+ProgressMonitor::Counter::Counter() noexcept :
+  m_monitor(currentMonitor),
+  m_stats(IOStats::getCurrent()),
+  m_rows(0),
+  m_entries(0)
+{
+  // do nothing
+}
+
+
+ProgressMonitor::ProgressMonitor(
+    callback_type callback,
+    double const interval) :
+  m_callback(std::move(callback)),
+  m_interval(static_cast<int64_t>(interval*1e9)),
+  m_start(Util::now()),
+  m_phase(WILDRIVER_PHASE_OPEN),
+  m_bytes(0),
+  m_totalBytes(0),
+  m_rows(0),
+  m_entries(0),
+  m_reporting(false),
+  m_pending(false),
+  m_lastTime(m_start),
+  m_lastBytes(0),
+  m_rate(0.0)
+{
+  // do nothing
+}
+
+
+
+
+/******************************************************************************
+* PUBLIC FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+void ProgressMonitor::add(
+    size_t const bytes,
+    size_t const rows,
+    size_t const entries)
+{
+  if (bytes > 0) {
+    m_bytes.fetch_add(bytes, std::memory_order_relaxed);
+  }
+  if (rows > 0) {
+    m_rows.fetch_add(rows, std::memory_order_relaxed);
+  }
+  if (entries > 0) {
+    m_entries.fetch_add(entries, std::memory_order_relaxed);
+  }
+
+  report(false);
+}
+
+
+void ProgressMonitor::addTotalBytes(
+    size_t const bytes) noexcept
+{
+  m_totalBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+
+void ProgressMonitor::setPhase(
+    int const phase)
+{
+  if (m_phase.exchange(phase) != phase) {
+    report(true);
+  }
+}
+
+
+wildriver_progress ProgressMonitor::getProgress() const noexcept
+{
+  wildriver_progress progress;
+
+  progress.phase = m_phase.load();
+  progress.bytes = m_bytes.load(std::memory_order_relaxed);
+  progress.total_bytes = m_totalBytes.load(std::memory_order_relaxed);
+  progress.rows = m_rows.load(std::memory_order_relaxed);
+  progress.entries = m_entries.load(std::memory_order_relaxed);
+  progress.seconds = (Util::now() - m_start) / 1e9;
+  progress.mbps = m_rate.load();
+
+  return progress;
+}
+
+
+
+
+/******************************************************************************
+* PRIVATE FUNCTIONS ***********************************************************
+******************************************************************************/
+
+
+void ProgressMonitor::report(
+    bool const force)
+{
+  int64_t const time = Util::now();
+  if (!force && time - m_lastTime.load() < m_interval) {
+    return;
+  }
+
+  // a forced report is left for the reporting thread if there is one
+  if (force) {
+    m_pending.store(true);
+  }
+
+  // let one thread report at a time, and others carry on loading
+  if (m_reporting.exchange(true)) {
+    return;
+  }
+
+  do {
+    m_pending.store(false);
+
+    int64_t const current = Util::now();
+    int64_t const period = current - m_lastTime.load();
+    if (period >= MIN_RATE_PERIOD) {
+      size_t const bytes = m_bytes.load(std::memory_order_relaxed);
+      m_rate.store((bytes - m_lastBytes.load()) / (period / 1e9) / 1e6);
+      m_lastTime.store(current);
+      m_lastBytes.store(bytes);
+    }
+
+    if (m_callback) {
+      m_callback(getProgress());
+    }
+
+    m_reporting.store(false);
+
+    // deliver a forced report made while reporting, unless the thread which
+    // made it has since started reporting itself
+  } while (m_pending.load() && !m_reporting.exchange(true));
+}
+
+
+
+
+}
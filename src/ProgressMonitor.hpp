@@ -0,0 +1,291 @@
+/**
+ * @file ProgressMonitor.hpp
+ * @brief Class for reporting the progress of loads.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-23
+ */
+
+
+
+
+#ifndef WILDRIVER_PROGRESSMONITOR_HPP
+#define WILDRIVER_PROGRESSMONITOR_HPP
+
+
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "base.h"
+#include "IOStats.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/**
+ * @brief Atomic counts of the bytes, rows, and entries processed by loads,
+ * along with the current phase. Like a CancelToken, a monitor is installed
+ * for the loads of a thread with a Scope. Text files report the bytes they
+ * read, and readers report rows and entries through a Counter at the same
+ * chunk boundaries where they check for cancellation.
+ */
+class ProgressMonitor
+{
+  public:
+    typedef std::function<void(wildriver_progress const &)> callback_type;
+
+
+    /**
+     * @brief Installs a monitor as the current monitor of the calling thread
+     * for the lifetime of the scope.
+     */
+    class Scope
+    {
+      public:
+        /**
+         * @brief Install a monitor.
+         *
+         * @param monitor The monitor (may be null for no monitor).
+         */
+        Scope(
+            ProgressMonitor * monitor) noexcept;
+
+
+        /**
+         * @brief Restore the previously installed monitor.
+         */
+        ~Scope();
+
+
+      private:
+        ProgressMonitor * m_previous;
+
+        // disable copying
+        Scope(
+            Scope const & rhs);
+        Scope & operator=(
+            Scope const & rhs);
+    };
+
+
+    /**
+     * @brief Reports the rows and entries of a single reader to the monitor
+     * and IOStats that were current when it was created. The reader passes
+     * its running totals, and only the increases are added to the monitor.
+     */
+    class Counter
+    {
+      public:
+        /**
+         * @brief Create a counter for the current monitor.
+         */
+        Counter() noexcept;
+
+
+        /**
+         * @brief Update the counts of the reader.
+         *
+         * @param rows The number of rows processed so far.
+         * @param entries The number of entries processed so far.
+         */
+        void update(
+            size_t const rows,
+            size_t const entries)
+        {
+          if (m_monitor != nullptr || m_stats != nullptr) {
+            if (m_monitor != nullptr) {
+              m_monitor->add(0, rows - m_rows, entries - m_entries);
+            }
+            if (m_stats != nullptr) {
+              m_stats->add(0, 0, 0, rows - m_rows, entries - m_entries);
+            }
+            m_rows = rows;
+            m_entries = entries;
+          }
+        }
+
+
+      private:
+        ProgressMonitor * m_monitor;
+        IOStats * m_stats;
+        size_t m_rows;
+        size_t m_entries;
+
+        // disable copying
+        Counter(
+            Counter const & rhs);
+        Counter & operator=(
+            Counter const & rhs);
+    };
+
+
+    /**
+     * @brief Get the current monitor of the calling thread.
+     *
+     * @return The monitor (null if there is none).
+     */
+    static ProgressMonitor * getCurrent() noexcept;
+
+
+    /**
+     * @brief Set the current monitor of the calling thread.
+     *
+     * @param monitor The monitor (may be null for no monitor).
+     *
+     * @return The previous monitor.
+     */
+    static ProgressMonitor * setCurrent(
+        ProgressMonitor * monitor) noexcept;
+
+
+    /**
+     * @brief Add to the bytes read by the current monitor, if there is one,
+     * and to the current IOStats.
+     *
+     * @param bytes The number of bytes.
+     */
+    static void addCurrentBytes(
+        size_t bytes);
+
+
+    /**
+     * @brief Add to the total bytes of the files of the current monitor, if
+     * there is one.
+     *
+     * @param bytes The number of bytes.
+     */
+    static void addCurrentTotalBytes(
+        size_t bytes);
+
+
+    /**
+     * @brief Set the phase of the current monitor, if there is one, and of
+     * the current IOStats.
+     *
+     * @param phase The phase (a wildriver_phase_t).
+     */
+    static void setCurrentPhase(
+        int phase);
+
+
+    /**
+     * @brief Create a new monitor.
+     *
+     * @param callback The function to call with the progress (may be empty).
+     * It must not throw.
+     * @param interval The minimum number of seconds between calls of the
+     * callback, other than for changes of phase.
+     */
+    ProgressMonitor(
+        callback_type callback = callback_type(),
+        double interval = 0.0);
+
+
+    /**
+     * @brief Add to the counts of the monitor, calling the callback if the
+     * interval has passed.
+     *
+     * @param bytes The number of bytes read.
+     * @param rows The number of rows processed.
+     * @param entries The number of entries processed.
+     */
+    void add(
+        size_t bytes,
+        size_t rows,
+        size_t entries);
+
+
+    /**
+     * @brief Add to the total bytes of the files being loaded.
+     *
+     * @param bytes The number of bytes.
+     */
+    void addTotalBytes(
+        size_t bytes) noexcept;
+
+
+    /**
+     * @brief Set the phase, calling the callback if it changed.
+     *
+     * @param phase The phase (a wildriver_phase_t).
+     */
+    void setPhase(
+        int phase);
+
+
+    /**
+     * @brief Get the current progress. This is safe to call from any thread.
+     *
+     * @return The progress.
+     */
+    wildriver_progress getProgress() const noexcept;
+
+
+  private:
+    callback_type m_callback;
+    int64_t m_interval;
+    int64_t m_start;
+    std::atomic<int> m_phase;
+    std::atomic<size_t> m_bytes;
+    std::atomic<size_t> m_totalBytes;
+    std::atomic<size_t> m_rows;
+    std::atomic<size_t> m_entries;
+
+    /**
+     * @brief Whether or not a thread is reporting, so that the callback is
+     * never called concurrently.
+     */
+    std::atomic<bool> m_reporting;
+
+    /**
+     * @brief Whether or not a forced report (i.e., of a change of phase) is
+     * waiting, to be delivered by the reporting thread if another thread was
+     * reporting when it was made.
+     */
+    std::atomic<bool> m_pending;
+
+    /**
+     * @brief The time and bytes of the last report, for the rate.
+     */
+    std::atomic<int64_t> m_lastTime;
+    std::atomic<size_t> m_lastBytes;
+    std::atomic<double> m_rate;
+
+    /**
+     * @brief Update the rate and call the callback, if the interval has
+     * passed or the report is forced.
+     *
+     * @param force Whether or not to report regardless of the interval.
+     */
+    void report(
+        bool force);
+
+    // disable copying
+    ProgressMonitor(
+        ProgressMonitor const & rhs);
+    ProgressMonitor & operator=(
+        ProgressMonitor const & rhs);
+
+
+
+
+};
+
+
+
+
+}
+
+
+
+
+#endif
@@ -0,0 +1,145 @@
+/**
+ * @file ReadBackend.cpp
+ * @brief Implementation of the ReadBackend class.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-27
+ */
+
+
+
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#include "ReadBackend.hpp"
+#include "AsyncReadBuffer.hpp"
+#include "MappedBuffer.hpp"
+#include "Exception.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/******************************************************************************
+* HELPER FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+/**
+ * @brief Get the backend from the WILDRIVER_READ_BACKEND environment
+ * variable.
+ *
+ * @return The backend, or READ_BACKEND_BUFFERED if it is not set.
+ */
+int getDefaultBackend() noexcept
+{
+  char const * const env = std::getenv("WILDRIVER_READ_BACKEND");
+  if (env != nullptr) {
+    for (int backend : {READ_BACKEND_MMAP, READ_BACKEND_ASYNC}) {
+      if (std::strcmp(env, ReadBackend::getName(backend)) == 0) {
+        return backend;
+      }
+    }
+  }
+
+  return READ_BACKEND_BUFFERED;
+}
+
+
+}
+
+
+
+
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+
+std::atomic<int> ReadBackend::s_backend(getDefaultBackend());
+
+
+
+
+/******************************************************************************
+* PUBLIC STATIC FUNCTIONS *****************************************************
+******************************************************************************/
+
+
+int ReadBackend::get() noexcept
+{
+  return s_backend.load();
+}
+
+
+void ReadBackend::set(
+    int const backend) noexcept
+{
+  s_backend.store(backend);
+}
+
+
+char const * ReadBackend::getName(
+    int const backend) noexcept
+{
+  switch (backend) {
+    case READ_BACKEND_MMAP:
+      return "mmap";
+    case READ_BACKEND_ASYNC:
+      return "async";
+    default:
+      return "buffered";
+  }
+}
+
+
+bool ReadBackend::isSupported(
+    int const backend) noexcept
+{
+  switch (backend) {
+    case READ_BACKEND_BUFFERED:
+      return true;
+    case READ_BACKEND_MMAP:
+      return MappedBuffer::isSupported();
+    case READ_BACKEND_ASYNC:
+      return AsyncReadBuffer::isSupported();
+    default:
+      return false;
+  }
+}
+
+
+std::unique_ptr<std::streambuf> ReadBackend::openRead(
+    std::string const & name)
+{
+  int const backend = get();
+  if (backend == READ_BACKEND_MMAP && MappedBuffer::isSupported()) {
+    return std::unique_ptr<std::streambuf>(new MappedBuffer(name));
+  } else if (backend == READ_BACKEND_ASYNC && \
+      AsyncReadBuffer::isSupported()) {
+    return std::unique_ptr<std::streambuf>(new AsyncReadBuffer(name));
+  }
+
+  std::unique_ptr<std::filebuf> buffer(new std::filebuf);
+  if (buffer->open(name, std::ios::in | std::ios::binary) == nullptr) {
+    throw BadFileException(std::string("Failed to open file '") + \
+        name + std::string("'"));
+  }
+
+  return std::unique_ptr<std::streambuf>(buffer.release());
+}
+
+
+
+
+}
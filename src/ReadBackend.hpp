@@ -0,0 +1,124 @@
+/**
+ * @file ReadBackend.hpp
+ * @brief The process wide choice of how uncompressed files are read.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-27
+ */
+
+
+
+
+#ifndef WILDRIVER_READBACKEND_HPP
+#define WILDRIVER_READBACKEND_HPP
+
+
+
+
+#include <atomic>
+#include <memory>
+#include <streambuf>
+#include <string>
+
+
+
+
+namespace WildRiver
+{
+
+
+/**
+ * @brief The ways of reading uncompressed files.
+ */
+enum read_backend_type {
+  READ_BACKEND_BUFFERED,
+  READ_BACKEND_MMAP,
+  READ_BACKEND_ASYNC
+};
+
+
+/**
+ * @brief The process wide backend uncompressed files are read with: buffered
+ * reads through the standard library, a memory mapping of the file (see
+ * MappedBuffer), or many large reads kept in flight with io_uring, falling
+ * back to pread (see AsyncReadBuffer).
+ *
+ * The default is taken from the WILDRIVER_READ_BACKEND environment variable
+ * ("buffered", "mmap", or "async") if it is set, and is otherwise buffered.
+ * Backends which are not supported on the platform fall back to buffered
+ * reads.
+ */
+class ReadBackend
+{
+  public:
+    /**
+     * @brief Get the backend.
+     *
+     * @return The backend (a read_backend_type).
+     */
+    static int get() noexcept;
+
+
+    /**
+     * @brief Set the backend. This may be called at any time, from any
+     * thread, and applies to files opened for reading afterwards.
+     *
+     * @param backend The backend (a read_backend_type).
+     */
+    static void set(
+        int backend) noexcept;
+
+
+    /**
+     * @brief Get the name of a backend.
+     *
+     * @param backend The backend.
+     *
+     * @return The name (e.g., "mmap").
+     */
+    static char const * getName(
+        int backend) noexcept;
+
+
+    /**
+     * @brief Check whether a backend is supported on this platform.
+     *
+     * @param backend The backend.
+     *
+     * @return True if files are read with it when it is set.
+     */
+    static bool isSupported(
+        int backend) noexcept;
+
+
+    /**
+     * @brief Open an uncompressed file for reading with the backend.
+     *
+     * @param name The filename/path.
+     *
+     * @return The buffer to read the file from.
+     *
+     * @throw BadFileException If the file cannot be opened.
+     */
+    static std::unique_ptr<std::streambuf> openRead(
+        std::string const & name);
+
+
+  private:
+    static std::atomic<int> s_backend;
+
+
+
+
+};
+
+
+
+
+}
+
+
+
+
+#endif
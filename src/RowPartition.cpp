@@ -0,0 +1,124 @@
+/**
+ * @file RowPartition.cpp
+ * @brief Implementation of the RowPartition class.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-19
+ */
+
+
+
+
+#include <algorithm>
+#include <string>
+
+#include "RowPartition.hpp"
+#include "Exception.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/******************************************************************************
+* PUBLIC STATIC FUNCTIONS *****************************************************
+******************************************************************************/
+
+
+std::vector<dim_t> RowPartition::balance(
+    std::vector<ind_t> const & counts,
+    int const numParts)
+{
+  if (numParts < 1) {
+    throw BadParameterException(std::string("Invalid number of parts: ") + \
+        std::to_string(numParts));
+  }
+
+  dim_t const nrows = static_cast<dim_t>(counts.size());
+
+  // prefix sum of the row weights
+  std::vector<ind_t> prefix(nrows+1);
+  prefix[0] = 0;
+  for (dim_t i = 0; i < nrows; ++i) {
+    prefix[i+1] = prefix[i] + counts[i] + 1;
+  }
+  ind_t const total = prefix[nrows];
+
+  std::vector<dim_t> starts(numParts+1);
+  for (int p = 0; p <= numParts; ++p) {
+    ind_t const target = (total*p) / numParts;
+    starts[p] = static_cast<dim_t>(std::lower_bound(prefix.begin(), \
+        prefix.end(), target) - prefix.begin());
+  }
+  starts[0] = 0;
+  starts[numParts] = nrows;
+
+  return starts;
+}
+
+
+std::vector<dim_t> RowPartition::balanceBlocks(
+    std::vector<dim_t> const & blockStarts,
+    std::vector<ind_t> const & blockCounts,
+    int const numParts,
+    std::function<void(size_t, std::vector<ind_t> &)> const & readBlock)
+{
+  if (numParts < 1) {
+    throw BadParameterException(std::string("Invalid number of parts: ") + \
+        std::to_string(numParts));
+  }
+
+  size_t const numBlocks = blockCounts.size();
+  dim_t const nrows = blockStarts[numBlocks];
+
+  // prefix sum of the block weights
+  std::vector<ind_t> prefix(numBlocks+1);
+  prefix[0] = 0;
+  for (size_t b = 0; b < numBlocks; ++b) {
+    prefix[b+1] = prefix[b] + blockCounts[b] + \
+        (blockStarts[b+1] - blockStarts[b]);
+  }
+  ind_t const total = prefix[numBlocks];
+
+  // the boundaries are increasing, so each block is read at most once
+  size_t readIndex = numBlocks;
+  std::vector<ind_t> counts;
+
+  std::vector<dim_t> starts(numParts+1);
+  for (int p = 0; p <= numParts; ++p) {
+    ind_t const target = (total*p) / numParts;
+    size_t const b = static_cast<size_t>(std::lower_bound(prefix.begin(), \
+        prefix.end(), target) - prefix.begin());
+    if (b == 0 || prefix[b] == target) {
+      starts[p] = b < numBlocks ? blockStarts[b] : nrows;
+      continue;
+    }
+
+    // the boundary falls inside the previous block
+    size_t const block = b-1;
+    if (readIndex != block) {
+      readBlock(block, counts);
+      readIndex = block;
+    }
+    dim_t row = blockStarts[block];
+    ind_t weight = prefix[block];
+    for (size_t i = 0; i < counts.size() && weight < target && \
+        row < blockStarts[block+1]; ++i) {
+      weight += counts[i] + 1;
+      ++row;
+    }
+    starts[p] = weight < target ? blockStarts[block+1] : row;
+  }
+  starts[0] = 0;
+  starts[numParts] = nrows;
+
+  return starts;
+}
+
+
+
+
+}
@@ -0,0 +1,90 @@
+/**
+ * @file RowPartition.hpp
+ * @brief Functions for splitting the rows of a matrix into balanced parts.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-19
+ */
+
+
+
+
+#ifndef WILDRIVER_ROWPARTITION_HPP
+#define WILDRIVER_ROWPARTITION_HPP
+
+
+
+
+#include <functional>
+#include <vector>
+
+#include "base.h"
+
+
+
+
+namespace WildRiver
+{
+
+
+class RowPartition
+{
+  public:
+    /**
+     * @brief Split the rows into contiguous parts with (nearly) equal
+     * weight, where the weight of a row is its number of entries plus one.
+     * Counting the row itself keeps the parts of matrices with many empty
+     * rows balanced as well.
+     *
+     * @param counts The number of entries in each row.
+     * @param numParts The number of parts.
+     *
+     * @return The first row of each part, followed by the number of rows
+     * (length numParts+1).
+     *
+     * @throw BadParameterException If the number of parts is less than one.
+     */
+    static std::vector<dim_t> balance(
+        std::vector<ind_t> const & counts,
+        int numParts);
+
+
+    /**
+     * @brief Split the rows into the same parts as balance(), given only the
+     * number of entries in each block of consecutive rows. Each part boundary
+     * is first found among the blocks, and then among the rows of the single
+     * block it falls in, so that only the counts of those blocks are needed.
+     *
+     * @param blockStarts The first row of each block, followed by the number
+     * of rows.
+     * @param blockCounts The number of entries in each block.
+     * @param numParts The number of parts.
+     * @param readBlock The function providing the number of entries in each
+     * row of a block.
+     *
+     * @return The first row of each part, followed by the number of rows
+     * (length numParts+1).
+     *
+     * @throw BadParameterException If the number of parts is less than one.
+     */
+    static std::vector<dim_t> balanceBlocks(
+        std::vector<dim_t> const & blockStarts,
+        std::vector<ind_t> const & blockCounts,
+        int numParts,
+        std::function<void(size_t, std::vector<ind_t> &)> const & readBlock);
+
+
+
+
+};
+
+
+
+
+}
+
+
+
+
+#endif
@@ -0,0 +1,167 @@
+/**
+ * @file RowStream.cpp
+ * @brief Implementation of the RowStream class.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-20
+ */
+
+
+
+
+#include <algorithm>
+
+#include "RowStream.hpp"
+#include "Exception.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/******************************************************************************
+* PUBLIC STATIC FUNCTIONS *****************************************************
+******************************************************************************/
+
+
+bool RowStream::isSupported(
+    std::string const & name)
+{
+  return CSRFile::hasExtension(name) || MetisFile::hasExtension(name);
+}
+
+
+
+
+/******************************************************************************
+* CONSTRUCTORS / DESTRUCTOR ***************************************************
+******************************************************************************/
+
+
+RowStream::RowStream(
+    std::string const & name) :
+  m_csr(nullptr),
+  m_metis(nullptr),
+  m_numRows(NULL_DIM),
+  m_numCols(NULL_DIM),
+  m_nnz(NULL_IND),
+  m_nextRow(0),
+  m_pending(false),
+  m_columns(),
+  m_values()
+{
+  if (CSRFile::hasExtension(name)) {
+    m_csr.reset(new CSRFile(name));
+    m_csr->getInfo(m_numRows, m_numCols, m_nnz);
+  } else if (MetisFile::hasExtension(name)) {
+    m_metis.reset(new MetisFile(name));
+    int nvwgt;
+    bool ewgts;
+    m_metis->getInfo(m_numRows, m_nnz, nvwgt, ewgts);
+    m_numCols = m_numRows;
+  } else {
+    throw UnknownExtensionException(std::string("Only CSR and METIS files " \
+        "can be streamed by row: ") + name);
+  }
+}
+
+
+
+
+/******************************************************************************
+* PUBLIC FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+void RowStream::getInfo(
+    dim_t & nrows,
+    dim_t & ncols,
+    ind_t & nnz) const noexcept
+{
+  nrows = m_numRows;
+  ncols = m_numCols;
+  nnz = m_nnz;
+}
+
+
+dim_t RowStream::nextRows(
+    dim_t const maxRows,
+    ind_t const maxNnz,
+    ind_t * const rowptr,
+    dim_t * const rowind,
+    val_t * const rowval)
+{
+  dim_t numRows = 0;
+  rowptr[0] = 0;
+
+  while (numRows < maxRows) {
+    if (!m_pending && !readPending()) {
+      break;
+    }
+
+    ind_t const start = rowptr[numRows];
+    ind_t const degree = m_columns.size();
+    if (start + degree > maxNnz) {
+      if (numRows == 0) {
+        throw BadParameterException(std::string("Row ") + \
+            std::to_string(m_nextRow) + std::string(" has ") + \
+            std::to_string(degree) + std::string(" non-zeros, but the " \
+            "batch only holds ") + std::to_string(maxNnz));
+      }
+      // leave the row for the next batch
+      break;
+    }
+
+    std::copy(m_columns.begin(), m_columns.end(), rowind + start);
+    if (rowval != nullptr) {
+      std::copy(m_values.begin(), m_values.end(), rowval + start);
+    }
+    m_pending = false;
+
+    rowptr[numRows+1] = start + degree;
+    ++numRows;
+    ++m_nextRow;
+  }
+
+  return numRows;
+}
+
+
+
+
+/******************************************************************************
+* PRIVATE FUNCTIONS ***********************************************************
+******************************************************************************/
+
+
+bool RowStream::readPending()
+{
+  if (m_nextRow >= m_numRows) {
+    return false;
+  }
+
+  bool found;
+  if (m_csr.get() != nullptr) {
+    found = m_csr->getNextRow(m_columns, &m_values);
+  } else {
+    found = m_metis->getNextVertex(m_columns, &m_values);
+  }
+
+  if (!found) {
+    throw EOFException(std::string("Only found ") + \
+        std::to_string(m_nextRow) + std::string("/") + \
+        std::to_string(m_numRows) + std::string(" rows in file"));
+  }
+
+  m_pending = true;
+
+  return true;
+}
+
+
+
+
+}
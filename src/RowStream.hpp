@@ -0,0 +1,174 @@
+/**
+ * @file RowStream.hpp
+ * @brief Class for reading a matrix a batch of rows at a time.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-20
+ */
+
+
+
+
+#ifndef WILDRIVER_ROWSTREAM_HPP
+#define WILDRIVER_ROWSTREAM_HPP
+
+
+
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "CSRFile.hpp"
+#include "MetisFile.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/**
+* @brief Reads the rows of a matrix (or the adjacency lists of a graph) in
+* order into caller provided batches, so that only a single row is ever held
+* beyond the caller's buffers. Only row ordered text formats (CSR and METIS)
+* can be streamed.
+*/
+class RowStream
+{
+  public:
+    /**
+    * @brief Check if the given file can be streamed by row.
+    *
+    * @param name The filename.
+    *
+    * @return True if the file type is row ordered.
+    */
+    static bool isSupported(
+        std::string const & name);
+
+
+    /**
+    * @brief Open a file for streaming its rows.
+    *
+    * @param name The filename/path.
+    *
+    * @throw UnknownExtensionException If the file cannot be streamed by row.
+    */
+    RowStream(
+        std::string const & name);
+
+
+    /**
+    * @brief Get the number of rows, columns, and non-zeros in the matrix.
+    *
+    * @param nrows The number of rows.
+    * @param ncols The number of columns.
+    * @param nnz The number of non-zeros.
+    */
+    void getInfo(
+        dim_t & nrows,
+        dim_t & ncols,
+        ind_t & nnz) const noexcept;
+
+
+    /**
+    * @brief Get the index of the next row to be read.
+    *
+    * @return The next row.
+    */
+    dim_t getNextRowIndex() const noexcept
+    {
+      return m_nextRow;
+    }
+
+
+    /**
+    * @brief Read the next batch of rows. A row which does not fit in the
+    * remaining space of the batch is held until the next call.
+    *
+    * @param maxRows The maximum number of rows in the batch.
+    * @param maxNnz The maximum number of non-zeros in the batch.
+    * @param rowptr The local row pointer of the batch (output, length at
+    * least maxRows+1).
+    * @param rowind The column index of each entry (output, length at least
+    * maxNnz).
+    * @param rowval The value of each entry (output, may be null, length at
+    * least maxNnz).
+    *
+    * @return The number of rows read (zero once all rows have been read).
+    *
+    * @throw BadParameterException If the next row alone has more than maxNnz
+    * non-zeros. The row is kept, so that the call can be repeated with a
+    * larger batch.
+    */
+    dim_t nextRows(
+        dim_t maxRows,
+        ind_t maxNnz,
+        ind_t * rowptr,
+        dim_t * rowind,
+        val_t * rowval);
+
+
+  private:
+    /**
+    * @brief The CSR file being streamed (null if it is a METIS file).
+    */
+    std::unique_ptr<CSRFile> m_csr;
+
+    /**
+    * @brief The METIS file being streamed (null if it is a CSR file).
+    */
+    std::unique_ptr<MetisFile> m_metis;
+
+    dim_t m_numRows;
+    dim_t m_numCols;
+    ind_t m_nnz;
+
+    /**
+    * @brief The index of the next row to be returned.
+    */
+    dim_t m_nextRow;
+
+    /**
+    * @brief Whether or not a row has been read but not yet returned.
+    */
+    bool m_pending;
+
+    /**
+    * @brief The columns and values of the pending row.
+    */
+    std::vector<dim_t> m_columns;
+    std::vector<val_t> m_values;
+
+
+    /**
+    * @brief Read the next row of the file into the pending row.
+    *
+    * @return True if a row was read.
+    */
+    bool readPending();
+
+
+    // disable copying
+    RowStream(
+        RowStream const & rhs);
+    RowStream & operator=(
+        RowStream const & rhs);
+
+
+
+
+};
+
+
+
+
+}
+
+
+
+
+#endif
@@ -11,12 +11,19 @@
 
 
 #include "SNAPFile.hpp"
+#include "CancelToken.hpp"
+#include "IOStats.hpp"
+#include "MemoryBudget.hpp"
+#include "ProgressMonitor.hpp"
+#include "ThreadPool.hpp"
+#include "Tracer.hpp"
 #include "CoordinateWriter.hpp"
 #include "Exception.hpp"
 #include <string>
 #include <unordered_set>
 #include <vector>
 #include <cassert>
+#include <algorithm>
 
 
 namespace WildRiver
@@ -51,6 +58,11 @@ const std::string DIRECTED_GRAPH_HEADER("# Directed graph");
 const std::string UNDIRECTED_GRAPH_HEADER("# Undirected graph");
 const std::string NODES_HEADER("# Nodes: ");
 
+/**
+* @brief The number of vertices to pass to the writer at a time.
+*/
+dim_t const VERTICES_PER_BATCH = 1024;
+
 }
 
 
@@ -89,31 +101,37 @@ std::vector<std::string> split(
   return chunks;
 }
 
-std::vector<edge_struct> readEdges(
-    TextFile * file,
-    ind_t const numEdges = NULL_IND)
+/**
+* @brief Read the next edge from the file, skipping comments.
+*
+* @param file The file.
+* @param line The line buffer.
+* @param edge The edge to fill.
+*
+* @return True if an edge was read, false at the end of the file.
+*/
+bool nextEdge(
+    TextFile * const file,
+    std::string & line,
+    edge_struct * const edge)
 {
-  std::string line;
-  std::vector<edge_struct> edges;
-  if (numEdges != NULL_IND) {
-    edges.reserve(numEdges);
-  }
   while (file->nextLine(line)) {
     if (line.size() == 0) {
       throw BadFileException("Hit empty line.");
     } else if (line[0] == '#') {
       // skip comment line
+      file->countComment();
     } else {
-      edge_struct edge{0, 0, 1};
+      *edge = edge_struct{0, 0, 1};
       char * eptr = (char*)line.data();
       char * sptr = eptr;
-      edge.src = std::strtoull(sptr, &eptr, 10);
+      edge->src = std::strtoull(sptr, &eptr, 10);
       if (eptr == sptr) {
         throw BadFileException("Unable to parse line: '" + line + "'");
       }
 
       sptr = eptr;
-      edge.dst = static_cast<dim_t>(std::strtoull(sptr, &eptr, 10));
+      edge->dst = static_cast<dim_t>(std::strtoull(sptr, &eptr, 10));
       if (eptr == sptr) {
         throw BadFileException("Unable to parse line: '" + line + "'");
       }
@@ -121,12 +139,43 @@ std::vector<edge_struct> readEdges(
       sptr = eptr;
       val_t const weight = static_cast<val_t>(std::strtod(sptr, &eptr));
       if (sptr != eptr) {
-        edge.weight = weight;
+        edge->weight = weight;
       }
 
+      return true;
+    }
+  }
+
+  return false;
+}
+
+std::vector<edge_struct> readEdges(
+    TextFile * file,
+    ind_t const numEdges = NULL_IND)
+{
+  std::string line;
+  std::vector<edge_struct> edges;
+  if (numEdges != NULL_IND) {
+    edges.reserve(numEdges);
+  }
+  IOStats::Temporary memory(sizeof(edge_struct)*edges.capacity());
+
+  ProgressMonitor::Counter counter;
+
+  edge_struct edge;
+  while (nextEdge(file, line, &edge)) {
+    if (edges.size() == edges.capacity()) {
+      edges.emplace_back(edge);
+      memory.resize(sizeof(edge_struct)*edges.capacity());
+    } else {
       edges.emplace_back(edge);
     }
+    if (edges.size() % CancelToken::CHECK_INTERVAL == 0) {
+      CancelToken::checkCurrent();
+      counter.update(0, edges.size());
+    }
   }
+  counter.update(0, edges.size());
 
   return edges;
 }
@@ -279,56 +328,27 @@ void SNAPFile::readHeader()
   m_file.resetStream();
 }
 
-/******************************************************************************
-* CONSTRUCTORS / DESTRUCTOR ***************************************************
-******************************************************************************/
-
-
-SNAPFile::SNAPFile(
-    std::string const & filename) :
-  m_infoSet(false),
-  m_numVertices(0),
-  m_numEdges(0),
-  m_hasEdgeWeights(false),
-  m_directed(true),
-  m_line(),
-  m_file(filename)
-{
-  // do nothing
-}
-
-
-SNAPFile::~SNAPFile()
-{
-  // do nothing
-}
-
-
-/******************************************************************************
-* PUBLIC METHODS **************************************************************
-******************************************************************************/
-
-
-void SNAPFile::read(
+void SNAPFile::readEdgeList(
     ind_t * const xadj,
     dim_t * const adjncy,
-    val_t * const vwgt,
     val_t * const adjwgt,
     double * progress)
 {
-  if (m_numVertices == 0) {
-    return;
-  }
-
   dim_t const interval = m_numEdges*2 > 100 ? m_numEdges*2 / 100 : 1;
   double const increment = 1.0/100.0;
 
   std::string line;
 
   // read in all edges
+  ProgressMonitor::setCurrentPhase(WILDRIVER_PHASE_READ);
+  Tracer::Span parse("reader", "parse");
   const std::vector<edge_struct> edges =
       readEdges(&m_file, m_numEdges);
 
+  ProgressMonitor::setCurrentPhase(WILDRIVER_PHASE_BUILD);
+  parse.end();
+  Tracer::Span build("reader", "build");
+
   // zero out xadj
   for (dim_t i = 0; i < m_numVertices; ++i) {
     xadj[i] = 0;
@@ -349,17 +369,21 @@ void SNAPFile::read(
       ++xadj[edge.dst+1];
     }
 
+    if (edgesProcessed % CancelToken::CHECK_INTERVAL == 0) {
+      CancelToken::checkCurrent();
+    }
     ++edgesProcessed;
-    if (progress != nullptr && edgesProcessed % interval == 0) {
-      *progress += increment;
+    if (edgesProcessed % interval == 0) {
+      if (progress != nullptr) {
+        *progress += increment;
+      }
     }
   }
 
   // shift xadj and prefixsum
   xadj[0] = 0;
-  for (dim_t v = 1; v <= m_numVertices; ++v) {
-    xadj[v] += xadj[v-1];
-  }
+  ThreadPool::getInstance().prefixSum(xadj, \
+      static_cast<size_t>(m_numVertices)+1);
   for (dim_t v = m_numVertices; v > 0; --v) {
     xadj[v] = xadj[v-1];
   }
@@ -383,13 +407,162 @@ void SNAPFile::read(
       ++xadj[edge.dst+1];
     }
 
+    if (edgesProcessed % CancelToken::CHECK_INTERVAL == 0) {
+      CancelToken::checkCurrent();
+    }
     ++edgesProcessed;
-    if (progress != nullptr && edgesProcessed % interval == 0) {
-      *progress += increment;
+    if (edgesProcessed % interval == 0) {
+      if (progress != nullptr) {
+        *progress += increment;
+      }
     }
   }
   assert(xadj[m_numVertices] == m_numEdges);
 
+  // the edges were counted as they were read
+  ProgressMonitor::Counter counter;
+  counter.update(m_numVertices, 0);
+}
+
+
+void SNAPFile::readTwice(
+    ind_t * const xadj,
+    dim_t * const adjncy,
+    val_t * const adjwgt,
+    double * progress)
+{
+  std::string line;
+  edge_struct edge;
+
+  std::fill(xadj, xadj+m_numVertices+1, 0);
+
+  // count the edges of each vertex
+  ProgressMonitor::setCurrentPhase(WILDRIVER_PHASE_READ);
+  Tracer::Span count("reader", "parse");
+  size_t edgesRead = 0;
+  while (nextEdge(&m_file, line, &edge)) {
+    if (edge.src >= m_numVertices || edge.dst >= m_numVertices) {
+      throw BadFileException(std::string("Invalid edge: ") + \
+          std::to_string(edge.src) + std::string(" -> ") + \
+          std::to_string(edge.dst));
+    }
+    ++xadj[edge.src+1];
+    if (!m_directed) {
+      ++xadj[edge.dst+1];
+    }
+
+    ++edgesRead;
+    if (edgesRead % CancelToken::CHECK_INTERVAL == 0) {
+      CancelToken::checkCurrent();
+    }
+  }
+  count.end();
+
+  if (progress != nullptr) {
+    *progress += 0.5;
+  }
+
+  ProgressMonitor::setCurrentPhase(WILDRIVER_PHASE_BUILD);
+  ThreadPool::getInstance().prefixSum(xadj, \
+      static_cast<size_t>(m_numVertices)+1);
+  if (xadj[m_numVertices] > m_numEdges) {
+    throw BadFileException(std::string("Found ") + \
+        std::to_string(xadj[m_numVertices]) + std::string(" edges but " \
+        "expected ") + std::to_string(m_numEdges));
+  }
+
+  // use the adjacency list pointer as the insertion point of each edge as it
+  // is read again, and shift it back after
+  m_file.resetStream();
+  ProgressMonitor::setCurrentPhase(WILDRIVER_PHASE_READ);
+  ProgressMonitor::Counter counter;
+  Tracer::Span place("reader", "parse");
+  edgesRead = 0;
+  while (nextEdge(&m_file, line, &edge)) {
+    ind_t const srcIdx = xadj[edge.src]++;
+    adjncy[srcIdx] = edge.dst;
+    if (adjwgt) {
+      adjwgt[srcIdx] = edge.weight;
+    }
+
+    if (!m_directed) {
+      ind_t const dstIdx = xadj[edge.dst]++;
+      adjncy[dstIdx] = edge.src;
+      if (adjwgt) {
+        adjwgt[dstIdx] = edge.weight;
+      }
+    }
+
+    ++edgesRead;
+    if (edgesRead % CancelToken::CHECK_INTERVAL == 0) {
+      CancelToken::checkCurrent();
+      counter.update(0, edgesRead);
+    }
+  }
+  place.end();
+
+  ProgressMonitor::setCurrentPhase(WILDRIVER_PHASE_BUILD);
+  for (dim_t v = m_numVertices; v > 0; --v) {
+    xadj[v] = xadj[v-1];
+  }
+  xadj[0] = 0;
+
+  counter.update(m_numVertices, edgesRead);
+
+  if (progress != nullptr) {
+    *progress += 0.5;
+  }
+}
+
+/******************************************************************************
+* CONSTRUCTORS / DESTRUCTOR ***************************************************
+******************************************************************************/
+
+
+SNAPFile::SNAPFile(
+    std::string const & filename) :
+  m_infoSet(false),
+  m_numVertices(0),
+  m_numEdges(0),
+  m_hasEdgeWeights(false),
+  m_directed(true),
+  m_line(),
+  m_file(filename),
+  m_writer(&m_file),
+  m_numWrittenVertices(0)
+{
+  // do nothing
+}
+
+
+SNAPFile::~SNAPFile()
+{
+  // do nothing
+}
+
+
+/******************************************************************************
+* PUBLIC METHODS **************************************************************
+******************************************************************************/
+
+
+void SNAPFile::read(
+    ind_t * const xadj,
+    dim_t * const adjncy,
+    val_t * const vwgt,
+    val_t * const adjwgt,
+    double * progress)
+{
+  if (m_numVertices == 0) {
+    return;
+  }
+
+  if (MemoryBudget::fits(sizeof(edge_struct)*m_numEdges)) {
+    readEdgeList(xadj, adjncy, adjwgt, progress);
+  } else {
+    readTwice(xadj, adjncy, adjwgt, progress);
+  }
+
   // vertex weights are not part of snap format
   if (vwgt) {
     for (dim_t v = m_numVertices; v > 1; ++v) {
@@ -399,6 +572,14 @@ void SNAPFile::read(
 }
 
 
+size_t SNAPFile::getTemporaryBytes()
+{
+  // reading twice needs no temporary memory
+  size_t const edgeBytes = sizeof(edge_struct)*m_numEdges;
+  return MemoryBudget::fits(edgeBytes) ? edgeBytes : 0;
+}
+
+
 void SNAPFile::getInfo(
     dim_t & nvtxs,
     ind_t & nedges,
@@ -416,41 +597,75 @@ void SNAPFile::getInfo(
 }
 
 
-void SNAPFile::write(
-    ind_t const * const xadj,
-    dim_t const * const adjncy,
-    val_t const *,
-    val_t const * const adjwgt)
+void SNAPFile::getInfo(
+    dim_t & nrows,
+    dim_t & ncols,
+    ind_t & nnz)
 {
-  CoordinateWriter writer(&m_file);
+  readHeader();
 
-  std::vector<dim_t> neighbors;
-  std::vector<val_t> weights;
-  for (dim_t i = 0; i < m_numVertices; ++i) {
-    neighbors.clear();
-    weights.clear();
+  nrows = m_numVertices;
+  ncols = m_numVertices;
+  nnz = m_numEdges;
 
-    // build edges
-    for (ind_t j=xadj[i]; j<xadj[i+1]; ++j) {
-      if (m_directed || adjncy[j] <= i) {
-        neighbors.emplace_back(adjncy[j]);
-        if (m_hasEdgeWeights) {
-          if (adjwgt) {
-            weights.emplace_back(adjwgt[j]);
-          } else {
-            weights.emplace_back(1);
-          }
-        }
-      }
+  m_infoSet = true;
+}
+
+
+void SNAPFile::readEntries(
+    entry_visitor const & visit,
+    double * const progress)
+{
+  ind_t const interval = m_numEdges > 100 ? m_numEdges / 100 : 1;
+  double const increment = 1.0/100.0;
+
+  ProgressMonitor::setCurrentPhase(WILDRIVER_PHASE_READ);
+  ProgressMonitor::Counter counter;
+
+  // the header lines are skipped as comments
+  m_file.resetStream();
+
+  std::string line;
+  edge_struct edge;
+  ind_t edgesProcessed = 0;
+  while (nextEdge(&m_file, line, &edge)) {
+    if (edge.src >= m_numVertices || edge.dst >= m_numVertices) {
+      throw BadFileException(std::string("Invalid edge: ") + \
+          std::to_string(edge.src) + std::string(" -> ") + \
+          std::to_string(edge.dst));
     }
 
-    // set the vertex
-    if (m_hasEdgeWeights) {
-      writer.setNextRow(xadj[i+1]-xadj[i], neighbors.data(), weights.data());
-    } else {
-      writer.setNextRow(xadj[i+1]-xadj[i], neighbors.data(), nullptr);
+    visit(edge.src, edge.dst, edge.weight);
+    if (!m_directed) {
+      visit(edge.dst, edge.src, edge.weight);
+    }
+
+    if (edgesProcessed % CancelToken::CHECK_INTERVAL == 0) {
+      CancelToken::checkCurrent();
+    }
+    ++edgesProcessed;
+    if (edgesProcessed % interval == 0) {
+      counter.update(0, edgesProcessed);
+      if (progress != nullptr) {
+        *progress += increment;
+      }
     }
   }
+  counter.update(0, edgesProcessed);
+}
+
+
+void SNAPFile::write(
+    ind_t const * const xadj,
+    dim_t const * const adjncy,
+    val_t const *,
+    val_t const * const adjwgt)
+{
+  // pass a batch of vertices to the writer at once
+  for (dim_t start = 0; start < m_numVertices; start += VERTICES_PER_BATCH) {
+    dim_t const end = std::min(start + VERTICES_PER_BATCH, m_numVertices);
+    setNextRows(end - start, xadj + start, adjncy, adjwgt);
+  }
 }
 
 
@@ -470,4 +685,58 @@ void SNAPFile::setInfo(
 }
 
 
+void SNAPFile::writeHeader(
+    dim_t const nrows,
+    dim_t,
+    ind_t const nnz)
+{
+  if (!m_infoSet) {
+    setInfo(nrows, nnz, 0, false);
+  }
+}
+
+
+void SNAPFile::setNextRow(
+    dim_t const numNonZeros,
+    dim_t const * const columns,
+    val_t const * const values)
+{
+  ind_t const rowptr[2] = {0, numNonZeros};
+  setNextRows(1, rowptr, columns, values);
+}
+
+
+void SNAPFile::setNextRows(
+    dim_t const numRows,
+    ind_t const * const rowptr,
+    dim_t const * const columns,
+    val_t const * const values)
+{
+  // build the edges to keep, and pass them to the writer at once
+  std::vector<ind_t> batchPtr(1, 0);
+  std::vector<dim_t> neighbors;
+  std::vector<val_t> weights;
+  for (dim_t r = 0; r < numRows; ++r) {
+    dim_t const i = m_numWrittenVertices + r;
+    for (ind_t j = rowptr[r]; j < rowptr[r+1]; ++j) {
+      if (m_directed || columns[j] <= i) {
+        neighbors.emplace_back(columns[j]);
+        if (m_hasEdgeWeights) {
+          if (values) {
+            weights.emplace_back(values[j]);
+          } else {
+            weights.emplace_back(1);
+          }
+        }
+      }
+    }
+    batchPtr.emplace_back(neighbors.size());
+  }
+
+  m_writer.setNextRows(numRows, batchPtr.data(), neighbors.data(), \
+      m_hasEdgeWeights ? weights.data() : nullptr);
+  m_numWrittenVertices += numRows;
+}
+
+
 }
@@ -12,8 +12,11 @@
 #ifndef WILDRIVER_SNAPFILE_HPP
 #define WILDRIVER_SNAPFILE_HPP
 
+#include "ICoordinateReader.hpp"
 #include "IGraphReader.hpp"
 #include "IGraphWriter.hpp"
+#include "IRowMatrixWriter.hpp"
+#include "CoordinateWriter.hpp"
 #include "TextFile.hpp"
 
 
@@ -49,7 +52,9 @@ namespace WildRiver
 */
 class SNAPFile :
   public IGraphReader,
-  public IGraphWriter
+  public IGraphWriter,
+  public ICoordinateReader,
+  public IRowMatrixWriter
 {
   public:
     /**
@@ -116,6 +121,44 @@ class SNAPFile :
         bool & ewgts) override;
 
 
+    /**
+     * @brief Get the peak amount of temporary memory read() is expected to
+     * allocate. Building the graph from its edges in memory needs a copy of
+     * the edges, and if that does not fit in the memory budget the file is
+     * instead read twice, needing none.
+     *
+     * @return The number of bytes.
+     */
+    virtual size_t getTemporaryBytes() override;
+
+
+    /**
+     * @brief Get the graph as a square matrix.
+     *
+     * @param nrows The number of rows (vertices).
+     * @param ncols The number of columns (vertices).
+     * @param nnz The number of entries (directed edges).
+     */
+    virtual void getInfo(
+        dim_t & nrows,
+        dim_t & ncols,
+        ind_t & nnz) override;
+
+
+    /**
+     * @brief Visit each edge of the graph in file order, without storing
+     * them. For undirected graphs, the reverse edge is visited immediately
+     * after each edge.
+     *
+     * @param visit The function to call for each edge.
+     * @param progress The variable to update as the graph is read (may be
+     * null).
+     */
+    virtual void readEntries(
+        entry_visitor const & visit,
+        double * progress) override;
+
+
     /**
      * @brief Write a graph file from the given CSR structure.
      *
@@ -147,6 +190,50 @@ class SNAPFile :
         bool ewgts) override;
 
 
+    /**
+     * @brief Write the header of the graph from the dimensions of a square
+     * matrix, if the information of the graph has not already been set.
+     *
+     * @param nrows The number of rows (vertices).
+     * @param ncols The number of columns (vertices).
+     * @param nnz The number of entries (directed edges).
+     */
+    virtual void writeHeader(
+        dim_t nrows,
+        dim_t ncols,
+        ind_t nnz) override;
+
+
+    /**
+     * @brief Set the edges of the next vertex.
+     *
+     * @param numNonZeros The number of edges of the vertex.
+     * @param columns The neighbors.
+     * @param values The edge weights (may be null).
+     */
+    virtual void setNextRow(
+        dim_t numNonZeros,
+        dim_t const * columns,
+        val_t const * values) override;
+
+
+    /**
+     * @brief Set the edges of the next several vertices, passing them to the
+     * writer at once.
+     *
+     * @param numRows The number of vertices to set.
+     * @param rowptr The adjacency list pointer of the vertices (length
+     * numRows+1), indexing columns and values.
+     * @param columns The neighbors.
+     * @param values The edge weights (may be null).
+     */
+    virtual void setNextRows(
+        dim_t numRows,
+        ind_t const * rowptr,
+        dim_t const * columns,
+        val_t const * values) override;
+
+
 
 
   private:
@@ -192,6 +279,18 @@ class SNAPFile :
     TextFile m_file;
 
 
+    /**
+     * @brief The writer of the edges, which tracks the vertex being written.
+     */
+    CoordinateWriter m_writer;
+
+
+    /**
+     * @brief The number of vertices written.
+     */
+    dim_t m_numWrittenVertices;
+
+
     /**
     * @brief Get the next non-comment line from the file.
     *
@@ -217,6 +316,41 @@ class SNAPFile :
     virtual void writeHeader(); 
 
 
+    /**
+     * @brief Read the CSR structure of the graph from a copy of its edges
+     * held in memory.
+     *
+     * @param xadj The adjacency list pointer.
+     * @param adjncy The adjacency list.
+     * @param adjwgt The edge weights (may be null).
+     * @param progress The variable to update as the graph is loaded (may be
+     * null).
+     */
+    void readEdgeList(
+        ind_t * xadj,
+        dim_t * adjncy,
+        val_t * adjwgt,
+        double * progress);
+
+
+    /**
+     * @brief Read the CSR structure of the graph without any temporary
+     * memory, by counting the edges of each vertex in one pass over the file
+     * and placing them in a second.
+     *
+     * @param xadj The adjacency list pointer.
+     * @param adjncy The adjacency list.
+     * @param adjwgt The edge weights (may be null).
+     * @param progress The variable to update as the graph is loaded (may be
+     * null).
+     */
+    void readTwice(
+        ind_t * xadj,
+        dim_t * adjncy,
+        val_t * adjwgt,
+        double * progress);
+
+
 
 
 };
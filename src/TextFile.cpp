@@ -10,7 +10,15 @@
 
 
 
+#include <algorithm>
+
+#include <sys/stat.h>
+
 #include "TextFile.hpp"
+#include "Compression.hpp"
+#include "IOStats.hpp"
+#include "ProgressMonitor.hpp"
+#include "ReadBackend.hpp"
 
 
 
@@ -31,6 +39,19 @@ enum {
 };
 
 
+namespace
+{
+
+
+/**
+ * @brief The number of bytes to read between reports of progress.
+ */
+size_t const PROGRESS_BYTES = 64*1024;
+
+
+}
+
+
 
 
 /******************************************************************************
@@ -42,10 +63,11 @@ bool TextFile::matchExtension(
     std::string const & f,
     std::vector<std::string> const & extensions)
 {
+  std::string const name = Compression::stripExtension(f);
   for (std::string const & ext : extensions) {
     size_t len = ext.size();
 
-    if (f.compare(f.size()-len,len,ext) == 0) {
+    if (name.size() >= len && name.compare(name.size()-len,len,ext) == 0) {
       return true;
     }
   }
@@ -54,6 +76,18 @@ bool TextFile::matchExtension(
 }
 
 
+size_t TextFile::getFileSize(
+    std::string const & name)
+{
+  struct stat info;
+  if (stat(name.c_str(), &info) != 0) {
+    return 0;
+  }
+
+  return static_cast<size_t>(info.st_size);
+}
+
+
 
 /******************************************************************************
 * CONSTRUCTORS / DESTRUCTOR ***************************************************
@@ -64,8 +98,18 @@ TextFile::TextFile(
     std::string const & name) :
   m_state(FILE_STATE_UNOPENED),
   m_currentLine(0),
+  m_unreportedBytes(0),
+  m_unreportedLines(0),
+  m_unreportedComments(0),
+  m_bytesSinceReset(0),
   m_name(name),
-  m_stream()
+  m_reportedCompressedBytes(0),
+  m_resetCompressedBytes(0),
+  m_fileBuffer(),
+  m_readBuffer(),
+  m_decompressBuffer(),
+  m_compressBuffer(),
+  m_stream(&m_fileBuffer)
 {
   // throw exceptions when things go wrong
   m_stream.exceptions(std::fstream::failbit | std::fstream::badbit);
@@ -74,7 +118,11 @@ TextFile::TextFile(
 
 TextFile::~TextFile()
 {
-  m_stream.close();
+  report();
+
+  if (m_fileBuffer.is_open()) {
+    m_fileBuffer.close();
+  }
 }
 
 
@@ -92,11 +140,18 @@ void TextFile::openWrite()
         m_name + std::string("' for writing."));
   }
 
-  m_stream.open(getFilename(),std::fstream::out | std::fstream::trunc);
-
-  if (!m_stream.good()) {
-    throw BadFileException(std::string("Failed to open file '") + \
-        m_name + std::string("'"));
+  int const compression = Compression::forOutput(m_name);
+  if (compression != COMPRESSION_NONE) {
+    // compressed in independent blocks, so it can be read in parallel
+    m_compressBuffer.reset(new CompressBuffer(m_name, compression));
+    m_stream.rdbuf(m_compressBuffer.get());
+  } else {
+    if (m_fileBuffer.open(getFilename(),std::fstream::out | \
+        std::fstream::trunc) == nullptr) {
+      throw BadFileException(std::string("Failed to open file '") + \
+          m_name + std::string("'"));
+    }
+    m_stream.clear();
   }
 
   m_state = FILE_STATE_WRITE;
@@ -110,11 +165,24 @@ void TextFile::openRead()
         m_name + std::string("' for reading."));
   }
 
-  m_stream.open(getFilename(),std::fstream::in);
+  int const compression = Compression::fromMagic(m_name);
+  if (compression != COMPRESSION_NONE) {
+    m_decompressBuffer.reset(new DecompressBuffer(m_name, compression));
+    m_stream.rdbuf(m_decompressBuffer.get());
+  } else if (ReadBackend::get() != READ_BACKEND_BUFFERED) {
+    m_readBuffer = ReadBackend::openRead(m_name);
+    m_stream.rdbuf(m_readBuffer.get());
+  } else {
+    if (m_fileBuffer.open(getFilename(),std::fstream::in) == nullptr) {
+      throw BadFileException(std::string("Failed to open file '") + \
+          m_name + std::string("'"));
+    }
+    m_stream.clear();
+  }
 
-  if (!m_stream.good()) {
-    throw BadFileException(std::string("Failed to open file '") + \
-        m_name + std::string("'"));
+  // progress of compressed files is measured in compressed bytes
+  if (ProgressMonitor::getCurrent() != nullptr) {
+    ProgressMonitor::addCurrentTotalBytes(getFileSize(m_name));
   }
 
   m_state = FILE_STATE_READ;
@@ -135,12 +203,48 @@ bool TextFile::isOpenRead() const
 
 void TextFile::resetStream()
 {
+  // the bytes already read will be read again
+  if (m_decompressBuffer != nullptr) {
+    size_t const consumed = m_decompressBuffer->getCompressedBytes();
+    ProgressMonitor::addCurrentTotalBytes(consumed - m_resetCompressedBytes);
+    m_resetCompressedBytes = consumed;
+  } else {
+    ProgressMonitor::addCurrentTotalBytes(m_bytesSinceReset);
+  }
+  m_bytesSinceReset = 0;
+
   m_stream.clear();
   m_stream.seekg(0,std::ifstream::beg);
   m_currentLine = 0;
 }
 
 
+void TextFile::seek(
+    size_t const offset,
+    size_t const line)
+{
+  m_stream.clear();
+  m_stream.seekg(static_cast<std::streamoff>(offset),std::ifstream::beg);
+  m_currentLine = line;
+
+  if (m_decompressBuffer != nullptr) {
+    // the bytes skipped were not parsed
+    report();
+    m_reportedCompressedBytes = m_decompressBuffer->getCompressedBytes();
+  }
+}
+
+
+size_t TextFile::tell()
+{
+  // query the buffer directly, as the stream fails the query at its end
+  std::streamoff const offset = m_stream.rdbuf()->pubseekoff(0, \
+      std::ios_base::cur, std::ios_base::in);
+
+  return static_cast<size_t>(offset);
+}
+
+
 bool TextFile::nextLine(
     std::string & line)
 {
@@ -148,13 +252,23 @@ bool TextFile::nextLine(
     std::getline(m_stream,line);
   } catch (std::fstream::failure const & e) {
     // at eof
+    report();
     return false;
   }
 
   if (line.size() > 0 || !m_stream.eof()) {
     ++m_currentLine;
+
+    ++m_unreportedLines;
+    m_unreportedBytes += line.size()+1;
+    m_bytesSinceReset += line.size()+1;
+    if (m_unreportedBytes >= PROGRESS_BYTES) {
+      report();
+    }
+
     return true;
   } else {
+    report();
     return false;
   }
 }
@@ -164,6 +278,45 @@ void TextFile::setNextLine(
     std::string const & line)
 {
   m_stream << line << "\n";
+
+  // the line may be a buffer of several lines
+  m_unreportedLines += std::count(line.begin(), line.end(), '\n') + 1;
+  m_unreportedBytes += line.size()+1;
+  if (m_unreportedBytes >= PROGRESS_BYTES) {
+    report();
+  }
+}
+
+
+
+
+/******************************************************************************
+* PRIVATE FUNCTIONS ***********************************************************
+******************************************************************************/
+
+
+void TextFile::report()
+{
+  if (m_unreportedBytes > 0) {
+    // only reads count towards the progress of loads
+    if (m_state == FILE_STATE_READ) {
+      if (m_decompressBuffer != nullptr) {
+        size_t const consumed = m_decompressBuffer->getCompressedBytes();
+        ProgressMonitor::addCurrentBytes(consumed - m_reportedCompressedBytes);
+        m_reportedCompressedBytes = consumed;
+      } else {
+        ProgressMonitor::addCurrentBytes(m_unreportedBytes);
+      }
+    } else {
+      IOStats::addCurrentBytes(m_unreportedBytes);
+    }
+    m_unreportedBytes = 0;
+  }
+  if (m_unreportedLines > 0 || m_unreportedComments > 0) {
+    IOStats::addCurrentLines(m_unreportedLines, m_unreportedComments);
+    m_unreportedLines = 0;
+    m_unreportedComments = 0;
+  }
 }
 
 
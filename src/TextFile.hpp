@@ -20,8 +20,12 @@
 #include <string>
 #include <vector>
 #include <fstream>
+#include <memory>
+#include <streambuf>
 
 #include "Exception.hpp"
+#include "DecompressBuffer.hpp"
+#include "CompressBuffer.hpp"
 
 
 
@@ -34,7 +38,8 @@ class TextFile
 {
   public:
     /**
-     * @brief Match the given filename with the given extensions.
+     * @brief Match the given filename with the given extensions, ignoring a
+     * compression extension (e.g., "A.mtx.gz" matches ".mtx").
      *
      * @param f The filename.
      * @param extensions The extensions.
@@ -46,6 +51,17 @@ class TextFile
         std::vector<std::string> const & extensions);
 
 
+    /**
+     * @brief Get the size of a file on disk without opening it.
+     *
+     * @param name The filename/path.
+     *
+     * @return The number of bytes (0 if it cannot be determined).
+     */
+    static size_t getFileSize(
+        std::string const & name);
+
+
     /**
      * @brief Create a new text file from the given filename/path.
      *
@@ -91,13 +107,27 @@ class TextFile
 
 
     /**
-     * @brief Open the underlying file for writing.
+     * @brief Count the line last retrieved by nextLine() as a skipped
+     * comment.
+     */
+    void countComment() noexcept
+    {
+      ++m_unreportedComments;
+    }
+
+
+    /**
+     * @brief Open the underlying file for writing. Files named with a gzip
+     * or zstd extension, or any file if an output compression is set, are
+     * compressed in independent blocks (BGZF and zstd seekable files).
      */
     void openWrite();
 
 
     /**
-     * @brief Open the underlying file for writing.
+     * @brief Open the underlying file for reading. Files compressed with
+     * gzip, zstd, or xz (detected by their first bytes) are decompressed in
+     * the background as they are read.
      */
     void openRead();
 
@@ -108,6 +138,26 @@ class TextFile
     void resetStream();
 
 
+    /**
+     * @brief Move to the given position of the input stream.
+     *
+     * @param offset The byte offset to move to (must be the start of a
+     * line).
+     * @param line The number of lines preceding the offset.
+     */
+    void seek(
+        size_t offset,
+        size_t line);
+
+
+    /**
+     * @brief Get the position of the input stream.
+     *
+     * @return The byte offset of the next line to be read.
+     */
+    size_t tell();
+
+
     /**
      * @brief Get the current line in the file.
      *
@@ -148,16 +198,63 @@ class TextFile
     size_t m_currentLine;
 
 
+    /**
+     * @brief The number of bytes read but not yet reported to the progress
+     * monitor.
+     */
+    size_t m_unreportedBytes;
+
+
+    /**
+     * @brief The number of lines read or written, and of the lines read which
+     * were skipped as comments, not yet reported to the IOStats.
+     */
+    size_t m_unreportedLines;
+    size_t m_unreportedComments;
+
+
+    /**
+     * @brief The number of bytes read since the stream was last reset.
+     */
+    size_t m_bytesSinceReset;
+
+
     /**
      * @brief The filename/path of this file.
      */
     std::string m_name;
 
 
+    /**
+     * @brief The number of compressed bytes consumed, which were already
+     * reported to the progress monitor, and when the stream was last reset.
+     */
+    size_t m_reportedCompressedBytes;
+    size_t m_resetCompressedBytes;
+
+
+    /**
+     * @brief The buffer of the uncompressed file (or of the read backend
+     * reading it), or the decompressed contents of a compressed one, or the
+     * contents to compress.
+     */
+    std::filebuf m_fileBuffer;
+    std::unique_ptr<std::streambuf> m_readBuffer;
+    std::unique_ptr<DecompressBuffer> m_decompressBuffer;
+    std::unique_ptr<CompressBuffer> m_compressBuffer;
+
+
     /**
      * @brief The I/O stream for this file.
      */
-    std::fstream m_stream;
+    std::iostream m_stream;
+
+
+    /**
+     * @brief Report the bytes and lines read or written since the last
+     * report.
+     */
+    void report();
 
 
 
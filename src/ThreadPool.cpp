@@ -0,0 +1,664 @@
+/**
+ * @file ThreadPool.cpp
+ * @brief Implementation of the ThreadPool class.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-21
+ */
+
+
+
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+
+#include "ThreadPool.hpp"
+#include "CancelToken.hpp"
+#include "IOStats.hpp"
+#include "ProgressMonitor.hpp"
+#include "Tracer.hpp"
+
+
+
+
+/******************************************************************************
+* EXTERNAL SYMBOLS ************************************************************
+******************************************************************************/
+
+
+#if defined(__GNUC__) && !defined(_WIN32)
+/**
+* @brief The OpenMP runtime's check for being within a parallel region. It is
+* only resolved if the application links against an OpenMP runtime.
+*
+* @return Non-zero if called from within an active parallel region.
+*/
+extern "C" int omp_in_parallel(void) __attribute__((weak));
+#endif
+
+
+
+
+namespace WildRiver
+{
+
+
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+/**
+* @brief The most chunks to split a parallel loop into per thread.
+*/
+size_t const CHUNKS_PER_THREAD = 4;
+
+
+/**
+* @brief How long a thread waiting on a task group sleeps before checking
+* for queued tasks it could run.
+*/
+std::chrono::milliseconds const HELP_INTERVAL(1);
+
+
+/**
+* @brief The stages of a pipeline a thread counts for. Stages spend much of
+* their time waiting on each other, so a pipeline with a couple per thread
+* does not oversubscribe the processors.
+*/
+int const STAGES_PER_THREAD = 2;
+
+
+/**
+* @brief The stages a pipeline may have on top of those counted per thread,
+* for the serial stages which feed and drain the parallel ones.
+*/
+int const SERIAL_STAGES = 3;
+
+
+/**
+* @brief The pool whose worker is the calling thread, if any.
+*/
+thread_local ThreadPool const * currentPool = nullptr;
+
+
+/**
+* @brief The index of the worker which is the calling thread.
+*/
+thread_local int currentIndex = -1;
+
+
+}
+
+
+int const ThreadPool::MAX_THREADS = 1024;
+
+
+size_t const ThreadPool::MIN_SCAN_CHUNK = 65536;
+
+
+
+
+/******************************************************************************
+* HELPER FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+/**
+* @brief Check if the calling thread is within an OpenMP parallel region of
+* the application, in which case the other hardware threads are likely busy.
+*
+* @return True if within a parallel region.
+*/
+bool inOpenMPRegion()
+{
+#if defined(__GNUC__) && !defined(_WIN32)
+  return omp_in_parallel != nullptr && omp_in_parallel() != 0;
+#else
+  return false;
+#endif
+}
+
+
+}
+
+
+
+
+/******************************************************************************
+* PUBLIC STATIC FUNCTIONS *****************************************************
+******************************************************************************/
+
+
+ThreadPool & ThreadPool::getInstance()
+{
+  // constructed on first use, and joined at exit
+  static ThreadPool pool(0);
+
+  return pool;
+}
+
+
+int ThreadPool::getDefaultNumThreads()
+{
+  char const * const env = std::getenv("WILDRIVER_NUM_THREADS");
+  if (env != nullptr) {
+    int const numThreads = std::atoi(env);
+    if (numThreads > 0) {
+      return std::min(numThreads, MAX_THREADS);
+    }
+  }
+
+  return std::min(std::max( \
+      static_cast<int>(std::thread::hardware_concurrency()), 1), MAX_THREADS);
+}
+
+
+
+
+/******************************************************************************
+* CONSTRUCTORS / DESTRUCTOR ***************************************************
+******************************************************************************/
+
+
+ThreadPool::TaskGroup::TaskGroup(
+    ThreadPool & pool) :
+  m_pool(pool),
+  m_pending(0),
+  m_error(),
+  m_mutex(),
+  m_finished()
+{
+  // do nothing
+}
+
+
+ThreadPool::TaskGroup::~TaskGroup()
+{
+  try {
+    wait();
+  } catch (...) {
+    // the exception is only reported by an explicit wait
+  }
+}
+
+
+ThreadPool::ThreadPool(
+    int const numThreads) :
+  m_numThreads(0),
+  m_numActive(0),
+  m_numStarted(0),
+  m_numQueued(0),
+  m_stopping(false),
+  m_mutex(),
+  m_available(),
+  m_shared(),
+  m_workers(MAX_THREADS),
+  m_threads(),
+  m_numReservedStages(0),
+  m_stages(),
+  m_stageAvailable(),
+  m_stageReleased(),
+  m_stageThreads()
+{
+  setNumThreads(numThreads);
+}
+
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping.store(true);
+  }
+  m_available.notify_all();
+  m_stageAvailable.notify_all();
+
+  for (std::thread & thread : m_threads) {
+    thread.join();
+  }
+  for (std::thread & thread : m_stageThreads) {
+    thread.join();
+  }
+}
+
+
+
+
+/******************************************************************************
+* PUBLIC FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+void ThreadPool::TaskGroup::run(
+    std::function<void()> task)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_pending;
+  }
+
+  m_pool.push(capture([this, task]() {
+    try {
+      task();
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (!m_error) {
+        m_error = std::current_exception();
+      }
+    }
+
+    // notify while holding the lock, as the group may be destroyed as soon
+    // as the waiter sees no pending tasks
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (--m_pending == 0) {
+      m_finished.notify_all();
+    }
+  }, this));
+}
+
+
+void ThreadPool::TaskGroup::wait()
+{
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_pending == 0) {
+        break;
+      }
+    }
+
+    // only the group's own tasks are run, as others may block on this one
+    if (!m_pool.runQueued(this)) {
+      // the remaining tasks are running elsewhere
+      Tracer::Span span("pool", "wait");
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_finished.wait_for(lock, HELP_INTERVAL, [this]() {
+        return m_pending == 0;
+      });
+    }
+  }
+
+  std::exception_ptr error;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    error = m_error;
+    m_error = nullptr;
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+
+void ThreadPool::submit(
+    std::function<void()> task)
+{
+  task_struct queued;
+  queued.func = std::move(task);
+  push(std::move(queued));
+}
+
+
+void ThreadPool::setNumThreads(
+    int numThreads)
+{
+  if (numThreads <= 0) {
+    numThreads = getDefaultNumThreads();
+  }
+  numThreads = std::min(numThreads, MAX_THREADS);
+
+  // the calling thread takes part in parallel work, but background tasks
+  // still need a worker
+  int const numWorkers = std::max(numThreads-1, 1);
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_numThreads.store(numThreads);
+    m_numActive.store(numWorkers);
+    while (static_cast<int>(m_threads.size()) < numWorkers) {
+      int const index = static_cast<int>(m_threads.size());
+      m_workers[index].reset(new worker_struct);
+      m_numStarted.store(index+1);
+      m_threads.emplace_back(&ThreadPool::work, this, index);
+    }
+  }
+  m_available.notify_all();
+}
+
+
+void ThreadPool::parallelFor(
+    size_t const begin,
+    size_t const end,
+    size_t grain,
+    std::function<void(size_t, size_t)> const & func)
+{
+  if (end <= begin) {
+    return;
+  }
+
+  grain = std::max(grain, static_cast<size_t>(1));
+
+  size_t const size = end - begin;
+  size_t const numChunks = std::min((size + grain - 1) / grain, \
+      static_cast<size_t>(getNumThreads())*CHUNKS_PER_THREAD);
+
+  if (numChunks <= 1 || getNumThreads() <= 1 || inOpenMPRegion()) {
+    func(begin, end);
+    return;
+  }
+
+  TaskGroup group(*this);
+  for (size_t c = 1; c < numChunks; ++c) {
+    group.run([&func, begin, size, numChunks, c]() {
+      func(begin + (size*c) / numChunks, begin + (size*(c+1)) / numChunks);
+    });
+  }
+  func(begin, begin + size / numChunks);
+  group.wait();
+}
+
+
+int ThreadPool::getMaxStages() const noexcept
+{
+  // the application's threads are likely busy within an OpenMP region
+  int const numThreads = inOpenMPRegion() ? 1 : getNumThreads();
+
+  return STAGES_PER_THREAD*numThreads + SERIAL_STAGES;
+}
+
+
+void ThreadPool::runPipeline(
+    std::vector<std::function<void()>> const & stages)
+{
+  if (stages.empty()) {
+    return;
+  }
+
+  std::mutex mutex;
+  std::condition_variable finished;
+  size_t const numReserved = stages.size()-1;
+  size_t remaining = numReserved;
+
+  // the stages run while this thread waits, so its context outlives them
+  task_struct const context = capture(nullptr, nullptr);
+
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // wait for the stage threads to be free, so that pipelines run at once
+    // stay within the limit, but let a pipeline above it run on its own
+    size_t const maxReserved = static_cast<size_t>(getMaxStages()-1);
+    m_stageReleased.wait(lock, [this, numReserved, maxReserved]() {
+      return m_numReservedStages == 0 || \
+          m_numReservedStages + numReserved <= maxReserved;
+    });
+    m_numReservedStages += numReserved;
+
+    for (size_t i = 1; i < stages.size(); ++i) {
+      m_stages.emplace_back([&stages, &mutex, &finished, &remaining, \
+          &context, i]() {
+        task_struct stage = context;
+        stage.func = stages[i];
+        execute(stage);
+
+        std::lock_guard<std::mutex> stageLock(mutex);
+        if (--remaining == 0) {
+          finished.notify_all();
+        }
+      });
+    }
+
+    // every stage must be running at once, and threads left by earlier
+    // pipelines are reused, as every reserved stage frees its thread
+    while (m_stageThreads.size() < m_numReservedStages) {
+      m_stageThreads.emplace_back(&ThreadPool::runStages, this);
+    }
+  }
+  m_stageAvailable.notify_all();
+
+  stages[0]();
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [&remaining]() {
+      return remaining == 0;
+    });
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_numReservedStages -= numReserved;
+  }
+  m_stageReleased.notify_all();
+}
+
+
+
+
+/******************************************************************************
+* PRIVATE STATIC FUNCTIONS ****************************************************
+******************************************************************************/
+
+
+ThreadPool::task_struct ThreadPool::capture(
+    std::function<void()> func,
+    TaskGroup const * const group)
+{
+  task_struct task;
+  task.func = std::move(func);
+  task.group = group;
+  task.token = CancelToken::getCurrent();
+  task.monitor = ProgressMonitor::getCurrent();
+  task.stats = IOStats::getCurrent();
+
+  return task;
+}
+
+
+void ThreadPool::execute(
+    task_struct & task)
+{
+  // replaces whatever the running thread had installed, including nothing
+  CancelToken::Scope token(task.token);
+  ProgressMonitor::Scope monitor(task.monitor);
+  IOStats::Scope stats(task.stats);
+
+  task.func();
+}
+
+
+bool ThreadPool::takeFrom(
+    worker_struct & queue,
+    bool const newest,
+    TaskGroup const * const group,
+    task_struct * const task)
+{
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.tasks.empty()) {
+    return false;
+  }
+
+  if (group == nullptr) {
+    if (newest) {
+      *task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+    } else {
+      *task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    }
+    return true;
+  }
+
+  size_t const size = queue.tasks.size();
+  for (size_t i = 0; i < size; ++i) {
+    size_t const position = newest ? size - 1 - i : i;
+    if (queue.tasks[position].group == group) {
+      *task = std::move(queue.tasks[position]);
+      queue.tasks.erase(queue.tasks.begin() + \
+          static_cast<std::ptrdiff_t>(position));
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+
+
+/******************************************************************************
+* PRIVATE FUNCTIONS ***********************************************************
+******************************************************************************/
+
+
+void ThreadPool::push(
+    task_struct task)
+{
+  worker_struct * queue = &m_shared;
+  if (currentPool == this) {
+    queue = m_workers[currentIndex].get();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    queue->tasks.emplace_back(std::move(task));
+    ++m_numQueued;
+  }
+
+  // pass through the lock so the wakeup cannot be missed by a worker about
+  // to sleep
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+  }
+  if (m_numActive.load() < m_numStarted.load()) {
+    // a sleeping worker beyond the number of threads might be the one woken
+    m_available.notify_all();
+  } else {
+    m_available.notify_one();
+  }
+}
+
+
+bool ThreadPool::take(
+    int const index,
+    TaskGroup const * const group,
+    task_struct * const task)
+{
+  if (m_numQueued.load() == 0) {
+    return false;
+  }
+
+  // newest first from our own queue
+  if (index >= 0 && takeFrom(*m_workers[index], true, group, task)) {
+    --m_numQueued;
+    return true;
+  }
+
+  // oldest first from the shared queue and the other workers
+  if (takeFrom(m_shared, false, group, task)) {
+    --m_numQueued;
+    return true;
+  }
+
+  int const numStarted = m_numStarted.load();
+  for (int i = 1; i <= numStarted; ++i) {
+    int const victim = (index + i) % numStarted;
+    if (victim == index) {
+      continue;
+    }
+
+    if (takeFrom(*m_workers[victim], false, group, task)) {
+      --m_numQueued;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+bool ThreadPool::runQueued(
+    TaskGroup const * const group)
+{
+  int const index = currentPool == this ? currentIndex : -1;
+
+  task_struct task;
+  if (!take(index, group, &task)) {
+    return false;
+  }
+
+  Tracer::Span span("pool", "task");
+  execute(task);
+
+  return true;
+}
+
+
+void ThreadPool::work(
+    int const index)
+{
+  currentPool = this;
+  currentIndex = index;
+  Tracer::setThreadName("worker", index);
+
+  while (true) {
+    // workers beyond the number of threads only help drain the queues when
+    // stopping
+    task_struct task;
+    if ((index < m_numActive.load() || m_stopping.load()) && \
+        take(index, nullptr, &task)) {
+      Tracer::Span span("pool", "task");
+      execute(task);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_stopping.load() && m_numQueued.load() == 0) {
+      // only reached once the remaining tasks have run
+      return;
+    }
+    m_available.wait(lock, [this, index]() {
+      return m_stopping.load() || \
+          (m_numQueued.load() > 0 && index < m_numActive.load());
+    });
+  }
+}
+
+
+void ThreadPool::runStages()
+{
+  Tracer::setThreadName("stage");
+
+  while (true) {
+    std::function<void()> stage;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_stageAvailable.wait(lock, [this]() {
+        return m_stopping.load() || !m_stages.empty();
+      });
+      if (m_stages.empty()) {
+        return;
+      }
+      stage = std::move(m_stages.front());
+      m_stages.pop_front();
+    }
+
+    stage();
+  }
+}
+
+
+
+
+}
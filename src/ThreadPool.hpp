@@ -0,0 +1,519 @@
+/**
+ * @file ThreadPool.hpp
+ * @brief The work-stealing pool of threads shared by the library for running
+ * tasks in the background and in parallel.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-21
+ */
+
+
+
+
+#ifndef WILDRIVER_THREADPOOL_HPP
+#define WILDRIVER_THREADPOOL_HPP
+
+
+
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Tracer.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+class CancelToken;
+class IOStats;
+class ProgressMonitor;
+
+
+/**
+* @brief A set of worker threads which run submitted tasks, each worker
+* keeping its own queue of tasks and stealing from the others when it runs
+* out. Tasks submitted by a worker go to its own queue and are run newest
+* first, while tasks submitted from other threads go to a shared queue and
+* are run oldest first. Threads waiting on a TaskGroup run the group's queued
+* tasks while they wait, so parallel loops may be nested and may be started
+* from any number of application threads at once.
+*
+* The tasks of a group, and the stages of a pipeline, run with the cancel
+* token, progress monitor, and stats which were current for the thread that
+* added them, whichever thread runs them. Tasks submitted on their own run
+* with none, as the thread submitting them may have moved on by the time
+* they run.
+*
+* The library shares a single pool, which is started the first time it is
+* used, and whose size is taken from the WILDRIVER_NUM_THREADS environment
+* variable if it is set. Idle workers sleep rather than spin, and parallel
+* loops started from within an OpenMP parallel region run serially, so that
+* the pool does not compete with the application's own threads.
+*/
+class ThreadPool
+{
+  public:
+    /**
+    * @brief A set of tasks which can be waited on together.
+    */
+    class TaskGroup
+    {
+      public:
+        /**
+        * @brief Create a new empty group.
+        *
+        * @param pool The pool to run the tasks on.
+        */
+        TaskGroup(
+            ThreadPool & pool);
+
+
+        /**
+        * @brief Wait for the remaining tasks to finish, ignoring any
+        * exceptions they threw.
+        */
+        ~TaskGroup();
+
+
+        /**
+        * @brief Deleted copy constructor.
+        *
+        * @param rhs The group to copy.
+        */
+        TaskGroup(
+            TaskGroup const & rhs) = delete;
+
+
+        /**
+        * @brief Deleted assignment operator.
+        *
+        * @param rhs The group to copy.
+        *
+        * @return This group.
+        */
+        TaskGroup & operator=(
+            TaskGroup const & rhs) = delete;
+
+
+        /**
+        * @brief Add a task to the group.
+        *
+        * @param task The task.
+        */
+        void run(
+            std::function<void()> task);
+
+
+        /**
+        * @brief Run the queued tasks of the group until all of its tasks
+        * have finished.
+        *
+        * @throw The first exception thrown by a task of the group.
+        */
+        void wait();
+
+
+      private:
+        ThreadPool & m_pool;
+        size_t m_pending;
+        std::exception_ptr m_error;
+        std::mutex m_mutex;
+        std::condition_variable m_finished;
+    };
+
+
+    /**
+    * @brief The most threads a pool can run parallel work with.
+    */
+    static int const MAX_THREADS;
+
+
+    /**
+    * @brief The fewest elements worth giving to a task of a parallel prefix
+    * sum.
+    */
+    static size_t const MIN_SCAN_CHUNK;
+
+
+    /**
+    * @brief Get the pool shared by the library.
+    *
+    * @return The pool.
+    */
+    static ThreadPool & getInstance();
+
+
+    /**
+    * @brief Get the number of threads the shared pool starts with: the value
+    * of the WILDRIVER_NUM_THREADS environment variable if it is set, and
+    * otherwise the number of hardware threads.
+    *
+    * @return The number of threads.
+    */
+    static int getDefaultNumThreads();
+
+
+    /**
+    * @brief Create a new pool.
+    *
+    * @param numThreads The number of threads to run parallel work with,
+    * including the thread which starts it (0 for the default). At least one
+    * worker is always started so that tasks can run in the background.
+    */
+    ThreadPool(
+        int numThreads);
+
+
+    /**
+    * @brief Wait for the submitted tasks to finish and stop the workers.
+    */
+    ~ThreadPool();
+
+
+    /**
+    * @brief Deleted copy constructor.
+    *
+    * @param rhs The pool to copy.
+    */
+    ThreadPool(
+        ThreadPool const & rhs) = delete;
+
+
+    /**
+    * @brief Deleted assignment operator.
+    *
+    * @param rhs The pool to copy.
+    *
+    * @return This pool.
+    */
+    ThreadPool & operator=(
+        ThreadPool const & rhs) = delete;
+
+
+    /**
+    * @brief Add a task to be run by one of the workers, with no cancel
+    * token, progress monitor, or stats installed. Exceptions must not escape
+    * the task.
+    *
+    * @param task The task.
+    */
+    void submit(
+        std::function<void()> task);
+
+
+    /**
+    * @brief Change the number of threads to run parallel work with. Workers
+    * are started as needed, and workers beyond the new number finish their
+    * current task and then sleep. This is safe to call while the pool is in
+    * use.
+    *
+    * @param numThreads The number of threads (0 for the default).
+    */
+    void setNumThreads(
+        int numThreads);
+
+
+    /**
+    * @brief Get the number of threads to run parallel work with.
+    *
+    * @return The number of threads.
+    */
+    int getNumThreads() const noexcept
+    {
+      return m_numThreads.load();
+    }
+
+
+    /**
+    * @brief Run a function over a range in parallel, blocking until it
+    * finishes. The range is split into equal chunks, at most a few per
+    * thread, and about the grain or more in size. The calling thread runs
+    * the first chunk itself. Loops started from within an OpenMP parallel
+    * region, or on a pool of one thread, run serially.
+    *
+    * @param begin The start of the range.
+    * @param end The end of the range (exclusive).
+    * @param grain The fewest elements worth giving to a chunk.
+    * @param func The function, taking the start and end of a chunk.
+    *
+    * @throw The first exception thrown by the function.
+    */
+    void parallelFor(
+        size_t begin,
+        size_t end,
+        size_t grain,
+        std::function<void(size_t, size_t)> const & func);
+
+
+    /**
+    * @brief Replace each element of an array with the sum of it and the
+    * elements preceding it, in parallel.
+    *
+    * @tparam T The type of element.
+    * @param data The array.
+    * @param size The number of elements.
+    */
+    template<typename T>
+    void prefixSum(
+        T * const data,
+        size_t const size)
+    {
+      Tracer::Span span("pool", "prefix sum");
+
+      size_t const numChunks = std::min( \
+          static_cast<size_t>(getNumThreads()), size / MIN_SCAN_CHUNK);
+      if (numChunks <= 1) {
+        for (size_t i = 1; i < size; ++i) {
+          data[i] += data[i-1];
+        }
+        return;
+      }
+
+      // scan each chunk independently
+      std::vector<T> offsets(numChunks, 0);
+      parallelFor(0, numChunks, 1, [&](size_t const first, \
+          size_t const last) {
+        for (size_t c = first; c < last; ++c) {
+          size_t const start = (size*c) / numChunks;
+          size_t const end = (size*(c+1)) / numChunks;
+          for (size_t i = start+1; i < end; ++i) {
+            data[i] += data[i-1];
+          }
+          offsets[c] = data[end-1];
+        }
+      });
+
+      // offset each chunk by the totals of the chunks before it
+      for (size_t c = 1; c < numChunks; ++c) {
+        offsets[c] += offsets[c-1];
+      }
+      parallelFor(1, numChunks, 1, [&](size_t const first, \
+          size_t const last) {
+        for (size_t c = first; c < last; ++c) {
+          size_t const start = (size*c) / numChunks;
+          size_t const end = (size*(c+1)) / numChunks;
+          T const offset = offsets[c-1];
+          for (size_t i = start; i < end; ++i) {
+            data[i] += offset;
+          }
+        }
+      });
+    }
+
+
+    /**
+    * @brief Get the most stages a pipeline run by the calling thread may
+    * have without oversubscribing the processors, which is a couple per
+    * thread plus a few serial stages, or as if the pool had a single thread
+    * within an OpenMP parallel region.
+    *
+    * @return The number of stages.
+    */
+    int getMaxStages() const noexcept;
+
+
+    /**
+    * @brief Run the stages of a pipeline, which block waiting on each
+    * other, each on its own thread, blocking until all have finished. The
+    * calling thread runs the first stage. The stage threads are kept by the
+    * pool and reused, and pipelines run at once share the limit of
+    * getMaxStages(), later ones waiting for the stage threads of earlier
+    * ones to be freed. A pipeline with more stages than the limit waits to
+    * run on its own. Exceptions must not escape the stages.
+    *
+    * @param stages The stages.
+    */
+    void runPipeline(
+        std::vector<std::function<void()>> const & stages);
+
+
+  private:
+    /**
+    * @brief A queued task, with the group it belongs to and what to install
+    * for the calling thread while it runs.
+    */
+    struct task_struct
+    {
+      task_struct() :
+        func(),
+        group(nullptr),
+        token(nullptr),
+        monitor(nullptr),
+        stats(nullptr)
+      {
+        // do nothing
+      }
+
+      // the pointers are not owned, so copies share them
+      task_struct(
+          task_struct const & rhs) = default;
+      task_struct(
+          task_struct && rhs) = default;
+      task_struct & operator=(
+          task_struct const & rhs) = default;
+      task_struct & operator=(
+          task_struct && rhs) = default;
+
+      std::function<void()> func;
+      TaskGroup const * group;
+      CancelToken const * token;
+      ProgressMonitor * monitor;
+      IOStats * stats;
+    };
+
+
+    /**
+    * @brief The queue of tasks of a single worker.
+    */
+    struct worker_struct
+    {
+      worker_struct() :
+        mutex(),
+        tasks()
+      {
+        // do nothing
+      }
+
+      std::mutex mutex;
+      std::deque<task_struct> tasks;
+    };
+
+
+    std::atomic<int> m_numThreads;
+    std::atomic<int> m_numActive;
+    std::atomic<int> m_numStarted;
+    std::atomic<size_t> m_numQueued;
+    std::atomic<bool> m_stopping;
+    std::mutex m_mutex;
+    std::condition_variable m_available;
+    worker_struct m_shared;
+    // sized for the most workers up front, so that it is never resized while
+    // being searched for tasks to steal
+    std::vector<std::unique_ptr<worker_struct>> m_workers;
+    std::vector<std::thread> m_threads;
+    size_t m_numReservedStages;
+    std::deque<std::function<void()>> m_stages;
+    std::condition_variable m_stageAvailable;
+    std::condition_variable m_stageReleased;
+    std::vector<std::thread> m_stageThreads;
+
+
+    /**
+    * @brief Create a task which runs with the cancel token, progress monitor,
+    * and stats of the calling thread.
+    *
+    * @param func The function of the task.
+    * @param group The group of the task (may be null).
+    *
+    * @return The task.
+    */
+    static task_struct capture(
+        std::function<void()> func,
+        TaskGroup const * group);
+
+
+    /**
+    * @brief Run a task, with its cancel token, progress monitor, and stats
+    * installed.
+    *
+    * @param task The task.
+    */
+    static void execute(
+        task_struct & task);
+
+
+    /**
+    * @brief Take a task from a queue.
+    *
+    * @param queue The queue.
+    * @param newest Whether to take the newest task rather than the oldest.
+    * @param group The group the task must belong to (null for any).
+    * @param task The task (output).
+    *
+    * @return True if a task was taken.
+    */
+    static bool takeFrom(
+        worker_struct & queue,
+        bool newest,
+        TaskGroup const * group,
+        task_struct * task);
+
+
+    /**
+    * @brief Add a task to the queue of the calling worker, or to the shared
+    * queue if the calling thread is not a worker of this pool.
+    *
+    * @param task The task.
+    */
+    void push(
+        task_struct task);
+
+
+    /**
+    * @brief Take a task to run, first from the calling worker's own queue,
+    * then from the shared queue, and then from the other workers.
+    *
+    * @param index The index of the calling worker (-1 for other threads).
+    * @param group The group the task must belong to (null for any).
+    * @param task The task (output).
+    *
+    * @return True if a task was taken.
+    */
+    bool take(
+        int index,
+        TaskGroup const * group,
+        task_struct * task);
+
+
+    /**
+    * @brief Run a single queued task of a group, if there is one.
+    *
+    * @param group The group.
+    *
+    * @return True if a task was run.
+    */
+    bool runQueued(
+        TaskGroup const * group);
+
+
+    /**
+    * @brief Run tasks until the pool is stopped.
+    *
+    * @param index The index of the worker.
+    */
+    void work(
+        int index);
+
+
+    /**
+    * @brief Run pipeline stages until the pool is stopped.
+    */
+    void runStages();
+
+
+
+
+};
+
+
+
+
+}
+
+
+
+
+#endif
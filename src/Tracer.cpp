@@ -0,0 +1,397 @@
+/**
+ * @file Tracer.cpp
+ * @brief Implementation of the Tracer class.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-27
+ */
+
+
+
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Tracer.hpp"
+#include "Exception.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/******************************************************************************
+* HELPER FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+/**
+ * @brief A complete event.
+ */
+struct event_struct
+{
+  char const * category;
+  char const * name;
+  int64_t id;
+  int64_t start;
+  int64_t end;
+};
+
+
+/**
+ * @brief The events of a single thread. Only the owning thread appends
+ * events, publishing each by incrementing the size.
+ */
+struct buffer_struct
+{
+  buffer_struct(
+      int const tid,
+      char const * const name,
+      int const index) :
+    tid(tid),
+    name(name),
+    index(index),
+    size(0),
+    dropped(0),
+    events(new event_struct[Tracer::BUFFER_EVENTS])
+  {
+    // do nothing
+  }
+
+  buffer_struct(
+      buffer_struct const & rhs) = delete;
+  buffer_struct & operator=(
+      buffer_struct const & rhs) = delete;
+
+  int tid;
+  char const * name;
+  int index;
+  std::atomic<size_t> size;
+  std::atomic<size_t> dropped;
+  std::unique_ptr<event_struct[]> events;
+};
+
+
+/**
+ * @brief The buffers of all threads which have recorded events. The buffer of
+ * a thread which exits keeps its events, and is handed to the next thread
+ * needing one, so that there are only ever as many buffers as threads
+ * recording at once. They are never freed, as threads may record events
+ * while the program exits.
+ */
+struct registry_struct
+{
+  registry_struct() :
+    mutex(),
+    buffers(),
+    unused(),
+    epoch(Util::now())
+  {
+    // do nothing
+  }
+
+  std::mutex mutex;
+  std::vector<std::unique_ptr<buffer_struct>> buffers;
+  std::vector<buffer_struct*> unused;
+  int64_t epoch;
+};
+
+
+/**
+ * @brief The buffer of a thread, which is returned to the registry when the
+ * thread exits.
+ */
+struct owner_struct
+{
+  owner_struct() :
+    buffer(nullptr)
+  {
+    // do nothing
+  }
+
+  owner_struct(
+      owner_struct const & rhs) = delete;
+  owner_struct & operator=(
+      owner_struct const & rhs) = delete;
+
+  ~owner_struct();
+
+  buffer_struct * buffer;
+};
+
+
+/**
+ * @brief The buffer of each thread, once it has recorded an event.
+ */
+thread_local owner_struct currentOwner;
+
+
+/**
+ * @brief Whether the thread has returned its buffer as it exits, after which
+ * its events are dropped.
+ */
+thread_local bool threadExited = false;
+
+
+/**
+ * @brief The name of each thread and its index.
+ */
+thread_local char const * threadName = nullptr;
+thread_local int threadIndex = -1;
+
+
+/**
+ * @brief Get the registry of buffers.
+ *
+ * @return The registry.
+ */
+registry_struct & getRegistry()
+{
+  static registry_struct * const registry = new registry_struct;
+  return *registry;
+}
+
+
+/**
+ * @brief Get the buffer of the calling thread, creating it if needed.
+ *
+ * @return The buffer.
+ */
+buffer_struct * getBuffer()
+{
+  if (threadExited) {
+    return nullptr;
+  }
+
+  buffer_struct *& buffer = currentOwner.buffer;
+  if (buffer == nullptr) {
+    registry_struct & registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    if (!registry.unused.empty()) {
+      // the track keeps the events of the threads which used it before
+      buffer = registry.unused.back();
+      registry.unused.pop_back();
+      buffer->name = threadName;
+      buffer->index = threadIndex;
+    } else {
+      int const tid = static_cast<int>(registry.buffers.size())+1;
+      registry.buffers.emplace_back(new buffer_struct(tid, threadName, \
+          threadIndex));
+      buffer = registry.buffers.back().get();
+    }
+  }
+
+  return buffer;
+}
+
+
+owner_struct::~owner_struct()
+{
+  threadExited = true;
+  if (buffer != nullptr) {
+    registry_struct & registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.unused.emplace_back(buffer);
+  }
+}
+
+
+/**
+ * @brief Write a time as microseconds since the start of the trace.
+ *
+ * @param stream The stream to write to.
+ * @param nanoseconds The time.
+ */
+void writeMicroseconds(
+    std::ostream & stream,
+    int64_t const nanoseconds)
+{
+  stream << (nanoseconds / 1000) << "." << std::setw(3) << \
+      std::setfill('0') << (nanoseconds % 1000) << std::setfill(' ');
+}
+
+
+}
+
+
+
+
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+
+size_t const Tracer::BUFFER_EVENTS = 1 << 16;
+
+
+std::atomic<bool> Tracer::s_enabled(false);
+
+
+
+
+/******************************************************************************
+* PUBLIC STATIC FUNCTIONS *****************************************************
+******************************************************************************/
+
+
+void Tracer::setEnabled(
+    bool const enabled) noexcept
+{
+  // fix the start of the trace before any event is recorded
+  getRegistry();
+
+  s_enabled.store(enabled);
+}
+
+
+void Tracer::clear() noexcept
+{
+  registry_struct & registry = getRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (std::unique_ptr<buffer_struct> const & buffer : registry.buffers) {
+    buffer->size.store(0);
+    buffer->dropped.store(0);
+  }
+}
+
+
+void Tracer::setThreadName(
+    char const * const name,
+    int const index) noexcept
+{
+  threadName = name;
+  threadIndex = index;
+
+  buffer_struct * const buffer = threadExited ? nullptr : \
+      currentOwner.buffer;
+  if (buffer != nullptr) {
+    registry_struct & registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    buffer->name = name;
+    buffer->index = index;
+  }
+}
+
+
+void Tracer::record(
+    char const * const category,
+    char const * const name,
+    int64_t const id,
+    int64_t const start,
+    int64_t const end) noexcept
+{
+  buffer_struct * buffer;
+  try {
+    buffer = getBuffer();
+  } catch (std::exception const &) {
+    // tracing must never fail the traced work
+    return;
+  }
+  if (buffer == nullptr) {
+    return;
+  }
+
+  size_t const size = buffer->size.load(std::memory_order_relaxed);
+  if (size >= BUFFER_EVENTS) {
+    buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  buffer->events[size] = event_struct{category, name, id, start, end};
+  buffer->size.store(size+1, std::memory_order_release);
+}
+
+
+void Tracer::write(
+    std::ostream & stream)
+{
+  registry_struct & registry = getRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+
+  stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+  bool first = true;
+  for (std::unique_ptr<buffer_struct> const & buffer : registry.buffers) {
+    size_t const size = buffer->size.load(std::memory_order_acquire);
+    size_t const dropped = buffer->dropped.load(std::memory_order_relaxed);
+
+    stream << (first ? "" : ",") << "\n{\"name\":\"thread_name\"," \
+        "\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid << \
+        ",\"args\":{\"name\":\"";
+    if (buffer->name != nullptr) {
+      stream << buffer->name;
+      if (buffer->index >= 0) {
+        stream << " " << buffer->index;
+      }
+    } else {
+      stream << "thread " << buffer->tid;
+    }
+    stream << "\"}}";
+    first = false;
+
+    for (size_t i = 0; i < size; ++i) {
+      event_struct const & event = buffer->events[i];
+
+      // events started before tracing was first enabled are cut short
+      int64_t const start = std::max(event.start, registry.epoch);
+      int64_t const end = std::max(event.end, start);
+
+      stream << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"" << \
+          event.category << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << \
+          buffer->tid << ",\"ts\":";
+      writeMicroseconds(stream, start - registry.epoch);
+      stream << ",\"dur\":";
+      writeMicroseconds(stream, end - start);
+      if (event.id >= 0) {
+        stream << ",\"args\":{\"id\":" << event.id << "}";
+      }
+      stream << "}";
+    }
+
+    if (dropped > 0) {
+      // mark where the buffer filled up
+      stream << ",\n{\"name\":\"dropped " << dropped << " events\"," \
+          "\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":" << buffer->tid << \
+          ",\"ts\":";
+      writeMicroseconds(stream, size > 0 ? std::max(buffer->events[size-1].end \
+          - registry.epoch, static_cast<int64_t>(0)) : 0);
+      stream << "}";
+    }
+  }
+
+  stream << "\n]}\n";
+}
+
+
+void Tracer::dump(
+    std::string const & filename)
+{
+  std::ofstream stream(filename);
+  if (!stream) {
+    throw BadFileException(std::string("Failed to open trace file '") + \
+        filename + std::string("' for writing."));
+  }
+
+  write(stream);
+
+  if (!stream) {
+    throw BadFileException(std::string("Failed to write trace file '") + \
+        filename + std::string("'."));
+  }
+}
+
+
+
+
+}
@@ -0,0 +1,212 @@
+/**
+ * @file Tracer.hpp
+ * @brief Recording of timed events in the Chrome trace format.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-27
+ */
+
+
+
+
+#ifndef WILDRIVER_TRACER_HPP
+#define WILDRIVER_TRACER_HPP
+
+
+
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include "Util.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/**
+ * @brief Records the timelines of the threads of loads, writes, and the
+ * thread pool, for viewing in chrome://tracing or Perfetto. Each thread
+ * appends its events to its own buffer without locking, and the buffers are
+ * written out together as Chrome trace JSON. The buffer of a thread which
+ * exits is reused by the next thread to record, so a track may hold the
+ * events of several short lived threads one after another. When tracing is
+ * disabled, recording an event costs a single relaxed atomic load.
+ */
+class Tracer
+{
+  public:
+    /**
+     * @brief The number of events each buffer can hold before further
+     * events are dropped.
+     */
+    static size_t const BUFFER_EVENTS;
+
+
+    /**
+     * @brief Records the time between its creation and destruction (or the
+     * call to end()) as an event of the calling thread, if tracing was
+     * enabled when it was created.
+     */
+    class Span
+    {
+      public:
+        /**
+         * @brief Start the event.
+         *
+         * @param category The category of the event (must be a string
+         * literal).
+         * @param name The name of the event (must be a string literal).
+         * @param id An identifier of the work (e.g., a chunk index), or -1
+         * for none.
+         */
+        Span(
+            char const * const category,
+            char const * const name,
+            int64_t const id = -1) noexcept :
+          m_category(category),
+          m_name(name),
+          m_id(id),
+          m_start(isEnabled() ? Util::now() : -1)
+        {
+          // do nothing
+        }
+
+
+        /**
+         * @brief End the event if it has not already ended.
+         */
+        ~Span()
+        {
+          end();
+        }
+
+
+        /**
+         * @brief End the event early.
+         */
+        void end() noexcept
+        {
+          if (m_start >= 0) {
+            record(m_category, m_name, m_id, m_start, Util::now());
+            m_start = -1;
+          }
+        }
+
+
+      private:
+        char const * m_category;
+        char const * m_name;
+        int64_t m_id;
+        int64_t m_start;
+
+        // disable copying
+        Span(
+            Span const & rhs);
+        Span & operator=(
+            Span const & rhs);
+    };
+
+
+    /**
+     * @brief Check whether tracing is enabled.
+     *
+     * @return True if events are being recorded.
+     */
+    static bool isEnabled() noexcept
+    {
+      return s_enabled.load(std::memory_order_relaxed);
+    }
+
+
+    /**
+     * @brief Enable or disable the recording of events. Events already
+     * recorded are kept.
+     *
+     * @param enabled True to record events.
+     */
+    static void setEnabled(
+        bool enabled) noexcept;
+
+
+    /**
+     * @brief Discard all recorded events. No thread may be recording events
+     * at the time.
+     */
+    static void clear() noexcept;
+
+
+    /**
+     * @brief Name the calling thread in the trace.
+     *
+     * @param name The name (must be a string literal).
+     * @param index The index of the thread among those of the same name, or
+     * -1 for none.
+     */
+    static void setThreadName(
+        char const * name,
+        int index = -1) noexcept;
+
+
+    /**
+     * @brief Record a complete event of the calling thread.
+     *
+     * @param category The category of the event (must be a string literal).
+     * @param name The name of the event (must be a string literal).
+     * @param id An identifier of the work, or -1 for none.
+     * @param start The time the event started.
+     * @param end The time the event ended.
+     */
+    static void record(
+        char const * category,
+        char const * name,
+        int64_t id,
+        int64_t start,
+        int64_t end) noexcept;
+
+
+    /**
+     * @brief Write the recorded events of all threads as Chrome trace JSON.
+     * Threads may keep recording events while they are written, but only
+     * those recorded before are included.
+     *
+     * @param stream The stream to write to.
+     */
+    static void write(
+        std::ostream & stream);
+
+
+    /**
+     * @brief Write the recorded events of all threads to a file.
+     *
+     * @param filename The file to write.
+     *
+     * @throw BadFileException If the file cannot be written.
+     */
+    static void dump(
+        std::string const & filename);
+
+
+  private:
+    static std::atomic<bool> s_enabled;
+
+
+
+
+};
+
+
+
+
+}
+
+
+
+
+#endif
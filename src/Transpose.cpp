@@ -0,0 +1,188 @@
+/**
+ * @file Transpose.cpp
+ * @brief Implementation of the Transpose class.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-11
+ */
+
+
+
+
+#include <algorithm>
+#include <vector>
+
+
+#include "Transpose.hpp"
+#include "ThreadPool.hpp"
+#include "Tracer.hpp"
+
+
+
+
+namespace WildRiver
+{
+
+
+/******************************************************************************
+* CONSTANTS *******************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+/**
+* @brief The fewest non-zeros worth giving to a thread.
+*/
+ind_t const MIN_NNZ_PER_THREAD = 65536;
+
+
+}
+
+
+
+
+/******************************************************************************
+* HELPER FUNCTIONS ************************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+/**
+* @brief Run the given function for each of the pieces of work as a separate
+* task of the library's thread pool, with the calling thread running the
+* first.
+*
+* @tparam F The type of function.
+* @param numThreads The number of pieces of work.
+* @param func The function, taking the piece id.
+*/
+template<typename F>
+void runThreads(
+    int const numThreads,
+    F const & func)
+{
+  ThreadPool::getInstance().parallelFor(0, numThreads, 1, \
+      [&func](size_t const begin, size_t const end) {
+    for (size_t t = begin; t < end; ++t) {
+      Tracer::Span span("build", "transpose", static_cast<int64_t>(t));
+      func(static_cast<int>(t));
+    }
+  });
+}
+
+
+}
+
+
+
+
+/******************************************************************************
+* PUBLIC STATIC FUNCTIONS *****************************************************
+******************************************************************************/
+
+
+void Transpose::csrToCsc(
+    dim_t const nrows,
+    dim_t const ncols,
+    ind_t const * const rowptr,
+    dim_t const * const rowind,
+    val_t const * const rowval,
+    ind_t * const colptr,
+    dim_t * const colind,
+    val_t * const colval,
+    int numThreads)
+{
+  ind_t const nnz = rowptr[nrows];
+
+  ThreadPool & pool = ThreadPool::getInstance();
+
+  if (numThreads <= 0) {
+    numThreads = pool.getNumThreads();
+  }
+  // avoid threads with too little work, and keep the histograms from
+  // dwarfing the matrix
+  numThreads = static_cast<int>(std::min(static_cast<ind_t>(numThreads), \
+      std::max(std::min(nnz / MIN_NNZ_PER_THREAD, \
+      (4*nnz) / (static_cast<ind_t>(ncols)+1)), static_cast<ind_t>(1))));
+
+  // split the rows by non-zeros
+  std::vector<dim_t> rowStart(numThreads+1);
+  for (int t = 0; t <= numThreads; ++t) {
+    ind_t const target = (nnz*t) / numThreads;
+    rowStart[t] = static_cast<dim_t>(std::lower_bound(rowptr, \
+        rowptr+nrows+1, target) - rowptr);
+  }
+  rowStart[0] = 0;
+  rowStart[numThreads] = nrows;
+
+  // split the columns evenly for the prefix sum
+  std::vector<dim_t> colStart(numThreads+1);
+  for (int t = 0; t <= numThreads; ++t) {
+    colStart[t] = static_cast<dim_t>((static_cast<ind_t>(ncols)*t) / \
+        numThreads);
+  }
+
+  // each thread's histogram of columns, which become its insertion points
+  std::vector<ind_t> counts(static_cast<size_t>(numThreads)*ncols, 0);
+
+  // histogram
+  runThreads(numThreads, [&](int const t) {
+    ind_t * const myCounts = counts.data() + static_cast<size_t>(t)*ncols;
+    for (ind_t j = rowptr[rowStart[t]]; j < rowptr[rowStart[t+1]]; ++j) {
+      ++myCounts[rowind[j]];
+    }
+  });
+
+  // column totals
+  runThreads(numThreads, [&](int const t) {
+    for (dim_t c = colStart[t]; c < colStart[t+1]; ++c) {
+      ind_t sum = 0;
+      for (int o = 0; o < numThreads; ++o) {
+        sum += counts[static_cast<size_t>(o)*ncols + c];
+      }
+      colptr[c+1] = sum;
+    }
+  });
+
+  colptr[0] = 0;
+  pool.prefixSum(colptr, static_cast<size_t>(ncols)+1);
+
+  // insertion points
+  runThreads(numThreads, [&](int const t) {
+    for (dim_t c = colStart[t]; c < colStart[t+1]; ++c) {
+      ind_t offset = colptr[c];
+      for (int o = 0; o < numThreads; ++o) {
+        ind_t & count = counts[static_cast<size_t>(o)*ncols + c];
+        ind_t const size = count;
+        count = offset;
+        offset += size;
+      }
+    }
+  });
+
+  // scatter
+  runThreads(numThreads, [&](int const t) {
+    ind_t * const myOffsets = counts.data() + static_cast<size_t>(t)*ncols;
+    for (dim_t r = rowStart[t]; r < rowStart[t+1]; ++r) {
+      for (ind_t j = rowptr[r]; j < rowptr[r+1]; ++j) {
+        ind_t const dest = myOffsets[rowind[j]]++;
+        colind[dest] = r;
+        if (colval) {
+          colval[dest] = rowval ? rowval[j] : 1;
+        }
+      }
+    }
+  });
+}
+
+
+
+
+}
@@ -0,0 +1,74 @@
+/**
+ * @file Transpose.hpp
+ * @brief Functions for transposing sparse matrices.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-11
+ */
+
+
+
+
+#ifndef WILDRIVER_TRANSPOSE_HPP
+#define WILDRIVER_TRANSPOSE_HPP
+
+
+
+
+#include "base.h"
+
+
+
+
+namespace WildRiver
+{
+
+
+class Transpose
+{
+  public:
+    /**
+     * @brief Build the CSC form of a CSR matrix (equivalently, the CSR form
+     * of its transpose). Rows are split among the threads by number of
+     * non-zeros; each thread builds a histogram of the columns in its rows,
+     * the histograms are prefix summed to give each thread its own region
+     * of every column, and then each thread scatters its entries. Within
+     * each column, entries are in increasing row order.
+     *
+     * @param nrows The number of rows.
+     * @param ncols The number of columns.
+     * @param rowptr The row pointer (length nrows+1).
+     * @param rowind The column index of each entry (length nnz).
+     * @param rowval The value of each entry (may be null).
+     * @param colptr The column pointer (output, length ncols+1).
+     * @param colind The row index of each entry (output, length nnz).
+     * @param colval The value of each entry (output, may be null).
+     * @param numThreads The number of threads to use (0 for the number of
+     * threads of the library's thread pool).
+     */
+    static void csrToCsc(
+        dim_t nrows,
+        dim_t ncols,
+        ind_t const * rowptr,
+        dim_t const * rowind,
+        val_t const * rowval,
+        ind_t * colptr,
+        dim_t * colind,
+        val_t * colval,
+        int numThreads);
+
+
+
+
+};
+
+
+
+
+}
+
+
+
+
+#endif
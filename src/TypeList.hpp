@@ -0,0 +1,112 @@
+/**
+ * @file TypeList.hpp
+ * @brief The combinations of index, dimension, and value types supported by
+ * the typed readers and writers.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-14
+ */
+
+
+
+
+#ifndef WILDRIVER_TYPELIST_HPP
+#define WILDRIVER_TYPELIST_HPP
+
+
+
+
+#include <cstdint>
+#include <limits>
+#include <string>
+
+
+#include "base.h"
+#include "Exception.hpp"
+
+
+
+
+/******************************************************************************
+* MACROS **********************************************************************
+******************************************************************************/
+
+
+/* invoke M(I, D, V) for each supported value type */
+#define WILDRIVER_FOR_EACH_VALUE_TYPE(M, I, D) \
+  M(I, D, float) \
+  M(I, D, double) \
+  M(I, D, int32_t) \
+  M(I, D, int64_t)
+
+
+/* invoke M(I, D, V) for each supported dimension and value type */
+#define WILDRIVER_FOR_EACH_DIM_TYPE(M, I) \
+  WILDRIVER_FOR_EACH_VALUE_TYPE(M, I, uint32_t) \
+  WILDRIVER_FOR_EACH_VALUE_TYPE(M, I, uint64_t)
+
+
+/* invoke M(I, D, V) for each supported combination of types -- used for
+ * explicitly instantiating the typed readers and writers */
+#define WILDRIVER_FOR_EACH_TYPE(M) \
+  WILDRIVER_FOR_EACH_DIM_TYPE(M, uint32_t) \
+  WILDRIVER_FOR_EACH_DIM_TYPE(M, uint64_t)
+
+
+
+
+namespace WildRiver
+{
+
+
+class TypeList
+{
+  public:
+    /**
+     * @brief Ensure the dimensions of a matrix can be represented with the
+     * given index and dimension types.
+     *
+     * @tparam I The index type.
+     * @tparam D The dimension type.
+     * @param nrows The number of rows.
+     * @param ncols The number of columns.
+     * @param nnz The number of non-zeros.
+     *
+     * @throw BadParameterException If a type is too narrow.
+     */
+    template<typename I, typename D>
+    static void checkFits(
+        dim_t const nrows,
+        dim_t const ncols,
+        ind_t const nnz)
+    {
+      if (static_cast<uint64_t>(nnz) > \
+          static_cast<uint64_t>(std::numeric_limits<I>::max())) {
+        throw BadParameterException(std::string("The index type is too " \
+            "small for ") + std::to_string(nnz) + std::string(" non-zeros."));
+      }
+      if (static_cast<uint64_t>(nrows) > \
+          static_cast<uint64_t>(std::numeric_limits<D>::max()) || \
+          static_cast<uint64_t>(ncols) > \
+          static_cast<uint64_t>(std::numeric_limits<D>::max())) {
+        throw BadParameterException(std::string("The dimension type is " \
+            "too small for a ") + std::to_string(nrows) + std::string("x") + \
+            std::to_string(ncols) + std::string(" matrix."));
+      }
+    }
+
+
+
+
+};
+
+
+
+
+}
+
+
+
+
+#endif
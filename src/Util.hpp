@@ -10,12 +10,14 @@
 
 
 
-#ifndef WILDIRVER_UTIL_HPP
-#define WILDIRVER_UTIL_HPP
+#ifndef WILDRIVER_UTIL_HPP
+#define WILDRIVER_UTIL_HPP
 
 
 
 
+#include <chrono>
+#include <cstdint>
 #include <cstring>
 #include <string>
 #include <vector>
@@ -72,6 +74,87 @@ class Util
     }
 
 
+    /**
+     * @brief Skip over the next whitespace delimited field of a null
+     * terminated string without converting it. This is a fast replacement
+     * for strtod() when the value is not needed.
+     *
+     * @param str The position in the string to start at.
+     *
+     * @return The position after the field, or str if there is no field left.
+     */
+    static char * skipField(
+        char * const str) noexcept
+    {
+      char * ptr = str;
+      while (*ptr == ' ' || *ptr == '\t' || *ptr == '\r' || *ptr == '\n') {
+        ++ptr;
+      }
+      if (*ptr == '\0') {
+        return str;
+      }
+      while (*ptr != '\0' && *ptr != ' ' && *ptr != '\t' && *ptr != '\r' && \
+          *ptr != '\n') {
+        ++ptr;
+      }
+
+      return ptr;
+    }
+
+
+    /**
+     * @brief Read an integer stored in little endian order (as in the
+     * headers of compressed files).
+     *
+     * @param data The bytes.
+     * @param bytes The number of bytes.
+     *
+     * @return The integer.
+     */
+    static uint64_t readLittleEndian(
+        char const * const data,
+        size_t const bytes) noexcept
+    {
+      uint64_t value = 0;
+      for (size_t i = bytes; i > 0; --i) {
+        value = (value << 8) | static_cast<uint8_t>(data[i-1]);
+      }
+
+      return value;
+    }
+
+
+    /**
+     * @brief Append an integer in little endian order.
+     *
+     * @param value The integer.
+     * @param bytes The number of bytes to write.
+     * @param out The string to append to.
+     */
+    static void appendLittleEndian(
+        uint64_t value,
+        size_t const bytes,
+        std::string & out)
+    {
+      for (size_t i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<char>(value & 0xff));
+        value >>= 8;
+      }
+    }
+
+
+    /**
+     * @brief Get the current time of the steady clock.
+     *
+     * @return The time in nanoseconds.
+     */
+    static int64_t now() noexcept
+    {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>( \
+          std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+
 
 
 };
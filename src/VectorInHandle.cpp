@@ -12,6 +12,7 @@
 
 #include "VectorInHandle.hpp"
 #include "VectorReaderFactory.hpp"
+#include "Tracer.hpp"
 
 
 
@@ -56,6 +57,7 @@ void VectorInHandle::read(
     val_t * const vals,
     double * progress)
 {
+  Tracer::Span span("reader", "read vector");
   m_reader->read(vals,progress);
 }
 
@@ -12,6 +12,7 @@
 
 #include "VectorOutHandle.hpp"
 #include "VectorWriterFactory.hpp"
+#include "Tracer.hpp"
 
 
 
@@ -51,6 +52,7 @@ void VectorOutHandle::write(
     ind_t const size,
     double * const progress)
 {
+  Tracer::Span span("writer", "write vector");
   m_writer->setSize(size);
   m_writer->write(vals,progress);
 }
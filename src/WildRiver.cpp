@@ -9,9 +9,16 @@
 
 
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <cstring>
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include "MatrixInHandle.hpp"
 #include "MatrixOutHandle.hpp"
@@ -19,6 +26,26 @@
 #include "GraphOutHandle.hpp"
 #include "VectorInHandle.hpp"
 #include "VectorOutHandle.hpp"
+#include "ConversionPipeline.hpp"
+#include "CoordinateReaderFactory.hpp"
+#include "ExternalCSRBuilder.hpp"
+#include "BatchLoader.hpp"
+#include "BCSRFile.hpp"
+#include "CancelToken.hpp"
+#include "Compression.hpp"
+#include "CSRFile.hpp"
+#include "Generator.hpp"
+#include "IOStats.hpp"
+#include "MatrixMarketFile.hpp"
+#include "MemoryBudget.hpp"
+#include "MetisFile.hpp"
+#include "NumaAllocator.hpp"
+#include "ProgressMonitor.hpp"
+#include "ReadBackend.hpp"
+#include "RowStream.hpp"
+#include "SNAPFile.hpp"
+#include "ThreadPool.hpp"
+#include "Tracer.hpp"
 #include "Exception.hpp"
 
 
@@ -37,437 +64,2574 @@ namespace
 {
 
 /**
- * @brief Deleter function for using malloc with unique_ptr.
+ * @brief How the arrays of the convenience loaders are allocated.
  */
-struct c_delete
+std::atomic<int> allocFlags(WILDRIVER_ALLOC_DEFAULT);
+
+
+/**
+ * @brief Allocate an array for one of the convenience loaders.
+ *
+ * @tparam T The type of element.
+ * @param num The number of elements.
+ *
+ * @return The array, which must be released with free().
+ *
+ * @throw OutOfMemoryException If the array cannot be allocated.
+ */
+template<typename T>
+T * allocateArray(
+    size_t const num)
+{
+  size_t const nbytes = sizeof(T)*num;
+  T * const ptr = static_cast<T*>(NumaAllocator::allocate(nbytes, \
+      allocFlags.load(), 0));
+  if (ptr == nullptr) {
+    throw OutOfMemoryException(nbytes);
+  }
+
+  return ptr;
+}
+
+
+/**
+ * @brief The alignment requested from user supplied allocators.
+ */
+size_t const ARRAY_ALIGNMENT = 64;
+
+
+/**
+ * @brief An array owned by one of the convenience loaders until it is handed
+ * to the caller. It is allocated with the user supplied allocator if one is
+ * given, and otherwise according to the allocation flags.
+ *
+ * @tparam T The type of element.
+ */
+template<typename T>
+class LoaderArray
+{
+  public:
+    LoaderArray(
+        wildriver_allocator const * const allocator) :
+      m_allocator(allocator),
+      m_ptr(nullptr),
+      m_bytes(0)
+    {
+      // do nothing
+    }
+
+    ~LoaderArray()
+    {
+      if (m_ptr != nullptr) {
+        if (m_allocator != nullptr) {
+          m_allocator->free(m_ptr, m_bytes, m_allocator->ctx);
+        } else {
+          free(m_ptr);
+        }
+      }
+    }
+
+    void allocate(
+        size_t const num)
+    {
+      m_bytes = sizeof(T)*num;
+      if (m_allocator != nullptr) {
+        m_ptr = static_cast<T*>(m_allocator->alloc(m_bytes, ARRAY_ALIGNMENT, \
+            m_allocator->ctx));
+        if (m_ptr == nullptr && m_bytes > 0) {
+          throw OutOfMemoryException(m_bytes);
+        }
+      } else {
+        m_ptr = allocateArray<T>(num);
+      }
+      IOStats::addCurrentAllocation(m_bytes);
+    }
+
+    T * get() const noexcept
+    {
+      return m_ptr;
+    }
+
+    T * release() noexcept
+    {
+      T * const ptr = m_ptr;
+      m_ptr = nullptr;
+      return ptr;
+    }
+
+  private:
+    wildriver_allocator const * m_allocator;
+    T * m_ptr;
+    size_t m_bytes;
+
+    // disable copying
+    LoaderArray(
+        LoaderArray const & rhs);
+    LoaderArray & operator=(
+        LoaderArray const & rhs);
+};
+
+
+/**
+ * @brief Check that a user supplied allocator is usable.
+ *
+ * @param allocator The allocator.
+ *
+ * @throw BadParameterException If it is not.
+ */
+void checkAllocator(
+    wildriver_allocator const * const allocator)
+{
+  if (allocator == nullptr || allocator->alloc == nullptr || \
+      allocator->free == nullptr) {
+    throw BadParameterException("The allocator must supply both alloc and " \
+        "free functions.");
+  }
+}
+
+
+/**
+ * @brief Read a matrix into newly allocated arrays.
+ *
+ * @param fname The filename/path of the matrix file.
+ * @param allocator The allocator (may be null for the allocation flags).
+ * @param r_nrows The number of rows in the matrix (output).
+ * @param r_ncols The number of columns in the matrix (output).
+ * @param r_nnz The number of non-zeros in the matrix (output).
+ * @param r_rowptr The the starting index for each row (output).
+ * @param r_rowind The column indices for entries in each row (output).
+ * @param r_rowval The value of the entries in each row (output, optional).
+ */
+void readMatrix(
+    char const * const fname,
+    wildriver_allocator const * const allocator,
+    dim_t * const r_nrows,
+    dim_t * const r_ncols,
+    ind_t * const r_nnz,
+    ind_t ** const r_rowptr,
+    dim_t ** const r_rowind,
+    val_t ** const r_rowval)
+{
+  ProgressMonitor::setCurrentPhase(WILDRIVER_PHASE_OPEN);
+
+  MatrixInHandle handle(fname);
+
+  dim_t nrows, ncols;
+  ind_t nnz;
+
+  // read the header
+  handle.getInfo(nrows,ncols,nnz);
+
+  // allocate matrix
+  LoaderArray<ind_t> rowptr(allocator);
+  rowptr.allocate(nrows+1);
+  LoaderArray<dim_t> rowind(allocator);
+  rowind.allocate(nnz);
+
+  LoaderArray<val_t> rowval(allocator);
+  if (r_rowval) {
+    // we need to use rowval
+    rowval.allocate(nnz);
+  }
+
+  handle.readSparse(rowptr.get(),rowind.get(),rowval.get());
+
+  ProgressMonitor::setCurrentPhase(WILDRIVER_PHASE_DONE);
+
+  // we've completely succeed -- assign pointers
+  *r_nrows = nrows;
+  *r_ncols = ncols;
+  *r_nnz = nnz;
+
+  *r_rowptr = rowptr.release();
+  *r_rowind = rowind.release();
+  if (r_rowval) {
+    *r_rowval = rowval.release();
+  }
+}
+
+
+/**
+ * @brief Read a graph into newly allocated arrays.
+ *
+ * @param fname The filename/path of the graph file.
+ * @param allocator The allocator (may be null for the allocation flags).
+ * @param r_nvtxs The number of vertices in the graph (output).
+ * @param r_nedges The number of edges in the graph (output, optional).
+ * @param r_nvwgts The number of vertex weights in the graph (output,
+ * optional).
+ * @param r_ewgts Whether or not edge weights are present in the graph file
+ * (output, optional).
+ * @param r_xadj The adjacency list pointer (output).
+ * @param r_adjncy The adjacency list (output).
+ * @param r_vwgt The vertex weights (output, optional).
+ * @param r_adjwgt The edge weights (output, optional).
+ */
+void readGraph(
+    char const * const fname,
+    wildriver_allocator const * const allocator,
+    dim_t * const r_nvtxs,
+    ind_t * const r_nedges,
+    int * const r_nvwgts,
+    int * const r_ewgts,
+    ind_t ** const r_xadj,
+    dim_t ** const r_adjncy,
+    val_t ** const r_vwgt,
+    val_t ** const r_adjwgt)
+{
+  ProgressMonitor::setCurrentPhase(WILDRIVER_PHASE_OPEN);
+
+  GraphInHandle handle(fname);
+
+  dim_t nvtxs;
+  ind_t nedges;
+  int nvwgts;
+  bool ewgts;
+
+  // read the header
+  handle.getInfo(nvtxs,nedges,nvwgts,ewgts);
+
+  // allocate matrix
+  LoaderArray<ind_t> xadj(allocator);
+  xadj.allocate(nvtxs+1);
+  LoaderArray<dim_t> adjncy(allocator);
+  adjncy.allocate(nedges);
+
+  LoaderArray<val_t> vwgt(allocator);
+  if (r_vwgt && nvwgts > 0) {
+    vwgt.allocate(static_cast<size_t>(nvtxs)*nvwgts);
+  }
+
+  // unweighted graphs are loaded as a pattern only, without allocating or
+  // filling edge weights
+  LoaderArray<val_t> adjwgt(allocator);
+  if (r_adjwgt && ewgts) {
+    adjwgt.allocate(nedges);
+  }
+
+  handle.readGraph(xadj.get(),adjncy.get(),vwgt.get(),adjwgt.get());
+
+  ProgressMonitor::setCurrentPhase(WILDRIVER_PHASE_DONE);
+
+  // we've completed exception possible tasks -- assign pointers
+  *r_xadj = xadj.release();
+  *r_adjncy = adjncy.release();
+  if (r_vwgt) {
+    *r_vwgt = vwgt.release();
+  }
+  if (r_adjwgt) {
+    *r_adjwgt = adjwgt.release();
+  }
+
+  *r_nvtxs = nvtxs;
+
+  if (r_nedges) {
+    *r_nedges = nedges;
+  }
+
+  if (r_ewgts) {
+    // convert to c style int
+    *r_ewgts = (int)ewgts;
+  }
+  if (r_nvwgts) {
+    *r_nvwgts = nvwgts;
+  }
+}
+
+
+/**
+ * @brief Copy a vector into a newly allocated array.
+ *
+ * @tparam T The type of element.
+ * @param vec The vector to copy.
+ * @param array The array to allocate and fill.
+ */
+template<typename T>
+void copyToArray(
+    std::vector<T> const & vec,
+    LoaderArray<T> & array)
+{
+  array.allocate(vec.size());
+  std::copy(vec.begin(), vec.end(), array.get());
+}
+
+
+/**
+ * @brief Read a range of rows of a matrix into newly allocated arrays.
+ *
+ * @param handle The handle of the matrix.
+ * @param begin The first row to read.
+ * @param end One past the last row to read.
+ * @param r_nrows The number of rows in the whole matrix (output).
+ * @param r_ncols The number of columns in the whole matrix (output).
+ * @param r_nnz The number of non-zeros in the range of rows (output).
+ * @param r_rowptr The the starting index for each row (output).
+ * @param r_rowind The column indices for entries in each row (output).
+ * @param r_rowval The value of the entries in each row (output, optional).
+ */
+void readMatrixRange(
+    MatrixInHandle & handle,
+    dim_t const begin,
+    dim_t const end,
+    dim_t * const r_nrows,
+    dim_t * const r_ncols,
+    ind_t * const r_nnz,
+    ind_t ** const r_rowptr,
+    dim_t ** const r_rowind,
+    val_t ** const r_rowval)
+{
+  dim_t nrows, ncols;
+  ind_t nnz;
+  handle.getInfo(nrows,ncols,nnz);
+
+  std::vector<ind_t> rowptr;
+  std::vector<dim_t> rowind;
+  std::vector<val_t> rowval;
+  handle.readSparseRange(begin, end, rowptr, rowind, \
+      r_rowval ? &rowval : nullptr);
+
+  LoaderArray<ind_t> rowptrArray(nullptr);
+  copyToArray(rowptr, rowptrArray);
+  LoaderArray<dim_t> rowindArray(nullptr);
+  copyToArray(rowind, rowindArray);
+  LoaderArray<val_t> rowvalArray(nullptr);
+  if (r_rowval) {
+    copyToArray(rowval, rowvalArray);
+  }
+
+  // we've completely succeed -- assign pointers
+  *r_nrows = nrows;
+  *r_ncols = ncols;
+  *r_nnz = rowptr.back();
+
+  *r_rowptr = rowptrArray.release();
+  *r_rowind = rowindArray.release();
+  if (r_rowval) {
+    *r_rowval = rowvalArray.release();
+  }
+}
+
+
+/**
+ * @brief Read a range of vertices of a graph into newly allocated arrays.
+ *
+ * @param handle The handle of the graph.
+ * @param begin The first vertex to read.
+ * @param end One past the last vertex to read.
+ * @param r_nvtxs The number of vertices in the whole graph (output).
+ * @param r_nedges The number of edges in the range of vertices (output,
+ * optional).
+ * @param r_nvwgts The number of vertex weights in the graph (output,
+ * optional).
+ * @param r_ewgts Whether or not edge weights are present in the graph file
+ * (output, optional).
+ * @param r_xadj The adjacency list pointer (output).
+ * @param r_adjncy The adjacency list (output).
+ * @param r_vwgt The vertex weights (output, optional).
+ * @param r_adjwgt The edge weights (output, optional).
+ */
+void readGraphRange(
+    GraphInHandle & handle,
+    dim_t const begin,
+    dim_t const end,
+    dim_t * const r_nvtxs,
+    ind_t * const r_nedges,
+    int * const r_nvwgts,
+    int * const r_ewgts,
+    ind_t ** const r_xadj,
+    dim_t ** const r_adjncy,
+    val_t ** const r_vwgt,
+    val_t ** const r_adjwgt)
+{
+  dim_t nvtxs;
+  ind_t nedges;
+  int nvwgts;
+  bool ewgts;
+  handle.getInfo(nvtxs,nedges,nvwgts,ewgts);
+
+  bool const readVwgt = r_vwgt && nvwgts > 0;
+  bool const readAdjwgt = r_adjwgt && ewgts;
+
+  std::vector<ind_t> xadj;
+  std::vector<dim_t> adjncy;
+  std::vector<val_t> vwgt;
+  std::vector<val_t> adjwgt;
+  handle.readGraphRange(begin, end, xadj, adjncy, \
+      readVwgt ? &vwgt : nullptr, readAdjwgt ? &adjwgt : nullptr);
+
+  LoaderArray<ind_t> xadjArray(nullptr);
+  copyToArray(xadj, xadjArray);
+  LoaderArray<dim_t> adjncyArray(nullptr);
+  copyToArray(adjncy, adjncyArray);
+  LoaderArray<val_t> vwgtArray(nullptr);
+  if (readVwgt) {
+    copyToArray(vwgt, vwgtArray);
+  }
+  LoaderArray<val_t> adjwgtArray(nullptr);
+  if (readAdjwgt) {
+    copyToArray(adjwgt, adjwgtArray);
+  }
+
+  // we've completed exception possible tasks -- assign pointers
+  *r_xadj = xadjArray.release();
+  *r_adjncy = adjncyArray.release();
+  if (r_vwgt) {
+    *r_vwgt = vwgtArray.release();
+  }
+  if (r_adjwgt) {
+    *r_adjwgt = adjwgtArray.release();
+  }
+
+  *r_nvtxs = nvtxs;
+  if (r_nedges) {
+    *r_nedges = xadj.back();
+  }
+  if (r_ewgts) {
+    *r_ewgts = (int)ewgts;
+  }
+  if (r_nvwgts) {
+    *r_nvwgts = nvwgts;
+  }
+}
+
+
+/**
+ * @brief Row writer passing each row to a user supplied callback.
+ */
+class RowCallbackWriter :
+  public IRowMatrixWriter
+{
+  public:
+    RowCallbackWriter(
+        wildriver_external_options const * const options) :
+      m_row(0),
+      m_options(options)
+    {
+      // do nothing
+    }
+
+    void writeHeader(
+        dim_t,
+        dim_t,
+        ind_t) override
+    {
+      m_row = 0;
+    }
+
+    void setNextRow(
+        dim_t const numNonZeros,
+        dim_t const * const columns,
+        val_t const * const values) override
+    {
+      m_options->row_callback(m_row++, numNonZeros, columns, values, \
+          m_options->row_ctx);
+    }
+
+  private:
+    dim_t m_row;
+    wildriver_external_options const * m_options;
+
+    // disable copying
+    RowCallbackWriter(
+        RowCallbackWriter const & rhs);
+    RowCallbackWriter & operator=(
+        RowCallbackWriter const & rhs);
+};
+
+
+/**
+ * @brief Get the reader of a matrix handle, checking that it is open for
+ * reading.
+ *
+ * @param handle The handle.
+ *
+ * @return The reader.
+ */
+MatrixInHandle * getMatrixInHandle(
+    wildriver_matrix_handle * const handle)
+{
+  if (handle->mode != WILDRIVER_IN) {
+    throw BadParameterException( \
+        std::string("Cannot load matrix in mode: ") + \
+        std::to_string(handle->mode));
+  }
+
+  // check input
+  if (handle->nrows == NULL_DIM) {
+    throw BadParameterException("Number of rows has not been set.");
+  }
+  if (handle->ncols == NULL_DIM) {
+    throw BadParameterException("Number of columns has not been set.");
+  }
+  if (handle->nnz == NULL_IND) {
+    throw BadParameterException("Number of non-zeros has not been set.");
+  }
+  if (handle->fd == nullptr) {
+    throw BadParameterException("The file descriptor has not been set.");
+  }
+
+  return reinterpret_cast<MatrixInHandle*>(handle->fd);
+}
+
+
+/**
+ * @brief Get the writer of a matrix handle, checking that it is open for
+ * writing and its information has been set.
+ *
+ * @param handle The handle.
+ *
+ * @return The writer.
+ */
+MatrixOutHandle * getMatrixOutHandle(
+    wildriver_matrix_handle * const handle)
+{
+  if (handle->mode != WILDRIVER_OUT) {
+    throw BadParameterException( \
+        std::string("Cannot save matrix in mode: ") + \
+        std::to_string(handle->mode));
+  }
+
+  // check input
+  if (handle->nrows == NULL_DIM) {
+    throw BadParameterException("Number of rows has not been set.");
+  }
+  if (handle->ncols == NULL_DIM) {
+    throw BadParameterException("Number of columns has not been set.");
+  }
+  if (handle->nnz == NULL_IND) {
+    throw BadParameterException("Number of non-zeros has not been set.");
+  }
+  if (handle->fd == nullptr) {
+    throw BadParameterException("The file descriptor has not been set.");
+  }
+
+  return reinterpret_cast<MatrixOutHandle*>(handle->fd);
+}
+
+
+/**
+ * @brief Invoke the function for the value type chosen at runtime.
+ *
+ * @tparam I The index type.
+ * @tparam D The dimension type.
+ * @tparam F The type of function.
+ * @param valType The value type.
+ * @param func The function.
+ */
+template<typename I, typename D, typename F>
+void dispatchValue(
+    int const valType,
+    F & func)
+{
+  switch (valType) {
+    case WILDRIVER_TYPE_F32:
+      func.template apply<I, D, float>();
+      break;
+    case WILDRIVER_TYPE_F64:
+      func.template apply<I, D, double>();
+      break;
+    case WILDRIVER_TYPE_I32:
+      func.template apply<I, D, int32_t>();
+      break;
+    case WILDRIVER_TYPE_I64:
+      func.template apply<I, D, int64_t>();
+      break;
+    default:
+      throw BadParameterException(std::string("Unsupported value type: ") + \
+          std::to_string(valType));
+  }
+}
+
+
+/**
+ * @brief Invoke the function for the dimension and value types chosen at
+ * runtime.
+ *
+ * @tparam I The index type.
+ * @tparam F The type of function.
+ * @param dimType The dimension type.
+ * @param valType The value type.
+ * @param func The function.
+ */
+template<typename I, typename F>
+void dispatchDim(
+    int const dimType,
+    int const valType,
+    F & func)
+{
+  switch (dimType) {
+    case WILDRIVER_TYPE_U32:
+      dispatchValue<I, uint32_t>(valType, func);
+      break;
+    case WILDRIVER_TYPE_U64:
+      dispatchValue<I, uint64_t>(valType, func);
+      break;
+    default:
+      throw BadParameterException(std::string("Unsupported dimension " \
+          "type: ") + std::to_string(dimType));
+  }
+}
+
+
+/**
+ * @brief Invoke the function for the index, dimension, and value types chosen
+ * at runtime.
+ *
+ * @tparam F The type of function.
+ * @param indType The index type.
+ * @param dimType The dimension type.
+ * @param valType The value type.
+ * @param func The function.
+ */
+template<typename F>
+void dispatchTypes(
+    int const indType,
+    int const dimType,
+    int const valType,
+    F & func)
 {
-  void operator()(void * ptr)
-  {
-    free(ptr);
+  switch (indType) {
+    case WILDRIVER_TYPE_U32:
+      dispatchDim<uint32_t>(dimType, valType, func);
+      break;
+    case WILDRIVER_TYPE_U64:
+      dispatchDim<uint64_t>(dimType, valType, func);
+      break;
+    default:
+      throw BadParameterException(std::string("Unsupported index type: ") + \
+          std::to_string(indType));
   }
+}
+
+
+/**
+ * @brief Function for reading a matrix into arrays of runtime types.
+ */
+class TypedLoader
+{
+  public:
+    TypedLoader(
+        MatrixInHandle * const handle,
+        void * const rowptr,
+        void * const rowind,
+        void * const rowval,
+        double * const progress) :
+      m_handle(handle),
+      m_rowptr(rowptr),
+      m_rowind(rowind),
+      m_rowval(rowval),
+      m_progress(progress)
+    {
+      // do nothing
+    }
+
+    template<typename I, typename D, typename V>
+    void apply()
+    {
+      m_handle->readSparseTyped(static_cast<I*>(m_rowptr), \
+          static_cast<D*>(m_rowind), static_cast<V*>(m_rowval), m_progress);
+    }
+
+  private:
+    MatrixInHandle * m_handle;
+    void * m_rowptr;
+    void * m_rowind;
+    void * m_rowval;
+    double * m_progress;
+
+    // disable copying
+    TypedLoader(
+        TypedLoader const & rhs);
+    TypedLoader & operator=(
+        TypedLoader const & rhs);
+};
+
+
+/**
+ * @brief Function for writing a matrix from arrays of runtime types.
+ */
+class TypedSaver
+{
+  public:
+    TypedSaver(
+        MatrixOutHandle * const handle,
+        void const * const rowptr,
+        void const * const rowind,
+        void const * const rowval) :
+      m_handle(handle),
+      m_rowptr(rowptr),
+      m_rowind(rowind),
+      m_rowval(rowval)
+    {
+      // do nothing
+    }
+
+    template<typename I, typename D, typename V>
+    void apply()
+    {
+      m_handle->writeSparseTyped(static_cast<I const*>(m_rowptr), \
+          static_cast<D const*>(m_rowind), static_cast<V const*>(m_rowval));
+    }
+
+  private:
+    MatrixOutHandle * m_handle;
+    void const * m_rowptr;
+    void const * m_rowind;
+    void const * m_rowval;
+
+    // disable copying
+    TypedSaver(
+        TypedSaver const & rhs);
+    TypedSaver & operator=(
+        TypedSaver const & rhs);
+};
+
+
+/**
+ * @brief The state of a load running on the thread pool, shared between the
+ * loading thread and the caller.
+ */
+class AsyncLoad
+{
+  public:
+    typedef void (*callback_type)(
+        wildriver_async * async,
+        int status,
+        void * ctx);
+
+    AsyncLoad(
+        callback_type const callback,
+        void * const ctx) :
+      m_callback(callback),
+      m_ctx(ctx),
+      m_status(WILDRIVER_STATUS_PENDING),
+      m_token(),
+      m_monitor(),
+      m_finished(false),
+      m_taken(false),
+      m_mutex(),
+      m_changed(),
+      nrows(0),
+      ncols(0),
+      nnz(0),
+      nvwgts(0),
+      ewgts(0),
+      rowptr(nullptr),
+      rowind(nullptr),
+      rowval(nullptr),
+      vwgt(nullptr),
+      adjwgt(nullptr)
+    {
+      // do nothing
+    }
+
+    ~AsyncLoad()
+    {
+      if (!m_taken) {
+        free(rowptr);
+        free(rowind);
+        free(rowval);
+        free(vwgt);
+        free(adjwgt);
+      }
+    }
+
+    /**
+     * @brief Perform the load, then notify the callback and any waiters. The
+     * load must not be touched by this thread after it is finished, as it may
+     * then be freed.
+     *
+     * @param async The handle of the load.
+     * @param load The function filling in the results.
+     */
+    void run(
+        wildriver_async * const async,
+        std::function<void(AsyncLoad*)> const & load)
+    {
+      m_status.store(WILDRIVER_STATUS_RUNNING);
+
+      int status = WILDRIVER_STATUS_DONE;
+      try {
+        CancelToken::Scope scope(&m_token);
+        ProgressMonitor::Scope monitor(&m_monitor);
+        load(this);
+      } catch (CancelledException const & e) {
+        std::cerr << "ERROR: failed to load asynchronously due to: " << \
+            e.what() << std::endl;
+        status = WILDRIVER_STATUS_CANCELLED;
+      } catch (std::exception const & e) {
+        std::cerr << "ERROR: failed to load asynchronously due to: " << \
+            e.what() << std::endl;
+        status = WILDRIVER_STATUS_FAILED;
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_status.store(status);
+        m_changed.notify_all();
+      }
+
+      if (m_callback != nullptr) {
+        m_callback(async, status, m_ctx);
+      }
+
+      // notify while holding the lock, as a waiter may free us once it
+      // observes the load as finished
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_finished = true;
+      m_changed.notify_all();
+    }
+
+    int getStatus() const noexcept
+    {
+      return m_status.load();
+    }
+
+    void cancel() noexcept
+    {
+      m_token.cancel();
+    }
+
+    wildriver_progress getProgress() const noexcept
+    {
+      return m_monitor.getProgress();
+    }
+
+    /**
+     * @brief Wait for the results to be available.
+     *
+     * @return The final status.
+     */
+    int waitForResults()
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_changed.wait(lock, [this]() {
+        return m_status.load() >= WILDRIVER_STATUS_DONE;
+      });
+      return m_status.load();
+    }
+
+    /**
+     * @brief Wait for the load to finish, including its callback.
+     *
+     * @return The final status.
+     */
+    int waitForFinish()
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_changed.wait(lock, [this]() {
+        return m_finished;
+      });
+      return m_status.load();
+    }
+
+    /**
+     * @brief Wait for the results and mark them as owned by the caller.
+     *
+     * @throw BadParameterException If the load failed or the results have
+     * already been taken.
+     */
+    void take()
+    {
+      if (waitForResults() != WILDRIVER_STATUS_DONE) {
+        throw BadParameterException("The load failed.");
+      }
+
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_taken) {
+        throw BadParameterException("The results have already been taken.");
+      }
+      m_taken = true;
+    }
+
+  private:
+    callback_type m_callback;
+    void * m_ctx;
+    std::atomic<int> m_status;
+    CancelToken m_token;
+    ProgressMonitor m_monitor;
+    bool m_finished;
+    bool m_taken;
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+
+    // disable copying
+    AsyncLoad(
+        AsyncLoad const & rhs);
+    AsyncLoad & operator=(
+        AsyncLoad const & rhs);
+
+  public:
+    // the results, for either a matrix or a graph
+    dim_t nrows;
+    dim_t ncols;
+    ind_t nnz;
+    int nvwgts;
+    int ewgts;
+    ind_t * rowptr;
+    dim_t * rowind;
+    val_t * rowval;
+    val_t * vwgt;
+    val_t * adjwgt;
 };
 
+
+/**
+ * @brief Get the filenames of the slots of a batch.
+ *
+ * @tparam S The type of slot.
+ * @param slots The slots.
+ * @param nslots The number of slots.
+ *
+ * @return The filenames.
+ *
+ * @throw BadParameterException If the slots or one of their filenames is
+ * missing.
+ */
+template<typename S>
+std::vector<std::string> getBatchNames(
+    S const * const slots,
+    size_t const nslots)
+{
+  if (slots == nullptr && nslots > 0) {
+    throw BadParameterException("No slots given for the batch.");
+  }
+
+  std::vector<std::string> names(nslots);
+  for (size_t i = 0; i < nslots; ++i) {
+    if (slots[i].fname == nullptr) {
+      throw BadParameterException(std::string("No filename given for " \
+          "slot ") + std::to_string(i) + ".");
+    }
+    names[i] = slots[i].fname;
+  }
+
+  return names;
+}
+
+
+/**
+ * @brief Record the outcome of the load of each slot of a batch.
+ *
+ * @tparam S The type of slot.
+ * @param slots The slots.
+ * @param errors The error of each slot (null for success).
+ *
+ * @return The number of slots loaded successfully.
+ */
+template<typename S>
+size_t finishBatch(
+    S * const slots,
+    std::vector<std::exception_ptr> const & errors)
+{
+  size_t loaded = 0;
+  for (size_t i = 0; i < errors.size(); ++i) {
+    S & slot = slots[i];
+    slot.error[0] = '\0';
+    if (errors[i] == nullptr) {
+      slot.status = WILDRIVER_SUCCESS;
+      ++loaded;
+    } else {
+      slot.status = WILDRIVER_ERROR;
+      try {
+        std::rethrow_exception(errors[i]);
+      } catch (std::exception const & e) {
+        std::cerr << "ERROR: failed to read '" << slot.fname << \
+            "' due to: " << e.what() << std::endl;
+        std::strncpy(slot.error, e.what(), WILDRIVER_ERROR_SIZE-1);
+        slot.error[WILDRIVER_ERROR_SIZE-1] = '\0';
+      } catch (...) {
+        std::strncpy(slot.error, "Unknown error.", WILDRIVER_ERROR_SIZE-1);
+      }
+    }
+  }
+
+  return loaded;
+}
+
+
+/**
+ * @brief Start a load on the thread pool.
+ *
+ * @param kind The kind of load.
+ * @param callback The function to call once the load has completed.
+ * @param ctx The context passed to the callback.
+ * @param load The function filling in the results.
+ *
+ * @return The handle of the load.
+ */
+wildriver_async * startAsync(
+    int const kind,
+    AsyncLoad::callback_type const callback,
+    void * const ctx,
+    std::function<void(AsyncLoad*)> load)
+{
+  std::unique_ptr<wildriver_async> async(new wildriver_async);
+  std::unique_ptr<AsyncLoad> state(new AsyncLoad(callback, ctx));
+
+  async->kind = kind;
+  async->fd = reinterpret_cast<void*>(state.get());
+
+  wildriver_async * const ptr = async.get();
+  AsyncLoad * const statePtr = state.get();
+  ThreadPool::getInstance().submit([ptr, statePtr, load]() {
+    statePtr->run(ptr, load);
+  });
+
+  state.release();
+  return async.release();
+}
+
+
+/**
+ * @brief Get the state of a load, checking its kind.
+ *
+ * @param async The handle of the load.
+ * @param kind The expected kind of load.
+ *
+ * @return The state.
+ */
+AsyncLoad * getAsyncLoad(
+    wildriver_async * const async,
+    int const kind)
+{
+  if (async->kind != kind) {
+    throw BadParameterException(std::string("Cannot take results of kind ") + \
+        std::to_string(kind) + std::string(" from a load of kind ") + \
+        std::to_string(async->kind));
+  }
+
+  return reinterpret_cast<AsyncLoad*>(async->fd);
+}
+
+}
+
+
+/******************************************************************************
+* API FUNCTIONS ***************************************************************
+******************************************************************************/
+
+
+extern "C" wildriver_matrix_handle * wildriver_open_matrix(
+    char const * const filename,
+    int const mode)
+{
+  try {
+    IOStats::Record record("open matrix", filename);
+    std::unique_ptr<wildriver_matrix_handle> handle(
+        new wildriver_matrix_handle);
+
+    // initialize handle
+    handle->mode = mode;
+    handle->nrows = NULL_DIM;
+    handle->ncols = NULL_DIM;
+    handle->nnz = NULL_IND;
+    handle->temporary_bytes = 0;
+    handle->fd = nullptr;
+
+    switch (mode) {
+      case WILDRIVER_IN: {
+          std::unique_ptr<MatrixInHandle> ptr(new MatrixInHandle(filename));
+          ptr->getInfo(handle->nrows,handle->ncols,handle->nnz);
+          handle->temporary_bytes = ptr->getTemporaryBytes();
+          handle->fd = reinterpret_cast<void*>(ptr.release());
+        }
+        break;
+      case WILDRIVER_OUT: {
+          std::unique_ptr<MatrixOutHandle> ptr(new MatrixOutHandle(filename));
+          handle->fd = reinterpret_cast<void*>(ptr.release());
+        }
+        break;
+      default:
+        throw BadParameterException(std::string("Unknown matrix mode: ") + \
+            std::to_string(mode));
+    }
+
+    return handle.release();
+  } catch (std::exception const & e) {
+    std::cerr << "ERROR: failed to open matrix due to: " << e.what() \
+        << std::endl;
+    return nullptr;
+  }
+}
+
+
+extern "C" int wildriver_load_matrix(
+    wildriver_matrix_handle * const handle,
+    ind_t * const rowptr,
+    dim_t * const rowind,
+    val_t * const rowval,
+    double * progress)
+{
+  if (progress != nullptr) {
+    *progress = 0.0;
+  }
+
+  try {
+    IOStats::Record record("read matrix", nullptr);
+    MatrixInHandle * const inHandle = getMatrixInHandle(handle);
+
+    // allocate matrix
+    inHandle->readSparse(rowptr,rowind,rowval,progress);
+  } catch (std::exception const & e) {
+    std::cerr << "ERROR: failed to read matrix due to: " << e.what() \
+        << std::endl;
+    return 0;
+  }
+
+  if (progress != nullptr) {
+    *progress = 1.0;
+  }
+
+  return 1;
+}
+
+
+extern "C" int wildriver_load_matrix_csc(
+    wildriver_matrix_handle * const handle,
+    ind_t * const colptr,
+    dim_t * const colind,
+    val_t * const colval,
+    double * progress)
+{
+  if (progress != nullptr) {
+    *progress = 0.0;
+  }
+
+  try {
+    IOStats::Record record("read matrix", nullptr);
+    MatrixInHandle * const inHandle = getMatrixInHandle(handle);
+
+    inHandle->readSparseTransposed(colptr,colind,colval,progress);
+  } catch (std::exception const & e) {
+    std::cerr << "ERROR: failed to read matrix due to: " << e.what() \
+        << std::endl;
+    return 0;
+  }
+
+  if (progress != nullptr) {
+    *progress = 1.0;
+  }
+
+  return 1;
+}
+
+
+extern "C" int wildriver_load_matrix_both(
+    wildriver_matrix_handle * const handle,
+    ind_t * const rowptr,
+    dim_t * const rowind,
+    val_t * const rowval,
+    ind_t * const colptr,
+    dim_t * const colind,
+    val_t * const colval,
+    double * progress)
+{
+  if (progress != nullptr) {
+    *progress = 0.0;
+  }
+
+  try {
+    IOStats::Record record("read matrix", nullptr);
+    MatrixInHandle * const inHandle = getMatrixInHandle(handle);
+
+    inHandle->readSparseBoth(rowptr,rowind,rowval,colptr,colind,colval, \
+        progress);
+  } catch (std::exception const & e) {
+    std::cerr << "ERROR: failed to read matrix due to: " << e.what() \
+        << std::endl;
+    return 0;
+  }
+
+  if (progress != nullptr) {
+    *progress = 1.0;
+  }
+
+  return 1;
+}
+
+
+extern "C" int wildriver_save_matrix(
+    wildriver_matrix_handle * const handle,
+    ind_t const * const rowptr,
+    dim_t const * const rowind,
+    val_t const * const rowval,
+    double * const progress)
+{
+  if (progress != nullptr) {
+    *progress = 0.0;
+  }
+
+  try {
+    IOStats::Record record("write matrix", nullptr);
+    MatrixOutHandle * const outHandle = getMatrixOutHandle(handle);
+
+    // save matrix
+    outHandle->setInfo(handle->nrows,handle->ncols,handle->nnz);
+    outHandle->writeSparse(rowptr,rowind,rowval);
+  } catch (std::exception const & e) {
+    std::cerr << "ERROR: failed to save matrix due to: " << e.what() \
+        << std::endl;
+    return 0;
+  }
+
+  if (progress != nullptr) {
+    *progress = 1.0;
+  }
+
+  return 1;
+}
+
+
+extern "C" size_t wildriver_type_size(
+    int const type)
+{
+  switch (type) {
+    case WILDRIVER_TYPE_U32:
+    case WILDRIVER_TYPE_I32:
+    case WILDRIVER_TYPE_F32:
+      return 4;
+    case WILDRIVER_TYPE_U64:
+    case WILDRIVER_TYPE_I64:
+    case WILDRIVER_TYPE_F64:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+
+extern "C" int wildriver_load_matrix_typed(
+    wildriver_matrix_handle * const handle,
+    int const ind_type,
+    int const dim_type,
+    int const val_type,
+    void * const rowptr,
+    void * const rowind,
+    void * const rowval,
+    double * const progress)
+{
+  if (progress != nullptr) {
+    *progress = 0.0;
+  }
+
+  try {
+    IOStats::Record record("read matrix", nullptr);
+    TypedLoader loader(getMatrixInHandle(handle), rowptr, rowind, rowval, \
+        progress);
+    dispatchTypes(ind_type, dim_type, val_type, loader);
+  } catch (std::exception const & e) {
+    std::cerr << "ERROR: failed to read matrix due to: " << e.what() \
+        << std::endl;
+    return 0;
+  }
+
+  if (progress != nullptr) {
+    *progress = 1.0;
+  }
+
+  return 1;
+}
+
+
+extern "C" int wildriver_save_matrix_typed(
+    wildriver_matrix_handle * const handle,
+    int const ind_type,
+    int const dim_type,
+    int const val_type,
+    void const * const rowptr,
+    void const * const rowind,
+    void const * const rowval,
+    double * const progress)
+{
+  if (progress != nullptr) {
+    *progress = 0.0;
+  }
+
+  try {
+    IOStats::Record record("write matrix", nullptr);
+    MatrixOutHandle * const outHandle = getMatrixOutHandle(handle);
+
+    outHandle->setInfo(handle->nrows,handle->ncols,handle->nnz);
+
+    TypedSaver saver(outHandle, rowptr, rowind, rowval);
+    dispatchTypes(ind_type, dim_type, val_type, saver);
+  } catch (std::exception const & e) {
+    std::cerr << "ERROR: failed to save matrix due to: " << e.what() \
+        << std::endl;
+    return 0;
+  }
+
+  if (progress != nullptr) {
+    *progress = 1.0;
+  }
+
+  return 1;
+}
+
+
+extern "C" void wildriver_close_matrix(
+    wildriver_matrix_handle * handle)
+{
+  if (handle->fd != nullptr) {
+    if (handle->mode == WILDRIVER_IN) {
+      delete reinterpret_cast<MatrixInHandle*>(handle->fd);
+    } else if (handle->mode == WILDRIVER_OUT) {
+      delete reinterpret_cast<MatrixOutHandle*>(handle->fd);
+    } else {
+      std::cerr << "WARNING: unable to determine current mode" << \
+          handle->mode << std::endl;
+    }
+  }
+
+  delete handle;
+}
+
+extern "C" wildriver_graph_handle * wildriver_open_graph(
+    char const * const filename,
+    int const mode)
+{
+  try {
+    IOStats::Record record("open graph", filename);
+    std::unique_ptr<wildriver_graph_handle> handle(
+        new wildriver_graph_handle);
+
+    // initialize handle
+    handle->mode = mode;
+    handle->nvtxs = NULL_DIM;
+    handle->nedges = NULL_IND;
+    handle->temporary_bytes = 0;
+    handle->fd = nullptr;
+
+    bool ewgt_present;
+
+    switch (mode) {
+      case WILDRIVER_IN: {
+          std::unique_ptr<GraphInHandle> ptr(new GraphInHandle(filename));
+          ptr->getInfo(handle->nvtxs, handle->nedges, handle->nvwgt, \
+              ewgt_present);
+          handle->ewgt = static_cast<int>(ewgt_present);
+          handle->temporary_bytes = ptr->getTemporaryBytes();
+          handle->fd = reinterpret_cast<void*>(ptr.release());
+        }
+        break;
+      case WILDRIVER_OUT: {
+          std::unique_ptr<GraphOutHandle> ptr(new GraphOutHandle(filename));
+          handle->fd = reinterpret_cast<void*>(ptr.release());
+        }
+        break;
+      default:
+        throw BadParameterException(std::string("Unknown graph mode: ") + \
+            std::to_string(mode));
+    }
+
+    return handle.release();
+  } catch (std::exception const & e) {
+    std::cerr << "ERROR: failed to open graph due to: " << e.what() \
+        << std::endl;
+    return nullptr;
+  }
+}
+
+
+extern "C" int wildriver_load_graph(
+    wildriver_graph_handle * const handle,
+    ind_t * const xadj,
+    dim_t * const adjncy,
+    val_t * const vwgt,
+    val_t * const ewgt,
+    double * progress)
+{
+  if (progress != nullptr) {
+    *progress = 0.0;
+  }
+
+  try {
+    IOStats::Record record("read graph", nullptr);
+    if (handle->mode != WILDRIVER_IN) {
+      throw BadParameterException( \
+          std::string("Cannot load graph in mode: ") + \
+          std::to_string(handle->mode));
+    }
+
+    // check input
+    if (handle->nvtxs == NULL_DIM) {
+      throw BadParameterException("Number of rows has not been set.");
+    }
+    if (handle->nedges == NULL_IND) {
+      throw BadParameterException("Number of edges has not been set.");
+    }
+    if (handle->fd == nullptr) {
+      throw BadParameterException("The file descriptor has not been set.");
+    }
+
+    GraphInHandle * const inHandle = \
+        reinterpret_cast<GraphInHandle*>(handle->fd);
+
+    // allocate graph
+    inHandle->readGraph(xadj, adjncy, vwgt, ewgt, progress);
+  } catch (std::exception const & e) {
+    std::cerr << "ERROR: failed to read graph due to: " << e.what() \
+        << std::endl;
+    return 0;
+  }
+
+  if (progress != nullptr) {
+    *progress = 1.0;
+  }
+
+  return 1;
+}
+
+extern "C" void wildriver_close_graph(
+    wildriver_graph_handle * handle)
+{
+  if (handle->fd != nullptr) {
+    if (handle->mode == WILDRIVER_IN) {
+      delete reinterpret_cast<GraphInHandle*>(handle->fd);
+    } else if (handle->mode == WILDRIVER_OUT) {
+      delete reinterpret_cast<GraphOutHandle*>(handle->fd);
+    } else {
+      std::cerr << "WARNING: unable to determine current mode" << \
+          handle->mode << std::endl;
+    }
+  }
+
+  delete handle;
+}
+
+
+
+
+extern "C" wildriver_vector_handle * wildriver_open_vector(
+    char const * const filename,
+    int const mode)
+{
+  try {
+    IOStats::Record record("open vector", filename);
+    std::unique_ptr<wildriver_vector_handle> handle(
+        new wildriver_vector_handle);
+
+    // initialize handle
+    handle->mode = mode;
+    handle->size = NULL_IND;
+    handle->fd = nullptr;
+
+    switch (mode) {
+      case WILDRIVER_IN: {
+          std::unique_ptr<VectorInHandle> ptr(new VectorInHandle(filename));
+          handle->size = ptr->getSize();
+          handle->fd = reinterpret_cast<void*>(ptr.release());
+        }
+        break;
+      case WILDRIVER_OUT: {
+          std::unique_ptr<VectorOutHandle> ptr(new VectorOutHandle(filename));
+          handle->fd = reinterpret_cast<void*>(ptr.release());
+        }
+        break;
+      default:
+        throw BadParameterException(std::string("Unknown vector mode: ") + \
+            std::to_string(mode));
+    }
+
+    return handle.release();
+  } catch (std::exception const & e) {
+    std::cerr << "ERROR: failed to open vector due to: " << e.what() \
+        << std::endl;
+    return nullptr;
+  }
+}
+
+
+extern "C" int wildriver_load_vector(
+    wildriver_vector_handle * handle,
+    val_t * const vals,
+    double * progress)
+{
+  if (progress != nullptr) {
+    *progress = 0.0;
+  }
+
+  try {
+    IOStats::Record record("read vector", nullptr);
+    if (handle->mode != WILDRIVER_IN) {
+      throw BadParameterException( \
+          std::string("Cannot load vector in mode: ") + \
+          std::to_string(handle->mode));
+    }
+
+    // check input
+    if (handle->size == NULL_IND) {
+      throw BadParameterException("The size of the vector has not been set.");
+    }
+    if (handle->fd == nullptr) {
+      throw BadParameterException("The file descriptor has not been set.");
+    }
+
+    VectorInHandle * const inHandle = \
+        reinterpret_cast<VectorInHandle*>(handle->fd);
+
+    // allocate vector
+    inHandle->read(vals,progress);
+  } catch (std::exception const & e) {
+    std::cerr << "ERROR: failed to read vector due to: " << e.what() \
+        << std::endl;
+    return 0;
+  }
+
+  if (progress != nullptr) {
+    *progress = 1.0;
+  }
+
+  return 1;
+}
+
+
+extern "C" int wildriver_save_vector(
+    wildriver_vector_handle * handle,
+    val_t const * const vals,
+    double * progress)
+{
+  if (progress != nullptr) {
+    *progress = 0.0;
+  }
+
+  try {
+    IOStats::Record record("write vector", nullptr);
+    if (handle->mode != WILDRIVER_OUT) {
+      throw BadParameterException( \
+          std::string("Cannot save vector in mode: ") + \
+          std::to_string(handle->mode));
+    }
+
+    // check input
+    if (handle->size == NULL_IND) {
+      throw BadParameterException("Size of vector has not been set.");
+    }
+    if (handle->fd == nullptr) {
+      throw BadParameterException("The file descriptor has not been set.");
+    }
+
+    VectorOutHandle * const outHandle = \
+        reinterpret_cast<VectorOutHandle*>(handle->fd);
+
+    // save matrix
+    outHandle->write(vals,handle->size,progress);
+  } catch (std::exception const & e) {
+    std::cerr << "ERROR: failed to save vector due to: " << e.what() \
+        << std::endl;
+    return 0;
+  }
+
+  if (progress != nullptr) {
+    *progress = 1.0;
+  }
+
+  return 1;
+}
+
+
+extern "C" void wildriver_close_vector(
+    wildriver_vector_handle * handle)
+{
+  if (handle->fd != nullptr) {
+    if (handle->mode == WILDRIVER_IN) {
+      delete reinterpret_cast<VectorInHandle*>(handle->fd);
+    } else if (handle->mode == WILDRIVER_OUT) {
+      delete reinterpret_cast<VectorOutHandle*>(handle->fd);
+    } else {
+      std::cerr << "WARNING: unable to determine current mode" << \
+          handle->mode << std::endl;
+    }
+  }
+
+  delete handle;
+}
+
+
+
+
+extern "C" wildriver_row_stream * wildriver_begin_rows(
+    char const * const fname)
+{
+  try {
+    std::unique_ptr<wildriver_row_stream> stream(new wildriver_row_stream);
+
+    std::unique_ptr<RowStream> ptr(new RowStream(fname));
+    ptr->getInfo(stream->nrows, stream->ncols, stream->nnz);
+    stream->row = 0;
+    stream->fd = reinterpret_cast<void*>(ptr.release());
+
+    return stream.release();
+  } catch (std::exception const & e) {
+    std::cerr << "ERROR: failed to begin rows due to: " << e.what() \
+        << std::endl;
+    return nullptr;
+  }
+}
+
+
+extern "C" int wildriver_next_rows(
+    wildriver_row_stream * const stream,
+    dim_t const maxrows,
+    ind_t const maxnnz,
+    dim_t * const r_nrows,
+    ind_t * const rowptr,
+    dim_t * const rowind,
+    val_t * const rowval)
+{
+  try {
+    RowStream * const rows = reinterpret_cast<RowStream*>(stream->fd);
+    *r_nrows = rows->nextRows(maxrows, maxnnz, rowptr, rowind, rowval);
+    stream->row = rows->getNextRowIndex();
+  } catch (std::exception const & e) {
+    std::cerr << "ERROR: failed to read rows due to: " << e.what() \
+        << std::endl;
+    return 0;
+  }
+
+  return 1;
+}
+
+
+extern "C" void wildriver_end_rows(
+    wildriver_row_stream * const stream)
+{
+  delete reinterpret_cast<RowStream*>(stream->fd);
+  delete stream;
+}
+
+
+extern "C" wildriver_async * wildriver_read_matrix_async(
+    char const * const fname,
+    void (* const callback)(
+        wildriver_async * async,
+        int status,
+        void * ctx),
+    void * const ctx)
+{
+  try {
+    std::string const name(fname);
+    return startAsync(WILDRIVER_ASYNC_MATRIX, callback, ctx, \
+        [name](AsyncLoad * const load) {
+      readMatrix(name.c_str(), nullptr, &load->nrows, &load->ncols, \
+          &load->nnz, &load->rowptr, &load->rowind, &load->rowval);
+    });
+  } catch (std::exception const & e) {
+    std::cerr << "ERROR: failed to start reading matrix due to: " << \
+        e.what() << std::endl;
+    return nullptr;
+  }
+}
+
+
+extern "C" wildriver_async * wildriver_read_graph_async(
+    char const * const fname,
+    void (* const callback)(
+        wildriver_async * async,
+        int status,
+        void * ctx),
+    void * const ctx)
+{
+  try {
+    std::string const name(fname);
+    return startAsync(WILDRIVER_ASYNC_GRAPH, callback, ctx, \
+        [name](AsyncLoad * const load) {
+      readGraph(name.c_str(), nullptr, &load->nrows, &load->nnz, \
+          &load->nvwgts, &load->ewgts, &load->rowptr, &load->rowind, \
+          &load->vwgt, &load->adjwgt);
+    });
+  } catch (std::exception const & e) {
+    std::cerr << "ERROR: failed to start reading graph due to: " << \
+        e.what() << std::endl;
+    return nullptr;
+  }
+}
+
+
+extern "C" void wildriver_async_cancel(
+    wildriver_async * const async)
+{
+  reinterpret_cast<AsyncLoad*>(async->fd)->cancel();
+}
+
+
+extern "C" void wildriver_async_get_progress(
+    wildriver_async const * const async,
+    wildriver_progress * const r_progress)
+{
+  *r_progress = reinterpret_cast<AsyncLoad const*>(async->fd)->getProgress();
+}
+
+
+extern "C" int wildriver_async_status(
+    wildriver_async const * const async)
+{
+  return reinterpret_cast<AsyncLoad const*>(async->fd)->getStatus();
+}
+
+
+extern "C" int wildriver_async_wait(
+    wildriver_async * const async)
+{
+  return reinterpret_cast<AsyncLoad*>(async->fd)->waitForFinish();
+}
+
+
+extern "C" int wildriver_async_get_matrix(
+    wildriver_async * const async,
+    dim_t * const r_nrows,
+    dim_t * const r_ncols,
+    ind_t * const r_nnz,
+    ind_t ** const r_rowptr,
+    dim_t ** const r_rowind,
+    val_t ** const r_rowval)
+{
+  try {
+    AsyncLoad * const load = getAsyncLoad(async, WILDRIVER_ASYNC_MATRIX);
+    load->take();
+
+    *r_nrows = load->nrows;
+    *r_ncols = load->ncols;
+    *r_nnz = load->nnz;
+    *r_rowptr = load->rowptr;
+    *r_rowind = load->rowind;
+    if (r_rowval) {
+      *r_rowval = load->rowval;
+    } else {
+      free(load->rowval);
+    }
+  } catch (std::exception const & e) {
+    std::cerr << "ERROR: failed to get matrix due to: " << e.what() \
+        << std::endl;
+    return 0;
+  }
+
+  return 1;
+}
+
+
+extern "C" int wildriver_async_get_graph(
+    wildriver_async * const async,
+    dim_t * const r_nvtxs,
+    ind_t * const r_nedges,
+    int * const r_nvwgts,
+    int * const r_ewgts,
+    ind_t ** const r_xadj,
+    dim_t ** const r_adjncy,
+    val_t ** const r_vwgt,
+    val_t ** const r_adjwgt)
+{
+  try {
+    AsyncLoad * const load = getAsyncLoad(async, WILDRIVER_ASYNC_GRAPH);
+    load->take();
+
+    *r_nvtxs = load->nrows;
+    *r_xadj = load->rowptr;
+    *r_adjncy = load->rowind;
+    if (r_nedges) {
+      *r_nedges = load->nnz;
+    }
+    if (r_nvwgts) {
+      *r_nvwgts = load->nvwgts;
+    }
+    if (r_ewgts) {
+      *r_ewgts = load->ewgts;
+    }
+    if (r_vwgt) {
+      *r_vwgt = load->vwgt;
+    } else {
+      free(load->vwgt);
+    }
+    if (r_adjwgt) {
+      *r_adjwgt = load->adjwgt;
+    } else {
+      free(load->adjwgt);
+    }
+  } catch (std::exception const & e) {
+    std::cerr << "ERROR: failed to get graph due to: " << e.what() \
+        << std::endl;
+    return 0;
+  }
+
+  return 1;
+}
+
+
+extern "C" void wildriver_async_free(
+    wildriver_async * const async)
+{
+  AsyncLoad * const load = reinterpret_cast<AsyncLoad*>(async->fd);
+  load->waitForFinish();
+
+  delete load;
+  delete async;
+}
+
+
+
+
+extern "C" void wildriver_init_convert_options(
+    wildriver_convert_options * const options)
+{
+  options->nthreads = 0;
+  options->chunk_size = 0;
+  options->queue_depth = 0;
+  options->symmetrize = 0;
+  options->labels = nullptr;
+  options->nlabels = 0;
+  options->filter = nullptr;
+  options->filter_ctx = nullptr;
+}
+
+
+extern "C" int wildriver_convert_matrix(
+    char const * const input,
+    char const * const output,
+    wildriver_convert_options const * options,
+    wildriver_stage_stats * const stats)
+{
+  try {
+    IOStats::Record record("convert matrix", input);
+    wildriver_convert_options defaults;
+    if (options == nullptr) {
+      wildriver_init_convert_options(&defaults);
+      options = &defaults;
+    }
+
+    ConversionPipeline pipeline(input, output);
+
+    pipeline.setNumThreads(options->nthreads);
+    pipeline.setChunkSize(options->chunk_size);
+    pipeline.setQueueDepth(options->queue_depth);
+    pipeline.setSymmetrize(options->symmetrize != 0);
+    if (options->labels != nullptr) {
+      pipeline.setColumnLabels(std::vector<dim_t>(options->labels, \
+          options->labels + options->nlabels));
+    }
+    if (options->filter != nullptr) {
+      auto const filter = options->filter;
+      void * const ctx = options->filter_ctx;
+      pipeline.setFilter([filter, ctx](dim_t row, dim_t col, val_t val) {
+        return filter(row, col, val, ctx) != 0;
+      });
+    }
+
+    pipeline.run();
+
+    if (stats != nullptr) {
+      for (int s = 0; s < WILDRIVER_NUM_STAGES; ++s) {
+        stats[s] = pipeline.getStageStats(s);
+      }
+    }
+  } catch (std::exception const & e) {
+    std::cerr << "ERROR: failed to convert matrix due to: " << e.what() \
+        << std::endl;
+    return 0;
+  }
+
+  return 1;
+}
+
+
+extern "C" void wildriver_init_external_options(
+    wildriver_external_options * const options)
+{
+  options->tmpdir = nullptr;
+  options->memory_budget = 0;
+  options->row_callback = nullptr;
+  options->row_ctx = nullptr;
+  options->nruns = 0;
+}
+
+
+extern "C" int wildriver_build_csr_external(
+    char const * const input,
+    char const * const output,
+    wildriver_external_options * options)
+{
+  try {
+    IOStats::Record record("build matrix", input);
+    wildriver_external_options defaults;
+    if (options == nullptr) {
+      wildriver_init_external_options(&defaults);
+      options = &defaults;
+    }
+
+    // select where the rows go
+    std::unique_ptr<IRowMatrixWriter> writer;
+    if (output == nullptr) {
+      if (options->row_callback == nullptr) {
+        throw BadParameterException("Either an output file or a row " \
+            "callback must be supplied.");
+      }
+      writer.reset(new RowCallbackWriter(options));
+    } else if (BCSRFile::hasExtension(output)) {
+      writer.reset(new BCSRFile(output));
+    } else if (CSRFile::hasExtension(output)) {
+      writer.reset(new CSRFile(output));
+    } else {
+      throw UnknownExtensionException(std::string("Output must be a CSR " \
+          "file: ") + output);
+    }
+
+    std::unique_ptr<ICoordinateReader> reader( \
+        CoordinateReaderFactory::make(input));
+
+    dim_t nrows, ncols;
+    ind_t nnz;
+    reader->getInfo(nrows, ncols, nnz);
+
+    // the reader's count bounds the entries, so small inputs do not take
+    // the whole budget
+    ExternalCSRBuilder builder( \
+        options->tmpdir != nullptr ? options->tmpdir : "", \
+        options->memory_budget, static_cast<size_t>(nnz));
+    reader->readEntries([&builder](dim_t row, dim_t col, val_t val) {
+      builder.add(row, col, val);
+    }, nullptr);
+
+    builder.build(nrows, ncols, writer.get());
+
+    options->nruns = builder.getNumRuns();
+  } catch (std::exception const & e) {
+    std::cerr << "ERROR: failed to build matrix due to: " << e.what() \
+        << std::endl;
+    return 0;
+  }
+
+  return 1;
+}
+
+
+
+
+extern "C" void wildriver_init_generator_options(
+    wildriver_generator_options * const options)
+{
+  options->kind = WILDRIVER_GENERATOR_RMAT;
+  options->nrows = 0;
+  options->ncols = 0;
+  options->nnz = 0;
+  options->a = 0.57;
+  options->b = 0.19;
+  options->c = 0.19;
+  options->bandwidth = 1;
+  options->symmetric = 0;
+  options->values = 1;
+  options->seed = 0;
+  options->nnz_written = 0;
+}
+
+
+extern "C" int wildriver_generate_matrix(
+    char const * const output,
+    wildriver_generator_options * const options)
+{
+  try {
+    IOStats::Record record("generate matrix", output);
+    Generator generator(options->nrows, options->ncols, options->seed);
+    switch (options->kind) {
+      case WILDRIVER_GENERATOR_RMAT:
+        generator.setRMat(options->nnz, options->a, options->b, options->c);
+        break;
+      case WILDRIVER_GENERATOR_UNIFORM:
+        generator.setUniform(options->nnz);
+        break;
+      case WILDRIVER_GENERATOR_BANDED:
+        generator.setBanded(options->bandwidth);
+        break;
+      default:
+        throw BadParameterException(std::string("Unknown generator: ") + \
+            std::to_string(options->kind));
+    }
+    generator.setSymmetric(options->symmetric != 0);
+    generator.setValues(options->values != 0);
+
+    // select the writer, graphs having no self loops or weights
+    std::unique_ptr<IRowMatrixWriter> writer;
+    if (BCSRFile::hasExtension(output)) {
+      writer.reset(new BCSRFile(output));
+    } else if (CSRFile::hasExtension(output)) {
+      writer.reset(new CSRFile(output));
+    } else if (MatrixMarketFile::hasExtension(output)) {
+      writer.reset(new MatrixMarketFile(output));
+    } else if (MetisFile::hasExtension(output)) {
+      if (options->symmetric == 0) {
+        throw BadParameterException("METIS graphs must be symmetric.");
+      }
+      writer.reset(new MetisFile(output));
+      generator.setDiagonal(false);
+      generator.setValues(false);
+    } else if (SNAPFile::hasExtension(output)) {
+      writer.reset(new SNAPFile(output));
+      generator.setDiagonal(false);
+      generator.setValues(false);
+    } else {
+      throw UnknownExtensionException(std::string("Unknown output " \
+          "format: ") + output);
+    }
+
+    options->nnz_written = generator.write(writer.get());
+  } catch (std::exception const & e) {
+    std::cerr << "ERROR: failed to generate matrix due to: " << e.what() \
+        << std::endl;
+    return 0;
+  }
+
+  return 1;
+}
+
+
+extern "C" void wildriver_set_alloc_flags(
+    int const flags)
+{
+  allocFlags.store(flags);
+}
+
+
+extern "C" int wildriver_get_alloc_flags(void)
+{
+  return allocFlags.load();
+}
+
+
+extern "C" void wildriver_set_num_threads(
+    int const nthreads)
+{
+  ThreadPool::getInstance().setNumThreads(nthreads);
+}
+
+
+extern "C" int wildriver_get_num_threads(void)
+{
+  return ThreadPool::getInstance().getNumThreads();
 }
 
 
-/******************************************************************************
-* API FUNCTIONS ***************************************************************
-******************************************************************************/
+extern "C" void wildriver_set_memory_budget(
+    size_t const bytes)
+{
+  MemoryBudget::set(bytes);
+}
 
 
-extern "C" wildriver_matrix_handle * wildriver_open_matrix(
-    char const * const filename,
-    int const mode)
+extern "C" size_t wildriver_get_memory_budget(void)
 {
-  try {
-    std::unique_ptr<wildriver_matrix_handle> handle(
-        new wildriver_matrix_handle);
+  return MemoryBudget::get();
+}
 
-    // initialize handle
-    handle->mode = mode;
-    handle->nrows = NULL_DIM;
-    handle->ncols = NULL_DIM;
-    handle->nnz = NULL_IND;
-    handle->fd = nullptr;
 
-    switch (mode) {
-      case WILDRIVER_IN: {
-          std::unique_ptr<MatrixInHandle> ptr(new MatrixInHandle(filename));
-          ptr->getInfo(handle->nrows,handle->ncols,handle->nnz);
-          handle->fd = reinterpret_cast<void*>(ptr.release());
-        }
-        break;
-      case WILDRIVER_OUT: {
-          std::unique_ptr<MatrixOutHandle> ptr(new MatrixOutHandle(filename));
-          handle->fd = reinterpret_cast<void*>(ptr.release());
-        }
-        break;
-      default:
-        throw BadParameterException(std::string("Unknown matrix mode: ") + \
-            std::to_string(mode));
-    }
+extern "C" void wildriver_set_output_compression(
+    int const compression)
+{
+  switch (compression) {
+    case WILDRIVER_COMPRESSION_GZIP:
+      Compression::setOutputCompression(COMPRESSION_GZIP);
+      break;
+    case WILDRIVER_COMPRESSION_ZSTD:
+      Compression::setOutputCompression(COMPRESSION_ZSTD);
+      break;
+    default:
+      Compression::setOutputCompression(COMPRESSION_NONE);
+      break;
+  }
+}
 
-    return handle.release();
-  } catch (std::exception const & e) {
-    std::cerr << "ERROR: failed to open matrix due to: " << e.what() \
-        << std::endl;
-    return nullptr;
+
+extern "C" int wildriver_get_output_compression(void)
+{
+  switch (Compression::getOutputCompression()) {
+    case COMPRESSION_GZIP:
+      return WILDRIVER_COMPRESSION_GZIP;
+    case COMPRESSION_ZSTD:
+      return WILDRIVER_COMPRESSION_ZSTD;
+    default:
+      return WILDRIVER_COMPRESSION_NONE;
   }
 }
 
 
-extern "C" int wildriver_load_matrix(
-    wildriver_matrix_handle * const handle,
-    ind_t * const rowptr,
-    dim_t * const rowind,
-    val_t * const rowval,
-    double * progress)
+extern "C" void wildriver_set_read_backend(
+    int const backend)
 {
-  if (progress != nullptr) {
-    *progress = 0.0;
+  switch (backend) {
+    case WILDRIVER_READ_MMAP:
+      ReadBackend::set(READ_BACKEND_MMAP);
+      break;
+    case WILDRIVER_READ_ASYNC:
+      ReadBackend::set(READ_BACKEND_ASYNC);
+      break;
+    default:
+      ReadBackend::set(READ_BACKEND_BUFFERED);
+      break;
   }
+}
 
-  try {
-    if (handle->mode != WILDRIVER_IN) {
-      throw BadParameterException( \
-          std::string("Cannot load matrix in mode: ") + \
-          std::to_string(handle->mode));
-    }
 
-    // check input
-    if (handle->nrows == NULL_DIM) {
-      throw BadParameterException("Number of rows has not been set.");
-    }
-    if (handle->ncols == NULL_DIM) {
-      throw BadParameterException("Number of columns has not been set.");
-    }
-    if (handle->nnz == NULL_IND) {
-      throw BadParameterException("Number of non-zeros has not been set.");
-    }
-    if (handle->fd == nullptr) {
-      throw BadParameterException("The file descriptor has not been set.");
-    }
+extern "C" int wildriver_get_read_backend(void)
+{
+  switch (ReadBackend::get()) {
+    case READ_BACKEND_MMAP:
+      return WILDRIVER_READ_MMAP;
+    case READ_BACKEND_ASYNC:
+      return WILDRIVER_READ_ASYNC;
+    default:
+      return WILDRIVER_READ_BUFFERED;
+  }
+}
 
-    MatrixInHandle * const inHandle = \
-        reinterpret_cast<MatrixInHandle*>(handle->fd);
 
-    // allocate matrix
-    inHandle->readSparse(rowptr,rowind,rowval,progress);
+extern "C" int wildriver_read_matrix_alloc(
+    char const * const fname,
+    wildriver_allocator const * const allocator,
+    dim_t * const r_nrows,
+    dim_t * const r_ncols,
+    ind_t * const r_nnz,
+    ind_t ** const r_rowptr,
+    dim_t ** const r_rowind,
+    val_t ** const r_rowval)
+{
+  try {
+    IOStats::Record record("read matrix", fname);
+    checkAllocator(allocator);
+    readMatrix(fname, allocator, r_nrows, r_ncols, r_nnz, r_rowptr, \
+        r_rowind, r_rowval);
   } catch (std::exception const & e) {
     std::cerr << "ERROR: failed to read matrix due to: " << e.what() \
         << std::endl;
     return 0;
   }
 
-  if (progress != nullptr) {
-    *progress = 1.0;
-  }
-
   return 1;
 }
 
 
-extern "C" int wildriver_save_matrix(
-    wildriver_matrix_handle * const handle,
-    ind_t const * const rowptr,
-    dim_t const * const rowind,
-    val_t const * const rowval,
-    double * const progress)
+extern "C" int wildriver_read_graph_alloc(
+    char const * const fname,
+    wildriver_allocator const * const allocator,
+    dim_t * const r_nvtxs,
+    ind_t * const r_nedges,
+    int * const r_nvwgts,
+    int * const r_ewgts,
+    ind_t ** const r_xadj,
+    dim_t ** const r_adjncy,
+    val_t ** const r_vwgt,
+    val_t ** const r_adjwgt)
 {
-  if (progress != nullptr) {
-    *progress = 0.0;
-  }
-
   try {
-    if (handle->mode != WILDRIVER_OUT) {
-      throw BadParameterException( \
-          std::string("Cannot save matrix in mode: ") + \
-          std::to_string(handle->mode));
-    }
-
-    // check input
-    if (handle->nrows == NULL_DIM) {
-      throw BadParameterException("Number of rows has not been set.");
-    }
-    if (handle->ncols == NULL_DIM) {
-      throw BadParameterException("Number of columns has not been set.");
-    }
-    if (handle->nnz == NULL_IND) {
-      throw BadParameterException("Number of non-zeros has not been set.");
-    }
-    if (handle->fd == nullptr) {
-      throw BadParameterException("The file descriptor has not been set.");
-    }
-
-    MatrixOutHandle * const outHandle = \
-        reinterpret_cast<MatrixOutHandle*>(handle->fd);
-
-    // save matrix
-    outHandle->setInfo(handle->nrows,handle->ncols,handle->nnz);
-    outHandle->writeSparse(rowptr,rowind,rowval);
+    IOStats::Record record("read graph", fname);
+    checkAllocator(allocator);
+    readGraph(fname, allocator, r_nvtxs, r_nedges, r_nvwgts, r_ewgts, \
+        r_xadj, r_adjncy, r_vwgt, r_adjwgt);
   } catch (std::exception const & e) {
-    std::cerr << "ERROR: failed to save matrix due to: " << e.what() \
+    std::cerr << "ERROR: failed to read graph due to: " << e.what() \
         << std::endl;
     return 0;
   }
 
-  if (progress != nullptr) {
-    *progress = 1.0;
-  }
-
   return 1;
 }
 
 
-extern "C" void wildriver_close_matrix(
-    wildriver_matrix_handle * handle)
+extern "C" int wildriver_read_matrix_rows(
+    char const * const fname,
+    dim_t const begin,
+    dim_t const end,
+    dim_t * const r_nrows,
+    dim_t * const r_ncols,
+    ind_t * const r_nnz,
+    ind_t ** const r_rowptr,
+    dim_t ** const r_rowind,
+    val_t ** const r_rowval)
 {
-  if (handle->fd != nullptr) {
-    if (handle->mode == WILDRIVER_IN) {
-      delete reinterpret_cast<MatrixInHandle*>(handle->fd);
-    } else if (handle->mode == WILDRIVER_OUT) {
-      delete reinterpret_cast<MatrixOutHandle*>(handle->fd);
-    } else {
-      std::cerr << "WARNING: unable to determine current mode" << \
-          handle->mode << std::endl;
-    }
+  try {
+    IOStats::Record record("read matrix rows", fname);
+    MatrixInHandle handle(fname);
+    readMatrixRange(handle, begin, end, r_nrows, r_ncols, r_nnz, r_rowptr, \
+        r_rowind, r_rowval);
+  } catch (std::exception const & e) {
+    std::cerr << "ERROR: failed to read matrix rows due to: " << e.what() \
+        << std::endl;
+    return 0;
   }
 
-  delete handle;
+  return 1;
 }
 
-extern "C" wildriver_graph_handle * wildriver_open_graph(
-    char const * const filename,
-    int const mode)
+
+extern "C" int wildriver_read_matrix_part(
+    char const * const fname,
+    int const nparts,
+    int const part,
+    dim_t * const r_nrows,
+    dim_t * const r_ncols,
+    dim_t * const r_begin,
+    dim_t * const r_end,
+    ind_t * const r_nnz,
+    ind_t ** const r_rowptr,
+    dim_t ** const r_rowind,
+    val_t ** const r_rowval)
 {
   try {
-    std::unique_ptr<wildriver_graph_handle> handle(
-        new wildriver_graph_handle);
-
-    // initialize handle
-    handle->mode = mode;
-    handle->nvtxs = NULL_DIM;
-    handle->nedges = NULL_IND;
-    handle->fd = nullptr;
-
-    bool ewgt_present;
-
-    switch (mode) {
-      case WILDRIVER_IN: {
-          std::unique_ptr<GraphInHandle> ptr(new GraphInHandle(filename));
-          ptr->getInfo(handle->nvtxs, handle->nedges, handle->nvwgt, \
-              ewgt_present);
-          handle->ewgt = static_cast<int>(ewgt_present);
-          handle->fd = reinterpret_cast<void*>(ptr.release());
-        }
-        break;
-      case WILDRIVER_OUT: {
-          std::unique_ptr<GraphOutHandle> ptr(new GraphOutHandle(filename));
-          handle->fd = reinterpret_cast<void*>(ptr.release());
-        }
-        break;
-      default:
-        throw BadParameterException(std::string("Unknown graph mode: ") + \
-            std::to_string(mode));
+    IOStats::Record record("read matrix part", fname);
+    if (part < 0 || part >= nparts) {
+      throw BadParameterException(std::string("Invalid part ") + \
+          std::to_string(part) + std::string(" of ") + \
+          std::to_string(nparts));
     }
 
-    return handle.release();
+    MatrixInHandle handle(fname);
+    std::vector<dim_t> const starts = handle.getPartition(nparts);
+    readMatrixRange(handle, starts[part], starts[part+1], r_nrows, r_ncols, \
+        r_nnz, r_rowptr, r_rowind, r_rowval);
+
+    *r_begin = starts[part];
+    *r_end = starts[part+1];
   } catch (std::exception const & e) {
-    std::cerr << "ERROR: failed to open graph due to: " << e.what() \
+    std::cerr << "ERROR: failed to read matrix part due to: " << e.what() \
         << std::endl;
-    return nullptr;
+    return 0;
   }
+
+  return 1;
 }
 
 
-extern "C" int wildriver_load_graph(
-    wildriver_graph_handle * const handle,
-    ind_t * const xadj,
-    dim_t * const adjncy,
-    val_t * const vwgt,
-    val_t * const ewgt,
-    double * progress)
+extern "C" int wildriver_read_graph_vertices(
+    char const * const fname,
+    dim_t const begin,
+    dim_t const end,
+    dim_t * const r_nvtxs,
+    ind_t * const r_nedges,
+    int * const r_nvwgts,
+    int * const r_ewgts,
+    ind_t ** const r_xadj,
+    dim_t ** const r_adjncy,
+    val_t ** const r_vwgt,
+    val_t ** const r_adjwgt)
 {
-  if (progress != nullptr) {
-    *progress = 0.0;
+  try {
+    IOStats::Record record("read graph vertices", fname);
+    GraphInHandle handle(fname);
+    readGraphRange(handle, begin, end, r_nvtxs, r_nedges, r_nvwgts, r_ewgts, \
+        r_xadj, r_adjncy, r_vwgt, r_adjwgt);
+  } catch (std::exception const & e) {
+    std::cerr << "ERROR: failed to read graph vertices due to: " << \
+        e.what() << std::endl;
+    return 0;
   }
 
-  try {
-    if (handle->mode != WILDRIVER_IN) {
-      throw BadParameterException( \
-          std::string("Cannot load graph in mode: ") + \
-          std::to_string(handle->mode));
-    }
+  return 1;
+}
 
-    // check input
-    if (handle->nvtxs == NULL_DIM) {
-      throw BadParameterException("Number of rows has not been set.");
-    }
-    if (handle->nedges == NULL_IND) {
-      throw BadParameterException("Number of edges has not been set.");
-    }
-    if (handle->fd == nullptr) {
-      throw BadParameterException("The file descriptor has not been set.");
+
+extern "C" int wildriver_read_graph_part(
+    char const * const fname,
+    int const nparts,
+    int const part,
+    dim_t * const r_nvtxs,
+    dim_t * const r_begin,
+    dim_t * const r_end,
+    ind_t * const r_nedges,
+    int * const r_nvwgts,
+    int * const r_ewgts,
+    ind_t ** const r_xadj,
+    dim_t ** const r_adjncy,
+    val_t ** const r_vwgt,
+    val_t ** const r_adjwgt)
+{
+  try {
+    IOStats::Record record("read graph part", fname);
+    if (part < 0 || part >= nparts) {
+      throw BadParameterException(std::string("Invalid part ") + \
+          std::to_string(part) + std::string(" of ") + \
+          std::to_string(nparts));
     }
 
-    GraphInHandle * const inHandle = \
-        reinterpret_cast<GraphInHandle*>(handle->fd);
+    GraphInHandle handle(fname);
+    std::vector<dim_t> const starts = handle.getPartition(nparts);
+    readGraphRange(handle, starts[part], starts[part+1], r_nvtxs, r_nedges, \
+        r_nvwgts, r_ewgts, r_xadj, r_adjncy, r_vwgt, r_adjwgt);
 
-    // allocate graph
-    inHandle->readGraph(xadj, adjncy, vwgt, ewgt, progress);
+    *r_begin = starts[part];
+    *r_end = starts[part+1];
   } catch (std::exception const & e) {
-    std::cerr << "ERROR: failed to read graph due to: " << e.what() \
+    std::cerr << "ERROR: failed to read graph part due to: " << e.what() \
         << std::endl;
     return 0;
   }
 
-  if (progress != nullptr) {
-    *progress = 1.0;
-  }
-
   return 1;
 }
 
-extern "C" void wildriver_close_graph(
-    wildriver_graph_handle * handle)
+
+extern "C" wildriver_cancel_token * wildriver_create_cancel_token(void)
 {
-  if (handle->fd != nullptr) {
-    if (handle->mode == WILDRIVER_IN) {
-      delete reinterpret_cast<GraphInHandle*>(handle->fd);
-    } else if (handle->mode == WILDRIVER_OUT) {
-      delete reinterpret_cast<GraphOutHandle*>(handle->fd);
-    } else {
-      std::cerr << "WARNING: unable to determine current mode" << \
-          handle->mode << std::endl;
-    }
+  try {
+    std::unique_ptr<wildriver_cancel_token> token( \
+        new wildriver_cancel_token);
+    token->fd = reinterpret_cast<void*>(new CancelToken);
+
+    return token.release();
+  } catch (std::exception const & e) {
+    std::cerr << "ERROR: failed to create cancel token due to: " << \
+        e.what() << std::endl;
+    return nullptr;
   }
+}
 
-  delete handle;
+
+extern "C" void wildriver_cancel(
+    wildriver_cancel_token * const token)
+{
+  reinterpret_cast<CancelToken*>(token->fd)->cancel();
 }
 
 
+extern "C" void wildriver_set_deadline(
+    wildriver_cancel_token * const token,
+    double const seconds)
+{
+  reinterpret_cast<CancelToken*>(token->fd)->setDeadline(seconds);
+}
 
 
-extern "C" wildriver_vector_handle * wildriver_open_vector(
-    char const * const filename,
-    int const mode)
+extern "C" void wildriver_free_cancel_token(
+    wildriver_cancel_token * const token)
 {
-  try {
-    std::unique_ptr<wildriver_vector_handle> handle(
-        new wildriver_vector_handle);
+  delete reinterpret_cast<CancelToken*>(token->fd);
+  delete token;
+}
 
-    // initialize handle
-    handle->mode = mode;
-    handle->size = NULL_IND;
-    handle->fd = nullptr;
 
-    switch (mode) {
-      case WILDRIVER_IN: {
-          std::unique_ptr<VectorInHandle> ptr(new VectorInHandle(filename));
-          handle->size = ptr->getSize();
-          handle->fd = reinterpret_cast<void*>(ptr.release());
-        }
-        break;
-      case WILDRIVER_OUT: {
-          std::unique_ptr<VectorOutHandle> ptr(new VectorOutHandle(filename));
-          handle->fd = reinterpret_cast<void*>(ptr.release());
-        }
-        break;
-      default:
-        throw BadParameterException(std::string("Unknown vector mode: ") + \
-            std::to_string(mode));
-    }
+extern "C" void wildriver_set_thread_cancel_token(
+    wildriver_cancel_token const * const token)
+{
+  CancelToken::setCurrent(token != nullptr ? \
+      reinterpret_cast<CancelToken const*>(token->fd) : nullptr);
+}
 
-    return handle.release();
+
+extern "C" int wildriver_read_matrix_cancellable(
+    char const * const fname,
+    wildriver_cancel_token const * const token,
+    dim_t * const r_nrows,
+    dim_t * const r_ncols,
+    ind_t * const r_nnz,
+    ind_t ** const r_rowptr,
+    dim_t ** const r_rowind,
+    val_t ** const r_rowval)
+{
+  try {
+    IOStats::Record record("read matrix", fname);
+    CancelToken::Scope scope( \
+        reinterpret_cast<CancelToken const*>(token->fd));
+    readMatrix(fname, nullptr, r_nrows, r_ncols, r_nnz, r_rowptr, r_rowind, \
+        r_rowval);
+  } catch (DeadlineExceededException const & e) {
+    std::cerr << "ERROR: failed to read matrix due to: " << e.what() \
+        << std::endl;
+    return WILDRIVER_ERROR_DEADLINE;
+  } catch (CancelledException const & e) {
+    std::cerr << "ERROR: failed to read matrix due to: " << e.what() \
+        << std::endl;
+    return WILDRIVER_ERROR_CANCELLED;
   } catch (std::exception const & e) {
-    std::cerr << "ERROR: failed to open vector due to: " << e.what() \
+    std::cerr << "ERROR: failed to read matrix due to: " << e.what() \
         << std::endl;
-    return nullptr;
+    return WILDRIVER_ERROR;
   }
+
+  return WILDRIVER_SUCCESS;
 }
 
 
-extern "C" int wildriver_load_vector(
-    wildriver_vector_handle * handle,
-    val_t * const vals,
-    double * progress)
+extern "C" int wildriver_read_graph_cancellable(
+    char const * const fname,
+    wildriver_cancel_token const * const token,
+    dim_t * const r_nvtxs,
+    ind_t * const r_nedges,
+    int * const r_nvwgts,
+    int * const r_ewgts,
+    ind_t ** const r_xadj,
+    dim_t ** const r_adjncy,
+    val_t ** const r_vwgt,
+    val_t ** const r_adjwgt)
 {
-  if (progress != nullptr) {
-    *progress = 0.0;
+  try {
+    IOStats::Record record("read graph", fname);
+    CancelToken::Scope scope( \
+        reinterpret_cast<CancelToken const*>(token->fd));
+    readGraph(fname, nullptr, r_nvtxs, r_nedges, r_nvwgts, r_ewgts, r_xadj, \
+        r_adjncy, r_vwgt, r_adjwgt);
+  } catch (DeadlineExceededException const & e) {
+    std::cerr << "ERROR: failed to read graph due to: " << e.what() \
+        << std::endl;
+    return WILDRIVER_ERROR_DEADLINE;
+  } catch (CancelledException const & e) {
+    std::cerr << "ERROR: failed to read graph due to: " << e.what() \
+        << std::endl;
+    return WILDRIVER_ERROR_CANCELLED;
+  } catch (std::exception const & e) {
+    std::cerr << "ERROR: failed to read graph due to: " << e.what() \
+        << std::endl;
+    return WILDRIVER_ERROR;
   }
 
+  return WILDRIVER_SUCCESS;
+}
+
+
+extern "C" wildriver_progress_monitor * wildriver_create_progress_monitor(
+    void (* const callback)(
+        wildriver_progress const * progress,
+        void * ctx),
+    void * const ctx,
+    double const interval)
+{
   try {
-    if (handle->mode != WILDRIVER_IN) {
-      throw BadParameterException( \
-          std::string("Cannot load vector in mode: ") + \
-          std::to_string(handle->mode));
+    std::unique_ptr<wildriver_progress_monitor> monitor( \
+        new wildriver_progress_monitor);
+
+    ProgressMonitor::callback_type func;
+    if (callback != nullptr) {
+      func = [callback, ctx](wildriver_progress const & progress) {
+        callback(&progress, ctx);
+      };
     }
+    monitor->fd = reinterpret_cast<void*>(new ProgressMonitor(func, \
+        interval));
 
-    // check input
-    if (handle->size == NULL_IND) {
-      throw BadParameterException("The size of the vector has not been set.");
-    }
-    if (handle->fd == nullptr) {
-      throw BadParameterException("The file descriptor has not been set.");
-    }
+    return monitor.release();
+  } catch (std::exception const & e) {
+    std::cerr << "ERROR: failed to create progress monitor due to: " << \
+        e.what() << std::endl;
+    return nullptr;
+  }
+}
 
-    VectorInHandle * const inHandle = \
-        reinterpret_cast<VectorInHandle*>(handle->fd);
 
-    // allocate vector
-    inHandle->read(vals,progress);
+extern "C" void wildriver_set_thread_progress(
+    wildriver_progress_monitor * const monitor)
+{
+  ProgressMonitor::setCurrent(monitor != nullptr ? \
+      reinterpret_cast<ProgressMonitor*>(monitor->fd) : nullptr);
+}
+
+
+extern "C" void wildriver_get_progress(
+    wildriver_progress_monitor const * const monitor,
+    wildriver_progress * const r_progress)
+{
+  *r_progress = \
+      reinterpret_cast<ProgressMonitor const*>(monitor->fd)->getProgress();
+}
+
+
+extern "C" void wildriver_free_progress_monitor(
+    wildriver_progress_monitor * const monitor)
+{
+  delete reinterpret_cast<ProgressMonitor*>(monitor->fd);
+  delete monitor;
+}
+
+
+extern "C" int wildriver_get_last_stats(
+    wildriver_stats * const r_stats)
+{
+  return IOStats::getLast(r_stats) ? 1 : 0;
+}
+
+
+extern "C" void wildriver_set_tracing(
+    int const enable)
+{
+  Tracer::setEnabled(enable != 0);
+}
+
+
+extern "C" int wildriver_write_trace(
+    char const * const filename)
+{
+  try {
+    Tracer::dump(filename);
   } catch (std::exception const & e) {
-    std::cerr << "ERROR: failed to read vector due to: " << e.what() \
+    std::cerr << "ERROR: failed to write trace due to: " << e.what() \
         << std::endl;
     return 0;
   }
 
-  if (progress != nullptr) {
-    *progress = 1.0;
-  }
-
   return 1;
 }
 
 
-extern "C" int wildriver_save_vector(
-    wildriver_vector_handle * handle,
-    val_t const * const vals,
-    double * progress)
+extern "C" void wildriver_clear_trace(void)
 {
-  if (progress != nullptr) {
-    *progress = 0.0;
-  }
+  Tracer::clear();
+}
 
-  try {
-    if (handle->mode != WILDRIVER_OUT) {
-      throw BadParameterException( \
-          std::string("Cannot save vector in mode: ") + \
-          std::to_string(handle->mode));
-    }
 
-    // check input
-    if (handle->size == NULL_IND) {
-      throw BadParameterException("Size of vector has not been set.");
-    }
-    if (handle->fd == nullptr) {
-      throw BadParameterException("The file descriptor has not been set.");
+extern "C" size_t wildriver_read_matrix_batch(
+    wildriver_matrix_slot * const slots,
+    size_t const nslots,
+    int const values)
+{
+  try {
+    std::vector<std::string> const names = getBatchNames(slots, nslots);
+    for (size_t i = 0; i < nslots; ++i) {
+      slots[i].rowptr = nullptr;
+      slots[i].rowind = nullptr;
+      slots[i].rowval = nullptr;
     }
 
-    VectorOutHandle * const outHandle = \
-        reinterpret_cast<VectorOutHandle*>(handle->fd);
+    std::vector<std::exception_ptr> const errors = BatchLoader::load(names, \
+        [slots, values](size_t const i) {
+      wildriver_matrix_slot & slot = slots[i];
+      readMatrix(slot.fname, nullptr, &slot.nrows, &slot.ncols, &slot.nnz, \
+          &slot.rowptr, &slot.rowind, values ? &slot.rowval : nullptr);
+    });
 
-    // save matrix
-    outHandle->write(vals,handle->size,progress);
+    return finishBatch(slots, errors);
   } catch (std::exception const & e) {
-    std::cerr << "ERROR: failed to save vector due to: " << e.what() \
+    std::cerr << "ERROR: failed to read matrix batch due to: " << e.what() \
         << std::endl;
     return 0;
   }
-
-  if (progress != nullptr) {
-    *progress = 1.0;
-  }
-
-  return 1;
 }
 
 
-extern "C" void wildriver_close_vector(
-    wildriver_vector_handle * handle)
+extern "C" size_t wildriver_read_vector_batch(
+    wildriver_vector_slot * const slots,
+    size_t const nslots)
 {
-  if (handle->fd != nullptr) {
-    if (handle->mode == WILDRIVER_IN) {
-      delete reinterpret_cast<VectorInHandle*>(handle->fd);
-    } else if (handle->mode == WILDRIVER_OUT) {
-      delete reinterpret_cast<VectorOutHandle*>(handle->fd);
-    } else {
-      std::cerr << "WARNING: unable to determine current mode" << \
-          handle->mode << std::endl;
+  try {
+    std::vector<std::string> const names = getBatchNames(slots, nslots);
+    for (size_t i = 0; i < nslots; ++i) {
+      slots[i].vals = nullptr;
     }
-  }
 
-  delete handle;
+    std::vector<std::exception_ptr> const errors = BatchLoader::load(names, \
+        [slots](size_t const i) {
+      wildriver_vector_slot & slot = slots[i];
+
+      VectorInHandle handle(slot.fname);
+      ind_t const size = handle.getSize();
+
+      LoaderArray<val_t> vals(nullptr);
+      vals.allocate(size);
+      handle.read(vals.get(), nullptr);
+
+      slot.size = size;
+      slot.vals = vals.release();
+    });
+
+    return finishBatch(slots, errors);
+  } catch (std::exception const & e) {
+    std::cerr << "ERROR: failed to read vector batch due to: " << e.what() \
+        << std::endl;
+    return 0;
+  }
 }
 
 
@@ -488,52 +2652,9 @@ extern "C" int wildriver_read_matrix(
     val_t ** const r_rowval)
 {
   try {
-    MatrixInHandle handle(fname);
-
-    dim_t nrows, ncols;
-    ind_t nnz;
-
-    // read the header
-    handle.getInfo(nrows,ncols,nnz);
-
-    // allocate matrix
-    size_t nbytes = sizeof(ind_t)*(nrows+1);
-    std::unique_ptr<ind_t,c_delete> rowptr((ind_t*)malloc(nbytes));
-    if (!rowptr.get()) {
-      throw OutOfMemoryException(nbytes);
-    }
-
-    nbytes = sizeof(dim_t)*nnz;
-    std::unique_ptr<dim_t,c_delete> rowind((dim_t*)malloc(nbytes));
-    if (!rowind.get()) {
-      throw OutOfMemoryException(nbytes);
-    }
-
-    std::unique_ptr<val_t,c_delete> rowval;
-    if (r_rowval) {
-      // we need to use rowval
-      nbytes = sizeof(val_t)*nnz;
-      rowval.reset((val_t*)malloc(nbytes));
-      if (!rowind.get()) {
-        throw OutOfMemoryException(nbytes);
-      }
-    } else {
-      // don't allocate rowval
-      nbytes = 0;
-    }
-
-    handle.readSparse(rowptr.get(),rowind.get(),rowval.get());
-
-    // we've completely succeed -- assign pointers
-    *r_nrows = nrows;
-    *r_ncols = ncols;
-    *r_nnz = nnz;
-
-    *r_rowptr = rowptr.release();
-    *r_rowind = rowind.release();
-    if (r_rowval) {
-      *r_rowval = rowval.release();
-    }
+    IOStats::Record record("read matrix", fname);
+    readMatrix(fname, nullptr, r_nrows, r_ncols, r_nnz, r_rowptr, r_rowind, \
+        r_rowval);
   } catch (std::exception const & e) {
     std::cerr << "ERROR: failed to read matrix due to: " << e.what() \
         << std::endl;
@@ -553,7 +2674,8 @@ extern "C" int wildriver_write_matrix(
     dim_t const * const rowind,
     val_t const * const rowval)
 {
-  try{
+  try {
+    IOStats::Record record("write matrix", fname);
     MatrixOutHandle handle(fname);
 
     handle.setInfo(nrows,ncols,nnz);
@@ -581,74 +2703,9 @@ extern "C" int wildriver_read_graph(
     val_t ** const r_adjwgt)
 {
   try {
-    GraphInHandle handle(fname);
-
-    dim_t nvtxs;
-    ind_t nedges;
-    int nvwgts;
-    bool ewgts;
-
-    // read the header
-    handle.getInfo(nvtxs,nedges,nvwgts,ewgts);
-
-    // allocate matrix
-    size_t nbytes = sizeof(ind_t)*(nvtxs+1);
-    std::unique_ptr<ind_t,c_delete> xadj((ind_t*)malloc(nbytes));
-    if (!xadj.get()) {
-      throw OutOfMemoryException(nbytes);
-    }
-
-    nbytes = sizeof(dim_t)*nedges;
-    std::unique_ptr<dim_t,c_delete> adjncy((dim_t*)malloc(nbytes));
-    if (!adjncy.get()) {
-      throw OutOfMemoryException(nbytes);
-    }
-
-    std::unique_ptr<val_t> vwgt;
-    if (r_vwgt && nvwgts > 0) {
-      // we need to use rowval
-      nbytes = sizeof(val_t)*nvtxs*nvwgts;
-      vwgt.reset((val_t*)malloc(nbytes));
-      if (!adjncy.get()) {
-        throw OutOfMemoryException(nbytes);
-      }
-    }
-
-    std::unique_ptr<val_t,c_delete> adjwgt;
-    if (r_adjwgt) {
-      // we need to use rowval
-      nbytes = sizeof(val_t)*nedges;
-      adjwgt.reset((val_t*)malloc(nbytes));
-      if (!adjncy.get()) {
-        throw OutOfMemoryException(nbytes);
-      }
-    }
-
-    handle.readGraph(xadj.get(),adjncy.get(),vwgt.get(),adjwgt.get());
-
-    // we've completed exception possible tasks -- assign pointers
-    *r_xadj = xadj.release();
-    *r_adjncy = adjncy.release();
-    if (r_vwgt) {
-      *r_vwgt = vwgt.release();
-    }
-    if (r_adjwgt) {
-      *r_adjwgt = adjwgt.release();
-    }
-
-    *r_nvtxs = nvtxs;
-
-    if (r_nedges) {
-      *r_nedges = nedges;
-    }
-
-    if (r_ewgts) {
-      // convert to c style int
-      *r_ewgts = (int)ewgts;
-    }
-    if (r_nvwgts) {
-      *r_nvwgts = nvwgts;
-    }
+    IOStats::Record record("read graph", fname);
+    readGraph(fname, nullptr, r_nvtxs, r_nedges, r_nvwgts, r_ewgts, r_xadj, \
+        r_adjncy, r_vwgt, r_adjwgt);
   } catch (std::exception const & e) {
     std::cerr << "ERROR: failed to read graph due to: " << e.what() \
         << std::endl;
@@ -670,6 +2727,7 @@ extern "C" int wildriver_write_graph(
     val_t const * const adjwgt)
 {
   try {
+    IOStats::Record record("write graph", fname);
     GraphOutHandle handle(fname);
 
     bool const ewgts = adjwgt != NULL;
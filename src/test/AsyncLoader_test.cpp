@@ -0,0 +1,174 @@
+/**
+ * @file AsyncLoader_test.cpp
+ * @brief Test for loading matrices and graphs in the background.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-21
+ */
+
+
+
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <future>
+#include <vector>
+
+#include "AsyncLoader.hpp"
+#include "ThreadPool.hpp"
+#include "Exception.hpp"
+#include "DomTest.hpp"
+
+
+
+
+using namespace WildRiver;
+
+
+
+
+namespace DomTest
+{
+
+
+static void writeSparse(
+    std::string const & testFile)
+{
+  std::fstream stream(testFile,std::fstream::out | std::fstream::trunc);
+
+  stream << "1 1 2 2" << std::endl;
+  stream << "0 3 2 4" << std::endl;
+  stream << "0 5 1 6 3 7" << std::endl;
+  stream << "2 8 4 9 5 1" << std::endl;
+  stream << "3 2 5 3" << std::endl;
+  stream << "3 4 4 5" << std::endl;
+}
+
+
+static void writeMetis(
+    std::string const & testFile)
+{
+  std::fstream stream(testFile,std::fstream::out | std::fstream::trunc);
+
+  stream << "6 7 11 1" << std::endl;
+  stream << "4 2 1 3 2" << std::endl;
+  stream << "4 1 3 3 4" << std::endl;
+  stream << "4 1 5 2 6 4 7" << std::endl;
+  stream << "4 3 8 5 9 6 1" << std::endl;
+  stream << "4 4 2 6 3" << std::endl;
+  stream << "4 4 4 5 5" << std::endl;
+}
+
+
+static void poolTest()
+{
+  std::atomic<int> count(0);
+  {
+    ThreadPool pool(4);
+    testEquals(pool.getNumThreads(), 4);
+
+    for (int i = 0; i < 1000; ++i) {
+      pool.submit([&count]() {
+        ++count;
+      });
+    }
+
+    std::promise<void> done;
+    pool.submit([&done]() {
+      done.set_value();
+    });
+    done.get_future().wait();
+  }
+
+  // the destructor runs the remaining tasks
+  testEquals(count.load(), 1000);
+
+  testTrue(ThreadPool::getInstance().getNumThreads() >= 1);
+}
+
+
+static void matrixTest(
+    std::string const & testFile)
+{
+  std::future<loaded_matrix_struct> future = \
+      AsyncLoader::loadMatrix(testFile);
+
+  // poll until the matrix is loaded
+  while (future.wait_for(std::chrono::milliseconds(1)) != \
+      std::future_status::ready) {
+    // do nothing
+  }
+
+  loaded_matrix_struct const matrix = future.get();
+
+  testEquals(matrix.nrows, 6);
+  testEquals(matrix.ncols, 6);
+
+  std::vector<ind_t> const rowptr{0,2,4,7,10,12,14};
+  std::vector<dim_t> const rowind{1,2,0,2,0,1,3,2,4,5,3,5,3,4};
+  std::vector<val_t> const rowval{1,2,3,4,5,6,7,8,9,1,2,3,4,5};
+  testTrue(matrix.rowptr == rowptr);
+  testTrue(matrix.rowind == rowind);
+  testTrue(matrix.rowval == rowval);
+
+  loaded_matrix_struct const pattern = \
+      AsyncLoader::loadMatrix(testFile, false).get();
+  testTrue(pattern.rowind == rowind);
+  testTrue(pattern.rowval.empty());
+}
+
+
+static void graphTest(
+    std::string const & testFile)
+{
+  loaded_graph_struct const graph = AsyncLoader::loadGraph(testFile).get();
+
+  testEquals(graph.nvtxs, 6);
+  testEquals(graph.nvwgts, 1);
+  testEquals(graph.ewgts, true);
+  testEquals(graph.xadj.back(), 14);
+  testEquals(graph.vwgt.size(), 6);
+  testEquals(graph.vwgt[0], 4);
+  testEquals(graph.adjncy[0], 1);
+  testEquals(graph.adjwgt[0], 1);
+}
+
+
+static void failureTest()
+{
+  std::future<loaded_matrix_struct> future = \
+      AsyncLoader::loadMatrix("./async_test_missing.csr");
+
+  bool caught = false;
+  try {
+    future.get();
+  } catch (std::exception const &) {
+    caught = true;
+  }
+  testTrue(caught);
+}
+
+
+void Test::run()
+{
+  poolTest();
+
+  std::string const csrFile("./async_test.csr");
+  writeSparse(csrFile);
+  matrixTest(csrFile);
+  Test::removeFile(csrFile);
+
+  std::string const metisFile("./async_test.graph");
+  writeMetis(metisFile);
+  graphTest(metisFile);
+  Test::removeFile(metisFile);
+
+  failureTest();
+}
+
+
+
+
+}
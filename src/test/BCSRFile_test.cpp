@@ -0,0 +1,166 @@
+/**
+ * @file BCSRFile_test.cpp
+ * @brief Test for reading and writing binary CSR files.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-09
+ */
+
+
+
+
+#include <iostream>
+#include <fstream>
+#include <memory>
+
+#include "BCSRFile.hpp"
+#include "Exception.hpp"
+#include "DomTest.hpp"
+
+
+
+
+using namespace WildRiver;
+
+
+
+
+namespace DomTest
+{
+
+
+static void writeTest(
+    std::string const & testFile)
+{
+  BCSRFile csr(testFile);
+
+  csr.setInfo(6,6,14);
+
+  wildriver_ind_t rowptr[] = {0,2,4,7,10,12,14};
+  wildriver_dim_t rowind[] = {1,2,0,2,0,1,3,2,4,5,3,5,3,4};
+  wildriver_val_t rowval[] = {1,2,3,4,5,6,7,8,9,1,2,3,4,5};
+
+  csr.write(rowptr,rowind,rowval);
+}
+
+
+static void writeRowsTest(
+    std::string const & testFile)
+{
+  BCSRFile csr(testFile);
+
+  csr.writeHeader(6,6,14);
+
+  wildriver_dim_t rowind[] = {1,2,0,2,0,1,3,2,4,5,3,5,3,4};
+  wildriver_val_t rowval[] = {1,2,3,4,5,6,7,8,9,1,2,3,4,5};
+
+  csr.setNextRow(2, rowind, rowval);
+  csr.setNextRow(2, rowind+2, rowval+2);
+  csr.setNextRow(3, rowind+4, rowval+4);
+  csr.setNextRow(3, rowind+7, rowval+7);
+  csr.setNextRow(2, rowind+10, rowval+10);
+  csr.setNextRow(2, rowind+12, rowval+12);
+}
+
+
+static void readTest(
+    std::string const & testFile)
+{
+  BCSRFile csr(testFile);
+
+  wildriver_dim_t nrows, ncols;
+  wildriver_ind_t nnz;
+
+  csr.getInfo(nrows,ncols,nnz);
+
+  testEquals(nrows,6);
+  testEquals(ncols,6);
+  testEquals(nnz,14);
+
+  std::unique_ptr<wildriver_ind_t[]> rowptr(new wildriver_ind_t[nrows+1]);
+  std::unique_ptr<wildriver_dim_t[]> rowind(new wildriver_dim_t[nnz]);
+  std::unique_ptr<wildriver_val_t[]> rowval(new wildriver_val_t[nnz]);
+
+  double progress = 0;
+  csr.read(rowptr.get(),rowind.get(),rowval.get(),&progress);
+
+  testEquals(progress,1.0);
+
+  wildriver_ind_t const expRowptr[] = {0,2,4,7,10,12,14};
+  wildriver_dim_t const expRowind[] = {1,2,0,2,0,1,3,2,4,5,3,5,3,4};
+  wildriver_val_t const expRowval[] = {1,2,3,4,5,6,7,8,9,1,2,3,4,5};
+
+  for (wildriver_dim_t i = 0; i <= nrows; ++i) {
+    testEquals(rowptr[i],expRowptr[i]);
+  }
+  for (wildriver_ind_t j = 0; j < nnz; ++j) {
+    testEquals(rowind[j],expRowind[j]);
+    testEquals(rowval[j],expRowval[j]);
+  }
+}
+
+
+static void tooManyRowsTest(
+    std::string const & testFile)
+{
+  BCSRFile csr(testFile);
+
+  csr.writeHeader(1,2,1);
+
+  wildriver_dim_t const rowind[] = {1};
+  wildriver_val_t const rowval[] = {2};
+  csr.setNextRow(1, rowind, rowval);
+
+  bool failed = false;
+  try {
+    csr.setNextRow(1, rowind, rowval);
+  } catch (BadParameterException const &) {
+    failed = true;
+  }
+  testTrue(failed);
+}
+
+
+static void badHeaderTest(
+    std::string const & testFile)
+{
+  std::ofstream fout(testFile, std::ofstream::trunc);
+  fout << "1 1.0 2 2.0" << std::endl;
+  fout.close();
+
+  BCSRFile csr(testFile);
+
+  wildriver_dim_t nrows, ncols;
+  wildriver_ind_t nnz;
+
+  bool failed = false;
+  try {
+    csr.getInfo(nrows,ncols,nnz);
+  } catch (BadFileException const &) {
+    failed = true;
+  }
+  testTrue(failed);
+}
+
+
+void Test::run()
+{
+  std::string const testFile("./bcsr_test.bcsr");
+
+  writeTest(testFile);
+  readTest(testFile);
+
+  writeRowsTest(testFile);
+  readTest(testFile);
+
+  tooManyRowsTest(testFile);
+  badHeaderTest(testFile);
+
+  Test::removeFile(testFile);
+}
+
+
+
+
+}
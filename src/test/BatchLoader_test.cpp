@@ -0,0 +1,183 @@
+/**
+ * @file BatchLoader_test.cpp
+ * @brief Test for loading many files concurrently.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-24
+ */
+
+
+
+
+#include <atomic>
+#include <fstream>
+#include <vector>
+
+#include "BatchLoader.hpp"
+#include "CancelToken.hpp"
+#include "IOStats.hpp"
+#include "MatrixInHandle.hpp"
+#include "ProgressMonitor.hpp"
+#include "Exception.hpp"
+#include "DomTest.hpp"
+
+
+
+
+using namespace WildRiver;
+
+
+
+
+namespace DomTest
+{
+
+
+static void groupTest()
+{
+  std::vector<size_t> const sizes{10, 100, 30, 0, 60, 40, 200};
+
+  std::vector<std::vector<size_t>> const groups = \
+      BatchLoader::group(sizes, 100);
+
+  // large files are alone, and largest first
+  testEquals(groups.size(), 4);
+  testEquals(groups[0].size(), 1);
+  testEquals(groups[0][0], 6);
+  testEquals(groups[1].size(), 1);
+  testEquals(groups[1][0], 1);
+
+  // small files are packed in decreasing size
+  testEquals(groups[2].size(), 2);
+  testEquals(groups[2][0], 4);
+  testEquals(groups[2][1], 5);
+  testEquals(groups[3].size(), 3);
+  testEquals(groups[3][0], 2);
+  testEquals(groups[3][1], 0);
+  testEquals(groups[3][2], 3);
+
+  testEquals(BatchLoader::group(std::vector<size_t>(), 100).size(), 0);
+
+  // every file is in exactly one group
+  std::vector<size_t> const many(1000, 7);
+  std::vector<int> seen(many.size(), 0);
+  for (std::vector<size_t> const & group : BatchLoader::group(many, 100)) {
+    testTrue(group.size() <= 14);
+    for (size_t const file : group) {
+      ++seen[file];
+    }
+  }
+  for (int const count : seen) {
+    testEquals(count, 1);
+  }
+}
+
+
+static void loadTest(
+    std::string const & testFile)
+{
+  {
+    std::fstream stream(testFile,std::fstream::out | std::fstream::trunc);
+    stream << "1 1 2 2" << std::endl;
+    stream << "0 3 2 4" << std::endl;
+    stream << "0 5 1 6" << std::endl;
+  }
+
+  std::vector<std::string> names(64, testFile);
+  names[17] = "./BatchLoader_test_missing.csr";
+
+  std::vector<ind_t> nnz(names.size(), 0);
+  std::vector<std::exception_ptr> const errors = BatchLoader::load(names, \
+      [&names, &nnz](size_t const i) {
+    MatrixInHandle handle(names[i]);
+    dim_t nrows, ncols;
+    handle.getInfo(nrows, ncols, nnz[i]);
+  });
+
+  testEquals(errors.size(), names.size());
+  for (size_t i = 0; i < names.size(); ++i) {
+    if (i == 17) {
+      testTrue(errors[i] != nullptr);
+      testEquals(nnz[i], 0);
+    } else {
+      testTrue(errors[i] == nullptr);
+      testEquals(nnz[i], 6);
+    }
+  }
+
+  bool thrown = false;
+  try {
+    std::rethrow_exception(errors[17]);
+  } catch (std::exception const &) {
+    thrown = true;
+  }
+  testTrue(thrown);
+
+  // every file is loaded exactly once
+  std::atomic<size_t> calls(0);
+  BatchLoader::load(names, [&calls](size_t) {
+    ++calls;
+  });
+  testEquals(calls.load(), names.size());
+
+  Test::removeFile(testFile);
+}
+
+
+static void cancelTest()
+{
+  std::vector<std::string> const names(64, "./BatchLoader_test_cancel.csr");
+
+  CancelToken token;
+  CancelToken::Scope tokenScope(&token);
+  ProgressMonitor monitor;
+  ProgressMonitor::Scope monitorScope(&monitor);
+  IOStats::Record record("batch", nullptr);
+  IOStats * const stats = IOStats::getCurrent();
+
+  // the files are loaded under the caller's token, monitor and stats
+  std::atomic<size_t> matched(0);
+  BatchLoader::load(names, [&token, &monitor, stats, &matched](size_t) {
+    if (CancelToken::getCurrent() == &token && \
+        ProgressMonitor::getCurrent() == &monitor && \
+        IOStats::getCurrent() == stats) {
+      ++matched;
+    }
+  });
+  testEquals(matched.load(), names.size());
+
+  // cancelling the batch fails the files not yet started
+  std::atomic<size_t> calls(0);
+  std::vector<std::exception_ptr> const errors = BatchLoader::load(names, \
+      [&token, &calls](size_t) {
+    ++calls;
+    token.cancel();
+  });
+  testTrue(calls.load() < names.size());
+
+  size_t cancelled = 0;
+  for (std::exception_ptr const & error : errors) {
+    if (error != nullptr) {
+      try {
+        std::rethrow_exception(error);
+      } catch (CancelledException const &) {
+        ++cancelled;
+      }
+    }
+  }
+  testEquals(cancelled + calls.load(), names.size());
+}
+
+
+void Test::run()
+{
+  groupTest();
+  loadTest("./BatchLoader_test.csr");
+  cancelTest();
+}
+
+
+
+
+}
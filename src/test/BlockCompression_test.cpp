@@ -0,0 +1,260 @@
+/**
+ * @file BlockCompression_test.cpp
+ * @brief Test for writing and reading block compressed files.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-27
+ */
+
+
+
+
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include "BlockReader.hpp"
+#include "CompressBuffer.hpp"
+#include "Compression.hpp"
+#include "ConversionPipeline.hpp"
+#include "DecompressBuffer.hpp"
+#include "MatrixInHandle.hpp"
+#include "MatrixOutHandle.hpp"
+#include "ThreadPool.hpp"
+#include "DomTest.hpp"
+#include "TestMatrix.hpp"
+
+
+
+
+using namespace WildRiver;
+
+
+
+
+namespace DomTest
+{
+
+
+static std::string readFile(
+    std::string const & file)
+{
+  std::ifstream stream(file, std::ifstream::binary);
+  return std::string(std::istreambuf_iterator<char>(stream), \
+      std::istreambuf_iterator<char>());
+}
+
+
+static void writeBlocked(
+    std::string const & file,
+    int const compression,
+    std::string const & text)
+{
+  CompressBuffer buffer(file, compression);
+  std::ostream stream(&buffer);
+  stream.write(text.data(), text.size());
+  buffer.close();
+}
+
+
+static std::string readCompressed(
+    std::string const & file)
+{
+  std::unique_ptr<std::streambuf> buffer(Compression::openRead(file));
+  return std::string(std::istreambuf_iterator<char>(buffer.get()), \
+      std::istreambuf_iterator<char>());
+}
+
+
+static void writeMatrix(
+    std::string const & testFile,
+    csr_struct const & csr)
+{
+  MatrixOutHandle handle(testFile);
+  handle.setInfo(static_cast<dim_t>(csr.rowptr.size()-1), 1000, \
+      csr.rowind.size());
+  handle.writeSparse(csr.rowptr.data(), csr.rowind.data(), \
+      csr.rowval.data());
+}
+
+
+static void writerTest(
+    std::string const & plainFile,
+    std::string const & testFile,
+    int const compression)
+{
+  csr_struct const plain = readMatrix(plainFile);
+
+  // compressed by the writer alone, and by the thread pool
+  ThreadPool & pool = ThreadPool::getInstance();
+  int const numThreads = pool.getNumThreads();
+  pool.setNumThreads(1);
+  writeMatrix(testFile, plain);
+  compare(plain, readMatrix(testFile));
+  pool.setNumThreads(4);
+  writeMatrix(testFile, plain);
+  pool.setNumThreads(numThreads);
+
+  testTrue(BlockReader::isBlocked(testFile));
+  testEquals(Compression::fromMagic(testFile), compression);
+  compare(plain, readMatrix(testFile));
+
+  // the index covers the whole file, in several blocks
+  std::vector<BlockReader::block_struct> const index = \
+      BlockReader::readIndex(testFile);
+  testGreaterThan(index.size(), 1);
+  testEquals(index[0].offset, 0);
+  for (size_t i = 1; i < index.size(); ++i) {
+    testEquals(index[i].offset, index[i-1].offset + index[i-1].size);
+    testEquals(index[i].compressedOffset, \
+        index[i-1].compressedOffset + index[i-1].compressedSize);
+  }
+}
+
+
+static void optionTest(
+    std::string const & plainFile,
+    std::string const & testFile,
+    int const compression)
+{
+  csr_struct const plain = readMatrix(plainFile);
+
+  // compressed without a compression extension
+  Compression::setOutputCompression(compression);
+  writeMatrix(testFile, plain);
+  Compression::setOutputCompression(COMPRESSION_NONE);
+
+  testEquals(Compression::fromMagic(testFile), compression);
+  testTrue(BlockReader::isBlocked(testFile));
+  compare(plain, readMatrix(testFile));
+
+  Test::removeFile(testFile);
+}
+
+
+static void outputTest(
+    std::string const & plainFile,
+    std::string const & plainOutFile,
+    std::string const & testOutFile,
+    int const compression)
+{
+  {
+    ConversionPipeline pipeline(plainFile, plainOutFile);
+    pipeline.run();
+  }
+
+  ConversionPipeline pipeline(plainFile, testOutFile);
+  pipeline.setNumThreads(3);
+  pipeline.run();
+
+  // the header written at the end is part of the standard stream
+  testEquals(Compression::fromMagic(testOutFile), compression);
+  testTrue(BlockReader::isBlocked(testOutFile));
+  testTrue(readFile(plainOutFile) == readCompressed(testOutFile));
+
+  Test::removeFile(plainOutFile);
+  Test::removeFile(testOutFile);
+}
+
+
+static void pipelineTest(
+    std::string const & plainFile,
+    std::string const & testFile,
+    std::string const & plainOutFile,
+    std::string const & testOutFile)
+{
+  {
+    ConversionPipeline pipeline(plainFile, plainOutFile);
+    pipeline.run();
+  }
+
+  ConversionPipeline pipeline(testFile, testOutFile);
+  pipeline.setNumThreads(3);
+  // one block per chunk, so lines are split between chunks
+  pipeline.setChunkSize(1);
+  pipeline.setQueueDepth(2);
+  pipeline.run();
+
+  testGreaterThan(pipeline.getStageStats(WILDRIVER_STAGE_READ).chunks, 1);
+  testTrue(readFile(plainOutFile) == readFile(testOutFile));
+
+  Test::removeFile(plainOutFile);
+  Test::removeFile(testOutFile);
+}
+
+
+static void seekTest(
+    std::string const & testFile,
+    int const compression,
+    std::string const & text)
+{
+  DecompressBuffer buffer(testFile, compression);
+  std::istream stream(&buffer);
+
+  size_t const length = 1000;
+  std::string data(length, '\0');
+  for (size_t const offset : {text.size()/2, text.size()/4, \
+      text.size()-length, static_cast<size_t>(0)}) {
+    stream.seekg(static_cast<std::streamoff>(offset));
+    stream.read(&data[0], length);
+    testEquals(static_cast<size_t>(stream.gcount()), length);
+    testTrue(data == text.substr(offset, length));
+  }
+}
+
+
+static void blockTest(
+    std::string const & plainFile,
+    std::string const & testFile,
+    std::string const & matrixFile,
+    std::string const & extension,
+    int const compression)
+{
+  // spanning many blocks, with a row longer than a block
+  std::string const text = makeText(3000, 150, 1000, 30000);
+  {
+    std::ofstream stream(plainFile, std::ofstream::binary);
+    stream << text;
+  }
+
+  testTrue(!BlockReader::isBlocked(plainFile));
+
+  writeBlocked(testFile, compression, text);
+  testTrue(BlockReader::isBlocked(testFile));
+  compare(readMatrix(plainFile), readMatrix(testFile));
+
+  writerTest(plainFile, matrixFile, compression);
+  pipelineTest(plainFile, testFile, "./BlockCompression_test_plain.mtx", \
+      "./BlockCompression_test.mtx");
+  seekTest(testFile, compression, text);
+  optionTest(plainFile, "./BlockCompression_test_option.csr", compression);
+  outputTest(plainFile, "./BlockCompression_test_plain.mtx", \
+      "./BlockCompression_test.mtx" + extension, compression);
+
+  Test::removeFile(plainFile);
+  Test::removeFile(testFile);
+  Test::removeFile(matrixFile);
+}
+
+
+void Test::run()
+{
+  if (Compression::isSupported(COMPRESSION_GZIP)) {
+    blockTest("./BlockCompression_test.csr", \
+        "./BlockCompression_test.csr.gz", \
+        "./BlockCompression_test_out.csr.gz", ".gz", COMPRESSION_GZIP);
+  }
+  if (Compression::isSupported(COMPRESSION_ZSTD)) {
+    blockTest("./BlockCompression_test.csr", \
+        "./BlockCompression_test.csr.zst", \
+        "./BlockCompression_test_out.csr.zst", ".zst", COMPRESSION_ZSTD);
+  }
+}
+
+
+
+
+}
@@ -13,6 +13,7 @@
 #include <iostream>
 #include <fstream>
 #include <memory>
+#include <vector>
 
 #include "CSRFile.hpp"
 #include "DomTest.hpp"
@@ -197,6 +198,149 @@ static void readTestBaseOne(
 
 
 
+static void readTestPattern(
+    std::string const & testFile)
+{
+  std::ofstream fout(testFile, std::ofstream::trunc);
+  fout << "1 1.0 2 2e3" << std::endl;
+  fout << "0 -3.0\t2 4.0" << std::endl;
+  fout << "0 5.0 1 6.0 3 7.0" << std::endl;
+  fout << "2 8.0 4 9.0 5 1.0" << std::endl;
+  fout << "3 2.0 5 3.0" << std::endl;
+  fout << "3 4.0 4 5.0" << std::endl;
+
+  fout.close();
+
+  CSRFile csr(testFile);
+
+  wildriver_dim_t nrows, ncols;
+  wildriver_ind_t nnz;
+
+  csr.getInfo(nrows,ncols,nnz);
+
+  testEquals(nrows,6);
+  testEquals(ncols,6);
+  testEquals(nnz,14);
+
+  std::unique_ptr<wildriver_ind_t[]> rowptr(new wildriver_ind_t[nrows+1]);
+  std::unique_ptr<wildriver_dim_t[]> rowind(new wildriver_dim_t[nnz]);
+
+  // values are skipped entirely
+  csr.read(rowptr.get(),rowind.get(),nullptr,nullptr);
+
+  wildriver_ind_t const expRowptr[] = {0,2,4,7,10,12,14};
+  wildriver_dim_t const expRowind[] = {1,2,0,2,0,1,3,2,4,5,3,5,3,4};
+  for (size_t i = 0; i < 7; ++i) {
+    testEquals(rowptr[i],expRowptr[i]);
+  }
+  for (size_t j = 0; j < 14; ++j) {
+    testEquals(rowind[j],expRowind[j]);
+  }
+}
+
+
+static void readTestRange(
+    std::string const & testFile)
+{
+  // enough rows to span several indexed lines, with comments and an empty
+  // row mixed in
+  wildriver_dim_t const numRows = 3000;
+  std::ofstream fout(testFile, std::ofstream::trunc);
+  for (wildriver_dim_t i = 0; i < numRows; ++i) {
+    if (i % 500 == 0) {
+      fout << "# rows " << i << " and on" << std::endl;
+    }
+    if (i == 1500) {
+      fout << std::endl;
+    } else {
+      fout << (i % 100) << " " << i << " " << (100 + (i % 7)) << " 1.5" \
+          << std::endl;
+    }
+  }
+  fout.close();
+
+  CSRFile csr(testFile);
+
+  wildriver_dim_t nrows, ncols;
+  wildriver_ind_t nnz;
+  csr.getInfo(nrows,ncols,nnz);
+
+  testEquals(nrows,numRows);
+
+  std::vector<wildriver_ind_t> rowptr;
+  std::vector<wildriver_dim_t> rowind;
+  std::vector<wildriver_val_t> rowval;
+
+  csr.readRange(1000,2100,rowptr,rowind,&rowval);
+
+  testEquals(rowptr.size(),1101);
+  testEquals(rowptr.back(),2198);
+  for (wildriver_dim_t i = 1000; i < 2100; ++i) {
+    wildriver_ind_t const start = rowptr[i-1000];
+    if (i == 1500) {
+      testEquals(rowptr[i-1000+1],start);
+    } else {
+      testEquals(rowptr[i-1000+1],start+2);
+      testEquals(rowind[start],i % 100);
+      testEquals(rowval[start],i);
+      testEquals(rowind[start+1],100 + (i % 7));
+      testEquals(rowval[start+1],1.5);
+    }
+  }
+
+  // the last row, after a previous range
+  csr.readRange(numRows-1,numRows,rowptr,rowind,nullptr);
+  testEquals(rowptr.size(),2);
+  testEquals(rowptr[1],2);
+  testEquals(rowind[0],(numRows-1) % 100);
+}
+
+
+static void batchTest(
+    std::string const & testFile)
+{
+  wildriver_ind_t const rowptr[] = {0,2,4,7,10,12,14};
+  wildriver_dim_t const rowind[] = {1,2,0,2,0,1,3,2,4,5,3,5,3,4};
+  wildriver_val_t const rowval[] = {1,2,3,4,5,6,7,8,9,1,2,3,4,5};
+
+  {
+    CSRFile csr(testFile);
+    csr.setInfo(6,6,14);
+
+    // in two uneven batches, the second indexing from the start of the
+    // arrays
+    csr.setNextRows(2,rowptr,rowind,rowval);
+    csr.setNextRows(4,rowptr+2,rowind,rowval);
+  }
+
+  CSRFile csr(testFile);
+
+  wildriver_dim_t nrows, ncols;
+  wildriver_ind_t nnz;
+  csr.getInfo(nrows,ncols,nnz);
+
+  testEquals(nrows,6);
+  testEquals(nnz,14);
+
+  std::vector<wildriver_ind_t> readRowptr(nrows+1);
+  std::vector<wildriver_dim_t> readRowind(nnz);
+  std::vector<wildriver_val_t> readRowval(nnz);
+
+  readRowptr[0] = 0;
+  csr.getNextRows(3,readRowptr.data(),readRowind.data(),readRowval.data());
+  csr.getNextRows(3,readRowptr.data()+3,readRowind.data(), \
+      readRowval.data());
+
+  for (size_t i = 0; i < 7; ++i) {
+    testEquals(readRowptr[i],rowptr[i]);
+  }
+  for (size_t j = 0; j < 14; ++j) {
+    testEquals(readRowind[j],rowind[j]);
+    testEquals(readRowval[j],rowval[j]);
+  }
+}
+
+
 void Test::run()
 {
   std::string testFile("./CSRFile_test.csr");
@@ -213,6 +357,18 @@ void Test::run()
 
   remove(testFile.c_str());
 
+  readTestPattern(testFile);
+
+  remove(testFile.c_str());
+
+  readTestRange(testFile);
+
+  remove(testFile.c_str());
+
+  batchTest(testFile);
+
+  remove(testFile.c_str());
+
 }
 
 
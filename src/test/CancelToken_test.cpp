@@ -0,0 +1,271 @@
+/**
+ * @file CancelToken_test.cpp
+ * @brief Test for cancelling loads.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-22
+ */
+
+
+
+
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "AsyncLoader.hpp"
+#include "CancelToken.hpp"
+#include "GraphInHandle.hpp"
+#include "GraphOutHandle.hpp"
+#include "IOStats.hpp"
+#include "MatrixInHandle.hpp"
+#include "MatrixOutHandle.hpp"
+#include "ThreadPool.hpp"
+#include "Exception.hpp"
+#include "DomTest.hpp"
+
+
+
+
+using namespace WildRiver;
+
+
+
+
+namespace DomTest
+{
+
+
+static void tokenTest()
+{
+  CancelToken token;
+  testTrue(!token.isCancelled());
+  token.check();
+
+  token.setDeadline(0.001);
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  testTrue(token.isCancelled());
+
+  bool caught = false;
+  try {
+    token.check();
+  } catch (DeadlineExceededException const &) {
+    caught = true;
+  }
+  testTrue(caught);
+
+  token.setDeadline(0);
+  testTrue(!token.isCancelled());
+
+  token.cancel();
+  testTrue(token.isCancelled());
+
+  // only the installed token is checked, and only within its scope
+  CancelToken::checkCurrent();
+  {
+    CancelToken::Scope scope(&token);
+    caught = false;
+    try {
+      CancelToken::checkCurrent();
+    } catch (CancelledException const &) {
+      caught = true;
+    }
+    testTrue(caught);
+
+    {
+      CancelToken::Scope inner(nullptr);
+      CancelToken::checkCurrent();
+    }
+
+    caught = false;
+    try {
+      CancelToken::checkCurrent();
+    } catch (CancelledException const &) {
+      caught = true;
+    }
+    testTrue(caught);
+  }
+  CancelToken::checkCurrent();
+}
+
+
+static void writeMatrix(
+    std::string const & testFile)
+{
+  dim_t const nrows = 200;
+  std::vector<ind_t> rowptr(nrows+1, 0);
+  std::vector<dim_t> rowind;
+  std::vector<val_t> rowval;
+  for (dim_t i = 0; i < nrows; ++i) {
+    rowind.emplace_back((i+1) % nrows);
+    rowval.emplace_back(1.0);
+    rowind.emplace_back((i+nrows-1) % nrows);
+    rowval.emplace_back(1.0);
+    rowptr[i+1] = rowind.size();
+  }
+
+  MatrixOutHandle handle(testFile);
+  handle.setInfo(nrows, nrows, rowind.size());
+  handle.writeSparse(rowptr.data(), rowind.data(), rowval.data());
+}
+
+
+static void matrixTest(
+    std::string const & testFile)
+{
+  writeMatrix(testFile);
+
+  CancelToken token;
+  for (int pass = 0; pass < 2; ++pass) {
+    MatrixInHandle handle(testFile);
+    dim_t nrows, ncols;
+    ind_t nnz;
+    handle.getInfo(nrows, ncols, nnz);
+
+    std::vector<ind_t> rowptr(nrows+1);
+    std::vector<dim_t> rowind(nnz);
+    std::vector<val_t> rowval(nnz);
+
+    CancelToken::Scope scope(&token);
+    if (pass == 0) {
+      // an uncancelled token does not affect the load
+      handle.readSparse(rowptr.data(), rowind.data(), rowval.data());
+      testEquals(rowptr[nrows], nnz);
+    } else {
+      bool caught = false;
+      try {
+        handle.readSparse(rowptr.data(), rowind.data(), rowval.data());
+      } catch (CancelledException const &) {
+        caught = true;
+      }
+      testTrue(caught);
+    }
+
+    token.cancel();
+  }
+
+  Test::removeFile(testFile);
+}
+
+
+static void graphTest(
+    std::string const & testFile)
+{
+  writeMatrix(testFile);
+
+  CancelToken token;
+  token.setDeadline(0.001);
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+  GraphInHandle handle(testFile);
+  dim_t nvtxs;
+  ind_t nedges;
+  int nvwgts;
+  bool ewgts;
+  handle.getInfo(nvtxs, nedges, nvwgts, ewgts);
+
+  std::vector<ind_t> xadj(nvtxs+1);
+  std::vector<dim_t> adjncy(nedges);
+
+  CancelToken::Scope scope(&token);
+  bool caught = false;
+  try {
+    handle.readGraph(xadj.data(), adjncy.data(), nullptr, nullptr);
+  } catch (DeadlineExceededException const &) {
+    caught = true;
+  }
+  testTrue(caught);
+
+  Test::removeFile(testFile);
+}
+
+
+static void concurrentTest(
+    std::string const & testFile)
+{
+  writeMatrix(testFile);
+
+  ThreadPool & pool = ThreadPool::getInstance();
+  int const numThreads = pool.getNumThreads();
+  pool.setNumThreads(4);
+
+  for (int r = 0; r < 10; ++r) {
+    // a load which is cancelled while its tasks run
+    bool caught = false;
+    std::thread cancelled([&pool, &caught]() {
+      CancelToken token;
+      token.cancel();
+      CancelToken::Scope scope(&token);
+      IOStats::Record record("cancelled", nullptr);
+      try {
+        pool.parallelFor(0, 64, 1, [](size_t, size_t) {
+          std::this_thread::sleep_for(std::chrono::microseconds(100));
+          CancelToken::checkCurrent();
+        });
+      } catch (CancelledException const &) {
+        caught = true;
+      }
+    });
+
+    // and loads alongside it, which must neither be cancelled nor have its
+    // tasks counted in their stats
+    std::future<loaded_matrix_struct> loaded = \
+        AsyncLoader::loadMatrix(testFile);
+    bool clean = true;
+    wildriver_stats stats;
+    std::thread other([&pool, &clean, &stats]() {
+      {
+        IOStats::Record record("other", nullptr);
+        try {
+          pool.parallelFor(0, 64, 1, [](size_t const begin, \
+              size_t const end) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            CancelToken::checkCurrent();
+            IOStats::addCurrentEntries(0, end - begin);
+          });
+        } catch (CancelledException const &) {
+          clean = false;
+        }
+      }
+      IOStats::getLast(&stats);
+    });
+
+    cancelled.join();
+    other.join();
+
+    testTrue(caught);
+    testTrue(clean);
+    testEquals(stats.entries, 64);
+
+    loaded_matrix_struct const matrix = loaded.get();
+    testEquals(matrix.nrows, 200);
+    testEquals(matrix.rowptr[matrix.nrows], 400);
+  }
+
+  pool.setNumThreads(numThreads);
+
+  Test::removeFile(testFile);
+}
+
+
+void Test::run()
+{
+  tokenTest();
+
+  matrixTest("./cancel_test.csr");
+  matrixTest("./cancel_test.mtx");
+  matrixTest("./cancel_test.bcsr");
+  matrixTest("./cancel_test.snap");
+
+  graphTest("./cancel_test.graph");
+  graphTest("./cancel_test.snap");
+
+  concurrentTest("./cancel_test_concurrent.csr");
+}
+
+
+
+
+}
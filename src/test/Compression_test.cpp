@@ -0,0 +1,227 @@
+/**
+ * @file Compression_test.cpp
+ * @brief Test for reading compressed files.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-27
+ */
+
+
+
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+#ifdef WILDRIVER_ZLIB
+#include <zlib.h>
+#endif
+
+#include "Compression.hpp"
+#include "MemoryBudget.hpp"
+#include "MatrixInHandle.hpp"
+#include "TextFile.hpp"
+#include "Exception.hpp"
+#include "DomTest.hpp"
+#include "TestMatrix.hpp"
+
+
+
+
+using namespace WildRiver;
+
+
+
+
+namespace DomTest
+{
+
+
+/**
+ * @brief A small matrix market file compressed with xz.
+ */
+static unsigned char const XZ_FILE[] = {
+  0xfd, 0x37, 0x7a, 0x58, 0x5a, 0x00, 0x00, 0x04, 0xe6, 0xd6, 0xb4, 0x46,
+  0x02, 0x00, 0x21, 0x01, 0x16, 0x00, 0x00, 0x00, 0x74, 0x2f, 0xe5, 0xa3,
+  0xe0, 0x00, 0x6f, 0x00, 0x5a, 0x5d, 0x00, 0x12, 0xe1, 0x30, 0xc2, 0x74,
+  0x38, 0x61, 0xde, 0x3a, 0x4b, 0x4f, 0x5f, 0x43, 0xe3, 0xfb, 0x8b, 0xa8,
+  0x9a, 0x11, 0xc8, 0x87, 0x49, 0xad, 0x30, 0xf2, 0x34, 0xb6, 0xb2, 0x4a,
+  0xbd, 0x60, 0xea, 0x3e, 0xc8, 0xf8, 0x15, 0x1e, 0x52, 0xd0, 0xda, 0xed,
+  0x47, 0x23, 0xfe, 0x05, 0x72, 0xcf, 0x56, 0xa6, 0x02, 0x07, 0x1f, 0xac,
+  0x0e, 0x1f, 0x84, 0x78, 0x59, 0x58, 0x6a, 0x1d, 0x80, 0x0e, 0x84, 0x78,
+  0xe1, 0x26, 0x01, 0xec, 0x7b, 0xc7, 0xd9, 0xeb, 0x8a, 0x88, 0xf5, 0x8c,
+  0x2a, 0x93, 0x6d, 0xb6, 0x94, 0x4c, 0x87, 0xd4, 0xbc, 0xd6, 0xa3, 0x45,
+  0x75, 0x00, 0x00, 0x00, 0x38, 0x82, 0xcb, 0x5a, 0x2b, 0x38, 0x6d, 0xc3,
+  0x00, 0x01, 0x76, 0x70, 0x67, 0x1a, 0xe6, 0x09, 0x1f, 0xb6, 0xf3, 0x7d,
+  0x01, 0x00, 0x00, 0x00, 0x00, 0x04, 0x59, 0x5a
+};
+
+
+/**
+ * @brief The same file compressed with zstd.
+ */
+static unsigned char const ZSTD_FILE[] = {
+  0x28, 0xb5, 0x2f, 0xfd, 0x20, 0x70, 0xd5, 0x02, 0x00, 0x12, 0x46, 0x13,
+  0x17, 0x90, 0xb5, 0x1a, 0x03, 0xe8, 0x75, 0x7b, 0x43, 0x8b, 0xbc, 0xfc,
+  0x32, 0x23, 0x56, 0xca, 0x9a, 0x10, 0x6a, 0x07, 0x73, 0xbe, 0x6c, 0xcd,
+  0x67, 0xca, 0x30, 0x12, 0xce, 0x1c, 0x3f, 0x67, 0x0a, 0xfa, 0x9c, 0x67,
+  0xca, 0x19, 0xc7, 0x33, 0x05, 0xc7, 0xd1, 0x0d, 0xe7, 0x79, 0x4d, 0x6d,
+  0x4a, 0xab, 0x58, 0x27, 0x77, 0x28, 0x5b, 0xb5, 0x81, 0x0f, 0x5d, 0xf6,
+  0x36, 0x55, 0x06, 0x80, 0xad, 0x55, 0x9c, 0x6e, 0x2b, 0x60, 0x4a, 0x0c,
+  0x0c, 0xd6, 0x94, 0x20, 0x24, 0x03, 0x04, 0x02, 0x2b, 0x83, 0xcc, 0x34,
+  0x60, 0x82, 0x01
+};
+
+
+static void extensionTest()
+{
+  testEquals(Compression::fromExtension("A.mtx.gz"), COMPRESSION_GZIP);
+  testEquals(Compression::fromExtension("A.graph.zst"), COMPRESSION_ZSTD);
+  testEquals(Compression::fromExtension("A.txt.xz"), COMPRESSION_XZ);
+  testEquals(Compression::fromExtension("A.mtx"), COMPRESSION_NONE);
+  testEquals(Compression::fromExtension(".gz"), COMPRESSION_NONE);
+
+  testEquals(Compression::stripExtension("A.mtx.gz"), std::string("A.mtx"));
+  testEquals(Compression::stripExtension("A.mtx"), std::string("A.mtx"));
+
+  testTrue(TextFile::matchExtension("A.mtx.gz", {".mtx"}));
+  testTrue(TextFile::matchExtension("A.graph.zst", {".graph"}));
+  testTrue(!TextFile::matchExtension("A.gz", {".mtx"}));
+  testTrue(!TextFile::matchExtension("x", {".mtx"}));
+}
+
+
+static void embeddedTest(
+    std::string const & testFile,
+    unsigned char const * const data,
+    size_t const size,
+    int const compression)
+{
+  if (!Compression::isSupported(compression)) {
+    return;
+  }
+
+  {
+    std::ofstream stream(testFile, std::ofstream::binary);
+    stream.write(reinterpret_cast<char const*>(data), size);
+  }
+  testEquals(Compression::fromMagic(testFile), compression);
+
+  csr_struct const csr = readMatrix(testFile);
+
+  testEquals(csr.rowptr.size(), 5);
+  testEquals(csr.rowptr[4], 6);
+  testEquals(csr.rowind[0], 0);
+  testEquals(csr.rowval[0], 2.0);
+  testEquals(csr.rowval[1], 4.0);
+
+  Test::removeFile(testFile);
+}
+
+
+#ifdef WILDRIVER_ZLIB
+static void writeGzip(
+    std::string const & file,
+    std::string const & text,
+    size_t const numMembers)
+{
+  std::remove(file.c_str());
+  size_t const length = text.size();
+  size_t const memberSize = (length + numMembers - 1) / numMembers;
+  for (size_t start = 0; start < length; start += memberSize) {
+    // appending starts a new member
+    gzFile gz = gzopen(file.c_str(), "ab");
+    testTrue(gz != nullptr);
+    size_t const size = std::min(memberSize, length - start);
+    testEquals(gzwrite(gz, text.data() + start, static_cast<unsigned>(size)), \
+        static_cast<int>(size));
+    testEquals(gzclose(gz), Z_OK);
+  }
+}
+
+
+static void gzipTest(
+    std::string const & plainFile,
+    std::string const & testFile,
+    std::string const & hiddenFile)
+{
+  // enough entries to fill several blocks
+  std::ostringstream text;
+  size_t const numEntries = 200000;
+  text << "%%MatrixMarket matrix coordinate real general\n";
+  text << "1000 1000 " << numEntries << "\n";
+  uint64_t state = 1;
+  for (size_t i = 0; i < numEntries; ++i) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    text << ((state >> 33) % 1000 + 1) << " " << ((state >> 17) % 1000 + 1) \
+        << " " << ((state >> 40) % 100) << ".5\n";
+  }
+  std::string const contents = text.str();
+
+  {
+    std::ofstream stream(plainFile);
+    stream << contents;
+  }
+  csr_struct const plain = readMatrix(plainFile);
+  testEquals(plain.rowind.size(), numEntries);
+
+  writeGzip(testFile, contents, 3);
+  compare(plain, readMatrix(testFile));
+
+  // parsing twice restarts decompression
+  MemoryBudget::set(1);
+  compare(plain, readMatrix(testFile));
+  MemoryBudget::set(0);
+
+  // detected without the extension
+  writeGzip(hiddenFile, contents, 1);
+  compare(plain, readMatrix(hiddenFile));
+
+  // a truncated file fails instead of silently losing entries
+  writeGzip(testFile, contents, 1);
+  std::string compressed;
+  {
+    std::ifstream stream(testFile, std::ifstream::binary);
+    compressed.assign(std::istreambuf_iterator<char>(stream), \
+        std::istreambuf_iterator<char>());
+  }
+  {
+    std::ofstream stream(testFile, std::ofstream::binary);
+    stream.write(compressed.data(), compressed.size() / 2);
+  }
+  bool failed = false;
+  try {
+    readMatrix(testFile);
+  } catch (BadFileException const &) {
+    failed = true;
+  }
+  testTrue(failed);
+
+  Test::removeFile(plainFile);
+  Test::removeFile(testFile);
+  Test::removeFile(hiddenFile);
+}
+#endif
+
+
+void Test::run()
+{
+  extensionTest();
+  embeddedTest("./Compression_test.mtx.xz", XZ_FILE, sizeof(XZ_FILE), \
+      COMPRESSION_XZ);
+  embeddedTest("./Compression_test.mtx.zst", ZSTD_FILE, sizeof(ZSTD_FILE), \
+      COMPRESSION_ZSTD);
+#ifdef WILDRIVER_ZLIB
+  gzipTest("./Compression_test.mtx", "./Compression_test.mtx.gz", \
+      "./Compression_test_hidden.mtx");
+#endif
+}
+
+
+
+
+}
@@ -0,0 +1,311 @@
+/**
+ * @file ConversionPipeline_test.cpp
+ * @brief Test for converting matrices with the pipeline.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-02
+ */
+
+
+
+
+#include <cmath>
+#include <iostream>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+#include "ConversionPipeline.hpp"
+#include "CSRFile.hpp"
+#include "MatrixMarketFile.hpp"
+#include "MetisFile.hpp"
+#include "DomTest.hpp"
+
+
+
+
+using namespace WildRiver;
+
+
+
+
+namespace DomTest
+{
+
+
+namespace
+{
+
+std::vector<ind_t> const ROWPTR{
+  0, 2, 4, 7, 10, 12, 14
+};
+
+std::vector<dim_t> const ROWIND{
+  1, 2,
+  0, 2,
+  0, 1, 3,
+  2, 4, 5,
+  3, 5,
+  3, 4
+};
+
+std::vector<val_t> const ROWVAL{
+  1, 2,
+  3, 4,
+  5, 6, 7,
+  8, 9, 1,
+  2, 3,
+  4, 5
+};
+
+
+void writeInput(
+    std::string const & testFile)
+{
+  std::ofstream fout(testFile, std::ofstream::trunc);
+  fout << "# a comment" << std::endl;
+  fout << "2 1.0 3 2.0" << std::endl;
+  fout << "1 3.0 3 4.0" << std::endl;
+  fout << "1 5.0 2 6.0 4 7.0" << std::endl;
+  fout << "3 8.0 5 9.0 6 1.0" << std::endl;
+  fout << "4 2.0 6 3.0" << std::endl;
+  fout << "4 4.0 5 5.0" << std::endl;
+}
+
+
+void readMatrixMarket(
+    std::string const & testFile,
+    std::vector<ind_t> & rowptr,
+    std::vector<dim_t> & rowind,
+    std::vector<val_t> & rowval)
+{
+  MatrixMarketFile mm(testFile);
+
+  dim_t nrows, ncols;
+  ind_t nnz;
+  mm.getInfo(nrows, ncols, nnz);
+
+  rowptr.resize(nrows+1);
+  rowind.resize(nnz);
+  rowval.resize(nnz);
+
+  mm.read(rowptr.data(), rowind.data(), rowval.data(), nullptr);
+}
+
+}
+
+
+static void csrToMatrixMarketTest(
+    std::string const & inFile,
+    std::string const & outFile)
+{
+  writeInput(inFile);
+
+  ConversionPipeline pipeline(inFile, outFile);
+  pipeline.setNumThreads(3);
+  // force many chunks
+  pipeline.setChunkSize(8);
+  pipeline.setQueueDepth(2);
+  pipeline.run();
+
+  std::vector<ind_t> rowptr;
+  std::vector<dim_t> rowind;
+  std::vector<val_t> rowval;
+  readMatrixMarket(outFile, rowptr, rowind, rowval);
+
+  testEquals(rowptr.size(), ROWPTR.size());
+  for (size_t i = 0; i < ROWPTR.size(); ++i) {
+    testEquals(rowptr[i], ROWPTR[i]);
+  }
+  for (size_t i = 0; i < ROWIND.size(); ++i) {
+    testEquals(rowind[i], ROWIND[i]);
+    testEquals(rowval[i], ROWVAL[i]);
+  }
+
+  wildriver_stage_stats const & read = \
+      pipeline.getStageStats(WILDRIVER_STAGE_READ);
+  wildriver_stage_stats const & parse = \
+      pipeline.getStageStats(WILDRIVER_STAGE_PARSE);
+  wildriver_stage_stats const & write = \
+      pipeline.getStageStats(WILDRIVER_STAGE_WRITE);
+  testGreaterThan(read.chunks, 1);
+  testEquals(parse.chunks, read.chunks);
+  testEquals(parse.rows, 6);
+  testEquals(parse.nnz, 14);
+  testEquals(parse.nthreads, 3);
+  testGreaterThan(write.bytes, 0);
+
+  // the rate is of the whole stage, which is the sum of its threads' rates
+  testGreaterThan(parse.busy, 0.0);
+  double const perThread = (parse.bytes / 1.0e6) / parse.busy;
+  testTrue(std::fabs(parse.mbps - parse.nthreads*perThread) <= \
+      1.0e-9*parse.mbps);
+}
+
+
+static void zeroBasedTest(
+    std::string const & inFile,
+    std::string const & outFile)
+{
+  // the indexing is taken from the first zero column
+  std::ofstream fout(inFile, std::ofstream::trunc);
+  for (size_t i = 0; i+1 < ROWPTR.size(); ++i) {
+    for (ind_t j = ROWPTR[i]; j < ROWPTR[i+1]; ++j) {
+      fout << (j > ROWPTR[i] ? " " : "") << ROWIND[j] << " " << ROWVAL[j];
+    }
+    fout << std::endl;
+  }
+  fout.close();
+
+  ConversionPipeline pipeline(inFile, outFile);
+  pipeline.setChunkSize(8);
+  pipeline.run();
+
+  std::vector<ind_t> rowptr;
+  std::vector<dim_t> rowind;
+  std::vector<val_t> rowval;
+  readMatrixMarket(outFile, rowptr, rowind, rowval);
+
+  testEquals(rowptr.size(), ROWPTR.size());
+  for (size_t i = 0; i < ROWPTR.size(); ++i) {
+    testEquals(rowptr[i], ROWPTR[i]);
+  }
+  for (size_t i = 0; i < ROWIND.size(); ++i) {
+    testEquals(rowind[i], ROWIND[i]);
+    testEquals(rowval[i], ROWVAL[i]);
+  }
+}
+
+
+static void filterTest(
+    std::string const & inFile,
+    std::string const & outFile)
+{
+  writeInput(inFile);
+
+  ConversionPipeline pipeline(inFile, outFile);
+  pipeline.setNumThreads(2);
+  pipeline.setChunkSize(16);
+  // drop the third row and any entries in the last column
+  pipeline.setFilter([](dim_t row, dim_t col, val_t) {
+    return row != 2 && col != 5;
+  });
+  pipeline.run();
+
+  CSRFile csr(outFile);
+  dim_t nrows, ncols;
+  ind_t nnz;
+  csr.getInfo(nrows, ncols, nnz);
+
+  testEquals(nrows, 6);
+  testEquals(ncols, 5);
+  testEquals(nnz, 9);
+
+  std::vector<ind_t> rowptr(nrows+1);
+  std::vector<dim_t> rowind(nnz);
+  std::vector<val_t> rowval(nnz);
+  csr.read(rowptr.data(), rowind.data(), rowval.data(), nullptr);
+
+  testEquals(rowptr[2], rowptr[3]);
+  for (dim_t i = 0; i < nrows; ++i) {
+    for (ind_t j = rowptr[i]; j < rowptr[i+1]; ++j) {
+      testTrue(rowind[j] != 5);
+    }
+  }
+}
+
+
+static void symmetrizeTest(
+    std::string const & inFile,
+    std::string const & midFile,
+    std::string const & outFile)
+{
+  writeInput(inFile);
+
+  // first drop most of the lower triangle (keeping the first column so the
+  // indexing is detected as 0-based), and then rebuild it
+  ConversionPipeline upper(inFile, midFile);
+  upper.setFilter([](dim_t row, dim_t col, val_t) {
+    return col > row || col == 0;
+  });
+  upper.run();
+
+  ConversionPipeline pipeline(midFile, outFile);
+  pipeline.setSymmetrize(true);
+  pipeline.run();
+
+  MetisFile graph(outFile);
+  dim_t nvtxs;
+  ind_t nedges;
+  int nvwgt;
+  bool ewgts;
+  graph.getInfo(nvtxs, nedges, nvwgt, ewgts);
+
+  testEquals(nvtxs, 6);
+  testEquals(nedges, 14);
+  testEquals(nvwgt, 0);
+  testTrue(ewgts);
+
+  std::vector<ind_t> xadj(nvtxs+1);
+  std::vector<dim_t> adjncy(nedges);
+  std::vector<val_t> adjwgt(nedges);
+  graph.read(xadj.data(), adjncy.data(), nullptr, adjwgt.data(), nullptr);
+
+  for (size_t i = 0; i < ROWPTR.size(); ++i) {
+    testEquals(xadj[i], ROWPTR[i]);
+  }
+  for (size_t i = 0; i < ROWIND.size(); ++i) {
+    testEquals(adjncy[i], ROWIND[i]);
+  }
+  // values of kept entries are unchanged, and the rest are mirrored
+  testEquals(adjwgt[0], 1);
+  testEquals(adjwgt[2], 3);
+  testEquals(adjwgt[5], 4);
+}
+
+
+static void badInputTest(
+    std::string const & inFile,
+    std::string const & outFile)
+{
+  std::ofstream fout(inFile, std::ofstream::trunc);
+  fout << "1 1.0 2" << std::endl;
+  fout.close();
+
+  ConversionPipeline pipeline(inFile, outFile);
+  bool failed = false;
+  try {
+    pipeline.run();
+  } catch (BadFileException const &) {
+    failed = true;
+  }
+  testTrue(failed);
+}
+
+
+void Test::run()
+{
+  std::string const inFile("./pipeline_in.csr");
+  std::string const midFile("./pipeline_mid.csr");
+  std::string const mmFile("./pipeline_out.mtx");
+  std::string const csrFile("./pipeline_out.csr");
+  std::string const metisFile("./pipeline_out.graph");
+
+  csrToMatrixMarketTest(inFile, mmFile);
+  zeroBasedTest(inFile, mmFile);
+  filterTest(inFile, csrFile);
+  symmetrizeTest(inFile, midFile, metisFile);
+  badInputTest(inFile, csrFile);
+
+  Test::removeFile(inFile);
+  Test::removeFile(midFile);
+  Test::removeFile(mmFile);
+  Test::removeFile(csrFile);
+  Test::removeFile(metisFile);
+}
+
+
+
+
+}
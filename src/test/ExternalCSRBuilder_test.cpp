@@ -0,0 +1,422 @@
+/**
+ * @file ExternalCSRBuilder_test.cpp
+ * @brief Test for building CSR matrices out of core.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-09
+ */
+
+
+
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <fstream>
+#include <new>
+#include <vector>
+
+#include "ExternalCSRBuilder.hpp"
+#include "BCSRFile.hpp"
+#include "MatrixMarketFile.hpp"
+#include "Exception.hpp"
+#include "DomTest.hpp"
+
+
+
+
+using namespace WildRiver;
+
+
+
+
+/******************************************************************************
+* ALLOCATION TRACKING *********************************************************
+******************************************************************************/
+
+
+namespace
+{
+
+
+// the size of each allocation is kept in front of it
+size_t const ALLOC_HEADER = sizeof(std::max_align_t);
+
+std::atomic<size_t> allocatedBytes(0);
+std::atomic<size_t> peakBytes(0);
+
+
+}
+
+
+void * operator new(
+    size_t const size)
+{
+  char * const block = static_cast<char*>(std::malloc(size + ALLOC_HEADER));
+  if (block == nullptr) {
+    throw std::bad_alloc();
+  }
+  *reinterpret_cast<size_t*>(block) = size;
+
+  size_t const current = allocatedBytes.fetch_add(size) + size;
+  size_t peak = peakBytes.load();
+  while (current > peak && !peakBytes.compare_exchange_weak(peak, current)) {
+    // retry
+  }
+
+  return block + ALLOC_HEADER;
+}
+
+
+void operator delete(
+    void * const ptr) noexcept
+{
+  if (ptr == nullptr) {
+    return;
+  }
+
+  char * const block = static_cast<char*>(ptr) - ALLOC_HEADER;
+  allocatedBytes.fetch_sub(*reinterpret_cast<size_t*>(block));
+  std::free(block);
+}
+
+
+
+
+namespace DomTest
+{
+
+
+namespace
+{
+
+dim_t const NUM_ROWS = 30;
+dim_t const NUM_COLS = 25;
+
+
+bool isEntry(
+    dim_t const row,
+    dim_t const col)
+{
+  return (row*3 + col*5) % 4 == 0;
+}
+
+
+/**
+ * @brief Write a MatrixMarket file with the entries scrambled.
+ */
+ind_t writeScrambled(
+    std::string const & testFile)
+{
+  std::vector<std::pair<dim_t, dim_t>> entries;
+  for (dim_t r = 0; r < NUM_ROWS; ++r) {
+    for (dim_t c = 0; c < NUM_COLS; ++c) {
+      if (isEntry(r, c)) {
+        entries.emplace_back(r, c);
+      }
+    }
+  }
+
+  std::ofstream fout(testFile, std::ofstream::trunc);
+  fout << "%%MatrixMarket matrix coordinate real general" << std::endl;
+  fout << NUM_ROWS << " " << NUM_COLS << " " << entries.size() << std::endl;
+  // 97 is co-prime with the number of entries
+  for (size_t i = 0; i < entries.size(); ++i) {
+    std::pair<dim_t, dim_t> const & e = entries[(i*97) % entries.size()];
+    fout << (e.first+1) << " " << (e.second+1) << " " << \
+        (e.first*100 + e.second) << std::endl;
+  }
+
+  return entries.size();
+}
+
+
+/**
+ * @brief Counts the entries written to it, without allocating.
+ */
+class RowCounter :
+  public IRowMatrixWriter
+{
+  public:
+    ind_t numEntries;
+
+    RowCounter() :
+      numEntries(0)
+    {
+      // do nothing
+    }
+
+    void writeHeader(
+        dim_t,
+        dim_t,
+        ind_t) override
+    {
+      // do nothing
+    }
+
+    void setNextRow(
+        dim_t const numNonZeros,
+        dim_t const *,
+        val_t const *) override
+    {
+      numEntries += numNonZeros;
+    }
+};
+
+
+/**
+ * @brief Collects rows written to it.
+ */
+class RowCollector :
+  public IRowMatrixWriter
+{
+  public:
+    std::vector<ind_t> rowptr;
+    std::vector<dim_t> rowind;
+    std::vector<val_t> rowval;
+
+    RowCollector() :
+      rowptr(),
+      rowind(),
+      rowval()
+    {
+      // do nothing
+    }
+
+    void writeHeader(
+        dim_t,
+        dim_t,
+        ind_t) override
+    {
+      rowptr.assign(1, 0);
+    }
+
+    void setNextRow(
+        dim_t const numNonZeros,
+        dim_t const * const columns,
+        val_t const * const values) override
+    {
+      rowind.insert(rowind.end(), columns, columns+numNonZeros);
+      rowval.insert(rowval.end(), values, values+numNonZeros);
+      rowptr.emplace_back(rowind.size());
+    }
+};
+
+}
+
+
+static void spillTest(
+    std::string const & mmFile,
+    std::string const & outFile)
+{
+  ind_t const numEntries = writeScrambled(mmFile);
+
+  MatrixMarketFile mm(mmFile);
+  dim_t nrows, ncols;
+  ind_t nnz;
+  mm.getInfo(nrows, ncols, nnz);
+
+  // force many runs and several levels of merging
+  ExternalCSRBuilder builder(".", 32*sizeof(ExternalCSRBuilder::entry_struct));
+  mm.readEntries([&builder](dim_t row, dim_t col, val_t val) {
+    builder.add(row, col, val);
+  }, nullptr);
+
+  testEquals(builder.getNumEntries(), numEntries);
+
+  {
+    BCSRFile out(outFile);
+    builder.build(nrows, ncols, &out);
+  }
+  testGreaterThan(builder.getNumRuns(), numEntries / 32);
+
+  BCSRFile in(outFile);
+  in.getInfo(nrows, ncols, nnz);
+  testEquals(nrows, NUM_ROWS);
+  testEquals(ncols, NUM_COLS);
+  testEquals(nnz, numEntries);
+
+  std::vector<ind_t> rowptr(nrows+1);
+  std::vector<dim_t> rowind(nnz);
+  std::vector<val_t> rowval(nnz);
+  in.read(rowptr.data(), rowind.data(), rowval.data(), nullptr);
+
+  // every entry should be present, in order
+  ind_t idx = 0;
+  for (dim_t r = 0; r < NUM_ROWS; ++r) {
+    testEquals(rowptr[r], idx);
+    for (dim_t c = 0; c < NUM_COLS; ++c) {
+      if (isEntry(r, c)) {
+        testEquals(rowind[idx], c);
+        testEquals(rowval[idx], r*100 + c);
+        ++idx;
+      }
+    }
+  }
+  testEquals(rowptr[NUM_ROWS], idx);
+}
+
+
+static void inMemoryTest()
+{
+  ExternalCSRBuilder builder("", 0);
+
+  builder.add(2, 1, 1.0);
+  builder.add(0, 3, 2.0);
+  builder.add(2, 0, 3.0);
+  // duplicates keep the order they were added in
+  builder.add(0, 3, 4.0);
+
+  RowCollector rows;
+  builder.build(4, 4, &rows);
+
+  testEquals(builder.getNumRuns(), 0);
+
+  std::vector<ind_t> const rowptr{0, 2, 2, 4, 4};
+  std::vector<dim_t> const rowind{3, 3, 0, 1};
+  std::vector<val_t> const rowval{2.0, 4.0, 3.0, 1.0};
+
+  testEquals(rows.rowptr.size(), rowptr.size());
+  for (size_t i = 0; i < rowptr.size(); ++i) {
+    testEquals(rows.rowptr[i], rowptr[i]);
+  }
+  for (size_t i = 0; i < rowind.size(); ++i) {
+    testEquals(rows.rowind[i], rowind[i]);
+    testEquals(rows.rowval[i], rowval[i]);
+  }
+}
+
+
+static void symmetricTest(
+    std::string const & mmFile)
+{
+  std::ofstream fout(mmFile, std::ofstream::trunc);
+  fout << "%%MatrixMarket matrix coordinate real symmetric" << std::endl;
+  fout << "3 3 3" << std::endl;
+  fout << "3 1 1.0" << std::endl;
+  fout << "2 2 2.0" << std::endl;
+  fout << "2 1 3.0" << std::endl;
+  fout.close();
+
+  MatrixMarketFile mm(mmFile);
+  dim_t nrows, ncols;
+  ind_t nnz;
+  mm.getInfo(nrows, ncols, nnz);
+
+  ExternalCSRBuilder builder(".", 2*sizeof(ExternalCSRBuilder::entry_struct));
+  mm.readEntries([&builder](dim_t row, dim_t col, val_t val) {
+    builder.add(row, col, val);
+  }, nullptr);
+
+  RowCollector rows;
+  builder.build(nrows, ncols, &rows);
+
+  std::vector<ind_t> const rowptr{0, 2, 4, 5};
+  std::vector<dim_t> const rowind{1, 2, 0, 1, 0};
+  std::vector<val_t> const rowval{3.0, 1.0, 3.0, 2.0, 1.0};
+
+  testEquals(rows.rowptr.size(), rowptr.size());
+  for (size_t i = 0; i < rowptr.size(); ++i) {
+    testEquals(rows.rowptr[i], rowptr[i]);
+  }
+  for (size_t i = 0; i < rowind.size(); ++i) {
+    testEquals(rows.rowind[i], rowind[i]);
+    testEquals(rows.rowval[i], rowval[i]);
+  }
+}
+
+
+static void outOfBoundsTest()
+{
+  ExternalCSRBuilder builder("", 0);
+
+  builder.add(0, 0, 1.0);
+  builder.add(3, 0, 1.0);
+
+  RowCollector rows;
+  bool failed = false;
+  try {
+    builder.build(3, 3, &rows);
+  } catch (BadParameterException const &) {
+    failed = true;
+  }
+  testTrue(failed);
+}
+
+
+static void smallTest()
+{
+  // a few entries take little of the default budget, whether or not their
+  // number is known up front
+  for (size_t const maxEntries : {static_cast<size_t>(0), \
+      static_cast<size_t>(10)}) {
+    size_t const base = allocatedBytes.load();
+    peakBytes.store(base);
+
+    ExternalCSRBuilder builder("", 0, maxEntries);
+    for (dim_t i = 0; i < 10; ++i) {
+      builder.add(9-i, i, 1.0);
+    }
+
+    RowCounter rows;
+    builder.build(10, 10, &rows);
+    testEquals(rows.numEntries, 10);
+    testEquals(builder.getNumRuns(), 0);
+    testTrue(peakBytes.load() - base <= 1024*1024);
+  }
+}
+
+
+static void budgetTest()
+{
+  size_t const budget = 1024*1024;
+  // the run file streams and names are outside of the budget
+  size_t const slack = 64*1024;
+
+  dim_t const nrows = 1000;
+  dim_t const ncols = 500;
+
+  // enough entries to spill several runs, and to fit in memory
+  for (size_t const numEntries : {static_cast<size_t>(200000), \
+      budget / (2*sizeof(ExternalCSRBuilder::entry_struct))}) {
+    size_t const base = allocatedBytes.load();
+    peakBytes.store(base);
+
+    ExternalCSRBuilder builder(".", budget);
+    for (size_t i = 0; i < numEntries; ++i) {
+      builder.add(static_cast<dim_t>((i*7919) % nrows), \
+          static_cast<dim_t>(i % ncols), static_cast<val_t>(i % 100));
+    }
+    testTrue(peakBytes.load() - base <= budget + slack);
+
+    RowCounter rows;
+    builder.build(nrows, ncols, &rows);
+    testEquals(rows.numEntries, numEntries);
+    testTrue(peakBytes.load() - base <= budget + slack);
+  }
+}
+
+
+void Test::run()
+{
+  std::string const mmFile("./external_in.mtx");
+  std::string const outFile("./external_out.bcsr");
+
+  spillTest(mmFile, outFile);
+  inMemoryTest();
+  symmetricTest(mmFile);
+  outOfBoundsTest();
+  smallTest();
+  budgetTest();
+
+  Test::removeFile(mmFile);
+  Test::removeFile(outFile);
+}
+
+
+
+
+}
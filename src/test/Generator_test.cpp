@@ -0,0 +1,210 @@
+/**
+ * @file Generator_test.cpp
+ * @brief Test for generating synthetic matrices.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-26
+ */
+
+
+
+
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "Generator.hpp"
+#include "CSRFile.hpp"
+#include "Exception.hpp"
+#include "MatrixInHandle.hpp"
+#include "ThreadPool.hpp"
+#include "DomTest.hpp"
+
+
+
+
+using namespace WildRiver;
+
+
+
+
+namespace DomTest
+{
+
+
+static std::string readContents(
+    std::string const & testFile)
+{
+  std::ifstream stream(testFile);
+  std::stringstream contents;
+  contents << stream.rdbuf();
+  return contents.str();
+}
+
+
+static ind_t generate(
+    Generator & generator,
+    std::string const & testFile)
+{
+  CSRFile file(testFile);
+  return generator.write(&file);
+}
+
+
+static void deterministicTest(
+    std::string const & testFile)
+{
+  ThreadPool & pool = ThreadPool::getInstance();
+  int const numThreads = pool.getNumThreads();
+
+  // the output depends only on the seed
+  std::vector<std::string> outputs;
+  for (int const threads : {1, 4, 7}) {
+    pool.setNumThreads(threads);
+    Generator generator(5000, 5000, 42);
+    generator.setRMat(40000, 0.57, 0.19, 0.19);
+    generator.setSymmetric(true);
+    generate(generator, testFile);
+    outputs.emplace_back(readContents(testFile));
+  }
+  pool.setNumThreads(numThreads);
+
+  testTrue(outputs[0].size() > 0);
+  testTrue(outputs[0] == outputs[1]);
+  testTrue(outputs[0] == outputs[2]);
+
+  Generator other(5000, 5000, 43);
+  other.setRMat(40000, 0.57, 0.19, 0.19);
+  other.setSymmetric(true);
+  generate(other, testFile);
+  testTrue(readContents(testFile) != outputs[0]);
+
+  Test::removeFile(testFile);
+}
+
+
+static void symmetricTest(
+    std::string const & testFile)
+{
+  Generator generator(3000, 3000, 9);
+  generator.setRMat(20000, 0.45, 0.15, 0.15);
+  generator.setSymmetric(true);
+  generator.setDiagonal(false);
+  ind_t const written = generate(generator, testFile);
+  testEquals(generator.count(), written);
+
+  MatrixInHandle handle(testFile);
+  dim_t nrows, ncols;
+  ind_t nnz;
+  handle.getInfo(nrows, ncols, nnz);
+  testEquals(nnz, written);
+
+  std::vector<ind_t> rowptr(nrows+1);
+  std::vector<dim_t> rowind(nnz);
+  std::vector<val_t> rowval(nnz);
+  handle.readSparse(rowptr.data(), rowind.data(), rowval.data());
+
+  // each entry is mirrored with the same value, and rows are sorted
+  std::map<std::pair<dim_t, dim_t>, val_t> entries;
+  bool sorted = true;
+  bool loops = false;
+  for (dim_t i = 0; i < nrows; ++i) {
+    for (ind_t j = rowptr[i]; j < rowptr[i+1]; ++j) {
+      entries[std::make_pair(i, rowind[j])] = rowval[j];
+      sorted = sorted && (j == rowptr[i] || rowind[j-1] < rowind[j]);
+      loops = loops || rowind[j] == i;
+    }
+  }
+  testTrue(sorted);
+  testTrue(!loops);
+
+  bool mirrored = true;
+  for (auto const & entry : entries) {
+    auto const match = entries.find(std::make_pair(entry.first.second, \
+        entry.first.first));
+    mirrored = mirrored && match != entries.end() && \
+        match->second == entry.second;
+  }
+  testTrue(mirrored);
+
+  // the heavy quadrant gets more entries
+  testTrue(rowptr[nrows/2] > nnz - rowptr[nrows/2]);
+
+  Test::removeFile(testFile);
+}
+
+
+static void uniformTest(
+    std::string const & testFile)
+{
+  // a rectangular matrix keeps its entries within bounds
+  Generator generator(100, 3000, 5);
+  generator.setUniform(5000);
+  ind_t const written = generate(generator, testFile);
+  testTrue(written > 4500);
+  testTrue(written <= 5500);
+
+  MatrixInHandle handle(testFile);
+  dim_t nrows, ncols;
+  ind_t nnz;
+  handle.getInfo(nrows, ncols, nnz);
+  testEquals(nrows, 100);
+  testTrue(ncols <= 3000);
+
+  Test::removeFile(testFile);
+}
+
+
+static void bandedTest(
+    std::string const & testFile)
+{
+  Generator generator(10, 10, 0);
+  generator.setBanded(2);
+  testEquals(generate(generator, testFile), 44);
+
+  MatrixInHandle handle(testFile);
+  dim_t nrows, ncols;
+  ind_t nnz;
+  handle.getInfo(nrows, ncols, nnz);
+
+  std::vector<ind_t> rowptr(nrows+1);
+  std::vector<dim_t> rowind(nnz);
+  std::vector<val_t> rowval(nnz);
+  handle.readSparse(rowptr.data(), rowind.data(), rowval.data());
+
+  testEquals(rowptr[1], 3);
+  testEquals(rowptr[3] - rowptr[2], 5);
+  testEquals(rowind[rowptr[2]], 0);
+  testEquals(rowval[rowptr[2]], -1);
+  testEquals(rowval[rowptr[2]+2], 4);
+
+  Test::removeFile(testFile);
+
+  // rectangular symmetric matrices are rejected
+  Generator rectangular(10, 20, 0);
+  rectangular.setSymmetric(true);
+  bool thrown = false;
+  try {
+    rectangular.count();
+  } catch (BadParameterException const &) {
+    thrown = true;
+  }
+  testTrue(thrown);
+}
+
+
+void Test::run()
+{
+  deterministicTest("./Generator_test.csr");
+  symmetricTest("./Generator_test.csr");
+  uniformTest("./Generator_test.csr");
+  bandedTest("./Generator_test.csr");
+}
+
+
+
+
+}
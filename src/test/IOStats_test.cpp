@@ -0,0 +1,153 @@
+/**
+ * @file IOStats_test.cpp
+ * @brief Test for collecting the timings and counts of reads and writes.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-27
+ */
+
+
+
+
+#include <fstream>
+#include <vector>
+
+#include "IOStats.hpp"
+#include "MatrixInHandle.hpp"
+#include "MatrixOutHandle.hpp"
+#include "DomTest.hpp"
+
+
+
+
+using namespace WildRiver;
+
+
+
+
+namespace DomTest
+{
+
+
+static size_t fileSize(
+    std::string const & testFile)
+{
+  std::ifstream stream(testFile, std::ifstream::ate | std::ifstream::binary);
+  return static_cast<size_t>(stream.tellg());
+}
+
+
+static void temporaryTest()
+{
+  IOStats stats;
+  {
+    IOStats::Scope scope(&stats);
+
+    IOStats::Temporary first(100);
+    {
+      IOStats::Temporary second(50);
+    }
+    IOStats::Temporary third(20);
+    third.resize(60);
+    IOStats::addCurrentAllocation(1000);
+  }
+
+  // nothing is reported once the scope ends
+  IOStats::addCurrentBytes(10);
+
+  wildriver_stats const result = stats.getStats();
+  testEquals(result.peak_temporary_bytes, 180);
+  testEquals(result.allocations, 5);
+  testEquals(result.bytes, 0);
+}
+
+
+static void readTest(
+    std::string const & testFile)
+{
+  {
+    std::ofstream stream(testFile);
+    stream << "%%MatrixMarket matrix coordinate real general\n";
+    stream << "% a comment\n";
+    stream << "% another comment\n";
+    stream << "3 3 4\n";
+    stream << "1 1 1.0\n";
+    stream << "2 2 2.0\n";
+    stream << "3 1 3.0\n";
+    stream << "3 3 4.0\n";
+  }
+
+  {
+    IOStats::Record record("read", testFile.c_str());
+
+    MatrixInHandle handle(testFile);
+    dim_t nrows, ncols;
+    ind_t nnz;
+    handle.getInfo(nrows, ncols, nnz);
+
+    std::vector<ind_t> rowptr(nrows+1);
+    std::vector<dim_t> rowind(nnz);
+    std::vector<val_t> rowval(nnz);
+    handle.readSparse(rowptr.data(), rowind.data(), rowval.data());
+  }
+
+  wildriver_stats stats;
+  testTrue(IOStats::getLast(&stats));
+  testEquals(stats.bytes, fileSize(testFile));
+  testEquals(stats.lines, 8);
+  testEquals(stats.comment_lines, 2);
+  testEquals(stats.rows, 3);
+  testEquals(stats.entries, 4);
+
+  // the coordinates are sorted into rows through temporary arrays
+  testTrue(stats.peak_temporary_bytes >= 4*(sizeof(dim_t)+sizeof(ind_t)));
+  testTrue(stats.phase_seconds[WILDRIVER_PHASE_READ] > 0);
+  testEquals(stats.phase_seconds[WILDRIVER_PHASE_WRITE], 0);
+  testTrue(stats.seconds >= stats.phase_seconds[WILDRIVER_PHASE_READ]);
+
+  Test::removeFile(testFile);
+}
+
+
+static void writeTest(
+    std::string const & testFile)
+{
+  std::vector<ind_t> const rowptr{0, 2, 3, 5};
+  std::vector<dim_t> const rowind{0, 2, 1, 0, 2};
+  std::vector<val_t> const rowval{1, 2, 3, 4, 5};
+
+  {
+    IOStats::Record record("write", testFile.c_str());
+
+    // an operation within another is part of it
+    IOStats::Record inner("inner", nullptr);
+
+    MatrixOutHandle handle(testFile);
+    handle.setInfo(3, 3, 5);
+    handle.writeSparse(rowptr.data(), rowind.data(), rowval.data());
+  }
+
+  wildriver_stats stats;
+  testTrue(IOStats::getLast(&stats));
+  testEquals(stats.bytes, fileSize(testFile));
+  testEquals(stats.lines, 3);
+  testEquals(stats.rows, 3);
+  testEquals(stats.entries, 5);
+  testTrue(stats.phase_seconds[WILDRIVER_PHASE_WRITE] > 0);
+
+  Test::removeFile(testFile);
+}
+
+
+void Test::run()
+{
+  temporaryTest();
+  readTest("./IOStats_test.mtx");
+  writeTest("./IOStats_test.csr");
+}
+
+
+
+
+}
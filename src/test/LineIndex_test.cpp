@@ -0,0 +1,140 @@
+/**
+ * @file LineIndex_test.cpp
+ * @brief Test for indexing the lines of text files.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-18
+ */
+
+
+
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "LineIndex.hpp"
+#include "Exception.hpp"
+#include "DomTest.hpp"
+
+
+
+
+using namespace WildRiver;
+
+
+
+
+namespace DomTest
+{
+
+
+static void indexTest(
+    std::string const & testFile)
+{
+  size_t const numLines = 2*LineIndex::STRIDE + 10;
+
+  // record the offset of each data line as it is written
+  std::vector<size_t> offsets;
+  std::vector<size_t> fileLines;
+  {
+    std::ofstream fout(testFile, std::ofstream::trunc | std::ofstream::binary);
+    size_t fileLine = 0;
+    fout << "% a header comment\n";
+    ++fileLine;
+    for (size_t i = 0; i < numLines; ++i) {
+      if (i % 100 == 50) {
+        fout << "# a comment\n";
+        ++fileLine;
+      }
+      offsets.emplace_back(static_cast<size_t>(fout.tellp()));
+      fileLines.emplace_back(fileLine);
+      if (i % 10 != 3) {
+        fout << i << " " << (i*2);
+      }
+      fout << "\n";
+      ++fileLine;
+    }
+  }
+
+  LineIndex index(testFile, "#%");
+
+  testEquals(index.getNumLines(), numLines);
+  testEquals(index.getNumBlocks(), 3);
+  testTrue(!index.hasBlockFields());
+
+  size_t const lines[] = {0, 1, LineIndex::STRIDE-1, LineIndex::STRIDE, \
+      LineIndex::STRIDE+517, numLines-1};
+  for (size_t const line : lines) {
+    size_t indexedLine, offset, fileLine;
+    index.find(line, &indexedLine, &offset, &fileLine);
+
+    testEquals(indexedLine, (line / LineIndex::STRIDE)*LineIndex::STRIDE);
+    testEquals(offset, offsets[indexedLine]);
+    testEquals(fileLine, fileLines[indexedLine]);
+  }
+
+  bool caught = false;
+  try {
+    size_t indexedLine, offset, fileLine;
+    index.find(numLines, &indexedLine, &offset, &fileLine);
+  } catch (BadParameterException const &) {
+    caught = true;
+  }
+  testTrue(caught);
+}
+
+
+static void fieldsTest(
+    std::string const & testFile)
+{
+  // the file written by indexTest()
+  size_t const numLines = 2*LineIndex::STRIDE + 10;
+
+  std::vector<size_t> fields;
+  LineIndex::countFields(testFile, "#%", &fields);
+  testEquals(fields.size(), numLines);
+  for (size_t i = 0; i < numLines; ++i) {
+    size_t const expected = i % 10 != 3 ? 2 : 0;
+    testEquals(fields[i], expected);
+  }
+
+  LineIndex index(testFile, "#%", true);
+  testEquals(index.getNumLines(), numLines);
+  testTrue(index.hasBlockFields());
+
+  std::vector<size_t> const & blockFields = index.getBlockFields();
+  testEquals(blockFields.size(), index.getNumBlocks());
+  for (size_t b = 0; b < index.getNumBlocks(); ++b) {
+    std::vector<size_t> lineFields;
+    index.countBlockFields(b, &lineFields);
+
+    size_t const first = b*LineIndex::STRIDE;
+    testEquals(lineFields.size(), \
+        std::min(LineIndex::STRIDE, numLines - first));
+    size_t sum = 0;
+    for (size_t i = 0; i < lineFields.size(); ++i) {
+      testEquals(lineFields[i], fields[first+i]);
+      sum += lineFields[i];
+    }
+    testEquals(blockFields[b], sum);
+  }
+}
+
+
+void Test::run()
+{
+  std::string const testFile("./LineIndex_test.txt");
+
+  indexTest(testFile);
+  fieldsTest(testFile);
+
+  Test::removeFile(testFile);
+}
+
+
+
+
+}
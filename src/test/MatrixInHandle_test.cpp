@@ -10,11 +10,17 @@
 
 
 
+#include <cstdio>
 #include <iostream>
 #include <fstream>
 #include <memory>
+#include <thread>
+#include <vector>
 
+#include "LineIndex.hpp"
 #include "MatrixInHandle.hpp"
+#include "RowPartition.hpp"
+#include "Exception.hpp"
 #include "DomTest.hpp"
 
 
@@ -59,6 +65,98 @@ static void writeSparse(
 }
 
 
+static void writeMatrixMarket(
+    std::string const & testFile)
+{
+  std::fstream stream(testFile,std::fstream::out | std::fstream::trunc);
+
+  stream << "%%MatrixMarket matrix coordinate real general" << std::endl;
+  stream << "6 6 14" << std::endl;
+
+  // row-major, as most files are
+  stream << "1 2 1" << std::endl;
+  stream << "1 3 2" << std::endl;
+  stream << "2 1 3" << std::endl;
+  stream << "2 3 4" << std::endl;
+  stream << "3 1 5" << std::endl;
+  stream << "3 2 6" << std::endl;
+  stream << "3 4 7" << std::endl;
+  stream << "4 3 8" << std::endl;
+  stream << "4 5 9" << std::endl;
+  stream << "4 6 1" << std::endl;
+  stream << "5 4 2" << std::endl;
+  stream << "5 6 3" << std::endl;
+  stream << "6 4 4" << std::endl;
+  stream << "6 5 5" << std::endl;
+}
+
+
+static void checkTransposed(
+    wildriver_ind_t const * const colptr,
+    wildriver_dim_t const * const colind,
+    wildriver_val_t const * const colval)
+{
+  wildriver_ind_t const expColptr[] = {0,2,4,7,10,12,14};
+  wildriver_dim_t const expColind[] = {1,2,0,2,0,1,3,2,4,5,3,5,3,4};
+  wildriver_val_t const expColval[] = {3,5,1,6,2,4,8,7,2,4,9,5,1,3};
+
+  for (size_t i = 0; i < 7; ++i) {
+    testEquals(colptr[i],expColptr[i]);
+  }
+  for (size_t j = 0; j < 14; ++j) {
+    testEquals(colind[j],expColind[j]);
+    testEquals(colval[j],expColval[j]);
+  }
+}
+
+
+static void readTransposed(
+    std::string const & testFile)
+{
+  MatrixInHandle handle(testFile);
+
+  wildriver_dim_t nrows, ncols;
+  wildriver_ind_t nnz;
+  handle.getInfo(nrows,ncols,nnz);
+
+  std::unique_ptr<wildriver_ind_t[]> colptr(new wildriver_ind_t[ncols+1]);
+  std::unique_ptr<wildriver_dim_t[]> colind(new wildriver_dim_t[nnz]);
+  std::unique_ptr<wildriver_val_t[]> colval(new wildriver_val_t[nnz]);
+
+  handle.readSparseTransposed(colptr.get(),colind.get(),colval.get());
+
+  checkTransposed(colptr.get(),colind.get(),colval.get());
+}
+
+
+static void readBoth(
+    std::string const & testFile)
+{
+  MatrixInHandle handle(testFile);
+  handle.setNumThreads(3);
+
+  wildriver_dim_t nrows, ncols;
+  wildriver_ind_t nnz;
+  handle.getInfo(nrows,ncols,nnz);
+
+  std::unique_ptr<wildriver_ind_t[]> rowptr(new wildriver_ind_t[nrows+1]);
+  std::unique_ptr<wildriver_dim_t[]> rowind(new wildriver_dim_t[nnz]);
+  std::unique_ptr<wildriver_val_t[]> rowval(new wildriver_val_t[nnz]);
+  std::unique_ptr<wildriver_ind_t[]> colptr(new wildriver_ind_t[ncols+1]);
+  std::unique_ptr<wildriver_dim_t[]> colind(new wildriver_dim_t[nnz]);
+  std::unique_ptr<wildriver_val_t[]> colval(new wildriver_val_t[nnz]);
+
+  handle.readSparseBoth(rowptr.get(),rowind.get(),rowval.get(), \
+      colptr.get(),colind.get(),colval.get());
+
+  testEquals(rowptr[6],14);
+  testEquals(rowind[6],3);
+  testEquals(rowval[6],7);
+
+  checkTransposed(colptr.get(),colind.get(),colval.get());
+}
+
+
 static void readSparse(
     std::string const & testFile)
 {
@@ -125,16 +223,325 @@ static void readSparse(
 }
 
 
+template<typename I, typename D, typename V>
+static void readTyped(
+    std::string const & testFile)
+{
+  MatrixInHandle handle(testFile);
+
+  wildriver_dim_t nrows, ncols;
+  wildriver_ind_t nnz;
+  handle.getInfo(nrows,ncols,nnz);
+
+  std::unique_ptr<I[]> rowptr(new I[nrows+1]);
+  std::unique_ptr<D[]> rowind(new D[nnz]);
+  std::unique_ptr<V[]> rowval(new V[nnz]);
+
+  handle.readSparseTyped(rowptr.get(),rowind.get(),rowval.get());
+
+  I const expRowptr[] = {0,2,4,7,10,12,14};
+  D const expRowind[] = {1,2,0,2,0,1,3,2,4,5,3,5,3,4};
+  V const expRowval[] = {1,2,3,4,5,6,7,8,9,1,2,3,4,5};
+
+  for (size_t i = 0; i < 7; ++i) {
+    testEquals(rowptr[i],expRowptr[i]);
+  }
+  for (size_t j = 0; j < 14; ++j) {
+    testEquals(rowind[j],expRowind[j]);
+    testEquals(rowval[j],expRowval[j]);
+  }
+}
+
+
+static void readRange(
+    std::string const & testFile)
+{
+  MatrixInHandle handle(testFile);
+
+  std::vector<wildriver_ind_t> rowptr;
+  std::vector<wildriver_dim_t> rowind;
+  std::vector<wildriver_val_t> rowval;
+
+  handle.readSparseRange(2,5,rowptr,rowind,&rowval);
+
+  wildriver_ind_t const expRowptr[] = {0,3,6,8};
+  wildriver_dim_t const expRowind[] = {0,1,3,2,4,5,3,5};
+  wildriver_val_t const expRowval[] = {5,6,7,8,9,1,2,3};
+
+  testEquals(rowptr.size(),4);
+  testEquals(rowind.size(),8);
+  testEquals(rowval.size(),8);
+  for (size_t i = 0; i < 4; ++i) {
+    testEquals(rowptr[i],expRowptr[i]);
+  }
+  for (size_t j = 0; j < 8; ++j) {
+    testEquals(rowind[j],expRowind[j]);
+    testEquals(rowval[j],expRowval[j]);
+  }
+
+  // pattern only, to the last row
+  handle.readSparseRange(5,6,rowptr,rowind,nullptr);
+  testEquals(rowptr.size(),2);
+  testEquals(rowptr[1],2);
+  testEquals(rowind[0],3);
+  testEquals(rowind[1],4);
+
+  // empty range
+  handle.readSparseRange(3,3,rowptr,rowind,&rowval);
+  testEquals(rowptr.size(),1);
+  testEquals(rowind.size(),0);
+
+  bool caught = false;
+  try {
+    handle.readSparseRange(4,7,rowptr,rowind,&rowval);
+  } catch (BadParameterException const &) {
+    caught = true;
+  }
+  testTrue(caught);
+}
+
+
+static void readParts(
+    std::string const & testFile,
+    int const numParts)
+{
+  std::vector<wildriver_ind_t> fullRowptr;
+  std::vector<wildriver_dim_t> fullRowind;
+  std::vector<wildriver_val_t> fullRowval;
+  wildriver_dim_t nrows;
+  {
+    MatrixInHandle handle(testFile);
+    wildriver_dim_t ncols;
+    wildriver_ind_t nnz;
+    handle.getInfo(nrows,ncols,nnz);
+
+    fullRowptr.resize(nrows+1);
+    fullRowind.resize(nnz);
+    fullRowval.resize(nnz);
+    handle.readSparse(fullRowptr.data(),fullRowind.data(),fullRowval.data());
+  }
+
+  // load each part from its own thread, as separate ranks would
+  std::vector<wildriver_dim_t> begins(numParts);
+  std::vector<wildriver_dim_t> ends(numParts);
+  std::vector<std::vector<wildriver_ind_t>> rowptrs(numParts);
+  std::vector<std::vector<wildriver_dim_t>> rowinds(numParts);
+  std::vector<std::vector<wildriver_val_t>> rowvals(numParts);
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < numParts; ++p) {
+    threads.emplace_back([&, p]() {
+      MatrixInHandle handle(testFile);
+      handle.readSparsePart(numParts,p,begins[p],ends[p],rowptrs[p], \
+          rowinds[p],&rowvals[p]);
+    });
+  }
+  for (std::thread & thread : threads) {
+    thread.join();
+  }
+
+  // the parts must cover the matrix exactly
+  testEquals(begins[0],0);
+  testEquals(ends[numParts-1],nrows);
+  for (int p = 0; p < numParts; ++p) {
+    if (p > 0) {
+      testEquals(begins[p],ends[p-1]);
+    }
+
+    wildriver_ind_t const offset = fullRowptr[begins[p]];
+    for (wildriver_dim_t i = begins[p]; i <= ends[p]; ++i) {
+      testEquals(rowptrs[p][i-begins[p]],fullRowptr[i]-offset);
+    }
+    for (size_t j = 0; j < rowinds[p].size(); ++j) {
+      testEquals(rowinds[p][j],fullRowind[offset+j]);
+      testEquals(rowvals[p][j],fullRowval[offset+j]);
+    }
+  }
+}
+
+
+static void readPartsSkewed()
+{
+  std::string const testFile("./MatrixInHandle_test_skewed.csr");
+  {
+    // one row holding half of the non-zeros
+    std::fstream stream(testFile,std::fstream::out | std::fstream::trunc);
+    for (int j = 0; j < 1000; ++j) {
+      stream << j << " 1 ";
+    }
+    stream << std::endl;
+    for (int i = 1; i < 1000; ++i) {
+      stream << (i % 7) << " 2" << std::endl;
+    }
+  }
+
+  readParts(testFile,4);
+
+  MatrixInHandle handle(testFile);
+  std::vector<wildriver_dim_t> const starts = handle.getPartition(4);
+
+  // splitting by rows would give the first part 1250 non-zeros, splitting by
+  // non-zeros isolates the heavy row
+  testEquals(starts[1],1);
+
+  Test::removeFile(testFile);
+}
+
+
+static void readPartsBlocks()
+{
+  // several blocks of the line index, with uneven and empty rows
+  wildriver_dim_t const nrows = \
+      static_cast<wildriver_dim_t>(3*LineIndex::STRIDE + 100);
+  std::vector<std::vector<wildriver_dim_t>> adj(nrows);
+  for (wildriver_dim_t i = 0; i < nrows; ++i) {
+    wildriver_dim_t const degree = i == 1500 ? 2000 : i % 11;
+    for (wildriver_dim_t j = 1; j <= degree; ++j) {
+      wildriver_dim_t const other = (i + j*7) % nrows;
+      adj[i].emplace_back(other);
+      adj[other].emplace_back(i);
+    }
+  }
+  size_t nnz = 0;
+  for (std::vector<wildriver_dim_t> const & row : adj) {
+    nnz += row.size();
+  }
+
+  std::string const csrFile("./MatrixInHandle_test_blocks.csr");
+  std::string const metisFile("./MatrixInHandle_test_blocks.graph");
+  {
+    std::fstream csr(csrFile,std::fstream::out | std::fstream::trunc);
+    std::fstream metis(metisFile,std::fstream::out | std::fstream::trunc);
+    metis << "% vertex weights and edge weights" << std::endl;
+    metis << nrows << " " << (nnz/2) << " 11 1" << std::endl;
+    for (wildriver_dim_t i = 0; i < nrows; ++i) {
+      if (i % 1000 == 0) {
+        csr << "# rows from " << i << std::endl;
+      }
+      metis << (i % 3 + 1);
+      for (size_t j = 0; j < adj[i].size(); ++j) {
+        csr << (j > 0 ? " " : "") << adj[i][j] << " " << (j+1);
+        metis << " " << (adj[i][j]+1) << " " << (j+1);
+      }
+      csr << std::endl;
+      metis << std::endl;
+    }
+  }
+
+  // the same parts as balancing the count of every row
+  for (std::string const & testFile : {csrFile, metisFile}) {
+    for (int const numParts : {1, 3, 7, 64}) {
+      MatrixInHandle handle(testFile);
+      std::vector<wildriver_ind_t> counts;
+      handle.readRowCounts(counts);
+
+      std::vector<wildriver_dim_t> const starts = \
+          handle.getPartition(numParts);
+      std::vector<wildriver_dim_t> const expected = \
+          RowPartition::balance(counts, numParts);
+      testEquals(starts.size(), expected.size());
+      for (size_t p = 0; p < starts.size(); ++p) {
+        testEquals(starts[p], expected[p]);
+      }
+    }
+    readParts(testFile,5);
+  }
+
+  // the index is built while the header is read, so reading a range does
+  // not need to scan the file again
+  {
+    MatrixInHandle handle(csrFile);
+    wildriver_dim_t numRows, numCols;
+    wildriver_ind_t numNonZeros;
+    handle.getInfo(numRows,numCols,numNonZeros);
+
+    std::string const movedFile = csrFile + ".moved";
+    testEquals(std::rename(csrFile.c_str(),movedFile.c_str()),0);
+
+    std::vector<wildriver_ind_t> rowptr;
+    std::vector<wildriver_dim_t> rowind;
+    std::vector<wildriver_val_t> rowval;
+    handle.readSparseRange(2500,2600,rowptr,rowind,&rowval);
+
+    testEquals(rowptr.size(),101);
+    for (wildriver_dim_t i = 2500; i < 2600; ++i) {
+      wildriver_ind_t const start = rowptr[i-2500];
+      testEquals(rowptr[i-2500+1]-start,adj[i].size());
+      for (size_t j = 0; j < adj[i].size(); ++j) {
+        testEquals(rowind[start+j],adj[i][j]);
+      }
+    }
+
+    testEquals(std::rename(movedFile.c_str(),csrFile.c_str()),0);
+  }
+
+  Test::removeFile(csrFile);
+  Test::removeFile(metisFile);
+}
+
+
+static void readTypedTooSmall()
+{
+  std::string const testFile("./MatrixInHandle_test_large.mtx");
+  {
+    std::fstream stream(testFile,std::fstream::out | std::fstream::trunc);
+    stream << "%%MatrixMarket matrix coordinate real general" << std::endl;
+    stream << "1 1 4294967296" << std::endl;
+  }
+
+  MatrixInHandle handle(testFile);
+
+  uint32_t rowptr[2];
+  uint32_t rowind[1];
+  float rowval[1];
+
+  bool caught = false;
+  try {
+    handle.readSparseTyped(rowptr,rowind,rowval);
+  } catch (BadParameterException const &) {
+    caught = true;
+  }
+  testTrue(caught);
+
+  Test::removeFile(testFile);
+}
+
+
 void Test::run()
 {
   // generate test metis file
   std::string metisFile("./MatrixInHandle_test.graph");
   writeMetis(metisFile);
   readSparse(metisFile);
+  readTransposed(metisFile);
+  readTyped<uint32_t, uint32_t, float>(metisFile);
+  readRange(metisFile);
+  readParts(metisFile,3);
 
   std::string csrFile("./MatrixInHandle_test.csr");
   writeSparse(csrFile);
   readSparse(csrFile);
+  readTransposed(csrFile);
+  readBoth(csrFile);
+  readTyped<uint32_t, uint32_t, float>(csrFile);
+  readTyped<uint64_t, uint64_t, int32_t>(csrFile);
+  readRange(csrFile);
+  readParts(csrFile,3);
+  readParts(csrFile,8);
+
+  std::string mmFile("./MatrixInHandle_test.mtx");
+  writeMatrixMarket(mmFile);
+  readTransposed(mmFile);
+  readBoth(mmFile);
+  readTyped<uint32_t, uint32_t, float>(mmFile);
+  readTyped<uint64_t, uint32_t, int64_t>(mmFile);
+  readRange(mmFile);
+  readParts(mmFile,4);
+
+  readPartsSkewed();
+  readPartsBlocks();
+
+  readTypedTooSmall();
 }
 
 
@@ -13,6 +13,7 @@
 #include <memory>
 
 #include "MatrixOutHandle.hpp"
+#include "MatrixInHandle.hpp"
 #include "DomTest.hpp"
 
 
@@ -41,6 +42,49 @@ static void writeSparse(
 }
 
 
+static void writeTyped(
+    std::string const & testFile)
+{
+  uint32_t rowptr[] = {0,2,4,7,10,12,14};
+  uint32_t rowind[] = {1,2,0,2,0,1,3,2,4,5,3,5,3,4};
+  float rowval[] = {1,2,3,4,5,6,7,8,9,1,2,3,4,5};
+
+  MatrixOutHandle handle(testFile);
+
+  handle.setInfo(6,6,14);
+
+  handle.writeSparseTyped(rowptr,rowind,rowval);
+}
+
+
+static void readTyped(
+    std::string const & testFile)
+{
+  MatrixInHandle handle(testFile);
+
+  wildriver_dim_t nrows, ncols;
+  wildriver_ind_t nnz;
+  handle.getInfo(nrows,ncols,nnz);
+
+  testEquals(nrows,6);
+  testEquals(ncols,6);
+  testEquals(nnz,14);
+
+  std::unique_ptr<uint32_t[]> rowptr(new uint32_t[nrows+1]);
+  std::unique_ptr<uint64_t[]> rowind(new uint64_t[nnz]);
+  std::unique_ptr<float[]> rowval(new float[nnz]);
+
+  handle.readSparseTyped(rowptr.get(),rowind.get(),rowval.get());
+
+  testEquals(rowptr[3],7);
+  testEquals(rowptr[6],14);
+  testEquals(rowind[6],3);
+  testEquals(rowval[6],7.0f);
+  testEquals(rowind[13],4);
+  testEquals(rowval[13],5.0f);
+}
+
+
 static void readSparse(
     std::string const & testFile)
 {
@@ -111,6 +155,21 @@ void Test::run()
   std::string csrFile("./MatrixOutHandle_test.csr");
   writeSparse(csrFile);
   readSparse(csrFile);
+
+  // typed round trips
+  writeTyped(metisFile);
+  readMetis(metisFile);
+
+  writeTyped(csrFile);
+  readSparse(csrFile);
+
+  std::string bcsrFile("./MatrixOutHandle_test.bcsr");
+  writeTyped(bcsrFile);
+  readTyped(bcsrFile);
+
+  std::string mmFile("./MatrixOutHandle_test.mtx");
+  writeTyped(mmFile);
+  readTyped(mmFile);
 }
 
 
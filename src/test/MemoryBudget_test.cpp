@@ -0,0 +1,238 @@
+/**
+ * @file MemoryBudget_test.cpp
+ * @brief Test for limiting the temporary memory of reads.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-27
+ */
+
+
+
+
+#include <fstream>
+#include <vector>
+
+#include "MemoryBudget.hpp"
+#include "IOStats.hpp"
+#include "MatrixInHandle.hpp"
+#include "MatrixOutHandle.hpp"
+#include "GraphInHandle.hpp"
+#include "Exception.hpp"
+#include "DomTest.hpp"
+#include "TestMatrix.hpp"
+
+
+
+
+using namespace WildRiver;
+
+
+
+
+namespace DomTest
+{
+
+
+static csr_struct readRecorded(
+    std::string const & testFile,
+    bool const transpose)
+{
+  IOStats::Record record("read", testFile.c_str());
+  return readMatrix(testFile, transpose);
+}
+
+
+static void matrixMarketTest(
+    std::string const & testFile,
+    bool const symmetric,
+    bool const transpose)
+{
+  {
+    std::ofstream stream(testFile);
+    stream << "%%MatrixMarket matrix coordinate real " << \
+        (symmetric ? "symmetric" : "general") << "\n";
+    stream << "% a comment\n";
+    stream << "4 4 6\n";
+    stream << "3 1 1.0\n";
+    stream << "1 1 2.0\n";
+    stream << "4 2 3.0\n";
+    stream << "2 1 4.0\n";
+    stream << "4 4 5.0\n";
+    stream << "4 3 6.0\n";
+  }
+
+  MemoryBudget::set(0);
+  csr_struct const sorted = readRecorded(testFile, transpose);
+  testTrue(sorted.temporaryBytes > 0);
+
+  wildriver_stats stats;
+  testTrue(IOStats::getLast(&stats));
+  testTrue(stats.peak_temporary_bytes > 0);
+  testTrue(stats.peak_temporary_bytes <= sorted.temporaryBytes);
+
+  // the file is read twice instead of sorted in memory
+  MemoryBudget::set(1);
+  csr_struct const twice = readRecorded(testFile, transpose);
+  testEquals(twice.temporaryBytes, 0);
+  testTrue(IOStats::getLast(&stats));
+  testEquals(stats.peak_temporary_bytes, 0);
+  testEquals(stats.entries, twice.rowind.size());
+  MemoryBudget::set(0);
+
+  compare(sorted, twice);
+
+  Test::removeFile(testFile);
+}
+
+
+static void snapTest(
+    std::string const & testFile)
+{
+  {
+    std::ofstream stream(testFile);
+    stream << "# Undirected graph (each unordered pair of nodes is saved " \
+        "once): test.snap\n";
+    stream << "# Nodes: 5 Edges: 4\n";
+    stream << "# FromNodeId\tToNodeId\n";
+    stream << "3\t0\n";
+    stream << "0\t1\n";
+    stream << "4\t2\n";
+    stream << "1\t3\n";
+  }
+
+  std::vector<std::vector<ind_t>> xadjs;
+  std::vector<std::vector<dim_t>> adjncys;
+  std::vector<size_t> budgets{0, 1};
+  for (size_t const budget : budgets) {
+    MemoryBudget::set(budget);
+
+    GraphInHandle handle(testFile);
+    dim_t nvtxs;
+    ind_t nedges;
+    int nvwgt;
+    bool ewgts;
+    handle.getInfo(nvtxs, nedges, nvwgt, ewgts);
+    testTrue((handle.getTemporaryBytes() > 0) == (budget == 0));
+
+    std::vector<ind_t> xadj(nvtxs+1);
+    std::vector<dim_t> adjncy(nedges);
+    handle.readGraph(xadj.data(), adjncy.data(), nullptr, nullptr);
+
+    xadjs.emplace_back(xadj);
+    adjncys.emplace_back(adjncy);
+  }
+  MemoryBudget::set(0);
+
+  testEquals(xadjs[0].size(), 6);
+  for (size_t i = 0; i < xadjs[0].size(); ++i) {
+    testEquals(xadjs[0][i], xadjs[1][i]);
+  }
+  testEquals(adjncys[0].size(), 8);
+  for (size_t j = 0; j < adjncys[0].size(); ++j) {
+    testEquals(adjncys[0][j], adjncys[1][j]);
+  }
+
+  Test::removeFile(testFile);
+}
+
+
+static void failFastTest(
+    std::string const & testFile)
+{
+  std::vector<ind_t> const rowptr{0, 2, 3, 5};
+  std::vector<dim_t> const rowind{0, 2, 1, 0, 2};
+  std::vector<val_t> const rowval{1, 2, 3, 4, 5};
+  {
+    MatrixOutHandle handle(testFile);
+    handle.setInfo(3, 3, 5);
+    handle.writeSparse(rowptr.data(), rowind.data(), rowval.data());
+  }
+
+  std::vector<ind_t> colptr(4);
+  std::vector<dim_t> colind(5);
+  std::vector<val_t> colval(5);
+
+  // transposing a binary CSR file needs a copy of the matrix
+  MemoryBudget::set(64);
+  bool failed = false;
+  try {
+    MatrixInHandle handle(testFile);
+    dim_t nrows, ncols;
+    ind_t nnz;
+    handle.getInfo(nrows, ncols, nnz);
+    handle.readSparseTransposed(colptr.data(), colind.data(), \
+        colval.data());
+  } catch (MemoryBudgetException const &) {
+    failed = true;
+  }
+  testTrue(failed);
+
+  MemoryBudget::set(1 << 20);
+  {
+    MatrixInHandle handle(testFile);
+    dim_t nrows, ncols;
+    ind_t nnz;
+    handle.getInfo(nrows, ncols, nnz);
+    handle.readSparseTransposed(colptr.data(), colind.data(), \
+        colval.data());
+  }
+  MemoryBudget::set(0);
+
+  testEquals(colptr[3], 5);
+  testEquals(colind[0], 0);
+  testEquals(colval[1], 4);
+
+  Test::removeFile(testFile);
+}
+
+
+static void transposeTest(
+    std::string const & testFile)
+{
+  std::vector<ind_t> const rowptr{0, 2, 3, 5};
+  std::vector<dim_t> const rowind{0, 2, 1, 0, 2};
+  std::vector<val_t> const rowval{1, 2, 3, 4, 5};
+  {
+    MatrixOutHandle handle(testFile);
+    handle.setInfo(3, 3, 5);
+    handle.writeSparse(rowptr.data(), rowind.data(), rowval.data());
+  }
+
+  // text files are read twice instead of copied
+  MemoryBudget::set(64);
+  csr_struct const csc = readMatrix(testFile, true);
+  MemoryBudget::set(0);
+
+  std::vector<ind_t> const colptr{0, 2, 3, 5};
+  std::vector<dim_t> const colind{0, 2, 1, 0, 2};
+  std::vector<val_t> const colval{1, 4, 3, 2, 5};
+  testEquals(csc.rowptr.size(), colptr.size());
+  for (size_t i = 0; i < colptr.size(); ++i) {
+    testEquals(csc.rowptr[i], colptr[i]);
+  }
+  for (size_t j = 0; j < colind.size(); ++j) {
+    testEquals(csc.rowind[j], colind[j]);
+    testEquals(csc.rowval[j], colval[j]);
+  }
+
+  Test::removeFile(testFile);
+}
+
+
+void Test::run()
+{
+  matrixMarketTest("./MemoryBudget_test.mtx", false, false);
+  matrixMarketTest("./MemoryBudget_test.mtx", false, true);
+  matrixMarketTest("./MemoryBudget_test.mtx", true, false);
+  matrixMarketTest("./MemoryBudget_test.mtx", true, true);
+  snapTest("./MemoryBudget_test.snap");
+  failFastTest("./MemoryBudget_test.bcsr");
+  transposeTest("./MemoryBudget_test.csr");
+  transposeTest("./MemoryBudget_test.snap");
+}
+
+
+
+
+}
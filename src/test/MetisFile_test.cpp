@@ -102,6 +102,49 @@ static void readTest(
 }
 
 
+static void readPatternTest(
+    std::string const & testFile)
+{
+  {
+    std::ofstream fout(testFile, std::ofstream::trunc);
+    fout << "3 2 11 1" << std::endl;
+    fout << "4 2 7" << std::endl;
+    fout << "2 1 7 3 2.5" << std::endl;
+    fout << "1 2 2.5" << std::endl;
+  }
+
+  MetisFile graph(testFile);
+
+  wildriver_dim_t nvtxs;
+  wildriver_ind_t nedges;
+  int nvwgts;
+  bool ewgts;
+
+  graph.getInfo(nvtxs,nedges,nvwgts,ewgts);
+
+  testEquals(nvtxs,3);
+  testEquals(nedges,4);
+  testEquals(nvwgts,1);
+  testEquals(ewgts,true);
+
+  std::unique_ptr<wildriver_ind_t[]> xadj(new wildriver_ind_t[nvtxs+1]);
+  std::unique_ptr<wildriver_dim_t[]> adjncy(new wildriver_dim_t[nedges]);
+
+  // both vertex and edge weights are skipped
+  graph.read(xadj.get(),adjncy.get(),nullptr,nullptr,nullptr);
+
+  testEquals(xadj[0],0);
+  testEquals(xadj[1],1);
+  testEquals(xadj[2],3);
+  testEquals(xadj[3],4);
+
+  testEquals(adjncy[0],1);
+  testEquals(adjncy[1],0);
+  testEquals(adjncy[2],2);
+  testEquals(adjncy[3],1);
+}
+
+
 void Test::run()
 {
   std::string testFile("./metis_test.graph");
@@ -109,6 +152,10 @@ void Test::run()
   writeTest(testFile);
   readTest(testFile);
 
+  readPatternTest(testFile);
+
+  Test::removeFile(testFile);
+
 }
 
 
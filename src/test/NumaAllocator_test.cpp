@@ -0,0 +1,90 @@
+/**
+ * @file NumaAllocator_test.cpp
+ * @brief Test for allocating arrays with page placement hints.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-16
+ */
+
+
+
+
+#include <cstdint>
+#include <cstdlib>
+
+#include "NumaAllocator.hpp"
+#include "DomTest.hpp"
+
+
+
+
+using namespace WildRiver;
+
+
+
+
+namespace DomTest
+{
+
+
+static void allocateTest(
+    int const flags,
+    int const numThreads)
+{
+  // large enough to be touched by several threads
+  size_t const num = 3*1024*1024 + 17;
+
+  uint32_t * const data = static_cast<uint32_t*>( \
+      NumaAllocator::allocate(num*sizeof(uint32_t), flags, numThreads));
+  testTrue(data != nullptr);
+
+  if (flags & WILDRIVER_ALLOC_HUGE_PAGES) {
+    testEquals(reinterpret_cast<uintptr_t>(data) % (2*1024*1024), 0);
+  }
+
+  if (flags & WILDRIVER_ALLOC_FIRST_TOUCH) {
+    // the whole array, including the partial last page, is zeroed
+    for (size_t i = 0; i < num; ++i) {
+      testEquals(data[i], 0);
+    }
+  }
+
+  for (size_t i = 0; i < num; ++i) {
+    data[i] = static_cast<uint32_t>(i);
+  }
+  for (size_t i = 0; i < num; ++i) {
+    testEquals(data[i], i);
+  }
+
+  free(data);
+}
+
+
+void Test::run()
+{
+  testGreaterThan(NumaAllocator::getNumNodes(), 0);
+
+  allocateTest(WILDRIVER_ALLOC_DEFAULT, 0);
+  allocateTest(WILDRIVER_ALLOC_FIRST_TOUCH, 1);
+  allocateTest(WILDRIVER_ALLOC_FIRST_TOUCH, 5);
+  allocateTest(WILDRIVER_ALLOC_HUGE_PAGES, 0);
+  allocateTest(WILDRIVER_ALLOC_INTERLEAVE, 0);
+  allocateTest(WILDRIVER_ALLOC_FIRST_TOUCH | WILDRIVER_ALLOC_HUGE_PAGES | \
+      WILDRIVER_ALLOC_INTERLEAVE, 0);
+
+  // an array smaller than a huge page is only page aligned, but usable
+  char * const small = static_cast<char*>(NumaAllocator::allocate(100, \
+      WILDRIVER_ALLOC_HUGE_PAGES, 0));
+  testTrue(small != nullptr);
+  small[99] = 1;
+  free(small);
+
+  // an empty array may still be freed
+  free(NumaAllocator::allocate(0, WILDRIVER_ALLOC_FIRST_TOUCH, 0));
+}
+
+
+
+
+}
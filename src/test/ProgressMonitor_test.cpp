@@ -0,0 +1,213 @@
+/**
+ * @file ProgressMonitor_test.cpp
+ * @brief Test for reporting the progress of loads.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-23
+ */
+
+
+
+
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#include "ProgressMonitor.hpp"
+#include "GraphInHandle.hpp"
+#include "MatrixInHandle.hpp"
+#include "MatrixOutHandle.hpp"
+#include "DomTest.hpp"
+
+
+
+
+using namespace WildRiver;
+
+
+
+
+namespace DomTest
+{
+
+
+static void writeMatrix(
+    std::string const & testFile)
+{
+  dim_t const nrows = 500;
+  std::vector<ind_t> rowptr(nrows+1, 0);
+  std::vector<dim_t> rowind;
+  std::vector<val_t> rowval;
+  for (dim_t i = 0; i < nrows; ++i) {
+    rowind.emplace_back((i+1) % nrows);
+    rowval.emplace_back(1.0);
+    rowind.emplace_back((i+nrows-1) % nrows);
+    rowval.emplace_back(1.0);
+    rowptr[i+1] = rowind.size();
+  }
+
+  MatrixOutHandle handle(testFile);
+  handle.setInfo(nrows, nrows, rowind.size());
+  handle.writeSparse(rowptr.data(), rowind.data(), rowval.data());
+}
+
+
+static void loadMatrix(
+    std::string const & testFile,
+    ProgressMonitor * const monitor)
+{
+  ProgressMonitor::Scope scope(monitor);
+
+  MatrixInHandle handle(testFile);
+  dim_t nrows, ncols;
+  ind_t nnz;
+  handle.getInfo(nrows, ncols, nnz);
+
+  std::vector<ind_t> rowptr(nrows+1);
+  std::vector<dim_t> rowind(nnz);
+  std::vector<val_t> rowval(nnz);
+  handle.readSparse(rowptr.data(), rowind.data(), rowval.data());
+}
+
+
+static void matrixTest(
+    std::string const & testFile,
+    bool const build)
+{
+  writeMatrix(testFile);
+
+  // record the phases after opening the file
+  std::vector<int> phases;
+  ProgressMonitor monitor([&phases](wildriver_progress const & progress) {
+    if (progress.phase != WILDRIVER_PHASE_OPEN && \
+        (phases.empty() || phases.back() != progress.phase)) {
+      phases.emplace_back(progress.phase);
+    }
+  });
+
+  loadMatrix(testFile, &monitor);
+
+  wildriver_progress const progress = monitor.getProgress();
+  testEquals(progress.rows, 500);
+  testEquals(progress.entries, 1000);
+  testEquals(progress.bytes, progress.total_bytes);
+  testTrue(progress.total_bytes > 0);
+  testTrue(progress.seconds >= 0);
+
+  testEquals(phases.size(), static_cast<size_t>(build ? 2 : 1));
+  testEquals(phases[0], WILDRIVER_PHASE_READ);
+  if (build) {
+    testEquals(phases[1], WILDRIVER_PHASE_BUILD);
+  }
+
+  Test::removeFile(testFile);
+}
+
+
+static void sharedTest(
+    std::string const & testFile)
+{
+  writeMatrix(testFile);
+
+  ProgressMonitor monitor;
+
+  // several threads report to the same monitor
+  int const numThreads = 4;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < numThreads; ++t) {
+    threads.emplace_back(loadMatrix, testFile, &monitor);
+  }
+  for (std::thread & thread : threads) {
+    thread.join();
+  }
+
+  wildriver_progress const progress = monitor.getProgress();
+  testEquals(progress.rows, 500*numThreads);
+  testEquals(progress.entries, 1000*numThreads);
+  testEquals(progress.bytes, progress.total_bytes);
+
+  // loads without a monitor are not counted
+  loadMatrix(testFile, nullptr);
+  testEquals(monitor.getProgress().rows, 500*numThreads);
+
+  Test::removeFile(testFile);
+}
+
+
+static void graphTest(
+    std::string const & testFile)
+{
+  writeMatrix(testFile);
+
+  ProgressMonitor monitor;
+  {
+    ProgressMonitor::Scope scope(&monitor);
+
+    GraphInHandle handle(testFile);
+    dim_t nvtxs;
+    ind_t nedges;
+    int nvwgts;
+    bool ewgts;
+    handle.getInfo(nvtxs, nedges, nvwgts, ewgts);
+
+    std::vector<ind_t> xadj(nvtxs+1);
+    std::vector<dim_t> adjncy(nedges);
+    handle.readGraph(xadj.data(), adjncy.data(), nullptr, nullptr);
+  }
+
+  wildriver_progress const progress = monitor.getProgress();
+  testEquals(progress.rows, 500);
+  testTrue(progress.entries > 0);
+  testEquals(progress.bytes, progress.total_bytes);
+
+  Test::removeFile(testFile);
+}
+
+
+static void phaseTest()
+{
+  // a change of phase made while another thread is reporting
+  std::vector<int> phases;
+  ProgressMonitor * changer = nullptr;
+  ProgressMonitor monitor([&phases, &changer](wildriver_progress const & \
+      progress) {
+    phases.emplace_back(progress.phase);
+    if (changer != nullptr) {
+      ProgressMonitor * const target = changer;
+      changer = nullptr;
+      std::thread thread([target]() {
+        target->setPhase(WILDRIVER_PHASE_BUILD);
+      });
+      thread.join();
+    }
+  });
+  changer = &monitor;
+
+  monitor.setPhase(WILDRIVER_PHASE_READ);
+
+  // is still delivered, once the report in progress finishes
+  testEquals(phases.size(), 2);
+  testEquals(phases[0], WILDRIVER_PHASE_READ);
+  testEquals(phases[1], WILDRIVER_PHASE_BUILD);
+}
+
+
+void Test::run()
+{
+  matrixTest("./progress_test.csr", false);
+  matrixTest("./progress_test.graph", false);
+  matrixTest("./progress_test.bcsr", false);
+  matrixTest("./progress_test.mtx", true);
+
+  sharedTest("./progress_test.csr");
+
+  graphTest("./progress_test.snap");
+
+  phaseTest();
+}
+
+
+
+
+}
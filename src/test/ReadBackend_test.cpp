@@ -0,0 +1,183 @@
+/**
+ * @file ReadBackend_test.cpp
+ * @brief Test for reading files with each of the read backends.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-27
+ */
+
+
+
+
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include "AsyncReadBuffer.hpp"
+#include "ConversionPipeline.hpp"
+#include "MappedBuffer.hpp"
+#include "MatrixInHandle.hpp"
+#include "ReadBackend.hpp"
+#include "DomTest.hpp"
+#include "TestMatrix.hpp"
+
+
+
+
+using namespace WildRiver;
+
+
+
+
+namespace DomTest
+{
+
+
+static std::string readAll(
+    std::streambuf * const buffer)
+{
+  return std::string(std::istreambuf_iterator<char>(buffer), \
+      std::istreambuf_iterator<char>());
+}
+
+
+static void seekTest(
+    std::streambuf * const buffer,
+    std::string const & text)
+{
+  std::istream stream(buffer);
+
+  size_t const length = 1000;
+  std::string data(length, '\0');
+  // within the first buffer, backward, far forward, and across buffers
+  for (size_t const offset : {static_cast<size_t>(10), \
+      static_cast<size_t>(0), text.size()-length, text.size()/3, \
+      AsyncReadBuffer::BUFFER_SIZE - length/2, text.size()/2, \
+      text.size()/2 + 3*length}) {
+    stream.seekg(static_cast<std::streamoff>(offset));
+    testEquals(static_cast<size_t>(stream.tellg()), offset);
+    stream.read(&data[0], length);
+    testEquals(static_cast<size_t>(stream.gcount()), length);
+    testTrue(data == text.substr(offset, length));
+    testEquals(static_cast<size_t>(stream.tellg()), offset+length);
+  }
+
+  // to the end
+  stream.seekg(0, std::ios_base::end);
+  testEquals(static_cast<size_t>(stream.tellg()), text.size());
+  testTrue(stream.get() == std::istream::traits_type::eof());
+}
+
+
+static void bufferTest(
+    std::string const & testFile,
+    std::string const & emptyFile,
+    std::string const & text)
+{
+  // io_uring where it is permitted, and pread
+  for (bool const ring : {true, false}) {
+    AsyncReadBuffer buffer(testFile, ring);
+    if (!ring) {
+      testTrue(!buffer.usesRing());
+    }
+    testTrue(readAll(&buffer) == text);
+
+    AsyncReadBuffer seekBuffer(testFile, ring);
+    seekTest(&seekBuffer, text);
+
+    AsyncReadBuffer emptyBuffer(emptyFile, ring);
+    testTrue(readAll(&emptyBuffer).empty());
+  }
+
+  MappedBuffer buffer(testFile);
+  testTrue(readAll(&buffer) == text);
+
+  MappedBuffer seekBuffer(testFile);
+  seekTest(&seekBuffer, text);
+
+  MappedBuffer emptyBuffer(emptyFile);
+  testTrue(readAll(&emptyBuffer).empty());
+
+  // a reader stopping early leaves reads in flight
+  {
+    AsyncReadBuffer partial(testFile);
+    std::istream stream(&partial);
+    std::string line;
+    std::getline(stream, line);
+    testTrue(line == text.substr(0, line.size()));
+  }
+}
+
+
+static void backendTest(
+    std::string const & testFile,
+    std::string const & outFile,
+    std::string const & plainOutFile)
+{
+  int const backend = ReadBackend::get();
+
+  ReadBackend::set(READ_BACKEND_BUFFERED);
+  csr_struct const plain = readMatrix(testFile);
+  {
+    ConversionPipeline pipeline(testFile, plainOutFile);
+    pipeline.run();
+  }
+  std::ifstream plainStream(plainOutFile, std::ifstream::binary);
+  std::string const plainOut = readAll(plainStream.rdbuf());
+
+  for (int const other : {READ_BACKEND_MMAP, READ_BACKEND_ASYNC}) {
+    ReadBackend::set(other);
+    testEquals(ReadBackend::get(), other);
+    testTrue(ReadBackend::isSupported(other));
+
+    compare(plain, readMatrix(testFile));
+
+    // the conversion pipeline reads through the backend too
+    ConversionPipeline pipeline(testFile, outFile);
+    pipeline.setNumThreads(3);
+    pipeline.run();
+    std::ifstream stream(outFile, std::ifstream::binary);
+    testTrue(readAll(stream.rdbuf()) == plainOut);
+  }
+
+  ReadBackend::set(backend);
+
+  Test::removeFile(outFile);
+  Test::removeFile(plainOutFile);
+}
+
+
+void Test::run()
+{
+  std::string const testFile = "./ReadBackend_test.csr";
+  std::string const emptyFile = "./ReadBackend_test_empty.csr";
+
+  // spanning several buffers of AsyncReadBuffer
+  std::string const text = makeText(20000, 40, 5000, 0);
+  {
+    std::ofstream stream(testFile, std::ofstream::binary);
+    stream << text;
+  }
+  {
+    std::ofstream stream(emptyFile, std::ofstream::binary);
+  }
+  testGreaterThan(text.size(), 2*AsyncReadBuffer::BUFFER_SIZE);
+
+  testEquals(std::string(ReadBackend::getName(READ_BACKEND_ASYNC)), \
+      std::string("async"));
+
+  bufferTest(testFile, emptyFile, text);
+  backendTest(testFile, "./ReadBackend_test.mtx", \
+      "./ReadBackend_test_plain.mtx");
+
+  Test::removeFile(testFile);
+  Test::removeFile(emptyFile);
+}
+
+
+
+
+}
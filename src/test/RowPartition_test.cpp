@@ -0,0 +1,138 @@
+/**
+ * @file RowPartition_test.cpp
+ * @brief Test for splitting rows into balanced parts.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-19
+ */
+
+
+
+
+#include <vector>
+
+#include "RowPartition.hpp"
+#include "Exception.hpp"
+#include "DomTest.hpp"
+
+
+
+
+using namespace WildRiver;
+
+
+
+
+namespace DomTest
+{
+
+
+static void skewedTest()
+{
+  // a single heavy row followed by many light ones, as in a power-law graph
+  std::vector<wildriver_ind_t> counts(1000, 1);
+  counts[0] = 2000;
+
+  std::vector<wildriver_dim_t> const starts = RowPartition::balance(counts, \
+      4);
+
+  testEquals(starts.size(), 5);
+  testEquals(starts[0], 0);
+  testEquals(starts[4], 1000);
+
+  // the heavy row alone outweighs a part
+  testEquals(starts[1], 1);
+  testEquals(starts[2], 1);
+
+  for (size_t p = 0; p < 4; ++p) {
+    testTrue(starts[p] <= starts[p+1]);
+  }
+}
+
+
+static void evenTest()
+{
+  std::vector<wildriver_ind_t> counts(12, 3);
+
+  std::vector<wildriver_dim_t> const starts = RowPartition::balance(counts, \
+      3);
+
+  testEquals(starts[0], 0);
+  testEquals(starts[1], 4);
+  testEquals(starts[2], 8);
+  testEquals(starts[3], 12);
+
+  // more parts than rows
+  std::vector<wildriver_dim_t> const many = RowPartition::balance(counts, \
+      20);
+  testEquals(many.size(), 21);
+  testEquals(many[20], 12);
+  for (size_t p = 0; p < 20; ++p) {
+    testTrue(many[p] <= many[p+1]);
+  }
+
+  bool caught = false;
+  try {
+    RowPartition::balance(counts, 0);
+  } catch (BadParameterException const &) {
+    caught = true;
+  }
+  testTrue(caught);
+}
+
+
+static void blocksTest()
+{
+  std::vector<wildriver_ind_t> counts(1000);
+  for (size_t i = 0; i < counts.size(); ++i) {
+    counts[i] = (i*i) % 17;
+  }
+  counts[500] = 3000;
+
+  // blocks of uneven sizes, including an empty one
+  std::vector<wildriver_dim_t> const blockStarts{0, 100, 250, 250, 600, 999, \
+      1000};
+  std::vector<wildriver_ind_t> blockCounts(blockStarts.size()-1, 0);
+  for (size_t b = 0; b+1 < blockStarts.size(); ++b) {
+    for (wildriver_dim_t i = blockStarts[b]; i < blockStarts[b+1]; ++i) {
+      blockCounts[b] += counts[i];
+    }
+  }
+
+  for (int const numParts : {1, 2, 5, 9, 40, 2000}) {
+    std::vector<int> reads(blockCounts.size(), 0);
+    std::vector<wildriver_dim_t> const starts = RowPartition::balanceBlocks( \
+        blockStarts, blockCounts, numParts, [&](size_t const block, \
+        std::vector<wildriver_ind_t> & rows) {
+      ++reads[block];
+      rows.assign(counts.begin()+blockStarts[block], \
+          counts.begin()+blockStarts[block+1]);
+    });
+
+    std::vector<wildriver_dim_t> const expected = \
+        RowPartition::balance(counts, numParts);
+    testEquals(starts.size(), expected.size());
+    for (size_t p = 0; p < starts.size(); ++p) {
+      testEquals(starts[p], expected[p]);
+    }
+
+    // only the blocks holding a boundary are read, and each only once
+    for (int const count : reads) {
+      testTrue(count <= 1);
+    }
+  }
+}
+
+
+void Test::run()
+{
+  skewedTest();
+  evenTest();
+  blocksTest();
+}
+
+
+
+
+}
@@ -0,0 +1,163 @@
+/**
+ * @file RowStream_test.cpp
+ * @brief Test for reading matrices a batch of rows at a time.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-20
+ */
+
+
+
+
+#include <fstream>
+#include <vector>
+
+#include "RowStream.hpp"
+#include "Exception.hpp"
+#include "DomTest.hpp"
+
+
+
+
+using namespace WildRiver;
+
+
+
+
+namespace DomTest
+{
+
+
+static void writeSparse(
+    std::string const & testFile)
+{
+  std::fstream stream(testFile,std::fstream::out | std::fstream::trunc);
+
+  stream << "1 1 2 2" << std::endl;
+  stream << "0 3 2 4" << std::endl;
+  stream << "0 5 1 6 3 7" << std::endl;
+  stream << "2 8 4 9 5 1" << std::endl;
+  stream << "3 2 5 3" << std::endl;
+  stream << "3 4 4 5" << std::endl;
+}
+
+
+static void writeMetis(
+    std::string const & testFile)
+{
+  std::fstream stream(testFile,std::fstream::out | std::fstream::trunc);
+
+  stream << "6 7 11 1" << std::endl;
+  stream << "% a comment" << std::endl;
+
+  stream << "4 2 1 3 2" << std::endl;
+  stream << "4 1 3 3 4" << std::endl;
+  stream << "4 1 5 2 6 4 7" << std::endl;
+  stream << "4 3 8 5 9 6 1" << std::endl;
+  stream << "4 4 2 6 3" << std::endl;
+  stream << "4 4 4 5 5" << std::endl;
+}
+
+
+static void streamTest(
+    std::string const & testFile)
+{
+  RowStream stream(testFile);
+
+  wildriver_dim_t nrows, ncols;
+  wildriver_ind_t nnz;
+  stream.getInfo(nrows,ncols,nnz);
+
+  testEquals(nrows,6);
+  testEquals(ncols,6);
+  testEquals(nnz,14);
+
+  // batches of at most four rows and five non-zeros
+  wildriver_ind_t rowptr[5];
+  wildriver_dim_t rowind[5];
+  wildriver_val_t rowval[5];
+
+  wildriver_dim_t const expBatch[] = {2,1,2,1};
+  wildriver_dim_t const expRowind[] = {1,2,0,2,0,1,3,2,4,5,3,5,3,4};
+  wildriver_val_t const expRowval[] = {1,2,3,4,5,6,7,8,9,1,2,3,4,5};
+
+  size_t j = 0;
+  for (wildriver_dim_t const exp : expBatch) {
+    wildriver_dim_t const first = stream.getNextRowIndex();
+    wildriver_dim_t const num = stream.nextRows(4,5,rowptr,rowind,rowval);
+    testEquals(num,exp);
+    testEquals(stream.getNextRowIndex(),first+num);
+    for (wildriver_ind_t k = 0; k < rowptr[num]; ++k, ++j) {
+      testEquals(rowind[k],expRowind[j]);
+      testEquals(rowval[k],expRowval[j]);
+    }
+  }
+  testEquals(j,14);
+
+  // at the end
+  testEquals(stream.nextRows(4,5,rowptr,rowind,rowval),0);
+}
+
+
+static void tooSmallTest(
+    std::string const & testFile)
+{
+  RowStream stream(testFile);
+
+  wildriver_ind_t rowptr[3];
+  wildriver_dim_t rowind[3];
+
+  testEquals(stream.nextRows(2,3,rowptr,rowind,nullptr),1);
+
+  // the third row has three non-zeros
+  testEquals(stream.nextRows(2,3,rowptr,rowind,nullptr),1);
+
+  bool caught = false;
+  try {
+    stream.nextRows(2,2,rowptr,rowind,nullptr);
+  } catch (BadParameterException const &) {
+    caught = true;
+  }
+  testTrue(caught);
+
+  // the row is kept for a retry
+  testEquals(stream.nextRows(2,3,rowptr,rowind,nullptr),1);
+  testEquals(rowptr[1],3);
+  testEquals(rowind[2],3);
+}
+
+
+static void unsupportedTest()
+{
+  bool caught = false;
+  try {
+    RowStream stream("./RowStream_test.mtx");
+  } catch (UnknownExtensionException const &) {
+    caught = true;
+  }
+  testTrue(caught);
+  testTrue(!RowStream::isSupported("./RowStream_test.mtx"));
+}
+
+
+void Test::run()
+{
+  std::string const csrFile("./RowStream_test.csr");
+  writeSparse(csrFile);
+  streamTest(csrFile);
+  tooSmallTest(csrFile);
+  Test::removeFile(csrFile);
+
+  std::string const metisFile("./RowStream_test.graph");
+  writeMetis(metisFile);
+  streamTest(metisFile);
+  Test::removeFile(metisFile);
+
+  unsupportedTest();
+}
+
+
+
+
+}
@@ -0,0 +1,168 @@
+/**
+ * @file TestMatrix.hpp
+ * @brief Helpers for reading, comparing, and generating matrices in tests.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-27
+ */
+
+
+
+
+#ifndef WILDRIVER_TESTMATRIX_HPP
+#define WILDRIVER_TESTMATRIX_HPP
+
+
+
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "MatrixInHandle.hpp"
+#include "DomTest.hpp"
+
+
+
+
+namespace DomTest
+{
+
+
+/**
+ * @brief A matrix read into memory.
+ */
+struct csr_struct
+{
+  csr_struct() :
+    rowptr(),
+    rowind(),
+    rowval(),
+    temporaryBytes(0)
+  {
+    // do nothing
+  }
+
+  std::vector<ind_t> rowptr;
+  std::vector<dim_t> rowind;
+  std::vector<val_t> rowval;
+  size_t temporaryBytes;
+};
+
+
+/**
+ * @brief Read a matrix from a file.
+ *
+ * @param testFile The file.
+ * @param transpose Whether to read the transpose of the matrix.
+ *
+ * @return The matrix.
+ */
+static inline csr_struct readMatrix(
+    std::string const & testFile,
+    bool const transpose = false)
+{
+  using namespace WildRiver;
+
+  csr_struct csr;
+
+  MatrixInHandle handle(testFile);
+  dim_t nrows, ncols;
+  ind_t nnz;
+  handle.getInfo(nrows, ncols, nnz);
+  csr.temporaryBytes = handle.getTemporaryBytes();
+
+  csr.rowptr.resize((transpose ? ncols : nrows)+1);
+  csr.rowind.resize(nnz);
+  csr.rowval.resize(nnz);
+  if (transpose) {
+    handle.readSparseTransposed(csr.rowptr.data(), csr.rowind.data(), \
+        csr.rowval.data());
+  } else {
+    handle.readSparse(csr.rowptr.data(), csr.rowind.data(), \
+        csr.rowval.data());
+  }
+
+  // symmetric files may have fewer entries than reported
+  csr.rowind.resize(csr.rowptr.back());
+  csr.rowval.resize(csr.rowptr.back());
+
+  return csr;
+}
+
+
+/**
+ * @brief Check that two matrices are the same.
+ *
+ * @param a The first matrix.
+ * @param b The second matrix.
+ */
+static inline void compare(
+    csr_struct const & a,
+    csr_struct const & b)
+{
+  testEquals(a.rowptr.size(), b.rowptr.size());
+  for (size_t i = 0; i < a.rowptr.size(); ++i) {
+    testEquals(a.rowptr[i], b.rowptr[i]);
+  }
+  testEquals(a.rowind.size(), b.rowind.size());
+  for (size_t j = 0; j < a.rowind.size(); ++j) {
+    testEquals(a.rowind[j], b.rowind[j]);
+    testEquals(a.rowval[j], b.rowval[j]);
+  }
+}
+
+
+/**
+ * @brief Build the text of a pseudo-random CSR file, with an empty fourth
+ * row and no newline at the end.
+ *
+ * @param numRows The number of rows.
+ * @param maxLength The maximum length of a row (exclusive).
+ * @param numCols The number of columns.
+ * @param longLength The length of the eighth row, or 0 for it to be as
+ * random as the others.
+ *
+ * @return The text.
+ */
+static inline std::string makeText(
+    size_t const numRows,
+    size_t const maxLength,
+    size_t const numCols,
+    size_t const longLength)
+{
+  std::ostringstream text;
+  uint64_t state = 1;
+  for (size_t i = 0; i < numRows; ++i) {
+    size_t length = 0;
+    if (i == 7 && longLength > 0) {
+      length = longLength;
+    } else if (i != 3) {
+      state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+      length = (state >> 33) % maxLength;
+    }
+    for (size_t j = 0; j < length; ++j) {
+      state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+      if (j > 0) {
+        text << " ";
+      }
+      text << ((state >> 33) % numCols) << " " << ((state >> 40) % 100) << \
+          ".5";
+    }
+    if (i+1 < numRows) {
+      text << "\n";
+    }
+  }
+
+  return text.str();
+}
+
+
+}
+
+
+
+
+#endif
@@ -0,0 +1,343 @@
+/**
+ * @file ThreadPool_test.cpp
+ * @brief Test for the library's work-stealing thread pool.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-25
+ */
+
+
+
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "CancelToken.hpp"
+#include "IOStats.hpp"
+#include "ThreadPool.hpp"
+#include "DomTest.hpp"
+
+
+
+
+using namespace WildRiver;
+
+
+
+
+namespace DomTest
+{
+
+
+static void parallelForTest(
+    ThreadPool & pool)
+{
+  std::vector<int> visits(100000, 0);
+  pool.parallelFor(0, visits.size(), 1000, [&visits](size_t const begin, \
+      size_t const end) {
+    for (size_t i = begin; i < end; ++i) {
+      ++visits[i];
+    }
+  });
+  for (int const count : visits) {
+    testEquals(count, 1);
+  }
+
+  // empty and single chunk ranges
+  std::atomic<size_t> calls(0);
+  pool.parallelFor(5, 5, 1, [&calls](size_t, size_t) {
+    ++calls;
+  });
+  testEquals(calls.load(), 0);
+  pool.parallelFor(5, 10, 100, [&calls](size_t const begin, \
+      size_t const end) {
+    calls += end - begin;
+  });
+  testEquals(calls.load(), 5);
+
+  // nested loops do not deadlock
+  std::atomic<size_t> total(0);
+  pool.parallelFor(0, 64, 1, [&pool, &total](size_t const begin, \
+      size_t const end) {
+    for (size_t i = begin; i < end; ++i) {
+      pool.parallelFor(0, 1000, 10, [&total](size_t const first, \
+          size_t const last) {
+        total += last - first;
+      });
+    }
+  });
+  testEquals(total.load(), 64000);
+
+  // the first exception is passed to the caller
+  bool thrown = false;
+  try {
+    pool.parallelFor(0, 1000, 1, [](size_t, size_t const end) {
+      if (end > 500) {
+        throw std::runtime_error("failed");
+      }
+    });
+  } catch (std::runtime_error const &) {
+    thrown = true;
+  }
+  testTrue(thrown);
+}
+
+
+static void prefixSumTest(
+    ThreadPool & pool)
+{
+  size_t const size = ThreadPool::MIN_SCAN_CHUNK*9 + 17;
+
+  std::vector<size_t> data(size);
+  for (size_t i = 0; i < size; ++i) {
+    data[i] = i % 7;
+  }
+  pool.prefixSum(data.data(), size);
+
+  size_t sum = 0;
+  bool match = true;
+  for (size_t i = 0; i < size; ++i) {
+    sum += i % 7;
+    match = match && data[i] == sum;
+  }
+  testTrue(match);
+
+  std::vector<int> small{3, 1, 4, 1, 5};
+  pool.prefixSum(small.data(), small.size());
+  testEquals(small[0], 3);
+  testEquals(small[4], 14);
+}
+
+
+static void concurrentTest(
+    ThreadPool & pool)
+{
+  // loops started from many application threads at once
+  std::vector<size_t> totals(8, 0);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < totals.size(); ++t) {
+    threads.emplace_back([&pool, &totals, t]() {
+      std::atomic<size_t> total(0);
+      for (int r = 0; r < 20; ++r) {
+        pool.parallelFor(0, 10000, 100, [&total](size_t const begin, \
+            size_t const end) {
+          total += end - begin;
+        });
+      }
+      totals[t] = total.load();
+    });
+  }
+  for (std::thread & thread : threads) {
+    thread.join();
+  }
+  for (size_t const total : totals) {
+    testEquals(total, 200000);
+  }
+}
+
+
+static void pipelineTest(
+    ThreadPool & pool)
+{
+  // each stage waits on the one before it, so all must run at once
+  size_t const numStages = 16;
+  std::mutex mutex;
+  std::condition_variable changed;
+  size_t next = 0;
+
+  std::vector<std::function<void()>> stages;
+  for (size_t s = 0; s < numStages; ++s) {
+    stages.emplace_back([&mutex, &changed, &next, s, numStages]() {
+      size_t const wanted = numStages - 1 - s;
+      std::unique_lock<std::mutex> lock(mutex);
+      changed.wait(lock, [&next, wanted]() {
+        return next == wanted;
+      });
+      ++next;
+      changed.notify_all();
+    });
+  }
+
+  for (int r = 0; r < 3; ++r) {
+    next = 0;
+    pool.runPipeline(stages);
+    testEquals(next, numStages);
+  }
+}
+
+
+static void pipelineLimitTest()
+{
+  ThreadPool pool(1);
+  size_t const numStages = static_cast<size_t>(pool.getMaxStages());
+
+  // pipelines run at once share the stage limit, so some must wait
+  std::mutex mutex;
+  size_t running = 0;
+  size_t most = 0;
+  std::vector<std::function<void()>> stages(numStages, [&mutex, &running, \
+      &most]() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      most = std::max(most, ++running);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    std::lock_guard<std::mutex> lock(mutex);
+    --running;
+  });
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 3; ++t) {
+    threads.emplace_back([&pool, &stages]() {
+      pool.runPipeline(stages);
+    });
+  }
+  for (std::thread & thread : threads) {
+    thread.join();
+  }
+  testEquals(most, numStages);
+}
+
+
+static void contextTest(
+    ThreadPool & pool)
+{
+  CancelToken token;
+  CancelToken::Scope scope(&token);
+  IOStats::Record record("test", nullptr);
+  IOStats * const stats = IOStats::getCurrent();
+
+  // the tasks of a group see the token and stats of the thread adding them
+  std::atomic<size_t> matched(0);
+  pool.parallelFor(0, 64, 1, [&matched, &token, stats](size_t const begin, \
+      size_t const end) {
+    if (CancelToken::getCurrent() == &token && \
+        IOStats::getCurrent() == stats) {
+      matched += end - begin;
+    }
+  });
+  testEquals(matched.load(), 64);
+
+  // tasks submitted on their own see none
+  std::mutex mutex;
+  std::condition_variable finished;
+  int state = 0;
+  pool.submit([&mutex, &finished, &state]() {
+    std::lock_guard<std::mutex> lock(mutex);
+    state = CancelToken::getCurrent() == nullptr && \
+        IOStats::getCurrent() == nullptr ? 1 : 2;
+    finished.notify_all();
+  });
+  std::unique_lock<std::mutex> lock(mutex);
+  finished.wait(lock, [&state]() {
+    return state != 0;
+  });
+  testEquals(state, 1);
+}
+
+
+static void groupTest()
+{
+  // a single worker, kept busy
+  ThreadPool pool(2);
+  std::mutex mutex;
+  std::condition_variable changed;
+  bool started = false;
+  bool released = false;
+  pool.submit([&mutex, &changed, &started, &released]() {
+    std::unique_lock<std::mutex> lock(mutex);
+    started = true;
+    changed.notify_all();
+    changed.wait(lock, [&released]() {
+      return released;
+    });
+  });
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&started]() {
+      return started;
+    });
+  }
+
+  std::atomic<bool> other(false);
+  pool.submit([&other]() {
+    other.store(true);
+  });
+
+  // waiting on a group runs its tasks, but not the other queued task
+  std::atomic<bool> own(false);
+  {
+    ThreadPool::TaskGroup group(pool);
+    group.run([&own]() {
+      own.store(true);
+    });
+    group.wait();
+  }
+  testTrue(own.load());
+  testTrue(!other.load());
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    released = true;
+  }
+  changed.notify_all();
+}
+
+
+static void resizeTest()
+{
+  ThreadPool pool(2);
+  testEquals(pool.getNumThreads(), 2);
+
+  pool.setNumThreads(6);
+  testEquals(pool.getNumThreads(), 6);
+  parallelForTest(pool);
+
+  pool.setNumThreads(1);
+  testEquals(pool.getNumThreads(), 1);
+  parallelForTest(pool);
+
+  // a pool of one thread still runs tasks in the background
+  std::atomic<bool> ran(false);
+  {
+    ThreadPool single(1);
+    single.submit([&ran]() {
+      ran.store(true);
+    });
+  }
+  testTrue(ran.load());
+
+  pool.setNumThreads(0);
+  testEquals(pool.getNumThreads(), ThreadPool::getDefaultNumThreads());
+}
+
+
+void Test::run()
+{
+  ThreadPool pool(4);
+
+  parallelForTest(pool);
+  prefixSumTest(pool);
+  concurrentTest(pool);
+  pipelineTest(pool);
+  contextTest(pool);
+
+  pipelineLimitTest();
+
+  groupTest();
+  resizeTest();
+
+  prefixSumTest(ThreadPool::getInstance());
+}
+
+
+
+
+}
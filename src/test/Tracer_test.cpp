@@ -0,0 +1,198 @@
+/**
+ * @file Tracer_test.cpp
+ * @brief Test for recording timelines of events.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-27
+ */
+
+
+
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "Tracer.hpp"
+#include "MatrixInHandle.hpp"
+#include "MatrixOutHandle.hpp"
+#include "ThreadPool.hpp"
+#include "DomTest.hpp"
+
+
+
+
+using namespace WildRiver;
+
+
+
+
+namespace DomTest
+{
+
+
+static std::string getTrace()
+{
+  std::ostringstream stream;
+  Tracer::write(stream);
+  return stream.str();
+}
+
+
+static size_t countMatches(
+    std::string const & trace,
+    std::string const & pattern)
+{
+  size_t count = 0;
+  for (size_t pos = trace.find(pattern); pos != std::string::npos; \
+      pos = trace.find(pattern, pos+1)) {
+    ++count;
+  }
+  return count;
+}
+
+
+static void disabledTest()
+{
+  testTrue(!Tracer::isEnabled());
+  {
+    Tracer::Span span("test", "ignored");
+  }
+  testEquals(countMatches(getTrace(), "\"ignored\""), 0);
+}
+
+
+static void poolTest()
+{
+  ThreadPool & pool = ThreadPool::getInstance();
+  int const numThreads = pool.getNumThreads();
+  pool.setNumThreads(4);
+
+  Tracer::setEnabled(true);
+  {
+    Tracer::Span outer("test", "outer");
+    pool.parallelFor(0, 64, 1, [](size_t const begin, size_t const end) {
+      for (size_t i = begin; i < end; ++i) {
+        Tracer::Span span("test", "item", static_cast<int64_t>(i));
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+      }
+    });
+  }
+  Tracer::setEnabled(false);
+  pool.setNumThreads(numThreads);
+
+  std::string const trace = getTrace();
+  testEquals(trace.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["), 0);
+  testEquals(trace.substr(trace.size()-4), "\n]}\n");
+  testEquals(countMatches(trace, "\"name\":\"outer\""), 1);
+  testEquals(countMatches(trace, "\"name\":\"item\""), 64);
+  testEquals(countMatches(trace, "\"args\":{\"id\":63}"), 1);
+  testTrue(countMatches(trace, "\"name\":\"task\"") > 0);
+  testTrue(countMatches(trace, "\"name\":\"worker ") > 0);
+
+  Tracer::clear();
+  testEquals(countMatches(getTrace(), "\"name\":\"item\""), 0);
+}
+
+
+static void droppedTest()
+{
+  Tracer::setEnabled(true);
+  std::thread thread([]() {
+    Tracer::setThreadName("filler");
+    for (size_t i = 0; i < Tracer::BUFFER_EVENTS+5; ++i) {
+      Tracer::Span span("test", "fill");
+    }
+  });
+  thread.join();
+  Tracer::setEnabled(false);
+
+  // the events of a thread are kept after it exits
+  std::string const trace = getTrace();
+  testEquals(countMatches(trace, "\"name\":\"fill\""), Tracer::BUFFER_EVENTS);
+  testEquals(countMatches(trace, "\"name\":\"dropped 5 events\""), 1);
+  testEquals(countMatches(trace, "\"name\":\"filler\""), 1);
+
+  Tracer::clear();
+}
+
+
+static void reuseTest()
+{
+  Tracer::setEnabled(true);
+  for (int i = 0; i < 8; ++i) {
+    std::thread thread([]() {
+      Tracer::setThreadName("reuser");
+      Tracer::Span span("test", "reuse");
+    });
+    thread.join();
+  }
+  Tracer::setEnabled(false);
+
+  // each thread takes over the buffer of the one before it
+  std::string const trace = getTrace();
+  testEquals(countMatches(trace, "\"name\":\"reuse\""), 8);
+  testEquals(countMatches(trace, "\"name\":\"reuser\""), 1);
+  testEquals(countMatches(trace, "\"name\":\"filler\""), 0);
+
+  Tracer::clear();
+}
+
+
+static void readTest(
+    std::string const & testFile,
+    std::string const & traceFile)
+{
+  {
+    std::ofstream stream(testFile);
+    stream << "%%MatrixMarket matrix coordinate real general\n";
+    stream << "2 2 3\n";
+    stream << "1 1 1.0\n";
+    stream << "2 1 2.0\n";
+    stream << "2 2 3.0\n";
+  }
+
+  Tracer::setEnabled(true);
+  {
+    MatrixInHandle handle(testFile);
+    dim_t nrows, ncols;
+    ind_t nnz;
+    handle.getInfo(nrows, ncols, nnz);
+
+    std::vector<ind_t> rowptr(nrows+1);
+    std::vector<dim_t> rowind(nnz);
+    std::vector<val_t> rowval(nnz);
+    handle.readSparse(rowptr.data(), rowind.data(), rowval.data());
+  }
+  Tracer::setEnabled(false);
+
+  Tracer::dump(traceFile);
+
+  std::ifstream stream(traceFile);
+  std::stringstream contents;
+  contents << stream.rdbuf();
+  std::string const trace = contents.str();
+  testEquals(countMatches(trace, "\"name\":\"read matrix\""), 1);
+  testEquals(countMatches(trace, "\"name\":\"parse\""), 1);
+  testEquals(countMatches(trace, "\"name\":\"build\""), 1);
+
+  Test::removeFile(testFile);
+  Test::removeFile(traceFile);
+}
+
+
+void Test::run()
+{
+  disabledTest();
+  poolTest();
+  droppedTest();
+  reuseTest();
+  readTest("./Tracer_test.mtx", "./Tracer_test.json");
+}
+
+
+
+
+}
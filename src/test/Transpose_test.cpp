@@ -0,0 +1,118 @@
+/**
+ * @file Transpose_test.cpp
+ * @brief Test for transposing sparse matrices.
+ * @author Dominique LaSalle <dominique@solidlake.com>
+ * Copyright 2018
+ * @version 1
+ * @date 2018-05-11
+ */
+
+
+
+
+#include <vector>
+
+#include "Transpose.hpp"
+#include "DomTest.hpp"
+
+
+
+
+using namespace WildRiver;
+
+
+
+
+namespace DomTest
+{
+
+
+static void transposeTest(
+    int const numThreads)
+{
+  // large enough to be split among several threads
+  dim_t const nrows = 20000;
+  dim_t const ncols = 3000;
+
+  std::vector<ind_t> rowptr(nrows+1, 0);
+  std::vector<dim_t> rowind;
+  std::vector<val_t> rowval;
+  for (dim_t r = 0; r < nrows; ++r) {
+    // skewed rows, with some empty
+    dim_t const degree = (r % 7) * (r % 13);
+    for (dim_t k = 0; k < degree; ++k) {
+      rowind.emplace_back((r*31 + k*97) % ncols);
+      rowval.emplace_back(static_cast<val_t>(r) + k/1000.0);
+    }
+    rowptr[r+1] = rowind.size();
+  }
+  ind_t const nnz = rowind.size();
+
+  std::vector<ind_t> colptr(ncols+1);
+  std::vector<dim_t> colind(nnz);
+  std::vector<val_t> colval(nnz);
+
+  Transpose::csrToCsc(nrows, ncols, rowptr.data(), rowind.data(), \
+      rowval.data(), colptr.data(), colind.data(), colval.data(), numThreads);
+
+  // compare against a serial counting transpose
+  std::vector<ind_t> expPtr(ncols+1, 0);
+  for (ind_t j = 0; j < nnz; ++j) {
+    ++expPtr[rowind[j]+1];
+  }
+  for (dim_t c = 0; c < ncols; ++c) {
+    expPtr[c+1] += expPtr[c];
+  }
+  std::vector<ind_t> offset(expPtr.begin(), expPtr.end()-1);
+  std::vector<dim_t> expInd(nnz);
+  std::vector<val_t> expVal(nnz);
+  for (dim_t r = 0; r < nrows; ++r) {
+    for (ind_t j = rowptr[r]; j < rowptr[r+1]; ++j) {
+      ind_t const dest = offset[rowind[j]]++;
+      expInd[dest] = r;
+      expVal[dest] = rowval[j];
+    }
+  }
+
+  for (dim_t c = 0; c <= ncols; ++c) {
+    testEquals(colptr[c], expPtr[c]);
+  }
+  for (ind_t j = 0; j < nnz; ++j) {
+    testEquals(colind[j], expInd[j]);
+    testEquals(colval[j], expVal[j]);
+  }
+}
+
+
+static void patternTest()
+{
+  std::vector<ind_t> const rowptr{0, 2, 3};
+  std::vector<dim_t> const rowind{0, 2, 1};
+
+  std::vector<ind_t> colptr(4);
+  std::vector<dim_t> colind(3);
+
+  Transpose::csrToCsc(2, 3, rowptr.data(), rowind.data(), nullptr, \
+      colptr.data(), colind.data(), nullptr, 2);
+
+  testEquals(colptr[0], 0);
+  testEquals(colptr[1], 1);
+  testEquals(colptr[2], 2);
+  testEquals(colptr[3], 3);
+  testEquals(colind[0], 0);
+  testEquals(colind[1], 1);
+  testEquals(colind[2], 0);
+}
+
+
+void Test::run()
+{
+  transposeTest(1);
+  transposeTest(4);
+  patternTest();
+}
+
+
+
+
+}
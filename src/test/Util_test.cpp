@@ -53,9 +53,32 @@ static void splitTest()
 
 
 
+static void skipFieldTest()
+{
+  std::string line = " 12\t3.5e-1  7";
+  char * const start = &line[0];
+
+  char * ptr = Util::skipField(start);
+  testEquals(ptr - start, 3);
+
+  ptr = Util::skipField(ptr);
+  testEquals(ptr - start, 10);
+
+  ptr = Util::skipField(ptr);
+  testEquals(ptr - start, 13);
+
+  // nothing left
+  testTrue(Util::skipField(ptr) == ptr);
+
+  std::string empty = "  \t";
+  testTrue(Util::skipField(&empty[0]) == &empty[0]);
+}
+
+
 void Test::run()
 {
   splitTest();
+  skipFieldTest();
 }
 
 
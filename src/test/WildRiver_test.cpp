@@ -11,6 +11,7 @@
 
 
 #include <iostream>
+#include <cstdint>
 #include <fstream>
 #include <vector>
 
@@ -123,6 +124,67 @@ static void readMatrix(
   testEquals(rowval[13],5);
 }
 
+static void writeMatrixTyped(
+    std::string const & testFile)
+{
+  uint32_t rowptr[] = {0,2,4,7,10,12,14};
+  uint32_t rowind[] = {1,2,0,2,0,1,3,2,4,5,3,5,3,4};
+  int32_t rowval[] = {1,2,3,4,5,6,7,8,9,1,2,3,4,5};
+
+  wildriver_matrix_handle * handle = \
+      wildriver_open_matrix(testFile.data(),WILDRIVER_OUT);
+
+  testTrue(handle != nullptr);
+
+  handle->nrows = 6;
+  handle->ncols = 6;
+  handle->nnz = 14;
+
+  int rv = wildriver_save_matrix_typed(handle,WILDRIVER_TYPE_U32, \
+      WILDRIVER_TYPE_U32,WILDRIVER_TYPE_I32,rowptr,rowind,rowval,nullptr);
+
+  testEquals(rv,1);
+
+  wildriver_close_matrix(handle);
+}
+
+
+static void readMatrixTyped(
+    std::string const & testFile)
+{
+  wildriver_matrix_handle * handle = \
+      wildriver_open_matrix(testFile.data(),WILDRIVER_IN);
+
+  testTrue(handle != nullptr);
+
+  testEquals(wildriver_type_size(WILDRIVER_TYPE_U32),4);
+  testEquals(wildriver_type_size(WILDRIVER_TYPE_F64),8);
+
+  std::vector<uint32_t> rowptr(handle->nrows+1);
+  std::vector<uint32_t> rowind(handle->nnz);
+  std::vector<float> rowval(handle->nnz);
+
+  // an unknown type should fail
+  int rv = wildriver_load_matrix_typed(handle,WILDRIVER_TYPE_F32, \
+      WILDRIVER_TYPE_U32,WILDRIVER_TYPE_F32,rowptr.data(),rowind.data(), \
+      rowval.data(),nullptr);
+  testEquals(rv,0);
+
+  rv = wildriver_load_matrix_typed(handle,WILDRIVER_TYPE_U32, \
+      WILDRIVER_TYPE_U32,WILDRIVER_TYPE_F32,rowptr.data(),rowind.data(), \
+      rowval.data(),nullptr);
+  testEquals(rv,1);
+
+  wildriver_close_matrix(handle);
+
+  testEquals(rowptr[6],14);
+  testEquals(rowind[6],3);
+  testEquals(rowval[6],7.0f);
+  testEquals(rowind[13],4);
+  testEquals(rowval[13],5.0f);
+}
+
+
 static void readGraph(
     std::string const & testFile)
 {
@@ -401,6 +463,604 @@ static void readGraph_deprecated(
 }
 
 
+struct arena_struct
+{
+  std::vector<char> memory;
+  size_t used;
+  size_t numAllocs;
+  size_t numFrees;
+};
+
+
+static void * arenaAlloc(
+    size_t const bytes,
+    size_t const alignment,
+    void * const ctx)
+{
+  arena_struct * const arena = static_cast<arena_struct*>(ctx);
+
+  uintptr_t const base = reinterpret_cast<uintptr_t>(arena->memory.data());
+  size_t const start = ((base + arena->used + alignment - 1) / alignment) * \
+      alignment - base;
+  if (start + bytes > arena->memory.size()) {
+    return nullptr;
+  }
+
+  arena->used = start + bytes;
+  ++arena->numAllocs;
+
+  return arena->memory.data() + start;
+}
+
+
+static void arenaFree(
+    void * const ptr,
+    size_t const bytes,
+    void * const ctx)
+{
+  arena_struct * const arena = static_cast<arena_struct*>(ctx);
+  ++arena->numFrees;
+}
+
+
+static void readAlloc(
+    std::string const & testFile)
+{
+  arena_struct arena{std::vector<char>(4096), 0, 0, 0};
+
+  wildriver_allocator allocator;
+  allocator.alloc = arenaAlloc;
+  allocator.free = arenaFree;
+  allocator.ctx = &arena;
+
+  wildriver_dim_t nrows, ncols;
+  wildriver_ind_t nnz;
+  wildriver_ind_t * rowptr;
+  wildriver_dim_t * rowind;
+  wildriver_val_t * rowval;
+
+  int rv = wildriver_read_matrix_alloc(testFile.data(),&allocator,&nrows, \
+      &ncols,&nnz,&rowptr,&rowind,&rowval);
+  testEquals(rv,1);
+
+  // everything came from the arena, and nothing has been released
+  testEquals(arena.numAllocs,3);
+  testEquals(arena.numFrees,0);
+  testTrue(reinterpret_cast<char*>(rowval) >= arena.memory.data() && \
+      reinterpret_cast<char*>(rowval) < arena.memory.data() + \
+      arena.memory.size());
+  testEquals(reinterpret_cast<uintptr_t>(rowind) % 64, 0);
+
+  testEquals(nnz,14);
+  testEquals(rowptr[6],14);
+  testEquals(rowind[6],3);
+  testEquals(rowval[6],7);
+
+  wildriver_ind_t * xadj;
+  wildriver_dim_t * adjncy;
+  wildriver_val_t * adjwgt;
+  rv = wildriver_read_graph_alloc(testFile.data(),&allocator,&nrows, \
+      nullptr,nullptr,nullptr,&xadj,&adjncy,nullptr,&adjwgt);
+  testEquals(rv,1);
+  testEquals(arena.numAllocs,6);
+  testEquals(xadj[6],14);
+
+  // when the arena runs out, what was allocated gets released
+  arena.used = arena.memory.size() - 64;
+  arena.numAllocs = 0;
+  rv = wildriver_read_matrix_alloc(testFile.data(),&allocator,&nrows, \
+      &ncols,&nnz,&rowptr,&rowind,&rowval);
+  testEquals(rv,0);
+  testEquals(arena.numFrees,arena.numAllocs);
+
+  // allocators must be complete
+  allocator.free = nullptr;
+  rv = wildriver_read_matrix_alloc(testFile.data(),&allocator,&nrows, \
+      &ncols,&nnz,&rowptr,&rowind,&rowval);
+  testEquals(rv,0);
+}
+
+
+static void readRows(
+    std::string const & testFile)
+{
+  wildriver_dim_t nrows, ncols;
+  wildriver_ind_t nnz;
+  wildriver_ind_t * rowptr;
+  wildriver_dim_t * rowind;
+  wildriver_val_t * rowval;
+
+  int rv = wildriver_read_matrix_rows(testFile.data(),1,4,&nrows,&ncols, \
+      &nnz,&rowptr,&rowind,&rowval);
+
+  testEquals(rv,1);
+
+  testEquals(nrows,6);
+  testEquals(ncols,6);
+  testEquals(nnz,8);
+
+  wildriver_ind_t const expRowptr[] = {0,2,5,8};
+  wildriver_dim_t const expRowind[] = {0,2,0,1,3,2,4,5};
+  wildriver_val_t const expRowval[] = {3,4,5,6,7,8,9,1};
+  for (size_t i = 0; i < 4; ++i) {
+    testEquals(rowptr[i],expRowptr[i]);
+  }
+  for (size_t j = 0; j < 8; ++j) {
+    testEquals(rowind[j],expRowind[j]);
+    testEquals(rowval[j],expRowval[j]);
+  }
+
+  free(rowptr);
+  free(rowind);
+  free(rowval);
+
+  // out of range
+  rv = wildriver_read_matrix_rows(testFile.data(),1,7,&nrows,&ncols, \
+      &nnz,&rowptr,&rowind,&rowval);
+  testEquals(rv,0);
+}
+
+
+static void readVertices(
+    std::string const & testFile)
+{
+  wildriver_dim_t nvtxs;
+  wildriver_ind_t nedges;
+  int nvwgts;
+  int ewgts;
+  wildriver_ind_t * xadj;
+  wildriver_dim_t * adjncy;
+  wildriver_val_t * vwgt;
+  wildriver_val_t * adjwgt;
+
+  int rv = wildriver_read_graph_vertices(testFile.data(),4,6,&nvtxs, \
+      &nedges,&nvwgts,&ewgts,&xadj,&adjncy,&vwgt,&adjwgt);
+
+  testEquals(rv,1);
+
+  testEquals(nvtxs,6);
+  testEquals(nedges,4);
+  testEquals(nvwgts,0);
+  testTrue(vwgt == NULL);
+
+  wildriver_ind_t const expXadj[] = {0,2,4};
+  wildriver_dim_t const expAdjncy[] = {3,5,3,4};
+  wildriver_val_t const expAdjwgt[] = {2,3,4,5};
+  for (size_t i = 0; i < 3; ++i) {
+    testEquals(xadj[i],expXadj[i]);
+  }
+  for (size_t j = 0; j < 4; ++j) {
+    testEquals(adjncy[j],expAdjncy[j]);
+    testEquals(adjwgt[j],expAdjwgt[j]);
+  }
+
+  free(xadj);
+  free(adjncy);
+  free(adjwgt);
+}
+
+
+static void readParts(
+    std::string const & testFile)
+{
+  wildriver_dim_t const expBegin[] = {0,3};
+  wildriver_dim_t const expEnd[] = {3,6};
+  wildriver_ind_t const expNnz[] = {7,7};
+
+  for (int p = 0; p < 2; ++p) {
+    wildriver_dim_t nrows, ncols, begin, end;
+    wildriver_ind_t nnz;
+    wildriver_ind_t * rowptr;
+    wildriver_dim_t * rowind;
+
+    int rv = wildriver_read_matrix_part(testFile.data(),2,p,&nrows,&ncols, \
+        &begin,&end,&nnz,&rowptr,&rowind,NULL);
+
+    testEquals(rv,1);
+    testEquals(nrows,6);
+    testEquals(begin,expBegin[p]);
+    testEquals(end,expEnd[p]);
+    testEquals(nnz,expNnz[p]);
+    testEquals(rowptr[end-begin],nnz);
+
+    free(rowptr);
+    free(rowind);
+
+    wildriver_dim_t nvtxs;
+    wildriver_ind_t nedges;
+    wildriver_ind_t * xadj;
+    wildriver_dim_t * adjncy;
+
+    rv = wildriver_read_graph_part(testFile.data(),2,p,&nvtxs,&begin,&end, \
+        &nedges,NULL,NULL,&xadj,&adjncy,NULL,NULL);
+
+    testEquals(rv,1);
+    testEquals(nvtxs,6);
+    testEquals(begin,expBegin[p]);
+    testEquals(end,expEnd[p]);
+    testEquals(nedges,expNnz[p]);
+
+    free(xadj);
+    free(adjncy);
+  }
+
+  wildriver_dim_t nrows, ncols, begin, end;
+  wildriver_ind_t nnz;
+  wildriver_ind_t * rowptr;
+  wildriver_dim_t * rowind;
+  int rv = wildriver_read_matrix_part(testFile.data(),2,2,&nrows,&ncols, \
+      &begin,&end,&nnz,&rowptr,&rowind,NULL);
+  testEquals(rv,0);
+}
+
+
+static void streamRows(
+    std::string const & testFile)
+{
+  wildriver_row_stream * stream = wildriver_begin_rows(testFile.data());
+  testTrue(stream != NULL);
+
+  testEquals(stream->nrows,6);
+  testEquals(stream->nnz,14);
+
+  wildriver_ind_t rowptr[3];
+  wildriver_dim_t rowind[6];
+  wildriver_val_t rowval[6];
+
+  // sum the values two rows at a time
+  wildriver_val_t sum = 0;
+  wildriver_dim_t total = 0;
+  while (true) {
+    wildriver_dim_t nrows;
+    int rv = wildriver_next_rows(stream,2,6,&nrows,rowptr,rowind,rowval);
+    testEquals(rv,1);
+    if (nrows == 0) {
+      break;
+    }
+    testEquals(nrows,2);
+    for (wildriver_ind_t j = 0; j < rowptr[nrows]; ++j) {
+      sum += rowval[j];
+    }
+    total += nrows;
+    testEquals(stream->row,total);
+  }
+
+  testEquals(total,6);
+  testEquals(sum,60);
+
+  wildriver_end_rows(stream);
+}
+
+
+static void asyncCallback(
+    wildriver_async *,
+    int const status,
+    void * const ctx)
+{
+  // record the status for checking from the main thread
+  *static_cast<int*>(ctx) = status;
+}
+
+
+static void readAsync(
+    std::string const & testFile)
+{
+  int matrixStatus = -1;
+  wildriver_async * matrix = wildriver_read_matrix_async(testFile.data(), \
+      asyncCallback, &matrixStatus);
+  testTrue(matrix != NULL);
+  testEquals(matrix->kind,WILDRIVER_ASYNC_MATRIX);
+
+  wildriver_async * graph = wildriver_read_graph_async(testFile.data(), \
+      NULL, NULL);
+  testTrue(graph != NULL);
+
+  testEquals(wildriver_async_wait(matrix),WILDRIVER_STATUS_DONE);
+  testEquals(wildriver_async_status(matrix),WILDRIVER_STATUS_DONE);
+  testEquals(matrixStatus,WILDRIVER_STATUS_DONE);
+
+  wildriver_dim_t nrows, ncols;
+  wildriver_ind_t nnz;
+  wildriver_ind_t * rowptr;
+  wildriver_dim_t * rowind;
+  wildriver_val_t * rowval;
+  int rv = wildriver_async_get_matrix(matrix,&nrows,&ncols,&nnz,&rowptr, \
+      &rowind,&rowval);
+  testEquals(rv,1);
+  testEquals(nrows,6);
+  testEquals(ncols,6);
+  testEquals(nnz,14);
+  testEquals(rowptr[6],14);
+  testEquals(rowind[13],4);
+  testEquals(rowval[13],5);
+
+  // the results can only be taken once
+  rv = wildriver_async_get_matrix(matrix,&nrows,&ncols,&nnz,&rowptr, \
+      &rowind,&rowval);
+  testEquals(rv,0);
+
+  free(rowptr);
+  free(rowind);
+  free(rowval);
+  wildriver_async_free(matrix);
+
+  // a matrix cannot be taken from a graph load
+  rv = wildriver_async_get_matrix(graph,&nrows,&ncols,&nnz,&rowptr, \
+      &rowind,&rowval);
+  testEquals(rv,0);
+
+  // the graph is left to be released by wildriver_async_free()
+  testEquals(wildriver_async_wait(graph),WILDRIVER_STATUS_DONE);
+  wildriver_async_free(graph);
+
+  int missingStatus = -1;
+  wildriver_async * missing = wildriver_read_matrix_async( \
+      "./wildriver_test_missing.csr", asyncCallback, &missingStatus);
+  testTrue(missing != NULL);
+  testEquals(wildriver_async_wait(missing),WILDRIVER_STATUS_FAILED);
+  testEquals(missingStatus,WILDRIVER_STATUS_FAILED);
+  rv = wildriver_async_get_matrix(missing,&nrows,&ncols,&nnz,&rowptr, \
+      &rowind,&rowval);
+  testEquals(rv,0);
+  wildriver_async_free(missing);
+}
+
+
+static void readCancellable(
+    std::string const & testFile)
+{
+  wildriver_cancel_token * token = wildriver_create_cancel_token();
+  testTrue(token != NULL);
+
+  wildriver_dim_t nrows, ncols;
+  wildriver_ind_t nnz;
+  wildriver_ind_t * rowptr;
+  wildriver_dim_t * rowind;
+  wildriver_val_t * rowval;
+  int rv = wildriver_read_matrix_cancellable(testFile.data(),token,&nrows, \
+      &ncols,&nnz,&rowptr,&rowind,&rowval);
+  testEquals(rv,WILDRIVER_SUCCESS);
+  testEquals(nnz,14);
+  free(rowptr);
+  free(rowind);
+  free(rowval);
+
+  // a deadline in the past
+  wildriver_set_deadline(token,1e-9);
+  wildriver_dim_t nvtxs;
+  wildriver_ind_t * xadj;
+  wildriver_dim_t * adjncy;
+  rv = wildriver_read_graph_cancellable(testFile.data(),token,&nvtxs,NULL, \
+      NULL,NULL,&xadj,&adjncy,NULL,NULL);
+  testEquals(rv,WILDRIVER_ERROR_DEADLINE);
+
+  wildriver_set_deadline(token,0);
+  wildriver_cancel(token);
+  rv = wildriver_read_matrix_cancellable(testFile.data(),token,&nrows, \
+      &ncols,&nnz,&rowptr,&rowind,&rowval);
+  testEquals(rv,WILDRIVER_ERROR_CANCELLED);
+
+  // loads through handles check the token of the calling thread, including
+  // the scan of the header when opening
+  wildriver_matrix_handle * handle = wildriver_open_matrix(testFile.data(), \
+      WILDRIVER_IN);
+  testTrue(handle != NULL);
+  std::vector<wildriver_ind_t> handleRowptr(handle->nrows+1);
+  std::vector<wildriver_dim_t> handleRowind(handle->nnz);
+  std::vector<wildriver_val_t> handleRowval(handle->nnz);
+
+  wildriver_set_thread_cancel_token(token);
+  testTrue(wildriver_open_matrix(testFile.data(),WILDRIVER_IN) == NULL);
+  rv = wildriver_load_matrix(handle,handleRowptr.data(), \
+      handleRowind.data(),handleRowval.data(),NULL);
+  testEquals(rv,0);
+
+  wildriver_set_thread_cancel_token(NULL);
+  wildriver_close_matrix(handle);
+
+  wildriver_free_cancel_token(token);
+
+  // a load cancelled before it starts
+  wildriver_async * async = wildriver_read_matrix_async(testFile.data(), \
+      NULL, NULL);
+  wildriver_async_cancel(async);
+  rv = wildriver_async_wait(async);
+  testTrue(rv == WILDRIVER_STATUS_CANCELLED || rv == WILDRIVER_STATUS_DONE);
+  wildriver_async_free(async);
+}
+
+
+static void progressCallback(
+    wildriver_progress const * const progress,
+    void * const ctx)
+{
+  // record the last phase for checking from the main thread
+  *static_cast<int*>(ctx) = progress->phase;
+}
+
+
+static void readProgress(
+    std::string const & testFile)
+{
+  int phase = -1;
+  wildriver_progress_monitor * monitor = wildriver_create_progress_monitor( \
+      progressCallback, &phase, 0);
+  testTrue(monitor != NULL);
+
+  wildriver_set_thread_progress(monitor);
+
+  wildriver_dim_t nrows, ncols;
+  wildriver_ind_t nnz;
+  wildriver_ind_t * rowptr;
+  wildriver_dim_t * rowind;
+  wildriver_val_t * rowval;
+  int rv = wildriver_read_matrix(testFile.data(),&nrows,&ncols,&nnz,&rowptr, \
+      &rowind,&rowval);
+  testEquals(rv,1);
+  free(rowptr);
+  free(rowind);
+  free(rowval);
+
+  wildriver_set_thread_progress(NULL);
+
+  wildriver_progress progress;
+  wildriver_get_progress(monitor,&progress);
+  testEquals(progress.phase,WILDRIVER_PHASE_DONE);
+  testEquals(phase,WILDRIVER_PHASE_DONE);
+  testEquals(progress.rows,6);
+  testEquals(progress.entries,14);
+  testEquals(progress.bytes,progress.total_bytes);
+
+  // the stats of the read count the same as the monitor
+  wildriver_stats stats;
+  testEquals(wildriver_get_last_stats(&stats),1);
+  testEquals(stats.rows,6);
+  testEquals(stats.entries,14);
+  testEquals(stats.bytes,progress.bytes);
+  testTrue(stats.lines >= 6);
+  testEquals(stats.allocations,3);
+
+  wildriver_free_progress_monitor(monitor);
+
+  wildriver_async * async = wildriver_read_matrix_async(testFile.data(), \
+      NULL, NULL);
+  testEquals(wildriver_async_wait(async),WILDRIVER_STATUS_DONE);
+  wildriver_async_get_progress(async,&progress);
+  testEquals(progress.phase,WILDRIVER_PHASE_DONE);
+  testEquals(progress.entries,14);
+  wildriver_async_free(async);
+}
+
+
+static void readBatch(
+    std::string const & testFile,
+    std::string const & graphFile,
+    std::string const & vectorFile)
+{
+  std::vector<std::string> const names{testFile, \
+      "./wildriver_test_missing.csr", graphFile, testFile};
+
+  std::vector<wildriver_matrix_slot> slots(names.size());
+  for (size_t i = 0; i < names.size(); ++i) {
+    slots[i].fname = names[i].c_str();
+  }
+
+  size_t const loaded = wildriver_read_matrix_batch(slots.data(), \
+      slots.size(), 1);
+  testEquals(loaded,3);
+
+  testEquals(slots[0].status,WILDRIVER_SUCCESS);
+  testEquals(slots[0].nrows,6);
+  testEquals(slots[0].nnz,14);
+  testEquals(slots[0].rowptr[6],14);
+  testEquals(slots[0].rowind[13],4);
+  testEquals(slots[0].rowval[13],5);
+
+  // a missing file only fails its own slot
+  testEquals(slots[1].status,WILDRIVER_ERROR);
+  testTrue(slots[1].rowptr == NULL);
+  testTrue(std::string(slots[1].error).size() > 0);
+
+  testEquals(slots[2].status,WILDRIVER_SUCCESS);
+  testTrue(slots[2].nrows > 0);
+
+  testEquals(slots[3].status,WILDRIVER_SUCCESS);
+  testEquals(slots[3].rowval[13],5);
+
+  for (wildriver_matrix_slot const & slot : slots) {
+    free(slot.rowptr);
+    free(slot.rowind);
+    free(slot.rowval);
+  }
+
+  // without values
+  testEquals(wildriver_read_matrix_batch(slots.data(),1,0),1);
+  testTrue(slots[0].rowval == NULL);
+  testEquals(slots[0].rowind[13],4);
+  free(slots[0].rowptr);
+  free(slots[0].rowind);
+
+  std::vector<wildriver_vector_slot> vectors(2);
+  vectors[0].fname = vectorFile.c_str();
+  vectors[1].fname = "./wildriver_test_missing.txt";
+  testEquals(wildriver_read_vector_batch(vectors.data(),vectors.size()),1);
+  testEquals(vectors[0].status,WILDRIVER_SUCCESS);
+  testEquals(vectors[0].size,7);
+  testEquals(vectors[0].vals[4],9);
+  testEquals(vectors[1].status,WILDRIVER_ERROR);
+  free(vectors[0].vals);
+
+  // a slot without a filename fails the whole batch
+  slots[1].fname = NULL;
+  testEquals(wildriver_read_matrix_batch(slots.data(),slots.size(),1),0);
+  vectors[0].fname = NULL;
+  testEquals(wildriver_read_vector_batch(vectors.data(),vectors.size()),0);
+  testEquals(wildriver_read_vector_batch(NULL,1),0);
+}
+
+
+static void generateMatrix(
+    std::string const & graphFile,
+    std::string const & mmFile)
+{
+  wildriver_generator_options options;
+  wildriver_init_generator_options(&options);
+  options.nrows = 1000;
+  options.ncols = 1000;
+  options.nnz = 8000;
+  options.seed = 7;
+
+  // graphs must be symmetric
+  testEquals(wildriver_generate_matrix(graphFile.c_str(), &options), 0);
+
+  options.symmetric = 1;
+  testEquals(wildriver_generate_matrix(graphFile.c_str(), &options), 1);
+  testTrue(options.nnz_written > 0);
+  testTrue(options.nnz_written <= 16000);
+
+  wildriver_dim_t nvtxs;
+  wildriver_ind_t nedges;
+  wildriver_ind_t * xadj;
+  wildriver_dim_t * adjncy;
+  testEquals(wildriver_read_graph(graphFile.c_str(), &nvtxs, &nedges, NULL, \
+      NULL, &xadj, &adjncy, NULL, NULL), 1);
+  testEquals(nvtxs, 1000);
+  testEquals(nedges, options.nnz_written);
+
+  // no self loops
+  bool loops = false;
+  for (wildriver_dim_t i = 0; i < nvtxs; ++i) {
+    for (wildriver_ind_t j = xadj[i]; j < xadj[i+1]; ++j) {
+      loops = loops || adjncy[j] == i;
+    }
+  }
+  testTrue(!loops);
+  free(xadj);
+  free(adjncy);
+
+  options.kind = WILDRIVER_GENERATOR_BANDED;
+  options.bandwidth = 2;
+  testEquals(wildriver_generate_matrix(mmFile.c_str(), &options), 1);
+  testEquals(options.nnz_written, 1000*5-6);
+
+  wildriver_dim_t nrows, ncols;
+  wildriver_ind_t nnz;
+  wildriver_ind_t * rowptr;
+  wildriver_dim_t * rowind;
+  wildriver_val_t * rowval;
+  testEquals(wildriver_read_matrix(mmFile.c_str(), &nrows, &ncols, &nnz, \
+      &rowptr, &rowind, &rowval), 1);
+  testEquals(nnz, options.nnz_written);
+  testEquals(rowptr[1], 3);
+  testEquals(rowind[0], 0);
+  testEquals(rowval[0], 2);
+  testEquals(rowval[1], -1);
+  free(rowptr);
+  free(rowind);
+  free(rowval);
+}
+
+
 void Test::run()
 {
   std::string const csrFile("./wildriver_test.csr");
@@ -415,6 +1075,11 @@ void Test::run()
 
   Test::removeFile(mmFile);
 
+  writeMatrixTyped(csrFile);
+  readMatrixTyped(csrFile);
+
+  Test::removeFile(csrFile);
+
   std::string const graphFile("./wildriver_test.graph");
   writeGraph_deprecated(graphFile);
   readGraph(graphFile);
@@ -442,6 +1107,51 @@ void Test::run()
 
   writeGraph_deprecated("./wildriver_test.csr");
   readGraph_deprecated("./wildriver_test.csr");
+
+  // test placement of the returned arrays
+  wildriver_set_alloc_flags(WILDRIVER_ALLOC_FIRST_TOUCH | \
+      WILDRIVER_ALLOC_HUGE_PAGES | WILDRIVER_ALLOC_INTERLEAVE);
+  testEquals(wildriver_get_alloc_flags(), 7);
+  readMatrix_deprecated("./wildriver_test.csr");
+  readGraph_deprecated("./wildriver_test.csr");
+  wildriver_set_alloc_flags(WILDRIVER_ALLOC_DEFAULT);
+
+  // test running parallel work with a different number of threads
+  int const numThreads = wildriver_get_num_threads();
+  testTrue(numThreads >= 1);
+  wildriver_set_num_threads(3);
+  testEquals(wildriver_get_num_threads(), 3);
+  wildriver_set_alloc_flags(WILDRIVER_ALLOC_FIRST_TOUCH);
+  readMatrix_deprecated("./wildriver_test.csr");
+  wildriver_set_alloc_flags(WILDRIVER_ALLOC_DEFAULT);
+  wildriver_set_num_threads(0);
+  testEquals(wildriver_get_num_threads(), numThreads);
+
+  readAlloc("./wildriver_test.csr");
+
+  // test reading ranges of rows/vertices
+  readRows("./wildriver_test.csr");
+  readVertices("./wildriver_test.csr");
+
+  writeGraph_deprecated("./wildriver_test.graph");
+  readRows("./wildriver_test.graph");
+  readVertices("./wildriver_test.graph");
+
+  readParts("./wildriver_test.csr");
+  readParts("./wildriver_test.graph");
+
+  streamRows("./wildriver_test.csr");
+
+  readAsync("./wildriver_test.csr");
+  readCancellable("./wildriver_test.csr");
+  readProgress("./wildriver_test.csr");
+
+  writeVector(vectorFile);
+  readBatch("./wildriver_test.csr", "./wildriver_test.graph", vectorFile);
+  Test::removeFile(vectorFile);
+
+  generateMatrix("./wildriver_test.graph", mmFile);
+  Test::removeFile(mmFile);
 }
 
 